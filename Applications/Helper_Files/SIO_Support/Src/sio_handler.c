@@ -41,6 +41,18 @@ int _sio_putchar(char data, FILE *dummy)
 {
     uint8_t c = data;
 
+#ifdef PAL_SIO_TX_RING
+    /* The ring takes the data, pal_task() passes it to the SIO unit. */
+    if (c == '\n')
+    {
+        c = '\r';
+        pal_sio_tx_ring(SIO_CHANNEL, &c, 1);
+        c = data;
+    }
+    pal_sio_tx_ring(SIO_CHANNEL, &c, 1);
+
+    return (0);
+#else
     if (c == '\n')
     {
         c = '\r';
@@ -71,6 +83,7 @@ int _sio_putchar(char data, FILE *dummy)
     }
 
     return (0);
+#endif  /* PAL_SIO_TX_RING */
 }
 
 
@@ -159,6 +172,15 @@ void sio_binarywrite(uint8_t *d, int16_t sz)
 {
     int16_t x = 0;
 
+#ifdef PAL_SIO_TX_RING
+    /* Keeps the order with the text written by _sio_putchar(). */
+    while (sz > 0)
+    {
+        x = pal_sio_tx_ring(SIO_CHANNEL, d, (sz > 0xFF) ? 0xFF : (uint8_t)sz);
+        sz = sz - x;
+        d += x;
+    }
+#else
     while (sz > 0)
     {
         x = pal_sio_tx(SIO_CHANNEL, d, sz);
@@ -172,6 +194,7 @@ void sio_binarywrite(uint8_t *d, int16_t sz)
         pal_task();
 #endif
     }
+#endif  /* PAL_SIO_TX_RING */
 }
 
 #endif  /* SIO_HUB */
@@ -37,7 +37,12 @@
 #define MAC_PURGE_REQUEST_CONFIRM               (0)
 #define MAC_RX_ENABLE_SUPPORT                   (0)
 #define MAC_SCAN_ACTIVE_REQUEST_CONFIRM         (0)
+#ifdef ENABLE_RTB_SPECTRUM
+/* The spectrum monitor of the RTB uses the ED scan of the TAL. */
+#define MAC_SCAN_ED_REQUEST_CONFIRM             (1)
+#else
 #define MAC_SCAN_ED_REQUEST_CONFIRM             (0)
+#endif  /* ENABLE_RTB_SPECTRUM */
 #define MAC_SCAN_ORPHAN_REQUEST_CONFIRM         (0)
 #define MAC_SCAN_PASSIVE_REQUEST_CONFIRM        (0)
 #define MAC_START_REQUEST_CONFIRM               (0)
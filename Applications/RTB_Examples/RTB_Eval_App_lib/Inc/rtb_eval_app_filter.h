@@ -0,0 +1,106 @@
+/**
+ * @file rtb_eval_app_filter.h
+ *
+ * @brief Incremental filters of the continuous ranging
+ *
+ * The filter keeps the last MAX_LEN_OF_FILTERING_CONT results of a link
+ * and updates its statistics with every new result, instead of rescanning
+ * the filter window:
+ * - Sums of the distances, DQFs and their squares for average and variance
+ * - The window positions sorted by distance for median, minimum and maximum
+ * - A histogram of the DQFs for their median and minimum
+ *
+ * The file has no stack dependencies, so it is also used by host tools.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_EVAL_APP_FILTER_H
+#define RTB_EVAL_APP_FILTER_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+#ifndef MAX_LEN_OF_FILTERING_CONT
+/**
+ * Max. filtering length during continuous ranging.
+ * The filter of a link requires 6 octets RAM per value.
+ */
+#   define MAX_LEN_OF_FILTERING_CONT    (255U)
+#endif
+
+#if (MAX_LEN_OF_FILTERING_CONT > 255) || (MAX_LEN_OF_FILTERING_CONT < 4)
+#   error "MAX_LEN_OF_FILTERING_CONT must be within 4 and 255"
+#endif
+
+/** Maximum DQF value in percent */
+#define CONT_FILT_DQF_MAX               (100U)
+
+/* === Types ================================================================ */
+
+/** Filter state of one link */
+typedef struct cont_filt_tag
+{
+    /** Distances of the last results in cm */
+    uint32_t dist[MAX_LEN_OF_FILTERING_CONT];
+    /** DQFs of the last results */
+    uint8_t dqf[MAX_LEN_OF_FILTERING_CONT];
+    /** Positions of the window values, sorted by distance; newest first among equal distances */
+    uint8_t sorted[MAX_LEN_OF_FILTERING_CONT];
+    /** Number of window values per DQF */
+    uint8_t dqf_hist[CONT_FILT_DQF_MAX + 1];
+    /** Sum of the window distances */
+    uint32_t dist_sum;
+    /** Sum of the squared window distances */
+    uint64_t dist_sum_sqr;
+    /** Sum of the window DQFs */
+    uint16_t dqf_sum;
+    /** Sum of the squared window DQFs */
+    uint32_t dqf_sum_sqr;
+    /** Position of the newest result */
+    uint8_t idx;
+    /** Filtering length, i.e. number of values within the window */
+    uint8_t len;
+} cont_filt_t;
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void cont_filt_init(cont_filt_t *filt, uint8_t len,
+                        uint32_t dist, uint8_t dqf);
+    void cont_filt_set_len(cont_filt_t *filt, uint8_t len);
+    void cont_filt_add(cont_filt_t *filt, uint32_t dist, uint8_t dqf);
+    uint32_t cont_filt_prev_dist(const cont_filt_t *filt, uint8_t offset);
+    void cont_filt_aver(const cont_filt_t *filt,
+                        uint32_t *dist, uint8_t *dqf);
+    void cont_filt_median(const cont_filt_t *filt,
+                          uint32_t *dist, uint8_t *dqf);
+    void cont_filt_min(const cont_filt_t *filt,
+                       uint32_t *dist, uint8_t *dqf);
+    void cont_filt_max(const cont_filt_t *filt,
+                       uint32_t *dist, uint8_t *dqf);
+    void cont_filt_min_var(const cont_filt_t *filt,
+                           uint32_t *dist, uint8_t *dqf);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RTB_EVAL_APP_FILTER_H */
+/* EOF */
@@ -32,6 +32,8 @@
 #include "sio_handler.h"
 #include "mac_api.h"
 #include "rtb_api.h"
+#include "rtb_eval_app_filter.h"
+#include "rtb_eval_app_track.h"
 #include "app_config.h"
 #include "ieee_const.h"
 #include "mac_internal.h"
@@ -101,16 +103,15 @@
 /* Default transmit power. */
 #define DEFAULT_TX_POWER                (-17)
 
-/* Max. filtering length during continuous ranging. */
-/*
- * Keep this a value of power of 2 for unexpansive module operations
- * during index calculations.
- */
-#define MAX_LEN_OF_FILTERING_CONT              (16U)
-
 /* Default filtering length during continuous ranging. */
 #define DEFAULT_LEN_OF_FILTERING_CONT          (5U)
 
+/* Share of valid PMU values of a sweep not refined by the adaptive sweep. */
+#define ADAPTIVE_MIN_VALID_PERCENT      (75)
+
+/* Time between the ED scans of two blocks of the spectrum monitor in ms. */
+#define SPECTRUM_SCAN_INTERVAL_MS       (500)
+
 /*
  * Number of values utilzed for speed calculation during continuous
  * ranging.
@@ -132,6 +133,57 @@
 #   error "Value for ranging period too large for timers for speed calculation."
 #endif
 
+/*
+ * Timeout value before starting next ranging in continuous ranging in ms,
+ * if the results are sent as binary result frames.
+ */
+#define CONT_RANGING_PERIOD_BINARY_MS   (20UL)
+
+/*
+ * Binary result frame, sent instead of the text output for each range
+ * confirm if the output mode is OUTPUT_BINARY.
+ * It uses the framing of the binary PMU capture frames (see rtb_pmu.h):
+ * sync (0xA5 0x5A), length of the payload (2 octets), payload, CRC-16
+ * (CCITT, initial value 0xFFFF) over length and payload.
+ * All multi-octet fields are little endian.
+ *
+ * Payload:
+ * Octets  Field
+ * 1       Frame type (RESULT_FRAME_TYPE)
+ * 2       Sequence number
+ * 1       Status of the range confirm
+ * 4       Distance in cm
+ * 1       DQF in percent
+ * 4       Timestamp of the range confirm in us
+ * 1       Flags (RESULT_FLAG_xxx, addressing scheme in bits 4..5)
+ * 2       Short address of the Initiator or RESULT_ADDR_LONG
+ * 2       Short address of the Reflector or RESULT_ADDR_LONG
+ * 1       Number of measurement pairs N
+ * N * 5   Distance (4) and DQF (1) of each measurement pair
+ */
+/** First sync octet of a binary result frame */
+#define RESULT_FRAME_SYNC_0             (0xA5)
+/** Second sync octet of a binary result frame */
+#define RESULT_FRAME_SYNC_1             (0x5A)
+/** Frame type of a binary result frame */
+#define RESULT_FRAME_TYPE               (0x02)
+/** Length of the payload without measurement pairs */
+#define RESULT_FRAME_FIXED_LEN          (19)
+/** Length of a measurement pair within the payload */
+#define RESULT_FRAME_PAIR_LEN           (5)
+/** Maximum number of measurement pairs of a binary result frame */
+#define RESULT_FRAME_MAX_PAIRS          (4)
+/** Initial value of the CRC of a binary result frame */
+#define RESULT_FRAME_CRC_INIT           (0xFFFF)
+/** Flag: Result of a remote ranging */
+#define RESULT_FLAG_REMOTE              (0x01)
+/** Flag: Result of a continuous ranging */
+#define RESULT_FLAG_CONTINUOUS          (0x02)
+/** Bit position of the addressing scheme within the flags */
+#define RESULT_FLAG_ADDR_SCHEME_POS     (4)
+/** Address of a node addressed by its long address */
+#define RESULT_ADDR_LONG                (0xFFFE)
+
 /* === Types ================================================================ */
 
 /* Ranging application state type */
@@ -185,9 +237,17 @@ typedef enum filtering_method_tag
     FILT_MEDIAN,    /**< Median of distance and DQF */
     FILT_MIN,       /**< Minimum of distance and DQF */
     FILT_MIN_VAR,   /**< Minimum of distance and DQF considerung variance */
-    FILT_MAX        /**< Maximum of distance and DQF */
+    FILT_MAX,       /**< Maximum of distance and DQF */
+    FILT_TRACK      /**< Tracking of distance and speed (Kalman filter) */
 } SHORTENUM filtering_method_t;
 
+/* Output format of the ranging results */
+typedef enum output_mode_tag
+{
+    OUTPUT_TEXT = 0,    /**< Text for Python and human reading */
+    OUTPUT_BINARY       /**< Binary result frames */
+} SHORTENUM output_mode_t;
+
 /* Complete application relevant type for EEPROM storage */
 typedef struct app_data_tag
 {
@@ -208,6 +268,7 @@ extern rtb_pib_t rtb_pib;
 extern bool cont_ranging_ongoing;
 extern uint16_t time_history[];
 extern uint8_t time_history_idx;
+extern output_mode_t app_output_mode;
 
 /* === Prototypes =========================================================== */
 
@@ -233,16 +294,28 @@ extern "C" {
                                 uint32_t distance,
                                 uint8_t dqf);
     void init_ranging(bool is_remote);
+    void get_range_short_addresses(bool was_remote,
+                                   uint16_t *init_addr,
+                                   uint16_t *refl_addr);
     void print_range_addresses(bool was_remote);
     void print_status(uint8_t status);
     bool range_load_param(void);
     void range_store_param(void);
+#ifdef PAL_PS_STORE
+    void range_commit_param(void);
+#endif
 #if (AUTOMATIC_NODE_DETECTION_RTB == 1)
     void range_set_default_addr(node_type_t cur_node_type);
 #else
     void range_set_default_addr(void);
 #endif
-    uint64_t atoll(char *instr);
+    uint64_t atoull(char *instr);
+#ifdef ENABLE_RTB_ADAPTIVE
+    void set_adaptive_sweep(void);
+#endif
+#ifdef ENABLE_RTB_SPECTRUM
+    void set_spectrum_monitor(void);
+#endif
     bool set_addr_scheme(void);
     bool set_antenna_diversity(void);
     bool set_channel(void);
@@ -260,6 +333,7 @@ extern "C" {
     bool set_provisioning_of_tx_power(void);
     bool set_filtering_length_cont(void);
     bool set_filtering_method_cont(void);
+    bool set_output_mode(void);
     bool set_refl_long_addr(void);
     bool set_refl_short_addr(void);
     bool set_short_addr(void);
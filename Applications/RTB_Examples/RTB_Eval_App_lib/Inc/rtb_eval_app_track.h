@@ -0,0 +1,128 @@
+/**
+ * @file rtb_eval_app_track.h
+ *
+ * @brief Distance tracker of the continuous ranging
+ *
+ * The tracker is a Kalman filter with the state distance and velocity
+ * of a link. Every result is weighted by a measurement variance derived
+ * from its DQF, and the prediction uses the time between two rangings.
+ * All calculations are done in Q16 fixed point, so the tracker needs
+ * no floating point support on the MCU.
+ *
+ * The file has no stack dependencies, so it is also used by host tools.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_EVAL_APP_TRACK_H
+#define RTB_EVAL_APP_TRACK_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+#ifndef TRACK_SIGMA_DQF100_CM
+/**
+ * Standard deviation of a distance with a DQF of 100 % in cm.
+ * The standard deviation is inversely proportional to the DQF.
+ */
+#   define TRACK_SIGMA_DQF100_CM        (15UL)
+#endif
+
+#ifndef TRACK_SIGMA_ACCEL_CM_S2
+/** Standard deviation of the acceleration of a node in cm/s^2 */
+#   define TRACK_SIGMA_ACCEL_CM_S2      (50UL)
+#endif
+
+#ifndef TRACK_SIGMA_VEL_CM_S
+/** Standard deviation of the initial velocity in cm/s */
+#   define TRACK_SIGMA_VEL_CM_S         (200UL)
+#endif
+
+#ifndef TRACK_GATE_SIGMA
+/** Results beyond this number of standard deviations are rejected. */
+#   define TRACK_GATE_SIGMA             (3)
+#endif
+
+#ifndef TRACK_MAX_REJECTS
+/** Number of consecutive rejected results restarting the tracker */
+#   define TRACK_MAX_REJECTS            (3U)
+#endif
+
+/** Maximum time between two results in ms */
+#define TRACK_MAX_DT_MS                 (10000U)
+
+/** Maximum distance of the tracker in cm (32767 m) */
+#define TRACK_MAX_DIST_CM               (3276700UL)
+
+#if (TRACK_SIGMA_DQF100_CM < 1) || (TRACK_SIGMA_DQF100_CM > 100)
+#   error "TRACK_SIGMA_DQF100_CM must be within 1 and 100"
+#endif
+
+#if (TRACK_SIGMA_ACCEL_CM_S2 > 1000) || (TRACK_SIGMA_VEL_CM_S > 1000)
+#   error "Unreasonable standard deviation of the tracker"
+#endif
+
+/* === Types ================================================================ */
+
+/** Result of the correction of the tracker */
+typedef enum cont_track_status_tag
+{
+    TRACK_ACCEPTED = 0, /**< Result updated the tracker */
+    TRACK_REJECTED,     /**< Result was outside of the gate */
+    TRACK_RESTARTED     /**< Tracker restarted at the result */
+} cont_track_status_t;
+
+/**
+ * Tracker state of one link.
+ * All values are Q16 fixed point in m and s.
+ */
+typedef struct cont_track_tag
+{
+    /** Distance in m */
+    int32_t dist;
+    /** Velocity in m/s; negative if the node approaches */
+    int32_t vel;
+    /** Variance of the distance in m^2 */
+    int32_t p00;
+    /** Covariance of distance and velocity in m^2/s */
+    int32_t p01;
+    /** Variance of the velocity in m^2/s^2 */
+    int32_t p11;
+    /** Number of consecutive rejected results */
+    uint8_t rejects;
+} cont_track_t;
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void cont_track_init(cont_track_t *track, uint32_t dist, uint8_t dqf);
+    void cont_track_predict(cont_track_t *track, uint16_t dt_ms);
+    cont_track_status_t cont_track_correct(cont_track_t *track,
+                                           uint32_t dist, uint8_t dqf);
+    uint32_t cont_track_dist(const cont_track_t *track);
+    uint8_t cont_track_dqf(const cont_track_t *track);
+    int16_t cont_track_vel(const cont_track_t *track);
+    int8_t cont_track_speed_kmh(const cont_track_t *track);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RTB_EVAL_APP_TRACK_H */
+/* EOF */
@@ -64,6 +64,11 @@ bool cont_ranging_ongoing = false;
 uint16_t time_history[SPEED_CALC_ARRAY_LEN] = {0, 0};
 /* Timestamp history array index */
 uint8_t time_history_idx = 0;
+/*
+ * Output format of the ranging results.
+ * Not stored in EEPROM, so each reset returns to text output.
+ */
+output_mode_t app_output_mode = OUTPUT_TEXT;
 
 char build_string[sizeof(BUILD_NO)] = BUILD_NO;
 char build_no[20];
@@ -75,6 +80,12 @@ static void flash_all_leds(void);
 static bool handle_user_input(int user_input);
 static void rtb_eval_app_help_menu(void);
 static void rtb_eval_app_param_menu(void);
+#ifdef ENABLE_BMM_STATS
+static void rtb_eval_app_buffer_stats(void);
+#endif
+#ifdef ENABLE_RTB_TRACE
+static void rtb_eval_app_trace(void);
+#endif
 static void rtb_eval_app_task(void);
 void timeout_remote_ranging_cb(void *parameter);
 #if (AUTOMATIC_NODE_DETECTION_RTB == 1)
@@ -153,11 +164,13 @@ int main(void)
     build_no_start++;
 
     /* Search for 2nd occurrence of space; the build number starts here. */
-    build_no_start = memchr(build_no_start, ' ', sizeof(BUILD_NO));
+    build_no_start = memchr(build_no_start, ' ',
+                            sizeof(build_string) - (build_no_start - build_string));
     build_no_start++;
 
     /* Search for 3rd occurence of space; the build number ends here. */
-    build_no_end = memchr(build_no_start, ' ', sizeof(BUILD_NO));
+    build_no_end = memchr(build_no_start, ' ',
+                          sizeof(build_string) - (build_no_start - build_string));
 
     strncpy(build_no, build_no_start, build_no_end - build_no_start);
     printf("%s)\n\n\n", build_no);
@@ -249,6 +262,10 @@ void rtb_eval_app_task(void)
         }
     }
 
+#ifdef PAL_PS_STORE
+    range_commit_param();
+#endif
+
     if (cont_ranging_ongoing)
     {
         int input = sio_getchar_nowait();
@@ -335,6 +352,32 @@ static bool handle_user_input(int user_input)
             rtb_eval_app_param_menu();
             break;
 
+#ifdef ENABLE_BMM_STATS
+        case 'B':
+            rtb_eval_app_buffer_stats();
+            break;
+#endif
+
+#ifdef ENABLE_RTB_TRACE
+        case 'L':
+            rtb_eval_app_trace();
+            break;
+#endif
+
+#ifdef ENABLE_RTB_ADAPTIVE
+        case 'A':
+            /* The adaptive frequency sweep is not stored in EEPROM. */
+            set_adaptive_sweep();
+            break;
+#endif
+
+#ifdef ENABLE_RTB_SPECTRUM
+        case 'S':
+            /* The spectrum monitor is not stored in EEPROM. */
+            set_spectrum_monitor();
+            break;
+#endif
+
         case '1':
             eeprom_to_be_updated = set_freq_start();
             break;
@@ -401,6 +444,11 @@ static bool handle_user_input(int user_input)
             eeprom_to_be_updated = set_verbose_level();
             break;
 
+        case 'b':
+            /* The output mode is not stored in EEPROM. */
+            set_output_mode();
+            break;
+
         case 's':
             eeprom_to_be_updated = set_addr_scheme();
             break;
@@ -767,12 +815,139 @@ static void rtb_eval_app_help_menu(void)
            " M : remote ranging\n"
 		   #endif
            " p : parameters\n"
+#ifdef ENABLE_BMM_STATS
+           " B : buffer statistics\n"
+#endif
+#ifdef ENABLE_RTB_TRACE
+           " L : ranging latency trace\n"
+#endif
+#ifdef ENABLE_RTB_ADAPTIVE
+           " A : adaptive frequency sweep\n"
+#endif
+#ifdef ENABLE_RTB_SPECTRUM
+           " S : spectrum monitor\n"
+#endif
            " F : factory defaults\n"
           );
 }
 
 
 
+#ifdef ENABLE_BMM_STATS
+/**
+ * This function displays the statistics of the buffer pool.
+ *
+ * The minimum of free buffers, the allocation failures and the peak use
+ * are restarted afterwards, so the next output covers the time since.
+ */
+static void rtb_eval_app_buffer_stats(void)
+{
+    static const char *const owner_names[BMM_NO_OF_OWNERS] =
+    {
+        "App", "TAL", "MAC", "RTB"
+    };
+    bmm_stats_t stats;
+
+    bmm_get_stats(&stats, true);
+
+    printf("\n[BUFFER_STATS]\n");
+    printf(" Large: free %" PRIu8 " of %" PRIu8 ", min free %" PRIu8
+           ", failures %" PRIu16 "\n",
+           stats.free[BMM_CLASS_LARGE], (uint8_t)TOTAL_NUMBER_OF_LARGE_BUFS,
+           stats.min_free[BMM_CLASS_LARGE],
+           stats.alloc_failures[BMM_CLASS_LARGE]);
+#if (TOTAL_NUMBER_OF_SMALL_BUFS > 0)
+    printf(" Small: free %" PRIu8 " of %" PRIu8 ", min free %" PRIu8
+           ", failures %" PRIu16 "\n",
+           stats.free[BMM_CLASS_SMALL], (uint8_t)TOTAL_NUMBER_OF_SMALL_BUFS,
+           stats.min_free[BMM_CLASS_SMALL],
+           stats.alloc_failures[BMM_CLASS_SMALL]);
+#endif
+    for (uint8_t i = 0; i < BMM_NO_OF_OWNERS; i++)
+    {
+        printf(" %s: used %" PRIu8 ", peak %" PRIu8 "\n",
+               owner_names[i], stats.used[i], stats.peak_used[i]);
+    }
+    printf("[BUFFER_STATS_END]\n");
+}
+#endif  /* ENABLE_BMM_STATS */
+
+
+
+#ifdef ENABLE_RTB_TRACE
+/**
+ * This function displays the phase durations of the last ranging procedures
+ * and the duration histograms of all phases.
+ */
+static void rtb_eval_app_trace(void)
+{
+    static const char *const role_names[] =
+    {
+        "None", "Initiator", "Reflector", "Coordinator"
+    };
+    static const char *const hist_names[RTB_TRACE_NO_OF_HISTS] =
+    {
+        "Range Req", "Time Sync", "PMU", "Result", "Calc", "Remote", "Round"
+    };
+    rtb_trace_transaction_t trans[RTB_TRACE_MAX_TRANSACTIONS];
+    uint16_t bins[RTB_TRACE_HIST_BINS];
+    uint8_t count;
+
+    count = rtb_trace_get_transactions(trans, RTB_TRACE_MAX_TRANSACTIONS);
+
+    printf("\n[TRACE]\n");
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t total = 0;
+
+        printf(" #%" PRIu16 " %s, status %" PRIu8 "%s\n", trans[i].Seq,
+               role_names[(trans[i].Role < 4) ? trans[i].Role : 0],
+               trans[i].Status, trans[i].Complete ? "" : ", incomplete");
+        for (uint8_t phase = 0; phase < RTB_TRACE_NO_OF_PHASES; phase++)
+        {
+            if (trans[i].PhaseDuration[phase] > 0)
+            {
+                printf("  %-10s %8" PRIu32 " us\n", hist_names[phase],
+                       trans[i].PhaseDuration[phase]);
+                total += trans[i].PhaseDuration[phase];
+            }
+        }
+        printf("  %-10s %8" PRIu32 " us\n", "Total", total);
+        if (trans[i].NoOfRounds > 0)
+        {
+            printf("  Rounds %" PRIu8 ":", trans[i].NoOfRounds);
+            for (uint8_t r = 0; (r < trans[i].NoOfRounds) &&
+                 (r < RTB_TRACE_MAX_ROUNDS); r++)
+            {
+                printf(" %" PRIu32, trans[i].RoundDuration[r]);
+            }
+            printf(" us\n");
+        }
+    }
+
+    /* Bin n counts durations below 2^(n+5) us, the last bin all longer ones. */
+    printf(" Histogram [us] <32");
+    for (uint8_t b = 1; b < (RTB_TRACE_HIST_BINS - 1); b++)
+    {
+        printf(" <%" PRIu32, (uint32_t)32 << b);
+    }
+    printf(" more\n");
+    for (uint8_t h = 0; h < RTB_TRACE_NO_OF_HISTS; h++)
+    {
+        rtb_trace_get_histogram(h, bins);
+        printf("  %-10s", hist_names[h]);
+        for (uint8_t b = 0; b < RTB_TRACE_HIST_BINS; b++)
+        {
+            printf(" %" PRIu16, bins[b]);
+        }
+        printf("\n");
+    }
+    printf("[TRACE_END]\n");
+}
+#endif  /* ENABLE_RTB_TRACE */
+
+
+
 /**
  * This function displays the paramter menu.
  */
@@ -846,6 +1021,10 @@ static void rtb_eval_app_param_menu(void)
     {
         printf("Max of dist and DQF)\n");
     }
+    else if (FILT_TRACK == app_data.app_filtering_method_cont)
+    {
+        printf("Tracking of dist and speed\n");
+    }
     else
     {
         printf("Undef Filt method\n");
@@ -884,8 +1063,12 @@ static void rtb_eval_app_param_menu(void)
 //#else
 //    printf("      Distance Offset = %" PRId8 " cm\n", DISTANCE_OFFSET);
 //#endif
-    printf("  v: Verb = %" PRIu8 " [0...%" PRIu8 "]\n",
-           rtb_pib.PMUVerboseLevel, 1);
+    printf("  v: Verb = %" PRIu8 " [0...%" PRIu8 "%s]\n",
+           rtb_pib.PMUVerboseLevel, aRTBMaxPMUVerboseLevel,
+           ((aRTBMaxPMUVerboseLevel < PMU_VERBOSE_LEVEL_BINARY_DUMP) &&
+            RTB_PMU_VERBOSE_LEVEL_SUPPORTED(PMU_VERBOSE_LEVEL_BINARY_DUMP)) ? ",3" : "");
+    printf("  b: Binary Output = %" PRIu8 " [0,1]\n",
+           (uint8_t)app_output_mode);
 
     printf("\nRadio Param:\n");
     /* Print tx power settings */
@@ -898,6 +1081,37 @@ static void rtb_eval_app_param_menu(void)
                rtb_pib.ProvideRangingTransmitPower);
     }
 
+#ifdef PAL_TIMER_STATS
+    /* Print run time statistics of the timer module */
+    {
+        pal_timer_stats_t stats;
+
+        pal_timer_get_stats(&stats, false);
+
+        printf("\nTimer Stats:\n");
+        printf("     Max Crit Region = %" PRIu32 " us\n",
+               stats.max_critical_us);
+        printf("     Callback Lateness = %" PRIu32 " us avg, %" PRIu32 " us max\n",
+               (stats.callbacks > 0) ? (stats.sum_lateness_us / stats.callbacks) : 0,
+               stats.max_lateness_us);
+        printf("     Max Running Timers = %" PRIu8 "\n", stats.max_running);
+    }
+#endif
+
+#ifdef PAL_SIO_TX_RING
+    /* Print statistics of the transmit ring of the serial interface */
+    {
+        pal_sio_tx_stats_t stats;
+
+        pal_sio_tx_get_stats(SIO_CHANNEL, &stats, false);
+
+        printf("\nSIO Stats:\n");
+        printf("     Max Tx Ring Used = %" PRIu16 " bytes\n", stats.max_used);
+        printf("     Dropped = %" PRIu32 " bytes, Stalls = %" PRIu32 "\n",
+               stats.dropped, stats.stalls);
+    }
+#endif
+
     printf("[PARAM_END]\n");
 }
 
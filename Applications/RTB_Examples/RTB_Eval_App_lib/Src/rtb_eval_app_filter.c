@@ -0,0 +1,431 @@
+/**
+ * @file rtb_eval_app_filter.c
+ *
+ * @brief Incremental filters of the continuous ranging
+ *
+ * A new result replaces the oldest value of the filter window:
+ * - The sums are updated by the difference of both values, so average
+ *   and variance cost O(1). The sums are integers, so they do not drift
+ *   like a floating point running mean and variance would.
+ * - The oldest value is found in the sorted window by binary search,
+ *   and only the positions between the oldest and the new value are
+ *   shifted. Median, minimum and maximum cost O(log n).
+ * - The DQFs are counted in a histogram of CONT_FILT_DQF_MAX + 1 bins,
+ *   so their median and minimum cost at most one pass over the bins,
+ *   independent of the filtering length.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "rtb_eval_app_filter.h"
+
+/* === Macros ============================================================== */
+
+/*
+ * Variance of the distances (in cm^2) and DQFs at which the minimum
+ * variance filter weights average and minimum equally.
+ */
+#define MIN_VAR_THRESHOLD               (100.0f)
+
+/* === Prototypes ========================================================== */
+
+static uint8_t prev_pos(uint8_t pos, uint8_t offset);
+static uint8_t lower_bound(const cont_filt_t *filt, uint8_t cnt, uint32_t dist);
+static uint8_t upper_bound(const cont_filt_t *filt, uint8_t cnt, uint32_t dist);
+static void add_stats(cont_filt_t *filt, uint32_t dist, uint8_t dqf);
+static void remove_stats(cont_filt_t *filt, uint32_t dist, uint8_t dqf);
+static uint8_t dqf_at_rank(const cont_filt_t *filt, uint8_t rank);
+
+/* === Implementation ====================================================== */
+
+/* Position of the value offset results before position pos */
+static uint8_t prev_pos(uint8_t pos, uint8_t offset)
+{
+    if (pos >= offset)
+    {
+        return (pos - offset);
+    }
+
+    return (uint8_t)(pos + MAX_LEN_OF_FILTERING_CONT - offset);
+}
+
+
+
+/* Index of the first of cnt sorted values not smaller than dist */
+static uint8_t lower_bound(const cont_filt_t *filt, uint8_t cnt, uint32_t dist)
+{
+    uint8_t lo = 0;
+    uint8_t hi = cnt;
+
+    while (lo < hi)
+    {
+        uint8_t mid = lo + (hi - lo) / 2;
+
+        if (filt->dist[filt->sorted[mid]] < dist)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+
+/* Index of the first of cnt sorted values larger than dist */
+static uint8_t upper_bound(const cont_filt_t *filt, uint8_t cnt, uint32_t dist)
+{
+    uint8_t lo = 0;
+    uint8_t hi = cnt;
+
+    while (lo < hi)
+    {
+        uint8_t mid = lo + (hi - lo) / 2;
+
+        if (filt->dist[filt->sorted[mid]] <= dist)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+
+/* Adds a value to the sums and the DQF histogram. */
+static void add_stats(cont_filt_t *filt, uint32_t dist, uint8_t dqf)
+{
+    filt->dist_sum += dist;
+    filt->dist_sum_sqr += (uint64_t)dist * dist;
+    filt->dqf_sum += dqf;
+    filt->dqf_sum_sqr += (uint16_t)dqf * dqf;
+    filt->dqf_hist[dqf]++;
+}
+
+
+
+/* Removes a value from the sums and the DQF histogram. */
+static void remove_stats(cont_filt_t *filt, uint32_t dist, uint8_t dqf)
+{
+    filt->dist_sum -= dist;
+    filt->dist_sum_sqr -= (uint64_t)dist * dist;
+    filt->dqf_sum -= dqf;
+    filt->dqf_sum_sqr -= (uint16_t)dqf * dqf;
+    filt->dqf_hist[dqf]--;
+}
+
+
+
+/* DQF of the given rank (0 = smallest) within the window */
+static uint8_t dqf_at_rank(const cont_filt_t *filt, uint8_t rank)
+{
+    uint16_t cnt = 0;
+    uint8_t dqf;
+
+    for (dqf = 0; dqf < CONT_FILT_DQF_MAX; dqf++)
+    {
+        cnt += filt->dqf_hist[dqf];
+        if (cnt > rank)
+        {
+            break;
+        }
+    }
+
+    return dqf;
+}
+
+
+
+/**
+ * @brief Initializes the filter of a link with its first result
+ *
+ * All values of the filter are set to the first result.
+ *
+ * @param filt Filter of the link
+ * @param len Filtering length (1 .. MAX_LEN_OF_FILTERING_CONT)
+ * @param dist First distance in cm
+ * @param dqf First DQF in percent
+ */
+void cont_filt_init(cont_filt_t *filt, uint8_t len,
+                    uint32_t dist, uint8_t dqf)
+{
+    if (dqf > CONT_FILT_DQF_MAX)
+    {
+        dqf = CONT_FILT_DQF_MAX;
+    }
+
+    for (uint8_t i = 0; i < MAX_LEN_OF_FILTERING_CONT; i++)
+    {
+        filt->dist[i] = dist;
+        filt->dqf[i] = dqf;
+    }
+    filt->idx = 0;
+
+    cont_filt_set_len(filt, len);
+}
+
+
+
+/**
+ * @brief Changes the filtering length of a link
+ *
+ * The window is rebuilt from the last results, i.e. this costs
+ * O(n^2) once per change.
+ *
+ * @param filt Filter of the link
+ * @param len New filtering length (1 .. MAX_LEN_OF_FILTERING_CONT)
+ */
+void cont_filt_set_len(cont_filt_t *filt, uint8_t len)
+{
+    uint8_t pos;
+
+    if (len < 1)
+    {
+        len = 1;
+    }
+    else if (len > MAX_LEN_OF_FILTERING_CONT)
+    {
+        len = MAX_LEN_OF_FILTERING_CONT;
+    }
+
+    filt->len = len;
+    filt->dist_sum = 0;
+    filt->dist_sum_sqr = 0;
+    filt->dqf_sum = 0;
+    filt->dqf_sum_sqr = 0;
+    memset(filt->dqf_hist, 0, sizeof(filt->dqf_hist));
+
+    /* Insert from the oldest to the newest value. */
+    pos = prev_pos(filt->idx, len - 1);
+    for (uint8_t cnt = 0; cnt < len; cnt++)
+    {
+        uint8_t i = lower_bound(filt, cnt, filt->dist[pos]);
+
+        memmove(&filt->sorted[i + 1], &filt->sorted[i], cnt - i);
+        filt->sorted[i] = pos;
+        add_stats(filt, filt->dist[pos], filt->dqf[pos]);
+
+        pos++;
+        if (MAX_LEN_OF_FILTERING_CONT == pos)
+        {
+            pos = 0;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Adds a result to the filter of a link
+ *
+ * The result replaces the oldest value of the window.
+ *
+ * @param filt Filter of the link
+ * @param dist Distance in cm
+ * @param dqf DQF in percent
+ */
+void cont_filt_add(cont_filt_t *filt, uint32_t dist, uint8_t dqf)
+{
+    uint8_t pos = filt->idx + 1;
+    uint8_t old_pos;
+    uint32_t old_dist;
+    uint8_t r;
+    uint8_t i;
+
+    if (MAX_LEN_OF_FILTERING_CONT == pos)
+    {
+        pos = 0;
+    }
+    if (dqf > CONT_FILT_DQF_MAX)
+    {
+        dqf = CONT_FILT_DQF_MAX;
+    }
+
+    old_pos = prev_pos(pos, filt->len);
+    old_dist = filt->dist[old_pos];
+    remove_stats(filt, old_dist, filt->dqf[old_pos]);
+
+    /*
+     * The oldest value is the last one among equal distances.
+     * Both indices are searched before the new value is stored,
+     * since it may overwrite the oldest value.
+     */
+    r = upper_bound(filt, filt->len, old_dist) - 1;
+    i = lower_bound(filt, filt->len, dist);
+
+    if (i <= r)
+    {
+        memmove(&filt->sorted[i + 1], &filt->sorted[i], r - i);
+    }
+    else
+    {
+        i--;
+        memmove(&filt->sorted[r], &filt->sorted[r + 1], i - r);
+    }
+    filt->sorted[i] = pos;
+
+    filt->dist[pos] = dist;
+    filt->dqf[pos] = dqf;
+    filt->idx = pos;
+    add_stats(filt, dist, dqf);
+}
+
+
+
+/**
+ * @brief Returns a previous distance of a link
+ *
+ * @param filt Filter of the link
+ * @param offset Number of results before the newest result
+ *               (0 .. MAX_LEN_OF_FILTERING_CONT - 1)
+ *
+ * @return Distance in cm
+ */
+uint32_t cont_filt_prev_dist(const cont_filt_t *filt, uint8_t offset)
+{
+    return filt->dist[prev_pos(filt->idx, offset)];
+}
+
+
+
+/**
+ * @brief Calculates average distance and DQF of a link
+ *
+ * @param filt Filter of the link
+ * @param[out] dist Filtered distance in cm
+ * @param[out] dqf Filtered DQF in percent
+ */
+void cont_filt_aver(const cont_filt_t *filt,
+                    uint32_t *dist, uint8_t *dqf)
+{
+    *dist = filt->dist_sum / filt->len;
+    *dqf = (uint8_t)((filt->dqf_sum + filt->len / 2) / filt->len);
+}
+
+
+
+/**
+ * @brief Calculates median distance and DQF of a link
+ *
+ * For an even filtering length the mean of both middle values is taken.
+ *
+ * @param filt Filter of the link
+ * @param[out] dist Filtered distance in cm
+ * @param[out] dqf Filtered DQF in percent
+ */
+void cont_filt_median(const cont_filt_t *filt,
+                      uint32_t *dist, uint8_t *dqf)
+{
+    uint8_t median_index = filt->len / 2;
+
+    if (filt->len % 2)
+    {
+        *dist = filt->dist[filt->sorted[median_index]];
+        *dqf = dqf_at_rank(filt, median_index);
+    }
+    else
+    {
+        *dist = (filt->dist[filt->sorted[median_index - 1]] +
+                 filt->dist[filt->sorted[median_index]]) / 2;
+        *dqf = (uint8_t)(((uint16_t)dqf_at_rank(filt, median_index - 1) +
+                          dqf_at_rank(filt, median_index)) / 2);
+    }
+}
+
+
+
+/**
+ * @brief Calculates minimum distance of a link
+ *
+ * @param filt Filter of the link
+ * @param[out] dist Minimum distance in cm
+ * @param[out] dqf DQF of the newest result with minimum distance
+ */
+void cont_filt_min(const cont_filt_t *filt,
+                   uint32_t *dist, uint8_t *dqf)
+{
+    uint8_t pos = filt->sorted[0];
+
+    *dist = filt->dist[pos];
+    *dqf = filt->dqf[pos];
+}
+
+
+
+/**
+ * @brief Calculates maximum distance of a link
+ *
+ * @param filt Filter of the link
+ * @param[out] dist Maximum distance in cm
+ * @param[out] dqf DQF of the newest result with maximum distance
+ */
+void cont_filt_max(const cont_filt_t *filt,
+                   uint32_t *dist, uint8_t *dqf)
+{
+    uint32_t max_dist = filt->dist[filt->sorted[filt->len - 1]];
+    uint8_t pos = filt->sorted[lower_bound(filt, filt->len, max_dist)];
+
+    *dist = max_dist;
+    *dqf = filt->dqf[pos];
+}
+
+
+
+/**
+ * @brief Calculates distance and DQF of a link considering their variance
+ *
+ * The result is weighted between average and minimum; the larger the
+ * variance, the closer it is to the minimum.
+ *
+ * @param filt Filter of the link
+ * @param[out] dist Filtered distance in cm
+ * @param[out] dqf Filtered DQF in percent
+ */
+void cont_filt_min_var(const cont_filt_t *filt,
+                       uint32_t *dist, uint8_t *dqf)
+{
+    uint32_t dist_aver = filt->dist_sum / filt->len;
+    uint8_t dqf_aver = filt->dqf_sum / filt->len;
+    uint32_t dist_min = filt->dist[filt->sorted[0]];
+    uint8_t dqf_min = dqf_at_rank(filt, 0);
+    float dist_var;
+    float dqf_var;
+    float b;
+
+    /* Population variance: (n * sum(x^2) - sum(x)^2) / n^2 */
+    dist_var = (float)(filt->len * filt->dist_sum_sqr -
+                       (uint64_t)filt->dist_sum * filt->dist_sum) /
+               ((uint16_t)filt->len * filt->len);
+    dqf_var = (float)(filt->len * filt->dqf_sum_sqr -
+                      (uint32_t)filt->dqf_sum * filt->dqf_sum) /
+              ((uint16_t)filt->len * filt->len);
+
+    b = MIN_VAR_THRESHOLD / (MIN_VAR_THRESHOLD + dist_var);
+    *dist = (uint32_t)(b * dist_aver + (1 - b) * dist_min);
+    b = MIN_VAR_THRESHOLD / (MIN_VAR_THRESHOLD + dqf_var);
+    *dqf = (uint8_t)(b * dqf_aver + (1 - b) * dqf_min);
+}
+
+/* EOF */
@@ -27,14 +27,29 @@
 
 #define EEPROM_RECORD_OFFSET (16)
 
+#ifdef PAL_PS_STORE
+/*
+ * Time without further parameter changes after which the staged parameters
+ * are written into the EEPROM (in us).
+ */
+#define PARAM_COMMIT_DELAY_US           (1000000UL)
+#endif
+
 /* Length of buffer for user input. */
 #define LENGTH_OF_USER_INPUT_BUF        (18)//(11) //To allow long long int input
 
 /* === Globals =============================================================*/
 
+#ifdef PAL_PS_STORE
+/* Time of the last parameter change (in us). */
+static uint32_t param_change_time;
+#endif
+
 
 /* === Prototypes ==========================================================*/
 
+static bool param_record_valid(const app_data_t *record, bool whole_record);
+
 
 /* === Implementation ======================================================*/
 
@@ -42,6 +57,10 @@ void fill_range_addresses(wpan_rtb_range_req_t *wrrr, bool is_remote)
 {
     wrrr->InitiatorAddr = 0;
     wrrr->ReflectorAddr = 0;
+#ifdef ENABLE_RTB_RANGE_PROFILE
+    /* The ranging parameter are taken from the RTB PIB. */
+    wrrr->UseProfile = false;
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
 
     switch (app_data.app_addressing.range_addr_scheme)
     {
@@ -181,10 +200,10 @@ uint64_t get_longint(void)
     }
     while (1);
     
-    return atoll(buf);
+    return atoull(buf);
 }
 
-uint64_t atoll(char *instr)
+uint64_t atoull(char *instr)
 {
   uint64_t retval;
   //int i;
@@ -196,6 +215,43 @@ uint64_t atoll(char *instr)
   return retval;
 }
 
+/* Helper function to get the short addresses of the ranging nodes. */
+void get_range_short_addresses(bool was_remote,
+                               uint16_t *init_addr,
+                               uint16_t *refl_addr)
+{
+    range_addr_scheme_t scheme = app_data.app_addressing.range_addr_scheme;
+
+    if ((RANGE_INIT_SHORT_REFL_SHORT == scheme) ||
+        (RANGE_INIT_SHORT_REFL_LONG == scheme))
+    {
+        if (was_remote)
+        {
+            *init_addr = app_data.app_addressing.init_short_addr_for_rem;
+        }
+        else
+        {
+            *init_addr = tal_pib.ShortAddress;
+        }
+    }
+    else
+    {
+        *init_addr = RESULT_ADDR_LONG;
+    }
+
+    if ((RANGE_INIT_SHORT_REFL_SHORT == scheme) ||
+        (RANGE_INIT_LONG_REFL_SHORT == scheme))
+    {
+        *refl_addr = app_data.app_addressing.refl_short_addr;
+    }
+    else
+    {
+        *refl_addr = RESULT_ADDR_LONG;
+    }
+}
+
+
+
 void print_range_addresses(bool was_remote)
 {
     switch (app_data.app_addressing.range_addr_scheme)
@@ -277,26 +333,82 @@ void print_range_addresses(bool was_remote)
 
 
 
+/**
+ * @brief Checks the CRC of a stored parameter record
+ *
+ * @param record Stored parameter record
+ * @param whole_record true to check the CRC over the whole record as written
+ *                     by former versions, false to check it over the data
+ *                     preceding the CRC
+ *
+ * @return true if the CRC is valid
+ */
+static bool param_record_valid(const app_data_t *record, bool whole_record)
+{
+    const uint8_t *p = (const uint8_t *)record;
+    uint16_t crc16 = 0;
+    uint8_t i;
+
+    if (whole_record)
+    {
+        /* The CRC over the data and the CRC itself results in 0. */
+        for (i = 0; i < sizeof(app_data_t); i++)
+        {
+            crc16 = CRC_CCITT_UPDATE(crc16, *p++);
+        }
+
+        return (0 == crc16);
+    }
+
+    /* Padding following the CRC (on the host) is not covered. */
+    for (i = 0; i < offsetof(app_data_t, crc); i++)
+    {
+        crc16 = CRC_CCITT_UPDATE(crc16, *p++);
+    }
+
+    return (crc16 == record->crc);
+}
+
+
+
 bool range_load_param(void)
 {
     app_data_t stored_app_data;
     bool ret;
-    uint8_t *p, i;
 
+#ifdef PAL_PS_STORE
+    if (MAC_SUCCESS == pal_ps_store_load(&stored_app_data, sizeof(stored_app_data)))
+    {
+        ret = param_record_valid(&stored_app_data, false);
+    }
+    else if ((FAILURE != pal_ps_get(INTERN_EEPROM, EEPROM_RECORD_OFFSET,
+                                    sizeof(stored_app_data), &stored_app_data)) &&
+             param_record_valid(&stored_app_data, true))
+    {
+        /*
+         * The record store is still empty, so take over the record written
+         * by former versions into the record store once.
+         */
+        pal_ps_store_save(&stored_app_data, sizeof(stored_app_data));
+        pal_ps_store_commit();
+        ret = true;
+    }
+    else
+    {
+        ret = false;
+    }
+#else
     if (FAILURE == pal_ps_get(INTERN_EEPROM, EEPROM_RECORD_OFFSET, sizeof(stored_app_data), &stored_app_data))
     {
         return false;
     }
 
-    uint16_t crc16 = 0;
-    p = (uint8_t *) &stored_app_data;
-
-    for (i = 0; i < sizeof(stored_app_data); i++)
-    {
-        crc16 = CRC_CCITT_UPDATE(crc16, *p++);
-    }
+    /* Also accept a record written by former versions. */
+    ret = (param_record_valid(&stored_app_data, false) ||
+           param_record_valid(&stored_app_data, true));
+#endif
 
-    if (crc16 == 0)
+    if (ret)
     {
         /* Update application data. */
         memcpy(&app_data, &stored_app_data, sizeof(app_data_t));
@@ -311,12 +423,6 @@ bool range_load_param(void)
         mlme_set(macPANId, (pib_value_t *) & (stored_app_data.app_addressing.pan_id), false);
         /* Set new own short address. */
         mlme_set(macShortAddress, (pib_value_t *) & (stored_app_data.app_addressing.own_short_addr), false);
-
-        ret = true;
-    }
-    else
-    {
-        ret = false;
     }
 
     return ret;
@@ -388,15 +494,44 @@ void range_store_param(void)
 
     app_data_to_be_stored.crc = 0;
 
-    for (i = 0; i < sizeof(app_data_to_be_stored) - sizeof(app_data_to_be_stored.crc); i++)
+    for (i = 0; i < offsetof(app_data_t, crc); i++)
     {
         app_data_to_be_stored.crc = CRC_CCITT_UPDATE(app_data_to_be_stored.crc, *p++);
     }
 
+#ifdef PAL_PS_STORE
+    /* The record is written by range_commit_param() once the node is idle. */
+    pal_ps_store_save(&app_data_to_be_stored, sizeof(app_data_to_be_stored));
+    pal_get_current_time(&param_change_time);
+#else
     pal_ps_set (EEPROM_RECORD_OFFSET,
                 sizeof(app_data_to_be_stored),
                 &app_data_to_be_stored);
+#endif
+}
+
+
+
+#ifdef PAL_PS_STORE
+void range_commit_param(void)
+{
+    uint32_t now;
+
+    if (!pal_ps_store_pending() || (APP_IDLE != app_state) || cont_ranging_ongoing)
+    {
+        return;
+    }
+
+    /* Further changes of the parameters are collected into the same write. */
+    pal_get_current_time(&now);
+    if (pal_sub_time_us(now, param_change_time) < PARAM_COMMIT_DELAY_US)
+    {
+        return;
+    }
+
+    pal_ps_store_commit();
 }
+#endif  /* PAL_PS_STORE */
 
 
 
@@ -546,11 +681,12 @@ bool set_filtering_method_cont(void)
     printf("  2: Minimum of distance and DQF)\n");
     printf("  3: Minimum of distance and DQF considerung variance)\n");
     printf("  4: Maximum of distance and DQF)\n");
+    printf("  5: Tracking of distance and speed\n");
     printf("Enter new Filtering Method [%" PRIu8 "...%" PRIu8 "]",
            (uint8_t)FILT_AVER,
-           (uint8_t)FILT_MAX);
+           (uint8_t)FILT_TRACK);
     input = get_int();
-    if ((input < FILT_AVER) || (input > FILT_MAX))
+    if ((input < FILT_AVER) || (input > FILT_TRACK))
     {
         /* In case of erroneous input set filtering method. to average filtering. */
         input = FILT_AVER;
@@ -733,7 +869,7 @@ bool set_verbose_level(void)
 
     printf("Verbose level:");
     input = get_int() & 0xFF;
-    if ((input >= 0) && (input <= 1))
+    if ((input >= 0) && RTB_PMU_VERBOSE_LEVEL_SUPPORTED(input))
     {
         rtb_set(RTB_PIB_PMU_VERBOSE_LEVEL, (pib_value_t *)&input, false);
         return true;
@@ -744,6 +880,97 @@ bool set_verbose_level(void)
 
 
 
+bool set_output_mode(void)
+{
+    int input;
+
+    printf("Output mode (0 = text, 1 = binary):");
+    input = get_int();
+    if ((input == OUTPUT_TEXT) || (input == OUTPUT_BINARY))
+    {
+        app_output_mode = (output_mode_t)input;
+        return true;
+    }
+
+    return false;
+}
+
+
+
+#ifdef ENABLE_RTB_ADAPTIVE
+void set_adaptive_sweep(void)
+{
+    rtb_adaptive_config_t config;
+    rtb_adaptive_stats_t stats;
+    int input;
+
+    rtb_adaptive_get_stats(&stats);
+    printf("Local rangings %" PRIu32 ", dense sweeps %" PRIu32
+           ", frequencies per ranging %" PRIu32 "\n",
+           stats.NoOfRangings, stats.NoOfDenseSweeps,
+           (stats.NoOfRangings > 0) ?
+           (stats.NoOfFrequencies / stats.NoOfRangings) : (uint32_t)0);
+
+    printf("Adaptive sweep DQF threshold (0 = off):");
+    input = get_int();
+    if ((input < 0) || (input > 100))
+    {
+        return;
+    }
+
+    /* The configuration is not stored in EEPROM. */
+    config.Enabled = (input > 0);
+    config.DQFThreshold = (uint8_t)input;
+    config.MinValidPercent = ADAPTIVE_MIN_VALID_PERCENT;
+    config.DenseFreqStep = PMU_STEP_FREQ_500kHz;
+    rtb_adaptive_set_config(&config);
+}
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+
+
+#ifdef ENABLE_RTB_SPECTRUM
+void set_spectrum_monitor(void)
+{
+    rtb_spectrum_config_t config;
+    rtb_spectrum_stats_t stats;
+    uint8_t ed_levels[RTB_SPECTRUM_NO_OF_BLOCKS];
+    int input;
+
+    rtb_spectrum_get_stats(&stats);
+    printf("ED scans %" PRIu32 ", rangings %" PRIu32 ", reduced %" PRIu32
+           ", skipped frequencies %" PRIu32 "\n",
+           stats.NoOfScans, stats.NoOfRangings, stats.NoOfReducedPlans,
+           stats.NoOfSkippedFrequencies);
+
+    /* Only the blocks scanned so far have an energy level. */
+    rtb_spectrum_get_map(ed_levels);
+    for (uint8_t i = 0; i < RTB_SPECTRUM_NO_OF_BLOCKS; i++)
+    {
+        if (ed_levels[i] > 0)
+        {
+            printf("%u MHz: ED %u\n",
+                   PMU_MIN_FREQ + i * RTB_SPECTRUM_BLOCK_MHZ, ed_levels[i]);
+        }
+    }
+
+    printf("Spectrum monitor ED threshold (0 = off):");
+    input = get_int();
+    if ((input < 0) || (input > 255))
+    {
+        return;
+    }
+
+    /* The configuration is not stored in EEPROM. */
+    config.Enabled = (input > 0);
+    config.EDThreshold = (uint8_t)input;
+    config.ScanInterval = SPECTRUM_SCAN_INTERVAL_MS;
+    rtb_spectrum_set_config(&config);
+}
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+
+
 /* Helper function for actual PIB writing. */
 void write_pib(void)
 {
@@ -50,18 +50,17 @@ typedef enum distance_error_tag
 
 /* === Globals ============================================================= */
 
-static const float THRESHOLD = 100.0;   /* In case the distance is measured in cm */
 /*
  * Status variable indicating whether at least one successful ranging
  * measurements during a continuous ranging has been received.
  */
 static bool fill_status = false;
-/* Index during a continuous ranging. */
-static uint8_t ranging_array_idx = 0;
-/* Array to hold the ranging distance results during a continuous ranging. */
-static uint32_t dist_array[MAX_LEN_OF_FILTERING_CONT];
-/* Array to hold the ranging DQF results during a continuous ranging. */
-static uint8_t dqf_array[MAX_LEN_OF_FILTERING_CONT];
+/* Index into the speed history array during a continuous ranging. */
+static uint8_t speed_array_idx = 0;
+/* Filter holding the ranging results during a continuous ranging. */
+static cont_filt_t cont_filt;
+/* Tracker of distance and speed during a continuous ranging. */
+static cont_track_t cont_track;
 /* Filtered distance for continuous ranging. */
 static uint32_t dist_filt = 0;
 /* Filtered DQF for continuous ranging. */
@@ -83,352 +82,47 @@ static distance_error_t last_error = DIST_OK;
  * timestamp history array.
  */
 static uint16_t time_diff_dist_ms;
+/* Sequence number of the binary result frames. */
+static uint16_t result_frame_seq = 0;
 
 /* === Prototypes ========================================================== */
 
 static void calc_distance_history(void);
-static void calc_filt_aver(uint8_t filter_len);
-static void calc_filt_max(uint8_t filter_len);
-static void calc_filt_median(uint8_t filter_len);
-static void calc_filt_min(uint8_t filter_len);
-static void calc_filt_min_var(uint8_t filter_len);
-static void calc_filt_distance_and_dqf(uint8_t filter_len);
+static void calc_filt_distance_and_dqf(void);
 static distance_error_t check_distance(uint32_t curr_distance,
                                        uint8_t curr_dqf,
                                        uint32_t *curr_checked_dist,
                                        uint16_t curr_time_diff_dist);
-static uint32_t get_median_dist(uint32_t *temp_dist_array,
-                                uint8_t len_of_dist_array);
-static uint8_t get_median_dqf(uint8_t *temp_dqf_array,
-                              uint8_t len_of_dqf_array);
-static int compare_uin32_t(const void *f1, const void *f2);
+static void send_result_frame(uint8_t flags,
+                              uint8_t status,
+                              uint32_t distance,
+                              uint8_t dqf,
+                              uint8_t no_of_meas_pairs,
+                              measurement_pair_t *meas_pairs);
 
 /* === Externals =========================================================== */
 
 
 /* === Implementation ====================================================== */
 
-/* Helper function to calculate a previous array index. */
-FORCE_INLINE(uint8_t, calc_prev_array_idx, uint8_t curr_idx, uint8_t offset, uint8_t arr_len)
-{
-    uint8_t temp_idx = curr_idx - offset;
-    uint8_t temp_idx_2 = temp_idx % arr_len;
-    return temp_idx_2;
-}
-
-
-
-/* Implements required compare function fpr uint32_t variables for qsort(). */
-static int compare_uin32_t(const void *f1, const void *f2)
-{
-    return ( *(uint32_t *)f1 > *(uint32_t *)f2) ? 1 : -1;
-}
-
-/* Returns median distance. */
-static uint32_t get_median_dist(uint32_t *temp_dist_array,
-                                uint8_t len_of_dist_array)
-{
-    uint8_t median_index = len_of_dist_array / 2;
-
-    /* First sort the distance array. */
-    qsort(temp_dist_array, len_of_dist_array, sizeof(uint32_t), compare_uin32_t);
-
-    /* Get actual median distance value. */
-    if (len_of_dist_array % 2)
-    {
-        /*
-         * Odd number of distance values, so the median is the
-         * value in the middle of the sorted array.
-         */
-        return temp_dist_array[median_index];
-    }
-    else
-    {
-        /*
-         * Even number of distance values, so the median is to be calculated.
-         */
-        uint32_t temp = temp_dist_array[median_index - 1] + temp_dist_array[median_index];
-        return (temp / 2);
-    }
-}
-
-
-
-static uint8_t get_median_dqf(uint8_t *temp_dqf_array,
-                              uint8_t len_of_dqf_array)
-{
-    uint8_t median_index = len_of_dqf_array / 2;
-
-    /* First sort the distance array. */
-    qsort(temp_dqf_array, len_of_dqf_array, sizeof(uint8_t), compare_uin32_t);
-
-    /* Get actual median distance value. */
-    if (len_of_dqf_array % 2)
-    {
-        /*
-         * Odd number of distance values, so the median is the
-         * value in the middle of the sorted array.
-         */
-        return temp_dqf_array[median_index];
-    }
-    else
-    {
-        /*
-         * Even number of distance values, so the median is to be calculated.
-         */
-        uint32_t temp = temp_dqf_array[median_index - 1] + temp_dqf_array[median_index];
-        return (temp / 2);
-    }
-}
-
-
-
 /*
  * Helper function to calculate distance history array values
  * for speed calculation.
  */
 static void calc_distance_history(void)
 {
-    dist_history[0] = (dist_array[ranging_array_idx] +
-                       dist_array[calc_prev_array_idx(ranging_array_idx, 1, MAX_LEN_OF_FILTERING_CONT)])
+    dist_history[0] = (cont_filt_prev_dist(&cont_filt, 0) +
+                       cont_filt_prev_dist(&cont_filt, 1))
                       / 2;
-    dist_history[1] = (dist_array[calc_prev_array_idx(ranging_array_idx, 2, MAX_LEN_OF_FILTERING_CONT)] +
-                       dist_array[calc_prev_array_idx(ranging_array_idx, 3, MAX_LEN_OF_FILTERING_CONT)])
+    dist_history[1] = (cont_filt_prev_dist(&cont_filt, 2) +
+                       cont_filt_prev_dist(&cont_filt, 3))
                       / 2;
 }
 
 
 
-/* Helper function to calculate average distance and DQF. */
-static void calc_filt_aver(uint8_t filter_len)
-{
-    /* No. of result values in array to be considered for filtering. */
-    uint8_t index_cnt = filter_len;
-    /* Start index in result array for filtering. */
-    uint8_t curr_array_idx = ranging_array_idx;
-    /* Sum of distances during calculation. */
-    uint32_t dist_sum = 0;
-    /* Sum of dqfs during calculation. */
-    uint16_t dqf_sum = 0;
-
-    while (index_cnt)
-    {
-        dist_sum += dist_array[curr_array_idx];
-        dqf_sum += dqf_array[curr_array_idx];
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-    dist_filt = dist_sum / filter_len;
-    dqf_filt = (uint8_t)(round((float)dqf_sum / filter_len));
-}
-
-
-
-/* Helper function to calculate median distance and DQF. */
-static void calc_filt_median(uint8_t filter_len)
-{
-    /* No. of result values in array to be considered for filtering. */
-    uint8_t index_cnt = filter_len;
-    /* Start index in result array for filtering. */
-    uint8_t curr_array_idx = ranging_array_idx;
-    /* Local copy of distance and DQF arrays. */
-    uint32_t temp_distance_array[MAX_LEN_OF_FILTERING_CONT];
-    uint8_t temp_dqf_array[MAX_LEN_OF_FILTERING_CONT];
-
-    /*
-     * Create a temp copy of the distance and DQF value arrays in order
-     * be able to sort and find the median.
-     */
-    while (index_cnt)
-    {
-        temp_distance_array[index_cnt - 1] = dist_array[curr_array_idx];
-        temp_dqf_array[index_cnt - 1] = dqf_array[curr_array_idx];
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-    /* Now sort the distances and DQFs within the temp array. */
-    dist_filt = get_median_dist(temp_distance_array, filter_len);
-    dqf_filt = get_median_dqf(temp_dqf_array, filter_len);
-}
-
-
-
-/* Helper function to calculate minimum distance and DQF. */
-static void calc_filt_min(uint8_t filter_len)
-{
-    /* No. of result values in array to be considered for filtering. */
-    uint8_t index_cnt = filter_len;
-    /* Start index in result array for filtering. */
-    uint8_t curr_array_idx = ranging_array_idx;
-    /* Min. distances during calculation. */
-    uint32_t temp_dist = (uint32_t) - 1;
-    /* Min. of dqfs during calculation. */
-    uint8_t temp_dqf = 100;
-
-    while (index_cnt)
-    {
-        if (dist_array[curr_array_idx] < temp_dist)
-        {
-            /* Store new minimum distance value. */
-            temp_dist = dist_array[curr_array_idx];
-            /* Store the DQF of the new minimum distance value. */
-            temp_dqf = dqf_array[curr_array_idx];
-        }
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-    dist_filt = temp_dist;
-    dqf_filt = temp_dqf;
-}
-
-
-
-/* Helper function to calculate minimum distance and DQF considering variance. */
-static void calc_filt_min_var(uint8_t filter_len)
-{
-    /* No. of result values in array to be considered for filtering. */
-    uint8_t index_cnt = filter_len;
-    /* Start index in result array for filtering. */
-    uint8_t curr_array_idx = ranging_array_idx;
-
-    /* Min. distances during calculation. */
-    uint32_t dist_min = (uint32_t) - 1;
-    uint32_t dist_aver, dist_deviation, dist_var;
-    uint32_t dist_sum = 0;
-    uint32_t dist_sum_sqr = 0;
-
-    /* Min. of DQFs during calculation. */
-    uint8_t dqf_min = 100;
-    uint8_t dqf_aver, dqf_deviation, dqf_var;
-    uint16_t dqf_sum = 0;
-    uint16_t dqf_sum_sqr = 0;
-
-    float b;
-
-    while (index_cnt)
-    {
-        if (dist_array[curr_array_idx] < dist_min)
-        {
-            /* Store new minimum distance value. */
-            dist_min = dist_array[curr_array_idx];
-        }
-        if (dqf_array[curr_array_idx] < dqf_min)
-        {
-            /* Store new minimum DQF value. */
-            dqf_min = dqf_array[curr_array_idx];
-        }
-
-        /* Calculate sum of distance values for mean distance value. */
-        dist_sum += dist_array[curr_array_idx];
-        /* Calculate sum of DQF values for mean DQF value. */
-        dqf_sum += dqf_array[curr_array_idx];
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-
-    /* Mean distance value */
-    dist_aver = dist_sum / filter_len;
-    /* Mean DQF value */
-    dqf_aver = dqf_sum / filter_len;
-
-
-    /* Calculate variance */
-    curr_array_idx = ranging_array_idx;
-
-    while (index_cnt)
-    {
-        dist_deviation = dist_array[curr_array_idx] - dist_aver;
-        dist_sum_sqr += dist_deviation * dist_deviation;
-
-        dqf_deviation = dqf_array[curr_array_idx] - dqf_aver;
-        dqf_sum_sqr += dqf_deviation * dqf_deviation;
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-    dist_var = dist_sum_sqr / filter_len;
-    dqf_var = dqf_sum_sqr / filter_len;
-
-    b = THRESHOLD / (THRESHOLD + dist_var);
-    dist_filt = (uint32_t)(b * dist_aver + (1 - b) * dist_min);
-    b = THRESHOLD / (THRESHOLD + dqf_var);
-    dqf_filt = (uint32_t)(b * dqf_aver + (1 - b) * dqf_min);
-}
-
-
-
-/* Helper function to calculate minimum distance and DQF. */
-static void calc_filt_max(uint8_t filter_len)
-{
-    /* No. of result values in array to be considered for filtering. */
-    uint8_t index_cnt = filter_len;
-    /* Start index in result array for filtering. */
-    uint8_t curr_array_idx = ranging_array_idx;
-    /* Min. distances during calculation. */
-    uint32_t temp_dist = 0;
-    /* Min. of dqfs during calculation. */
-    uint8_t temp_dqf = 0;
-
-    while (index_cnt)
-    {
-        if (dist_array[curr_array_idx] > temp_dist)
-        {
-            /* Store new maximum distance value. */
-            temp_dist = dist_array[curr_array_idx];
-            /* Store the DQF of the new maximum distance value. */
-            temp_dqf = dqf_array[curr_array_idx];
-        }
-
-        if (curr_array_idx == 0)
-        {
-            /* Perform wrap-around. */
-            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
-        }
-        curr_array_idx--;
-        index_cnt--;
-    }
-
-    dist_filt = temp_dist;
-    dqf_filt = temp_dqf;
-}
-
-
-
-static void calc_filt_distance_and_dqf(uint8_t filter_len)
+/* Helper function to get the filtered distance and DQF. */
+static void calc_filt_distance_and_dqf(void)
 {
     /* Check current filter method. */
     switch (app_data.app_filtering_method_cont)
@@ -436,27 +130,33 @@ static void calc_filt_distance_and_dqf(uint8_t filter_len)
         case FILT_AVER:
         default:
             /* Average of distance and DQF */
-            calc_filt_aver(filter_len);
+            cont_filt_aver(&cont_filt, &dist_filt, &dqf_filt);
             break;
 
         case FILT_MEDIAN:
             /* Median of distance and DQF */
-            calc_filt_median(filter_len);
+            cont_filt_median(&cont_filt, &dist_filt, &dqf_filt);
             break;
 
         case FILT_MIN:
             /* Minimum of distance and DQF */
-            calc_filt_min(filter_len);
+            cont_filt_min(&cont_filt, &dist_filt, &dqf_filt);
             break;
 
         case FILT_MIN_VAR:
             /* Minimum of distance and DQF considerung variance */
-            calc_filt_min_var(filter_len);
+            cont_filt_min_var(&cont_filt, &dist_filt, &dqf_filt);
             break;
 
         case FILT_MAX:
             /* Maximum of distance and DQF */
-            calc_filt_max(filter_len);
+            cont_filt_max(&cont_filt, &dist_filt, &dqf_filt);
+            break;
+
+        case FILT_TRACK:
+            /* Tracked distance and DQF of its variance */
+            dist_filt = cont_track_dist(&cont_track);
+            dqf_filt = cont_track_dqf(&cont_track);
             break;
     }
 }
@@ -533,6 +233,87 @@ static distance_error_t check_distance(uint32_t curr_distance,
 
 
 
+/**
+ * @brief Sends the result of a range confirm as binary result frame
+ *
+ * The frame format is described in rtb_eval_app_param.h.
+ *
+ * @param flags Flags of the result (RESULT_FLAG_xxx)
+ * @param status Status of the range confirm
+ * @param distance Distance in cm
+ * @param dqf DQF in percent
+ * @param no_of_meas_pairs Number of measurement pairs
+ * @param meas_pairs Pointer to the measurement pairs
+ */
+static void send_result_frame(uint8_t flags,
+                              uint8_t status,
+                              uint32_t distance,
+                              uint8_t dqf,
+                              uint8_t no_of_meas_pairs,
+                              measurement_pair_t *meas_pairs)
+{
+    uint8_t frame[4 + RESULT_FRAME_FIXED_LEN +
+                  RESULT_FRAME_MAX_PAIRS * RESULT_FRAME_PAIR_LEN + 2];
+    uint8_t *ptr = frame;
+    uint16_t len;
+    uint16_t crc = RESULT_FRAME_CRC_INIT;
+    uint16_t init_addr;
+    uint16_t refl_addr;
+    uint32_t curr_time = 0;
+
+    if ((NULL == meas_pairs) || (no_of_meas_pairs > RESULT_FRAME_MAX_PAIRS))
+    {
+        no_of_meas_pairs = (NULL == meas_pairs) ? 0 : RESULT_FRAME_MAX_PAIRS;
+    }
+    len = RESULT_FRAME_FIXED_LEN + no_of_meas_pairs * RESULT_FRAME_PAIR_LEN;
+
+    pal_get_current_time(&curr_time);
+    get_range_short_addresses((flags & RESULT_FLAG_REMOTE) != 0,
+                              &init_addr,
+                              &refl_addr);
+    flags |= (uint8_t)(app_data.app_addressing.range_addr_scheme <<
+                       RESULT_FLAG_ADDR_SCHEME_POS);
+
+    *ptr++ = RESULT_FRAME_SYNC_0;
+    *ptr++ = RESULT_FRAME_SYNC_1;
+    *ptr++ = (uint8_t)len;
+    *ptr++ = (uint8_t)(len >> 8);
+    *ptr++ = RESULT_FRAME_TYPE;
+    *ptr++ = (uint8_t)result_frame_seq;
+    *ptr++ = (uint8_t)(result_frame_seq >> 8);
+    *ptr++ = status;
+    convert_32_bit_to_byte_array(distance, ptr);
+    ptr += sizeof(uint32_t);
+    *ptr++ = dqf;
+    convert_32_bit_to_byte_array(curr_time, ptr);
+    ptr += sizeof(uint32_t);
+    *ptr++ = flags;
+    *ptr++ = (uint8_t)init_addr;
+    *ptr++ = (uint8_t)(init_addr >> 8);
+    *ptr++ = (uint8_t)refl_addr;
+    *ptr++ = (uint8_t)(refl_addr >> 8);
+    *ptr++ = no_of_meas_pairs;
+    for (uint8_t i = 0; i < no_of_meas_pairs; i++)
+    {
+        convert_32_bit_to_byte_array(meas_pairs[i].distance, ptr);
+        ptr += sizeof(uint32_t);
+        *ptr++ = meas_pairs[i].dqf;
+    }
+    result_frame_seq++;
+
+    /* The sync octets are not covered by the CRC. */
+    for (uint8_t *p = &frame[2]; p < ptr; p++)
+    {
+        crc = CRC_CCITT_UPDATE(crc, *p);
+    }
+    *ptr++ = (uint8_t)crc;
+    *ptr++ = (uint8_t)(crc >> 8);
+
+    sio_binarywrite(frame, (int16_t)(ptr - frame));
+}
+
+
+
 void continue_ranging(bool is_remote,
                       app_state_t next_app_state)
 {
@@ -590,6 +371,17 @@ void handle_range_conf(bool was_remote,
                        uint8_t no_of_provided_meas_pairs,
                        measurement_pair_t *provided_meas_pairs)
 {
+    if (OUTPUT_BINARY == app_output_mode)
+    {
+        send_result_frame(was_remote ? RESULT_FLAG_REMOTE : 0,
+                          status,
+                          distance,
+                          dqf,
+                          no_of_provided_meas_pairs,
+                          provided_meas_pairs);
+        return;
+    }
+
     if (RTB_SUCCESS == status)
     {
         /* Python oriented formatting. */
@@ -664,20 +456,18 @@ void handle_cont_ranging_res(uint8_t status,
             fill_status = true;
 
             /* In case this was the first successful ranging,
-             * the complete array is filled up (with MAX_LEN_OF_FILTERING_CONT
+             * the complete filter is filled up (with MAX_LEN_OF_FILTERING_CONT
              * values) taking always the first received results.
              */
-            for (uint8_t index = 0;
-                 index < MAX_LEN_OF_FILTERING_CONT;
-                 index++)
-            {
-                dist_array[index] = distance;
-                dqf_array[index] = dqf;
-            }
+            cont_filt_init(&cont_filt,
+                           app_data.app_filtering_len_cont,
+                           distance,
+                           dqf);
+            cont_track_init(&cont_track, distance, dqf);
 
             /* Initialize the filtered distance and DQF values. */
-            dist_filt = dist_array[0];
-            dqf_filt = dqf_array[0];
+            dist_filt = distance;
+            dqf_filt = dqf;
 
             /*
              * Initialize the (not yet initialized portion of the)
@@ -696,13 +486,16 @@ void handle_cont_ranging_res(uint8_t status,
         else
         {
             /* No successful ranging so far. */
-            printf("Err: T\n");
+            if (OUTPUT_TEXT == app_output_mode)
+            {
+                printf("Err: T\n");
+            }
         }
     }
     else
     {
         uint8_t prev_time_history_idx;
-        char dir;
+        uint32_t checked_dist;
 
         if (time_history_idx == 0)
         {
@@ -720,17 +513,50 @@ void handle_cont_ranging_res(uint8_t status,
 
         /*
          * The first successful ranging has already been received, so
-         * add the received values to the existing arrays.
+         * add the received values to the existing filter.
          * For the distance some sanity calculations are done.
          */
-        /* Write next distance value into distance array. */
         last_error = check_distance(distance,
                                     dqf,
-                                    &dist_array[ranging_array_idx],
+                                    &checked_dist,
                                     time_diff_dist_ms);
 
-        /* Write next DQF value into DQF array. */
-        dqf_array[ranging_array_idx] = dqf;
+        /* The filtering length may have been changed meanwhile. */
+        if (app_data.app_filtering_len_cont != cont_filt.len)
+        {
+            cont_filt_set_len(&cont_filt, app_data.app_filtering_len_cont);
+        }
+
+        /* Add next distance and DQF value to the filter. */
+        cont_filt_add(&cont_filt, checked_dist, dqf);
+
+        /*
+         * The tracker runs with every result, so it is up to date once
+         * it is selected. It takes the unchecked distance weighted by
+         * its DQF and applies its own gate instead of the speed limit.
+         */
+        cont_track_predict(&cont_track, time_diff_dist_ms);
+        if ((TRANSACT_ERROR != last_error) && (DQF_TOO_LOW != last_error))
+        {
+            cont_track_status_t track_status =
+                cont_track_correct(&cont_track, distance, dqf);
+
+            if (FILT_TRACK == app_data.app_filtering_method_cont)
+            {
+                if (TRACK_REJECTED != track_status)
+                {
+                    last_error = DIST_OK;
+                }
+                else if (distance > cont_track_dist(&cont_track))
+                {
+                    last_error = DIST_TOO_LONG;
+                }
+                else
+                {
+                    last_error = DIST_TOO_SHORT;
+                }
+            }
+        }
 
         /*
          * Calculate the distance history values for speed calculation
@@ -742,15 +568,20 @@ void handle_cont_ranging_res(uint8_t status,
          * Calculate filtered distance and DQF
          * based on current filter method.
          */
-        calc_filt_distance_and_dqf(app_data.app_filtering_len_cont);
+        calc_filt_distance_and_dqf();
 
-        if (time_diff_dist_ms != 0)
+        if (FILT_TRACK == app_data.app_filtering_method_cont)
+        {
+            /* The tracker estimates the speed without floating point. */
+            speed_filt = cont_track_speed_kmh(&cont_track);
+        }
+        else if (time_diff_dist_ms != 0)
         {
             float speed_array_sum = 0.0;
             /* Speed estimation done in km/h derived from cm/ms. */
             float dist_float = (int32_t)(dist_history[0] - dist_history[1]);
 
-            speed_array[ranging_array_idx % SPEED_HISTORY_LEN] =
+            speed_array[speed_array_idx] =
                 dist_float / time_diff_dist_ms * 36;
 
             /* Calculate mean value of speed history array. */
@@ -765,65 +596,71 @@ void handle_cont_ranging_res(uint8_t status,
             speed_filt = 0;
         }
 
-        /* Get direction of node. */
-        if (speed_filt < -1)
+        /* Print results; binary result frames are sent by the caller. */
+        if (OUTPUT_TEXT == app_output_mode)
         {
-            dir = 'A';  /* Node approaches */
-        }
-        else if (speed_filt > 1)
-        {
-            dir = 'L';  /* Node leaves */
-        }
-        else
-        {
-            dir = ' ';   /* Constant node position */
-        }
+            char dir;
+
+            /* Get direction of node. */
+            if (speed_filt < -1)
+            {
+                dir = 'A';  /* Node approaches */
+            }
+            else if (speed_filt > 1)
+            {
+                dir = 'L';  /* Node leaves */
+            }
+            else
+            {
+                dir = ' ';   /* Constant node position */
+            }
 
-        /* Print results. */
-        printf("Dist: %5" PRIu32 "cm| Spd: %2" PRIi8 "| Dir: %c| DQF: %3" PRIu8 "%%| Dur: %3" PRIu16 "ms",
-               dist_filt,
-               speed_filt,
-               dir,
-               dqf_filt,
-               time_diff_dist_ms);
+            /* Print results. */
+            printf("Dist: %5" PRIu32 "cm| Spd: %2" PRIi8 "| Dir: %c| DQF: %3" PRIu8 "%%| Dur: %3" PRIu16 "ms",
+                   dist_filt,
+                   speed_filt,
+                   dir,
+                   dqf_filt,
+                   time_diff_dist_ms);
 
-        if (DIST_OK != last_error)
-        {
-            printf("| Err: ");
-        }
+            if (DIST_OK != last_error)
+            {
+                printf("| Err: ");
+            }
 
-        switch (last_error)
-        {
-            case (DIST_OK):
-            default:
-                printf(" ");
-                break;
-
-            case (TRANSACT_ERROR):
-                printf("T");
-                break;
-
-            case (DQF_TOO_LOW):
-                printf("D");
-                break;
-
-            case (DIST_TOO_SHORT):
-                printf("S");
-                break;
-
-            case (DIST_TOO_LONG):
-                printf("L");
-                break;
-        }
+            switch (last_error)
+            {
+                case (DIST_OK):
+                default:
+                    printf(" ");
+                    break;
+
+                case (TRANSACT_ERROR):
+                    printf("T");
+                    break;
+
+                case (DQF_TOO_LOW):
+                    printf("D");
+                    break;
+
+                case (DIST_TOO_SHORT):
+                    printf("S");
+                    break;
+
+                case (DIST_TOO_LONG):
+                    printf("L");
+                    break;
+            }
 
-        printf("\n");
+            printf("\n");
+        }
 
-        /* Update ranging array index. */
-        ranging_array_idx++;
-        if (ranging_array_idx == MAX_LEN_OF_FILTERING_CONT)
+        /* Update speed history array index. */
+        speed_array_idx++;
+        if (speed_array_idx == SPEED_HISTORY_LEN)
         {
-            /* Reset ranging array index if overflow happened. */
-            ranging_array_idx = 0;
+            /* Reset speed history array index if overflow happened. */
+            speed_array_idx = 0;
         }
 
         /* Update timestamp history array index. */
@@ -841,13 +678,41 @@ void handle_cont_range_conf(uint8_t status,
                             uint32_t distance,
                             uint8_t dqf)
 {
+    uint32_t period_ms = CONT_RANGING_PERIOD_MS;
+
     handle_cont_ranging_res(status,
                             distance,
                             dqf);
 
+    if (OUTPUT_BINARY == app_output_mode)
+    {
+        /*
+         * The filtered result is sent as distance and DQF,
+         * the result of this ranging as measurement pair.
+         */
+        measurement_pair_t curr_result;
+        uint8_t flags = RESULT_FLAG_CONTINUOUS;
+
+        curr_result.distance = distance;
+        curr_result.dqf = dqf;
+        if (APP_CONT_REMOTE_RANGING_ONGOING == app_state)
+        {
+            flags |= RESULT_FLAG_REMOTE;
+        }
+        send_result_frame(flags,
+                          status,
+                          fill_status ? dist_filt : distance,
+                          fill_status ? dqf_filt : dqf,
+                          1,
+                          &curr_result);
+
+        /* A few octets per ranging allow a shorter ranging period. */
+        period_ms = CONT_RANGING_PERIOD_BINARY_MS;
+    }
+
     /* Start timer before next ranging is initiated. */
     pal_timer_start(RANGING_APP_TIMER_CONT_RANGING,
-                    CONT_RANGING_PERIOD_MS * 1000,
+                    period_ms * 1000,
                     TIMEOUT_RELATIVE,
                     (FUNC_PTR())continue_ranging_after_timeout_cb,
                     NULL);
@@ -871,7 +736,7 @@ void init_ranging(bool is_remote)
         wrrr.CoordinatorAddrMode = NO_COORDINATOR;
     }
 
-    ranging_array_idx = 0;
+    speed_array_idx = 0;
     time_history_idx = 0;
     fill_status = false;
 
@@ -963,6 +828,14 @@ void print_status(uint8_t status)
             printf("Unsupported ranging method\n");
             break;
 
+        case RTB_SESSION_TABLE_FULL:
+            printf("Too many remote rangings ongoing\n");
+            break;
+
+        case RTB_TDMA_SLOT_END:
+            printf("Ranging does not fit into its TDMA slot\n");
+            break;
+
         case MAC_CHANNEL_ACCESS_FAILURE:
             printf("Channel access failure during ranging procedure\n");
             break;
@@ -0,0 +1,353 @@
+/**
+ * @file rtb_eval_app_track.c
+ *
+ * @brief Distance tracker of the continuous ranging
+ *
+ * Kalman filter with the state x = (distance, velocity) and the
+ * measurement of the distance only:
+ * - Prediction over dt: x = F x, P = F P F' + Q with F = (1 dt; 0 1)
+ *   and Q = q (dt^4/4 dt^3/2; dt^3/2 dt^2) for a random acceleration
+ *   with the variance q.
+ * - Correction with the distance z of variance R: S = P00 + R,
+ *   K = (P00 P01)' / S, x = x + K (z - x0), P = (I - K H) P.
+ *
+ * R decreases with the square of the DQF. Results outside of
+ * TRACK_GATE_SIGMA standard deviations of S are rejected, so the
+ * tracker replaces the fixed speed limit of the window filters.
+ *
+ * All values are Q16 fixed point. Products are calculated with 64 bit
+ * intermediates, and one 32 bit division is needed for each gain.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtb_eval_app_track.h"
+
+/* === Macros ============================================================== */
+
+/** 1.0 in Q16 */
+#define Q16_ONE                         (65536L)
+
+/** Variance of a distance with a DQF of 1 % in m^2 (Q16) */
+#define VAR_DQF1                        ((uint32_t)TRACK_SIGMA_DQF100_CM * \
+                                         TRACK_SIGMA_DQF100_CM * 65536UL)
+
+/** Variance of the acceleration in m^2/s^4 (Q16), from cm^2/s^4 */
+#define VAR_ACCEL                       ((int32_t)((TRACK_SIGMA_ACCEL_CM_S2 * \
+                                                    TRACK_SIGMA_ACCEL_CM_S2 * 4096UL) / 625UL))
+
+/** Initial variance of the velocity in m^2/s^2 (Q16), from cm^2/s^2 */
+#define VAR_VEL_INIT                    ((int32_t)((TRACK_SIGMA_VEL_CM_S * \
+                                                    TRACK_SIGMA_VEL_CM_S * 4096UL) / 625UL))
+
+/** Maximum variance of the distance (100 m standard deviation) */
+#define VAR_DIST_MAX                    (10000L * Q16_ONE)
+
+/** Maximum variance of the velocity (10 m/s standard deviation) */
+#define VAR_VEL_MAX                     (100L * Q16_ONE)
+
+/** Maximum velocity (100 m/s) */
+#define VEL_MAX                         (100L * Q16_ONE)
+
+/** Maximum distance in m (Q16) */
+#define DIST_MAX                        ((int32_t)(((uint64_t)TRACK_MAX_DIST_CM << 16) / 100))
+
+/* === Prototypes ========================================================== */
+
+static int32_t q16_mul(int32_t a, int32_t b);
+static int32_t limit(int64_t value, int32_t min, int32_t max);
+static int32_t meas_var(uint8_t dqf);
+static uint8_t isqrt(uint16_t value);
+
+/* === Implementation ====================================================== */
+
+/* Product of two Q16 values, rounded */
+static int32_t q16_mul(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b + 0x8000) >> 16);
+}
+
+
+
+/* Limits a value to min .. max. */
+static int32_t limit(int64_t value, int32_t min, int32_t max)
+{
+    if (value < min)
+    {
+        return min;
+    }
+    if (value > max)
+    {
+        return max;
+    }
+
+    return (int32_t)value;
+}
+
+
+
+/* Variance of a distance in m^2 (Q16) derived from its DQF */
+static int32_t meas_var(uint8_t dqf)
+{
+    if (dqf < 1)
+    {
+        dqf = 1;
+    }
+    else if (dqf > 100)
+    {
+        dqf = 100;
+    }
+
+    return (int32_t)(VAR_DQF1 / ((uint16_t)dqf * dqf));
+}
+
+
+
+/* Integer square root */
+static uint8_t isqrt(uint16_t value)
+{
+    uint16_t root = 0;
+    uint16_t bit = 1U << 14;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint8_t)root;
+}
+
+
+
+/**
+ * @brief Initializes the tracker of a link with its first result
+ *
+ * @param track Tracker of the link
+ * @param dist First distance in cm
+ * @param dqf First DQF in percent
+ */
+void cont_track_init(cont_track_t *track, uint32_t dist, uint8_t dqf)
+{
+    if (dist > TRACK_MAX_DIST_CM)
+    {
+        dist = TRACK_MAX_DIST_CM;
+    }
+
+    track->dist = (int32_t)(((uint64_t)dist << 16) / 100);
+    track->vel = 0;
+    track->p00 = meas_var(dqf);
+    track->p01 = 0;
+    track->p11 = VAR_VEL_INIT;
+    track->rejects = 0;
+}
+
+
+
+/**
+ * @brief Predicts distance and velocity of a link
+ *
+ * Is called for every ranging, also if no distance has been measured.
+ *
+ * @param track Tracker of the link
+ * @param dt_ms Time since the previous ranging in ms
+ */
+void cont_track_predict(cont_track_t *track, uint16_t dt_ms)
+{
+    int64_t dt;
+    int64_t dt2;
+    int64_t dt3;
+    int64_t dt4;
+    int64_t p00;
+    int64_t p01;
+    int64_t p11;
+
+    if (dt_ms > TRACK_MAX_DT_MS)
+    {
+        dt_ms = TRACK_MAX_DT_MS;
+    }
+
+    dt = (((uint32_t)dt_ms << 16) + 500) / 1000;
+    dt2 = (dt * dt) >> 16;
+    dt3 = (dt2 * dt) >> 16;
+    dt4 = (dt2 * dt2) >> 16;
+
+    track->dist = limit(track->dist + ((track->vel * dt + 0x8000) >> 16),
+                        0, DIST_MAX);
+
+    /* P = F P F' + Q */
+    p00 = track->p00 +
+          ((dt * (2 * (int64_t)track->p01 + ((dt * track->p11) >> 16))) >> 16) +
+          ((VAR_ACCEL * dt4) >> 18);
+    p01 = track->p01 + ((dt * track->p11) >> 16) + ((VAR_ACCEL * dt3) >> 17);
+    p11 = track->p11 + ((VAR_ACCEL * dt2) >> 16);
+
+    if ((p00 > VAR_DIST_MAX) || (p11 > VAR_VEL_MAX))
+    {
+        /* Keep the covariance positive when saturating the variances. */
+        p00 = limit(p00, 1, VAR_DIST_MAX);
+        p11 = limit(p11, 1, VAR_VEL_MAX);
+        p01 = limit(p01, -((p00 < p11) ? p00 : p11), (p00 < p11) ? p00 : p11);
+    }
+
+    track->p00 = (int32_t)p00;
+    track->p01 = (int32_t)p01;
+    track->p11 = (int32_t)p11;
+}
+
+
+
+/**
+ * @brief Corrects the tracker of a link by a measured distance
+ *
+ * Is called after cont_track_predict() with a valid distance.
+ *
+ * @param track Tracker of the link
+ * @param dist Distance in cm
+ * @param dqf DQF in percent
+ *
+ * @return TRACK_ACCEPTED if the distance updated the tracker,
+ *         TRACK_REJECTED if it was outside of the gate, or
+ *         TRACK_RESTARTED if the tracker restarted at the distance after
+ *         TRACK_MAX_REJECTS consecutive rejected distances
+ */
+cont_track_status_t cont_track_correct(cont_track_t *track,
+                                       uint32_t dist, uint8_t dqf)
+{
+    int32_t s;
+    int32_t k0;
+    int32_t k1;
+    int32_t y;
+
+    if (dist > TRACK_MAX_DIST_CM)
+    {
+        dist = TRACK_MAX_DIST_CM;
+    }
+
+    s = track->p00 + meas_var(dqf);
+    y = (int32_t)(((uint64_t)dist << 16) / 100) - track->dist;
+
+    /* Gate: y^2 > G^2 * S */
+    if ((int64_t)y * y >
+        ((int64_t)TRACK_GATE_SIGMA * TRACK_GATE_SIGMA * s) << 16)
+    {
+        track->rejects++;
+        if (track->rejects < TRACK_MAX_REJECTS)
+        {
+            return TRACK_REJECTED;
+        }
+
+        /* The node has really moved, e.g. behind an obstacle. */
+        cont_track_init(track, dist, dqf);
+        return TRACK_RESTARTED;
+    }
+    track->rejects = 0;
+
+    k0 = (int32_t)(((int64_t)track->p00 << 16) / s);
+    k1 = (int32_t)(((int64_t)track->p01 << 16) / s);
+
+    track->dist = limit((int64_t)track->dist + q16_mul(k0, y), 0, DIST_MAX);
+    track->vel = limit((int64_t)track->vel + q16_mul(k1, y), -VEL_MAX, VEL_MAX);
+
+    /* P = (I - K H) P; P11 is updated first, since it needs the old P01. */
+    track->p11 = limit((int64_t)track->p11 - q16_mul(k1, track->p01),
+                       1, VAR_VEL_MAX);
+    track->p00 = limit(q16_mul(Q16_ONE - k0, track->p00), 1, VAR_DIST_MAX);
+    track->p01 = q16_mul(Q16_ONE - k0, track->p01);
+
+    return TRACK_ACCEPTED;
+}
+
+
+
+/**
+ * @brief Returns the tracked distance of a link
+ *
+ * @param track Tracker of the link
+ *
+ * @return Distance in cm
+ */
+uint32_t cont_track_dist(const cont_track_t *track)
+{
+    return (uint32_t)(((int64_t)track->dist * 100 + 0x8000) >> 16);
+}
+
+
+
+/**
+ * @brief Returns the DQF of the tracked distance of a link
+ *
+ * The DQF is derived from the variance of the tracked distance,
+ * the same way the variance of a result is derived from its DQF.
+ *
+ * @param track Tracker of the link
+ *
+ * @return DQF in percent
+ */
+uint8_t cont_track_dqf(const cont_track_t *track)
+{
+    uint32_t dqf_sqr = VAR_DQF1 / (uint32_t)track->p00;
+
+    if (dqf_sqr >= 10000)
+    {
+        return 100;
+    }
+
+    return isqrt((uint16_t)dqf_sqr);
+}
+
+
+
+/**
+ * @brief Returns the tracked velocity of a link
+ *
+ * @param track Tracker of the link
+ *
+ * @return Velocity in cm/s; negative if the node approaches
+ */
+int16_t cont_track_vel(const cont_track_t *track)
+{
+    return (int16_t)(((int64_t)track->vel * 100 + 0x8000) >> 16);
+}
+
+
+
+/**
+ * @brief Returns the tracked speed of a link
+ *
+ * @param track Tracker of the link
+ *
+ * @return Speed in km/h; negative if the node approaches
+ */
+int8_t cont_track_speed_kmh(const cont_track_t *track)
+{
+    return (int8_t)limit(((int64_t)track->vel * 36 / 10 + 0x8000) >> 16,
+                         INT8_MIN, INT8_MAX);
+}
+
+/* EOF */
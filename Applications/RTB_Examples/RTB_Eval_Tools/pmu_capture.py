@@ -0,0 +1,293 @@
+##
+# @file pmu_capture.py
+#
+# @brief Decoder of binary PMU capture frames
+#
+# $Id$
+#
+# @author    Atmel Corporation: http://www.atmel.com
+# @author    Support email: avr@atmel.com
+#
+#
+# Copyright (c) 2013, Atmel Corporation All rights reserved.
+#
+# Licensed under Atmel's Limited License Agreement --> EULA.txt
+#
+"""
+PMU Capture Decoder - V %s
+
+  Decodes the binary PMU capture frames, which the RTB sends at PMU verbose
+  level 3 (see PMU_VERBOSE_LEVEL_BINARY_DUMP and the frame format in
+  rtb_pmu.h), and writes the captured measurements as CSV file.
+  The frames may be interleaved with the text output of the application.
+
+  Usage:
+    python pmu_capture.py [OPTIONS]
+
+  Options:
+    -p <PORT>
+       Read from serial port PORT (requires pyserial).
+    -b <BAUD>
+       Baud rate of the serial port (default 38400).
+    -i <FILE>
+       Read a raw capture from FILE ('-' for stdin) instead of a port.
+    -o <FILE>
+       Write the measurements as CSV to FILE (default stdout).
+    -r <FILE>
+       Write all received octets to FILE, e.g. for later decoding with -i.
+    -n <COUNT>
+       Stop after COUNT frames.
+    -c
+       Check the reported distance against the PMU values.
+    -h
+       Print help and exit.
+    -V
+       Print version number and exit.
+
+  CSV columns:
+    seq, start_mhz, f_step, no_of_freq, ant_meas, distance_cm, dqf,
+    ant_distance_cm, ant_dqf, init (PMU values separated by blanks), refl
+"""
+# === modules =================================================================
+from __future__ import print_function
+import sys, getopt, math, struct
+
+#=== global variables =========================================================
+VERSION = "1.0.0"
+
+## Sync octets of a frame
+SYNC = bytearray([0xA5, 0x5A])
+## Frame type containing PMU values
+TYPE_PMU_VALUES = 0x01
+## Supported version of the frame format
+FRAME_VERSION = 1
+## Initial value of the CRC
+CRC_INIT = 0xFFFF
+## Length of the fixed part of the payload
+FIXED_LEN = 15
+## Maximum length of the payload (4 antenna pairs, 255 frequencies)
+MAX_LEN = FIXED_LEN + 4 * (5 + 2 * 255)
+## Speed of light in m/s
+SPEED_OF_LIGHT = 299792458.0
+
+# === functions ===============================================================
+
+## Computes the CCITT-CRC16 (same as _crc_ccitt_update() of avr-libc).
+def crc_ccitt_update(crc, data):
+    data ^= crc & 0xFF
+    data = (data ^ (data << 4)) & 0xFF
+    return (((data << 8) | (crc >> 8)) ^ (data >> 4) ^ (data << 3)) & 0xFFFF
+
+## Computes the CRC of a frame.
+def crc_ccitt(data, crc = CRC_INIT):
+    for d in bytearray(data):
+        crc = crc_ccitt_update(crc, d)
+    return crc
+
+## Measurement of one capture frame.
+class Capture:
+    def __init__(self, payload):
+        (ftype, self.version, self.seq, self.start_mhz, self.f_step,
+         self.no_of_freq, self.no_of_ant_meas, self.dist_offset,
+         self.distance_cm, self.dqf) = struct.unpack_from("<BBHHBBBbIB", payload)
+        if ftype != TYPE_PMU_VALUES or self.version != FRAME_VERSION:
+            raise ValueError("unsupported frame type %d version %d" %
+                             (ftype, self.version))
+        n = self.no_of_freq
+        a = self.no_of_ant_meas
+        if len(payload) != FIXED_LEN + a * (5 + 2 * n):
+            raise ValueError("invalid frame length")
+        self.ant_distance_cm = []
+        self.ant_dqf = []
+        pos = FIXED_LEN
+        for i in range(a):
+            d, q = struct.unpack_from("<IB", payload, pos)
+            self.ant_distance_cm.append(d)
+            self.ant_dqf.append(q)
+            pos += 5
+        self.init = []
+        self.refl = []
+        for i in range(a):
+            self.init.append(list(bytearray(payload[pos:pos + n])))
+            pos += n
+        for i in range(a):
+            self.refl.append(list(bytearray(payload[pos:pos + n])))
+            pos += n
+
+    ## Calculates distance and DQF of an antenna pair like the RTB does
+    #  (see rtb_pmu_math.c), but with the exact trigonometric functions.
+    def calc(self, ant_meas):
+        init = self.init[ant_meas]
+        refl = self.refl[ant_meas]
+        sum_cos = sum_sin = 0.0
+        for i in range(1, self.no_of_freq):
+            step = ((init[i] + refl[i]) - (init[i - 1] + refl[i - 1])) & 0xFF
+            sum_cos += math.cos(step * math.pi / 128.0)
+            sum_sin += math.sin(step * math.pi / 128.0)
+        angle = math.atan2(sum_sin, sum_cos)
+        if angle < 0:
+            angle += 2.0 * math.pi
+        dist = (angle / (2.0 * math.pi)) * SPEED_OF_LIGHT / \
+               (2.0 * 500000.0 * (1 << self.f_step))
+        dist_cm = max(0, int(round(dist * 100.0)) + self.dist_offset)
+        dqf = int(round(100.0 * math.hypot(sum_cos, sum_sin) /
+                        (self.no_of_freq - 1)))
+        return dist_cm, dqf
+
+    ## Returns the CSV rows of this measurement.
+    def rows(self):
+        for i in range(self.no_of_ant_meas):
+            yield [self.seq, self.start_mhz, self.f_step, self.no_of_freq, i,
+                   self.distance_cm, self.dqf,
+                   self.ant_distance_cm[i], self.ant_dqf[i],
+                   " ".join(str(v) for v in self.init[i]),
+                   " ".join(str(v) for v in self.refl[i])]
+
+## Extracts capture frames from a stream of octets.
+class Decoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.format_errors = 0
+        self.other_frames = 0
+        self.lost = 0
+        self.last_seq = None
+
+    ## Adds received octets and returns the completely received captures.
+    def feed(self, data):
+        self.buf += bytearray(data)
+        captures = []
+        while True:
+            pos = self.buf.find(SYNC)
+            if pos < 0:
+                # Keep a possible first sync octet.
+                del self.buf[:max(0, len(self.buf) - 1)]
+                break
+            del self.buf[:pos]
+            if len(self.buf) < 4:
+                break
+            length = self.buf[2] | (self.buf[3] << 8)
+            if length < FIXED_LEN or length > MAX_LEN:
+                # Not a frame, e.g. sync octets within text or PMU values.
+                del self.buf[:1]
+                continue
+            if len(self.buf) < 4 + length + 2:
+                break
+            crc = self.buf[4 + length] | (self.buf[5 + length] << 8)
+            if crc_ccitt(self.buf[2:4 + length]) != crc:
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            if self.buf[4] != TYPE_PMU_VALUES:
+                # Other frame type, e.g. a binary result frame.
+                self.other_frames += 1
+                del self.buf[:4 + length + 2]
+                continue
+            try:
+                cap = Capture(bytes(self.buf[4:4 + length]))
+            except (ValueError, struct.error):
+                self.format_errors += 1
+                del self.buf[:4 + length + 2]
+                continue
+            del self.buf[:4 + length + 2]
+            if self.last_seq is not None:
+                self.lost += (cap.seq - self.last_seq - 1) & 0xFFFF
+            self.last_seq = cap.seq
+            self.frames += 1
+            captures.append(cap)
+        return captures
+
+def _parse_arguments_():
+    cfg = {"port": None, "baud": 38400, "input": None, "output": None,
+           "raw": None, "count": None, "check": False}
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "p:b:i:o:r:n:chV")
+    except getopt.GetoptError as e:
+        print(e)
+        sys.exit(1)
+    for o, v in opts:
+        if o == "-p":
+            cfg["port"] = v
+        elif o == "-b":
+            cfg["baud"] = int(v)
+        elif o == "-i":
+            cfg["input"] = v
+        elif o == "-o":
+            cfg["output"] = v
+        elif o == "-r":
+            cfg["raw"] = v
+        elif o == "-n":
+            cfg["count"] = int(v)
+        elif o == "-c":
+            cfg["check"] = True
+        elif o == "-h":
+            print(__doc__ % VERSION)
+            sys.exit(0)
+        elif o == "-V":
+            print("pmu_capture.py V%s" % VERSION)
+            sys.exit(0)
+    if (cfg["port"] is None) == (cfg["input"] is None):
+        print("Either a port (-p) or an input file (-i) is required.")
+        sys.exit(1)
+    return cfg
+
+def _open_source_(cfg):
+    if cfg["port"] is not None:
+        import serial
+        sport = serial.Serial(cfg["port"], cfg["baud"], timeout=1)
+        return lambda: sport.read(max(1, sport.inWaiting())), False
+    if cfg["input"] == "-":
+        f = getattr(sys.stdin, "buffer", sys.stdin)
+    else:
+        f = open(cfg["input"], "rb")
+    return lambda: f.read(4096), True
+
+# === main function ===========================================================
+if __name__ == "__main__":
+    cfg = _parse_arguments_()
+    read, is_file = _open_source_(cfg)
+    out = open(cfg["output"], "w") if cfg["output"] else sys.stdout
+    raw = open(cfg["raw"], "wb") if cfg["raw"] else None
+    dec = Decoder()
+    mismatches = 0
+
+    out.write("seq,start_mhz,f_step,no_of_freq,ant_meas,distance_cm,dqf,"
+              "ant_distance_cm,ant_dqf,init,refl\n")
+    try:
+        while cfg["count"] is None or dec.frames < cfg["count"]:
+            data = read()
+            if not data:
+                if is_file:
+                    break
+                continue
+            if raw:
+                raw.write(data)
+            for cap in dec.feed(data):
+                for row in cap.rows():
+                    out.write(",".join(str(v) for v in row) + "\n")
+                if cfg["check"]:
+                    for i in range(cap.no_of_ant_meas):
+                        dist, dqf = cap.calc(i)
+                        # The RTB uses a Q14 table with 256 entries.
+                        if abs(dist - cap.ant_distance_cm[i]) > 2 or \
+                           abs(dqf - cap.ant_dqf[i]) > 1:
+                            mismatches += 1
+                            sys.stderr.write("seq %d ant %d: reported %d cm %d %%, "
+                                             "calculated %d cm %d %%\n" %
+                                             (cap.seq, i, cap.ant_distance_cm[i],
+                                              cap.ant_dqf[i], dist, dqf))
+                if cfg["count"] is not None and dec.frames >= cfg["count"]:
+                    break
+            out.flush()
+    except KeyboardInterrupt:
+        pass
+
+    sys.stderr.write("%d frames, %d lost, %d CRC errors, %d format errors" %
+                     (dec.frames, dec.lost, dec.crc_errors, dec.format_errors))
+    if cfg["check"]:
+        sys.stderr.write(", %d distance mismatches" % mismatches)
+    sys.stderr.write("\n")
+    sys.exit(1 if mismatches else 0)
+
+# === EOF =====================================================================
@@ -62,17 +62,31 @@ Ranging Evaluation Terminal Application - V %s
 # === modules =================================================================
 import sys, traceback
 import serial, threading, time
-import getopt, pprint
+import getopt, pprint, struct
+from pmu_capture import crc_ccitt
 try:
     import pydoc
 except:
     print "pydoc not found"
 
 #=== global variables =========================================================
-VERSION = "1.1.7"
+VERSION = "1.1.8"
 VERBOSE = 0
 PORT    = None
 
+## Sync octets of a binary result frame
+RESULT_SYNC = "\xA5\x5A"
+## Frame type of a binary result frame
+RESULT_TYPE = 0x02
+## Length of the payload of a binary result frame without measurement pairs
+RESULT_FIXED_LEN = 19
+## Maximum length of the payload of a binary result frame (4 pairs)
+RESULT_MAX_LEN = RESULT_FIXED_LEN + 4 * 5
+## Status RTB_SUCCESS of a binary result frame
+RESULT_SUCCESS = 0x10
+## Short address reported for a node addressed by its long address
+RESULT_ADDR_LONG = 0xFFFE
+
 # === classes =================================================================
 
 ## Class for controlling a ranging device.
@@ -100,6 +114,7 @@ class BasicDevice:
         self.rxThread.setName("RX[%s]" % self.sport.portstr)
         self.rxThread.start()
         self.mode = None
+        self.binary = False
         self.param = {}
         self.no_of_measurements = 0
         self.results_antenna_div = []
@@ -131,7 +146,8 @@ class BasicDevice:
                  Verbose=None,
                  TxPowerduringRanging=None,
                  ProvideRangingTxPowerfornextRanging=None,
-                 ApplyMinimumThresholdduringweightedDistanceCalc=None):
+                 ApplyMinimumThresholdduringweightedDistanceCalc=None,
+                 BinaryOutput=None):
         ## Investigate present node setting
         tmp = self.getparam()
         cmd = ""
@@ -212,6 +228,11 @@ class BasicDevice:
                     cmd += "v0\n"
                 self.py_verbose = Verbose
 
+        if BinaryOutput != None:
+            if tmp['BinaryOutput'] != BinaryOutput:
+                cmd += "b%d\n" % BinaryOutput
+            self.binary = (BinaryOutput != 0)
+
         self.sport.write(cmd)
 
     ## Return a dictionary with the current parameter settings.
@@ -367,6 +388,53 @@ class BasicDevice:
             pass
         return ret
 
+    ##
+    # Extract a binary result frame from the data collector.
+    #
+    # @return None if text lines have to be processed first,
+    #         True if octets were consumed,
+    #         False if more octets are required
+    def _process_rx_frame_(self):
+        pos = self.DATABUF.find(RESULT_SYNC)
+        if pos < 0 or self.DATABUF.find('\n', 0, pos) >= 0:
+            return None
+        # Drop text without line end, e.g. a prompt.
+        self.DATABUF = self.DATABUF[pos:]
+        if len(self.DATABUF) < 4:
+            return False
+        length = struct.unpack("<H", self.DATABUF[2:4])[0]
+        if length < RESULT_FIXED_LEN or length > RESULT_MAX_LEN:
+            self.DATABUF = self.DATABUF[1:]
+            return True
+        if len(self.DATABUF) < 4 + length + 2:
+            return False
+        frame = self.DATABUF[:4 + length + 2]
+        crc = struct.unpack("<H", frame[4 + length:])[0]
+        if crc_ccitt(frame[2:4 + length]) != crc or ord(frame[4]) != RESULT_TYPE:
+            # Not a result frame, e.g. a PMU capture frame.
+            self.DATABUF = self.DATABUF[1:]
+            return True
+        self.DATABUF = self.DATABUF[len(frame):]
+        (ftype, seq, status, dist, dqf, timestamp, flags, init, refl,
+         pairs) = struct.unpack_from("<BHBIBIBHHB", frame, 4)
+        if status == RESULT_SUCCESS:
+            self.ERROR = 0
+            self.result = [dist, dqf, init, refl]
+        else:
+            self.ERROR = status
+            self.result = [-1, 0, init, refl, status]
+        self.results_antenna_div = []
+        for i in range(pairs):
+            self.results_antenna_div.append(
+                list(struct.unpack_from("<IB", frame, 4 + RESULT_FIXED_LEN + i * 5)))
+        self.no_of_measurements = pairs
+        if self.py_verbose >= 2:
+            sys.stdout.write("    >[FRAME %d] %s %s\n" %
+                             (seq, self.result, self.results_antenna_div))
+            sys.stdout.flush()
+        self.resultEvent.set()
+        return True
+
     ## Interpret lines modespecific.
     def _decode_line_(self,line):
         if self.mode == None:
@@ -409,6 +477,10 @@ class BasicDevice:
     #       - dowait:   if True do a blocking read from serial, no line was available
     def _process_rx_line_(self):
         ret = True
+        if self.binary:
+            frame = self._process_rx_frame_()
+            if frame != None:
+                return (False, not frame)
         line = self._serial_getline_()
         if line:
             if self.py_verbose >= 2:
@@ -486,6 +558,8 @@ class BasicDevice:
 #           Apply Tx Power during Ranging in dBm
 # @param ProvideRangingTxPowerfornextRanging
 #           Force Tx Power setting for next Ranging at peer nodes (0, 1)
+# @param BinaryOutput
+#           Report the ranging results as binary result frames (0, 1)
 #
 # Usage:
 #
@@ -0,0 +1,770 @@
+/**
+ * @file rtb_filter_bench.c
+ *
+ * @brief Benchmark of the continuous ranging filters
+ *
+ * The benchmark generates a series of ranging results of a moving node
+ * with noise and outliers and feeds them into the filters of the
+ * continuous ranging for several filtering lengths. For every filter
+ * method the incremental filter (rtb_eval_app_filter.c) is compared with
+ * the former implementation, which rescans and sorts the complete filter
+ * window for every result. The throughput is reported in results per
+ * second. The benchmark fails on any difference of average, median,
+ * minimum or maximum, or if the minimum variance filter deviates by more
+ * than 1 cm or 1 % DQF from the exact calculation.
+ *
+ * Afterwards the same results are fed into the fixed point tracker
+ * (rtb_eval_app_track.c) with a jittered ranging period. The time per
+ * result is reported in ns and, on x86 hosts, in TSC cycles. The tracker
+ * is compared with the same Kalman filter in double precision, and its
+ * error against the true distance is reported.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "rtb_eval_app_filter.h"
+#include "rtb_eval_app_track.h"
+#if defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#   define BENCH_HAS_TSC                (1)
+#else
+#   define BENCH_HAS_TSC                (0)
+#endif
+
+/* === Macros ============================================================== */
+
+/** Default number of results per filtering length */
+#define BENCH_DEFAULT_RESULTS           (200000)
+
+/** Maximum number of filtering lengths given on the command line */
+#define BENCH_MAX_LENGTHS               (8)
+
+/** Variance threshold of the minimum variance filter */
+#define BENCH_MIN_VAR_THRESHOLD         (100.0)
+
+/** Ranging period of the tracker in ms, jittered by +/- 25 % */
+#define BENCH_TRACK_PERIOD_MS           (40)
+
+/** DQF below which results are not passed to the tracker (Q_THRESHOLD) */
+#define BENCH_TRACK_MIN_DQF             (10)
+
+/** Allowed deviation of the tracker from the double precision reference */
+#define BENCH_TRACK_MAX_DEV_CM          (1.0)
+#define BENCH_TRACK_MAX_DEV_CM_S        (2.0)
+
+/* === Types =============================================================== */
+
+/** Filter methods of the continuous ranging */
+typedef enum bench_method_tag
+{
+    BENCH_AVER,
+    BENCH_MEDIAN,
+    BENCH_MIN,
+    BENCH_MAX,
+    BENCH_MIN_VAR,
+    BENCH_NO_OF_METHODS
+} bench_method_t;
+
+/** Window of the former implementation */
+typedef struct bench_window_tag
+{
+    uint32_t dist[MAX_LEN_OF_FILTERING_CONT];
+    uint8_t dqf[MAX_LEN_OF_FILTERING_CONT];
+    uint8_t idx;
+} bench_window_t;
+
+/** Double precision reference of the tracker */
+typedef struct bench_track_ref_tag
+{
+    double dist;
+    double vel;
+    double p00;
+    double p01;
+    double p11;
+    uint8_t rejects;
+} bench_track_ref_t;
+
+/* === Globals ============================================================= */
+
+/** Names of the filter methods */
+static const char *const method_names[BENCH_NO_OF_METHODS] =
+{
+    "aver", "median", "min", "max", "min_var"
+};
+
+/** State of the random generator */
+static uint32_t rnd_state = 1;
+
+/** Keeps the compiler from dropping the timed filter calls */
+static volatile uint32_t bench_sink;
+
+/* === Prototypes ========================================================== */
+
+static void usage(const char *prog);
+static uint32_t bench_rand(void);
+static void generate(uint32_t *dist, uint8_t *dqf, uint32_t *true_dist,
+                     uint16_t *dt_ms, uint32_t count,
+                     uint16_t outlier_permille);
+static bool bench_track(const uint32_t *dist, const uint8_t *dqf,
+                        const uint32_t *true_dist, const uint16_t *dt_ms,
+                        uint32_t count);
+static void ref_track_init(bench_track_ref_t *ref, uint32_t dist, uint8_t dqf);
+static void ref_track_update(bench_track_ref_t *ref, uint16_t dt_ms,
+                             bool valid, uint32_t dist, uint8_t dqf);
+static void window_add(bench_window_t *win, uint32_t dist, uint8_t dqf);
+static void legacy_filt(bench_method_t method, const bench_window_t *win,
+                        uint8_t len, uint32_t *dist, uint8_t *dqf);
+static void exact_min_var(const bench_window_t *win, uint8_t len,
+                          uint32_t *dist, uint8_t *dqf);
+static void engine_filt(bench_method_t method, const cont_filt_t *filt,
+                        uint32_t *dist, uint8_t *dqf);
+static int compare_uint32(const void *f1, const void *f2);
+static int compare_uint8(const void *f1, const void *f2);
+static double wall_clock_s(void);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Main function of the benchmark
+ */
+int main(int argc, char *argv[])
+{
+    uint8_t lengths[BENCH_MAX_LENGTHS] = { 5, 16, 64, 255 };
+    uint8_t no_of_lengths = 4;
+    bool lengths_given = false;
+    uint32_t count = BENCH_DEFAULT_RESULTS;
+    uint16_t outlier_permille = 50;
+    static bench_window_t win;
+    static cont_filt_t filt;
+    uint32_t *dist;
+    uint8_t *dqf;
+    uint32_t *ref_dist;
+    uint8_t *ref_dqf;
+    uint32_t *true_dist;
+    uint16_t *dt_ms;
+    bool failed = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:l:o:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                count = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'l':
+                if (!lengths_given)
+                {
+                    no_of_lengths = 0;
+                    lengths_given = true;
+                }
+                if (no_of_lengths < BENCH_MAX_LENGTHS)
+                {
+                    lengths[no_of_lengths++] = (uint8_t)atoi(optarg);
+                }
+                break;
+
+            case 'o':
+                outlier_permille = (uint16_t)atoi(optarg);
+                break;
+
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    for (uint8_t l = 0; l < no_of_lengths; l++)
+    {
+        if ((lengths[l] < 1) || (lengths[l] > MAX_LEN_OF_FILTERING_CONT))
+        {
+            fprintf(stderr, "Filtering length must be 1 .. %u\n",
+                    MAX_LEN_OF_FILTERING_CONT);
+            return EXIT_FAILURE;
+        }
+    }
+    if (0 == count)
+    {
+        fprintf(stderr, "Invalid number of results\n");
+        return EXIT_FAILURE;
+    }
+
+    dist = malloc(count * sizeof(*dist));
+    dqf = malloc(count * sizeof(*dqf));
+    ref_dist = malloc(count * sizeof(*ref_dist));
+    ref_dqf = malloc(count * sizeof(*ref_dqf));
+    true_dist = malloc(count * sizeof(*true_dist));
+    dt_ms = malloc(count * sizeof(*dt_ms));
+    if ((NULL == dist) || (NULL == dqf) || (NULL == ref_dist) ||
+        (NULL == ref_dqf) || (NULL == true_dist) || (NULL == dt_ms))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    generate(dist, dqf, true_dist, dt_ms, count, outlier_permille);
+
+    printf("%u results, %u permille outliers\n", count, outlier_permille);
+    printf("%-4s %-8s %14s %14s %8s %10s\n",
+           "len", "method", "former res/s", "incr. res/s", "speedup",
+           "mismatch");
+
+    for (uint8_t l = 0; l < no_of_lengths; l++)
+    {
+        uint8_t len = lengths[l];
+
+        for (uint8_t m = 0; m < BENCH_NO_OF_METHODS; m++)
+        {
+            bench_method_t method = (bench_method_t)m;
+            uint32_t mismatch = 0;
+            uint32_t res_dist;
+            uint8_t res_dqf;
+            double start;
+            double legacy_rate;
+            double engine_rate;
+
+            /* Former implementation: rescan the window for every result. */
+            memset(&win, 0, sizeof(win));
+            for (uint8_t i = 0; i < MAX_LEN_OF_FILTERING_CONT; i++)
+            {
+                win.dist[i] = dist[0];
+                win.dqf[i] = dqf[0];
+            }
+            start = wall_clock_s();
+            for (uint32_t r = 1; r < count; r++)
+            {
+                window_add(&win, dist[r], dqf[r]);
+                legacy_filt(method, &win, len, &ref_dist[r], &ref_dqf[r]);
+            }
+            legacy_rate = (count - 1) / (wall_clock_s() - start);
+
+            /* Incremental filter */
+            cont_filt_init(&filt, len, dist[0], dqf[0]);
+            start = wall_clock_s();
+            for (uint32_t r = 1; r < count; r++)
+            {
+                cont_filt_add(&filt, dist[r], dqf[r]);
+                engine_filt(method, &filt, &res_dist, &res_dqf);
+                bench_sink = res_dist + res_dqf;
+            }
+            engine_rate = (count - 1) / (wall_clock_s() - start);
+
+            /* Compare, outside of the timed loop. */
+            memset(&win, 0, sizeof(win));
+            cont_filt_init(&filt, len, dist[0], dqf[0]);
+            for (uint8_t i = 0; i < MAX_LEN_OF_FILTERING_CONT; i++)
+            {
+                win.dist[i] = dist[0];
+                win.dqf[i] = dqf[0];
+            }
+            for (uint32_t r = 1; r < count; r++)
+            {
+                cont_filt_add(&filt, dist[r], dqf[r]);
+                engine_filt(method, &filt, &res_dist, &res_dqf);
+
+                if (BENCH_MIN_VAR == method)
+                {
+                    window_add(&win, dist[r], dqf[r]);
+                    exact_min_var(&win, len, &ref_dist[r], &ref_dqf[r]);
+                    if ((labs((long)res_dist - (long)ref_dist[r]) > 1) ||
+                        (abs((int)res_dqf - (int)ref_dqf[r]) > 1))
+                    {
+                        mismatch++;
+                    }
+                }
+                else if ((res_dist != ref_dist[r]) || (res_dqf != ref_dqf[r]))
+                {
+                    mismatch++;
+                }
+            }
+
+            printf("%-4u %-8s %14.0f %14.0f %7.1fx %10u\n",
+                   len, method_names[method], legacy_rate, engine_rate,
+                   engine_rate / legacy_rate, mismatch);
+
+            if (mismatch > 0)
+            {
+                failed = true;
+            }
+        }
+    }
+
+    if (!bench_track(dist, dqf, true_dist, dt_ms, count))
+    {
+        failed = true;
+    }
+
+    free(dt_ms);
+    free(true_dist);
+    free(ref_dqf);
+    free(ref_dist);
+    free(dqf);
+    free(dist);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief Prints the command line options
+ */
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <count>     results per filtering length (default %u)\n"
+           "  -l <len>       filtering length 1 .. %u, may be repeated\n"
+           "                 (default 5, 16, 64 and 255)\n"
+           "  -o <permille>  distance outliers (default 50)\n",
+           prog, BENCH_DEFAULT_RESULTS, MAX_LEN_OF_FILTERING_CONT);
+}
+
+
+
+/**
+ * @brief Gets the next value of the random generator (xorshift32)
+ */
+static uint32_t bench_rand(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+
+    return rnd_state;
+}
+
+
+
+/**
+ * @brief Generates the ranging results of a node moving back and forth
+ *
+ * The node moves by 1 cm per ranging. The distances are noisy with a few
+ * centimeters, so equal distances occur frequently within the filter
+ * window.
+ */
+static void generate(uint32_t *dist, uint8_t *dqf, uint32_t *true_dist,
+                     uint16_t *dt_ms, uint32_t count,
+                     uint16_t outlier_permille)
+{
+    int32_t pos = 500;
+    int32_t step = 1;
+
+    for (uint32_t r = 0; r < count; r++)
+    {
+        int32_t d = pos + (int32_t)(bench_rand() % 9) - 4;
+
+        if ((bench_rand() % 1000) < outlier_permille)
+        {
+            d += (int32_t)(bench_rand() % 2000);
+        }
+        dist[r] = (d > 0) ? (uint32_t)d : 0;
+        dqf[r] = (uint8_t)(bench_rand() % (CONT_FILT_DQF_MAX + 1));
+        true_dist[r] = (uint32_t)pos;
+        dt_ms[r] = (uint16_t)(BENCH_TRACK_PERIOD_MS * 3 / 4 +
+                              bench_rand() % (BENCH_TRACK_PERIOD_MS / 2 + 1));
+
+        pos += step;
+        if ((pos > 3000) || (pos < 100))
+        {
+            step = -step;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Runs the tracker over all results
+ *
+ * @return true if the tracker matches the double precision reference
+ */
+static bool bench_track(const uint32_t *dist, const uint8_t *dqf,
+                        const uint32_t *true_dist, const uint16_t *dt_ms,
+                        uint32_t count)
+{
+    static cont_track_t track;
+    bench_track_ref_t ref;
+    double start;
+    double ns;
+    double cycles = 0.0;
+    double dev_dist = 0.0;
+    double dev_vel = 0.0;
+    double err_raw = 0.0;
+    double err_track = 0.0;
+    uint32_t rejected = 0;
+
+    /* Timed run */
+    cont_track_init(&track, dist[0], dqf[0]);
+    start = wall_clock_s();
+#if BENCH_HAS_TSC
+    uint64_t tsc = __rdtsc();
+#endif
+    for (uint32_t r = 1; r < count; r++)
+    {
+        cont_track_predict(&track, dt_ms[r]);
+        if (dqf[r] >= BENCH_TRACK_MIN_DQF)
+        {
+            cont_track_correct(&track, dist[r], dqf[r]);
+        }
+        bench_sink = cont_track_dist(&track);
+    }
+#if BENCH_HAS_TSC
+    cycles = (double)(__rdtsc() - tsc) / (count - 1);
+#endif
+    ns = (wall_clock_s() - start) * 1e9 / (count - 1);
+
+    /* Compare, outside of the timed loop. */
+    cont_track_init(&track, dist[0], dqf[0]);
+    ref_track_init(&ref, dist[0], dqf[0]);
+    for (uint32_t r = 1; r < count; r++)
+    {
+        bool valid = (dqf[r] >= BENCH_TRACK_MIN_DQF);
+        double d;
+
+        cont_track_predict(&track, dt_ms[r]);
+        if (valid &&
+            (TRACK_REJECTED == cont_track_correct(&track, dist[r], dqf[r])))
+        {
+            rejected++;
+        }
+        ref_track_update(&ref, dt_ms[r], valid, dist[r], dqf[r]);
+
+        d = fabs(cont_track_dist(&track) - ref.dist);
+        dev_dist = (d > dev_dist) ? d : dev_dist;
+        d = fabs(cont_track_vel(&track) - ref.vel);
+        dev_vel = (d > dev_vel) ? d : dev_vel;
+
+        d = (double)dist[r] - true_dist[r];
+        err_raw += d * d;
+        d = (double)cont_track_dist(&track) - true_dist[r];
+        err_track += d * d;
+    }
+
+    printf("\ntracker: %.1f ns/result", ns);
+#if BENCH_HAS_TSC
+    printf(", %.0f TSC cycles/result", cycles);
+#endif
+    printf("\n  max. deviation from double: %.2f cm, %.2f cm/s\n",
+           dev_dist, dev_vel);
+    printf("  RMS error: results %.1f cm, tracker %.1f cm (%u rejected)\n",
+           sqrt(err_raw / (count - 1)), sqrt(err_track / (count - 1)),
+           rejected);
+
+    return (dev_dist <= BENCH_TRACK_MAX_DEV_CM) &&
+           (dev_vel <= BENCH_TRACK_MAX_DEV_CM_S);
+}
+
+
+
+/**
+ * @brief Initializes the double precision tracker (cm, cm/s)
+ */
+static void ref_track_init(bench_track_ref_t *ref, uint32_t dist, uint8_t dqf)
+{
+    double sigma = TRACK_SIGMA_DQF100_CM * 100.0 / ((dqf < 1) ? 1 : dqf);
+
+    ref->dist = dist;
+    ref->vel = 0.0;
+    ref->p00 = sigma * sigma;
+    ref->p01 = 0.0;
+    ref->p11 = (double)TRACK_SIGMA_VEL_CM_S * TRACK_SIGMA_VEL_CM_S;
+    ref->rejects = 0;
+}
+
+
+
+/**
+ * @brief Updates the double precision tracker
+ */
+static void ref_track_update(bench_track_ref_t *ref, uint16_t dt_ms,
+                             bool valid, uint32_t dist, uint8_t dqf)
+{
+    double dt = dt_ms / 1000.0;
+    double q = (double)TRACK_SIGMA_ACCEL_CM_S2 * TRACK_SIGMA_ACCEL_CM_S2;
+    double sigma = TRACK_SIGMA_DQF100_CM * 100.0 / ((dqf < 1) ? 1 : dqf);
+    double s;
+    double y;
+    double k0;
+    double k1;
+
+    ref->dist += ref->vel * dt;
+    ref->p00 += dt * (2 * ref->p01 + dt * ref->p11) + q * dt * dt * dt * dt / 4;
+    ref->p01 += dt * ref->p11 + q * dt * dt * dt / 2;
+    ref->p11 += q * dt * dt;
+
+    if (!valid)
+    {
+        return;
+    }
+
+    s = ref->p00 + sigma * sigma;
+    y = dist - ref->dist;
+    if (y * y > TRACK_GATE_SIGMA * TRACK_GATE_SIGMA * s)
+    {
+        ref->rejects++;
+        if (ref->rejects >= TRACK_MAX_REJECTS)
+        {
+            ref_track_init(ref, dist, dqf);
+        }
+        return;
+    }
+    ref->rejects = 0;
+
+    k0 = ref->p00 / s;
+    k1 = ref->p01 / s;
+    ref->dist += k0 * y;
+    ref->vel += k1 * y;
+    ref->p11 -= k1 * ref->p01;
+    ref->p00 *= 1 - k0;
+    ref->p01 *= 1 - k0;
+}
+
+
+
+/**
+ * @brief Adds a result to the window of the former implementation
+ */
+static void window_add(bench_window_t *win, uint32_t dist, uint8_t dqf)
+{
+    win->idx++;
+    if (MAX_LEN_OF_FILTERING_CONT == win->idx)
+    {
+        win->idx = 0;
+    }
+    win->dist[win->idx] = dist;
+    win->dqf[win->idx] = dqf;
+}
+
+
+
+/**
+ * @brief Former filter implementation
+ *
+ * Collects the last len results of the window, newest first, and
+ * calculates the filtered values by scanning resp. sorting them.
+ * The minimum variance filter is left to exact_min_var().
+ */
+static void legacy_filt(bench_method_t method, const bench_window_t *win,
+                        uint8_t len, uint32_t *dist, uint8_t *dqf)
+{
+    uint32_t temp_dist[MAX_LEN_OF_FILTERING_CONT];
+    uint8_t temp_dqf[MAX_LEN_OF_FILTERING_CONT];
+    uint8_t curr_array_idx = win->idx;
+    uint8_t median_index = len / 2;
+    uint32_t dist_sum = 0;
+    uint16_t dqf_sum = 0;
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        temp_dist[i] = win->dist[curr_array_idx];
+        temp_dqf[i] = win->dqf[curr_array_idx];
+
+        if (curr_array_idx == 0)
+        {
+            /* Perform wrap-around. */
+            curr_array_idx = MAX_LEN_OF_FILTERING_CONT;
+        }
+        curr_array_idx--;
+    }
+
+    switch (method)
+    {
+        case BENCH_AVER:
+            for (uint8_t i = 0; i < len; i++)
+            {
+                dist_sum += temp_dist[i];
+                dqf_sum += temp_dqf[i];
+            }
+            *dist = dist_sum / len;
+            *dqf = (uint8_t)(round((float)dqf_sum / len));
+            break;
+
+        case BENCH_MEDIAN:
+            qsort(temp_dist, len, sizeof(uint32_t), compare_uint32);
+            qsort(temp_dqf, len, sizeof(uint8_t), compare_uint8);
+            if (len % 2)
+            {
+                *dist = temp_dist[median_index];
+                *dqf = temp_dqf[median_index];
+            }
+            else
+            {
+                *dist = (temp_dist[median_index - 1] + temp_dist[median_index]) / 2;
+                *dqf = (uint8_t)(((uint16_t)temp_dqf[median_index - 1] +
+                                  temp_dqf[median_index]) / 2);
+            }
+            break;
+
+        case BENCH_MIN:
+            *dist = (uint32_t) - 1;
+            *dqf = 100;
+            for (uint8_t i = 0; i < len; i++)
+            {
+                if (temp_dist[i] < *dist)
+                {
+                    *dist = temp_dist[i];
+                    *dqf = temp_dqf[i];
+                }
+            }
+            break;
+
+        case BENCH_MAX:
+            *dist = 0;
+            *dqf = 0;
+            for (uint8_t i = 0; i < len; i++)
+            {
+                if (temp_dist[i] > *dist)
+                {
+                    *dist = temp_dist[i];
+                    *dqf = temp_dqf[i];
+                }
+            }
+            break;
+
+        default:
+            exact_min_var(win, len, dist, dqf);
+            break;
+    }
+}
+
+
+
+/**
+ * @brief Minimum variance filter with two passes in double precision
+ */
+static void exact_min_var(const bench_window_t *win, uint8_t len,
+                          uint32_t *dist, uint8_t *dqf)
+{
+    uint8_t curr_array_idx = win->idx;
+    uint32_t dist_min = (uint32_t) - 1;
+    uint8_t dqf_min = 100;
+    uint64_t dist_sum = 0;
+    uint32_t dqf_sum = 0;
+    double dist_mean;
+    double dqf_mean;
+    double dist_var = 0.0;
+    double dqf_var = 0.0;
+    double b;
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t pos = (uint8_t)((curr_array_idx + MAX_LEN_OF_FILTERING_CONT - i) %
+                                MAX_LEN_OF_FILTERING_CONT);
+
+        if (win->dist[pos] < dist_min)
+        {
+            dist_min = win->dist[pos];
+        }
+        if (win->dqf[pos] < dqf_min)
+        {
+            dqf_min = win->dqf[pos];
+        }
+        dist_sum += win->dist[pos];
+        dqf_sum += win->dqf[pos];
+    }
+    dist_mean = (double)dist_sum / len;
+    dqf_mean = (double)dqf_sum / len;
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t pos = (uint8_t)((curr_array_idx + MAX_LEN_OF_FILTERING_CONT - i) %
+                                MAX_LEN_OF_FILTERING_CONT);
+
+        dist_var += (win->dist[pos] - dist_mean) * (win->dist[pos] - dist_mean);
+        dqf_var += (win->dqf[pos] - dqf_mean) * (win->dqf[pos] - dqf_mean);
+    }
+    dist_var /= len;
+    dqf_var /= len;
+
+    /* The filter weights the truncated means, as the firmware does. */
+    b = BENCH_MIN_VAR_THRESHOLD / (BENCH_MIN_VAR_THRESHOLD + dist_var);
+    *dist = (uint32_t)(b * (uint32_t)(dist_sum / len) + (1 - b) * dist_min);
+    b = BENCH_MIN_VAR_THRESHOLD / (BENCH_MIN_VAR_THRESHOLD + dqf_var);
+    *dqf = (uint8_t)(b * (uint8_t)(dqf_sum / len) + (1 - b) * dqf_min);
+}
+
+
+
+/**
+ * @brief Incremental filter
+ */
+static void engine_filt(bench_method_t method, const cont_filt_t *filt,
+                        uint32_t *dist, uint8_t *dqf)
+{
+    switch (method)
+    {
+        case BENCH_AVER:
+            cont_filt_aver(filt, dist, dqf);
+            break;
+
+        case BENCH_MEDIAN:
+            cont_filt_median(filt, dist, dqf);
+            break;
+
+        case BENCH_MIN:
+            cont_filt_min(filt, dist, dqf);
+            break;
+
+        case BENCH_MAX:
+            cont_filt_max(filt, dist, dqf);
+            break;
+
+        default:
+            cont_filt_min_var(filt, dist, dqf);
+            break;
+    }
+}
+
+
+
+/* Compare function for uint32_t values for qsort(). */
+static int compare_uint32(const void *f1, const void *f2)
+{
+    uint32_t a = *(const uint32_t *)f1;
+    uint32_t b = *(const uint32_t *)f2;
+
+    return (a > b) - (a < b);
+}
+
+
+
+/* Compare function for uint8_t values for qsort(). */
+static int compare_uint8(const void *f1, const void *f2)
+{
+    return (int)*(const uint8_t *)f1 - (int)*(const uint8_t *)f2;
+}
+
+
+
+/**
+ * @brief Gets the monotonic wall clock in s
+ */
+static double wall_clock_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* EOF */
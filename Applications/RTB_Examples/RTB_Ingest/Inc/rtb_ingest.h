@@ -0,0 +1,261 @@
+/**
+ * @file rtb_ingest.h
+ *
+ * @brief Ingestion of ranging results from many RTB Evaluation Applications
+ *
+ * The ingestion daemon reads the serial ports of many boards running the
+ * RTB Evaluation Application. The output of each port is parsed as it is
+ * received; no lines are assembled. Complete results are published as
+ * fixed size records into a ring buffer in shared memory, which any
+ * number of consumer processes read without locks:
+ * - Text output: [RESULT] / [ERROR] blocks with their [PAIR_NO_x] lines,
+ *   completed by [DONE], and [PMU_VALID] blocks
+ * - Binary result frames (see rtb_eval_app_param.h)
+ *
+ * The ring buffer has a single producer. Each slot carries a sequence
+ * number, which is odd while the producer writes the slot. A consumer
+ * keeps its own read position, so consumers do not affect each other or
+ * the producer. A consumer that falls behind by more than the ring size
+ * loses the overwritten records and is told how many it lost.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_INGEST_H
+#define RTB_INGEST_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** Default name of the shared memory object of the ring buffer */
+#define RTB_INGEST_DEFAULT_SHM          "/rtb_ingest"
+
+/** Default number of records of the ring buffer */
+#define RTB_INGEST_DEFAULT_SLOTS        (65536UL)
+
+/** Magic number of the ring buffer ("RTBI") */
+#define RTB_INGEST_MAGIC                (0x49425452UL)
+
+/** Version of the ring buffer layout */
+#define RTB_INGEST_VERSION              (1)
+
+/** Maximum number of measurement pairs per record */
+#define RTB_INGEST_MAX_PAIRS            (4)
+
+/** Maximum number of PMU validity values per record (PMU_MAX_NO_OF_FREQ) */
+#define RTB_INGEST_MAX_PMU_VALUES       (160)
+
+/** Status of a successful ranging (RTB_SUCCESS) */
+#define RTB_INGEST_STATUS_SUCCESS       (0x10)
+
+/** Distance of a failed ranging */
+#define RTB_INGEST_INVALID_DISTANCE     (0xFFFFFFFFUL)
+
+/** Maximum number of fields of a text line */
+#define RTB_INGEST_MAX_FIELDS           (8)
+
+/** Maximum length of a tag of a text line, e.g. [PAIR_NO_0] */
+#define RTB_INGEST_MAX_TAG_LEN          (32)
+
+/** Maximum payload length of a binary result frame (4 pairs) */
+#define RTB_INGEST_FRAME_MAX_LEN        (19 + 4 * 5)
+
+/* Flags of a record */
+/** Result was received as binary result frame */
+#define RTB_INGEST_FLAG_BINARY          (0x01)
+/** Result of a remote ranging (binary result frames only) */
+#define RTB_INGEST_FLAG_REMOTE          (0x02)
+/** Result of a continuous ranging (binary result frames only) */
+#define RTB_INGEST_FLAG_CONTINUOUS      (0x04)
+/** More measurement pairs were received than stored */
+#define RTB_INGEST_FLAG_PAIRS_TRUNCATED (0x08)
+
+/* === Types ================================================================ */
+
+/** Type of a record */
+typedef enum rtb_ingest_type_tag
+{
+    RTB_INGEST_RESULT = 1,      /**< Successful ranging */
+    RTB_INGEST_ERROR,           /**< Failed ranging */
+    RTB_INGEST_PMU_VALID        /**< PMU validity vector */
+} rtb_ingest_type_t;
+
+/** Record of the ring buffer (64 octets) */
+typedef struct rtb_ingest_record_tag
+{
+    /** Receive time (CLOCK_MONOTONIC) of the last octet in ns */
+    uint64_t rx_time_ns;
+    /** Initiator address, short or long */
+    uint64_t initiator;
+    /** Reflector address, short or long */
+    uint64_t reflector;
+    /** Distance in cm, RTB_INGEST_INVALID_DISTANCE if failed */
+    uint32_t distance;
+    /** Index of the port in the order of the command line */
+    uint16_t port;
+    /** Sequence number of a binary result frame */
+    uint16_t seq;
+    /** Record type (rtb_ingest_type_t) */
+    uint8_t type;
+    /** Status of the ranging */
+    uint8_t status;
+    /** DQF in percent */
+    uint8_t dqf;
+    /** RTB_INGEST_FLAG_xxx */
+    uint8_t flags;
+    /** Number of measurement pairs resp. PMU validity values */
+    uint8_t count;
+    /** Antenna measurement value of a PMU validity vector */
+    uint8_t ant_meas;
+    /** Start frequency of a PMU validity vector in 500 kHz */
+    uint16_t start_freq;
+    union
+    {
+        /** Measurement pairs */
+        struct
+        {
+            uint32_t distance[RTB_INGEST_MAX_PAIRS];
+            uint8_t dqf[RTB_INGEST_MAX_PAIRS];
+        } pairs;
+        /** PMU validity values, one bit per frequency (LSB first) */
+        uint8_t pmu_valid[RTB_INGEST_MAX_PMU_VALUES / 8];
+    } u;
+} rtb_ingest_record_t;
+
+/** Slot of the ring buffer */
+typedef struct rtb_ingest_slot_tag
+{
+    /** 2 * n + 2 if record n is valid, odd while written */
+    uint64_t seq;
+    rtb_ingest_record_t rec;
+} rtb_ingest_slot_t;
+
+/** Header of the ring buffer in shared memory */
+typedef struct rtb_ingest_ring_hdr_tag
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t slots;
+    /** Process id of the producer */
+    uint32_t producer_pid;
+    /** Number of published records; on its own cache line */
+    uint64_t head __attribute__((aligned(64)));
+    /** Futex incremented after publishing */
+    uint32_t wake;
+} __attribute__((aligned(64))) rtb_ingest_ring_hdr_t;
+
+/** Mapping of a ring buffer */
+typedef struct rtb_ingest_ring_tag
+{
+    rtb_ingest_ring_hdr_t *hdr;
+    rtb_ingest_slot_t *slot;
+    uint64_t mask;
+    uint64_t size;
+    /** Next record to publish (producer only) */
+    uint64_t head;
+    /** Records published since the last wake-up (producer only) */
+    uint32_t unwoken;
+} rtb_ingest_ring_t;
+
+/** Read position of a consumer */
+typedef struct rtb_ingest_reader_tag
+{
+    const rtb_ingest_ring_t *ring;
+    /** Next record to read */
+    uint64_t next;
+    /** Number of overwritten records */
+    uint64_t lost;
+} rtb_ingest_reader_t;
+
+/** Callback receiving a complete record of the parser */
+typedef void (*rtb_ingest_publish_cb_t)(void *ctx,
+                                        const rtb_ingest_record_t *rec);
+
+/** Statistics of a port */
+typedef struct rtb_ingest_stats_tag
+{
+    uint64_t octets;
+    uint32_t records;
+    uint32_t frame_errors;
+    uint32_t incomplete;
+} rtb_ingest_stats_t;
+
+/** Parser state of a port */
+typedef struct rtb_ingest_parser_tag
+{
+    /** Record of the block being received */
+    rtb_ingest_record_t rec;
+    rtb_ingest_stats_t stats;
+    /** Numeric fields of the current line */
+    int64_t field[RTB_INGEST_MAX_FIELDS];
+    /** Value of the field being received */
+    uint64_t value;
+    uint8_t tag[RTB_INGEST_MAX_TAG_LEN];
+    uint8_t frame[4 + RTB_INGEST_FRAME_MAX_LEN + 2];
+    /** Length of the frame being received, from its header */
+    uint16_t frame_len;
+    /** Number of received octets of the frame */
+    uint16_t frame_pos;
+    uint16_t crc;
+    uint16_t port;
+    uint8_t state;
+    /** Type of the block being received, 0 if none */
+    uint8_t block;
+    uint8_t tag_len;
+    uint8_t no_of_fields;
+    uint8_t digits;
+    bool negative;
+    bool hex;
+} rtb_ingest_parser_t;
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /* Parser */
+    void rtb_ingest_parser_init(rtb_ingest_parser_t *parser, uint16_t port);
+    void rtb_ingest_parse(rtb_ingest_parser_t *parser,
+                          const uint8_t *data, uint32_t len,
+                          uint64_t rx_time_ns,
+                          rtb_ingest_publish_cb_t publish, void *ctx);
+
+    /* Ring buffer */
+    int rtb_ingest_ring_create(rtb_ingest_ring_t *ring, const char *name,
+                               uint32_t slots);
+    int rtb_ingest_ring_attach(rtb_ingest_ring_t *ring, const char *name);
+    void rtb_ingest_ring_close(rtb_ingest_ring_t *ring);
+    void rtb_ingest_ring_publish(rtb_ingest_ring_t *ring,
+                                 const rtb_ingest_record_t *rec);
+    void rtb_ingest_ring_wake(rtb_ingest_ring_t *ring);
+    void rtb_ingest_reader_init(rtb_ingest_reader_t *reader,
+                                const rtb_ingest_ring_t *ring,
+                                bool from_oldest);
+    int rtb_ingest_read(rtb_ingest_reader_t *reader,
+                        rtb_ingest_record_t *rec, int timeout_ms);
+
+    /* Helpers */
+    uint64_t rtb_ingest_time_ns(void);
+    void rtb_ingest_print_record(const rtb_ingest_record_t *rec);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RTB_INGEST_H */
+/* EOF */
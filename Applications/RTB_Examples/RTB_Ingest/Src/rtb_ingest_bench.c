@@ -0,0 +1,398 @@
+/**
+ * @file rtb_ingest_bench.c
+ *
+ * @brief Benchmark of the ingestion daemon with emulated boards
+ *
+ * The benchmark creates one pseudo terminal per emulated board and starts
+ * the ingestion daemon on their slave sides. It writes ranging results in
+ * the output format of the RTB Evaluation Application to all boards, each
+ * result carrying its index as distance, and reads the records from the
+ * ring buffer in a consumer thread. It reports the latency from writing a
+ * result to the consumer receiving its record; the latency of real boards
+ * adds the transmission time and the latency of the USB serial converter.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "rtb_ingest.h"
+
+/* === Macros ============================================================== */
+
+/** Default number of emulated boards */
+#define BENCH_DEFAULT_PORTS             (32)
+
+/** Default number of results per board */
+#define BENCH_DEFAULT_RESULTS           (1000)
+
+/** Default interval between the results of a board in us */
+#define BENCH_DEFAULT_INTERVAL_US       (1000)
+
+/** Name of the shared memory object of the benchmark */
+#define BENCH_SHM_NAME                  "/rtb_ingest_bench"
+
+/** Time to wait for the remaining records at the end in ms */
+#define BENCH_DRAIN_MS                  (2000)
+
+/* === Globals ============================================================= */
+
+static uint64_t *send_ns;
+static uint32_t *latency_ns;
+static uint32_t total;
+static volatile uint32_t received;
+static volatile uint32_t invalid;
+static volatile bool stop;
+static rtb_ingest_ring_t ring;
+static rtb_ingest_reader_t reader;
+
+/* === Prototypes ========================================================== */
+
+static void *consumer(void *arg);
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data);
+static uint32_t format_text(char *buf, uint32_t idx);
+static uint32_t format_frame(uint8_t *buf, uint32_t idx);
+static int cmp_u32(const void *a, const void *b);
+static void usage(const char *name);
+
+/* === Implementation ====================================================== */
+
+/* Reads the records and calculates their latencies. */
+static void *consumer(void *arg)
+{
+    rtb_ingest_record_t rec;
+
+    (void)arg;
+
+    while (!stop)
+    {
+        if (0 == rtb_ingest_read(&reader, &rec, 100))
+        {
+            continue;
+        }
+
+        uint64_t now = rtb_ingest_time_ns();
+
+        if ((RTB_INGEST_RESULT != rec.type) || (rec.distance >= total) ||
+            (1 != rec.count) || (rec.u.pairs.distance[0] != rec.distance) ||
+            (0 != latency_ns[rec.distance]))
+        {
+            invalid++;
+            continue;
+        }
+
+        latency_ns[rec.distance] = (uint32_t)(now - send_ns[rec.distance]);
+        received++;
+    }
+
+    return NULL;
+}
+
+
+
+/* CCITT CRC-16, same as _crc_ccitt_update() of avr-libc */
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+    data ^= (uint8_t)crc;
+    data ^= (uint8_t)(data << 4);
+
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^
+            (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+
+
+/* Formats a result as text output of the evaluation application. */
+static uint32_t format_text(char *buf, uint32_t idx)
+{
+    return (uint32_t)sprintf(buf,
+                             "[RESULT] %lu 87 0x1 0x2\r\n"
+                             "[PAIR_NO_0] %lu 87\r\n"
+                             "[DONE]\r\n",
+                             (unsigned long)idx, (unsigned long)idx);
+}
+
+
+
+/* Formats a result as binary result frame of the evaluation application. */
+static uint32_t format_frame(uint8_t *buf, uint32_t idx)
+{
+    uint8_t *p = &buf[4];
+    uint16_t crc = 0xFFFF;
+    uint16_t len = 19 + 5;
+
+    buf[0] = 0xA5;
+    buf[1] = 0x5A;
+    buf[2] = (uint8_t)len;
+    buf[3] = (uint8_t)(len >> 8);
+    memset(p, 0, len);
+    p[0] = 0x02;                        /* Result frame */
+    p[1] = (uint8_t)idx;                /* Sequence number */
+    p[2] = (uint8_t)(idx >> 8);
+    p[3] = RTB_INGEST_STATUS_SUCCESS;
+    memcpy(&p[4], &idx, 4);             /* Distance */
+    p[8] = 87;                          /* DQF */
+    p[14] = 1;                          /* Initiator */
+    p[16] = 2;                          /* Reflector */
+    p[18] = 1;                          /* Number of pairs */
+    memcpy(&p[19], &idx, 4);
+    p[23] = 87;
+
+    for (uint16_t i = 2; i < 4 + len; i++)
+    {
+        crc = crc_ccitt_update(crc, buf[i]);
+    }
+    buf[4 + len] = (uint8_t)crc;
+    buf[5 + len] = (uint8_t)(crc >> 8);
+
+    return 6 + len;
+}
+
+
+
+/* Compares two latencies for qsort(). */
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+
+/* Prints the usage. */
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -p <ports>  Number of emulated boards (default %u)\n"
+            "  -r <n>      Results per board (default %u)\n"
+            "  -i <us>     Interval between the results of a board (default %u)\n"
+            "  -m          Send every other result as binary result frame\n"
+            "  -d <path>   Ingestion daemon (default ./RTB_Ingest)\n"
+            "  -h          This help\n",
+            name, BENCH_DEFAULT_PORTS, BENCH_DEFAULT_RESULTS,
+            BENCH_DEFAULT_INTERVAL_US);
+}
+
+
+
+/**
+ * @brief Main function of the benchmark
+ */
+int main(int argc, char *argv[])
+{
+    const char *daemon_path = "./RTB_Ingest";
+    unsigned ports = BENCH_DEFAULT_PORTS;
+    unsigned results = BENCH_DEFAULT_RESULTS;
+    unsigned interval_us = BENCH_DEFAULT_INTERVAL_US;
+    bool mixed = false;
+    int *master;
+    char **args;
+    pthread_t thread;
+    pid_t pid;
+    uint32_t *sorted;
+    uint64_t start;
+    int status;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:r:i:md:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                ports = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                results = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                interval_us = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                mixed = true;
+                break;
+            case 'd':
+                daemon_path = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if ((0 == ports) || (ports > 256) || (0 == results))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    total = ports * results;
+    send_ns = calloc(total, sizeof(uint64_t));
+    latency_ns = calloc(total, sizeof(uint32_t));
+    master = calloc(ports, sizeof(int));
+    args = calloc(ports + 6, sizeof(char *));
+    if ((NULL == send_ns) || (NULL == latency_ns) ||
+        (NULL == master) || (NULL == args))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* RTB_Ingest -s <name> -n <slots> <ports> */
+    args[0] = (char *)daemon_path;
+    args[1] = "-s";
+    args[2] = BENCH_SHM_NAME;
+    args[3] = "-n";
+    args[4] = "1048576";
+    for (unsigned i = 0; i < ports; i++)
+    {
+        struct termios tio;
+
+        master[i] = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((master[i] < 0) || (grantpt(master[i]) < 0) ||
+            (unlockpt(master[i]) < 0))
+        {
+            perror("pty");
+            return 1;
+        }
+
+        /* Raw before the daemon opens the slave, nothing is echoed. */
+        tcgetattr(master[i], &tio);
+        cfmakeraw(&tio);
+        tcsetattr(master[i], TCSANOW, &tio);
+
+        args[5 + i] = strdup(ptsname(master[i]));
+    }
+
+    shm_unlink(BENCH_SHM_NAME);
+    pid = fork();
+    if (0 == pid)
+    {
+        execv(daemon_path, args);
+        perror(daemon_path);
+        _exit(1);
+    }
+
+    /* Wait until the daemon has created the ring buffer. */
+    for (int i = 0; rtb_ingest_ring_attach(&ring, BENCH_SHM_NAME) < 0; i++)
+    {
+        if ((i >= 500) || (pid == waitpid(pid, &status, WNOHANG)))
+        {
+            fprintf(stderr, "Ingestion daemon did not start\n");
+            return 1;
+        }
+        usleep(10000);
+    }
+    /* The ports are opened after creating the ring buffer. */
+    usleep(200000);
+
+    rtb_ingest_reader_init(&reader, &ring, false);
+    pthread_create(&thread, NULL, consumer, NULL);
+
+    printf("%u boards, %u results per board, interval %u us%s\n",
+           ports, results, interval_us, mixed ? ", text and binary" : "");
+
+    start = rtb_ingest_time_ns();
+    for (unsigned r = 0; r < results; r++)
+    {
+        for (unsigned p = 0; p < ports; p++)
+        {
+            uint8_t buf[128];
+            uint32_t idx = r * ports + p;
+            uint32_t len;
+
+            if (mixed && (r & 1))
+            {
+                len = format_frame(buf, idx);
+            }
+            else
+            {
+                len = format_text((char *)buf, idx);
+            }
+
+            send_ns[idx] = rtb_ingest_time_ns();
+            if (write(master[p], buf, len) != (ssize_t)len)
+            {
+                perror("write");
+                return 1;
+            }
+        }
+
+        if (interval_us > 0)
+        {
+            uint64_t next = start + (uint64_t)(r + 1) * interval_us * 1000;
+            uint64_t now = rtb_ingest_time_ns();
+
+            if (next > now)
+            {
+                struct timespec ts;
+
+                ts.tv_sec = (time_t)((next - now) / 1000000000ULL);
+                ts.tv_nsec = (long)((next - now) % 1000000000ULL);
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+
+    for (int i = 0; (received + invalid < total) && (i < BENCH_DRAIN_MS); i++)
+    {
+        usleep(1000);
+    }
+    stop = true;
+    pthread_join(thread, NULL);
+
+    printf("%.0f results/s written\n",
+           total * 1e9 / (double)(rtb_ingest_time_ns() - start));
+
+    kill(pid, SIGTERM);
+    waitpid(pid, &status, 0);
+
+    sorted = malloc(received * sizeof(uint32_t));
+    if ((NULL == sorted) || (0 == received))
+    {
+        fprintf(stderr, "No records received\n");
+        return 1;
+    }
+    for (uint32_t i = 0, j = 0; i < total; i++)
+    {
+        if (0 != latency_ns[i])
+        {
+            sorted[j++] = latency_ns[i];
+        }
+    }
+    qsort(sorted, received, sizeof(uint32_t), cmp_u32);
+
+    printf("%u of %u records received, %u invalid, %llu lost\n",
+           received, total, invalid, (unsigned long long)reader.lost);
+    printf("Latency write -> consumer: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           sorted[received / 2] / 1e3,
+           sorted[(uint32_t)(received * 0.99)] / 1e3,
+           sorted[received - 1] / 1e3);
+
+    return ((received == total) && (0 == invalid)) ? 0 : 1;
+}
+
+/* EOF */
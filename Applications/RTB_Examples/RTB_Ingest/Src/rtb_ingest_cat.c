@@ -0,0 +1,100 @@
+/**
+ * @file rtb_ingest_cat.c
+ *
+ * @brief Prints the records of the ingestion daemon
+ *
+ * Each record is printed as one line (see rtb_ingest_print_record()), so
+ * scripts receive the results of all boards through a pipe instead of
+ * polling every serial port.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "rtb_ingest.h"
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Main function of the consumer
+ */
+int main(int argc, char *argv[])
+{
+    const char *shm_name = RTB_INGEST_DEFAULT_SHM;
+    bool from_oldest = false;
+    rtb_ingest_ring_t ring;
+    rtb_ingest_reader_t reader;
+    rtb_ingest_record_t rec;
+    uint64_t lost = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:ah")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                shm_name = optarg;
+                break;
+            case 'a':
+                from_oldest = true;
+                break;
+            default:
+                fprintf(stderr,
+                        "Usage: %s [options]\n"
+                        "  -s <name>   Shared memory object of the ring buffer "
+                        "(default %s)\n"
+                        "  -a          Start with the oldest available record\n"
+                        "  -h          This help\n",
+                        argv[0], RTB_INGEST_DEFAULT_SHM);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (rtb_ingest_ring_attach(&ring, shm_name) < 0)
+    {
+        perror(shm_name);
+        return 1;
+    }
+
+    rtb_ingest_reader_init(&reader, &ring, from_oldest);
+
+    for (;;)
+    {
+        if (0 == rtb_ingest_read(&reader, &rec, 0))
+        {
+            /* Flush once all available records are printed. */
+            fflush(stdout);
+            if (0 == rtb_ingest_read(&reader, &rec, -1))
+            {
+                continue;
+            }
+        }
+
+        if (reader.lost != lost)
+        {
+            fprintf(stderr, "%llu records lost\n",
+                    (unsigned long long)(reader.lost - lost));
+            lost = reader.lost;
+        }
+
+        rtb_ingest_print_record(&rec);
+    }
+
+    return 0;
+}
+
+/* EOF */
@@ -0,0 +1,472 @@
+/**
+ * @file rtb_ingest_daemon.c
+ *
+ * @brief Ingestion daemon for the serial ports of many evaluation boards
+ *
+ * One thread waits with epoll on all serial ports. Each readable port is
+ * read with one non-blocking read, its octets are parsed and the complete
+ * records are published into the ring buffer. Consumers are woken up once
+ * per epoll iteration.
+ *
+ * Commands for the boards (e.g. the menu keys of the RTB Evaluation
+ * Application) are sent as datagrams to the control socket: the first
+ * octet is the index of the port, the remaining octets are written to it.
+ *
+ * USB serial converters hold received octets for their latency timer
+ * (16 ms for FTDI devices by default). The daemon requests low latency
+ * mode for each port; if the driver does not support it, the timer has
+ * to be set via sysfs.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/serial.h>
+#include "rtb_ingest.h"
+
+/* === Macros ============================================================== */
+
+/** Maximum number of ports */
+#define MAX_PORTS                       (256)
+
+/** Default baud rate of the ports */
+#define DEFAULT_BAUD_RATE               (38400)
+
+/** Size of the receive buffer */
+#define RX_BUF_SIZE                     (4096)
+
+/** Interval of reopening failed ports in ms */
+#define REOPEN_INTERVAL_MS              (1000)
+
+/** Maximum size of a command datagram */
+#define MAX_CMD_LEN                     (256)
+
+/** epoll data of the control socket */
+#define CTRL_EPOLL_DATA                 (UINT32_MAX)
+
+/* === Types =============================================================== */
+
+/** State of a port */
+typedef struct port_tag
+{
+    const char *path;
+    int fd;
+    rtb_ingest_parser_t parser;
+} port_t;
+
+/* === Globals ============================================================= */
+
+static port_t *ports;
+static uint16_t no_of_ports;
+static rtb_ingest_ring_t ring;
+static volatile sig_atomic_t terminate;
+
+/* === Prototypes ========================================================== */
+
+static speed_t baud_to_speed(unsigned long baud);
+static int port_open(port_t *port, speed_t speed, int epfd, uint32_t index);
+static void port_close(port_t *port, int epfd);
+static int ctrl_open(const char *path);
+static void ctrl_handle(int fd);
+static void publish_cb(void *ctx, const rtb_ingest_record_t *rec);
+static void signal_handler(int sig);
+static void print_stats(void);
+static void usage(const char *name);
+
+/* === Implementation ====================================================== */
+
+/* Converts a baud rate into its termios constant. */
+static speed_t baud_to_speed(unsigned long baud)
+{
+    switch (baud)
+    {
+        case 9600:      return B9600;
+        case 19200:     return B19200;
+        case 38400:     return B38400;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+        case 460800:    return B460800;
+        case 500000:    return B500000;
+        case 921600:    return B921600;
+        case 1000000:   return B1000000;
+        case 2000000:   return B2000000;
+        default:        return B0;
+    }
+}
+
+
+
+/* Opens a port in raw mode and adds it to epoll. */
+static int port_open(port_t *port, speed_t speed, int epfd, uint32_t index)
+{
+    struct termios tio;
+    struct serial_struct serial;
+    struct epoll_event ev;
+    int fd;
+
+    fd = open(port->path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 == tcgetattr(fd, &tio))
+    {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    /* Not supported by every driver, e.g. pseudo terminals */
+    if (0 == ioctl(fd, TIOCGSERIAL, &serial))
+    {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.u32 = index;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    port->fd = fd;
+
+    return 0;
+}
+
+
+
+/* Closes a port after an error; it is reopened later. */
+static void port_close(port_t *port, int epfd)
+{
+    epoll_ctl(epfd, EPOLL_CTL_DEL, port->fd, NULL);
+    close(port->fd);
+    port->fd = -1;
+
+    /* A block cut by the error must not be completed by the next one. */
+    rtb_ingest_parser_init(&port->parser, port->parser.port);
+}
+
+
+
+/* Opens the control socket. */
+static int ctrl_open(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+
+/* Forwards the received commands to their ports. */
+static void ctrl_handle(int fd)
+{
+    uint8_t cmd[MAX_CMD_LEN];
+    ssize_t len;
+
+    while ((len = recv(fd, cmd, sizeof(cmd), 0)) > 0)
+    {
+        port_t *port;
+
+        if ((len < 2) || (cmd[0] >= no_of_ports))
+        {
+            continue;
+        }
+
+        port = &ports[cmd[0]];
+        if ((port->fd < 0) || (write(port->fd, &cmd[1], (size_t)len - 1) < 0))
+        {
+            fprintf(stderr, "Command for %s dropped\n", port->path);
+        }
+    }
+}
+
+
+
+/* Publishes a record of a parser. */
+static void publish_cb(void *ctx, const rtb_ingest_record_t *rec)
+{
+    rtb_ingest_ring_publish((rtb_ingest_ring_t *)ctx, rec);
+}
+
+
+
+/* Requests the termination of the main loop. */
+static void signal_handler(int sig)
+{
+    (void)sig;
+    terminate = 1;
+}
+
+
+
+/* Prints the statistics of all ports. */
+static void print_stats(void)
+{
+    for (uint16_t i = 0; i < no_of_ports; i++)
+    {
+        const rtb_ingest_stats_t *stats = &ports[i].parser.stats;
+
+        fprintf(stderr, "%3u %-24s %12llu octets %10u records "
+                "%6u frame errors %6u incomplete\n",
+                i, ports[i].path, (unsigned long long)stats->octets,
+                stats->records, stats->frame_errors, stats->incomplete);
+    }
+}
+
+
+
+/* Prints the usage. */
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <port> [<port> ...]\n"
+            "  -b <baud>   Baud rate of the ports (default %u)\n"
+            "  -s <name>   Shared memory object of the ring buffer (default %s)\n"
+            "  -n <slots>  Number of records of the ring buffer, power of 2 "
+            "(default %lu)\n"
+            "  -c <path>   Control socket for commands to the ports\n"
+            "  -h          This help\n",
+            name, DEFAULT_BAUD_RATE, RTB_INGEST_DEFAULT_SHM,
+            RTB_INGEST_DEFAULT_SLOTS);
+}
+
+
+
+/**
+ * @brief Main function of the ingestion daemon
+ */
+int main(int argc, char *argv[])
+{
+    const char *shm_name = RTB_INGEST_DEFAULT_SHM;
+    const char *ctrl_path = NULL;
+    unsigned long baud = DEFAULT_BAUD_RATE;
+    unsigned long slots = RTB_INGEST_DEFAULT_SLOTS;
+    struct epoll_event events[64];
+    struct sigaction sa;
+    uint8_t buf[RX_BUF_SIZE];
+    uint64_t next_reopen = 0;
+    speed_t speed;
+    int ctrl_fd = -1;
+    int epfd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:s:n:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                baud = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                shm_name = optarg;
+                break;
+            case 'n':
+                slots = strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                ctrl_path = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if ((optind >= argc) || (argc - optind > MAX_PORTS))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    speed = baud_to_speed(baud);
+    if (B0 == speed)
+    {
+        fprintf(stderr, "Unsupported baud rate %lu\n", baud);
+        return 1;
+    }
+
+    if (rtb_ingest_ring_create(&ring, shm_name, (uint32_t)slots) < 0)
+    {
+        perror(shm_name);
+        return 1;
+    }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+    {
+        perror("epoll");
+        return 1;
+    }
+
+    no_of_ports = (uint16_t)(argc - optind);
+    ports = calloc(no_of_ports, sizeof(port_t));
+    if (NULL == ports)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (uint16_t i = 0; i < no_of_ports; i++)
+    {
+        ports[i].path = argv[optind + i];
+        ports[i].fd = -1;
+        rtb_ingest_parser_init(&ports[i].parser, i);
+        if (port_open(&ports[i], speed, epfd, i) < 0)
+        {
+            perror(ports[i].path);
+        }
+    }
+
+    if (NULL != ctrl_path)
+    {
+        struct epoll_event ev;
+
+        ctrl_fd = ctrl_open(ctrl_path);
+        if (ctrl_fd < 0)
+        {
+            perror(ctrl_path);
+            return 1;
+        }
+        ev.events = EPOLLIN;
+        ev.data.u32 = CTRL_EPOLL_DATA;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, ctrl_fd, &ev);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = signal_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    while (!terminate)
+    {
+        int n = epoll_wait(epfd, events, sizeof(events) / sizeof(events[0]),
+                           REOPEN_INTERVAL_MS);
+        uint64_t now = rtb_ingest_time_ns();
+
+        for (int i = 0; i < n; i++)
+        {
+            port_t *port;
+            ssize_t len;
+
+            if (CTRL_EPOLL_DATA == events[i].data.u32)
+            {
+                ctrl_handle(ctrl_fd);
+                continue;
+            }
+
+            port = &ports[events[i].data.u32];
+            if (port->fd < 0)
+            {
+                continue;
+            }
+
+            len = read(port->fd, buf, sizeof(buf));
+            if (len > 0)
+            {
+                rtb_ingest_parse(&port->parser, buf, (uint32_t)len,
+                                 rtb_ingest_time_ns(), publish_cb, &ring);
+            }
+            else if ((0 == len) ||
+                     ((EAGAIN != errno) && (EINTR != errno)))
+            {
+                /* Board unplugged or pseudo terminal closed */
+                fprintf(stderr, "%s closed\n", port->path);
+                port_close(port, epfd);
+            }
+        }
+
+        rtb_ingest_ring_wake(&ring);
+
+        if (now >= next_reopen)
+        {
+            for (uint16_t i = 0; i < no_of_ports; i++)
+            {
+                if ((ports[i].fd < 0) &&
+                    (0 == port_open(&ports[i], speed, epfd, i)))
+                {
+                    fprintf(stderr, "%s reopened\n", ports[i].path);
+                }
+            }
+            next_reopen = now + REOPEN_INTERVAL_MS * 1000000ULL;
+        }
+    }
+
+    print_stats();
+
+    for (uint16_t i = 0; i < no_of_ports; i++)
+    {
+        if (ports[i].fd >= 0)
+        {
+            close(ports[i].fd);
+        }
+    }
+    if (ctrl_fd >= 0)
+    {
+        close(ctrl_fd);
+        unlink(ctrl_path);
+    }
+    rtb_ingest_ring_close(&ring);
+    shm_unlink(shm_name);
+    free(ports);
+
+    return 0;
+}
+
+/* EOF */
@@ -0,0 +1,528 @@
+/**
+ * @file rtb_ingest_parser.c
+ *
+ * @brief Incremental parser of the output of the RTB Evaluation Application
+ *
+ * The parser is a state machine consuming one octet at a time, so it is
+ * fed directly with the octets read from a port, in chunks of any size.
+ * Numbers are converted while they are received and tags are compared
+ * once their closing bracket is received; lines are never assembled.
+ * Only binary result frames are collected, since their CRC has to be
+ * checked before they are used.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "rtb_ingest.h"
+
+/* === Macros ============================================================== */
+
+/* Framing of binary frames (see rtb_eval_app_param.h and rtb_pmu.h) */
+#define FRAME_SYNC_0                    (0xA5)
+#define FRAME_SYNC_1                    (0x5A)
+#define FRAME_CRC_INIT                  (0xFFFF)
+#define FRAME_TYPE_RESULT               (0x02)
+#define FRAME_FIXED_LEN                 (19)
+#define FRAME_PAIR_LEN                  (5)
+#define FRAME_FLAG_REMOTE               (0x01)
+#define FRAME_FLAG_CONTINUOUS           (0x02)
+
+/** Frames longer than this are considered as garbage (PMU capture frames) */
+#define FRAME_MAX_SKIP_LEN              (4096)
+
+/* Compares a tag with a string constant. */
+#define TAG_IS(p, s)                    (((p)->tag_len == sizeof(s) - 1) && \
+                                         (0 == memcmp((p)->tag, s, sizeof(s) - 1)))
+
+/* Checks whether a tag starts with a string constant. */
+#define TAG_STARTS(p, s)                (((p)->tag_len >= sizeof(s) - 1) && \
+                                         (0 == memcmp((p)->tag, s, sizeof(s) - 1)))
+
+/* === Types =============================================================== */
+
+/** States of the parser */
+typedef enum parser_state_tag
+{
+    ST_LINE_START = 0,  /**< Start of a line */
+    ST_TAG,             /**< Within [...] */
+    ST_FIELDS,          /**< Fields after a tag */
+    ST_PMU_DATA,        /**< Line of a PMU validity vector */
+    ST_SKIP,            /**< Line without interest */
+    ST_SYNC,            /**< First sync octet of a frame received */
+    ST_FRAME,           /**< Within a result frame */
+    ST_FRAME_SKIP       /**< Within another frame */
+} parser_state_t;
+
+/* === Prototypes ========================================================== */
+
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data);
+static void end_field(rtb_ingest_parser_t *parser);
+static uint8_t tag_number(const rtb_ingest_parser_t *parser, uint8_t prefix_len);
+static void start_block(rtb_ingest_parser_t *parser, rtb_ingest_type_t type);
+static void publish_block(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                          rtb_ingest_publish_cb_t publish, void *ctx);
+static void handle_line(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                        rtb_ingest_publish_cb_t publish, void *ctx);
+static void handle_frame(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                         rtb_ingest_publish_cb_t publish, void *ctx);
+static uint32_t get_le32(const uint8_t *p);
+
+/* === Implementation ====================================================== */
+
+/* CCITT CRC-16, same as _crc_ccitt_update() of avr-libc */
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+    data ^= (uint8_t)crc;
+    data ^= (uint8_t)(data << 4);
+
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^
+            (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+
+
+/* Reads a little endian 32 bit value. */
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+
+/* Stores the number being received as next field. */
+static void end_field(rtb_ingest_parser_t *parser)
+{
+    if ((parser->digits > 0) && (parser->no_of_fields < RTB_INGEST_MAX_FIELDS))
+    {
+        parser->field[parser->no_of_fields++] =
+            parser->negative ? -(int64_t)parser->value : (int64_t)parser->value;
+    }
+
+    parser->value = 0;
+    parser->digits = 0;
+    parser->negative = false;
+    parser->hex = false;
+}
+
+
+
+/* Decimal number following the prefix of the tag, e.g. [PAIR_NO_1] */
+static uint8_t tag_number(const rtb_ingest_parser_t *parser, uint8_t prefix_len)
+{
+    uint8_t number = 0;
+
+    for (uint8_t i = prefix_len; i < parser->tag_len; i++)
+    {
+        if ((parser->tag[i] >= '0') && (parser->tag[i] <= '9'))
+        {
+            number = (uint8_t)(number * 10 + (parser->tag[i] - '0'));
+        }
+    }
+
+    return number;
+}
+
+
+
+/* Starts a new text block. */
+static void start_block(rtb_ingest_parser_t *parser, rtb_ingest_type_t type)
+{
+    if (0 != parser->block)
+    {
+        /* The previous block was not completed, e.g. line loss. */
+        parser->stats.incomplete++;
+    }
+
+    memset(&parser->rec, 0, sizeof(parser->rec));
+    parser->rec.type = (uint8_t)type;
+    parser->block = (uint8_t)type;
+}
+
+
+
+/* Publishes the current text block. */
+static void publish_block(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                          rtb_ingest_publish_cb_t publish, void *ctx)
+{
+    parser->rec.rx_time_ns = rx_time_ns;
+    parser->rec.port = parser->port;
+    parser->stats.records++;
+    parser->block = 0;
+
+    publish(ctx, &parser->rec);
+}
+
+
+
+/* Handles a complete tagged line. */
+static void handle_line(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                        rtb_ingest_publish_cb_t publish, void *ctx)
+{
+    rtb_ingest_record_t *rec = &parser->rec;
+    const int64_t *field = parser->field;
+    uint8_t n = parser->no_of_fields;
+
+    if (TAG_IS(parser, "RESULT"))
+    {
+        /* [RESULT] <distance> <DQF> <Initiator> <Reflector> */
+        start_block(parser, RTB_INGEST_RESULT);
+        rec->status = RTB_INGEST_STATUS_SUCCESS;
+        rec->distance = (n > 0) ? (uint32_t)field[0] : RTB_INGEST_INVALID_DISTANCE;
+        rec->dqf = (n > 1) ? (uint8_t)field[1] : 0;
+        rec->initiator = (n > 2) ? (uint64_t)field[2] : 0;
+        rec->reflector = (n > 3) ? (uint64_t)field[3] : 0;
+    }
+    else if (TAG_IS(parser, "ERROR"))
+    {
+        /* [ERROR] -1 0 <Initiator> <Reflector> <status> */
+        start_block(parser, RTB_INGEST_ERROR);
+        rec->distance = RTB_INGEST_INVALID_DISTANCE;
+        rec->initiator = (n > 2) ? (uint64_t)field[2] : 0;
+        rec->reflector = (n > 3) ? (uint64_t)field[3] : 0;
+        rec->status = (n > 4) ? (uint8_t)field[4] : 0;
+    }
+    else if (TAG_STARTS(parser, "PAIR_NO_"))
+    {
+        /* [PAIR_NO_x] <distance> <DQF> */
+        if ((RTB_INGEST_RESULT == parser->block) ||
+            (RTB_INGEST_ERROR == parser->block))
+        {
+            if (rec->count < RTB_INGEST_MAX_PAIRS)
+            {
+                rec->u.pairs.distance[rec->count] = (n > 0) ? (uint32_t)field[0] : 0;
+                rec->u.pairs.dqf[rec->count] = (n > 1) ? (uint8_t)field[1] : 0;
+                rec->count++;
+            }
+            else
+            {
+                rec->flags |= RTB_INGEST_FLAG_PAIRS_TRUNCATED;
+            }
+        }
+    }
+    else if (TAG_IS(parser, "DONE"))
+    {
+        if ((RTB_INGEST_RESULT == parser->block) ||
+            (RTB_INGEST_ERROR == parser->block))
+        {
+            publish_block(parser, rx_time_ns, publish, ctx);
+        }
+    }
+    else if (TAG_IS(parser, "PMU_VALID"))
+    {
+        start_block(parser, RTB_INGEST_PMU_VALID);
+    }
+    else if (TAG_STARTS(parser, "ANTENNA_MEASUREMENT_VALUE_"))
+    {
+        if (RTB_INGEST_PMU_VALID == parser->block)
+        {
+            rec->ant_meas = tag_number(parser,
+                                       sizeof("ANTENNA_MEASUREMENT_VALUE_") - 1);
+        }
+    }
+    else if (TAG_IS(parser, "PMU_VALID_END"))
+    {
+        if (RTB_INGEST_PMU_VALID == parser->block)
+        {
+            publish_block(parser, rx_time_ns, publish, ctx);
+        }
+    }
+}
+
+
+
+/* Handles a complete binary frame. */
+static void handle_frame(rtb_ingest_parser_t *parser, uint64_t rx_time_ns,
+                         rtb_ingest_publish_cb_t publish, void *ctx)
+{
+    /* The frame buffer starts with the length field. */
+    const uint8_t *payload = &parser->frame[2];
+    uint16_t len = parser->frame_len;
+    uint16_t crc = (uint16_t)(payload[len] | (payload[len + 1] << 8));
+    rtb_ingest_record_t rec;
+    uint8_t pairs;
+    uint8_t flags;
+
+    if ((parser->crc != crc) || (FRAME_TYPE_RESULT != payload[0]))
+    {
+        parser->stats.frame_errors++;
+        return;
+    }
+
+    pairs = payload[18];
+    if (len != FRAME_FIXED_LEN + pairs * FRAME_PAIR_LEN)
+    {
+        parser->stats.frame_errors++;
+        return;
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    flags = payload[13];
+    rec.rx_time_ns = rx_time_ns;
+    rec.port = parser->port;
+    rec.seq = (uint16_t)(payload[1] | (payload[2] << 8));
+    rec.status = payload[3];
+    rec.type = (RTB_INGEST_STATUS_SUCCESS == rec.status) ?
+               RTB_INGEST_RESULT : RTB_INGEST_ERROR;
+    rec.distance = get_le32(&payload[4]);
+    rec.dqf = payload[8];
+    rec.flags = RTB_INGEST_FLAG_BINARY;
+    if (flags & FRAME_FLAG_REMOTE)
+    {
+        rec.flags |= RTB_INGEST_FLAG_REMOTE;
+    }
+    if (flags & FRAME_FLAG_CONTINUOUS)
+    {
+        rec.flags |= RTB_INGEST_FLAG_CONTINUOUS;
+    }
+    rec.initiator = (uint16_t)(payload[14] | (payload[15] << 8));
+    rec.reflector = (uint16_t)(payload[16] | (payload[17] << 8));
+    for (uint8_t i = 0; (i < pairs) && (i < RTB_INGEST_MAX_PAIRS); i++)
+    {
+        rec.u.pairs.distance[i] = get_le32(&payload[FRAME_FIXED_LEN + i * FRAME_PAIR_LEN]);
+        rec.u.pairs.dqf[i] = payload[FRAME_FIXED_LEN + i * FRAME_PAIR_LEN + 4];
+        rec.count++;
+    }
+
+    parser->stats.records++;
+    publish(ctx, &rec);
+}
+
+
+
+/**
+ * @brief Initializes the parser of a port
+ *
+ * @param parser Parser of the port
+ * @param port Index of the port, reported in the records
+ */
+void rtb_ingest_parser_init(rtb_ingest_parser_t *parser, uint16_t port)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->port = port;
+    parser->state = ST_LINE_START;
+}
+
+
+
+/**
+ * @brief Parses octets received from a port
+ *
+ * Complete records are passed to the callback. Incomplete blocks
+ * are continued with the next call.
+ *
+ * @param parser Parser of the port
+ * @param data Received octets
+ * @param len Number of received octets
+ * @param rx_time_ns Receive time of the octets
+ * @param publish Callback receiving the records
+ * @param ctx Context of the callback
+ */
+void rtb_ingest_parse(rtb_ingest_parser_t *parser,
+                      const uint8_t *data, uint32_t len,
+                      uint64_t rx_time_ns,
+                      rtb_ingest_publish_cb_t publish, void *ctx)
+{
+    parser->stats.octets += len;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint8_t c = data[i];
+
+        if ((FRAME_SYNC_0 == c) && (parser->state < ST_SYNC))
+        {
+            /* Text never contains the sync octet. */
+            parser->state = ST_SYNC;
+            continue;
+        }
+
+        switch (parser->state)
+        {
+            case ST_LINE_START:
+                if ('[' == c)
+                {
+                    parser->tag_len = 0;
+                    parser->state = ST_TAG;
+                }
+                else if ((c >= '0') && (c <= '9') &&
+                         (RTB_INGEST_PMU_VALID == parser->block))
+                {
+                    /* <MHz>.<100 kHz> <validity values> */
+                    parser->no_of_fields = 0;
+                    end_field(parser);
+                    parser->value = (uint64_t)(c - '0');
+                    parser->digits = 1;
+                    parser->state = ST_PMU_DATA;
+                }
+                else if ((' ' != c) && ('\t' != c) && ('\r' != c) && ('\n' != c))
+                {
+                    parser->state = ST_SKIP;
+                }
+                break;
+
+            case ST_TAG:
+                if (']' == c)
+                {
+                    parser->no_of_fields = 0;
+                    end_field(parser);
+                    parser->state = ST_FIELDS;
+                }
+                else if ('\n' == c)
+                {
+                    parser->state = ST_LINE_START;
+                }
+                else if (parser->tag_len < RTB_INGEST_MAX_TAG_LEN)
+                {
+                    parser->tag[parser->tag_len++] = c;
+                }
+                else
+                {
+                    parser->state = ST_SKIP;
+                }
+                break;
+
+            case ST_FIELDS:
+                if ((c >= '0') && (c <= '9'))
+                {
+                    parser->value = parser->value * (parser->hex ? 16 : 10) + (c - '0');
+                    parser->digits++;
+                }
+                else if (parser->hex && (((c | 0x20) >= 'a') && ((c | 0x20) <= 'f')))
+                {
+                    parser->value = parser->value * 16 + ((c | 0x20) - 'a' + 10);
+                    parser->digits++;
+                }
+                else if ((('x' == c) || ('X' == c)) &&
+                         (1 == parser->digits) && (0 == parser->value))
+                {
+                    parser->hex = true;
+                }
+                else if (('-' == c) && (0 == parser->digits))
+                {
+                    parser->negative = true;
+                }
+                else
+                {
+                    end_field(parser);
+                    if ('\n' == c)
+                    {
+                        handle_line(parser, rx_time_ns, publish, ctx);
+                        parser->state = ST_LINE_START;
+                    }
+                }
+                break;
+
+            case ST_PMU_DATA:
+                if (parser->no_of_fields < 2)
+                {
+                    if ((c >= '0') && (c <= '9'))
+                    {
+                        parser->value = parser->value * 10 + (c - '0');
+                        parser->digits++;
+                    }
+                    else
+                    {
+                        end_field(parser);
+                        if ((2 == parser->no_of_fields) && (0 == parser->rec.count))
+                        {
+                            parser->rec.start_freq =
+                                (uint16_t)(parser->field[0] * 2 + (parser->field[1] >= 5));
+                        }
+                    }
+                }
+                else if (('0' == c) || ('1' == c))
+                {
+                    rtb_ingest_record_t *rec = &parser->rec;
+
+                    if (rec->count < RTB_INGEST_MAX_PMU_VALUES)
+                    {
+                        if ('1' == c)
+                        {
+                            rec->u.pmu_valid[rec->count / 8] |=
+                                (uint8_t)(1 << (rec->count % 8));
+                        }
+                        rec->count++;
+                    }
+                }
+                if ('\n' == c)
+                {
+                    parser->state = ST_LINE_START;
+                }
+                break;
+
+            case ST_SKIP:
+                if ('\n' == c)
+                {
+                    parser->state = ST_LINE_START;
+                }
+                break;
+
+            case ST_SYNC:
+                if (FRAME_SYNC_1 == c)
+                {
+                    parser->frame_pos = 0;
+                    parser->crc = FRAME_CRC_INIT;
+                    parser->state = ST_FRAME;
+                }
+                else if (FRAME_SYNC_0 != c)
+                {
+                    parser->state = ST_SKIP;
+                }
+                break;
+
+            case ST_FRAME:
+                parser->frame[parser->frame_pos++] = c;
+                /* The CRC covers the length field and the payload. */
+                if ((parser->frame_pos <= 2) ||
+                    (parser->frame_pos <= 2 + parser->frame_len))
+                {
+                    parser->crc = crc_ccitt_update(parser->crc, c);
+                }
+                if (2 == parser->frame_pos)
+                {
+                    parser->frame_len = (uint16_t)(parser->frame[0] |
+                                                   (parser->frame[1] << 8));
+                    if ((parser->frame_len < FRAME_FIXED_LEN) ||
+                        (parser->frame_len > RTB_INGEST_FRAME_MAX_LEN))
+                    {
+                        /* Another frame type, e.g. a PMU capture frame */
+                        parser->state = (parser->frame_len <= FRAME_MAX_SKIP_LEN) ?
+                                        ST_FRAME_SKIP : ST_LINE_START;
+                    }
+                }
+                else if (parser->frame_pos == 2 + parser->frame_len + 2)
+                {
+                    handle_frame(parser, rx_time_ns, publish, ctx);
+                    parser->state = ST_LINE_START;
+                }
+                break;
+
+            case ST_FRAME_SKIP:
+                parser->frame_pos++;
+                if (parser->frame_pos == 2 + parser->frame_len + 2)
+                {
+                    parser->state = ST_LINE_START;
+                }
+                break;
+
+            default:
+                parser->state = ST_LINE_START;
+                break;
+        }
+    }
+}
+
+/* EOF */
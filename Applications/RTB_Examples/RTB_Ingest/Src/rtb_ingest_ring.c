@@ -0,0 +1,423 @@
+/**
+ * @file rtb_ingest_ring.c
+ *
+ * @brief Lock-free ring buffer of ingested records in shared memory
+ *
+ * Publishing record n into slot n & mask:
+ * - seq = 2n + 1 (slot is being written)
+ * - record is copied
+ * - seq = 2n + 2 (release), head = n + 1 (release)
+ * A consumer copies the slot and accepts the copy only if seq was 2n + 2
+ * before and after copying. If seq is beyond 2n + 2, the record has been
+ * overwritten and the consumer skips to the oldest record still available.
+ *
+ * Waiting consumers sleep on a futex in the header. The producer wakes
+ * them once per batch of records, not per record.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "rtb_ingest.h"
+
+/* === Prototypes ========================================================== */
+
+static uint64_t ring_map_size(uint32_t slots);
+static int ring_map(rtb_ingest_ring_t *ring, int fd, uint64_t size, int prot);
+static void futex_wake(uint32_t *addr);
+static void futex_wait(uint32_t *addr, uint32_t val, int timeout_ms);
+
+/* === Implementation ====================================================== */
+
+/* Size of the shared memory object */
+static uint64_t ring_map_size(uint32_t slots)
+{
+    return sizeof(rtb_ingest_ring_hdr_t) +
+           (uint64_t)slots * sizeof(rtb_ingest_slot_t);
+}
+
+
+
+/* Maps the shared memory object. */
+static int ring_map(rtb_ingest_ring_t *ring, int fd, uint64_t size, int prot)
+{
+    void *addr = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        return -1;
+    }
+
+    ring->hdr = (rtb_ingest_ring_hdr_t *)addr;
+    ring->slot = (rtb_ingest_slot_t *)(ring->hdr + 1);
+    ring->size = size;
+
+    return 0;
+}
+
+
+
+/* Wakes all processes waiting on a shared futex. */
+static void futex_wake(uint32_t *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+
+
+/* Waits on a shared futex while it has the given value. */
+static void futex_wait(uint32_t *addr, uint32_t val, int timeout_ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, addr, FUTEX_WAIT, val,
+            (timeout_ms < 0) ? NULL : &ts, NULL, 0);
+}
+
+
+
+/**
+ * @brief Creates the ring buffer as producer
+ *
+ * An existing ring buffer of the same name is replaced.
+ *
+ * @param ring Mapping of the ring buffer
+ * @param name Name of the shared memory object, e.g. "/rtb_ingest"
+ * @param slots Number of records, a power of 2
+ *
+ * @return 0 if successful, -1 otherwise (errno is set)
+ */
+int rtb_ingest_ring_create(rtb_ingest_ring_t *ring, const char *name,
+                           uint32_t slots)
+{
+    uint64_t size;
+    int fd;
+
+    if ((slots < 2) || (0 != (slots & (slots - 1))))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    size = ring_map_size(slots);
+
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    if (ring_map(ring, fd, size, PROT_READ | PROT_WRITE) < 0)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+
+    /* The object is zero filled, so all slots are invalid. */
+    ring->hdr->version = RTB_INGEST_VERSION;
+    ring->hdr->record_size = sizeof(rtb_ingest_record_t);
+    ring->hdr->slots = slots;
+    ring->hdr->producer_pid = (uint32_t)getpid();
+    ring->mask = slots - 1;
+    __atomic_store_n(&ring->hdr->magic, RTB_INGEST_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+
+/**
+ * @brief Attaches to the ring buffer as consumer
+ *
+ * @param ring Mapping of the ring buffer
+ * @param name Name of the shared memory object
+ *
+ * @return 0 if successful, -1 otherwise (errno is set)
+ */
+int rtb_ingest_ring_attach(rtb_ingest_ring_t *ring, const char *name)
+{
+    rtb_ingest_ring_hdr_t hdr;
+    struct stat st;
+    int fd;
+
+    memset(ring, 0, sizeof(*ring));
+
+    /* Read-write, since consumers wait on the futex in the header. */
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if ((fstat(fd, &st) < 0) || ((uint64_t)st.st_size < sizeof(hdr)) ||
+        (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)))
+    {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if ((RTB_INGEST_MAGIC != hdr.magic) ||
+        (RTB_INGEST_VERSION != hdr.version) ||
+        (sizeof(rtb_ingest_record_t) != hdr.record_size) ||
+        (0 == hdr.slots) || (0 != (hdr.slots & (hdr.slots - 1))) ||
+        ((uint64_t)st.st_size < ring_map_size(hdr.slots)))
+    {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    if (ring_map(ring, fd, ring_map_size(hdr.slots),
+                 PROT_READ | PROT_WRITE) < 0)
+    {
+        return -1;
+    }
+    ring->mask = hdr.slots - 1;
+
+    return 0;
+}
+
+
+
+/**
+ * @brief Unmaps the ring buffer
+ *
+ * @param ring Mapping of the ring buffer
+ */
+void rtb_ingest_ring_close(rtb_ingest_ring_t *ring)
+{
+    if (NULL != ring->hdr)
+    {
+        munmap(ring->hdr, ring->size);
+        ring->hdr = NULL;
+        ring->slot = NULL;
+    }
+}
+
+
+
+/**
+ * @brief Publishes a record
+ *
+ * Consumers waiting for records are not woken up before
+ * rtb_ingest_ring_wake() is called.
+ *
+ * @param ring Ring buffer created by this process
+ * @param rec Record to publish
+ */
+void rtb_ingest_ring_publish(rtb_ingest_ring_t *ring,
+                             const rtb_ingest_record_t *rec)
+{
+    uint64_t n = ring->head;
+    rtb_ingest_slot_t *slot = &ring->slot[n & ring->mask];
+
+    __atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->rec, rec, sizeof(*rec));
+    __atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+
+    ring->head = n + 1;
+    __atomic_store_n(&ring->hdr->head, n + 1, __ATOMIC_RELEASE);
+    ring->unwoken++;
+}
+
+
+
+/**
+ * @brief Wakes up consumers waiting for records
+ *
+ * Is called once after a batch of records has been published.
+ *
+ * @param ring Ring buffer created by this process
+ */
+void rtb_ingest_ring_wake(rtb_ingest_ring_t *ring)
+{
+    if (0 == ring->unwoken)
+    {
+        return;
+    }
+
+    ring->unwoken = 0;
+    __atomic_add_fetch(&ring->hdr->wake, 1, __ATOMIC_RELEASE);
+    futex_wake(&ring->hdr->wake);
+}
+
+
+
+/**
+ * @brief Initializes the read position of a consumer
+ *
+ * @param reader Read position
+ * @param ring Attached ring buffer
+ * @param from_oldest true to start at the oldest available record,
+ *                    false to start at the next published record
+ */
+void rtb_ingest_reader_init(rtb_ingest_reader_t *reader,
+                            const rtb_ingest_ring_t *ring,
+                            bool from_oldest)
+{
+    uint64_t head = __atomic_load_n(&ring->hdr->head, __ATOMIC_ACQUIRE);
+
+    reader->ring = ring;
+    reader->lost = 0;
+    reader->next = head;
+    if (from_oldest)
+    {
+        reader->next = (head > ring->mask) ? head - ring->mask : 0;
+    }
+}
+
+
+
+/**
+ * @brief Reads the next record
+ *
+ * @param reader Read position
+ * @param rec Returns the record
+ * @param timeout_ms Maximum time to wait for a record, -1 for no limit
+ *
+ * @return 1 if a record was read, 0 on timeout
+ */
+int rtb_ingest_read(rtb_ingest_reader_t *reader,
+                    rtb_ingest_record_t *rec, int timeout_ms)
+{
+    const rtb_ingest_ring_t *ring = reader->ring;
+    rtb_ingest_ring_hdr_t *hdr = ring->hdr;
+    bool waited = false;
+
+    for (;;)
+    {
+        uint64_t n = reader->next;
+        uint64_t head;
+        uint32_t wake;
+
+        wake = __atomic_load_n(&hdr->wake, __ATOMIC_ACQUIRE);
+        head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+
+        if (n < head)
+        {
+            const rtb_ingest_slot_t *slot = &ring->slot[n & ring->mask];
+            uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+            if (seq == 2 * n + 2)
+            {
+                memcpy(rec, &slot->rec, sizeof(*rec));
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq)
+                {
+                    reader->next = n + 1;
+                    return 1;
+                }
+            }
+
+            /* Overwritten; continue with the oldest record still valid. */
+            head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+            if (head > n + ring->mask)
+            {
+                reader->lost += head - ring->mask - n;
+                reader->next = head - ring->mask;
+            }
+            continue;
+        }
+
+        if ((0 == timeout_ms) || waited)
+        {
+            return 0;
+        }
+
+        futex_wait(&hdr->wake, wake, timeout_ms);
+        waited = (timeout_ms >= 0);
+    }
+}
+
+
+
+/**
+ * @brief Returns the current time (CLOCK_MONOTONIC)
+ *
+ * @return Time in ns
+ */
+uint64_t rtb_ingest_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+
+/**
+ * @brief Prints a record as one line of text
+ *
+ * Format: <port> <rx_time_ns> <type> <status> <distance> <DQF>
+ *         <initiator> <reflector> <flags> <count> [<pairs> | <vector>]
+ * The distance of a failed ranging is -1.
+ *
+ * @param rec Record to print
+ */
+void rtb_ingest_print_record(const rtb_ingest_record_t *rec)
+{
+    static const char *const type_name[] = { "?", "RESULT", "ERROR", "PMU_VALID" };
+
+    printf("%u %llu %s 0x%02X %ld %u 0x%llX 0x%llX 0x%02X %u",
+           rec->port, (unsigned long long)rec->rx_time_ns,
+           type_name[(rec->type <= RTB_INGEST_PMU_VALID) ? rec->type : 0],
+           rec->status,
+           (RTB_INGEST_INVALID_DISTANCE == rec->distance) ? -1L : (long)rec->distance,
+           rec->dqf,
+           (unsigned long long)rec->initiator,
+           (unsigned long long)rec->reflector,
+           rec->flags, rec->count);
+
+    if (RTB_INGEST_PMU_VALID == rec->type)
+    {
+        printf(" %u %u.%u ", rec->ant_meas,
+               rec->start_freq / 2, (rec->start_freq & 1) ? 5 : 0);
+        for (uint8_t i = 0; i < rec->count; i++)
+        {
+            putchar((rec->u.pmu_valid[i / 8] & (1 << (i % 8))) ? '1' : '0');
+        }
+    }
+    else
+    {
+        for (uint8_t i = 0; (i < rec->count) && (i < RTB_INGEST_MAX_PAIRS); i++)
+        {
+            printf(" %lu %u", (unsigned long)rec->u.pairs.distance[i],
+                   rec->u.pairs.dqf[i]);
+        }
+    }
+    putchar('\n');
+}
+
+/* EOF */
@@ -0,0 +1,166 @@
+/**
+ * @file rtb_pmu_batch.h
+ *
+ * @brief Batch PMU to distance calculation for host-side reprocessing
+ *
+ * This library calculates distance and DQF of many PMU measurements per
+ * call, e.g. to reprocess captured averaged PMU values with different
+ * parameters. It uses the SIMD extensions of the host (SSE2, AVX2) where
+ * available. The results are identical to the results of rtb_pmu_math.c,
+ * the open port of the PMU calculation used by the Linux port of the RTB,
+ * since the phase steps are summed in integer arithmetic with the same
+ * cosine table and the final calculation is done by rtb_pmu_math.c itself
+ * (see rtb_pmu_math.h). They are not verified against the closed PMU
+ * library (lib_rtb_pmu_233r.a) or against distances reported by the
+ * firmware.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_PMU_BATCH_H
+#define RTB_PMU_BATCH_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* === Macros =============================================================== */
+
+/** Maximum number of antenna measurement pairs of a measurement */
+#define RTB_PMU_BATCH_MAX_ANT_MEAS      (4)
+
+/* === Types ================================================================ */
+
+/**
+ * Implementation of the batch calculation
+ */
+typedef enum rtb_pmu_batch_impl_tag
+{
+    /** Best implementation supported by the host */
+    RTB_PMU_BATCH_AUTO,
+    /** Plain C, i.e. the calculation of the RTB */
+    RTB_PMU_BATCH_SCALAR,
+    /** SSE2 */
+    RTB_PMU_BATCH_SSE2,
+    /** AVX2 */
+    RTB_PMU_BATCH_AVX2
+} rtb_pmu_batch_impl_t;
+
+/**
+ * Averaged PMU values of one measurement
+ *
+ * The members have the same meaning as the members of pmu_avg_data_t,
+ * see rtb_api.h, i.e. the values of antenna measurement pair n start at
+ * p_pmu_avg_init/p_pmu_avg_refl + n * ant_meas_ptr_offset.
+ */
+typedef struct rtb_pmu_batch_meas_tag
+{
+    /** Offset between the value arrays of the antenna measurement pairs */
+    uint16_t ant_meas_ptr_offset;
+    /** Number of antenna measurement pairs */
+    uint8_t no_of_ant_meas;
+    /** Number of frequencies */
+    uint8_t no_of_freq;
+    /** Averaged PMU values of the Initiator */
+    const uint8_t *p_pmu_avg_init;
+    /** Averaged PMU values of the Reflector */
+    const uint8_t *p_pmu_avg_refl;
+} rtb_pmu_batch_meas_t;
+
+/**
+ * Ranging parameters applying to all measurements of a batch
+ */
+typedef struct rtb_pmu_batch_param_tag
+{
+    /** Frequency step (PMU_STEP_FREQ_500kHz .. PMU_STEP_FREQ_4MHz) */
+    uint8_t f_step;
+    /** Distance offset in cm (RTB_PIB_DISTANCE_OFFSET) */
+    int8_t dist_offset;
+    /** Use the minimum distance instead of the weighted average */
+    bool apply_min_dist_threshold;
+} rtb_pmu_batch_param_t;
+
+/**
+ * Result of one measurement
+ *
+ * Measurements without valid values, i.e. with less than two frequencies,
+ * no or too many antenna measurement pairs or missing values, result in
+ * distance 0xFFFFFFFF (INVALID_DISTANCE) and DQF 0.
+ */
+typedef struct rtb_pmu_batch_result_tag
+{
+    /** Distance in cm */
+    uint32_t distance_cm;
+    /** Distance quality factor in percent */
+    uint8_t dqf;
+    /** Distance per antenna measurement pair in cm */
+    uint32_t measured_distance_cm[RTB_PMU_BATCH_MAX_ANT_MEAS];
+    /** Distance quality factor per antenna measurement pair in percent */
+    uint8_t measured_dqf[RTB_PMU_BATCH_MAX_ANT_MEAS];
+} rtb_pmu_batch_result_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the library
+ *
+ * This function needs to be called once before any other function.
+ */
+void rtb_pmu_batch_init(void);
+
+/**
+ * @brief Gets the implementation used for a requested implementation
+ *
+ * @param impl Requested implementation
+ *
+ * @return impl if supported by the host, otherwise the best supported
+ *         implementation below impl
+ */
+rtb_pmu_batch_impl_t rtb_pmu_batch_select(rtb_pmu_batch_impl_t impl);
+
+/**
+ * @brief Gets the name of an implementation
+ */
+const char *rtb_pmu_batch_impl_name(rtb_pmu_batch_impl_t impl);
+
+/**
+ * @brief Calculates distance and DQF of a batch of measurements
+ *
+ * @param impl Implementation, see rtb_pmu_batch_select()
+ * @param param Ranging parameters
+ * @param meas Measurements
+ * @param count Number of measurements
+ * @param[out] result Results, count entries
+ *
+ * @return Number of measurements with a valid distance
+ */
+size_t rtb_pmu_batch_calc(rtb_pmu_batch_impl_t impl,
+                          const rtb_pmu_batch_param_t *param,
+                          const rtb_pmu_batch_meas_t *meas,
+                          size_t count,
+                          rtb_pmu_batch_result_t *result);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* RTB_PMU_BATCH_H */
+/* EOF */
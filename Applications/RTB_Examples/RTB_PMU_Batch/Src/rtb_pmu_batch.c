@@ -0,0 +1,375 @@
+/**
+ * @file rtb_pmu_batch.c
+ *
+ * @brief Batch PMU to distance calculation for host-side reprocessing
+ *
+ * The run time of the distance calculation is dominated by summing the
+ * phase steps of all frequencies as unit vectors. The SIMD implementations
+ * vectorize this part:
+ * - SSE2 calculates the phase steps of 16 frequencies at once and looks up
+ *   cosine and sine by one access to a table holding both as 64 bit value.
+ * - AVX2 calculates 8 phase steps at once and looks up their cosine and
+ *   sine by one gather instruction.
+ * Since the sums are calculated in integer arithmetic with the cosine
+ * table of the RTB, they are identical for all implementations. Distance
+ * and DQF are calculated from the sums by rtb_pmu_math.c.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtb_pmu_math.h"
+#include "rtb_pmu_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RTB_PMU_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/* === Macros ============================================================== */
+
+/** Number of different phase steps (1/256 cycles) */
+#define PMU_BATCH_NO_OF_STEPS           (256)
+
+/* === Types =============================================================== */
+
+/** Function summing the phase steps of an antenna measurement pair */
+typedef void (*sum_steps_func_t)(const uint8_t *init_val,
+                                 const uint8_t *refl_val,
+                                 uint8_t no_of_freq,
+                                 int32_t *sum_cos,
+                                 int32_t *sum_sin);
+
+/* === Globals ============================================================= */
+
+#ifdef RTB_PMU_BATCH_X86
+/** Cosine (bits 0..15) and sine (bits 16..31) of each phase step in Q14 */
+static int32_t pmu_cos_sin_32[PMU_BATCH_NO_OF_STEPS];
+
+/**
+ * Cosine (bits 0..31) and sine (bits 32..63) of each phase step in Q14
+ *
+ * The sum of n entries is sum_sin * 2^32 + sum_cos, since sum_cos never
+ * exceeds 2^31 in magnitude.
+ */
+static int64_t pmu_cos_sin_64[PMU_BATCH_NO_OF_STEPS];
+#endif  /* RTB_PMU_BATCH_X86 */
+
+/* === Prototypes ========================================================== */
+
+#ifdef RTB_PMU_BATCH_X86
+static void sum_steps_sse2(const uint8_t *init_val,
+                           const uint8_t *refl_val,
+                           uint8_t no_of_freq,
+                           int32_t *sum_cos,
+                           int32_t *sum_sin);
+static void sum_steps_avx2(const uint8_t *init_val,
+                           const uint8_t *refl_val,
+                           uint8_t no_of_freq,
+                           int32_t *sum_cos,
+                           int32_t *sum_sin);
+#endif  /* RTB_PMU_BATCH_X86 */
+static bool meas_is_valid(const rtb_pmu_batch_meas_t *meas);
+
+/* === Implementation ====================================================== */
+
+void rtb_pmu_batch_init(void)
+{
+#ifdef RTB_PMU_BATCH_X86
+    for (uint16_t step = 0; step < PMU_BATCH_NO_OF_STEPS; step++)
+    {
+        int16_t c = pmu_math_cos_q14((uint8_t)step);
+        int16_t s = pmu_math_sin_q14((uint8_t)step);
+
+        pmu_cos_sin_32[step] = (int32_t)(((uint32_t)(uint16_t)s << 16) |
+                                         (uint16_t)c);
+        pmu_cos_sin_64[step] = (int64_t)s * ((int64_t)1 << 32) + c;
+    }
+
+    __builtin_cpu_init();
+#endif  /* RTB_PMU_BATCH_X86 */
+}
+
+
+
+rtb_pmu_batch_impl_t rtb_pmu_batch_select(rtb_pmu_batch_impl_t impl)
+{
+#ifdef RTB_PMU_BATCH_X86
+    if (RTB_PMU_BATCH_AUTO == impl)
+    {
+        impl = RTB_PMU_BATCH_AVX2;
+    }
+    if ((RTB_PMU_BATCH_AVX2 == impl) && !__builtin_cpu_supports("avx2"))
+    {
+        impl = RTB_PMU_BATCH_SSE2;
+    }
+    if ((RTB_PMU_BATCH_SSE2 == impl) && !__builtin_cpu_supports("sse2"))
+    {
+        impl = RTB_PMU_BATCH_SCALAR;
+    }
+
+    return impl;
+#else
+    impl = impl; /* Keep compiler happy. */
+
+    return RTB_PMU_BATCH_SCALAR;
+#endif  /* RTB_PMU_BATCH_X86 */
+}
+
+
+
+const char *rtb_pmu_batch_impl_name(rtb_pmu_batch_impl_t impl)
+{
+    switch (impl)
+    {
+        case RTB_PMU_BATCH_AUTO:    return "auto";
+        case RTB_PMU_BATCH_SCALAR:  return "scalar";
+        case RTB_PMU_BATCH_SSE2:    return "sse2";
+        case RTB_PMU_BATCH_AVX2:    return "avx2";
+        default:                    return "unknown";
+    }
+}
+
+
+
+size_t rtb_pmu_batch_calc(rtb_pmu_batch_impl_t impl,
+                          const rtb_pmu_batch_param_t *param,
+                          const rtb_pmu_batch_meas_t *meas,
+                          size_t count,
+                          rtb_pmu_batch_result_t *result)
+{
+    sum_steps_func_t sum_steps = pmu_math_sum_steps;
+    size_t valid = 0;
+
+#ifdef RTB_PMU_BATCH_X86
+    switch (rtb_pmu_batch_select(impl))
+    {
+        case RTB_PMU_BATCH_AVX2:
+            sum_steps = sum_steps_avx2;
+            break;
+
+        case RTB_PMU_BATCH_SSE2:
+            sum_steps = sum_steps_sse2;
+            break;
+
+        default:
+            break;
+    }
+#else
+    impl = impl; /* Keep compiler happy. */
+#endif  /* RTB_PMU_BATCH_X86 */
+
+    for (size_t m = 0; m < count; m++, meas++, result++)
+    {
+        uint8_t ant_meas;
+
+        for (ant_meas = 0; ant_meas < RTB_PMU_BATCH_MAX_ANT_MEAS; ant_meas++)
+        {
+            result->measured_distance_cm[ant_meas] = PMU_MATH_INVALID_DISTANCE;
+            result->measured_dqf[ant_meas] = 0;
+        }
+
+        if (!meas_is_valid(meas))
+        {
+            result->distance_cm = PMU_MATH_INVALID_DISTANCE;
+            result->dqf = 0;
+            continue;
+        }
+
+        for (ant_meas = 0; ant_meas < meas->no_of_ant_meas; ant_meas++)
+        {
+            size_t offset = (size_t)ant_meas * meas->ant_meas_ptr_offset;
+            int32_t sum_cos;
+            int32_t sum_sin;
+
+            sum_steps(meas->p_pmu_avg_init + offset,
+                      meas->p_pmu_avg_refl + offset,
+                      meas->no_of_freq,
+                      &sum_cos,
+                      &sum_sin);
+
+            pmu_math_steps_2_dist(sum_cos,
+                                  sum_sin,
+                                  meas->no_of_freq,
+                                  param->f_step,
+                                  param->dist_offset,
+                                  &result->measured_distance_cm[ant_meas],
+                                  &result->measured_dqf[ant_meas]);
+        }
+
+        pmu_math_combine(result->measured_distance_cm,
+                         result->measured_dqf,
+                         meas->no_of_ant_meas,
+                         param->apply_min_dist_threshold,
+                         &result->distance_cm,
+                         &result->dqf);
+
+        if (PMU_MATH_INVALID_DISTANCE != result->distance_cm)
+        {
+            valid++;
+        }
+    }
+
+    return valid;
+}
+
+
+
+/**
+ * @brief Checks whether a measurement contains PMU values
+ */
+static bool meas_is_valid(const rtb_pmu_batch_meas_t *meas)
+{
+    return ((NULL != meas->p_pmu_avg_init) &&
+            (NULL != meas->p_pmu_avg_refl) &&
+            (meas->no_of_freq >= 2) &&
+            (meas->no_of_ant_meas > 0) &&
+            (meas->no_of_ant_meas <= RTB_PMU_BATCH_MAX_ANT_MEAS) &&
+            ((meas->no_of_ant_meas == 1) ||
+             (meas->ant_meas_ptr_offset >= meas->no_of_freq)));
+}
+
+
+
+#ifdef RTB_PMU_BATCH_X86
+/**
+ * @brief Sums the phase steps of an antenna measurement pair using SSE2
+ *
+ * See pmu_math_sum_steps() for the parameters.
+ */
+__attribute__((target("sse2")))
+static void sum_steps_sse2(const uint8_t *init_val,
+                           const uint8_t *refl_val,
+                           uint8_t no_of_freq,
+                           int32_t *sum_cos,
+                           int32_t *sum_sin)
+{
+    uint8_t steps[PMU_BATCH_NO_OF_STEPS];
+    uint16_t no_of_steps = no_of_freq - 1;
+    uint16_t i;
+    int64_t sum0 = 0;
+    int64_t sum1 = 0;
+    int32_t sc;
+
+    /* Phase step from frequency i - 1 to i is stored at steps[i - 1]. */
+    for (i = 1; (i + 16) <= no_of_freq; i += 16)
+    {
+        __m128i curr = _mm_add_epi8(_mm_loadu_si128((const __m128i *)&init_val[i]),
+                                    _mm_loadu_si128((const __m128i *)&refl_val[i]));
+        __m128i prev = _mm_add_epi8(_mm_loadu_si128((const __m128i *)&init_val[i - 1]),
+                                    _mm_loadu_si128((const __m128i *)&refl_val[i - 1]));
+
+        _mm_storeu_si128((__m128i *)&steps[i - 1], _mm_sub_epi8(curr, prev));
+    }
+    for (; i < no_of_freq; i++)
+    {
+        steps[i - 1] = (uint8_t)((init_val[i] + refl_val[i]) -
+                                 (init_val[i - 1] + refl_val[i - 1]));
+    }
+
+    /* Two independent sums to hide the latency of the table accesses */
+    for (i = 0; (i + 2) <= no_of_steps; i += 2)
+    {
+        sum0 += pmu_cos_sin_64[steps[i]];
+        sum1 += pmu_cos_sin_64[steps[i + 1]];
+    }
+    if (i < no_of_steps)
+    {
+        sum0 += pmu_cos_sin_64[steps[i]];
+    }
+
+    sum0 += sum1;
+    sc = (int32_t)(uint32_t)sum0;
+    *sum_cos = sc;
+    *sum_sin = (int32_t)((sum0 - sc) / ((int64_t)1 << 32));
+}
+
+
+
+/**
+ * @brief Sums the phase steps of an antenna measurement pair using AVX2
+ *
+ * The phase sums are stored in a local buffer first, so that the phase
+ * steps can be calculated in chunks of 8 without reading beyond the PMU
+ * values of the caller. Lanes beyond the last phase step are cleared
+ * before they are accumulated.
+ *
+ * See pmu_math_sum_steps() for the parameters.
+ */
+__attribute__((target("avx2")))
+static void sum_steps_avx2(const uint8_t *init_val,
+                           const uint8_t *refl_val,
+                           uint8_t no_of_freq,
+                           int32_t *sum_cos,
+                           int32_t *sum_sin)
+{
+    uint8_t curr[PMU_BATCH_NO_OF_STEPS + 8];
+    uint16_t no_of_steps = no_of_freq - 1;
+    __m256i acc_cos = _mm256_setzero_si256();
+    __m256i acc_sin = _mm256_setzero_si256();
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m128i sum;
+    uint16_t i;
+
+    for (i = 0; (i + 32) <= no_of_freq; i += 32)
+    {
+        _mm256_storeu_si256((__m256i *)&curr[i],
+                            _mm256_add_epi8(_mm256_loadu_si256((const __m256i *)&init_val[i]),
+                                            _mm256_loadu_si256((const __m256i *)&refl_val[i])));
+    }
+    for (; i < no_of_freq; i++)
+    {
+        curr[i] = (uint8_t)(init_val[i] + refl_val[i]);
+    }
+
+    /* Phase step from frequency i to i + 1 is in lane i % 8. */
+    for (i = 0; i < no_of_steps; i += 8)
+    {
+        __m128i step = _mm_sub_epi8(_mm_loadl_epi64((const __m128i *)&curr[i + 1]),
+                                    _mm_loadl_epi64((const __m128i *)&curr[i]));
+        __m256i cs = _mm256_i32gather_epi32(pmu_cos_sin_32,
+                                            _mm256_cvtepu8_epi32(step),
+                                            4);
+
+        if ((i + 8) > no_of_steps)
+        {
+            __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(no_of_steps - i),
+                                               lane);
+
+            cs = _mm256_and_si256(cs, valid);
+        }
+
+        /* Sign extension of the lower and upper 16 bits */
+        acc_cos = _mm256_add_epi32(acc_cos,
+                                   _mm256_srai_epi32(_mm256_slli_epi32(cs, 16), 16));
+        acc_sin = _mm256_add_epi32(acc_sin, _mm256_srai_epi32(cs, 16));
+    }
+
+    /* Horizontal sums */
+    sum = _mm_add_epi32(_mm256_castsi256_si128(acc_cos),
+                        _mm256_extracti128_si256(acc_cos, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    *sum_cos = _mm_cvtsi128_si32(sum);
+
+    sum = _mm_add_epi32(_mm256_castsi256_si128(acc_sin),
+                        _mm256_extracti128_si256(acc_sin, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    *sum_sin = _mm_cvtsi128_si32(sum);
+}
+#endif  /* RTB_PMU_BATCH_X86 */
+
+/* EOF */
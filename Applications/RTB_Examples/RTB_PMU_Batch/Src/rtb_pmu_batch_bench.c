@@ -0,0 +1,419 @@
+/**
+ * @file rtb_pmu_batch_bench.c
+ *
+ * @brief Benchmark of the batch PMU to distance calculation
+ *
+ * The benchmark generates averaged PMU values of random distances with
+ * phase noise and outliers, calculates distance and DQF with every
+ * implementation supported by the host and reports the throughput in
+ * measurements per second. Each result is compared with the result of
+ * rtb_pmu_math.c, the benchmark fails on any difference.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "rtb_pmu_math.h"
+#include "rtb_pmu_batch.h"
+
+/* === Macros ============================================================== */
+
+/** Default number of measurements per batch */
+#define BENCH_DEFAULT_MEAS              (10000)
+
+/** Default frequency step (2 MHz, PMU_STEP_FREQ_DEFAULT) */
+#define BENCH_DEFAULT_F_STEP            (2)
+
+/** Default start and stop frequency in MHz (PMU_START/STOP_FREQ_DEFAULT) */
+#define BENCH_DEFAULT_START_MHZ         (2403)
+#define BENCH_DEFAULT_STOP_MHZ          (2443)
+
+/** Default number of batches per implementation */
+#define BENCH_DEFAULT_ROUNDS            (20)
+
+/** Maximum distance of the generated measurements in m */
+#define BENCH_MAX_DISTANCE_M            (60.0)
+
+/** Speed of light in m/s */
+#define SPEED_OF_LIGHT                  (299792458.0)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/** State of the random generator */
+static uint32_t rnd_state = 1;
+
+/* === Prototypes ========================================================== */
+
+static void usage(const char *prog);
+static uint32_t bench_rand(void);
+static void generate(rtb_pmu_batch_meas_t *meas, uint8_t *values,
+                     uint32_t count, uint8_t no_of_ant_meas,
+                     uint8_t no_of_freq, uint16_t start_mhz, uint8_t f_step,
+                     uint8_t noise, uint16_t outlier_permille);
+static void reference(const rtb_pmu_batch_param_t *param,
+                      const rtb_pmu_batch_meas_t *meas,
+                      rtb_pmu_batch_result_t *result);
+static bool results_equal(const rtb_pmu_batch_result_t *a,
+                          const rtb_pmu_batch_result_t *b,
+                          uint8_t no_of_ant_meas);
+static double wall_clock_s(void);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Main function of the benchmark
+ */
+int main(int argc, char *argv[])
+{
+    static const rtb_pmu_batch_impl_t impls[] =
+    {
+        RTB_PMU_BATCH_SCALAR,
+        RTB_PMU_BATCH_SSE2,
+        RTB_PMU_BATCH_AVX2
+    };
+    rtb_pmu_batch_param_t param = { BENCH_DEFAULT_F_STEP, 0, false };
+    uint32_t count = BENCH_DEFAULT_MEAS;
+    uint32_t rounds = BENCH_DEFAULT_ROUNDS;
+    uint16_t start_mhz = BENCH_DEFAULT_START_MHZ;
+    uint16_t stop_mhz = BENCH_DEFAULT_STOP_MHZ;
+    uint8_t no_of_ant_meas = 1;
+    uint8_t noise = 4;
+    uint16_t outlier_permille = 20;
+    uint32_t no_of_freq;
+    rtb_pmu_batch_meas_t *meas;
+    rtb_pmu_batch_result_t *ref;
+    rtb_pmu_batch_result_t *result;
+    uint8_t *values;
+    double scalar_rate = 0.0;
+    bool failed = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:b:e:f:a:p:o:mh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                count = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                rounds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                start_mhz = (uint16_t)atoi(optarg);
+                break;
+
+            case 'e':
+                stop_mhz = (uint16_t)atoi(optarg);
+                break;
+
+            case 'f':
+                param.f_step = (uint8_t)atoi(optarg);
+                break;
+
+            case 'a':
+                no_of_ant_meas = (uint8_t)atoi(optarg);
+                break;
+
+            case 'p':
+                noise = (uint8_t)atoi(optarg);
+                break;
+
+            case 'o':
+                outlier_permille = (uint16_t)atoi(optarg);
+                break;
+
+            case 'm':
+                param.apply_min_dist_threshold = true;
+                break;
+
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (param.f_step > 3)
+    {
+        fprintf(stderr, "Frequency step must be 0 .. 3\n");
+        return EXIT_FAILURE;
+    }
+    if ((no_of_ant_meas < 1) || (no_of_ant_meas > RTB_PMU_BATCH_MAX_ANT_MEAS))
+    {
+        fprintf(stderr, "Number of antenna measurement pairs must be 1 .. %u\n",
+                RTB_PMU_BATCH_MAX_ANT_MEAS);
+        return EXIT_FAILURE;
+    }
+    /* Frequency steps are given in units of 500 kHz. */
+    no_of_freq = (stop_mhz > start_mhz) ?
+                 (((uint32_t)(stop_mhz - start_mhz) * 2) >> param.f_step) + 1 : 0;
+    if ((no_of_freq < 2) || (no_of_freq > 255) || (0 == count))
+    {
+        fprintf(stderr, "Invalid number of frequencies (%u) or measurements\n",
+                no_of_freq);
+        return EXIT_FAILURE;
+    }
+
+    meas = malloc(count * sizeof(*meas));
+    ref = malloc(count * sizeof(*ref));
+    result = malloc(count * sizeof(*result));
+    values = malloc((size_t)count * no_of_ant_meas * no_of_freq * 2);
+    if ((NULL == meas) || (NULL == ref) || (NULL == result) || (NULL == values))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    rtb_pmu_batch_init();
+
+    generate(meas, values, count, no_of_ant_meas, (uint8_t)no_of_freq,
+             start_mhz, param.f_step, noise, outlier_permille);
+    for (uint32_t m = 0; m < count; m++)
+    {
+        reference(&param, &meas[m], &ref[m]);
+    }
+
+    printf("%u measurements, %u antenna pair(s), %u frequencies, "
+           "%u rounds\n",
+           count, no_of_ant_meas, no_of_freq, rounds);
+    printf("%-8s %14s %8s %10s\n", "impl", "meas/s", "speedup", "mismatch");
+
+    for (uint8_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+    {
+        rtb_pmu_batch_impl_t impl = impls[i];
+        uint32_t mismatch = 0;
+        double start;
+        double rate;
+
+        if (rtb_pmu_batch_select(impl) != impl)
+        {
+            printf("%-8s %14s\n", rtb_pmu_batch_impl_name(impl),
+                   "not supported");
+            continue;
+        }
+
+        memset(result, 0, count * sizeof(*result));
+        start = wall_clock_s();
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            rtb_pmu_batch_calc(impl, &param, meas, count, result);
+        }
+        rate = (double)count * rounds / (wall_clock_s() - start);
+
+        for (uint32_t m = 0; m < count; m++)
+        {
+            if (!results_equal(&result[m], &ref[m], no_of_ant_meas))
+            {
+                mismatch++;
+            }
+        }
+
+        if (RTB_PMU_BATCH_SCALAR == impl)
+        {
+            scalar_rate = rate;
+        }
+        printf("%-8s %14.0f %7.2fx %10u\n", rtb_pmu_batch_impl_name(impl),
+               rate, (scalar_rate > 0.0) ? rate / scalar_rate : 0.0,
+               mismatch);
+
+        if (mismatch > 0)
+        {
+            failed = true;
+        }
+    }
+
+    free(values);
+    free(result);
+    free(ref);
+    free(meas);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief Prints the command line options
+ */
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <count>     measurements per batch (default %u)\n"
+           "  -r <rounds>    batches per implementation (default %u)\n"
+           "  -b <MHz>       start frequency (default %u MHz)\n"
+           "  -e <MHz>       stop frequency (default %u MHz)\n"
+           "  -f <step>      frequency step 0 .. 3 (default %u)\n"
+           "  -a <pairs>     antenna measurement pairs 1 .. %u (default 1)\n"
+           "  -p <lsb>       PMU phase noise (default 4)\n"
+           "  -o <permille>  PMU outliers (default 20)\n"
+           "  -m             use minimum distance of the antenna pairs\n",
+           prog, BENCH_DEFAULT_MEAS, BENCH_DEFAULT_ROUNDS,
+           BENCH_DEFAULT_START_MHZ, BENCH_DEFAULT_STOP_MHZ,
+           BENCH_DEFAULT_F_STEP, RTB_PMU_BATCH_MAX_ANT_MEAS);
+}
+
+
+
+/**
+ * @brief Random numbers of the benchmark (xorshift32)
+ */
+static uint32_t bench_rand(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+
+    return rnd_state;
+}
+
+
+
+/**
+ * @brief Generates averaged PMU values of random distances
+ *
+ * The sum of the phases of Initiator and Reflector at frequency f is
+ * 2 * f * d / c cycles plus an arbitrary offset; the phase is split
+ * randomly between both nodes.
+ */
+static void generate(rtb_pmu_batch_meas_t *meas, uint8_t *values,
+                     uint32_t count, uint8_t no_of_ant_meas,
+                     uint8_t no_of_freq, uint16_t start_mhz, uint8_t f_step,
+                     uint8_t noise, uint16_t outlier_permille)
+{
+    size_t per_node = (size_t)no_of_ant_meas * no_of_freq;
+
+    for (uint32_t m = 0; m < count; m++)
+    {
+        uint8_t *init_val = values + m * per_node * 2;
+        uint8_t *refl_val = init_val + per_node;
+        double dist_m = BENCH_MAX_DISTANCE_M * (bench_rand() & 0xFFFF) / 65536.0;
+
+        meas[m].ant_meas_ptr_offset = no_of_freq;
+        meas[m].no_of_ant_meas = no_of_ant_meas;
+        meas[m].no_of_freq = no_of_freq;
+        meas[m].p_pmu_avg_init = init_val;
+        meas[m].p_pmu_avg_refl = refl_val;
+
+        for (size_t k = 0; k < per_node; k++)
+        {
+            /* Each antenna pair sees a slightly different path. */
+            double path_m = dist_m + 0.1 * (double)(k / no_of_freq);
+            double f_hz = start_mhz * 1e6 + (k % no_of_freq) * 500e3 * (1 << f_step);
+            double cycles = 2.0 * f_hz * path_m / SPEED_OF_LIGHT;
+            int32_t phase = (int32_t)lround((cycles - floor(cycles)) * 256.0);
+
+            if (noise > 0)
+            {
+                phase += (int32_t)(bench_rand() % (2 * noise + 1)) - noise;
+            }
+            if ((bench_rand() % 1000) < outlier_permille)
+            {
+                phase = (int32_t)bench_rand();
+            }
+
+            init_val[k] = (uint8_t)bench_rand();
+            refl_val[k] = (uint8_t)(phase - init_val[k]);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Calculates a measurement by rtb_pmu_math.c
+ *
+ * This is the calculation of pmu_math_pmu_2_dist() in rtb_pmu_233r_linux.c.
+ */
+static void reference(const rtb_pmu_batch_param_t *param,
+                      const rtb_pmu_batch_meas_t *meas,
+                      rtb_pmu_batch_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    for (uint8_t ant_meas = 0; ant_meas < meas->no_of_ant_meas; ant_meas++)
+    {
+        const uint8_t *init_val = meas->p_pmu_avg_init +
+                                  ant_meas * meas->ant_meas_ptr_offset;
+        const uint8_t *refl_val = meas->p_pmu_avg_refl +
+                                  ant_meas * meas->ant_meas_ptr_offset;
+        int32_t sum_cos;
+        int32_t sum_sin;
+
+        pmu_math_sum_steps(init_val, refl_val, meas->no_of_freq,
+                           &sum_cos, &sum_sin);
+        pmu_math_steps_2_dist(sum_cos, sum_sin, meas->no_of_freq,
+                              param->f_step, param->dist_offset,
+                              &result->measured_distance_cm[ant_meas],
+                              &result->measured_dqf[ant_meas]);
+    }
+
+    pmu_math_combine(result->measured_distance_cm,
+                     result->measured_dqf,
+                     meas->no_of_ant_meas,
+                     param->apply_min_dist_threshold,
+                     &result->distance_cm,
+                     &result->dqf);
+}
+
+
+
+/**
+ * @brief Compares two results
+ */
+static bool results_equal(const rtb_pmu_batch_result_t *a,
+                          const rtb_pmu_batch_result_t *b,
+                          uint8_t no_of_ant_meas)
+{
+    if ((a->distance_cm != b->distance_cm) || (a->dqf != b->dqf))
+    {
+        return false;
+    }
+
+    for (uint8_t ant_meas = 0; ant_meas < no_of_ant_meas; ant_meas++)
+    {
+        if ((a->measured_distance_cm[ant_meas] != b->measured_distance_cm[ant_meas]) ||
+            (a->measured_dqf[ant_meas] != b->measured_dqf[ant_meas]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Gets the monotonic wall clock in s
+ */
+static double wall_clock_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* EOF */
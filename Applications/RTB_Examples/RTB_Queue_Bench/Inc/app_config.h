@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @brief Definition of application-specific constants.
+ *
+ * The queue benchmark uses the buffer and queue management only, so the
+ * buffer pool is sized for the largest indirect data queue possible.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/* === Includes ============================================================= */
+
+#include "stack_config.h"
+
+/* === Macros =============================================================== */
+
+/** Defines the total number of timers used by the application and the layers below. */
+#define TOTAL_NUMBER_OF_TIMERS      (0)
+
+/**
+ *  Defines the total number of large buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_LARGE_BUFS  (250)
+
+/**
+ *  Defines the total number of small buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_SMALL_BUFS  (0)
+
+/**
+ *  Defines the total number of small and large buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_BUFS        (TOTAL_NUMBER_OF_LARGE_BUFS + TOTAL_NUMBER_OF_SMALL_BUFS)
+
+#endif /* APP_CONFIG_H */
+/* EOF */
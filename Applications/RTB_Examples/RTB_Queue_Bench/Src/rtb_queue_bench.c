@@ -0,0 +1,408 @@
+/**
+ * @file rtb_queue_bench.c
+ *
+ * @brief Benchmark of the keyed queue index
+ *
+ * The benchmark models the indirect data queue of a coordinator serving
+ * many devices. The queue is filled with frames for a number of devices.
+ * Then devices poll randomly; each poll looks up the first frame for the
+ * device, looks up a second one for the frame pending bit, and removes the
+ * first frame as the MAC does after its transmission. A new frame is
+ * queued for each removed one, so the queue stays filled. Every eighth
+ * poll an MSDU handle is purged.
+ *
+ * The same sequence is run on a queue searched linearly with
+ * qmm_queue_read() and qmm_queue_remove(), as the MAC does without
+ * ENABLE_QUEUE_INDEX, and on an indexed queue. The time per poll and per
+ * purge is reported, and the benchmark fails if both queues do not find
+ * the same frames.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "pal.h"
+#include "bmm.h"
+#include "qmm.h"
+#include "app_config.h"
+
+/* === Macros ============================================================== */
+
+/** Default number of queued frames */
+#define BENCH_DEFAULT_FRAMES            (240)
+
+/** Default number of devices the frames are queued for */
+#define BENCH_DEFAULT_DEVICES           (60)
+
+/** Default number of polls */
+#define BENCH_DEFAULT_POLLS             (200000)
+
+/** Short address of the first device */
+#define BENCH_FIRST_ADDR                (0x1000)
+
+/** Keys of the index, as used by the MAC */
+#define BENCH_KEY_DST_ADDR              (0)
+#define BENCH_KEY_MSDU_HANDLE           (1)
+
+/* === Types =============================================================== */
+
+/** Indirect data frame as far as the queue search is concerned */
+typedef struct bench_frame_tag
+{
+    uint16_t dst_addr;
+    uint8_t msdu_handle;
+    bool indirect_in_transit;
+} bench_frame_t;
+
+/** Result of one run */
+typedef struct bench_result_tag
+{
+    uint32_t digest;
+    uint32_t purged;
+    uint32_t pending;
+    double poll_ns;
+    double purge_ns;
+} bench_result_t;
+
+/* === Globals ============================================================= */
+
+/* Interrupt flag and service of the PAL, used by the critical regions */
+volatile bool pal_global_irq_flag = true;
+
+static queue_t q;
+static queue_index_t q_index;
+static uint8_t next_handle;
+static uint32_t seed;
+
+/* === Prototypes ========================================================== */
+
+void pal_irq_service(void);
+static uint32_t bench_rand(void);
+static uint64_t time_ns(void);
+static bool frame_key(void *buf, uint8_t key_no, uint16_t *key);
+static uint8_t find_dst_cb(void *buf, void *addr);
+static uint8_t find_handle_cb(void *buf, void *handle);
+static uint8_t find_buffer_cb(void *buf, void *buffer);
+static void queue_frame(unsigned devices);
+static void run(bool indexed, unsigned frames, unsigned devices,
+                unsigned polls, bench_result_t *res);
+
+/* === Implementation ====================================================== */
+
+/* No interrupts are emulated. */
+void pal_irq_service(void)
+{
+}
+
+
+
+/* Deterministic pseudo random numbers, the same for both runs. */
+static uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 16);
+}
+
+
+
+/* Monotonic time in ns. */
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+
+
+/* Key function of the index, see indirect_data_key() of the MAC. */
+static bool frame_key(void *buf, uint8_t key_no, uint16_t *key)
+{
+    bench_frame_t *frame = (bench_frame_t *)buf;
+
+    if (BENCH_KEY_MSDU_HANDLE == key_no)
+    {
+        *key = frame->msdu_handle;
+    }
+    else
+    {
+        *key = frame->dst_addr;
+    }
+
+    return true;
+}
+
+
+
+/* Finds a frame for a device not in transit, see find_short_buffer(). */
+static uint8_t find_dst_cb(void *buf, void *addr)
+{
+    bench_frame_t *frame = (bench_frame_t *)buf;
+
+    return ((!frame->indirect_in_transit) &&
+            (frame->dst_addr == *(uint16_t *)addr));
+}
+
+
+
+/* Finds a frame by MSDU handle, see check_msdu_handle_cb(). */
+static uint8_t find_handle_cb(void *buf, void *handle)
+{
+    return (((bench_frame_t *)buf)->msdu_handle == *(uint8_t *)handle);
+}
+
+
+
+/* Finds a given buffer, see find_buffer_cb() of the MAC. */
+static uint8_t find_buffer_cb(void *buf, void *buffer)
+{
+    return (buf == BMM_BUFFER_POINTER((buffer_t *)buffer));
+}
+
+
+
+/* Queues a frame for a random device. */
+static void queue_frame(unsigned devices)
+{
+    buffer_t *buf = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    bench_frame_t *frame;
+
+    if (NULL == buf)
+    {
+        fprintf(stderr, "Out of buffers\n");
+        exit(1);
+    }
+
+    frame = (bench_frame_t *)BMM_BUFFER_POINTER(buf);
+    frame->dst_addr = (uint16_t)(BENCH_FIRST_ADDR + bench_rand() % devices);
+    frame->msdu_handle = next_handle++;
+    frame->indirect_in_transit = false;
+
+    qmm_queue_append(&q, buf);
+}
+
+
+
+/* Runs the polls on a linearly searched or indexed queue. */
+static void run(bool indexed, unsigned frames, unsigned devices,
+                unsigned polls, bench_result_t *res)
+{
+    uint64_t poll_ns = 0;
+    uint64_t purge_ns = 0;
+    unsigned purges = 0;
+
+    seed = 1;
+    next_handle = 0;
+    bmm_buffer_init();
+#ifdef ENABLE_QUEUE_CAPACITY
+    qmm_queue_init(&q, TOTAL_NUMBER_OF_BUFS);
+#else
+    qmm_queue_init(&q);
+#endif  /* ENABLE_QUEUE_CAPACITY */
+    if (indexed)
+    {
+        qmm_queue_index_init(&q, &q_index, frame_key);
+    }
+
+    for (unsigned i = 0; i < frames; i++)
+    {
+        queue_frame(devices);
+    }
+
+    res->digest = 0;
+    res->purged = 0;
+    res->pending = 0;
+
+    for (unsigned i = 0; i < polls; i++)
+    {
+        uint16_t addr = (uint16_t)(BENCH_FIRST_ADDR + bench_rand() % devices);
+        buffer_t *buf;
+        buffer_t *next;
+        search_t find_buf;
+        uint64_t start;
+
+        find_buf.criteria_func = find_dst_cb;
+        find_buf.handle = &addr;
+
+        start = time_ns();
+        if (indexed)
+        {
+            buf = qmm_queue_index_read(&q, BENCH_KEY_DST_ADDR, addr, &find_buf);
+        }
+        else
+        {
+            buf = qmm_queue_read(&q, &find_buf);
+        }
+
+        if (NULL != buf)
+        {
+            ((bench_frame_t *)BMM_BUFFER_POINTER(buf))->indirect_in_transit = true;
+
+            if (indexed)
+            {
+                next = qmm_queue_index_read(&q, BENCH_KEY_DST_ADDR, addr,
+                                            &find_buf);
+                qmm_queue_remove_buffer(&q, buf);
+            }
+            else
+            {
+                search_t find_tx;
+
+                next = qmm_queue_read(&q, &find_buf);
+
+                find_tx.criteria_func = find_buffer_cb;
+                find_tx.handle = buf;
+                qmm_queue_remove(&q, &find_tx);
+            }
+            poll_ns += time_ns() - start;
+
+            res->digest = res->digest * 31 + bmm_buffer_number(buf) + 1;
+            if (NULL != next)
+            {
+                res->pending++;
+            }
+
+            bmm_buffer_free(buf);
+            queue_frame(devices);
+        }
+        else
+        {
+            poll_ns += time_ns() - start;
+            res->digest = res->digest * 31;
+        }
+
+        if (0 == (i & 7))
+        {
+            uint8_t handle = (uint8_t)bench_rand();
+
+            find_buf.criteria_func = find_handle_cb;
+            find_buf.handle = &handle;
+
+            start = time_ns();
+            if (indexed)
+            {
+                buf = qmm_queue_index_remove(&q, BENCH_KEY_MSDU_HANDLE, handle,
+                                             &find_buf);
+            }
+            else
+            {
+                buf = qmm_queue_remove(&q, &find_buf);
+            }
+            purge_ns += time_ns() - start;
+            purges++;
+
+            if (NULL != buf)
+            {
+                res->digest = res->digest * 31 + bmm_buffer_number(buf) + 1;
+                res->purged++;
+                bmm_buffer_free(buf);
+                queue_frame(devices);
+            }
+        }
+    }
+
+    if (q.size != frames)
+    {
+        fprintf(stderr, "Queue size %u, expected %u\n", q.size, frames);
+        res->digest = 0;
+    }
+
+    qmm_queue_flush(&q);
+
+    res->poll_ns = (double)poll_ns / polls;
+    res->purge_ns = (purges > 0) ? (double)purge_ns / purges : 0.0;
+}
+
+
+
+/**
+ * @brief Main function of the benchmark
+ */
+int main(int argc, char *argv[])
+{
+    unsigned frames = BENCH_DEFAULT_FRAMES;
+    unsigned devices = BENCH_DEFAULT_DEVICES;
+    unsigned polls = BENCH_DEFAULT_POLLS;
+    bench_result_t linear;
+    bench_result_t indexed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:d:p:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                frames = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                devices = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                polls = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr,
+                        "Usage: %s [options]\n"
+                        "  -f <n>      Queued frames, at most %u (default %u)\n"
+                        "  -d <n>      Devices (default %u)\n"
+                        "  -p <n>      Polls (default %u)\n"
+                        "  -h          This help\n",
+                        argv[0], TOTAL_NUMBER_OF_BUFS - 1,
+                        BENCH_DEFAULT_FRAMES, BENCH_DEFAULT_DEVICES,
+                        BENCH_DEFAULT_POLLS);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    /* One buffer is needed for the replacement of a removed frame. */
+    if ((0 == frames) || (frames >= TOTAL_NUMBER_OF_BUFS) ||
+        (0 == devices) || (0 == polls))
+    {
+        fprintf(stderr, "Invalid parameters\n");
+        return 1;
+    }
+
+    printf("%u frames for %u devices, %u polls, %u hash buckets\n",
+           frames, devices, polls, QUEUE_INDEX_BUCKETS);
+
+    run(false, frames, devices, polls, &linear);
+    run(true, frames, devices, polls, &indexed);
+
+    printf("          poll [ns]  purge [ns]\n");
+    printf("linear   %10.1f  %10.1f\n", linear.poll_ns, linear.purge_ns);
+    printf("indexed  %10.1f  %10.1f\n", indexed.poll_ns, indexed.purge_ns);
+    printf("speedup  %10.1f  %10.1f\n", linear.poll_ns / indexed.poll_ns,
+           linear.purge_ns / indexed.purge_ns);
+    printf("%u polls with pending frame, %u frames purged\n",
+           indexed.pending, indexed.purged);
+
+    if ((linear.digest != indexed.digest) || (0 == linear.digest) ||
+        (linear.pending != indexed.pending) ||
+        (linear.purged != indexed.purged))
+    {
+        fprintf(stderr, "Indexed queue differs from linear search\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* EOF */
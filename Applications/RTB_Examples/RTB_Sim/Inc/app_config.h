@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Definition of application-specific constants.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/* === Includes ============================================================= */
+
+#include "stack_config.h"
+
+/* === Macros =============================================================== */
+
+/** @brief This is the first timer identifier of the application.
+ *
+ *  The value of this identifier is an increment of the largest identifier
+ *  value used by the MAC.
+ */
+#if (NUMBER_OF_TOTAL_STACK_TIMERS == 0)
+#define APP_FIRST_TIMER_ID          (0)
+#else
+#define APP_FIRST_TIMER_ID          (LAST_STACK_TIMER_ID + 1)
+#endif
+
+/* === Types ================================================================ */
+
+/** Timer ID's used by the Application */
+typedef enum
+{
+    /* App Timers start from APP_FIRST_TIMER_ID */
+
+    /** Application timer id used to start the next range request */
+    RTB_SIM_RANGING_TIMER = (APP_FIRST_TIMER_ID)
+} SHORTENUM app_timer_t;
+
+/** Defines the number of timers used by the application. */
+#define NUMBER_OF_APP_TIMERS        (1)
+
+/** Defines the total number of timers used by the application and the layers below. */
+#define TOTAL_NUMBER_OF_TIMERS      (NUMBER_OF_APP_TIMERS + NUMBER_OF_TOTAL_STACK_TIMERS)
+
+/** Defines the number of additional large buffers used by the application */
+#define NUMBER_OF_LARGE_APP_BUFS    (0)
+
+/** Defines the number of additional small buffers used by the application */
+#define NUMBER_OF_SMALL_APP_BUFS    (0)
+
+/**
+ *  Defines the total number of large buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_LARGE_BUFS  (NUMBER_OF_LARGE_APP_BUFS + NUMBER_OF_LARGE_STACK_BUFS)
+
+/**
+ *  Defines the total number of small buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_SMALL_BUFS  (NUMBER_OF_SMALL_APP_BUFS + NUMBER_OF_SMALL_STACK_BUFS)
+
+/**
+ *  Defines the total number of small and large buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_BUFS        (TOTAL_NUMBER_OF_LARGE_BUFS + TOTAL_NUMBER_OF_SMALL_BUFS)
+
+/**
+ * Defines the USB transmit buffer size
+ */
+#define USB_TX_BUF_SIZE             (200)
+
+/**
+ * Defines the USB receive buffer size
+ */
+#define USB_RX_BUF_SIZE             (10)
+
+/**
+ * Defines the UART transmit buffer size
+ */
+#define UART_MAX_TX_BUF_LENGTH      (200)
+
+/**
+ * Defines the UART receive buffer size
+ */
+#define UART_MAX_RX_BUF_LENGTH      (10)
+
+/* Offset of IEEE address storage location within EEPROM */
+#define EE_IEEE_ADDR                (0)
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* APP_CONFIG_H */
+/* EOF */
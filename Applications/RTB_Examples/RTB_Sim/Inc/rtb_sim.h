@@ -0,0 +1,356 @@
+/**
+ * @file rtb_sim.h
+ *
+ * @brief Interface between the RTB network simulator and its nodes
+ *
+ * The simulator runs many RTB nodes within one Linux process. Each node
+ * is the complete stack (MAC, TAL, RTB, Linux PAL with the emulated
+ * AT86RF233) plus a small ranging application, built as shared object.
+ * The simulator loads a private copy of the shared object per node, so
+ * every node owns its own set of stack globals, and drives all nodes by
+ * a discrete-event loop on a common virtual clock.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_SIM_H
+#define RTB_SIM_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal_types.h"
+#include "pal_timer.h"
+#include "pal_trx_emu.h"
+
+/* === Macros =============================================================== */
+
+/** Version of the node interface, incremented on incompatible changes */
+#define RTB_SIM_API_VERSION             (9)
+
+/** Name of the symbol exporting the node interface from the node object */
+#define RTB_SIM_NODE_API_SYMBOL         "rtb_sim_node_api"
+
+/** Node does not initiate any ranging, i.e. it acts as Reflector only */
+#define RTB_SIM_NO_REFLECTOR            (0xFF)
+
+/**
+ * Maximum number of Reflectors of a batch range request
+ * (RTB_BATCH_MAX_REFLECTORS of the node object)
+ */
+#define RTB_SIM_MAX_BATCH_REFLECTORS    (6)
+
+/** Maximum number of node pairs ranged by remote range requests */
+#define RTB_SIM_MAX_REMOTE_PAIRS        (32)
+
+/**
+ * Maximum number of ranging slots of a TDMA schedule
+ * (RTB_TDMA_MAX_SLOTS of the node object)
+ */
+#define RTB_SIM_MAX_TDMA_SLOTS          (11)
+
+/** Keeps the default of a PMU parameter of the RTB */
+#define RTB_SIM_PMU_DEFAULT             (0xFF)
+
+/** Beacon order of a nonbeacon-enabled network */
+#define RTB_SIM_NON_BEACON_NWK          (15)
+
+/** Start of the first TDMA slot after the beacon in ms */
+#define RTB_SIM_TDMA_SLOT_START_MS      (4)
+
+/**
+ * Maximum number of ranging transactions fetched at once
+ * (RTB_TRACE_MAX_TRANSACTIONS of the node object)
+ */
+#define RTB_SIM_MAX_TRANSACTIONS        (4)
+
+/* === Types ================================================================ */
+
+/**
+ * Ranging timeouts, i.e. the timeout values of range_error_t
+ */
+typedef enum rtb_sim_timeout_tag
+{
+    /** Range Accept frame not received (Initiator) */
+    RTB_SIM_TMO_RANGE_ACPT,
+    /** Time Sync Request frame not received (Reflector) */
+    RTB_SIM_TMO_TIME_SYNC_REQ,
+    /** PMU Start frame not received (Initiator) */
+    RTB_SIM_TMO_PMU_START,
+    /** PMU measurement not finished (Reflector) */
+    RTB_SIM_TMO_PMU_MEAS,
+    /** Range Result Confirm frame not received (Initiator) */
+    RTB_SIM_TMO_RESULT_CONF,
+    /** Range Result Request frame not received (Reflector) */
+    RTB_SIM_TMO_RESULT_REQ,
+    /** Number of ranging timeouts */
+    RTB_SIM_NO_OF_TIMEOUTS
+} rtb_sim_timeout_t;
+
+/**
+ * Phases of a ranging transaction (rtb_trace_phase_t of the node object)
+ */
+typedef enum rtb_sim_phase_tag
+{
+    /** Range Request and Range Accept frames */
+    RTB_SIM_PHASE_RANGE_REQ,
+    /** Time synchronization until the start of the PMU measurement */
+    RTB_SIM_PHASE_TIME_SYNC,
+    /** PMU measurement */
+    RTB_SIM_PHASE_PMU,
+    /** Exchange of the measurement results */
+    RTB_SIM_PHASE_RESULT_EXCHANGE,
+    /** Calculation of the distance */
+    RTB_SIM_PHASE_CALC,
+    /** Remote Range Request and Confirm frames */
+    RTB_SIM_PHASE_REMOTE,
+    /** Number of phases */
+    RTB_SIM_NO_OF_PHASES
+} rtb_sim_phase_t;
+
+/**
+ * Role of a node within a ranging transaction
+ */
+typedef enum rtb_sim_role_tag
+{
+    /** Role unknown */
+    RTB_SIM_ROLE_NONE,
+    /** Initiator */
+    RTB_SIM_ROLE_INITIATOR,
+    /** Reflector */
+    RTB_SIM_ROLE_REFLECTOR,
+    /** Coordinator of a remote ranging */
+    RTB_SIM_ROLE_COORDINATOR
+} rtb_sim_role_t;
+
+/**
+ * Configuration of a simulated node
+ */
+typedef struct rtb_sim_node_config_tag
+{
+    /** Configuration of the emulated transceiver */
+    trx_emu_config_t trx;
+    /** PAN Id of the network */
+    uint16_t pan_id;
+    /** Own short address */
+    uint16_t short_addr;
+    /** Node number of the Reflector or @ref RTB_SIM_NO_REFLECTOR */
+    uint8_t reflector;
+    /** Short address of the (first) Reflector */
+    uint16_t reflector_addr;
+    /**
+     * PMU frequency step (PMU_STEP_FREQ_500kHz .. PMU_STEP_FREQ_4MHz) or
+     * @ref RTB_SIM_PMU_DEFAULT for the default of the RTB
+     */
+    uint8_t pmu_freq_step;
+    /** PMU start frequency in MHz or @ref RTB_SIM_PMU_DEFAULT */
+    uint16_t pmu_freq_start;
+    /** PMU stop frequency in MHz or @ref RTB_SIM_PMU_DEFAULT */
+    uint16_t pmu_freq_stop;
+    /** Antenna diversity of the node (RTB_PIB_ENABLE_ANTENNA_DIV) */
+    bool antenna_div;
+    /**
+     * Results of all antenna combinations are provided
+     * (RTB_PIB_PROVIDE_ANTENNA_DIV_RESULTS)
+     */
+    bool provide_antenna_div_results;
+    /**
+     * The range requests of the node alternate a coarse ranging profile
+     * (2 MHz step, no antenna diversity) and a precise one (0.5 MHz step,
+     * antenna diversity) instead of using the RTB PIB
+     */
+    bool alternate_profiles;
+    /**
+     * Local rangings of poor quality are refined by a dense sweep within
+     * the useful band (adaptive frequency sweep of the RTB)
+     */
+    bool adaptive_sweep;
+    /** DQF threshold of the adaptive frequency sweep in percent */
+    uint8_t adaptive_dqf_threshold;
+    /**
+     * The node scans the PMU band by ED scans and skips the busy blocks
+     * in its rangings (spectrum monitor of the RTB)
+     */
+    bool spectrum_monitor;
+    /** ED level of a busy block of the spectrum monitor */
+    uint8_t spectrum_ed_threshold;
+    /**
+     * Range requests address the nodes by their IEEE addresses; the
+     * IEEE addresses of the nodes follow each other like their short
+     * addresses
+     */
+    bool long_addr;
+    /**
+     * Number of Reflectors ranged with by one batch range request,
+     * having consecutive short addresses starting at reflector_addr;
+     * 0 for single range requests
+     */
+    uint8_t no_of_batch_reflectors;
+    /**
+     * Number of Initiator-Reflector pairs ranged by remote range requests
+     * of this node as Coordinator; the Initiator of pair k has the short
+     * address reflector_addr + 2k, its Reflector reflector_addr + 2k + 1;
+     * 0 if this node is no Coordinator
+     */
+    uint8_t no_of_remote_pairs;
+    /**
+     * Beacon order of the network; the Coordinator starts a beacon-enabled
+     * network with it and all other nodes track its beacons.
+     * @ref RTB_SIM_NON_BEACON_NWK for a nonbeacon-enabled network
+     */
+    uint8_t beacon_order;
+    /** Short address of the Coordinator sending the beacons */
+    uint16_t coord_addr;
+    /**
+     * Number of ranging slots assigned by this node as Coordinator;
+     * the Initiator of slot k has the short address short_addr + 2k + 1,
+     * its Reflector short_addr + 2k + 2;
+     * 0 if this node is no Coordinator
+     */
+    uint8_t no_of_tdma_slots;
+    /** Duration of a ranging slot in ms */
+    uint8_t tdma_slot_ms;
+    /** Time of the first range request in us */
+    uint64_t start_us;
+    /** Pause between the range confirm and the next range request in us */
+    uint32_t interval_us;
+    /** Random extension of the pause in us (0 .. jitter_us) */
+    uint32_t jitter_us;
+    /** CPU time of one main loop iteration in us */
+    uint16_t loop_us;
+} rtb_sim_node_config_t;
+
+/**
+ * Ranging statistics of a simulated node
+ */
+typedef struct rtb_sim_node_stats_tag
+{
+    /** Rangings requested (one per Reflector of a batch range request) */
+    uint32_t range_req;
+    /** Rangings confirmed with status RTB_SUCCESS */
+    uint32_t range_success;
+    /** Rangings confirmed with any other status */
+    uint32_t range_failed;
+    /** Sum of the distances of successful rangings in cm */
+    uint64_t distance_sum;
+    /** Sum of the DQF of successful rangings in percent */
+    uint64_t dqf_sum;
+    /** Ranging timeouts of the node */
+    uint32_t timeouts[RTB_SIM_NO_OF_TIMEOUTS];
+    /** Losses of the beacon synchronization */
+    uint32_t sync_losses;
+    /** Successful local rangings counted by the adaptive frequency sweep */
+    uint32_t swept_rangings;
+    /** Local rangings refined by a dense sweep */
+    uint32_t dense_sweeps;
+    /** Frequencies measured by all sweeps of these local rangings */
+    uint64_t swept_freqs;
+    /** ED scans of the spectrum monitor */
+    uint32_t spectrum_scans;
+    /** Rangings initiated with a proposed frequency plan */
+    uint32_t spectrum_rangings;
+    /** Rangings sweeping a reduced frequency plan */
+    uint32_t reduced_plans;
+    /** Frequencies skipped by the reduced frequency plans */
+    uint32_t skipped_freqs;
+    /** Maximum number of concurrently used large buffers */
+    uint8_t peak_large_bufs;
+    /** Maximum number of concurrently used small buffers */
+    uint8_t peak_small_bufs;
+    /** Size of the concurrently used buffers at their maximum in octets */
+    uint32_t peak_buf_bytes;
+    /** Statistics of the emulated transceiver */
+    trx_emu_stats_t trx;
+} rtb_sim_node_stats_t;
+
+/**
+ * Ranging transaction finished by a simulated node
+ */
+typedef struct rtb_sim_transaction_tag
+{
+    /** Role of the node, see @ref rtb_sim_role_t */
+    uint8_t role;
+    /** Status of the ranging (range_error_t of the node object) */
+    uint8_t status;
+    /** Duration of each phase, see @ref rtb_sim_phase_t, in us */
+    uint32_t phase_us[RTB_SIM_NO_OF_PHASES];
+} rtb_sim_transaction_t;
+
+/**
+ * Functions exported by a node object
+ */
+typedef struct rtb_sim_node_api_tag
+{
+    /** Version of the interface, see @ref RTB_SIM_API_VERSION */
+    uint32_t version;
+
+    /**
+     * Initializes the node
+     *
+     * The clock and the medium need to stay valid for the lifetime of
+     * the node.
+     */
+    bool (*init)(const rtb_sim_node_config_t *config,
+                 const pal_host_clock_t *clock,
+                 const trx_emu_medium_t *medium);
+
+    /**
+     * Runs the main loop of the node until it waits for an event
+     */
+    void (*step)(void);
+
+    /**
+     * Gets the host time of the next event of the node
+     *
+     * @return false if the node does not wait for any event
+     */
+    bool (*next_event)(uint64_t *time_us);
+
+    /**
+     * Passes a frame transmitted by another node to the node
+     */
+    void (*deliver)(const trx_emu_frame_t *frame);
+
+    /**
+     * Gets the statistics of the node
+     */
+    void (*get_stats)(rtb_sim_node_stats_t *stats);
+
+    /**
+     * Gets the ranging transactions finished since the last call
+     *
+     * Requires the latency trace of the RTB (ENABLE_RTB_TRACE) within the
+     * node object; transactions beyond @ref RTB_SIM_MAX_TRANSACTIONS
+     * finished in between are lost.
+     *
+     * @return Number of transactions
+     */
+    uint8_t (*get_transactions)(rtb_sim_transaction_t *trans, uint8_t max_trans);
+} rtb_sim_node_api_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* RTB_SIM_H */
+/* EOF */
@@ -0,0 +1,1417 @@
+/**
+ * @file rtb_sim.c
+ *
+ * @brief Discrete-event simulator for networks of RTB nodes
+ *
+ * The simulator loads one private copy of the node object per node and
+ * runs all nodes on a common virtual clock:
+ * - Each node has a local time, which runs ahead of the simulation time
+ *   by the CPU time it consumed (transceiver accesses, delays, main loop).
+ * - A node is stepped whenever the simulation time reaches its next
+ *   event, i.e. the expiry of a timer or an event of the transceiver.
+ * - Frames are passed to all other nodes at once and received there
+ *   according to their start time, the propagation delay and the
+ *   overlap with other frames.
+ *
+ * At the end of the simulation the ranging throughput, the ranging
+ * timeouts per range error, the channel utilisation and the statistics
+ * of the emulated transceivers are reported.
+ *
+ * The sweep mode benchmarks a single node pair instead: it simulates
+ * each combination of PMU frequency band and step, antenna diversity,
+ * local or remote ranging and short or long addressing for the given
+ * time and prints one CSV line per combination with the ranging rate,
+ * the latency percentiles of each phase of a ranging, the frames per
+ * ranging and the buffer and RAM usage of a node, so the results of two
+ * builds can be compared line by line.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <link.h>
+#include "rtb_sim.h"
+
+/* === Macros ============================================================== */
+
+/** Default number of nodes */
+#define RTB_SIM_DEFAULT_NODES           (4)
+
+/** Default simulated time in s */
+#define RTB_SIM_DEFAULT_DURATION_S      (10.0)
+
+/** Default distance between Initiator and Reflector in m */
+#define RTB_SIM_DEFAULT_DISTANCE_M      (5.0)
+
+/** Default distance between neighboured node pairs in m */
+#define RTB_SIM_DEFAULT_SPACING_M       (2.0)
+
+/** Default node object */
+#define RTB_SIM_DEFAULT_NODE_OBJECT     "./rtb_sim_node.so"
+
+/** Default CPU time of one main loop iteration in us */
+#define RTB_SIM_DEFAULT_LOOP_US         (1)
+
+/** PAN Id of the simulated network */
+#define RTB_SIM_PAN_ID                  (0xCAFE)
+
+/** Short address of node 0, the other nodes follow consecutively */
+#define RTB_SIM_FIRST_SHORT_ADDR        (0x0001)
+
+/** Offset between the start of the Initiators in us */
+#define RTB_SIM_START_OFFSET_US         (1000)
+
+/** ACK timeout of the emulated transceivers in us */
+#define RTB_SIM_ACK_TIMEOUT_US          (864)
+
+/** Time a frame is held while the receiver is not listening in us */
+#define RTB_SIM_RX_HOLD_US              (2000)
+
+/** Duration of a superframe with superframe order 0 in us */
+#define RTB_SIM_BASE_SUPERFRAME_US      (15360)
+
+/** Largest beacon order of a beacon-enabled network */
+#define RTB_SIM_MAX_BEACON_ORDER        (14)
+
+/** Duration of a PPDU octet in us */
+#define RTB_SIM_OCTET_US                (32)
+
+/** Length of SHR and PHR in octets */
+#define RTB_SIM_SHR_PHR_LEN             (6)
+
+/** Latency samples of the total duration of a ranging */
+#define RTB_SIM_TOTAL                   (RTB_SIM_NO_OF_PHASES)
+
+/** Initial number of latency samples per phase */
+#define RTB_SIM_INITIAL_SAMPLES         (1024)
+
+/** Frequency of the channel used by the simulated network in MHz */
+#define RTB_SIM_CHANNEL_FREQ_MHZ        (2405)
+
+/** Width of the interferer in MHz (a Wi-Fi channel) */
+#define RTB_SIM_INTERFERER_WIDTH_MHZ    (20)
+
+/** Power of the interferer at all nodes in dBm */
+#define RTB_SIM_INTERFERER_DBM          (-60)
+
+/** Share of time the interferer is on the air in percent */
+#define RTB_SIM_INTERFERER_DUTY         (50)
+
+/** Width of the PMU frequency bands of the sweep in MHz */
+#define RTB_SIM_SWEEP_BAND_MHZ          (40)
+
+/* === Types =============================================================== */
+
+/**
+ * Simulated node
+ */
+typedef struct sim_node_tag
+{
+    /** Interface of the node object */
+    const rtb_sim_node_api_t *api;
+    /** Handle of the node object */
+    void *handle;
+    /** Configuration of the node */
+    rtb_sim_node_config_t config;
+    /** Clock of the node */
+    pal_host_clock_t clock;
+    /** Medium of the node */
+    trx_emu_medium_t medium;
+    /** Local time of the node in us */
+    uint64_t local_us;
+    /** Time of the next event of the node in us */
+    uint64_t next_us;
+    /** Node waits for an event */
+    bool has_next;
+} sim_node_t;
+
+/**
+ * Parameters of a simulation
+ */
+typedef struct sim_params_tag
+{
+    /** Node object */
+    const char *object;
+    /** Simulated time in s */
+    double duration_s;
+    /** Distance between Initiator and Reflector in m */
+    double distance_m;
+    /** Distance between neighboured node pairs in m */
+    double spacing_m;
+    /** Pause between rangings in us */
+    uint32_t interval_us;
+    /** Random extension of the pause in us */
+    uint32_t jitter_us;
+    /** Seed of the random generators */
+    uint32_t seed;
+    /** Frame loss in permille */
+    uint16_t loss_permille;
+    /** PMU phase noise in LSB */
+    uint8_t phase_noise;
+    /** PMU frequency step or RTB_SIM_PMU_DEFAULT */
+    uint8_t pmu_freq_step;
+    /** PMU start frequency in MHz or RTB_SIM_PMU_DEFAULT */
+    uint16_t pmu_freq_start;
+    /** PMU stop frequency in MHz or RTB_SIM_PMU_DEFAULT */
+    uint16_t pmu_freq_stop;
+    /** Antenna diversity of all nodes */
+    bool antenna_div;
+    /** Results of all antenna combinations are provided */
+    bool provide_antenna_div_results;
+    /** Range requests alternate a coarse and a precise ranging profile */
+    bool alternate_profiles;
+    /** Local rangings use the adaptive frequency sweep */
+    bool adaptive_sweep;
+    /** DQF threshold of the adaptive frequency sweep in percent */
+    uint8_t adaptive_dqf_threshold;
+    /** Center frequency of the interferer in MHz, 0 for none */
+    uint16_t interferer_mhz;
+    /** All nodes use the spectrum monitor */
+    bool spectrum_monitor;
+    /** ED level of a busy block of the spectrum monitor */
+    uint8_t spectrum_ed_threshold;
+    /** Range requests use IEEE addresses */
+    bool long_addr;
+    /** Batch mode */
+    bool batch;
+    /** Remote mode */
+    bool remote;
+    /** Slot duration of the TDMA mode in ms, 0 without TDMA */
+    uint8_t tdma_slot_ms;
+    /** CPU time of one main loop iteration in us */
+    uint16_t loop_us;
+} sim_params_t;
+
+/**
+ * Latency samples of one phase of a ranging
+ */
+typedef struct sim_samples_tag
+{
+    /** Durations in us */
+    uint32_t *values;
+    /** Number of durations */
+    uint32_t count;
+    /** Capacity of values */
+    uint32_t size;
+} sim_samples_t;
+
+/* === Globals ============================================================= */
+
+/** Simulated nodes */
+static sim_node_t nodes[TRX_EMU_MAX_NODES];
+
+/** Number of simulated nodes */
+static uint8_t no_of_nodes = RTB_SIM_DEFAULT_NODES;
+
+/** Simulation time in us */
+static uint64_t sim_now_us;
+
+/** Time the medium has been occupied by frames in us */
+static uint64_t air_busy_us;
+
+/** End of the latest frame on the medium in us */
+static uint64_t air_until_us;
+
+/** The ranging transactions of the nodes are collected */
+static bool collect_latency;
+
+/** Latency samples of the successful rangings per phase and in total */
+static sim_samples_t latency[RTB_SIM_NO_OF_PHASES + 1];
+
+/** Names of the phases of a ranging within the sweep results */
+static const char *const phase_names[RTB_SIM_NO_OF_PHASES + 1] =
+{
+    "range_req",
+    "time_sync",
+    "pmu",
+    "result_exchange",
+    "calc",
+    "remote",
+    "total"
+};
+
+/** Names of the ranging timeouts */
+static const char *const timeout_names[RTB_SIM_NO_OF_TIMEOUTS] =
+{
+    "TMO_RTB_AWAIT_RANGE_ACPT_FRAME",
+    "TMO_RTB_AWAIT_TIME_SYNC_REQ_FRAME",
+    "TMO_RTB_AWAIT_PMU_START_FRAME",
+    "TMO_RTB_INIT_PMU_START_FRAME",
+    "TMO_RTB_AWAIT_RESULT_CONF_FRAME",
+    "TMO_RTB_AWAIT_RESULT_REQ_FRAME"
+};
+
+/* === Prototypes ========================================================== */
+
+static void usage(const char *prog);
+static bool setup_nodes(const sim_params_t *params);
+static void unload_nodes(void);
+static bool load_node(sim_node_t *node, const char *object);
+static uint64_t node_now(void *ctx);
+static void node_wait_until(void *ctx, uint64_t time_us);
+static void node_send(void *ctx, const trx_emu_frame_t *frame);
+static void update_next_event(sim_node_t *node);
+static void run(uint64_t end_us);
+static void collect_transactions(sim_node_t *node);
+static void get_total_stats(rtb_sim_node_stats_t *total, bool verbose);
+static void report(double duration_s, double wall_s, double distance_m,
+                   bool verbose);
+static int sweep(sim_params_t *params);
+static void sweep_result(const sim_params_t *params, uint32_t static_ram);
+static uint32_t percentile(sim_samples_t *samples, uint8_t pct);
+static int compare_u32(const void *a, const void *b);
+static int phdr_static_ram(struct dl_phdr_info *info, size_t size, void *data);
+static uint32_t node_static_ram(const sim_node_t *node);
+static double wall_clock_s(void);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Main function of the RTB network simulator
+ */
+int main(int argc, char *argv[])
+{
+    sim_params_t params;
+    bool verbose = false;
+    bool sweep_mode = false;
+    double wall_start;
+    int opt;
+
+    memset(&params, 0, sizeof(params));
+    params.object = RTB_SIM_DEFAULT_NODE_OBJECT;
+    params.duration_s = RTB_SIM_DEFAULT_DURATION_S;
+    params.distance_m = RTB_SIM_DEFAULT_DISTANCE_M;
+    params.spacing_m = RTB_SIM_DEFAULT_SPACING_M;
+    params.seed = 1;
+    params.pmu_freq_step = RTB_SIM_PMU_DEFAULT;
+    params.pmu_freq_start = RTB_SIM_PMU_DEFAULT;
+    params.pmu_freq_stop = RTB_SIM_PMU_DEFAULT;
+    params.loop_us = RTB_SIM_DEFAULT_LOOP_US;
+
+    while ((opt = getopt(argc, argv, "n:t:d:a:i:j:s:l:p:f:F:P:ARMD:W:E:o:ebrT:L:Svh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                {
+                    int n = atoi(optarg);
+
+                    if ((n < 2) || (n > TRX_EMU_MAX_NODES))
+                    {
+                        fprintf(stderr, "Number of nodes must be 2 .. %u\n",
+                                TRX_EMU_MAX_NODES);
+                        return EXIT_FAILURE;
+                    }
+                    no_of_nodes = (uint8_t)n;
+                }
+                break;
+
+            case 't':
+                params.duration_s = atof(optarg);
+                break;
+
+            case 'd':
+                params.distance_m = atof(optarg);
+                break;
+
+            case 'a':
+                params.spacing_m = atof(optarg);
+                break;
+
+            case 'i':
+                params.interval_us = (uint32_t)(atof(optarg) * 1000.0);
+                break;
+
+            case 'j':
+                params.jitter_us = (uint32_t)(atof(optarg) * 1000.0);
+                break;
+
+            case 's':
+                params.seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'l':
+                params.loss_permille = (uint16_t)atoi(optarg);
+                break;
+
+            case 'p':
+                params.phase_noise = (uint8_t)atoi(optarg);
+                break;
+
+            case 'f':
+                params.pmu_freq_step = (uint8_t)atoi(optarg);
+                break;
+
+            case 'F':
+                params.pmu_freq_stop = (uint16_t)atoi(optarg);
+                break;
+
+            case 'P':
+                params.pmu_freq_start = (uint16_t)atoi(optarg);
+                break;
+
+            case 'A':
+                params.antenna_div = true;
+                break;
+
+            case 'R':
+                params.provide_antenna_div_results = true;
+                break;
+
+            case 'M':
+                params.alternate_profiles = true;
+                break;
+
+            case 'D':
+                {
+                    int dqf = atoi(optarg);
+
+                    if ((dqf < 0) || (dqf > 100))
+                    {
+                        fprintf(stderr, "DQF threshold must be 0 .. 100 %%\n");
+                        return EXIT_FAILURE;
+                    }
+                    params.adaptive_sweep = true;
+                    params.adaptive_dqf_threshold = (uint8_t)dqf;
+                }
+                break;
+
+            case 'W':
+                {
+                    int mhz = atoi(optarg);
+
+                    /* The interferer must not block the frames of the network. */
+                    if ((mhz < 2400) || (mhz > 2500) ||
+                        (abs(mhz - RTB_SIM_CHANNEL_FREQ_MHZ) <=
+                         (RTB_SIM_INTERFERER_WIDTH_MHZ / 2 + 1)))
+                    {
+                        fprintf(stderr, "Interferer must be within 2400 .. 2500 MHz "
+                                "and clear of %u MHz\n", RTB_SIM_CHANNEL_FREQ_MHZ);
+                        return EXIT_FAILURE;
+                    }
+                    params.interferer_mhz = (uint16_t)mhz;
+                }
+                break;
+
+            case 'E':
+                {
+                    int ed = atoi(optarg);
+
+                    if ((ed < 0) || (ed > 255))
+                    {
+                        fprintf(stderr, "ED threshold must be 0 .. 255\n");
+                        return EXIT_FAILURE;
+                    }
+                    params.spectrum_monitor = true;
+                    params.spectrum_ed_threshold = (uint8_t)ed;
+                }
+                break;
+
+            case 'e':
+                params.long_addr = true;
+                break;
+
+            case 'o':
+                params.object = optarg;
+                break;
+
+            case 'b':
+                params.batch = true;
+                break;
+
+            case 'r':
+                params.remote = true;
+                break;
+
+            case 'T':
+                {
+                    int ms = atoi(optarg);
+
+                    if ((ms < 1) || (ms > 255))
+                    {
+                        fprintf(stderr, "Slot duration must be 1 .. 255 ms\n");
+                        return EXIT_FAILURE;
+                    }
+                    params.tdma_slot_ms = (uint8_t)ms;
+                }
+                break;
+
+            case 'L':
+                {
+                    int us = atoi(optarg);
+
+                    if ((us < 1) || (us > 10000))
+                    {
+                        fprintf(stderr, "Loop time must be 1 .. 10000 us\n");
+                        return EXIT_FAILURE;
+                    }
+                    params.loop_us = (uint16_t)us;
+                }
+                break;
+
+            case 'S':
+                sweep_mode = true;
+                break;
+
+            case 'v':
+                verbose = true;
+                break;
+
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (sweep_mode)
+    {
+        return sweep(&params);
+    }
+
+    wall_start = wall_clock_s();
+
+    if (!setup_nodes(&params))
+    {
+        return EXIT_FAILURE;
+    }
+
+    run((uint64_t)(params.duration_s * 1e6));
+
+    report(params.duration_s, wall_clock_s() - wall_start, params.distance_m,
+           verbose);
+
+    unload_nodes();
+
+    return EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief Prints the command line options
+ */
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <nodes>     number of nodes (default %u)\n"
+           "  -t <s>         simulated time (default %.1f s)\n"
+           "  -d <m>         Initiator-Reflector distance (default %.1f m)\n"
+           "  -a <m>         distance between node pairs (default %.1f m)\n"
+           "  -i <ms>        pause between rangings (default 0 ms)\n"
+           "  -j <ms>        random extension of the pause (default 0 ms)\n"
+           "  -s <seed>      seed of the random generators (default 1)\n"
+           "  -l <permille>  frame loss (default 0)\n"
+           "  -p <lsb>       PMU phase noise (default 0)\n"
+           "  -f <step>      PMU frequency step: 0 = 0.5 MHz .. 3 = 4 MHz\n"
+           "                 (default of the RTB)\n"
+           "  -F <MHz>       PMU stop frequency (default of the RTB)\n"
+           "  -P <MHz>       PMU start frequency (default of the RTB)\n"
+           "  -A             enable antenna diversity\n"
+           "  -R             provide the results of all antenna combinations\n"
+           "  -M             alternate a coarse and a precise ranging profile\n"
+           "                 with each range request\n"
+           "  -D <dqf>       adaptive frequency sweep: refine local rangings\n"
+           "                 with a DQF below <dqf> %% or few valid PMU values\n"
+           "                 by a dense sweep within the useful band\n"
+           "  -W <MHz>       Wi-Fi like interferer of 20 MHz around <MHz>\n"
+           "                 (-60 dBm, on the air 50 %% of the time)\n"
+           "  -E <ed>        spectrum monitor: avoid the PMU frequencies of\n"
+           "                 blocks with an ED level above <ed> (0 .. 255)\n"
+           "  -e             address the nodes by their IEEE addresses\n"
+           "  -o <file>      node object (default %s)\n"
+           "  -b             batch mode: node 0 ranges with all other nodes\n"
+           "                 by batch range requests\n"
+           "  -r             remote mode: node 0 requests the rangings of the\n"
+           "                 following node pairs by remote range requests\n"
+           "  -T <ms>        TDMA mode: node 0 sends beacons assigning a ranging\n"
+           "                 slot of <ms> to each following node pair\n"
+           "  -L <us>        CPU time of one main loop iteration (default %u us)\n"
+           "  -S             sweep mode: benchmark one node pair for each PMU\n"
+           "                 band and step, antenna diversity, local or remote\n"
+           "                 ranging and addressing for <s> each, CSV output\n"
+           "  -v             report per node\n",
+           prog, RTB_SIM_DEFAULT_NODES, RTB_SIM_DEFAULT_DURATION_S,
+           RTB_SIM_DEFAULT_DISTANCE_M, RTB_SIM_DEFAULT_SPACING_M,
+           RTB_SIM_DEFAULT_NODE_OBJECT, RTB_SIM_DEFAULT_LOOP_US);
+}
+
+
+
+/**
+ * @brief Configures, loads and initializes all nodes
+ *
+ * Node pairs are placed along the x axis: the Initiator (even node)
+ * at y = 0, its Reflector (odd node) at y = distance.
+ * A remaining single node acts as Reflector only.
+ * In batch mode node 0 ranges with all other nodes by batch range
+ * requests, which are placed on a circle of radius distance around it.
+ * In remote mode node 0 is the Coordinator, which requests the rangings
+ * of the node pairs following it concurrently by remote range requests.
+ * In TDMA mode node 0 is the Coordinator of a beacon-enabled network,
+ * which assigns a ranging slot to each node pair following it.
+ *
+ * @param params Parameters of the simulation
+ *
+ * @return true if all nodes have been initialized
+ */
+static bool setup_nodes(const sim_params_t *params)
+{
+    uint8_t beacon_order = RTB_SIM_NON_BEACON_NWK;
+    uint8_t i;
+
+    memset(nodes, 0, sizeof(nodes));
+    sim_now_us = 0;
+    air_busy_us = 0;
+    air_until_us = 0;
+
+    if (params->tdma_slot_ms > 0)
+    {
+        uint8_t n = (no_of_nodes - 1) / 2;
+        uint32_t slots_us = (RTB_SIM_TDMA_SLOT_START_MS + n * params->tdma_slot_ms) * 1000UL;
+
+        if ((0 == n) || (n > RTB_SIM_MAX_TDMA_SLOTS))
+        {
+            fprintf(stderr, "TDMA mode requires 1 .. %u node pairs\n",
+                    RTB_SIM_MAX_TDMA_SLOTS);
+            return false;
+        }
+
+        /* The smallest beacon interval containing all slots is used. */
+        for (beacon_order = 0;
+             (beacon_order < RTB_SIM_MAX_BEACON_ORDER) &&
+             (((uint32_t)RTB_SIM_BASE_SUPERFRAME_US << beacon_order) < slots_us);
+             beacon_order++)
+        {
+        }
+    }
+
+    for (i = 0; i < no_of_nodes; i++)
+    {
+        sim_node_t *node = &nodes[i];
+        rtb_sim_node_config_t *cfg = &node->config;
+        uint8_t pair = i / 2;
+
+        cfg->trx.node_id = i;
+        if (params->batch)
+        {
+            double angle = (i > 0) ? (2.0 * M_PI * (i - 1) / (no_of_nodes - 1)) : 0.0;
+
+            cfg->trx.pos[0] = (i > 0) ? (params->distance_m * cos(angle)) : 0.0;
+            cfg->trx.pos[1] = (i > 0) ? (params->distance_m * sin(angle)) : 0.0;
+        }
+        else if (params->remote || (params->tdma_slot_ms > 0))
+        {
+            /* Pair k consists of the nodes 2k + 1 and 2k + 2. */
+            cfg->trx.pos[0] = (i > 0) ? (((i - 1) / 2) * params->spacing_m) : -params->spacing_m;
+            cfg->trx.pos[1] = ((i > 0) && (0 == (i & 1))) ? params->distance_m : 0.0;
+        }
+        else
+        {
+            cfg->trx.pos[0] = pair * params->spacing_m;
+            cfg->trx.pos[1] = (i & 1) ? params->distance_m : 0.0;
+        }
+        cfg->trx.phase_noise = params->phase_noise;
+        cfg->trx.ack_timeout_us = RTB_SIM_ACK_TIMEOUT_US;
+        cfg->trx.rx_hold_us = RTB_SIM_RX_HOLD_US;
+        cfg->trx.frame_loss_permille = params->loss_permille;
+        cfg->trx.seed = (params->seed * 2654435761UL) ^ (i + 1);
+        if (params->interferer_mhz > 0)
+        {
+            cfg->trx.interferer_start_mhz = params->interferer_mhz -
+                                            RTB_SIM_INTERFERER_WIDTH_MHZ / 2;
+            cfg->trx.interferer_stop_mhz = params->interferer_mhz +
+                                           RTB_SIM_INTERFERER_WIDTH_MHZ / 2;
+            cfg->trx.interferer_dbm = RTB_SIM_INTERFERER_DBM;
+            cfg->trx.interferer_duty = RTB_SIM_INTERFERER_DUTY;
+        }
+        cfg->pan_id = RTB_SIM_PAN_ID;
+        cfg->short_addr = RTB_SIM_FIRST_SHORT_ADDR + i;
+        cfg->pmu_freq_step = params->pmu_freq_step;
+        cfg->pmu_freq_start = params->pmu_freq_start;
+        cfg->pmu_freq_stop = params->pmu_freq_stop;
+        cfg->antenna_div = params->antenna_div;
+        cfg->provide_antenna_div_results = params->provide_antenna_div_results;
+        cfg->alternate_profiles = params->alternate_profiles;
+        cfg->adaptive_sweep = params->adaptive_sweep;
+        cfg->adaptive_dqf_threshold = params->adaptive_dqf_threshold;
+        cfg->spectrum_monitor = params->spectrum_monitor;
+        cfg->spectrum_ed_threshold = params->spectrum_ed_threshold;
+        cfg->long_addr = params->long_addr;
+        cfg->beacon_order = beacon_order;
+        cfg->coord_addr = RTB_SIM_FIRST_SHORT_ADDR;
+        cfg->loop_us = params->loop_us;
+
+        if (params->batch && (0 == i))
+        {
+            uint8_t n = no_of_nodes - 1;
+
+            if (n > RTB_SIM_MAX_BATCH_REFLECTORS)
+            {
+                fprintf(stderr, "Batch mode supports up to %u Reflectors\n",
+                        RTB_SIM_MAX_BATCH_REFLECTORS);
+                return false;
+            }
+            cfg->reflector = 1;
+            cfg->reflector_addr = RTB_SIM_FIRST_SHORT_ADDR + 1;
+            cfg->no_of_batch_reflectors = n;
+            cfg->interval_us = params->interval_us;
+            cfg->jitter_us = params->jitter_us;
+        }
+        else if (params->remote && (0 == i))
+        {
+            uint8_t n = (no_of_nodes - 1) / 2;
+
+            if ((0 == n) || (n > RTB_SIM_MAX_REMOTE_PAIRS))
+            {
+                fprintf(stderr, "Remote mode requires 1 .. %u node pairs\n",
+                        RTB_SIM_MAX_REMOTE_PAIRS);
+                return false;
+            }
+            cfg->reflector = 1;
+            cfg->reflector_addr = RTB_SIM_FIRST_SHORT_ADDR + 1;
+            cfg->no_of_remote_pairs = n;
+            cfg->interval_us = params->interval_us;
+            cfg->jitter_us = params->jitter_us;
+        }
+        else if ((params->tdma_slot_ms > 0) && (0 == i))
+        {
+            cfg->reflector = RTB_SIM_NO_REFLECTOR;
+            cfg->no_of_tdma_slots = (no_of_nodes - 1) / 2;
+            cfg->tdma_slot_ms = params->tdma_slot_ms;
+        }
+        else if ((params->tdma_slot_ms > 0) && (i & 1) && ((i + 1) < no_of_nodes))
+        {
+            cfg->reflector = i + 1;
+            cfg->reflector_addr = RTB_SIM_FIRST_SHORT_ADDR + i + 1;
+            cfg->interval_us = params->interval_us;
+            cfg->jitter_us = params->jitter_us;
+        }
+        else if (!params->batch && !params->remote && (0 == params->tdma_slot_ms) &&
+                 (0 == (i & 1)) && ((i + 1) < no_of_nodes))
+        {
+            cfg->reflector = i + 1;
+            cfg->reflector_addr = RTB_SIM_FIRST_SHORT_ADDR + i + 1;
+            cfg->start_us = (uint64_t)pair * RTB_SIM_START_OFFSET_US;
+            cfg->interval_us = params->interval_us;
+            cfg->jitter_us = params->jitter_us;
+        }
+        else
+        {
+            cfg->reflector = RTB_SIM_NO_REFLECTOR;
+        }
+
+        if (!load_node(node, params->object))
+        {
+            return false;
+        }
+    }
+
+    for (i = 0; i < no_of_nodes; i++)
+    {
+        sim_node_t *node = &nodes[i];
+
+        node->clock.now_us = node_now;
+        node->clock.wait_until = node_wait_until;
+        node->clock.ctx = node;
+        node->medium.send = node_send;
+        node->medium.ctx = node;
+
+        if (!node->api->init(&node->config, &node->clock, &node->medium))
+        {
+            fprintf(stderr, "Node %u: initialization failed\n", i);
+            return false;
+        }
+        update_next_event(node);
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Unloads the node objects of all nodes
+ */
+static void unload_nodes(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < no_of_nodes; i++)
+    {
+        if (NULL != nodes[i].handle)
+        {
+            dlclose(nodes[i].handle);
+            nodes[i].handle = NULL;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Loads a private copy of the node object
+ *
+ * The dynamic loader maps an object only once per path, hence each node
+ * loads its own temporary copy to get its own set of globals.
+ *
+ * @param node Node to be loaded
+ * @param object Path of the node object
+ *
+ * @return true if the node has been loaded
+ */
+static bool load_node(sim_node_t *node, const char *object)
+{
+    char path[] = "/tmp/rtb_sim_node_XXXXXX";
+    char buf[4096];
+    ssize_t len;
+    int src;
+    int dst;
+
+    src = open(object, O_RDONLY);
+    if (src < 0)
+    {
+        perror(object);
+        return false;
+    }
+
+    dst = mkstemp(path);
+    if (dst < 0)
+    {
+        perror("mkstemp");
+        close(src);
+        return false;
+    }
+
+    while ((len = read(src, buf, sizeof(buf))) > 0)
+    {
+        if (write(dst, buf, (size_t)len) != len)
+        {
+            len = -1;
+            break;
+        }
+    }
+    close(src);
+    close(dst);
+
+    if (len < 0)
+    {
+        perror(path);
+        unlink(path);
+        return false;
+    }
+
+    node->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    /* The mapping stays valid after the file is removed. */
+    unlink(path);
+    if (NULL == node->handle)
+    {
+        fprintf(stderr, "%s\n", dlerror());
+        return false;
+    }
+
+    node->api = (const rtb_sim_node_api_t *)dlsym(node->handle,
+                                                  RTB_SIM_NODE_API_SYMBOL);
+    if ((NULL == node->api) || (RTB_SIM_API_VERSION != node->api->version))
+    {
+        fprintf(stderr, "%s: no compatible node interface\n", object);
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Reads the local time of a node
+ */
+static uint64_t node_now(void *ctx)
+{
+    sim_node_t *node = (sim_node_t *)ctx;
+
+    return node->local_us;
+}
+
+
+
+/**
+ * @brief Lets a node consume CPU time
+ */
+static void node_wait_until(void *ctx, uint64_t time_us)
+{
+    sim_node_t *node = (sim_node_t *)ctx;
+
+    if (time_us > node->local_us)
+    {
+        node->local_us = time_us;
+    }
+}
+
+
+
+/**
+ * @brief Passes a frame of a node to all other nodes
+ *
+ * The medium is occupied from the start of the SHR until the end of
+ * the PSDU, overlapping frames are counted once.
+ */
+static void node_send(void *ctx, const trx_emu_frame_t *frame)
+{
+    sim_node_t *sender = (sim_node_t *)ctx;
+    uint64_t end_us = frame->start_us +
+                      ((uint64_t)RTB_SIM_SHR_PHR_LEN + frame->psdu_len) * RTB_SIM_OCTET_US;
+    uint8_t i;
+
+    if (frame->start_us >= air_until_us)
+    {
+        air_busy_us += end_us - frame->start_us;
+        air_until_us = end_us;
+    }
+    else if (end_us > air_until_us)
+    {
+        air_busy_us += end_us - air_until_us;
+        air_until_us = end_us;
+    }
+
+    for (i = 0; i < no_of_nodes; i++)
+    {
+        if (&nodes[i] != sender)
+        {
+            nodes[i].api->deliver(frame);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Updates the time of the next event of a node
+ */
+static void update_next_event(sim_node_t *node)
+{
+    uint64_t time_us;
+
+    node->has_next = node->api->next_event(&time_us);
+    if (node->has_next)
+    {
+        node->next_us = (time_us > node->local_us) ? time_us : node->local_us;
+    }
+}
+
+
+
+/**
+ * @brief Runs the discrete-event loop
+ *
+ * Every round steps all nodes having an event due at the simulation
+ * time, the simulation time advances to the earliest next event
+ * afterwards. Since each step consumes CPU time of the node, the
+ * simulation cannot stall.
+ *
+ * @param end_us End of the simulation
+ */
+static void run(uint64_t end_us)
+{
+    while (true)
+    {
+        uint64_t next_us = UINT64_MAX;
+        uint8_t i;
+
+        for (i = 0; i < no_of_nodes; i++)
+        {
+            /* Frames of other nodes may have created new events. */
+            update_next_event(&nodes[i]);
+            if (nodes[i].has_next && (nodes[i].next_us < next_us))
+            {
+                next_us = nodes[i].next_us;
+            }
+        }
+
+        if (next_us >= end_us)
+        {
+            sim_now_us = end_us;
+            break;
+        }
+
+        if (next_us > sim_now_us)
+        {
+            sim_now_us = next_us;
+        }
+
+        for (i = 0; i < no_of_nodes; i++)
+        {
+            sim_node_t *node = &nodes[i];
+
+            if (node->has_next && (node->next_us <= sim_now_us))
+            {
+                if (node->local_us < sim_now_us)
+                {
+                    node->local_us = sim_now_us;
+                }
+                node->api->step();
+                if (collect_latency)
+                {
+                    collect_transactions(node);
+                }
+            }
+        }
+    }
+}
+
+
+
+/**
+ * @brief Collects the ranging transactions finished by a node
+ *
+ * The durations of the successful rangings are collected from the
+ * Initiators, which take part in all phases of a ranging.
+ */
+static void collect_transactions(sim_node_t *node)
+{
+    rtb_sim_transaction_t trans[RTB_SIM_MAX_TRANSACTIONS];
+    uint8_t count = node->api->get_transactions(trans, RTB_SIM_MAX_TRANSACTIONS);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t total_us = 0;
+
+        if ((RTB_SIM_ROLE_INITIATOR != trans[i].role) || (0 != trans[i].status))
+        {
+            continue;
+        }
+
+        for (uint8_t phase = 0; phase <= RTB_SIM_NO_OF_PHASES; phase++)
+        {
+            sim_samples_t *samples = &latency[phase];
+            uint32_t value;
+
+            if (phase < RTB_SIM_NO_OF_PHASES)
+            {
+                value = trans[i].phase_us[phase];
+                total_us += value;
+            }
+            else
+            {
+                value = total_us;
+            }
+
+            if (samples->count == samples->size)
+            {
+                uint32_t size = (samples->size > 0) ? (2 * samples->size)
+                                                    : RTB_SIM_INITIAL_SAMPLES;
+                uint32_t *values = realloc(samples->values, size * sizeof(uint32_t));
+
+                if (NULL == values)
+                {
+                    continue;
+                }
+                samples->values = values;
+                samples->size = size;
+            }
+            samples->values[samples->count++] = value;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Sums up the statistics of all nodes
+ *
+ * The peak buffer usage is the maximum of all nodes.
+ *
+ * @param[out] total Statistics of all nodes
+ * @param verbose true to print the statistics of each node
+ */
+static void get_total_stats(rtb_sim_node_stats_t *total, bool verbose)
+{
+    uint8_t i;
+    uint8_t t;
+
+    memset(total, 0, sizeof(*total));
+
+    for (i = 0; i < no_of_nodes; i++)
+    {
+        rtb_sim_node_stats_t s;
+
+        nodes[i].api->get_stats(&s);
+
+        total->range_req += s.range_req;
+        total->range_success += s.range_success;
+        total->range_failed += s.range_failed;
+        total->distance_sum += s.distance_sum;
+        total->dqf_sum += s.dqf_sum;
+        for (t = 0; t < RTB_SIM_NO_OF_TIMEOUTS; t++)
+        {
+            total->timeouts[t] += s.timeouts[t];
+        }
+        total->sync_losses += s.sync_losses;
+        total->swept_rangings += s.swept_rangings;
+        total->dense_sweeps += s.dense_sweeps;
+        total->swept_freqs += s.swept_freqs;
+        total->spectrum_scans += s.spectrum_scans;
+        total->spectrum_rangings += s.spectrum_rangings;
+        total->reduced_plans += s.reduced_plans;
+        total->skipped_freqs += s.skipped_freqs;
+        if (s.peak_buf_bytes > total->peak_buf_bytes)
+        {
+            total->peak_large_bufs = s.peak_large_bufs;
+            total->peak_small_bufs = s.peak_small_bufs;
+            total->peak_buf_bytes = s.peak_buf_bytes;
+        }
+        total->trx.tx_frames += s.trx.tx_frames;
+        total->trx.tx_acks += s.trx.tx_acks;
+        total->trx.rx_frames += s.trx.rx_frames;
+        total->trx.rx_collisions += s.trx.rx_collisions;
+        total->trx.rx_lost += s.trx.rx_lost;
+        total->trx.cca_busy += s.trx.cca_busy;
+        total->trx.channel_access_failures += s.trx.channel_access_failures;
+        total->trx.no_ack += s.trx.no_ack;
+        total->trx.responses += s.trx.responses;
+        total->trx.response_time_sum_us += s.trx.response_time_sum_us;
+        if (s.trx.response_time_max_us > total->trx.response_time_max_us)
+        {
+            total->trx.response_time_max_us = s.trx.response_time_max_us;
+        }
+
+        if (verbose)
+        {
+            printf("Node %2u: req %6u, ok %6u, failed %6u, tx %6u, rx %6u, "
+                   "coll %5u, cca busy %5u, no ack %5u\n",
+                   i, s.range_req, s.range_success, s.range_failed,
+                   s.trx.tx_frames, s.trx.rx_frames, s.trx.rx_collisions,
+                   s.trx.cca_busy, s.trx.no_ack);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Prints the results of the simulation
+ *
+ * @param duration_s Simulated time
+ * @param wall_s Real time of the simulation
+ * @param distance_m Configured Initiator-Reflector distance
+ * @param verbose true to report each node
+ */
+static void report(double duration_s, double wall_s, double distance_m,
+                   bool verbose)
+{
+    rtb_sim_node_stats_t total;
+    uint8_t t;
+
+    get_total_stats(&total, verbose);
+
+    printf("RTB network simulation: %u nodes, %.3f s simulated in %.3f s\n",
+           no_of_nodes, duration_s, wall_s);
+    printf("Rangings:             %u requested, %u successful, %u failed\n",
+           total.range_req, total.range_success, total.range_failed);
+    printf("Ranging throughput:   %.2f successful rangings/s\n",
+           total.range_success / duration_s);
+    if (total.range_success > 0)
+    {
+        printf("Mean distance:        %.1f cm (configured %.1f cm), mean DQF %.1f %%\n",
+               (double)total.distance_sum / total.range_success,
+               distance_m * 100.0,
+               (double)total.dqf_sum / total.range_success);
+    }
+    printf("Ranging timeouts:\n");
+    for (t = 0; t < RTB_SIM_NO_OF_TIMEOUTS; t++)
+    {
+        printf("  %-36s %u\n", timeout_names[t], total.timeouts[t]);
+    }
+    if (total.sync_losses > 0)
+    {
+        printf("Beacon sync losses:   %u\n", total.sync_losses);
+    }
+    if (total.swept_rangings > 0)
+    {
+        printf("PMU sweeps:           %.1f frequencies per local ranging, "
+               "%u of %u refined by a dense sweep\n",
+               (double)total.swept_freqs / total.swept_rangings,
+               total.dense_sweeps, total.swept_rangings);
+    }
+    if (total.spectrum_scans > 0)
+    {
+        printf("Spectrum plans:       %u ED scans, %u of %u rangings reduced, "
+               "%.1f frequencies skipped per reduced ranging\n",
+               total.spectrum_scans, total.reduced_plans, total.spectrum_rangings,
+               (total.reduced_plans > 0) ?
+               ((double)total.skipped_freqs / total.reduced_plans) : 0.0);
+    }
+    printf("Channel utilisation:  %.2f %%\n",
+           100.0 * (double)air_busy_us / (duration_s * 1e6));
+    printf("Transceivers:         tx %u, ack tx %u, rx %u, collisions %u, lost %u\n",
+           total.trx.tx_frames, total.trx.tx_acks, total.trx.rx_frames,
+           total.trx.rx_collisions, total.trx.rx_lost);
+    printf("CSMA-CA:              cca busy %u, channel access failures %u, no ack %u\n",
+           total.trx.cca_busy, total.trx.channel_access_failures,
+           total.trx.no_ack);
+    if (total.trx.responses > 0)
+    {
+        printf("Response time:        %.1f us mean, %u us max (%u responses)\n",
+               (double)total.trx.response_time_sum_us / total.trx.responses,
+               total.trx.response_time_max_us, total.trx.responses);
+    }
+}
+
+
+
+/**
+ * @brief Runs the sweep mode
+ *
+ * A single node pair is simulated for each combination, in remote mode
+ * with a Coordinator. The band of the PMU measurement has a fixed width
+ * and starts at a low and a high channel. Antenna diversity is swept
+ * without and with the results of all antenna combinations.
+ *
+ * @param params Parameters of the simulation, the swept ones are overwritten
+ *
+ * @return Exit code of the simulator
+ */
+static int sweep(sim_params_t *params)
+{
+    static const uint16_t freq_start[] = { 2403, 2443 };
+    static const bool antenna_div[] = { false, true, true };
+    static const bool provide_results[] = { false, false, true };
+    uint32_t static_ram = 0;
+
+    params->batch = false;
+    params->tdma_slot_ms = 0;
+    collect_latency = true;
+
+    printf("freq_start,freq_stop,freq_step,antenna_div,antenna_div_results,"
+           "ranging,addressing,rangings,failed,rangings_per_s,frames_per_ranging");
+    for (uint8_t phase = 0; phase <= RTB_SIM_NO_OF_PHASES; phase++)
+    {
+        printf(",%s_p50_us,%s_p90_us,%s_p99_us",
+               phase_names[phase], phase_names[phase], phase_names[phase]);
+    }
+    printf(",peak_large_bufs,peak_small_bufs,peak_buf_bytes,static_ram_bytes\n");
+
+    for (uint8_t f = 0; f < sizeof(freq_start) / sizeof(freq_start[0]); f++)
+    {
+        for (uint8_t step = 0; step <= 3; step++)
+        {
+            for (uint8_t a = 0; a < sizeof(antenna_div) / sizeof(antenna_div[0]); a++)
+            {
+                for (uint8_t remote = 0; remote <= 1; remote++)
+                {
+                    for (uint8_t long_addr = 0; long_addr <= 1; long_addr++)
+                    {
+                        params->pmu_freq_start = freq_start[f];
+                        params->pmu_freq_stop = freq_start[f] + RTB_SIM_SWEEP_BAND_MHZ;
+                        params->pmu_freq_step = step;
+                        params->antenna_div = antenna_div[a];
+                        params->provide_antenna_div_results = provide_results[a];
+                        params->remote = remote;
+                        params->long_addr = long_addr;
+                        no_of_nodes = remote ? 3 : 2;
+
+                        for (uint8_t phase = 0; phase <= RTB_SIM_NO_OF_PHASES; phase++)
+                        {
+                            latency[phase].count = 0;
+                        }
+
+                        if (!setup_nodes(params))
+                        {
+                            unload_nodes();
+                            return EXIT_FAILURE;
+                        }
+                        if (0 == static_ram)
+                        {
+                            static_ram = node_static_ram(&nodes[0]);
+                        }
+
+                        run((uint64_t)(params->duration_s * 1e6));
+                        sweep_result(params, static_ram);
+                        unload_nodes();
+                    }
+                }
+            }
+        }
+    }
+
+    for (uint8_t phase = 0; phase <= RTB_SIM_NO_OF_PHASES; phase++)
+    {
+        free(latency[phase].values);
+        latency[phase].values = NULL;
+        latency[phase].size = 0;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief Prints the CSV line of one combination of the sweep mode
+ *
+ * @param params Parameters of the simulation
+ * @param static_ram Static RAM of a node in octets
+ */
+static void sweep_result(const sim_params_t *params, uint32_t static_ram)
+{
+    rtb_sim_node_stats_t total;
+
+    get_total_stats(&total, false);
+
+    printf("%u,%u,%u,%u,%u,%s,%s,%u,%u,%.2f,%.2f",
+           params->pmu_freq_start, params->pmu_freq_stop, params->pmu_freq_step,
+           params->antenna_div, params->provide_antenna_div_results,
+           params->remote ? "remote" : "local",
+           params->long_addr ? "long" : "short",
+           total.range_success, total.range_failed,
+           total.range_success / params->duration_s,
+           (total.range_success > 0) ?
+           ((double)(total.trx.tx_frames + total.trx.tx_acks) / total.range_success) : 0.0);
+    for (uint8_t phase = 0; phase <= RTB_SIM_NO_OF_PHASES; phase++)
+    {
+        printf(",%u,%u,%u",
+               percentile(&latency[phase], 50),
+               percentile(&latency[phase], 90),
+               percentile(&latency[phase], 99));
+    }
+    printf(",%u,%u,%u,%u\n",
+           total.peak_large_bufs, total.peak_small_bufs, total.peak_buf_bytes,
+           static_ram);
+    fflush(stdout);
+}
+
+
+
+/**
+ * @brief Gets a percentile of latency samples (nearest rank)
+ *
+ * @param samples Samples, sorted by this function
+ * @param pct Percentile (1 .. 100)
+ *
+ * @return Percentile in us, 0 without samples
+ */
+static uint32_t percentile(sim_samples_t *samples, uint8_t pct)
+{
+    uint32_t rank;
+
+    if (0 == samples->count)
+    {
+        return 0;
+    }
+
+    qsort(samples->values, samples->count, sizeof(uint32_t), compare_u32);
+
+    rank = (uint32_t)(((uint64_t)samples->count * pct + 99) / 100);
+
+    return samples->values[(rank > 0) ? (rank - 1) : 0];
+}
+
+
+
+/**
+ * @brief Compares two latency samples for qsort()
+ */
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+
+/**
+ * @brief Sums up the writable segments of the node object
+ *
+ * Callback of dl_iterate_phdr(), data points to the load address of the
+ * node object on entry and receives the size on return.
+ */
+static int phdr_static_ram(struct dl_phdr_info *info, size_t size, void *data)
+{
+    uint64_t *result = (uint64_t *)data;
+    uint64_t ram = 0;
+
+    size = size; /* Keep compiler happy. */
+
+    if (info->dlpi_addr != (ElfW(Addr))*result)
+    {
+        return 0;
+    }
+
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++)
+    {
+        if ((PT_LOAD == info->dlpi_phdr[i].p_type) &&
+            (info->dlpi_phdr[i].p_flags & PF_W))
+        {
+            ram += info->dlpi_phdr[i].p_memsz;
+        }
+    }
+    *result = ram;
+
+    return 1;
+}
+
+
+
+/**
+ * @brief Gets the static RAM of a node
+ *
+ * The static RAM is the size of the writable segments of the node object,
+ * i.e. data, bss (including the buffer pool) and the relocated pointers.
+ *
+ * @return Static RAM in octets, 0 if unknown
+ */
+static uint32_t node_static_ram(const sim_node_t *node)
+{
+    struct link_map *map;
+    uint64_t data;
+
+    if ((0 != dlinfo(node->handle, RTLD_DI_LINKMAP, &map)) || (NULL == map))
+    {
+        return 0;
+    }
+
+    data = map->l_addr;
+    if (0 == dl_iterate_phdr(phdr_static_ram, &data))
+    {
+        return 0;
+    }
+
+    return (uint32_t)data;
+}
+
+
+
+/**
+ * @brief Reads the real time
+ */
+static double wall_clock_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/* EOF */
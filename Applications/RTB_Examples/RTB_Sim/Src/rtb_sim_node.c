@@ -0,0 +1,977 @@
+/**
+ * @file rtb_sim_node.c
+ *
+ * @brief Node application of the RTB network simulator
+ *
+ * This is the application running on each simulated node. It is linked
+ * with the complete stack into a shared object, which is loaded once per
+ * node by the simulator (see rtb_sim.c). Nodes with an assigned Reflector
+ * act as Initiator and range continuously with their Reflector, all other
+ * nodes answer range requests as Reflector only.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "rtb_api.h"
+#include "rtb_internal.h"
+#include "app_config.h"
+#include "rtb_sim.h"
+
+/* === Macros ============================================================== */
+
+/** Number of idle main loop iterations after which the node waits for an event */
+#define RTB_SIM_IDLE_LOOPS              (4)
+
+/** Maximum number of main loop iterations within one step */
+#define RTB_SIM_MAX_LOOPS               (10000)
+
+/** Number of reads of the same time after which the node polls the clock */
+#define RTB_SIM_POLL_READS              (16)
+
+/** CPU time of polling the clock in us */
+#define RTB_SIM_POLL_US                 (1)
+
+/** Share of valid PMU values of a sweep of good quality in percent */
+#define RTB_SIM_ADAPTIVE_MIN_VALID      (75)
+
+/** Time between the ED scans of two blocks of the spectrum monitor in ms */
+#define RTB_SIM_SPECTRUM_SCAN_INTERVAL  (500)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/** Configuration of this node */
+static rtb_sim_node_config_t node_config;
+
+/** Clock of the simulator */
+static const pal_host_clock_t *sim_clock;
+
+/** Clock of the node, counting the accesses of the stack to the clock */
+static pal_host_clock_t node_clock;
+
+/** Number of times the stack consumed time, e.g. by transceiver accesses */
+static uint32_t node_clock_waits;
+
+/** Last time read from the virtual clock */
+static uint64_t node_clock_last_read;
+
+/** Number of reads of the last time */
+static uint8_t node_clock_reads;
+
+/** Ranging statistics of this node */
+static rtb_sim_node_stats_t node_stats;
+
+/** Remote node pairs waiting for their next remote range request */
+static uint32_t remote_pending_pairs;
+
+/** State of the random generator of the application */
+static uint32_t node_rnd_state;
+
+/** The next range request uses the precise ranging profile */
+static bool node_precise_profile;
+
+#ifdef ENABLE_RTB_TRACE
+/** Number of the last ranging transaction passed to the simulator */
+static uint16_t node_trace_seq;
+#endif  /* ENABLE_RTB_TRACE */
+
+/* === Prototypes ========================================================== */
+
+static bool node_init(const rtb_sim_node_config_t *config,
+                      const pal_host_clock_t *clock,
+                      const trx_emu_medium_t *medium);
+static void node_step(void);
+static bool node_next_event(uint64_t *time_us);
+static void node_deliver(const trx_emu_frame_t *frame);
+static void node_get_stats(rtb_sim_node_stats_t *stats);
+static uint8_t node_get_transactions(rtb_sim_transaction_t *trans,
+                                     uint8_t max_trans);
+static uint64_t node_clock_now(void *ctx);
+static void node_clock_wait(void *ctx, uint64_t time_us);
+static void schedule_range_req(uint32_t pause_us);
+static void range_req_cb(void *parameter);
+static uint8_t node_addr_mode(void);
+static uint64_t node_addr(uint16_t short_addr);
+static void set_range_profile(wpan_rtb_range_req_t *wrrr);
+static void set_tdma_schedule(void);
+static void add_bulk_attr(wpan_rtb_set_bulk_req_t *attrs, uint8_t layer,
+                          uint8_t attribute, void *value, uint8_t size);
+static uint32_t node_rand(void);
+
+/* === Externals =========================================================== */
+
+/**
+ * Interface of this node object to the simulator
+ *
+ * This is the only symbol exported by the node object.
+ */
+__attribute__((visibility("default")))
+const rtb_sim_node_api_t rtb_sim_node_api =
+{
+    RTB_SIM_API_VERSION,
+    node_init,
+    node_step,
+    node_next_event,
+    node_deliver,
+    node_get_stats,
+    node_get_transactions
+};
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the node
+ *
+ * @param config Node configuration
+ * @param clock Virtual clock of the simulator
+ * @param medium Medium of the simulator
+ *
+ * @return true if the stack has been initialized
+ */
+static bool node_init(const rtb_sim_node_config_t *config,
+                      const pal_host_clock_t *clock,
+                      const trx_emu_medium_t *medium)
+{
+    if ((config->no_of_batch_reflectors > RTB_BATCH_MAX_REFLECTORS) ||
+        (config->no_of_remote_pairs > RTB_SIM_MAX_REMOTE_PAIRS))
+    {
+        return false;
+    }
+
+    node_config = *config;
+    sim_clock = clock;
+    node_rnd_state = (0 != config->trx.seed) ? config->trx.seed : 1;
+
+    node_clock.now_us = node_clock_now;
+    node_clock.wait_until = node_clock_wait;
+    node_clock.ctx = NULL;
+
+    /* The PAL needs to use the simulator instead of the host resources. */
+    pal_host_clock_set(&node_clock);
+    trx_emu_configure(&config->trx, medium);
+
+    /* Initialize the MAC layer and its underlying layers, like PAL, TAL, BMM. */
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        return false;
+    }
+
+    pal_global_irq_enable();
+
+    /*
+     * Reset the MAC layer to the default values.
+     * This request will cause a mlme reset confirm message ->
+     * usr_mlme_reset_conf
+     */
+    wpan_mlme_reset_req(true);
+
+    /* Process the reset, it does not wait for any timer or transceiver event. */
+    node_step();
+
+    return true;
+}
+
+
+
+/**
+ * @brief Runs the main loop until the node waits for an event
+ *
+ * An iteration of the main loop is idle if no layer had anything to do
+ * and the transceiver has not been accessed.
+ */
+static void node_step(void)
+{
+    uint8_t idle_loops = 0;
+    uint16_t loops;
+
+    for (loops = 0;
+         (loops < RTB_SIM_MAX_LOOPS) && (idle_loops < RTB_SIM_IDLE_LOOPS);
+         loops++)
+    {
+        uint32_t waits = node_clock_waits;
+
+        if (wpan_task() || (waits != node_clock_waits))
+        {
+            idle_loops = 0;
+        }
+        else
+        {
+            idle_loops++;
+        }
+
+        sim_clock->wait_until(sim_clock->ctx,
+                              sim_clock->now_us(sim_clock->ctx) + node_config.loop_us);
+    }
+}
+
+
+
+/**
+ * @brief Gets the time of the next timer or transceiver event
+ *
+ * @param[out] time_us Host time of the event
+ *
+ * @return false if the node does not wait for any event
+ */
+static bool node_next_event(uint64_t *time_us)
+{
+    uint64_t timer_us;
+    uint64_t trx_us;
+    bool timer_pending = pal_timer_next_expiry(&timer_us);
+    bool trx_pending = trx_emu_next_event(&trx_us);
+
+    if (timer_pending && trx_pending)
+    {
+        *time_us = (timer_us < trx_us) ? timer_us : trx_us;
+    }
+    else if (timer_pending)
+    {
+        *time_us = timer_us;
+    }
+    else if (trx_pending)
+    {
+        *time_us = trx_us;
+    }
+
+    return (timer_pending || trx_pending);
+}
+
+
+
+/**
+ * @brief Passes a frame of another node to the transceiver
+ */
+static void node_deliver(const trx_emu_frame_t *frame)
+{
+    trx_emu_deliver(frame);
+}
+
+
+
+/**
+ * @brief Gets the statistics of the node
+ */
+static void node_get_stats(rtb_sim_node_stats_t *stats)
+{
+    *stats = node_stats;
+
+#ifdef ENABLE_RTB_STATS
+    stats->timeouts[RTB_SIM_TMO_RANGE_ACPT] =
+        rtb_timeout_stats[TMO_RTB_AWAIT_RANGE_ACPT_FRAME];
+    stats->timeouts[RTB_SIM_TMO_TIME_SYNC_REQ] =
+        rtb_timeout_stats[TMO_RTB_AWAIT_TIME_SYNC_REQ_FRAME];
+    stats->timeouts[RTB_SIM_TMO_PMU_START] =
+        rtb_timeout_stats[TMO_RTB_AWAIT_PMU_START_FRAME];
+    stats->timeouts[RTB_SIM_TMO_PMU_MEAS] =
+        rtb_timeout_stats[TMO_RTB_INIT_PMU_START_FRAME];
+    stats->timeouts[RTB_SIM_TMO_RESULT_CONF] =
+        rtb_timeout_stats[TMO_RTB_AWAIT_RESULT_CONF_FRAME];
+    stats->timeouts[RTB_SIM_TMO_RESULT_REQ] =
+        rtb_timeout_stats[TMO_RTB_AWAIT_RESULT_REQ_FRAME];
+#endif  /* ENABLE_RTB_STATS */
+
+#ifdef ENABLE_BMM_STATS
+    {
+        bmm_stats_t bmm_stats;
+
+        bmm_get_stats(&bmm_stats, false);
+        stats->peak_large_bufs = TOTAL_NUMBER_OF_LARGE_BUFS -
+                                 bmm_stats.min_free[BMM_CLASS_LARGE];
+        stats->peak_small_bufs = TOTAL_NUMBER_OF_SMALL_BUFS -
+                                 bmm_stats.min_free[BMM_CLASS_SMALL];
+        stats->peak_buf_bytes =
+            (uint32_t)stats->peak_large_bufs * LARGE_BUFFER_SIZE +
+            (uint32_t)stats->peak_small_bufs * SMALL_BUFFER_SIZE;
+    }
+#endif  /* ENABLE_BMM_STATS */
+
+#ifdef ENABLE_RTB_ADAPTIVE
+    {
+        rtb_adaptive_stats_t adaptive_stats;
+
+        rtb_adaptive_get_stats(&adaptive_stats);
+        stats->swept_rangings = adaptive_stats.NoOfRangings;
+        stats->dense_sweeps = adaptive_stats.NoOfDenseSweeps;
+        stats->swept_freqs = adaptive_stats.NoOfFrequencies;
+    }
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+#ifdef ENABLE_RTB_SPECTRUM
+    {
+        rtb_spectrum_stats_t spectrum_stats;
+
+        rtb_spectrum_get_stats(&spectrum_stats);
+        stats->spectrum_scans = spectrum_stats.NoOfScans;
+        stats->spectrum_rangings = spectrum_stats.NoOfRangings;
+        stats->reduced_plans = spectrum_stats.NoOfReducedPlans;
+        stats->skipped_freqs = spectrum_stats.NoOfSkippedFrequencies;
+    }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+    trx_emu_get_stats(&stats->trx);
+}
+
+
+
+/**
+ * @brief Gets the ranging transactions finished since the last call
+ *
+ * @param[out] trans Transactions, oldest first
+ * @param max_trans Maximum number of transactions
+ *
+ * @return Number of transactions
+ */
+static uint8_t node_get_transactions(rtb_sim_transaction_t *trans,
+                                     uint8_t max_trans)
+{
+#ifdef ENABLE_RTB_TRACE
+    rtb_trace_transaction_t traced[RTB_TRACE_MAX_TRANSACTIONS];
+    uint8_t no_of_traced = rtb_trace_get_transactions(traced,
+                                                      RTB_TRACE_MAX_TRANSACTIONS);
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < no_of_traced; i++)
+    {
+        /* The sequence numbers wrap around, hence the difference decides. */
+        if ((int16_t)(traced[i].Seq - node_trace_seq) <= 0)
+        {
+            continue;
+        }
+        node_trace_seq = traced[i].Seq;
+
+        if (count < max_trans)
+        {
+            trans[count].role = traced[i].Role;
+            trans[count].status = traced[i].Status;
+            for (uint8_t phase = 0; phase < RTB_SIM_NO_OF_PHASES; phase++)
+            {
+                trans[count].phase_us[phase] = traced[i].PhaseDuration[phase];
+            }
+            count++;
+        }
+    }
+
+    return count;
+#else
+    /* Keep compiler happy. */
+    trans = trans;
+    max_trans = max_trans;
+
+    return 0;
+#endif  /* ENABLE_RTB_TRACE */
+}
+
+
+
+/**
+ * @brief Reads the virtual clock
+ *
+ * Reading the same time many times means the node polls the clock in a
+ * busy loop (e.g. the slotted CSMA-CA waiting for a backoff boundary), which
+ * consumes CPU time; otherwise the loop would never end.
+ */
+static uint64_t node_clock_now(void *ctx)
+{
+    uint64_t now = sim_clock->now_us(sim_clock->ctx);
+
+    ctx = ctx; /* Keep compiler happy. */
+
+    if (now != node_clock_last_read)
+    {
+        node_clock_last_read = now;
+        node_clock_reads = 0;
+    }
+    else if (++node_clock_reads >= RTB_SIM_POLL_READS)
+    {
+        sim_clock->wait_until(sim_clock->ctx, now + RTB_SIM_POLL_US);
+        now = sim_clock->now_us(sim_clock->ctx);
+        node_clock_last_read = now;
+        node_clock_reads = 0;
+    }
+
+    return now;
+}
+
+
+
+/**
+ * @brief Consumes CPU time on the virtual clock
+ */
+static void node_clock_wait(void *ctx, uint64_t time_us)
+{
+    ctx = ctx; /* Keep compiler happy. */
+
+    node_clock_waits++;
+    sim_clock->wait_until(sim_clock->ctx, time_us);
+}
+
+
+
+/**
+ * @brief Starts the timer for the next range request
+ *
+ * @param pause_us Time until the range request in us
+ */
+static void schedule_range_req(uint32_t pause_us)
+{
+    if (node_config.jitter_us > 0)
+    {
+        pause_us += node_rand() % (node_config.jitter_us + 1);
+    }
+
+    if (pause_us < MIN_TIMEOUT)
+    {
+        pause_us = MIN_TIMEOUT;
+    }
+
+    pal_timer_start(RTB_SIM_RANGING_TIMER,
+                    pause_us,
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR())range_req_cb,
+                    NULL);
+}
+
+
+
+/**
+ * @brief Issues a range request to the Reflector(s) of this node
+ *
+ * If the node is configured for batch rangings, all its Reflectors
+ * are ranged with by a single batch range request.
+ *
+ * @param parameter Pointer to callback parameter
+ *                  (not used in this application, but could be used
+ *                  to indicated LED to be switched off)
+ */
+static void range_req_cb(void *parameter)
+{
+    wpan_rtb_range_req_t wrrr;
+
+    parameter = parameter; /* Keep compiler happy. */
+
+    if (node_config.no_of_batch_reflectors > 0)
+    {
+        wpan_rtb_range_batch_req_t wrrbr;
+        uint8_t i;
+
+        wrrbr.InitiatorAddrMode = node_addr_mode();
+        wrrbr.InitiatorPANId = node_config.pan_id;
+        wrrbr.InitiatorAddr = node_addr(node_config.short_addr);
+        wrrbr.NoOfReflectors = node_config.no_of_batch_reflectors;
+        for (i = 0; i < wrrbr.NoOfReflectors; i++)
+        {
+            wrrbr.Reflectors[i].ReflectorAddrMode = node_addr_mode();
+            wrrbr.Reflectors[i].ReflectorPANId = node_config.pan_id;
+            wrrbr.Reflectors[i].ReflectorAddr = node_addr(node_config.reflector_addr + i);
+        }
+
+        node_stats.range_req += wrrbr.NoOfReflectors;
+        if (!wpan_rtb_range_batch_req(&wrrbr))
+        {
+            /* No buffer available, try again later. */
+            node_stats.range_failed += wrrbr.NoOfReflectors;
+            schedule_range_req(node_config.interval_us);
+        }
+        return;
+    }
+
+    if (node_config.no_of_remote_pairs > 0)
+    {
+        /* Request the rangings of all waiting pairs concurrently. */
+        for (uint8_t k = 0; k < node_config.no_of_remote_pairs; k++)
+        {
+            if (0 == (remote_pending_pairs & (1UL << k)))
+            {
+                continue;
+            }
+
+            wrrr.InitiatorAddrMode = node_addr_mode();
+            wrrr.InitiatorPANId = node_config.pan_id;
+            wrrr.InitiatorAddr = node_addr(node_config.reflector_addr + (2 * k));
+            wrrr.ReflectorAddrMode = node_addr_mode();
+            wrrr.ReflectorPANId = node_config.pan_id;
+            wrrr.ReflectorAddr = node_addr(node_config.reflector_addr + (2 * k) + 1);
+            wrrr.CoordinatorAddrMode = node_addr_mode();
+            set_range_profile(&wrrr);
+
+            node_stats.range_req++;
+            if (wpan_rtb_range_req(&wrrr))
+            {
+                remote_pending_pairs &= ~(1UL << k);
+            }
+            else
+            {
+                /* No buffer available, try again later. */
+                node_stats.range_failed++;
+            }
+        }
+
+        if (0 != remote_pending_pairs)
+        {
+            schedule_range_req(node_config.interval_us);
+        }
+        return;
+    }
+
+    wrrr.InitiatorAddrMode = node_addr_mode();
+    wrrr.InitiatorPANId = node_config.pan_id;
+    wrrr.InitiatorAddr = node_addr(node_config.short_addr);
+    wrrr.ReflectorAddrMode = node_addr_mode();
+    wrrr.ReflectorPANId = node_config.pan_id;
+    wrrr.ReflectorAddr = node_addr(node_config.reflector_addr);
+    wrrr.CoordinatorAddrMode = NO_COORDINATOR;
+    set_range_profile(&wrrr);
+
+    node_stats.range_req++;
+    if (!wpan_rtb_range_req(&wrrr))
+    {
+        /* No buffer available, try again later. */
+        node_stats.range_failed++;
+        schedule_range_req(node_config.interval_us);
+    }
+}
+
+
+
+/**
+ * @brief Gets the address mode of the range requests
+ */
+static uint8_t node_addr_mode(void)
+{
+    return node_config.long_addr ? WPAN_ADDRMODE_LONG : WPAN_ADDRMODE_SHORT;
+}
+
+
+
+/**
+ * @brief Gets the address of a node used within the range requests
+ *
+ * The emulated transceivers number their IEEE addresses by the node id
+ * like the simulator numbers the short addresses, so the IEEE address of
+ * another node follows from the own one.
+ *
+ * @param short_addr Short address of the node
+ *
+ * @return Short or IEEE address of the node
+ */
+static uint64_t node_addr(uint16_t short_addr)
+{
+    if (!node_config.long_addr)
+    {
+        return short_addr;
+    }
+
+    return tal_pib.IeeeAddress - node_config.short_addr + short_addr;
+}
+
+
+
+/**
+ * @brief Sets the ranging profile of a range request
+ *
+ * The coarse and the precise ranging profile alternate if configured;
+ * both measure the PMU band of the RTB PIB.
+ *
+ * @param wrrr Range request
+ */
+static void set_range_profile(wpan_rtb_range_req_t *wrrr)
+{
+    wrrr->UseProfile = node_config.alternate_profiles;
+    if (!wrrr->UseProfile)
+    {
+        return;
+    }
+
+    wrrr->Profile.PMUFreqStart = rtb_pib.PMUFreqStart;
+    wrrr->Profile.PMUFreqStop = rtb_pib.PMUFreqStop;
+    wrrr->Profile.RangingTransmitPower = rtb_pib.RangingTransmitPower;
+    wrrr->Profile.ProvideRangingTransmitPower = rtb_pib.ProvideRangingTransmitPower;
+    wrrr->Profile.ProvideAntennaDivResults = node_config.provide_antenna_div_results;
+    if (node_precise_profile)
+    {
+        wrrr->Profile.PMUFreqStep = PMU_STEP_FREQ_500kHz;
+        wrrr->Profile.EnableAntennaDiv = true;
+    }
+    else
+    {
+        wrrr->Profile.PMUFreqStep = PMU_STEP_FREQ_2MHz;
+        wrrr->Profile.EnableAntennaDiv = false;
+    }
+    node_precise_profile = !node_precise_profile;
+}
+
+
+
+/**
+ * @brief Adds a PIB attribute to the bulk request of this node
+ *
+ * @param attrs Bulk request
+ * @param layer Layer of the PIB attribute
+ * @param attribute PIB attribute
+ * @param value Value of the PIB attribute
+ * @param size Size of the value in octets
+ */
+static void add_bulk_attr(wpan_rtb_set_bulk_req_t *attrs, uint8_t layer,
+                          uint8_t attribute, void *value, uint8_t size)
+{
+    rtb_bulk_attr_t *attr = &attrs->Attributes[attrs->NoOfAttributes++];
+
+    attr->Layer = layer;
+    attr->PIBAttribute = attribute;
+    memset(&attr->PIBAttributeValue, 0, sizeof(pib_value_t));
+    memcpy(&attr->PIBAttributeValue, value, size);
+}
+
+
+
+/**
+ * @brief Random numbers of the application (xorshift32)
+ */
+static uint32_t node_rand(void)
+{
+    node_rnd_state ^= node_rnd_state << 13;
+    node_rnd_state ^= node_rnd_state >> 17;
+    node_rnd_state ^= node_rnd_state << 5;
+
+    return node_rnd_state;
+}
+
+
+
+/**
+ * @brief Callback function usr_mlme_reset_conf
+ *
+ * @param status Result of the reset procedure
+ */
+void usr_mlme_reset_conf(uint8_t status)
+{
+    if (status == MAC_SUCCESS)
+    {
+        /* Always enable receiver. */
+        bool rx_on_when_idle = true;
+
+        mlme_set(macRxOnWhenIdle,
+                 (pib_value_t *)&rx_on_when_idle,
+                 false);
+
+        /* Reset RTB. */
+        wpan_rtb_reset_req();
+    }
+    else
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+
+/**
+ * @brief Callback function usr_rtb_reset_conf
+ *
+ * @param urrc  Pointer to usr_rtb_reset_conf_t result structure.
+ */
+void usr_rtb_reset_conf(usr_rtb_reset_conf_t *urrc)
+{
+    wpan_rtb_set_bulk_req_t pib;
+    uint8_t failed_attr;
+
+    if (RTB_SUCCESS != urrc->status)
+    {
+        wpan_mlme_reset_req(true);
+        return;
+    }
+
+    /*
+     * The addresses and the PMU parameters of this node are set at once;
+     * the PMU band is validated as a whole, so the order of the updates
+     * of its start and stop frequency does not matter.
+     */
+    pib.NoOfAttributes = 0;
+    add_bulk_attr(&pib, RTB_BULK_LAYER_MAC, macPANId,
+                  &node_config.pan_id, sizeof(uint16_t));
+    add_bulk_attr(&pib, RTB_BULK_LAYER_MAC, macShortAddress,
+                  &node_config.short_addr, sizeof(uint16_t));
+    if (RTB_SIM_PMU_DEFAULT != node_config.pmu_freq_start)
+    {
+        add_bulk_attr(&pib, RTB_BULK_LAYER_RTB, RTB_PIB_PMU_FREQ_START,
+                      &node_config.pmu_freq_start, sizeof(uint16_t));
+    }
+    if (RTB_SIM_PMU_DEFAULT != node_config.pmu_freq_stop)
+    {
+        add_bulk_attr(&pib, RTB_BULK_LAYER_RTB, RTB_PIB_PMU_FREQ_STOP,
+                      &node_config.pmu_freq_stop, sizeof(uint16_t));
+    }
+    if (RTB_SIM_PMU_DEFAULT != node_config.pmu_freq_step)
+    {
+        add_bulk_attr(&pib, RTB_BULK_LAYER_RTB, RTB_PIB_PMU_FREQ_STEP,
+                      &node_config.pmu_freq_step, sizeof(uint8_t));
+    }
+#if (ANTENNA_DIVERSITY == 1)
+    add_bulk_attr(&pib, RTB_BULK_LAYER_RTB, RTB_PIB_ENABLE_ANTENNA_DIV,
+                  &node_config.antenna_div, sizeof(bool));
+#endif  /* (ANTENNA_DIVERSITY == 1) */
+    add_bulk_attr(&pib, RTB_BULK_LAYER_RTB, RTB_PIB_PROVIDE_ANTENNA_DIV_RESULTS,
+                  &node_config.provide_antenna_div_results, sizeof(bool));
+
+    /* An invalid PMU band is rejected as a whole; the defaults remain. */
+    rtb_set_bulk(pib.Attributes, pib.NoOfAttributes, &failed_attr);
+
+#ifdef ENABLE_RTB_ADAPTIVE
+    if (node_config.adaptive_sweep)
+    {
+        rtb_adaptive_config_t adaptive;
+
+        adaptive.Enabled = true;
+        adaptive.DQFThreshold = node_config.adaptive_dqf_threshold;
+        adaptive.MinValidPercent = RTB_SIM_ADAPTIVE_MIN_VALID;
+        adaptive.DenseFreqStep = PMU_STEP_FREQ_500kHz;
+        rtb_adaptive_set_config(&adaptive);
+    }
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+#ifdef ENABLE_RTB_SPECTRUM
+    if (node_config.spectrum_monitor)
+    {
+        rtb_spectrum_config_t spectrum;
+
+        spectrum.Enabled = true;
+        spectrum.EDThreshold = node_config.spectrum_ed_threshold;
+        spectrum.ScanInterval = RTB_SIM_SPECTRUM_SCAN_INTERVAL;
+        rtb_spectrum_set_config(&spectrum);
+    }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+    if (node_config.beacon_order < RTB_SIM_NON_BEACON_NWK)
+    {
+        if (node_config.no_of_tdma_slots > 0)
+        {
+            /*
+             * The Coordinator starts the beacon-enabled network. The TDMA
+             * schedule is set before, so that already the first beacon
+             * contains it.
+             */
+            mlme_set(macBeaconOrder,
+                     (pib_value_t *)&node_config.beacon_order,
+                     false);
+            set_tdma_schedule();
+            wpan_mlme_start_req(node_config.pan_id,
+                                tal_pib.CurrentChannel,
+                                tal_pib.CurrentPage,
+                                node_config.beacon_order,
+                                node_config.beacon_order,
+                                true, false, false);
+        }
+        else
+        {
+            /*
+             * All other nodes track the beacons of the Coordinator. The
+             * beacon order is known, so the lost beacons are detected
+             * in time before the first beacon.
+             */
+            mlme_set(macCoordShortAddress,
+                     (pib_value_t *)&node_config.coord_addr,
+                     false);
+            mlme_set(macBeaconOrder,
+                     (pib_value_t *)&node_config.beacon_order,
+                     false);
+            wpan_mlme_sync_req(tal_pib.CurrentChannel,
+                               tal_pib.CurrentPage,
+                               true);
+        }
+    }
+
+    if (RTB_SIM_NO_REFLECTOR != node_config.reflector)
+    {
+        uint64_t now = pal_host_clock_us();
+        uint32_t pause_us = 0;
+
+        if (node_config.start_us > now)
+        {
+            pause_us = (uint32_t)(node_config.start_us - now);
+        }
+
+        /* All remote node pairs wait for their first remote range request. */
+        remote_pending_pairs = 0;
+        for (uint8_t k = 0; k < node_config.no_of_remote_pairs; k++)
+        {
+            remote_pending_pairs |= (1UL << k);
+        }
+
+        schedule_range_req(pause_us);
+    }
+}
+
+
+
+/**
+ * @brief Callback function usr_mlme_start_conf
+ *
+ * @param status Result of the start procedure
+ */
+void usr_mlme_start_conf(uint8_t status)
+{
+    if (MAC_SUCCESS != status)
+    {
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+
+/**
+ * @brief Sets the TDMA schedule announced within the beacons
+ *
+ * Slot k belongs to the node pair 2k + 1 and 2k + 2.
+ */
+static void set_tdma_schedule(void)
+{
+    rtb_tdma_schedule_t schedule;
+
+    schedule.SlotStart = RTB_SIM_TDMA_SLOT_START_MS;
+    schedule.SlotDuration = node_config.tdma_slot_ms;
+    schedule.NoOfSlots = node_config.no_of_tdma_slots;
+    for (uint8_t k = 0; k < schedule.NoOfSlots; k++)
+    {
+        schedule.Slots[k].InitiatorAddr = node_config.short_addr + 2 * k + 1;
+        schedule.Slots[k].ReflectorAddr = node_config.short_addr + 2 * k + 2;
+    }
+
+    /* The beacon order has been chosen such that all slots fit. */
+    rtb_tdma_set_schedule(&schedule);
+}
+
+
+
+/**
+ * @brief Callback function usr_mlme_sync_loss_ind
+ *
+ * The node re-synchronizes with the Coordinator; deferred range requests
+ * are released by the RTB once the schedule is lost.
+ *
+ * @param LossReason Reason for the synchronization loss
+ * @param PANId PAN Id of the Coordinator
+ * @param LogicalChannel Channel of the Coordinator
+ * @param ChannelPage Channel page of the Coordinator
+ */
+void usr_mlme_sync_loss_ind(uint8_t LossReason,
+                            uint16_t PANId,
+                            uint8_t LogicalChannel,
+                            uint8_t ChannelPage)
+{
+    node_stats.sync_losses++;
+    wpan_mlme_sync_req(LogicalChannel, ChannelPage, true);
+
+    /* Keep compiler happy. */
+    LossReason = LossReason;
+    PANId = PANId;
+}
+
+
+
+/**
+ * @brief Callback function usr_rtb_range_conf
+ *
+ * @param urrc  Pointer to usr_rtb_range_conf_t result structure.
+ */
+void usr_rtb_range_conf(usr_rtb_range_conf_t *urrc)
+{
+    if (RTB_REMOTE_RANGING == urrc->ranging_type)
+    {
+        uint8_t k = (uint8_t)((urrc->results.remote.InitiatorAddr -
+                               node_addr(node_config.reflector_addr)) / 2);
+
+        if (RTB_SUCCESS == urrc->results.remote.status)
+        {
+            node_stats.range_success++;
+            node_stats.distance_sum += urrc->results.remote.distance;
+            node_stats.dqf_sum += urrc->results.remote.dqf;
+        }
+        else
+        {
+            node_stats.range_failed++;
+        }
+
+        if (k < node_config.no_of_remote_pairs)
+        {
+            remote_pending_pairs |= (1UL << k);
+            if (!pal_is_timer_running(RTB_SIM_RANGING_TIMER))
+            {
+                schedule_range_req(node_config.interval_us);
+            }
+        }
+        return;
+    }
+
+    if (RTB_LOCAL_RANGING != urrc->ranging_type)
+    {
+        return;
+    }
+
+    if (RTB_SUCCESS == urrc->results.local.status)
+    {
+        node_stats.range_success++;
+        node_stats.distance_sum += urrc->results.local.distance;
+        node_stats.dqf_sum += urrc->results.local.dqf;
+    }
+    else
+    {
+        node_stats.range_failed++;
+    }
+
+    schedule_range_req(node_config.interval_us);
+}
+
+
+
+/**
+ * @brief Callback function usr_rtb_range_batch_conf
+ *
+ * @param urrbc  Pointer to usr_rtb_range_batch_conf_t result structure.
+ */
+void usr_rtb_range_batch_conf(usr_rtb_range_batch_conf_t *urrbc)
+{
+    uint8_t i;
+
+    if (RTB_SUCCESS != urrbc->status)
+    {
+        /* The batch has been rejected. */
+        node_stats.range_failed += node_config.no_of_batch_reflectors;
+    }
+
+    for (i = 0; i < urrbc->NoOfResults; i++)
+    {
+        if (RTB_SUCCESS == urrbc->results[i].status)
+        {
+            node_stats.range_success++;
+            node_stats.distance_sum += urrbc->results[i].distance;
+            node_stats.dqf_sum += urrbc->results[i].dqf;
+        }
+        else
+        {
+            node_stats.range_failed++;
+        }
+    }
+
+    schedule_range_req(node_config.interval_us);
+}
+
+/* EOF */
@@ -45,6 +45,8 @@ typedef enum retval_tag
     RTB_UNSUPPORTED_METHOD      = 0x17, /**< Requested Ranging method is currently not supported at reflector */
     RTB_TIMEOUT                 = 0x18, /**< Timeout since requested Ranging response frame is not received */
     RTB_UNSUPPORTED_PROTOCOL    = 0x19, /**< Requested RTB Protocol is currently not supported at node */
+    RTB_SESSION_TABLE_FULL      = 0x1A, /**< No further remote ranging session can be opened at the Coordinator */
+    RTB_TDMA_SLOT_END           = 0x1B, /**< Ranging stopped at the end of its TDMA slot or within the slot of another node pair */
     RH_SUCCESS                  = 0x20, /**< Success of RH command */
     RH_FAILURE                  = 0x21, /**< Failure of RH command */
     RP_NO_RESPONSE              = 0x22, /**< No response from RP */
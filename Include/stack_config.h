@@ -88,7 +88,8 @@
                                              MAX_MGMT_FRAME_LENGTH + \
                                              LENGTH_FIELD_LEN + LQI_LEN + ED_VAL_LEN)
 #elif ((PAL_GENERIC_TYPE == ARM7) || (PAL_GENERIC_TYPE == AVR32) ||\
-      (PAL_GENERIC_TYPE == SAM3) || (PAL_GENERIC_TYPE == SAM4))
+      (PAL_GENERIC_TYPE == SAM3) || (PAL_GENERIC_TYPE == SAM4) ||\
+      (PAL_GENERIC_TYPE == LINUX))
 /*
  * Size of frame_info_t + max number of payload octets +
  * 1 octet LQI  + 1 octet ED value.
@@ -155,7 +156,8 @@
                                              MAX_MGMT_FRAME_LENGTH + \
                                              LENGTH_FIELD_LEN + LQI_LEN + ED_VAL_LEN)
 #elif ((PAL_GENERIC_TYPE == ARM7) || (PAL_GENERIC_TYPE == AVR32) ||\
-      (PAL_GENERIC_TYPE == SAM3)|| (PAL_GENERIC_TYPE == SAM4))
+      (PAL_GENERIC_TYPE == SAM3)|| (PAL_GENERIC_TYPE == SAM4) ||\
+      (PAL_GENERIC_TYPE == LINUX))
 /*
  * Size of mcps_data_ind_t + max number of payload octets +
  * 1 octet LQI  + 1 octet ED value.
@@ -177,6 +179,33 @@
 #error "Unknown PAL_GENERIC_TYPE for buffer calculation"
 #endif
 
+#if defined(ENABLE_BMM_MSG_BUFS) && (HIGHEST_STACK_LAYER == MAC)
+/*
+ * The small buffers hold the messages which are never turned into frames
+ * (see BMM_MSG_SIZE() in bmm.h), so their size is taken from these
+ * messages. A request converted into its confirm in place needs both
+ * types listed here. The message types are required where the size is
+ * used.
+ */
+#ifdef ENABLE_RTB
+#define MSG_BUFFER_RTB_MEMBERS \
+    rtb_reset_req_t rtb_reset_req; \
+    rtb_reset_conf_t rtb_reset_conf; \
+    rtb_set_req_t rtb_set_req; \
+    rtb_set_conf_t rtb_set_conf;
+#else
+#define MSG_BUFFER_RTB_MEMBERS
+#endif  /* ENABLE_RTB */
+
+#undef SMALL_BUFFER_SIZE
+#define SMALL_BUFFER_SIZE                   (((sizeof(union \
+    { \
+        mlme_reset_req_t mlme_reset_req; \
+        mlme_reset_conf_t mlme_reset_conf; \
+        MSG_BUFFER_RTB_MEMBERS \
+    }) + 3) / 4) * 4)
+#endif  /* defined(ENABLE_BMM_MSG_BUFS) && (HIGHEST_STACK_LAYER == MAC) */
+
 #elif (HIGHEST_STACK_LAYER == RF4CE)
 /*
  +----------+
@@ -267,7 +296,12 @@
 #else
 #define NUMBER_OF_LARGE_STACK_BUFS      (4 + EXTRA_RTB_BUFFER)
 #endif  /* (MAC_INDIRECT_DATA_FFD == 1) */
+#ifdef ENABLE_BMM_MSG_BUFS
+/* One reset or set request of the application */
+#define NUMBER_OF_SMALL_STACK_BUFS          (1)
+#else
 #define NUMBER_OF_SMALL_STACK_BUFS          (0)
+#endif  /* ENABLE_BMM_MSG_BUFS */
 #endif  /* (HIGHEST_STACK_LAYER == MAC) */
 
 /* Configuration if RF4CE is the highest stack layer */
@@ -36,6 +36,12 @@
 
 /* === Macros =============================================================== */
 
+#ifdef ENABLE_BMM_STATS
+/* Buffers allocated by the MAC are accounted to the MAC. */
+#undef BMM_OWNER
+#define BMM_OWNER                       (BMM_OWNER_MAC)
+#endif  /* ENABLE_BMM_STATS */
+
 /*
  * Beacon order used as timer interval for checking the expiration of indirect
  * transactions in a nonbeacon-enabled network
@@ -47,6 +53,20 @@
  */
 #define FINAL_CAP_SLOT_DEFAULT          (0x0F)
 
+#if (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX)
+/*
+ * Keys of the index of the indirect data queue
+ */
+#define MAC_INDIRECT_KEY_DST_ADDR       (0)
+#define MAC_INDIRECT_KEY_MSDU_HANDLE    (1)
+
+/*
+ * Folds an extended address into the key of the index
+ */
+#define MAC_INDIRECT_LONG_ADDR_KEY(addr) \
+    ((uint16_t)((addr) ^ ((addr) >> 16) ^ ((addr) >> 32) ^ ((addr) >> 48)))
+#endif  /* (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX) */
+
 /* === Types ================================================================ */
 
 /**
@@ -337,6 +357,9 @@ extern queue_t tal_rtb_q;
 
 #if (MAC_INDIRECT_DATA_FFD == 1)
 extern queue_t indirect_data_q;
+#ifdef ENABLE_QUEUE_INDEX
+extern queue_index_t indirect_data_index;
+#endif  /* ENABLE_QUEUE_INDEX */
 #endif /* (MAC_INDIRECT_DATA_FFD == 1) */
 
 #if (MAC_START_REQUEST_CONFIRM == 1)
@@ -181,6 +181,13 @@ queue_t broadcast_q;
  * NHLE is placed here by MAC, until the device polls for the data.
  */
 queue_t indirect_data_q;
+
+#ifdef ENABLE_QUEUE_INDEX
+/**
+ * Index of the indirect data queue by destination address and MSDU handle.
+ */
+queue_index_t indirect_data_index;
+#endif  /* ENABLE_QUEUE_INDEX */
 #endif /* (MAC_INDIRECT_DATA_FFD == 1) */
 
 extern volatile bool timer_trigger;
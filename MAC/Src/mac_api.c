@@ -38,6 +38,11 @@
 
 /* === Macros ============================================================== */
 
+#ifdef ENABLE_BMM_STATS
+/* The requests of the MAC API are accounted to the application. */
+#undef BMM_OWNER
+#define BMM_OWNER                       (BMM_OWNER_APP)
+#endif  /* ENABLE_BMM_STATS */
 
 /* === Globals ============================================================= */
 
@@ -473,7 +478,7 @@ bool wpan_mlme_reset_req(bool SetDefaultPib)
     mlme_reset_req_t *mlme_reset_req;
 
     /* Allocate a small buffer for reset request */
-    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    buffer_header = bmm_buffer_alloc(BMM_MSG_SIZE(sizeof(mlme_reset_req_t)));
 
     if (NULL == buffer_header)
     {
@@ -516,6 +516,9 @@ void mac_process_data_request(buffer_t *msg)
     /* Buffer pointer to next indirect data frame to be transmitted. */
     buffer_t *buf_ptr_next_data;
     search_t find_buf;
+#ifdef ENABLE_QUEUE_INDEX
+    uint16_t key;
+#endif  /* ENABLE_QUEUE_INDEX */
     frame_info_t *transmit_frame;
     retval_t tal_tx_status;
 
@@ -549,6 +552,9 @@ void mac_process_data_request(buffer_t *msg)
 
         /* Update the short address to be searched. */
         find_buf.handle = &mac_parse_data.src_addr.short_address;
+#ifdef ENABLE_QUEUE_INDEX
+        key = mac_parse_data.src_addr.short_address;
+#endif  /* ENABLE_QUEUE_INDEX */
     }
     else if (mac_parse_data.src_addr_mode == FCF_LONG_ADDR)
     {
@@ -565,6 +571,9 @@ void mac_process_data_request(buffer_t *msg)
 
         /* Update the long address to be searched. */
         find_buf.handle = &mac_parse_data.src_addr.long_address;
+#ifdef ENABLE_QUEUE_INDEX
+        key = MAC_INDIRECT_LONG_ADDR_KEY(mac_parse_data.src_addr.long_address);
+#endif  /* ENABLE_QUEUE_INDEX */
     }
     else
     {
@@ -578,7 +587,13 @@ void mac_process_data_request(buffer_t *msg)
      * Read from the indirect queue. The removal of items from this queue
      * will be done after successful transmission of the frame.
      */
+#ifdef ENABLE_QUEUE_INDEX
+    buf_ptr_next_data = qmm_queue_index_read(&indirect_data_q,
+                                             MAC_INDIRECT_KEY_DST_ADDR,
+                                             key, &find_buf);
+#else
     buf_ptr_next_data = qmm_queue_read(&indirect_data_q, &find_buf);
+#endif  /* ENABLE_QUEUE_INDEX */
     /* Note: The find_buf structure is reused below, so do not change this. */
 
     if (NULL == buf_ptr_next_data)
@@ -628,7 +643,13 @@ void mac_process_data_request(buffer_t *msg)
              * It is assumed that the find_buf struct does still have
              * the original values from above.
              */
+#ifdef ENABLE_QUEUE_INDEX
+            buf_ptr_next_data = qmm_queue_index_read(&indirect_data_q,
+                                                     MAC_INDIRECT_KEY_DST_ADDR,
+                                                     key, &find_buf);
+#else
             buf_ptr_next_data = qmm_queue_read(&indirect_data_q, &find_buf);
+#endif  /* ENABLE_QUEUE_INDEX */
             /*
              * Check whether there is another indirect data available
              * for the same recipient.
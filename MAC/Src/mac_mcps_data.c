@@ -1060,7 +1060,13 @@ static bool mac_buffer_purge(uint8_t msdu_handle)
     find_buf.handle = &handle;
 
     /* Remove from indirect queue if the short address matches */
+#ifdef ENABLE_QUEUE_INDEX
+    buf_ptr = (uint8_t *)qmm_queue_index_remove(&indirect_data_q,
+                                                MAC_INDIRECT_KEY_MSDU_HANDLE,
+                                                handle, &find_buf);
+#else
     buf_ptr = (uint8_t *)qmm_queue_remove(&indirect_data_q, &find_buf);
+#endif  /* ENABLE_QUEUE_INDEX */
 
     if (NULL != buf_ptr)
     {
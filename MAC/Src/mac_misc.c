@@ -53,6 +53,9 @@ static uint8_t mac_reset(uint8_t init_pib);
 static void mac_soft_reset(uint8_t init_pib);
 static void reset_globals(void);
 static void send_reset_conf(buffer_t *buf_ptr, uint8_t status);
+#if (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX)
+static bool indirect_data_key(void *buf, uint8_t key_no, uint16_t *key);
+#endif  /* (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX) */
 
 /* === Implementation ====================================================== */
 
@@ -134,11 +137,58 @@ retval_t mac_init(void)
 #endif  /* BEACON_SUPPORT */
 #endif /* (MAC_START_REQUEST_CONFIRM == 1) */
 #endif  /* ENABLE_QUEUE_CAPACITY */
+#if (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX)
+    qmm_queue_index_init(&indirect_data_q, &indirect_data_index,
+                         indirect_data_key);
+#endif  /* (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX) */
     return MAC_SUCCESS;
 }
 
 
 
+#if (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX)
+/*
+ * @brief Returns the keys of an indirect data frame for the queue index
+ *
+ * @param buf Pointer to indirect data buffer
+ * @param key_no MAC_INDIRECT_KEY_DST_ADDR or MAC_INDIRECT_KEY_MSDU_HANDLE
+ * @param key Key of the frame
+ *
+ * @return True if the frame has a key of this number, false otherwise
+ */
+static bool indirect_data_key(void *buf, uint8_t key_no, uint16_t *key)
+{
+    frame_info_t *frame = (frame_info_t *)buf;
+
+    if (MAC_INDIRECT_KEY_MSDU_HANDLE == key_no)
+    {
+        *key = frame->msduHandle;
+        return true;
+    }
+
+    /* Read the type of destination address. */
+    switch ((frame->mpdu[PL_POS_FCF_2] >> FCF_2_DEST_ADDR_OFFSET) & FCF_ADDR_MASK)
+    {
+        case FCF_SHORT_ADDR:
+            *key = convert_byte_array_to_16_bit(&frame->mpdu[PL_POS_DST_ADDR_START]);
+            return true;
+
+        case FCF_LONG_ADDR:
+            {
+                uint64_t addr = convert_byte_array_to_64_bit(&frame->mpdu[PL_POS_DST_ADDR_START]);
+
+                *key = MAC_INDIRECT_LONG_ADDR_KEY(addr);
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+#endif  /* (MAC_INDIRECT_DATA_FFD == 1) && defined(ENABLE_QUEUE_INDEX) */
+
+
+
 /**
  * @brief Resets the MAC helper variables and transition to idle state
  *
@@ -37,6 +37,9 @@
 #include "mac_internal.h"
 #include "mac.h"
 #include "mac_build_config.h"
+#ifdef ENABLE_RTB_TDMA
+#include "rtb.h"
+#endif  /* ENABLE_RTB_TDMA */
 
 #if ((MAC_SCAN_SUPPORT == 1) || (MAC_SYNC_REQUEST == 1))
 
@@ -325,6 +328,15 @@ void mac_process_beacon_frame(buffer_t *beacon)
         NUM_LONG_PEND_ADDR(mac_parse_data.mac_payload_data.beacon_data.pending_addr_spec);
 #endif
 
+#ifdef ENABLE_RTB_TDMA
+    if (MAC_SCAN_IDLE == mac_scan_state)
+    {
+        /* The RTB takes the ranging slots from the beacon of the parent. */
+        rtb_tdma_process_beacon(mac_parse_data.mac_payload_data.beacon_data.beacon_payload,
+                                mac_parse_data.mac_payload_data.beacon_data.beacon_payload_len);
+    }
+#endif  /* ENABLE_RTB_TDMA */
+
 #if (MAC_BEACON_NOTIFY_INDICATION == 1)
     /*
      * In all cases (PAN or device) if the payload is not equal to zero
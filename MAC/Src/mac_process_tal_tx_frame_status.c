@@ -46,7 +46,9 @@
 static void mac_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame);
 
 #if (MAC_INDIRECT_DATA_FFD == 1)
+#ifndef ENABLE_QUEUE_INDEX
 static uint8_t find_buffer_cb(void *buf, void *address);
+#endif  /* ENABLE_QUEUE_INDEX */
 static void remove_frame_from_indirect_q(frame_info_t *f_ptr);
 #endif /* (MAC_INDIRECT_DATA_FFD == 1) */
 
@@ -455,6 +457,9 @@ void tal_tx_frame_done_cb(retval_t status, frame_info_t *frame)
  */
 static void remove_frame_from_indirect_q(frame_info_t *f_ptr)
 {
+#ifdef ENABLE_QUEUE_INDEX
+    qmm_queue_remove_buffer(&indirect_data_q, f_ptr->buffer_header);
+#else
     search_t find_buf;
 
     find_buf.criteria_func = find_buffer_cb;
@@ -463,12 +468,13 @@ static void remove_frame_from_indirect_q(frame_info_t *f_ptr)
     find_buf.handle = (void *)f_ptr->buffer_header;
 
     qmm_queue_remove(&indirect_data_q, &find_buf);
+#endif  /* ENABLE_QUEUE_INDEX */
 }
 #endif /* (MAC_INDIRECT_DATA_FFD == 1) */
 
 
 
-#if (MAC_INDIRECT_DATA_FFD == 1)
+#if (MAC_INDIRECT_DATA_FFD == 1) && !defined(ENABLE_QUEUE_INDEX)
 /**
  * @brief Checks whether the indirect data frame address matches
  * with the address passed.
@@ -488,6 +494,6 @@ static uint8_t find_buffer_cb(void *buf, void *buffer)
     }
     return 0;
 }
-#endif /* (MAC_INDIRECT_DATA_FFD == 1) */
+#endif /* (MAC_INDIRECT_DATA_FFD == 1) && !defined(ENABLE_QUEUE_INDEX) */
 
 /* EOF */
@@ -40,6 +40,9 @@
 #include "mac.h"
 #include "mac_config.h"
 #include "mac_build_config.h"
+#ifdef ENABLE_RTB_SPECTRUM
+#include "rtb.h"
+#endif  /* ENABLE_RTB_SPECTRUM */
 
 #if (MAC_SCAN_SUPPORT == 1)
 
@@ -342,7 +345,11 @@ static void mac_awake_scan(buffer_t *scan_buf)
     {
 #if (MAC_SCAN_ED_REQUEST_CONFIRM == 1)
         case MLME_SCAN_TYPE_ED:
-            msc->scan_result_list[0].ed_value[1] = 0; /* First channel's accumulated energy level */
+            /*
+             * The ED values fill the variable portion of the scan confirm,
+             * so they are not bound to the size of ed_value.
+             */
+            ((uint8_t *)msc->scan_result_list)[1] = 0; /* First channel's accumulated energy level */
             mac_scan_state = MAC_SCAN_ED;
             scan_proceed(MLME_SCAN_TYPE_ED, (buffer_t *)scan_buf);
             break;
@@ -1046,6 +1053,14 @@ void tal_ed_end_cb(uint8_t energy_level)
 {
     MAKE_MAC_NOT_BUSY();
 
+#ifdef ENABLE_RTB_SPECTRUM
+    /* The ED scan may have been started by the spectrum monitor of the RTB. */
+    if (rtb_spectrum_ed_end(energy_level))
+    {
+        return;
+    }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
     mlme_scan_conf_t *msc;
 
     /*
@@ -1055,11 +1070,13 @@ void tal_ed_end_cb(uint8_t energy_level)
     msc = (mlme_scan_conf_t *)BMM_BUFFER_POINTER((buffer_t *)mac_conf_buf_ptr);
 
     uint8_t n_eds;
+    /* The ED values fill the variable portion of the scan confirm. */
+    uint8_t *ed_values = (uint8_t *)msc->scan_result_list;
 
     n_eds = msc->ResultListSize;
-    msc->scan_result_list[0].ed_value[n_eds] = energy_level;
+    ed_values[n_eds] = energy_level;
     msc->ResultListSize++;
-    msc->scan_result_list[0].ed_value[n_eds + 1] = 0;
+    ed_values[n_eds + 1] = 0;
 
     msc->UnscannedChannels &= ~(1UL << scan_curr_channel);
 
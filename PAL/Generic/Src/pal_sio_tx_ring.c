@@ -0,0 +1,249 @@
+/**
+ * @file pal_sio_tx_ring.c
+ *
+ * @brief Transmit rings of the SIO units
+ *
+ * This file implements the transmit rings of the Stream I/O API for all
+ * platforms. The rings are filled by the application and passed to the
+ * SIO units through pal_sio_tx() by pal_task().
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+/* === Includes ============================================================ */
+
+#if (defined SIO_HUB) && (defined PAL_SIO_TX_RING)
+
+#include <stdint.h>
+#include <string.h>
+#include "pal.h"
+
+/* === Macros ==============================================================*/
+
+/** Size of the transmit ring of each SIO unit */
+#ifndef PAL_SIO_TX_RING_SIZE
+#define PAL_SIO_TX_RING_SIZE    (1024)
+#endif
+
+/*
+ * By default a writer finding the ring full busy waits until the UART has
+ * taken enough data, so no output is lost. This stalls the caller, e.g. the
+ * ranging procedure printing its results, for as long as the UART needs to
+ * send the excess data. With PAL_SIO_TX_RING_DROP the writer never waits;
+ * the oldest data is dropped instead and counted in the statistics.
+ */
+
+/** Largest chunk passed to the UART at once */
+#define PAL_SIO_TX_CHUNK        (0xFF)
+
+/* === Types ===============================================================*/
+
+/*
+ * Transmit ring of an SIO unit, written by the application and drained
+ * into the UART buffer by pal_task()
+ */
+typedef struct sio_tx_ring_tag
+{
+    uint8_t buf[PAL_SIO_TX_RING_SIZE];
+    uint16_t head;
+    uint16_t count;
+    pal_sio_tx_stats_t stats;
+} sio_tx_ring_t;
+
+/* === Globals =============================================================*/
+
+#ifdef UART0
+static sio_tx_ring_t uart_0_tx_ring;
+#endif
+#ifdef UART1
+static sio_tx_ring_t uart_1_tx_ring;
+#endif
+
+/* === Prototypes ==========================================================*/
+
+static sio_tx_ring_t *get_tx_ring(uint8_t sio_unit);
+static void drain_tx_ring(uint8_t sio_unit, sio_tx_ring_t *ring);
+
+/* === Implementation ======================================================*/
+
+/**
+ * @brief Transmits data through the transmit ring of the selected SIO unit
+ *
+ * The data is copied into the transmit ring and passed to the UART by
+ * pal_task(), so the caller is not held up by the UART. If the ring is
+ * full, the function waits until the UART has taken enough data, so no
+ * output is lost. With PAL_SIO_TX_RING_DROP the oldest data is dropped
+ * instead and counted in the statistics.
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param data Pointer to the data to be transmitted
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Actual number of accepted bytes
+ */
+uint8_t pal_sio_tx_ring(uint8_t sio_unit, uint8_t *data, uint8_t length)
+{
+    sio_tx_ring_t *ring = get_tx_ring(sio_unit);
+    uint8_t i;
+
+    if (NULL == ring)
+    {
+        return 0;
+    }
+
+    if ((PAL_SIO_TX_RING_SIZE - ring->count) < length)
+    {
+        /* Make room by passing data to the UART first. */
+        drain_tx_ring(sio_unit, ring);
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        if (PAL_SIO_TX_RING_SIZE == ring->count)
+        {
+#ifdef PAL_SIO_TX_RING_DROP
+            /* Drop the oldest byte. */
+            ring->head = (ring->head + 1) % PAL_SIO_TX_RING_SIZE;
+            ring->count--;
+            ring->stats.dropped++;
+#else
+            do
+            {
+                ring->stats.stalls++;
+                drain_tx_ring(sio_unit, ring);
+            }
+            while (PAL_SIO_TX_RING_SIZE == ring->count);
+#endif
+        }
+
+        ring->buf[(ring->head + ring->count) % PAL_SIO_TX_RING_SIZE] = data[i];
+        ring->count++;
+    }
+
+    if (ring->count > ring->stats.max_used)
+    {
+        ring->stats.max_used = ring->count;
+    }
+
+    return length;
+}
+
+
+
+/**
+ * @brief Passes the content of the transmit rings to the UARTs
+ *
+ * This function is called by pal_task().
+ */
+void pal_sio_tx_ring_service(void)
+{
+#ifdef UART0
+    drain_tx_ring(SIO_0, &uart_0_tx_ring);
+#endif
+#ifdef UART1
+    drain_tx_ring(SIO_1, &uart_1_tx_ring);
+#endif
+}
+
+
+
+/**
+ * @brief Gets the statistics of the transmit ring of the selected SIO unit
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] stats Statistics since the start or the last reset
+ * @param reset true to reset the statistics after reading
+ */
+void pal_sio_tx_get_stats(uint8_t sio_unit, pal_sio_tx_stats_t *stats,
+                          bool reset)
+{
+    sio_tx_ring_t *ring = get_tx_ring(sio_unit);
+
+    if (NULL == ring)
+    {
+        memset(stats, 0, sizeof(pal_sio_tx_stats_t));
+        return;
+    }
+
+    *stats = ring->stats;
+    if (reset)
+    {
+        memset(&ring->stats, 0, sizeof(pal_sio_tx_stats_t));
+        ring->stats.max_used = ring->count;
+    }
+}
+
+
+
+/**
+ * @brief Gets the transmit ring of an SIO unit
+ *
+ * @param sio_unit Specifies the SIO unit
+ *
+ * @return Transmit ring, NULL if the SIO unit is not available
+ */
+static sio_tx_ring_t *get_tx_ring(uint8_t sio_unit)
+{
+    switch (sio_unit)
+    {
+#ifdef UART0
+        case SIO_0:
+            return &uart_0_tx_ring;
+#endif
+#ifdef UART1
+        case SIO_1:
+            return &uart_1_tx_ring;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+
+
+/**
+ * @brief Copies the content of a transmit ring into the UART buffer
+ *
+ * The data is passed in contiguous chunks, as far as the UART buffer
+ * takes them.
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param ring Transmit ring of the SIO unit
+ */
+static void drain_tx_ring(uint8_t sio_unit, sio_tx_ring_t *ring)
+{
+    while (ring->count > 0)
+    {
+        uint16_t chunk = PAL_SIO_TX_RING_SIZE - ring->head;
+        uint8_t sent;
+
+        if (chunk > ring->count)
+        {
+            chunk = ring->count;
+        }
+        if (chunk > PAL_SIO_TX_CHUNK)
+        {
+            chunk = PAL_SIO_TX_CHUNK;
+        }
+
+        sent = pal_sio_tx(sio_unit, &ring->buf[ring->head], (uint8_t)chunk);
+        ring->head = (ring->head + sent) % PAL_SIO_TX_RING_SIZE;
+        ring->count -= sent;
+
+        if (sent < chunk)
+        {
+            /* The UART buffer is full. */
+            break;
+        }
+    }
+}
+#endif  /* (defined SIO_HUB) && (defined PAL_SIO_TX_RING) */
+
+/* EOF */
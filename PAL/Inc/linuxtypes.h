@@ -0,0 +1,168 @@
+/**
+ * @file linuxtypes.h
+ *
+ * @brief Compiler and platform abstraction for hosted Linux builds
+ *
+ * This header file maps the compiler specific abstractions used throughout
+ * the stack (program memory access, packed types, byte order conversion)
+ * to plain C as available for a GCC build running as Linux process.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef LINUXTYPES_H
+#define LINUXTYPES_H
+
+/* === Includes ============================================================= */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#if !defined(__GNUC__)
+#error Unsupported compiler
+#endif
+
+#if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error Only little endian hosts are supported
+#endif
+
+/* === Externals ============================================================ */
+
+
+/* === Macros =============================================================== */
+
+#ifndef _BV
+/**
+ * Bit value -- compute the bitmask for a bit position
+ */
+#define _BV(x) (1 << (x))
+#endif
+
+/*
+ * There is no interrupt controller on the host. The global interrupt flag
+ * is emulated by the PAL, see ENTER_CRITICAL_REGION() in pal_config.h.
+ */
+#define nop() do { __asm__ __volatile__ ("" ::: "memory"); } while (0)
+#define ALIGN8BIT /* Natural alignment is kept on the host */
+#define SHORTENUM __attribute__ ((packed))
+#define PACKED __attribute__((packed))
+
+/* program memory space abstraction */
+#define FLASH_EXTERN(x) extern const x
+#define FLASH_DECLARE(x) const x
+#define FUNC_PTR(x) void (*x)(void)
+#define FLASH_STRING(x) (x)
+#define FLASH_STRING_T  const char *
+#define PGM_READ_BYTE(x) *(x)
+#define PGM_READ_BYTE_FAR(x) *(x)
+#define PGM_READ_WORD(x) *(x)
+#define PGM_READ_BLOCK(dst, src, len) memcpy((dst), (src), (len))
+#define PGM_STRLEN(x) strlen(x)
+#define PGM_STRCPY(dst, src) strcpy((dst), (src))
+#define HAS_PGM_VSNPRINTF 1
+#define PGM_VSNPRINTF(dst, n, fmt, ap) vsnprintf((dst), (n), (fmt), (ap))
+#define PRINTF_FLASH_STRING "%s"
+
+#define PUTS(s) printf(s)
+#define PRINTF(fmt, ...) printf(fmt, __VA_ARGS__)
+
+#define FORCE_INLINE(type, name, ...) \
+    static inline type name(__VA_ARGS__) __attribute__((always_inline)); \
+    static inline type name(__VA_ARGS__)
+
+#define RAMFUNCTION
+
+#define CAN_INITIALIZE_FLEXIBLE_ARRAY_MEMBERS 1
+
+#define ADDR_COPY_DST_SRC_16(dst, src)  memcpy((&(dst)), (&(src)), sizeof(uint16_t))
+#define ADDR_COPY_DST_SRC_64(dst, src)  memcpy((&(dst)), (&(src)), sizeof(uint64_t))
+
+/* Converts a 2 Byte array into a 16-Bit value */
+#define convert_byte_array_to_16_bit(data) \
+    (*(uint16_t *)(data))
+
+/* Converts a 4 Byte array into a 32-Bit value */
+#define convert_byte_array_to_32_bit(data) \
+    (*(uint32_t *)(data))
+
+/* Converts a 8 Byte array into a 64-Bit value */
+#define convert_byte_array_to_64_bit(data) \
+    (*(uint64_t *)(data))
+
+/* Converts a 16-Bit value into a 2 Byte array */
+#define convert_16_bit_to_byte_array(value, data) \
+    ((*(uint16_t *)(data)) = (uint16_t)(value))
+
+/* Converts spec 16-Bit value into a 2 Byte array */
+#define convert_spec_16_bit_to_byte_array(value, data) \
+    ((*(uint16_t *)(data)) = (uint16_t)(value))
+
+/* Converts spec 16-Bit value into a 2 Byte array */
+#define convert_16_bit_to_byte_address(value, data) \
+    ((*(uint16_t *)(data)) = (uint16_t)(value))
+
+/* Converts a 32-Bit value into a 4 Byte array */
+#define convert_32_bit_to_byte_array(value, data) \
+    ((*(uint32_t *)(data)) = (uint32_t)(value))
+
+/* Converts a 64-Bit value into  a 8 Byte array */
+#define convert_64_bit_to_byte_array(value, data) \
+    memcpy((data), (&(value)), sizeof(uint64_t))
+
+/*Defines the Flash Storage for the request and response of MAC*/
+#define CMD_ID_OCTET    (0)
+
+/* Converting of values from CPU endian to little endian. */
+#define CPU_ENDIAN_TO_LE16(x)   (x)
+#define CPU_ENDIAN_TO_LE32(x)   (x)
+#define CPU_ENDIAN_TO_LE64(x)   (x)
+
+/* Converting of values from little endian to CPU endian. */
+#define LE16_TO_CPU_ENDIAN(x)   (x)
+#define LE32_TO_CPU_ENDIAN(x)   (x)
+#define LE64_TO_CPU_ENDIAN(x)   (x)
+
+/* Converting of constants from little endian to CPU endian. */
+#define CLE16_TO_CPU_ENDIAN(x)  (x)
+#define CLE32_TO_CPU_ENDIAN(x)  (x)
+#define CLE64_TO_CPU_ENDIAN(x)  (x)
+
+/* Converting of constants from CPU endian to little endian. */
+#define CCPU_ENDIAN_TO_LE16(x)  (x)
+#define CCPU_ENDIAN_TO_LE32(x)  (x)
+#define CCPU_ENDIAN_TO_LE64(x)  (x)
+
+#define MEMCPY_ENDIAN memcpy
+
+
+/* === Types ================================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * avr-libc stream binding as used by the applications,
+     * implemented on top of glibc's fopencookie() in pal_utils.c.
+     */
+    FILE *fdevopen(int (*put)(char, FILE *), int (*get)(FILE *));
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* LINUXTYPES_H */
+/* EOF */
@@ -80,6 +80,29 @@
 #define U16_TO_TARGET(x) (x)
 #endif
 
+#if defined(PAL_PS_STORE) || defined(DOXYGEN)
+/**
+ * First address of the record store within the internal EEPROM,
+ * aligned to an EEPROM page
+ */
+#ifndef PAL_PS_STORE_START
+#define PAL_PS_STORE_START              (0x0400)
+#endif
+
+/**
+ * Number of EEPROM pages of the record store; the records rotate
+ * through all pages to spread the wear of the EEPROM
+ */
+#ifndef PAL_PS_STORE_PAGES
+#define PAL_PS_STORE_PAGES              (32)
+#endif
+
+/** Maximum length of the data of a record */
+#ifndef PAL_PS_STORE_MAX_LEN
+#define PAL_PS_STORE_MAX_LEN            (128)
+#endif
+#endif  /* #if defined(PAL_PS_STORE) || defined(DOXYGEN) */
+
 /* === Types =============================================================== */
 
 /**
@@ -140,6 +163,42 @@ typedef enum source_type_tag
     TMR_CLK_SRC_DURING_TRX_AWAKE
 } SHORTENUM source_type_t;
 
+
+#if defined(PAL_TIMER_STATS) || defined(DOXYGEN)
+/**
+ * Run time statistics of the timer module
+ */
+typedef struct pal_timer_stats_tag
+{
+    /** Longest critical region of the timer module in microseconds */
+    uint32_t max_critical_us;
+    /** Longest delay of a callback after the expiry of its timer */
+    uint32_t max_lateness_us;
+    /** Sum of the delays of all callbacks in microseconds */
+    uint32_t sum_lateness_us;
+    /** Number of called callbacks */
+    uint32_t callbacks;
+    /** Highest number of simultaneously running timers */
+    uint8_t max_running;
+} pal_timer_stats_t;
+#endif  /* #if defined(PAL_TIMER_STATS) || defined(DOXYGEN) */
+
+
+#if defined(PAL_SIO_TX_RING) || defined(DOXYGEN)
+/**
+ * Statistics of the transmit ring of an SIO unit
+ */
+typedef struct pal_sio_tx_stats_tag
+{
+    /** Number of bytes dropped because the ring was full (PAL_SIO_TX_RING_DROP) */
+    uint32_t dropped;
+    /** Number of cycles spent waiting for the UART because the ring was full */
+    uint32_t stalls;
+    /** Highest number of bytes in the ring */
+    uint16_t max_used;
+} pal_sio_tx_stats_t;
+#endif  /* #if defined(PAL_SIO_TX_RING) || defined(DOXYGEN) */
+
 /**
  * @brief IDs for persistence storage access
  */
@@ -348,6 +407,22 @@ extern "C" {
     bool pal_is_timer_running(uint8_t timer_id);
 #endif
 
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_STATS)) || defined(DOXYGEN)
+    /**
+     * @brief Gets the run time statistics of the timer module
+     *
+     * The critical regions of starting, stopping and servicing timers
+     * delay all interrupts, e.g. the timestamp interrupt of the
+     * transceiver. The lateness of a callback is the time from the expiry
+     * of its timer until the callback is called by pal_task().
+     *
+     * @param[out] stats Statistics since pal_init() or the last reset
+     * @param reset true to reset the statistics after reading
+     * @ingroup apiPalApi
+     */
+    void pal_timer_get_stats(pal_timer_stats_t *stats, bool reset);
+#endif
+
     /** @cond DOXYGEN_PAL_DEBUG */
 #if (DEBUG > 0)
     bool pal_are_all_timers_stopped(void);
@@ -453,6 +528,43 @@ extern "C" {
      * @ingroup apiPalApi
      */
     uint8_t pal_sio_rx(uint8_t sio_unit, uint8_t *data, uint8_t max_length);
+
+#if defined(PAL_SIO_TX_RING) || defined(DOXYGEN)
+    /**
+     * @brief Transmits data through the transmit ring of the selected SIO unit
+     *
+     * The data is buffered and passed to the SIO unit by pal_task(). If the
+     * ring is full, the function busy waits for the SIO unit, which stalls
+     * the caller (e.g. an ongoing ranging) until the excess data is sent.
+     * With PAL_SIO_TX_RING_DROP it never waits; the oldest data is dropped.
+     *
+     * @param sio_unit Specifies the SIO unit
+     * @param data Pointer to the data to be transmitted
+     * @param length Number of bytes to be transmitted
+     *
+     * @return Actual number of accepted bytes
+     * @ingroup apiPalApi
+     */
+    uint8_t pal_sio_tx_ring(uint8_t sio_unit, uint8_t *data, uint8_t length);
+
+    /**
+     * @brief Passes the content of the transmit rings to the SIO units
+     *
+     * @ingroup apiPalApi
+     */
+    void pal_sio_tx_ring_service(void);
+
+    /**
+     * @brief Gets the statistics of the transmit ring of an SIO unit
+     *
+     * @param sio_unit Specifies the SIO unit
+     * @param[out] stats Statistics since the start or the last reset
+     * @param reset true to reset the statistics after reading
+     * @ingroup apiPalApi
+     */
+    void pal_sio_tx_get_stats(uint8_t sio_unit, pal_sio_tx_stats_t *stats,
+                              bool reset);
+#endif  /* #if defined(PAL_SIO_TX_RING) || defined(DOXYGEN) */
 #endif  /* SIO_HUB */
 
 
@@ -493,6 +605,58 @@ extern "C" {
      */
     retval_t pal_ps_set(uint16_t start_addr, uint16_t length, void *value);
 
+#if defined(PAL_PS_STORE) || defined(DOXYGEN)
+    /**
+     * @brief Loads the newest valid record of the record store
+     *
+     * Only the headers of the records are scanned for the newest record
+     * of the requested length, its CRC decides whether it is valid;
+     * otherwise the next older record is tried.
+     *
+     * @param[out] value Data of the record
+     * @param[in]  length Length of the data
+     *
+     * @return MAC_SUCCESS if a valid record was found, FAILURE otherwise
+     * @ingroup apiPalApi
+     */
+    retval_t pal_ps_store_load(void *value, uint8_t length);
+
+    /**
+     * @brief Stages a record for the record store
+     *
+     * The record is kept in RAM until pal_ps_store_commit() is called,
+     * so a sequence of updates results in a single EEPROM write.
+     * A record equal to the stored one is not staged.
+     *
+     * @param[in]  value Data of the record
+     * @param[in]  length Length of the data (1 .. PAL_PS_STORE_MAX_LEN)
+     *
+     * @return MAC_SUCCESS if the record was staged or is already stored,
+     *         FAILURE otherwise
+     * @ingroup apiPalApi
+     */
+    retval_t pal_ps_store_save(const void *value, uint8_t length);
+
+    /**
+     * @brief Checks whether a staged record waits for its commit
+     *
+     * @return true if pal_ps_store_commit() would write a record
+     * @ingroup apiPalApi
+     */
+    bool pal_ps_store_pending(void);
+
+    /**
+     * @brief Writes the staged record into the record store
+     *
+     * The record is written with the next sequence number into the slot
+     * following the newest record, each EEPROM page of the slot by one
+     * erase-and-write operation. The application calls this function while
+     * the node is idle, since the page writes block the CPU.
+     *
+     * @ingroup apiPalApi
+     */
+    void pal_ps_store_commit(void);
+#endif  /* #if defined(PAL_PS_STORE) || defined(DOXYGEN) */
 
     /**
      * @brief Alert indication
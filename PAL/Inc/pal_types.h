@@ -28,6 +28,7 @@
 #define ARM7                            (0x05)
 #define SAM3                            (0x06)
 #define SAM4                            (0x07)
+#define LINUX                           (0x08)
 
 #if (PAL_GENERIC_TYPE == AVR)
 /* PAL_TYPE for AVR 8-bit MCUs */
@@ -94,6 +95,10 @@
 #    if (PAL_TYPE == ATMEGA64RFR2)
 #        define __ATMEGA64RFR2__       (ATMEGA64RFR2)
 #    endif
+
+#elif (PAL_GENERIC_TYPE == LINUX)
+/* PAL_TYPE for hosted builds running as Linux process */
+#    define LINUX_HOST                 (0x01)
 #else
 #    error "Undefined PAL_GENERIC_TYPE"
 #endif
@@ -110,6 +115,8 @@
 #include "armtypes.h"
 #elif (PAL_GENERIC_TYPE == AVR32)
 #include "avr32types.h"
+#elif (PAL_GENERIC_TYPE == LINUX)
+#include "linuxtypes.h"
 #else
 #error "Unknown PAL_GENERIC_TYPE"
 #endif
@@ -0,0 +1,62 @@
+/**
+ * @file pal_internal.h
+ *
+ * @brief PAL internal functions prototypes for Linux hosts
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+
+/* Prevent double inclusion */
+#ifndef PAL_INTERNAL_H
+#define PAL_INTERNAL_H
+
+/* === Includes ============================================================= */
+
+#include "pal.h"
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Macros ================================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void gpio_init(void);
+    void interrupt_system_init(void);
+    void trx_interface_init(void);
+
+    /**
+     * @brief Services pending emulated interrupts
+     *
+     * Executes the transceiver interrupt handler if the transceiver has
+     * raised its IRQ line while both the transceiver interrupt and the
+     * global interrupts were enabled. This is the counterpart of the
+     * interrupt controller of an MCU and is called at every point where
+     * the firmware could have been interrupted (leaving a critical region,
+     * enabling interrupts, spinning in a delay loop).
+     */
+    void pal_irq_service(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* PAL_INTERNAL_H */
+/* EOF */
@@ -0,0 +1,151 @@
+/**
+ * @file pal_timer.h
+ *
+ * @brief PAL timer internal functions prototypes for Linux hosts
+ *
+ * This header has the timer specific stuctures, macros and
+ * internal functions for Linux hosts.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+
+/* Prevent double inclusion */
+#ifndef PAL_TIMER_H
+#define PAL_TIMER_H
+
+/* === Includes ============================================================= */
+
+
+/* === Types ================================================================ */
+
+/*
+ * This defines the structure of the time type.
+ */
+typedef struct timer_info_tag
+{
+    /* Timeout in microseconds */
+    uint32_t abs_exp_timer;
+
+    /* Callback function to be executed on expiry of the timer */
+    FUNC_PTR(timer_cb);
+
+    /* Parameter to be passed to the callback function of the expired timer */
+    void *param_cb;
+
+    /* Next timer which was started or has expired */
+    uint_fast8_t next_timer_in_queue;
+
+#ifdef PAL_TIMER_HEAP
+    /* Position in the running timer heap, NO_TIMER if not running */
+    uint_fast8_t heap_index;
+#endif
+} timer_info_t;
+
+/*
+ * Type definition for callbacks for timer functions
+ */
+typedef void (*timer_expiry_cb_t)(void *);
+
+/**
+ * Clock source of the hosted PAL
+ *
+ * By default the system time follows the monotonic clock of the host.
+ * A simulator running several nodes in one process replaces it by its
+ * virtual time, see pal_host_clock_set().
+ */
+typedef struct pal_host_clock_tag
+{
+    /** Returns the current host time in microseconds. */
+    uint64_t (*now_us)(void *ctx);
+    /**
+     * Lets the caller consume CPU time until the given host time,
+     * e.g. for blocking delays and transceiver accesses.
+     */
+    void (*wait_until)(void *ctx, uint64_t time_us);
+    /** Context passed to the functions above */
+    void *ctx;
+} pal_host_clock_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Macros ================================================================ */
+
+/*
+ * Value to indicate end of timer in the array or queue
+ */
+#define NO_TIMER                (0xFF)
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void timer_init(void);
+    void timer_init_non_generic(void);
+    void internal_timer_handler(void);
+    void timer_service(void);
+
+    /**
+     * @brief Reads the free running system time
+     *
+     * The system time is the 32-bit microsecond counter of the host's
+     * monotonic clock since timer_init(). It takes the role of the
+     * hardware timer (sys_time/TCC0) of the MCU based PALs.
+     *
+     * @return Time in microseconds
+     */
+    uint32_t pal_host_time_us(void);
+
+    /**
+     * @brief Replaces the clock source of the host
+     *
+     * This needs to be called before pal_init().
+     *
+     * @param clock Clock source, NULL selects the monotonic clock of the host
+     */
+    void pal_host_clock_set(const pal_host_clock_t *clock);
+
+    /**
+     * @brief Reads the clock source of the host
+     *
+     * @return Host time in microseconds
+     */
+    uint64_t pal_host_clock_us(void);
+
+    /**
+     * @brief Consumes CPU time on a virtual clock
+     *
+     * Models the execution time of an operation that takes no time on
+     * the host, like an SPI access. Nothing is done if the system time
+     * follows the monotonic clock.
+     *
+     * @param duration Time in microseconds
+     */
+    void pal_host_clock_spend(uint32_t duration);
+
+    /**
+     * @brief Gets the host time of the next timer expiry
+     *
+     * @param[out] time_us Host time in microseconds
+     *
+     * @return true if a timer is running or expired, false otherwise
+     */
+    bool pal_timer_next_expiry(uint64_t *time_us);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* PAL_TIMER_H */
+/* EOF */
@@ -0,0 +1,348 @@
+/**
+ * @file pal_trx_emu.h
+ *
+ * @brief Software model of the AT86RF233 transceiver for hosted Linux builds
+ *
+ * This header file declares the interface of the transceiver emulation
+ * which replaces the SPI-attached AT86RF233 on the Linux PAL.
+ * The emulation provides the register file, the frame buffer, the SRAM,
+ * the IRQ line and the SLP_TR/RST pins of the transceiver as seen by the
+ * TAL via the regular PAL transceiver access functions.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_TRX_EMU_H
+#define PAL_TRX_EMU_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** Environment variable holding the node number of this process. */
+#define TRX_EMU_ENV_NODE                "RTB_EMU_NODE"
+
+/** Environment variable holding the number of emulated nodes. */
+#define TRX_EMU_ENV_NODES               "RTB_EMU_NODES"
+
+/** Environment variable holding the base UDP port of the emulated medium. */
+#define TRX_EMU_ENV_PORT                "RTB_EMU_PORT"
+
+/** Environment variable holding the position "x,y[,z]" of this node in m. */
+#define TRX_EMU_ENV_POS                 "RTB_EMU_POS"
+
+/** Environment variable holding the PMU phase noise in LSB (peak). */
+#define TRX_EMU_ENV_PHASE_NOISE         "RTB_EMU_PHASE_NOISE"
+
+/**
+ * Environment variable holding an interferer "start,stop,dbm,duty": band in
+ * MHz, power at this node in dBm and share of time on the air in percent.
+ */
+#define TRX_EMU_ENV_INTERFERER          "RTB_EMU_INTERFERER"
+
+/** Default number of emulated nodes sharing the medium. */
+#define TRX_EMU_DEFAULT_NODES           (4)
+
+/** Default base UDP port of the emulated medium. */
+#define TRX_EMU_DEFAULT_PORT            (47233)
+
+/** Maximum number of emulated nodes sharing the medium. */
+#define TRX_EMU_MAX_NODES               (64)
+
+/** Destination node of a frame addressed to all nodes. */
+#define TRX_EMU_BROADCAST               (0xFF)
+
+/** Maximum PSDU length */
+#define TRX_EMU_MAX_PSDU_LEN            (127)
+
+/* === Types ================================================================ */
+
+/**
+ * Frame on the emulated medium
+ *
+ * This is also the datagram format of the UDP based medium.
+ */
+typedef struct trx_emu_frame_tag
+{
+    /** Marker of a valid frame */
+    uint32_t magic;
+    /** Node number of the sender */
+    uint8_t src_node;
+    /** Node number of the receiver or @ref TRX_EMU_BROADCAST */
+    uint8_t dst_node;
+    /** Frame is an acknowledgment sent by the transceiver itself */
+    uint8_t is_ack;
+    /** Transmit power in dBm */
+    int8_t tx_pwr_dbm;
+    /** Carrier frequency in units of 500 kHz */
+    uint16_t freq;
+    /** Length of the PSDU */
+    uint8_t psdu_len;
+    uint8_t reserved;
+    /** Position of the sender in m */
+    double pos[3];
+    /** Start of the frame (first symbol of SHR) at the sender in us */
+    uint64_t start_us;
+    /** PSDU including FCS */
+    uint8_t psdu[TRX_EMU_MAX_PSDU_LEN];
+} trx_emu_frame_t;
+
+/**
+ * Medium replacing the UDP based medium
+ *
+ * The medium passes each transmitted frame to the other nodes by
+ * trx_emu_deliver(). Frames may be delivered before their start time,
+ * they are received once the host time has reached the start time plus
+ * the propagation delay.
+ */
+typedef struct trx_emu_medium_tag
+{
+    /** Transmits a frame of this node */
+    void (*send)(void *ctx, const trx_emu_frame_t *frame);
+    /** Context passed to send() */
+    void *ctx;
+} trx_emu_medium_t;
+
+/**
+ * Configuration of a node replacing the environment variables
+ */
+typedef struct trx_emu_config_tag
+{
+    /** Node number */
+    uint8_t node_id;
+    /** Position in m */
+    double pos[3];
+    /** PMU phase noise in LSB (peak) */
+    uint8_t phase_noise;
+    /** Time a node waits for an ACK after the end of a frame in us */
+    uint32_t ack_timeout_us;
+    /** Time a frame is held while the receiver is not listening in us */
+    uint32_t rx_hold_us;
+    /** Probability of a frame loss in 1/1000 */
+    uint16_t frame_loss_permille;
+    /** Lowest frequency of the interferer in MHz */
+    uint16_t interferer_start_mhz;
+    /** Highest frequency of the interferer in MHz */
+    uint16_t interferer_stop_mhz;
+    /** Power of the interferer at this node in dBm */
+    int8_t interferer_dbm;
+    /** Share of time the interferer is on the air in percent, 0 for none */
+    uint8_t interferer_duty;
+    /** Seed of the random generator, must not be 0 */
+    uint32_t seed;
+} trx_emu_config_t;
+
+/**
+ * Statistics of the emulated transceiver
+ */
+typedef struct trx_emu_stats_tag
+{
+    /** Frames transmitted, including retransmissions */
+    uint32_t tx_frames;
+    /** ACKs transmitted */
+    uint32_t tx_acks;
+    /** Frames passed to the MCU */
+    uint32_t rx_frames;
+    /** Frames destroyed by an overlapping frame */
+    uint32_t rx_collisions;
+    /** Frames lost due to the configured frame loss */
+    uint32_t rx_lost;
+    /** CCAs reporting a busy channel during CSMA-CA */
+    uint32_t cca_busy;
+    /** Transactions ending with TRAC_CHANNEL_ACCESS_FAILURE */
+    uint32_t channel_access_failures;
+    /** Transactions ending with TRAC_NO_ACK */
+    uint32_t no_ack;
+    /** Transmissions started in response to a received frame */
+    uint32_t responses;
+    /**
+     * Sum of the response times, i.e. the times from the end of a received
+     * frame to the start of the next transmission, in us
+     */
+    uint64_t response_time_sum_us;
+    /** Maximum response time in us */
+    uint32_t response_time_max_us;
+} trx_emu_stats_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Initializes the transceiver emulation
+     *
+     * Reads the node configuration from the environment and attaches the
+     * node to the emulated medium. The transceiver is in state P_ON
+     * afterwards.
+     */
+    void trx_emu_init(void);
+
+    /**
+     * @brief Configures the transceiver emulation without environment
+     *
+     * This needs to be called before pal_init(). The configuration
+     * replaces the environment variables, the medium replaces the UDP
+     * based medium.
+     *
+     * @param config Node configuration
+     * @param medium Medium, NULL selects the UDP based medium
+     */
+    void trx_emu_configure(const trx_emu_config_t *config,
+                           const trx_emu_medium_t *medium);
+
+    /**
+     * @brief Passes a frame of another node to this node
+     *
+     * @param frame Frame as transmitted by the other node
+     */
+    void trx_emu_deliver(const trx_emu_frame_t *frame);
+
+    /**
+     * @brief Gets the host time of the next transceiver event
+     *
+     * Events are the end of a frame, of a backoff period, of a CCA or
+     * ED measurement, the ACK timeout, the arrival of a delivered frame
+     * and a pending IRQ.
+     *
+     * @param[out] time_us Host time in microseconds
+     *
+     * @return true if an event is pending, false otherwise
+     */
+    bool trx_emu_next_event(uint64_t *time_us);
+
+    /**
+     * @brief Gets the statistics of the emulated transceiver
+     *
+     * @param[out] stats Statistics
+     */
+    void trx_emu_get_stats(trx_emu_stats_t *stats);
+
+    /**
+     * @brief Advances the transceiver emulation
+     *
+     * Handles all pending events of the emulated medium and the
+     * transceiver state machine (frame reception, end of transmission,
+     * ACK timeout, etc.). This is called from every transceiver access
+     * and from pal_task().
+     */
+    void trx_emu_poll(void);
+
+    /**
+     * @brief Reads a transceiver register
+     *
+     * @param addr Register address
+     *
+     * @return Register value
+     */
+    uint8_t trx_emu_reg_read(uint8_t addr);
+
+    /**
+     * @brief Writes a transceiver register
+     *
+     * @param addr Register address
+     * @param data Register value
+     */
+    void trx_emu_reg_write(uint8_t addr, uint8_t data);
+
+    /**
+     * @brief Reads from the frame buffer
+     *
+     * The data are returned in the same order as via the SPI frame read
+     * access of the AT86RF233, i.e. PHR, PSDU, LQI, ED and RX_STATUS.
+     *
+     * @param data Pointer to the location to store the data
+     * @param length Number of bytes to be read
+     */
+    void trx_emu_frame_read(uint8_t *data, uint8_t length);
+
+    /**
+     * @brief Writes to the frame buffer
+     *
+     * @param data Pointer to the data starting with the PHR
+     * @param length Number of bytes to be written
+     */
+    void trx_emu_frame_write(uint8_t *data, uint8_t length);
+
+    /**
+     * @brief Reads from the transceiver SRAM
+     *
+     * @param addr Start address
+     * @param data Pointer to the location to store the data
+     * @param length Number of bytes to be read
+     */
+    void trx_emu_sram_read(uint8_t addr, uint8_t *data, uint8_t length);
+
+    /**
+     * @brief Writes to the transceiver SRAM
+     *
+     * @param addr Start address
+     * @param data Pointer to the data to be written
+     * @param length Number of bytes to be written
+     */
+    void trx_emu_sram_write(uint8_t addr, uint8_t *data, uint8_t length);
+
+    /**
+     * @brief Drives the RST pin of the transceiver
+     *
+     * @param level true for high, false for low level
+     */
+    void trx_emu_set_rst(bool level);
+
+    /**
+     * @brief Drives the SLP_TR pin of the transceiver
+     *
+     * @param level true for high, false for low level
+     */
+    void trx_emu_set_slp_tr(bool level);
+
+    /**
+     * @brief Returns the level of the IRQ pin of the transceiver
+     *
+     * @return true if the IRQ pin is high
+     */
+    bool trx_emu_get_irq(void);
+
+    /**
+     * @brief Returns and clears the rising edge latch of the IRQ pin
+     *
+     * @return true if the IRQ pin had a rising edge since the last call
+     */
+    bool trx_emu_get_irq_edge(void);
+
+    /**
+     * @brief Returns the system time of the last rising edge of the IRQ pin
+     *
+     * @return Time in microseconds (see pal_get_current_time())
+     */
+    uint32_t trx_emu_irq_timestamp(void);
+
+    /**
+     * @brief Returns the node number of this emulated transceiver
+     *
+     * @return Node number
+     */
+    uint8_t trx_emu_node_id(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* PAL_TRX_EMU_H */
+/* EOF */
@@ -0,0 +1,80 @@
+/**
+ * @file pal_uart.h
+ *
+ * @brief PAL UART internal functions prototypes for Linux hosts
+ *
+ * The UART channels of the MCU based PALs are mapped to pseudo terminals
+ * (or the process' stdin/stdout) on Linux hosts.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_UART_H
+#define PAL_UART_H
+
+/* === Includes ============================================================= */
+
+#include "app_config.h"
+#include "pal_config.h"
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Macros =============================================================== */
+
+#if ((defined UART0) || (defined UART1))
+
+/*
+ * Environment variable selecting the backend of UART 0/1:
+ * - "pty" (default): a pseudo terminal is created, its slave device
+ *   name is reported on stderr,
+ * - "stdio": stdin/stdout of the process are used.
+ */
+#define UART_0_ENV_MODE         "PAL_UART0"
+#define UART_1_ENV_MODE         "PAL_UART1"
+
+/*
+ * Environment variable naming a symbolic link that is created
+ * to the slave device of the pseudo terminal of UART 0/1.
+ */
+#define UART_0_ENV_LINK         "PAL_UART0_LINK"
+#define UART_1_ENV_LINK         "PAL_UART1_LINK"
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef UART0
+    void sio_uart_0_init(uint32_t baud_rate);
+    uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length);
+    uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length);
+#endif
+
+#ifdef UART1
+    void sio_uart_1_init(uint32_t baud_rate);
+    uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length);
+    uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length);
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* #if ((defined UART0) || (defined UART1)) */
+
+#endif  /* PAL_UART_H */
+/* EOF */
@@ -0,0 +1,637 @@
+/**
+ * @file pal.c
+ *
+ * @brief General PAL functions for hosted Linux builds
+ *
+ * This file implements generic PAL function for hosted Linux builds.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "pal.h"
+#include "pal_config.h"
+#include "pal_timer.h"
+#include "pal_internal.h"
+#include "pal_trx_emu.h"
+#include "tal_constants.h"
+#include "at86rf233.h"
+
+/* === Macros ============================================================== */
+
+/**
+ * Environment variable naming the file holding the internal EEPROM.
+ * The default file name is rtb_emu_<node>.eep in the working directory.
+ */
+#define EEPROM_FILE_ENV                 "PAL_EEPROM_FILE"
+
+/** Maximum length of the EEPROM file name. */
+#define EEPROM_FILE_NAME_LEN            (256)
+
+/**
+ * IEEE address base of the emulated boards, the node number is added.
+ */
+#define USER_SIGN_IEEE_ADDR_BASE        (0x0004250000000000ULL)
+
+#ifdef PAL_PS_STORE
+/** Length of the header of a record: sequence number and length */
+#define PS_STORE_HEADER_LEN             (3)
+
+/** Length of the CRC of a record */
+#define PS_STORE_CRC_LEN                (2)
+
+/** Slot of the record store that holds no valid record */
+#define PS_STORE_NO_SLOT                (0xFF)
+
+/** Reads one byte of the internal EEPROM */
+#define PS_STORE_READ(addr)             (eeprom_image[(addr)])
+
+#if (PAL_PS_STORE_PAGES > 32)
+#   error "The record store supports up to 32 EEPROM pages"
+#endif
+#if ((PAL_PS_STORE_START + PAL_PS_STORE_PAGES * EEPROM_PAGE_SIZE) > (E2END + 1))
+#   error "The record store exceeds the internal EEPROM"
+#endif
+#endif  /* PAL_PS_STORE */
+
+/* === Globals ============================================================= */
+
+/* Image of the internal EEPROM. */
+static uint8_t eeprom_image[E2END + 1];
+
+/* Image of the user signature row. */
+static uint8_t user_sign_image[USER_SIGNATURES_END + 1];
+
+/* Name of the file holding the internal EEPROM. */
+static char eeprom_file_name[EEPROM_FILE_NAME_LEN];
+
+#ifdef PAL_PS_STORE
+/* Sequence number of the newest record of the record store. */
+static uint16_t ps_store_seq;
+
+/* Slot of the newest record of the record store. */
+static uint8_t ps_store_slot = PS_STORE_NO_SLOT;
+
+/* Data of the stored or staged record. */
+static uint8_t ps_store_data[PAL_PS_STORE_MAX_LEN];
+
+/* Length of the stored or staged record, 0 if none is known. */
+static uint8_t ps_store_len;
+
+/* A staged record waits for pal_ps_store_commit(). */
+static bool ps_store_pending_record;
+
+/* The record store has been scanned for its newest record. */
+static bool ps_store_scanned;
+#endif  /* PAL_PS_STORE */
+
+/* === Prototypes ========================================================== */
+
+static void eeprom_init(void);
+static void eeprom_flush(uint16_t start_addr, uint16_t length);
+static void user_sign_init(void);
+#ifdef PAL_PS_STORE
+static void eeprom_write_page(uint16_t page_addr, const uint8_t *data);
+static uint8_t ps_store_slot_pages(uint8_t length);
+static bool ps_store_scan(uint8_t length, uint8_t *value);
+#endif
+
+#ifdef EXTERNAL_OSC
+void external_osc(void)
+{
+    /*
+     * The host has no clock input, but the transceiver is configured
+     * the same way as on the boards which are clocked by CLKM.
+     */
+    pal_trx_bit_write(SR_CLKM_SHA_SEL, CLKM_SHA_DISABLE);
+    pal_trx_bit_write(SR_CLKM_CTRL, CLKM_16MHZ);
+}
+#endif
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initialization of PAL
+ *
+ * This function initializes the PAL.
+ *
+ * @return MAC_SUCCESS  if PAL initialization is successful, FAILURE otherwise
+  */
+retval_t pal_init(void)
+{
+    gpio_init();
+
+    trx_interface_init();
+
+#ifdef EXTERNAL_OSC
+    external_osc();
+#endif
+    timer_init();
+    interrupt_system_init();
+
+    eeprom_init();
+    user_sign_init();
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Services timer and sio handler
+ *
+ * This function calls sio & timer handling functions.
+ */
+void pal_task(void)
+{
+    /* Let the transceiver raise its interrupts of passed events. */
+    trx_emu_poll();
+    pal_irq_service();
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    timer_service();
+#endif
+
+#if (defined SIO_HUB) && (defined PAL_SIO_TX_RING)
+    pal_sio_tx_ring_service();
+#endif
+
+    /*
+     * The main loop polls and never sleeps. Give up the CPU once per
+     * iteration, so the other emulated nodes are scheduled in time
+     * on hosts with fewer CPUs than nodes.
+     */
+    sched_yield();
+}
+
+
+
+/**
+ * @brief Loads the internal EEPROM from its file
+ *
+ * A missing or short file results in erased (0xFF) EEPROM cells.
+ */
+static void eeprom_init(void)
+{
+    const char *env = getenv(EEPROM_FILE_ENV);
+    FILE *fp;
+
+    if (NULL != env)
+    {
+        snprintf(eeprom_file_name, sizeof(eeprom_file_name), "%s", env);
+    }
+    else
+    {
+        snprintf(eeprom_file_name, sizeof(eeprom_file_name),
+                 "rtb_emu_%u.eep", (unsigned)trx_emu_node_id());
+    }
+
+    memset(eeprom_image, 0xFF, sizeof(eeprom_image));
+
+    fp = fopen(eeprom_file_name, "rb");
+    if (NULL != fp)
+    {
+        if (fread(eeprom_image, 1, sizeof(eeprom_image), fp) == 0)
+        {
+            /* Empty file, keep erased EEPROM. */
+        }
+        fclose(fp);
+    }
+}
+
+
+
+/**
+ * @brief Writes a range of the internal EEPROM back to its file
+ *
+ * @param start_addr Start address of the modified range
+ * @param length Length of the modified range
+ */
+static void eeprom_flush(uint16_t start_addr, uint16_t length)
+{
+    FILE *fp = fopen(eeprom_file_name, "r+b");
+
+    if (NULL == fp)
+    {
+        /* Create the file with the complete image. */
+        fp = fopen(eeprom_file_name, "wb");
+        if (NULL == fp)
+        {
+            return;
+        }
+        start_addr = 0;
+        length = sizeof(eeprom_image);
+    }
+
+    if (0 == fseek(fp, start_addr, SEEK_SET))
+    {
+        if (fwrite(&eeprom_image[start_addr], 1, length, fp) != length)
+        {
+            fprintf(stderr, "%s: write error\n", eeprom_file_name);
+        }
+    }
+    fclose(fp);
+}
+
+
+
+#ifdef PAL_PS_STORE
+/**
+ * @brief Writes one complete EEPROM page
+ *
+ * @param page_addr EEPROM address of the page
+ * @param data Data of the page, EEPROM_PAGE_SIZE bytes
+ */
+static void eeprom_write_page(uint16_t page_addr, const uint8_t *data)
+{
+    memcpy(&eeprom_image[page_addr], data, EEPROM_PAGE_SIZE);
+    eeprom_flush(page_addr, EEPROM_PAGE_SIZE);
+}
+#endif  /* PAL_PS_STORE */
+
+
+
+/**
+ * @brief Initializes the user signature row
+ *
+ * The user signature row carries the IEEE address at offset 2, which is
+ * unique for each emulated node.
+ */
+static void user_sign_init(void)
+{
+    uint64_t ieee_addr = USER_SIGN_IEEE_ADDR_BASE + trx_emu_node_id() + 1;
+
+    memset(user_sign_image, 0xFF, sizeof(user_sign_image));
+    convert_64_bit_to_byte_array(ieee_addr,
+                                 &user_sign_image[USER_SIGNATURES_START + 2]);
+}
+
+
+
+/**
+ * @brief Get data from persistence storage
+ *
+ * @param[in]  ps_type Persistence storage type
+ * @param[in]  start_addr Start offset within EEPROM
+ * @param[in]  length Number of bytes to read from EEPROM
+ * @param[out] value Data from persistence storage
+ *
+ * @return MAC_SUCCESS  if everything went OK else FAILURE
+ */
+retval_t pal_ps_get(ps_type_t ps_type, uint16_t start_addr, uint16_t length, void *value)
+{
+    if (ps_type == INTERN_EEPROM)
+    {
+        if ((start_addr + length) > (E2END + 1))
+        {
+            return FAILURE;
+        }
+
+        memcpy(value, &eeprom_image[start_addr], length);
+    }
+    else if (ps_type == USER_SIGNATURE)
+    {
+        if ((start_addr + length) > (USER_SIGNATURES_END + 1))
+        {
+            return FAILURE;
+        }
+
+        memcpy(value, &user_sign_image[start_addr], length);
+    }
+    else    // no external eeprom available
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+/**
+ * @brief Write data to persistence storage
+ *
+ * @param[in]  start_addr Start address offset within EEPROM
+ * @param[in]  length Number of bytes to be written to EEPROM
+ * @param[in]  value Data to persistence storage
+ *
+ * @return MAC_SUCCESS  if everything went OK else FAILURE
+ */
+retval_t pal_ps_set(uint16_t start_addr, uint16_t length, void *value)
+{
+    uint8_t *data_ptr;
+    uint16_t i;
+    bool changed = false;
+
+    if ((start_addr + length) > (E2END + 1))
+    {
+        return FAILURE;
+    }
+
+    data_ptr = (uint8_t *)(value);
+    for (i = 0; i < length; i++)
+    {
+        if (eeprom_image[start_addr + i] != data_ptr[i])
+        {
+            eeprom_image[start_addr + i] = data_ptr[i];
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        eeprom_flush(start_addr, length);
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+#ifdef PAL_PS_STORE
+/**
+ * @brief Gets the number of EEPROM pages of a slot of the record store
+ *
+ * A slot holds the header (sequence number, length), the data and the CRC.
+ */
+static uint8_t ps_store_slot_pages(uint8_t length)
+{
+    return (uint8_t)((PS_STORE_HEADER_LEN + length + PS_STORE_CRC_LEN +
+                      EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE);
+}
+
+
+
+/**
+ * @brief Finds the newest valid record of the record store
+ *
+ * @param length Length of the data of the records
+ * @param[out] value Data of the record, NULL if not needed
+ *
+ * @return true if a valid record was found
+ */
+static bool ps_store_scan(uint8_t length, uint8_t *value)
+{
+    uint8_t slot_pages = ps_store_slot_pages(length);
+    uint8_t no_of_slots = PAL_PS_STORE_PAGES / slot_pages;
+    uint32_t checked = 0;
+
+    ps_store_scanned = true;
+    ps_store_slot = PS_STORE_NO_SLOT;
+
+    while (true)
+    {
+        uint8_t best = PS_STORE_NO_SLOT;
+        uint16_t best_seq = 0;
+        uint16_t addr;
+        uint16_t crc = 0;
+        uint8_t i;
+
+        /* Find the newest unchecked record by its header only. */
+        for (uint8_t slot = 0; slot < no_of_slots; slot++)
+        {
+            uint16_t slot_addr = PAL_PS_STORE_START +
+                                 (uint16_t)slot * slot_pages * EEPROM_PAGE_SIZE;
+            uint16_t seq;
+
+            if (checked & (1UL << slot))
+            {
+                continue;
+            }
+            if (PS_STORE_READ(slot_addr + 2) != length)
+            {
+                /* Erased slot or record of another length */
+                checked |= (1UL << slot);
+                continue;
+            }
+
+            seq = PS_STORE_READ(slot_addr) |
+                  ((uint16_t)PS_STORE_READ(slot_addr + 1) << 8);
+            /* The sequence numbers wrap around, hence the difference decides. */
+            if ((PS_STORE_NO_SLOT == best) || ((int16_t)(seq - best_seq) > 0))
+            {
+                best = slot;
+                best_seq = seq;
+            }
+        }
+
+        if (PS_STORE_NO_SLOT == best)
+        {
+            return false;
+        }
+        checked |= (1UL << best);
+
+        /* Verify the CRC of the header and the data. */
+        addr = PAL_PS_STORE_START + (uint16_t)best * slot_pages * EEPROM_PAGE_SIZE;
+        for (i = 0; i < PS_STORE_HEADER_LEN; i++)
+        {
+            crc = CRC_CCITT_UPDATE(crc, PS_STORE_READ(addr++));
+        }
+        for (i = 0; i < length; i++)
+        {
+            uint8_t data = PS_STORE_READ(addr++);
+
+            crc = CRC_CCITT_UPDATE(crc, data);
+            if (NULL != value)
+            {
+                value[i] = data;
+            }
+        }
+
+        if (((uint16_t)PS_STORE_READ(addr) |
+             ((uint16_t)PS_STORE_READ(addr + 1) << 8)) == crc)
+        {
+            ps_store_slot = best;
+            ps_store_seq = best_seq;
+            return true;
+        }
+    }
+}
+
+
+
+retval_t pal_ps_store_load(void *value, uint8_t length)
+{
+    if ((0 == length) || (length > PAL_PS_STORE_MAX_LEN))
+    {
+        return FAILURE;
+    }
+
+    if (!ps_store_scan(length, (uint8_t *)value))
+    {
+        return FAILURE;
+    }
+
+    /* The loaded record is the stored one. */
+    memcpy(ps_store_data, value, length);
+    ps_store_len = length;
+    ps_store_pending_record = false;
+
+    return MAC_SUCCESS;
+}
+
+
+
+retval_t pal_ps_store_save(const void *value, uint8_t length)
+{
+    if ((0 == length) || (length > PAL_PS_STORE_MAX_LEN))
+    {
+        return FAILURE;
+    }
+
+    if (!ps_store_pending_record && (length == ps_store_len) &&
+        (0 == memcmp(ps_store_data, value, length)))
+    {
+        /* Unchanged */
+        return MAC_SUCCESS;
+    }
+
+    memcpy(ps_store_data, value, length);
+    ps_store_len = length;
+    ps_store_pending_record = true;
+
+    return MAC_SUCCESS;
+}
+
+
+
+bool pal_ps_store_pending(void)
+{
+    return ps_store_pending_record;
+}
+
+
+
+void pal_ps_store_commit(void)
+{
+    uint8_t page[EEPROM_PAGE_SIZE];
+    uint8_t slot_pages;
+    uint8_t no_of_slots;
+    uint16_t page_addr;
+    uint16_t crc = 0;
+    uint16_t pos = 0;
+    uint16_t record_len;
+
+    if (!ps_store_pending_record)
+    {
+        return;
+    }
+
+    slot_pages = ps_store_slot_pages(ps_store_len);
+    no_of_slots = PAL_PS_STORE_PAGES / slot_pages;
+    record_len = PS_STORE_HEADER_LEN + ps_store_len + PS_STORE_CRC_LEN;
+
+    if (!ps_store_scanned)
+    {
+        ps_store_scan(ps_store_len, NULL);
+    }
+
+    /* The record goes into the slot following the newest record. */
+    if (PS_STORE_NO_SLOT == ps_store_slot)
+    {
+        ps_store_slot = 0;
+        ps_store_seq = 0;
+    }
+    else
+    {
+        ps_store_slot = (ps_store_slot + 1) % no_of_slots;
+        ps_store_seq++;
+    }
+
+    page_addr = PAL_PS_STORE_START +
+                (uint16_t)ps_store_slot * slot_pages * EEPROM_PAGE_SIZE;
+
+    for (uint8_t p = 0; p < slot_pages; p++)
+    {
+        for (uint8_t i = 0; i < EEPROM_PAGE_SIZE; i++, pos++)
+        {
+            uint8_t data;
+
+            if (pos == 0)
+            {
+                data = (uint8_t)ps_store_seq;
+            }
+            else if (pos == 1)
+            {
+                data = (uint8_t)(ps_store_seq >> 8);
+            }
+            else if (pos == 2)
+            {
+                data = ps_store_len;
+            }
+            else if (pos < (record_len - PS_STORE_CRC_LEN))
+            {
+                data = ps_store_data[pos - PS_STORE_HEADER_LEN];
+            }
+            else if (pos == (record_len - PS_STORE_CRC_LEN))
+            {
+                data = (uint8_t)crc;
+            }
+            else if (pos == (record_len - 1))
+            {
+                data = (uint8_t)(crc >> 8);
+            }
+            else
+            {
+                /* Remainder of the last page */
+                data = 0xFF;
+            }
+
+            if (pos < (record_len - PS_STORE_CRC_LEN))
+            {
+                crc = CRC_CCITT_UPDATE(crc, data);
+            }
+            page[i] = data;
+        }
+
+        eeprom_write_page(page_addr, page);
+        page_addr += EEPROM_PAGE_SIZE;
+    }
+
+    ps_store_pending_record = false;
+}
+#endif  /* PAL_PS_STORE */
+
+
+/*
+ * @brief Alert indication
+ *
+ * This Function can be used by any application to indicate an error condition.
+ * The function is blocking and does never return.
+ */
+void pal_alert(void)
+{
+#if (DEBUG > 0)
+    bool debug_flag = false;
+#endif
+    ALERT_INIT();
+
+    while (1)
+    {
+        pal_timer_delay(0xFFFF);
+        ALERT_INDICATE();
+
+#if (DEBUG > 0)
+        /* Used for debugging purposes only */
+        if (debug_flag == true)
+        {
+            break;
+        }
+#endif
+    }
+}
+
+
+/* EOF */
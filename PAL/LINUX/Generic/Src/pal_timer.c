@@ -0,0 +1,1216 @@
+/**
+ * @file pal_timer.c
+ *
+ * @brief Timer related functions for hosted Linux builds
+ *
+ * This file implements timer related functions for hosted Linux builds.
+ * The system time is derived from the monotonic clock of the host; the
+ * output compare match of the MCU based PALs is replaced by a check of the
+ * head of the running timer queue whenever the timer module is serviced.
+ *
+ * By default the running timers are kept in a list sorted by expiry time,
+ * so starting a timer walks the list with interrupts disabled. With
+ * PAL_TIMER_HEAP they are kept in a binary heap instead, which starts and
+ * stops a timer in O(log n). With PAL_TIMER_STATS the longest critical
+ * region and the lateness of the callbacks are recorded, see
+ * pal_timer_get_stats().
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pal.h"
+#include "return_val.h"
+#include "pal_timer.h"
+#include "app_config.h"
+#include "pal_trx_emu.h"
+
+/* === Macros =============================================================== */
+
+#ifdef PAL_TIMER_STATS
+/* Critical region of the timer module, its duration is recorded. */
+#define TIMER_ENTER_CRITICAL_REGION()   ENTER_CRITICAL_REGION(); \
+                                        uint32_t critical_start = gettime()
+#define TIMER_LEAVE_CRITICAL_REGION()   timer_stats_critical(critical_start); \
+                                        LEAVE_CRITICAL_REGION()
+#else
+#define TIMER_ENTER_CRITICAL_REGION()   ENTER_CRITICAL_REGION()
+#define TIMER_LEAVE_CRITICAL_REGION()   LEAVE_CRITICAL_REGION()
+#endif
+
+/* === Globals ============================================================== */
+
+/*
+ * Check the number of required timers or change the number of timers that are
+ * provided by the PAL. This is a kind of error handling to reduce the
+ * number of used timer and therefore the RAM usage.
+ */
+#if (TOTAL_NUMBER_OF_TIMERS > MAX_NO_OF_TIMERS)
+#error "Number of used timers is greater than the number of timer provided by PAL."
+#endif
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+
+/*
+ * This is the timer array.
+ *
+ * TOTAL_NUMBER_OF_TIMERS is calculated in file app_config.h within the Inc
+ * directory of each application depending on the number of timers required
+ * by the stack and the application.
+ */
+timer_info_t timer_array[TOTAL_NUMBER_OF_TIMERS];
+
+/* This is the counter of all running timers. */
+static uint8_t running_timers;
+
+/* This flag indicates an expired timer. */
+static volatile bool timer_trigger;
+
+/* This is the reference to the head of the running timer queue. */
+static uint_fast8_t running_timer_queue_head;
+
+/* This is the reference to the head of the expired timer queue. */
+static uint_fast8_t expired_timer_queue_head;
+
+/* This is the reference to the tail of the expired timer queue. */
+static uint_fast8_t expired_timer_queue_tail;
+
+#ifdef PAL_TIMER_HEAP
+/*
+ * The running timers as binary min-heap ordered by their expiry time.
+ * The root is also referenced by running_timer_queue_head, the number of
+ * entries is running_timers.
+ */
+static uint8_t running_timer_heap[TOTAL_NUMBER_OF_TIMERS];
+#endif
+
+#ifdef PAL_TIMER_STATS
+/* Run time statistics of the timer module */
+static pal_timer_stats_t timer_stats;
+#endif
+
+#endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
+
+/* Host time in microseconds corresponding to system time 0. */
+static uint64_t host_time_base;
+
+/* Clock source replacing the monotonic clock, NULL if none */
+static const pal_host_clock_t *host_clock;
+
+/* === Prototypes =========================================================== */
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+static void prog_ocr(void);
+static void start_absolute_timer(uint8_t timer_id,
+                                 uint32_t point_in_time,
+                                 FUNC_PTR(handler_cb),
+                                 void *parameter);
+#ifdef PAL_TIMER_HEAP
+static void heap_sift_up(uint_fast8_t index);
+static void heap_sift_down(uint_fast8_t index);
+static void heap_insert(uint8_t timer_id);
+static void heap_remove(uint_fast8_t index);
+#endif
+#ifdef PAL_TIMER_STATS
+static void timer_stats_critical(uint32_t start);
+#endif
+#endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
+static inline uint32_t gettime(void);
+static uint64_t host_clock_us(void);
+
+/* === Implementation ======================================================= */
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Compares two 32-bit time values
+ *
+ * This function compares two true 32-bit time values t1 and t2
+ * and returns true if t1 is less than t2.
+ *
+ * @param t1 Time
+ * @param t2 Time
+ *
+ * @return true If t1 is less than t2 when MSBs are same, false otherwise.
+ * @ingroup apiPalApi
+ */
+static inline bool compare_time(uint32_t t1, uint32_t t2)
+{
+    return ((t2 - t1) < INT32_MAX);
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Timer handling services
+ *
+ * This Function performs timer handling services.
+ * It calls functions which are responsible
+ * 1) to put the expired timer into the expired timer queue, and
+ * 2) to service expired timers and call the respective callback.
+ */
+void timer_service(void)
+{
+    TIMER_ENTER_CRITICAL_REGION();
+    /* Emulation of the output compare match interrupt */
+    prog_ocr();
+    internal_timer_handler();
+    TIMER_LEAVE_CRITICAL_REGION();
+
+    /*
+     * Process expired timers.
+     * Call the callback functions of the expired timers in the order of their
+     * expiry.
+     */
+    {
+        timer_expiry_cb_t callback;
+        void *callback_param;
+        uint8_t next_expired_timer;
+#ifdef PAL_TIMER_STATS
+        uint32_t expiry;
+#endif
+
+        /* Expired timer if any will be processed here */
+        while (NO_TIMER != expired_timer_queue_head)
+        {
+            TIMER_ENTER_CRITICAL_REGION();
+
+            next_expired_timer = timer_array[expired_timer_queue_head].next_timer_in_queue;
+
+            /* Callback is stored */
+            callback = (timer_expiry_cb_t)timer_array[expired_timer_queue_head].timer_cb;
+
+            /* Callback parameter is stored */
+            callback_param = timer_array[expired_timer_queue_head].param_cb;
+
+#ifdef PAL_TIMER_STATS
+            expiry = timer_array[expired_timer_queue_head].abs_exp_timer;
+#endif
+
+            /*
+             * The expired timer's structure elements are updated and the timer
+             * is taken out of expired timer queue
+             */
+            timer_array[expired_timer_queue_head].next_timer_in_queue = NO_TIMER;
+            timer_array[expired_timer_queue_head].timer_cb = NULL;
+            timer_array[expired_timer_queue_head].param_cb = NULL;
+
+            /*
+             * The expired timer queue head is updated with the next timer in the
+             * expired timer queue.
+             */
+            expired_timer_queue_head = next_expired_timer;
+
+            if (NO_TIMER == expired_timer_queue_head)
+            {
+                expired_timer_queue_tail = NO_TIMER;
+            }
+
+            TIMER_LEAVE_CRITICAL_REGION();
+
+            if (NULL != callback)
+            {
+#ifdef PAL_TIMER_STATS
+                uint32_t now = gettime();
+                uint32_t lateness = 0;
+
+                if (compare_time(expiry, now))
+                {
+                    lateness = SUB_TIME(now, expiry);
+                }
+                if (lateness > timer_stats.max_lateness_us)
+                {
+                    timer_stats.max_lateness_us = lateness;
+                }
+                timer_stats.sum_lateness_us += lateness;
+                timer_stats.callbacks++;
+#endif
+                /* Callback function is called */
+                callback(callback_param);
+            }
+        }
+    }
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Starts regular timer
+ *
+ * This function starts a regular timer and registers the corresponding
+ * callback function to handle the timeout event.
+ *
+ * @param timer_id Timer identifier
+ * @param timer_count Timeout in microseconds
+ * @param timeout_type @ref TIMEOUT_RELATIVE / @ref TIMEOUT_ABSOLUTE
+ * @param timer_cb Callback handler invoked upon timer expiry
+ * @param param_cb Argument for the callback handler
+ *
+ * @return
+ * - @ref PAL_TMR_INVALID_ID  if the timer identifier is undefined,
+ * - @ref MAC_INVALID_PARAMETER if the callback function for this timer is NULL or
+ *   timeout_type is invalid,
+ * - @ref PAL_TMR_ALREADY_RUNNING if the timer is already running,
+ * - @ref MAC_SUCCESS if timer is started, or
+ * - @ref PAL_TMR_INVALID_TIMEOUT if timeout is not within the timeout range.
+ */
+retval_t pal_timer_start(uint8_t timer_id,
+                         uint32_t timer_count,
+                         timeout_type_t timeout_type,
+                         FUNC_PTR(timer_cb),
+                         void *param_cb)
+{
+    uint32_t now;
+    uint32_t point_in_time;
+
+    if (timer_id >= TOTAL_NUMBER_OF_TIMERS)
+    {
+        return PAL_TMR_INVALID_ID;
+    }
+
+    if (NULL == timer_cb)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    if (NULL != timer_array[timer_id].timer_cb)
+    {
+        /*
+         * Timer is already running if the callback function of the
+         * corresponding timer index in the timer array is not NULL.
+         */
+        return PAL_TMR_ALREADY_RUNNING;
+    }
+
+    now = gettime();
+
+    switch (timeout_type)
+    {
+        case TIMEOUT_RELATIVE:
+            {
+                if ((timer_count > MAX_TIMEOUT) || (timer_count < MIN_TIMEOUT))
+                {
+                    return PAL_TMR_INVALID_TIMEOUT;
+                }
+
+                point_in_time = ADD_TIME(timer_count, now);
+            }
+            break;
+
+        case TIMEOUT_ABSOLUTE:
+            {
+                uint32_t timeout;
+
+                timeout = SUB_TIME(timer_count, now);
+
+                if ((timeout > MAX_TIMEOUT) || (timeout < MIN_TIMEOUT))
+                {
+                    return PAL_TMR_INVALID_TIMEOUT;
+                }
+                point_in_time = timer_count;
+            }
+            break;
+
+        default:
+            return MAC_INVALID_PARAMETER;
+    }
+
+    start_absolute_timer(timer_id, point_in_time, timer_cb, param_cb);
+    return MAC_SUCCESS;
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Stops a running timer
+ *
+ * This function stops a running timer with the specified timer_id.
+ *
+ * @param timer_id Timer identifier
+ *
+ * @return
+ * - @ref MAC_SUCCESS if the timer was stopped successfully,
+ * - @ref PAL_TMR_NOT_RUNNING if the specified timer is not running,
+ * - @ref PAL_TMR_INVALID_ID if the specified timer id is undefined.
+ */
+retval_t pal_timer_stop(uint8_t timer_id)
+{
+    bool timer_stop_request_status = false;
+    uint8_t curr_index;
+    uint8_t prev_index;
+
+
+    if (timer_id >= TOTAL_NUMBER_OF_TIMERS)
+    {
+        return (PAL_TMR_INVALID_ID);
+    }
+
+    TIMER_ENTER_CRITICAL_REGION();
+
+    /* Check if any timer has expired. */
+    internal_timer_handler();
+
+#ifdef PAL_TIMER_HEAP
+    /* A running timer is removed from the heap directly. */
+    if (NO_TIMER != timer_array[timer_id].heap_index)
+    {
+        timer_stop_request_status = true;
+        heap_remove(timer_array[timer_id].heap_index);
+        if (timer_id == running_timer_queue_head)
+        {
+            /* The timer was the root, so OCR needs to be reloaded. */
+            running_timer_queue_head = (running_timers > 0) ?
+                                       running_timer_heap[0] : NO_TIMER;
+            prog_ocr();
+        }
+        timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+    }
+#else
+    /* The requested timer is first searched in the running timer queue */
+    if (running_timers > 0)
+    {
+        uint8_t timer_count = running_timers;
+        prev_index = curr_index = running_timer_queue_head;
+        while (timer_count > 0)
+        {
+            if (timer_id == curr_index)
+            {
+                timer_stop_request_status = true;
+
+                if (timer_id == running_timer_queue_head)
+                {
+                    running_timer_queue_head =
+                        timer_array[timer_id].next_timer_in_queue;
+                    /*
+                     * The value in OCR corresponds to the timeout pointed
+                     * by the 'running_timer_queue_head'. As the head has
+                     * changed here, OCR needs to be loaded by the new
+                     * timeout value, if any.
+                     */
+                    prog_ocr();
+                }
+                else
+                {
+                    timer_array[prev_index].next_timer_in_queue =
+                        timer_array[timer_id].next_timer_in_queue;
+                }
+                /*
+                 * The next timer element of the stopped timer is updated
+                 * to its default value.
+                 */
+                timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+                break;
+            }
+            else
+            {
+                prev_index = curr_index;
+                curr_index = timer_array[curr_index].next_timer_in_queue;
+            }
+            timer_count--;
+        }
+        if (timer_stop_request_status)
+        {
+            running_timers--;
+        }
+    }
+#endif  /* PAL_TIMER_HEAP */
+
+    /*
+     * The requested timer is not present in the running timer queue.
+     * It will be now searched in the expired timer queue
+     */
+    if (!timer_stop_request_status)
+    {
+        prev_index = curr_index = expired_timer_queue_head;
+        while (NO_TIMER != curr_index)
+        {
+            if (timer_id == curr_index)
+            {
+                if (timer_id == expired_timer_queue_head)
+                {
+                    /*
+                     * The requested timer is the head of the expired timer
+                     * queue
+                     */
+                    if (expired_timer_queue_head == expired_timer_queue_tail)
+                    {
+                        /* Only one timer in expired timer queue */
+                        expired_timer_queue_head = expired_timer_queue_tail =
+                                                       NO_TIMER;
+                    }
+                    else
+                    {
+                        /*
+                         * The head of the expired timer queue is moved to next
+                         * timer in the expired timer queue.
+                         */
+                        expired_timer_queue_head =
+                            timer_array[expired_timer_queue_head].next_timer_in_queue;
+                    }
+                }
+                else
+                {
+                    /*
+                     * The requested timer is present in the middle or at the
+                     * end of the expired timer queue.
+                     */
+                    timer_array[prev_index].next_timer_in_queue =
+                        timer_array[timer_id].next_timer_in_queue;
+
+                    /*
+                     * If the stopped timer is the one which is at the tail of
+                     * the expired timer queue, then the tail is updated.
+                     */
+                    if (timer_id == expired_timer_queue_tail)
+                    {
+                        expired_timer_queue_tail = prev_index;
+                    }
+                }
+                timer_stop_request_status = true;
+                break;
+            }
+            else
+            {
+                prev_index = curr_index;
+                curr_index = timer_array[curr_index].next_timer_in_queue;
+            }
+        }
+    }
+
+    if (timer_stop_request_status)
+    {
+        /*
+         * The requested timer is stopped, hence the structure elements of the
+         * timer are updated.
+         */
+        timer_array[timer_id].timer_cb = NULL;
+    }
+
+    TIMER_LEAVE_CRITICAL_REGION();
+
+    if (timer_stop_request_status)
+    {
+        return (MAC_SUCCESS);
+    }
+
+    return (PAL_TMR_NOT_RUNNING);
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+/*
+ * This function is called to initialize the timer module.
+ */
+void timer_init(void)
+{
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    /*
+     * Initialize the timer resources like timer arrays
+     * queues, timer registers
+     */
+    uint8_t index;
+
+    running_timers = 0;
+    timer_trigger = false;
+
+    running_timer_queue_head = NO_TIMER;
+    expired_timer_queue_head = NO_TIMER;
+    expired_timer_queue_tail = NO_TIMER;
+
+    for (index = 0; index < TOTAL_NUMBER_OF_TIMERS; index++)
+    {
+        timer_array[index].next_timer_in_queue = NO_TIMER;
+        timer_array[index].timer_cb = NULL;
+#ifdef PAL_TIMER_HEAP
+        timer_array[index].heap_index = NO_TIMER;
+#endif
+    }
+
+#ifdef PAL_TIMER_STATS
+    timer_stats = (pal_timer_stats_t){ 0 };
+#endif
+#endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
+
+    host_time_base = host_clock_us();
+
+    /* Do non-generic/PAL specific actions here. */
+    timer_init_non_generic();
+}
+
+
+
+/**
+ * @brief Selects timer clock source
+ *
+ * This function selects the clock source of the timer.
+ *
+ * @param source
+ * - @ref TMR_CLK_SRC_DURING_TRX_SLEEP if clock source during sleep is to be selected, and
+ * - @ref TMR_CLK_SRC_DURING_TRX_AWAKE if clock source while being awake is selected.
+ */
+void pal_timer_source_select(source_type_t source)
+{
+    if (TMR_CLK_SRC_DURING_TRX_SLEEP == source)
+    {
+        TIMER_SRC_DURING_TRX_SLEEP();
+    }
+    else
+    {
+        TIMER_SRC_DURING_TRX_AWAKE();
+    }
+}
+
+
+
+/**
+ * @brief Gets current time
+ *
+ * This function returns the current time.
+ *
+ * @param[out] current_time Current system time
+ */
+void pal_get_current_time(uint32_t *current_time)
+{
+    *current_time = gettime();
+}
+
+
+
+/**
+ * @brief Performes blocking delay
+ *
+ * This functions performs a blocking delay of the specified time.
+ *
+ * @param delay in microseconds
+ */
+void  pal_timer_delay(uint16_t delay)
+{
+    /*
+     * Any interrupt occurring during the delay calculation will introduce
+     * additional delay and can also affect the logic of delay calculation.
+     * Hence the delay implementation is put under critical region.
+     */
+
+    ENTER_CRITICAL_REGION();
+
+    if (delay > MIN_DELAY_VAL)
+    {
+        uint32_t target_time = gettime() + delay;
+
+        if ((NULL != host_clock) && (NULL != host_clock->wait_until))
+        {
+            host_clock->wait_until(host_clock->ctx, host_clock_us() + delay);
+        }
+
+        /* Wait until the target time has been reached. */
+        while (compare_time(gettime() + 1, target_time))
+        {
+            /* The transceiver keeps on running meanwhile. */
+            trx_emu_poll();
+        }
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Checks if the timer with the requested timer identifier is running
+ *
+ * @param timer_id Timer identifier
+ *
+ * @return
+ * - true if timer with requested timer id is running,
+ * - false otherwise.
+ */
+bool pal_is_timer_running(uint8_t timer_id)
+{
+    if (NULL == timer_array[timer_id].timer_cb)
+    {
+        return false;
+    }
+    return true;
+}
+#endif  /* TOTAL_NUMBER_OF_TIMERS > 0 */
+
+
+
+#if (DEBUG > 0)
+/**
+ * @brief Checks if all timers are stopped
+ *
+ * This function checks whether all timers are stopped or not.
+ *
+ * @return
+ * - true if all timers are stopped,
+ * - false otherwise.
+ */
+bool pal_are_all_timers_stopped(void)
+{
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    uint8_t timer_id;
+
+    for (timer_id = 0; timer_id < TOTAL_NUMBER_OF_TIMERS; timer_id++)
+    {
+        if (NULL != timer_array[timer_id].timer_cb)
+        {
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+#endif  /* (DEBUG > 0) */
+
+
+
+/**
+ * @brief Gets actual system time
+ *
+ * This function is called to get the system time
+ *
+ * @return Time in microseconds
+ */
+static inline uint32_t gettime(void)
+{
+    return pal_host_time_us();
+}
+
+
+
+/**
+ * @brief Reads the free running system time
+ *
+ * @return Time in microseconds
+ */
+uint32_t pal_host_time_us(void)
+{
+    return (uint32_t)(host_clock_us() - host_time_base);
+}
+
+
+
+/**
+ * @brief Replaces the clock source of the host
+ *
+ * @param clock Clock source, NULL selects the monotonic clock of the host
+ */
+void pal_host_clock_set(const pal_host_clock_t *clock)
+{
+    host_clock = clock;
+}
+
+
+
+/**
+ * @brief Reads the clock source of the host
+ *
+ * @return Host time in microseconds
+ */
+uint64_t pal_host_clock_us(void)
+{
+    return host_clock_us();
+}
+
+
+
+/**
+ * @brief Consumes CPU time on a virtual clock
+ *
+ * @param duration Time in microseconds
+ */
+void pal_host_clock_spend(uint32_t duration)
+{
+    if ((NULL != host_clock) && (NULL != host_clock->wait_until))
+    {
+        host_clock->wait_until(host_clock->ctx, host_clock_us() + duration);
+    }
+}
+
+
+
+/**
+ * @brief Gets the host time of the next timer expiry
+ *
+ * @param[out] time_us Host time in microseconds
+ *
+ * @return true if a timer is running or expired, false otherwise
+ */
+bool pal_timer_next_expiry(uint64_t *time_us)
+{
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    bool running = false;
+
+    ENTER_CRITICAL_REGION();
+
+    if ((NO_TIMER != expired_timer_queue_head) || timer_trigger)
+    {
+        *time_us = host_clock_us();
+        running = true;
+    }
+    else if (NO_TIMER != running_timer_queue_head)
+    {
+        uint32_t current_time = gettime();
+        uint32_t expiry = timer_array[running_timer_queue_head].abs_exp_timer;
+
+        *time_us = host_clock_us();
+        if (compare_time(current_time, expiry))
+        {
+            *time_us += (uint32_t)(expiry - current_time);
+        }
+        running = true;
+    }
+
+    LEAVE_CRITICAL_REGION();
+
+    return running;
+#else
+    time_us = time_us;
+
+    return false;
+#endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
+}
+
+
+
+/**
+ * @brief Reads the clock source of the host
+ *
+ * The monotonic clock of the host is used unless a clock source has been
+ * installed by pal_host_clock_set().
+ *
+ * @return Time in microseconds
+ */
+static uint64_t host_clock_us(void)
+{
+    struct timespec ts;
+
+    if (NULL != host_clock)
+    {
+        return host_clock->now_us(host_clock->ctx);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Programs the emulated output compare match
+ *
+ * This function checks the timeout value of the timer present at the head
+ * of the running timer queue against the current system time and triggers
+ * the timer module if it has expired.
+ */
+static void prog_ocr(void)
+{
+    ENTER_CRITICAL_REGION();
+
+    if (NO_TIMER != running_timer_queue_head)
+    {
+        uint32_t current_time = gettime();
+
+        /* Trigger timer, if next_trigger is in the past. */
+        if (compare_time(timer_array[running_timer_queue_head].abs_exp_timer, current_time + 1))
+        {
+            timer_trigger = true;
+        }
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Internal timer handler
+ *
+ * This function checks for expired timers and rearranges the
+ * running timer queue head and expired timer queue head and tail
+ * if there are any expired timers.
+ */
+void internal_timer_handler(void)
+{
+    /*
+     * Flag was set once a timer has expired by the timer ISR or
+     * by function prog_rc().
+     */
+    if (timer_trigger)
+    {
+        timer_trigger = false;
+
+        if (running_timers > 0) /* Holds the number of running timers */
+        {
+            if ((expired_timer_queue_head == NO_TIMER) &&
+                (expired_timer_queue_tail == NO_TIMER))
+            {
+                expired_timer_queue_head = expired_timer_queue_tail =
+                                               running_timer_queue_head;
+            }
+            else
+            {
+                timer_array[expired_timer_queue_tail].next_timer_in_queue =
+                    running_timer_queue_head;
+
+                expired_timer_queue_tail = running_timer_queue_head;
+            }
+
+#ifdef PAL_TIMER_HEAP
+            heap_remove(0);
+            running_timer_queue_head = (running_timers > 0) ?
+                                       running_timer_heap[0] : NO_TIMER;
+#else
+            running_timer_queue_head =
+                timer_array[running_timer_queue_head].next_timer_in_queue;
+
+            running_timers--;
+#endif
+
+            timer_array[expired_timer_queue_tail].next_timer_in_queue =
+                NO_TIMER;
+
+            /*
+             * As a timer has expired, the OCR1A is programmed (if possible)
+             * with the new timeout value of the timer pointed by running
+             * timer queue head
+             */
+            prog_ocr();
+        }
+    }
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN))
+/**
+ * @brief Start a timer by setting its absolute expiration time
+ *
+ * This function starts a timer which should expire at the
+ * point_in_time value and upon timer expiry the function
+ * held by the handler is called.
+ *
+ * @param timer_id Timer identifier
+ * @param point_in_time Absolute expiration time in microseconds
+ * @param handler_cb Function called upon timer expiry
+ * @param parameter Parameter passed to the expired timer handler
+ */
+static void start_absolute_timer(uint8_t timer_id,
+                                 uint32_t point_in_time,
+                                 FUNC_PTR(handler_cb),
+                                 void *parameter)
+{
+    TIMER_ENTER_CRITICAL_REGION();
+
+    /* Check is done to see if any timer has expired */
+    internal_timer_handler();
+
+    bool load_ocr = false;
+
+#ifdef PAL_TIMER_HEAP
+    timer_array[timer_id].abs_exp_timer = point_in_time;
+    timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+    heap_insert(timer_id);
+    if (timer_id == running_timer_heap[0])
+    {
+        /* The timer expires first, hence load the OCR. */
+        running_timer_queue_head = timer_id;
+        load_ocr = true;
+    }
+#else
+    if (NO_TIMER == running_timer_queue_head)
+    {
+        running_timer_queue_head = timer_id;
+        timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+        /*
+         * This is the only timer running in the timer queue, hence load the
+         * OCR.
+         */
+        load_ocr = true;
+    }
+    else
+    {
+        uint8_t i;
+        bool timer_inserted = false;
+        uint8_t curr_index = running_timer_queue_head;
+        uint8_t prev_index = running_timer_queue_head;
+
+        for (i = 0; i < running_timers; i++)
+        {
+            if (NO_TIMER != curr_index)
+            {
+                if (compare_time(timer_array[curr_index].abs_exp_timer,
+                                 point_in_time))
+                {
+                    /*
+                     * Requested absolute time value is greater than the time
+                     * value pointed by the curr_index in the timer array
+                     */
+                    prev_index = curr_index;
+                    curr_index = timer_array[curr_index].next_timer_in_queue;
+                }
+                else
+                {
+                    timer_array[timer_id].next_timer_in_queue = curr_index;
+                    if (running_timer_queue_head == curr_index)
+                    {
+                        /* Insertion at the head of the timer queue. */
+                        running_timer_queue_head = timer_id;
+                        /*
+                         * Timer is inserted at the head of the queue, hence
+                         * load the OCR.
+                         */
+                        load_ocr = true;
+                    }
+                    else
+                    {
+                        timer_array[prev_index].next_timer_in_queue = timer_id;
+                    }
+                    timer_inserted = true;
+                    break;
+                }
+            }
+        }
+        if (!timer_inserted)
+        {
+            /* Insertion at the tail of the timer queue. */
+            timer_array[prev_index].next_timer_in_queue = timer_id;
+            timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+        }
+    }
+    timer_array[timer_id].abs_exp_timer = point_in_time;
+    running_timers++;
+#endif  /* PAL_TIMER_HEAP */
+    timer_array[timer_id].timer_cb = (FUNC_PTR())handler_cb;
+    timer_array[timer_id].param_cb = parameter;
+
+#ifdef PAL_TIMER_STATS
+    if (running_timers > timer_stats.max_running)
+    {
+        timer_stats.max_running = running_timers;
+    }
+#endif
+
+    /*
+     * If there is only one timer in the timer queue
+     * the timeout should be loaded immediately
+     */
+    if (load_ocr)
+    {
+        prog_ocr();
+    }
+
+    TIMER_LEAVE_CRITICAL_REGION();
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_HEAP)) || defined(DOXYGEN)
+/**
+ * @brief Checks whether a timer expires strictly before another one
+ *
+ * Timers with the same expiry time keep the order of the running timer
+ * queue, i.e. are not swapped in the heap.
+ *
+ * @param t1 Expiry time of the first timer
+ * @param t2 Expiry time of the second timer
+ *
+ * @return true if t1 is before t2, false otherwise
+ */
+static inline bool heap_before(uint32_t t1, uint32_t t2)
+{
+    return ((t1 != t2) && compare_time(t1, t2));
+}
+
+
+
+/**
+ * @brief Moves a heap entry towards the root
+ *
+ * @param index Position of the entry in the heap
+ */
+static void heap_sift_up(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+    uint32_t expiry = timer_array[timer_id].abs_exp_timer;
+
+    while (index > 0)
+    {
+        uint_fast8_t parent = (index - 1) >> 1;
+        uint8_t parent_id = running_timer_heap[parent];
+
+        if (!heap_before(expiry, timer_array[parent_id].abs_exp_timer))
+        {
+            break;
+        }
+
+        running_timer_heap[index] = parent_id;
+        timer_array[parent_id].heap_index = index;
+        index = parent;
+    }
+
+    running_timer_heap[index] = timer_id;
+    timer_array[timer_id].heap_index = index;
+}
+
+
+
+/**
+ * @brief Moves a heap entry away from the root
+ *
+ * @param index Position of the entry in the heap
+ */
+static void heap_sift_down(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+    uint32_t expiry = timer_array[timer_id].abs_exp_timer;
+
+    for (;;)
+    {
+        /* 16 bit, since the child of entry 127 exceeds 8 bit */
+        uint16_t child = 2 * (uint16_t)index + 1;
+        uint8_t child_id;
+
+        if (child >= running_timers)
+        {
+            break;
+        }
+
+        child_id = running_timer_heap[child];
+        if ((child + 1 < running_timers) &&
+            heap_before(timer_array[running_timer_heap[child + 1]].abs_exp_timer,
+                        timer_array[child_id].abs_exp_timer))
+        {
+            child++;
+            child_id = running_timer_heap[child];
+        }
+
+        if (!heap_before(timer_array[child_id].abs_exp_timer, expiry))
+        {
+            break;
+        }
+
+        running_timer_heap[index] = child_id;
+        timer_array[child_id].heap_index = index;
+        index = (uint_fast8_t)child;
+    }
+
+    running_timer_heap[index] = timer_id;
+    timer_array[timer_id].heap_index = index;
+}
+
+
+
+/**
+ * @brief Inserts a timer into the running timer heap
+ *
+ * The expiry time of the timer needs to be set before.
+ *
+ * @param timer_id Timer identifier
+ */
+static void heap_insert(uint8_t timer_id)
+{
+    running_timer_heap[running_timers] = timer_id;
+    running_timers++;
+    heap_sift_up(running_timers - 1);
+}
+
+
+
+/**
+ * @brief Removes a timer from the running timer heap
+ *
+ * The caller updates running_timer_queue_head.
+ *
+ * @param index Position of the timer in the heap
+ */
+static void heap_remove(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+
+    timer_array[timer_id].heap_index = NO_TIMER;
+    running_timers--;
+
+    if (index != running_timers)
+    {
+        /* The last entry fills the gap and moves up or down. */
+        uint8_t last_id = running_timer_heap[running_timers];
+
+        running_timer_heap[index] = last_id;
+        heap_sift_down(index);
+        heap_sift_up(timer_array[last_id].heap_index);
+    }
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_HEAP)) || defined(DOXYGEN) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_STATS)) || defined(DOXYGEN)
+/**
+ * @brief Records the duration of a critical region of the timer module
+ *
+ * @param start Time when the critical region was entered
+ */
+static void timer_stats_critical(uint32_t start)
+{
+    uint32_t duration = SUB_TIME(gettime(), start);
+
+    if (duration > timer_stats.max_critical_us)
+    {
+        timer_stats.max_critical_us = duration;
+    }
+}
+
+
+
+/**
+ * @brief Gets the run time statistics of the timer module
+ *
+ * @param[out] stats Statistics since timer_init() or the last reset
+ * @param reset true to reset the statistics after reading
+ */
+void pal_timer_get_stats(pal_timer_stats_t *stats, bool reset)
+{
+    ENTER_CRITICAL_REGION();
+
+    *stats = timer_stats;
+    if (reset)
+    {
+        timer_stats = (pal_timer_stats_t){ 0 };
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_STATS)) || defined(DOXYGEN) */
+
+
+
+/* EOF */
@@ -0,0 +1,204 @@
+/**
+ * @file pal_trx_access.c
+ *
+ * @brief Transceiver registers & Buffer accessing functions for
+ *        hosted Linux builds.
+ *
+ * This file implements functions for reading and writing transceiver
+ * registers and transceiver buffer. The SPI transactions of the MCU based
+ * PALs are replaced by accesses to the transceiver emulation.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include "pal.h"
+#include "return_val.h"
+#include "pal_internal.h"
+#include "pal_trx_emu.h"
+
+/* === Macros ============================================================== */
+
+/* === Prototypes ========================================================== */
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the transceiver interface
+ *
+ * This function initializes the transceiver interface.
+ */
+void trx_interface_init(void)
+{
+    TRX_INIT();
+}
+
+
+/**
+ * @brief Writes data into a transceiver register
+ *
+ * This function writes a value into transceiver register.
+ *
+ * @param addr Address of the trx register
+ * @param data Data to be written to trx register
+ *
+ */
+void pal_trx_reg_write(uint8_t addr, uint8_t data)
+{
+    ENTER_TRX_REGION();
+
+    trx_emu_reg_write(addr, data);
+
+    LEAVE_TRX_REGION();
+}
+
+
+/**
+ * @brief Reads current value from a transceiver register
+ *
+ * This function reads the current value from a transceiver register.
+ *
+ * @param addr Specifies the address of the trx register from which
+ * the data shall be read
+ *
+ * @return value of the register read
+ */
+uint8_t pal_trx_reg_read(uint8_t addr)
+{
+    uint8_t register_value;
+
+    ENTER_TRX_REGION();
+
+    register_value = trx_emu_reg_read(addr);
+
+    LEAVE_TRX_REGION();
+
+    return register_value;
+}
+
+
+/**
+ * @brief Reads frame buffer of the transceiver
+ *
+ * This function reads the frame buffer of the transceiver.
+ *
+ * @param[out] data Pointer to the location to store frame
+ * @param[in] length Number of bytes to be read from the frame
+ * buffer.
+ */
+void pal_trx_frame_read(uint8_t *data, uint8_t length)
+{
+    /* Assumption: This function is called within ISR. */
+    trx_emu_frame_read(data, length);
+}
+
+
+/**
+ * @brief Writes data into frame buffer of the transceiver
+ *
+ * This function writes data into the frame buffer of the transceiver
+ *
+ * @param[in] data Pointer to data to be written into frame buffer
+ * @param[in] length Number of bytes to be written into frame buffer
+ */
+void pal_trx_frame_write(uint8_t *data, uint8_t length)
+{
+    /* Assumption: The TAL has already disabled the trx interrupt. */
+    trx_emu_frame_write(data, length);
+}
+
+
+/**
+ * @brief Subregister read
+ *
+ * @param   addr  offset of the register
+ * @param   mask  bit mask of the subregister
+ * @param   pos   bit position of the subregister
+ *
+ * @return  value of the read bit(s)
+ */
+uint8_t pal_trx_bit_read(uint8_t addr, uint8_t mask, uint8_t pos)
+{
+    uint8_t ret;
+
+    ret = pal_trx_reg_read(addr);
+    ret &= mask;
+    ret >>= pos;
+
+    return ret;
+}
+
+
+/**
+ * @brief Subregister write
+ *
+ * @param[in]   reg_addr  Offset of the register
+ * @param[in]   mask  Bit mask of the subregister
+ * @param[in]   pos   Bit position of the subregister
+ * @param[out]  new_value  Data, which is muxed into the register
+ */
+void pal_trx_bit_write(uint8_t reg_addr, uint8_t mask, uint8_t pos, uint8_t new_value)
+{
+    uint8_t current_reg_value;
+    current_reg_value = pal_trx_reg_read(reg_addr);
+    current_reg_value &= (uint8_t)~(uint16_t)mask;
+    new_value <<= pos;
+    new_value &= mask;
+    new_value |= current_reg_value;
+
+    pal_trx_reg_write(reg_addr, new_value);
+}
+
+
+
+#if defined(ENABLE_TRX_SRAM) || defined(DOXYGEN)
+/**
+ * @brief Writes data into SRAM of the transceiver
+ *
+ * This function writes data into the SRAM of the transceiver
+ *
+ * @param addr Start address in the SRAM for the write operation
+ * @param data Pointer to the data to be written into SRAM
+ * @param length Number of bytes to be written into SRAM
+ */
+void pal_trx_sram_write(uint8_t addr, uint8_t *data, uint8_t length)
+{
+    ENTER_TRX_REGION();
+
+    trx_emu_sram_write(addr, data, length);
+
+    LEAVE_TRX_REGION();
+}
+#endif  /* #if defined(ENABLE_TRX_SRAM) || defined(DOXYGEN) */
+
+
+#if defined(ENABLE_TRX_SRAM) || defined(ENABLE_TRX_SRAM_READ) || defined(DOXYGEN)
+/**
+ * @brief Reads data from SRAM of the transceiver
+ *
+ * This function reads from the SRAM of the transceiver
+ *
+ * @param[in] addr Start address in SRAM for read operation
+ * @param[out] data Pointer to the location where data stored
+ * @param[in] length Number of bytes to be read from SRAM
+ */
+void pal_trx_sram_read(uint8_t addr, uint8_t *data, uint8_t length)
+{
+    ENTER_TRX_REGION();
+
+    trx_emu_sram_read(addr, data, length);
+
+    LEAVE_TRX_REGION();
+}
+#endif  /* #if defined(ENABLE_TRX_SRAM) || defined(DOXYGEN) */
+
+/* EOF */
@@ -0,0 +1,2150 @@
+/**
+ * @file pal_trx_emu.c
+ *
+ * @brief Software model of the AT86RF233 transceiver for hosted Linux builds
+ *
+ * This file implements the register file, the frame buffer, the state
+ * machine and the IRQ line of the AT86RF233 as far as they are used by the
+ * TAL and the RTB. Several processes share a radio medium, which is made of
+ * UDP datagrams exchanged on the loopback interface: each node listens on
+ * port RTB_EMU_PORT + node number and sends every transmitted frame to all
+ * other nodes. The datagram carries the start time of the frame (based on
+ * the monotonic clock common to all processes), so the receiving node can
+ * reproduce the frame timing.
+ *
+ * Instead of the UDP based medium, a simulator can attach its own medium
+ * and clock (see trx_emu_configure() and pal_host_clock_set()). In this
+ * case frames are delivered ahead of time and the emulation takes care of
+ * the propagation delay, collisions and the CCA based on the frames that
+ * are on air at this node.
+ *
+ * The phase measurement unit (PMU) is modelled by the phase of a carrier
+ * travelling over the distance between this node and the node that sent
+ * the last received frame, plus a local oscillator phase offset of each
+ * node. Each node position is taken from RTB_EMU_POS.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "pal.h"
+#include "pal_timer.h"
+#include "pal_trx_emu.h"
+#include "at86rf233.h"
+
+/* === Macros ============================================================== */
+
+/** Marker of a datagram of the emulated medium ("R233"). */
+#define MEDIUM_MAGIC                    (0x33333252UL)
+
+/** Maximum number of frames buffered between two polls. */
+#define MEDIUM_QUEUE_LEN                (64)
+
+/** Number of registers of the transceiver */
+#define EMU_NO_OF_REGS                  (0x40)
+
+/** Size of the frame buffer SRAM */
+#define EMU_SRAM_SIZE                   (0x80)
+
+/** Duration of one octet in us (O-QPSK 250 kbit/s) */
+#define EMU_OCTET_US                    (32)
+
+/** Length of SHR and PHR in octets */
+#define EMU_SHR_PHR_LEN                 (6)
+
+/** Time between end of a frame and start of the ACK (12 symbols) in us */
+#define EMU_ACK_TURNAROUND_US           (192)
+
+/** Duration of an ED measurement (8 symbols) in us */
+#define EMU_ED_DURATION_US              (128)
+
+/** Duration of a backoff period (20 symbols) in us */
+#define EMU_BACKOFF_PERIOD_US           (320)
+
+/** MAX_CSMA_RETRIES value requesting a transmission without CSMA-CA */
+#define EMU_NO_CSMA                     (7)
+
+/** Duration of one SPI octet (4 MHz SPI clock incl. gaps) in us */
+#define EMU_SPI_OCTET_US                (2)
+
+/**
+ * A frame overlapping a reception destroys it unless it is at least
+ * this much weaker (in dB, i.e. ED steps).
+ */
+#define EMU_CAPTURE_THRESHOLD_DB        (10)
+
+/**
+ * Default wall clock time in us a node waits for an ACK in TX_ARET.
+ * Since the peer is a separate process it needs to be scheduled before it
+ * can reply, hence the time is much larger than macAckWaitDuration.
+ */
+#define EMU_ACK_TIMEOUT_US              (10000)
+
+/**
+ * Wall clock time in us a frame is kept after its end while the receiver
+ * is not listening. On the real chip the MCU switches back to RX within a
+ * few us after a transmission; a hosted process may be preempted, so
+ * frames of the peer arriving in such a gap are held for this time.
+ */
+#define EMU_RX_HOLD_US                  (2000)
+
+/** Environment variable overriding the ACK timeout in us. */
+#define TRX_EMU_ENV_ACK_TIMEOUT         "RTB_EMU_ACK_TIMEOUT_US"
+
+/** Receiver sensitivity in dBm */
+#define EMU_SENSITIVITY_DBM             (-101)
+
+/** Offset between received power in dBm and the ED value */
+#define EMU_ED_OFFSET_DB                (94)
+
+/** Path loss at the reference distance of 1 m at 2.45 GHz in dB */
+#define EMU_PATH_LOSS_1M_DB             (40.2)
+
+/** Speed of light in m/s */
+#define EMU_SPEED_OF_LIGHT              (299792458.0)
+
+/** Part number of the AT86RF233 */
+#define EMU_PART_NUM                    (0x0B)
+
+/** Version number of the AT86RF233 */
+#define EMU_VERSION_NUM                 (0x01)
+
+/** Manufacturer ID (Atmel) */
+#define EMU_MAN_ID_0                    (0x1F)
+
+/* Frame control field */
+#define FCF_FRAME_TYPE_MASK             (0x0007)
+#define FCF_FRAMETYPE_BEACON            (0x00)
+#define FCF_FRAMETYPE_ACK               (0x02)
+#define FCF_FRAMETYPE_MAC_CMD           (0x03)
+#define FCF_FRAME_PENDING               (1 << 4)
+#define FCF_ACK_REQUEST                 (1 << 5)
+#define FCF_PAN_ID_COMPRESSION          (1 << 6)
+#define FCF_DST_ADDR_MODE(fcf)          (((fcf) >> 10) & 0x03)
+#define FCF_SRC_ADDR_MODE(fcf)          (((fcf) >> 14) & 0x03)
+#define FCF_ADDR_MODE_NONE              (0)
+#define FCF_ADDR_MODE_SHORT             (2)
+#define FCF_ADDR_MODE_LONG              (3)
+
+/** MAC command identifier of the data request */
+#define EMU_CMD_DATA_REQUEST            (0x04)
+
+/* === Types =============================================================== */
+
+/*
+ * Transmission in progress
+ */
+typedef struct emu_tx_tag
+{
+    /* A transmission is ongoing */
+    bool active;
+    /* Transmission has been triggered, but the frame is not written yet */
+    bool armed;
+    /* Waiting for the ACK of the transmitted frame */
+    bool wait_ack;
+    /* Transmission is done in TX_ARET_ON */
+    bool aret;
+    /* Number of retransmissions left */
+    uint8_t retries;
+    /* CSMA-CA is performed before the frame is put on air */
+    bool csma;
+    /* CSMA-CA backoff is running, the frame is not on air yet */
+    bool backoff;
+    /* Number of busy CCAs (NB) and backoff exponent (BE) */
+    uint8_t nb;
+    uint8_t be;
+    /* End of the CCA following the current backoff */
+    uint64_t cca_end_us;
+    /* End of the frame on air */
+    uint64_t end_us;
+    /* Latest point in time the ACK is accepted */
+    uint64_t ack_deadline_us;
+    /* Frame to be transmitted */
+    trx_emu_frame_t frame;
+} emu_tx_t;
+
+/* === Globals ============================================================= */
+
+/* Node number and configuration of this emulated transceiver */
+static uint8_t node_id;
+static uint8_t no_of_nodes = TRX_EMU_DEFAULT_NODES;
+static uint16_t base_port = TRX_EMU_DEFAULT_PORT;
+static double node_pos[3];
+static uint8_t phase_noise;
+static uint32_t ack_timeout_us = EMU_ACK_TIMEOUT_US;
+static uint32_t rx_hold_us = EMU_RX_HOLD_US;
+static uint16_t frame_loss_permille;
+static bool emu_initialized;
+
+/* Band, power and duty cycle of the interferer seen by this node */
+static uint16_t interferer_start_mhz;
+static uint16_t interferer_stop_mhz;
+static int8_t interferer_dbm;
+static uint8_t interferer_duty;
+
+/* Configuration has been provided by trx_emu_configure() */
+static bool emu_configured;
+
+/* Medium replacing the UDP based medium, NULL if none */
+static const trx_emu_medium_t *medium;
+
+/* Socket of the emulated medium */
+static int medium_sock = -1;
+
+/* Received datagrams not yet handled */
+static trx_emu_frame_t medium_queue[MEDIUM_QUEUE_LEN];
+static uint8_t medium_queue_head;
+static uint8_t medium_queue_len;
+
+/* Register file */
+static uint8_t regs[EMU_NO_OF_REGS];
+
+/* Current state (TRX_STATUS) */
+static uint8_t trx_state = P_ON;
+
+/* State transition requested while the transceiver has been busy */
+static uint8_t pending_cmd = CMD_NOP;
+
+/* Pin levels */
+static bool pin_rst = true;
+static bool pin_slp_tr;
+
+/* IRQ status, IRQ line and its rising edge latch */
+static uint8_t irq_status;
+static bool irq_edge;
+static uint32_t irq_edge_time;
+
+/* Result of the last TX_ARET transaction */
+static uint8_t trac_status = TRAC_INVALID;
+
+/* CCA result */
+static bool cca_done;
+static bool cca_idle = true;
+
+/* Scheduled ED / CCA measurement end, 0 if none */
+static uint64_t ed_done_us;
+
+/* Energy level of the last measurement or reception */
+static uint8_t ed_level;
+
+/* Frame buffer (SRAM), PHR at address 0 */
+static uint8_t sram[EMU_SRAM_SIZE];
+static uint8_t rx_lqi;
+static uint8_t rx_ed;
+static bool rx_crc_valid;
+
+/* Frame buffer is protected (RX_SAFE_MODE) until it is read */
+static bool rx_protected;
+
+/* Frame buffer has been written for the next transmission */
+static bool tx_frame_written;
+
+/* Reception in progress */
+static bool rx_active;
+static uint64_t rx_end_us;
+static trx_emu_frame_t rx_frame;
+
+/* Frame in reception has been destroyed by an overlapping frame */
+static bool rx_collided;
+
+/* Statistics */
+static trx_emu_stats_t emu_stats;
+
+/* End of the last frame passed to the MCU, not yet responded to */
+static uint64_t response_rx_end_us;
+static bool response_pending;
+
+/* Transmission in progress */
+static emu_tx_t tx;
+
+/* Node and position of the sender of the last received frame */
+static uint8_t peer_node = TRX_EMU_BROADCAST;
+static double peer_pos[3];
+
+/* State of the random generator of the emulation */
+static uint32_t rnd_state;
+
+/* Mapping of the TX_PWR register value to dBm */
+static const int8_t tx_pwr_table[16] =
+{
+    4, 4, 3, 3, 2, 2, 1, 0, -1, -2, -3, -4, -6, -8, -12, -17
+};
+
+/* === Prototypes ========================================================== */
+
+static void medium_init(void);
+static void medium_send(trx_emu_frame_t *frame);
+static void medium_poll(void);
+static void medium_enqueue(const trx_emu_frame_t *frame);
+static uint64_t now_us(void);
+static uint32_t emu_rand(void);
+static void reset_registers(void);
+static void raise_irq(uint8_t cause, uint64_t event_us);
+static void change_state(uint8_t cmd);
+static void start_tx(void);
+static void start_backoff(uint64_t now);
+static void transmit(uint64_t start);
+static void handle_tx(uint64_t now);
+static void handle_rx(uint64_t now);
+static void complete_rx(void);
+static void detect_collisions(uint64_t now);
+static uint64_t arrival_us(const trx_emu_frame_t *frame);
+static uint64_t frame_end_us(const trx_emu_frame_t *frame);
+static uint8_t channel_energy(uint64_t now);
+static uint8_t cca_threshold(void);
+static bool aack_filter(trx_emu_frame_t *frame, bool *ack_requested);
+static void send_ack(trx_emu_frame_t *frame);
+static uint16_t current_freq(void);
+static double distance_to(const double *pos);
+static uint8_t energy_level(int8_t tx_pwr_dbm, const double *pos);
+static uint8_t pmu_phase(void);
+static bool interferer_on(uint16_t freq);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the transceiver emulation
+ */
+void trx_emu_init(void)
+{
+    const char *env;
+
+    if (emu_initialized)
+    {
+        return;
+    }
+    emu_initialized = true;
+
+    if (emu_configured)
+    {
+        /* Node configuration has been provided by trx_emu_configure(). */
+        reset_registers();
+        trx_state = P_ON;
+        if (NULL == medium)
+        {
+            medium_init();
+        }
+        return;
+    }
+
+    env = getenv(TRX_EMU_ENV_NODE);
+    if (NULL != env)
+    {
+        node_id = (uint8_t)atoi(env);
+    }
+
+    env = getenv(TRX_EMU_ENV_NODES);
+    if (NULL != env)
+    {
+        int n = atoi(env);
+
+        if ((n > 0) && (n <= TRX_EMU_MAX_NODES))
+        {
+            no_of_nodes = (uint8_t)n;
+        }
+    }
+
+    env = getenv(TRX_EMU_ENV_PORT);
+    if (NULL != env)
+    {
+        base_port = (uint16_t)atoi(env);
+    }
+
+    node_pos[0] = (double)node_id;
+    node_pos[1] = 0.0;
+    node_pos[2] = 0.0;
+    env = getenv(TRX_EMU_ENV_POS);
+    if (NULL != env)
+    {
+        sscanf(env, "%lf,%lf,%lf", &node_pos[0], &node_pos[1], &node_pos[2]);
+    }
+
+    env = getenv(TRX_EMU_ENV_PHASE_NOISE);
+    if (NULL != env)
+    {
+        phase_noise = (uint8_t)atoi(env);
+    }
+
+    env = getenv(TRX_EMU_ENV_ACK_TIMEOUT);
+    if (NULL != env)
+    {
+        ack_timeout_us = (uint32_t)atol(env);
+    }
+
+    env = getenv(TRX_EMU_ENV_INTERFERER);
+    if (NULL != env)
+    {
+        unsigned start, stop, duty;
+        int dbm;
+
+        if (4 == sscanf(env, "%u,%u,%d,%u", &start, &stop, &dbm, &duty))
+        {
+            interferer_start_mhz = (uint16_t)start;
+            interferer_stop_mhz = (uint16_t)stop;
+            interferer_dbm = (int8_t)dbm;
+            interferer_duty = (uint8_t)((duty > 100) ? 100 : duty);
+        }
+    }
+
+    rnd_state = (uint32_t)now_us() ^ ((uint32_t)node_id << 24) ^ (uint32_t)getpid();
+    if (0 == rnd_state)
+    {
+        rnd_state = 1;
+    }
+
+    reset_registers();
+    trx_state = P_ON;
+
+    medium_init();
+
+    fprintf(stderr, "AT86RF233 emulation: node %u of %u, port %u, "
+            "position (%.2f, %.2f, %.2f) m\n",
+            node_id, no_of_nodes, base_port,
+            node_pos[0], node_pos[1], node_pos[2]);
+}
+
+
+
+/**
+ * @brief Configures the transceiver emulation without environment
+ */
+void trx_emu_configure(const trx_emu_config_t *config,
+                       const trx_emu_medium_t *medium_cfg)
+{
+    node_id = config->node_id;
+    memcpy(node_pos, config->pos, sizeof(node_pos));
+    phase_noise = config->phase_noise;
+    ack_timeout_us = config->ack_timeout_us;
+    rx_hold_us = config->rx_hold_us;
+    frame_loss_permille = config->frame_loss_permille;
+    interferer_start_mhz = config->interferer_start_mhz;
+    interferer_stop_mhz = config->interferer_stop_mhz;
+    interferer_dbm = config->interferer_dbm;
+    interferer_duty = config->interferer_duty;
+    rnd_state = (0 != config->seed) ? config->seed : 1;
+    medium = medium_cfg;
+    emu_configured = true;
+}
+
+
+
+/**
+ * @brief Passes a frame of another node to this node
+ */
+void trx_emu_deliver(const trx_emu_frame_t *frame)
+{
+    if (!pin_rst || (TRX_SLEEP == trx_state))
+    {
+        /* Transceiver is not able to receive. */
+        return;
+    }
+
+    medium_enqueue(frame);
+}
+
+
+
+/**
+ * @brief Gets the host time of the next transceiver event
+ */
+bool trx_emu_next_event(uint64_t *time_us)
+{
+    uint64_t now = now_us();
+    uint64_t next = UINT64_MAX;
+    uint8_t i;
+
+    if (!emu_initialized)
+    {
+        return false;
+    }
+
+    if (irq_edge)
+    {
+        *time_us = now;
+        return true;
+    }
+
+    if (0 != ed_done_us)
+    {
+        next = ed_done_us;
+    }
+
+    if (tx.active)
+    {
+        uint64_t t;
+
+        if (tx.backoff)
+        {
+            t = tx.cca_end_us;
+        }
+        else if (tx.wait_ack)
+        {
+            t = tx.ack_deadline_us;
+        }
+        else
+        {
+            t = tx.end_us;
+        }
+        if (t < next)
+        {
+            next = t;
+        }
+    }
+
+    if (rx_active && (rx_end_us < next))
+    {
+        next = rx_end_us;
+    }
+
+    for (i = 0; i < medium_queue_len; i++)
+    {
+        trx_emu_frame_t *f = &medium_queue[(medium_queue_head + i) % MEDIUM_QUEUE_LEN];
+        uint64_t t;
+
+        if (MEDIUM_MAGIC != f->magic)
+        {
+            continue;
+        }
+
+        /* Arrival of the frame, or its end in case of an ACK */
+        t = f->is_ack ? frame_end_us(f) : arrival_us(f);
+        if (t <= now)
+        {
+            /* Frame is held while the receiver is not listening. */
+            t = frame_end_us(f) + rx_hold_us;
+        }
+        if ((t > now) && (t < next))
+        {
+            next = t;
+        }
+    }
+
+    if (UINT64_MAX == next)
+    {
+        return false;
+    }
+
+    *time_us = next;
+
+    return true;
+}
+
+
+
+/**
+ * @brief Gets the statistics of the emulated transceiver
+ */
+void trx_emu_get_stats(trx_emu_stats_t *stats)
+{
+    *stats = emu_stats;
+}
+
+
+
+/**
+ * @brief Advances the transceiver emulation
+ */
+void trx_emu_poll(void)
+{
+    uint64_t now;
+
+    if (!emu_initialized)
+    {
+        return;
+    }
+
+    medium_poll();
+
+    now = now_us();
+
+    if ((0 != ed_done_us) && (now >= ed_done_us))
+    {
+        uint64_t done = ed_done_us;
+
+        ed_done_us = 0;
+        ed_level = channel_energy(done);
+        cca_done = true;
+        cca_idle = !rx_active && (ed_level < cca_threshold());
+        raise_irq(TRX_IRQ_4_CCA_ED_DONE, done);
+    }
+
+    handle_tx(now);
+    handle_rx(now);
+}
+
+
+
+/**
+ * @brief Reads a transceiver register
+ */
+uint8_t trx_emu_reg_read(uint8_t addr)
+{
+    uint8_t value;
+
+    pal_host_clock_spend(2 * EMU_SPI_OCTET_US);
+    trx_emu_poll();
+
+    addr &= (EMU_NO_OF_REGS - 1);
+
+    if ((TRX_SLEEP == trx_state) || !pin_rst)
+    {
+        /* No SPI access possible. */
+        return 0;
+    }
+
+    switch (addr)
+    {
+        case RG_TRX_STATUS:
+            value = trx_state;
+            if (cca_done)
+            {
+                value |= 0x80;
+                if (cca_idle)
+                {
+                    value |= 0x40;
+                }
+            }
+            break;
+
+        case RG_TRX_STATE:
+            value = (uint8_t)(trac_status << 5);
+            break;
+
+        case RG_PHY_RSSI:
+            value = (uint8_t)((emu_rand() & 0x03) << 5);
+            if (rx_crc_valid)
+            {
+                value |= 0x80;
+            }
+            if (rx_active || (trx_state == BUSY_RX) || (trx_state == BUSY_RX_AACK))
+            {
+                value |= (uint8_t)(rx_ed / 3);
+            }
+            break;
+
+        case RG_PHY_ED_LEVEL:
+            value = ed_level;
+            break;
+
+        case RG_IRQ_STATUS:
+            value = irq_status;
+            irq_status = 0;
+            break;
+
+        case RG_PART_NUM:
+            value = EMU_PART_NUM;
+            break;
+
+        case RG_VERSION_NUM:
+            value = EMU_VERSION_NUM;
+            break;
+
+        case RG_MAN_ID_0:
+            value = EMU_MAN_ID_0;
+            break;
+
+        case RG_MAN_ID_1:
+            value = 0x00;
+            break;
+
+        case RG_VREG_CTRL:
+            /* Both voltage regulators are always fine. */
+            value = regs[addr] | 0x44;
+            break;
+
+        case RG_PHY_PMU_VALUE:
+            if (regs[RG_TRX_CTRL_0] & 0x20)
+            {
+                value = pmu_phase();
+            }
+            else
+            {
+                value = regs[addr];
+            }
+            break;
+
+        default:
+            value = regs[addr];
+            break;
+    }
+
+    return value;
+}
+
+
+
+/**
+ * @brief Writes a transceiver register
+ */
+void trx_emu_reg_write(uint8_t addr, uint8_t data)
+{
+    pal_host_clock_spend(2 * EMU_SPI_OCTET_US);
+    trx_emu_poll();
+
+    addr &= (EMU_NO_OF_REGS - 1);
+
+    if ((TRX_SLEEP == trx_state) || !pin_rst)
+    {
+        return;
+    }
+
+    switch (addr)
+    {
+        case RG_TRX_STATE:
+            change_state(data & 0x1F);
+            break;
+
+        case RG_PHY_CC_CCA:
+            regs[addr] = data & 0x7F;
+            if ((data & 0x80) &&
+                ((RX_ON == trx_state) || (RX_AACK_ON == trx_state) ||
+                 (BUSY_RX == trx_state) || (BUSY_RX_AACK == trx_state)))
+            {
+                /* CCA request, assessed busy during a frame reception */
+                cca_done = false;
+                ed_done_us = now_us() + EMU_ED_DURATION_US;
+            }
+            break;
+
+        case RG_PHY_ED_LEVEL:
+            if ((RX_ON == trx_state) || (RX_AACK_ON == trx_state))
+            {
+                /* Manual ED measurement */
+                ed_level = 0;
+                ed_done_us = now_us() + EMU_ED_DURATION_US;
+            }
+            break;
+
+        case RG_IRQ_STATUS:
+        case RG_PART_NUM:
+        case RG_VERSION_NUM:
+        case RG_MAN_ID_0:
+        case RG_MAN_ID_1:
+            /* read only */
+            break;
+
+        default:
+            regs[addr] = data;
+            break;
+    }
+}
+
+
+
+/**
+ * @brief Reads from the frame buffer
+ */
+void trx_emu_frame_read(uint8_t *data, uint8_t length)
+{
+    uint8_t phr = sram[0] & 0x7F;
+    uint8_t i;
+
+    pal_host_clock_spend((uint32_t)(1 + length) * EMU_SPI_OCTET_US);
+    trx_emu_poll();
+
+    for (i = 0; i < length; i++)
+    {
+        if (i <= phr)
+        {
+            data[i] = sram[i];
+        }
+        else if (i == (phr + 1))
+        {
+            data[i] = rx_lqi;
+        }
+        else if (i == (phr + 2))
+        {
+            data[i] = rx_ed;
+        }
+        else if (i == (phr + 3))
+        {
+            data[i] = rx_crc_valid ? 0x80 : 0x00;
+        }
+        else
+        {
+            data[i] = 0;
+        }
+    }
+
+    /* Any frame buffer access releases the buffer protection. */
+    rx_protected = false;
+}
+
+
+
+/**
+ * @brief Writes to the frame buffer
+ */
+void trx_emu_frame_write(uint8_t *data, uint8_t length)
+{
+    pal_host_clock_spend((uint32_t)(1 + length) * EMU_SPI_OCTET_US);
+    trx_emu_poll();
+
+    if (length > EMU_SRAM_SIZE)
+    {
+        length = EMU_SRAM_SIZE;
+    }
+    memcpy(sram, data, length);
+    rx_protected = false;
+    tx_frame_written = true;
+
+    if (tx.armed)
+    {
+        /* Transmission has already been triggered by SLP_TR. */
+        start_tx();
+    }
+}
+
+
+
+/**
+ * @brief Reads from the transceiver SRAM
+ */
+void trx_emu_sram_read(uint8_t addr, uint8_t *data, uint8_t length)
+{
+    uint8_t i;
+
+    trx_emu_poll();
+
+    for (i = 0; i < length; i++)
+    {
+        uint16_t a = (uint16_t)addr + i;
+
+        data[i] = (a < EMU_SRAM_SIZE) ? sram[a] : 0;
+    }
+}
+
+
+
+/**
+ * @brief Writes to the transceiver SRAM
+ */
+void trx_emu_sram_write(uint8_t addr, uint8_t *data, uint8_t length)
+{
+    uint8_t i;
+
+    trx_emu_poll();
+
+    for (i = 0; i < length; i++)
+    {
+        uint16_t a = (uint16_t)addr + i;
+
+        if (a < EMU_SRAM_SIZE)
+        {
+            sram[a] = data[i];
+        }
+    }
+}
+
+
+
+/**
+ * @brief Drives the RST pin of the transceiver
+ */
+void trx_emu_set_rst(bool level)
+{
+    if (pin_rst && !level)
+    {
+        /* Reset asserted: all activities are stopped. */
+        tx.active = false;
+        tx.armed = false;
+        tx.wait_ack = false;
+        rx_active = false;
+        ed_done_us = 0;
+    }
+    else if (!pin_rst && level)
+    {
+        /* Reset released: the transceiver enters TRX_OFF. */
+        reset_registers();
+        trx_state = TRX_OFF;
+    }
+    pin_rst = level;
+}
+
+
+
+/**
+ * @brief Drives the SLP_TR pin of the transceiver
+ */
+void trx_emu_set_slp_tr(bool level)
+{
+    trx_emu_poll();
+
+    if (!pin_slp_tr && level)
+    {
+        switch (trx_state)
+        {
+            case TRX_OFF:
+                trx_state = TRX_SLEEP;
+                break;
+
+            case PLL_ON:
+            case TX_ARET_ON:
+                tx.armed = true;
+                tx.aret = (TX_ARET_ON == trx_state);
+                trx_state = tx.aret ? BUSY_TX_ARET : BUSY_TX;
+                if (tx_frame_written)
+                {
+                    /* Frame has been written before the trigger. */
+                    start_tx();
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    else if (pin_slp_tr && !level)
+    {
+        if (TRX_SLEEP == trx_state)
+        {
+            trx_state = TRX_OFF;
+            /* Awake IRQ */
+            raise_irq(TRX_IRQ_4_CCA_ED_DONE, now_us());
+        }
+    }
+    pin_slp_tr = level;
+}
+
+
+
+/**
+ * @brief Returns the level of the IRQ pin of the transceiver
+ */
+bool trx_emu_get_irq(void)
+{
+    trx_emu_poll();
+
+    return (0 != irq_status);
+}
+
+
+
+/**
+ * @brief Returns and clears the rising edge latch of the IRQ pin
+ */
+bool trx_emu_get_irq_edge(void)
+{
+    bool edge;
+
+    trx_emu_poll();
+
+    edge = irq_edge;
+    irq_edge = false;
+
+    return edge;
+}
+
+
+
+/**
+ * @brief Returns the system time of the last rising edge of the IRQ pin
+ */
+uint32_t trx_emu_irq_timestamp(void)
+{
+    return irq_edge_time;
+}
+
+
+
+/**
+ * @brief Returns the node number of this emulated transceiver
+ */
+uint8_t trx_emu_node_id(void)
+{
+    return node_id;
+}
+
+
+
+/**
+ * @brief Sets the registers to their reset values
+ */
+static void reset_registers(void)
+{
+    memset(regs, 0, sizeof(regs));
+
+    regs[RG_TRX_CTRL_0] = 0x09;
+    regs[RG_PHY_TX_PWR] = 0x00;
+    regs[RG_PHY_CC_CCA] = 0x2B;     /* channel 11, CCA mode 1 */
+    regs[RG_CCA_THRES] = 0xC7;
+    regs[RG_RX_CTRL] = 0xB7;
+    regs[RG_SFD_VALUE] = 0xA7;
+    regs[RG_TRX_CTRL_1] = 0x22;
+    regs[RG_TRX_CTRL_2] = 0x00;
+    regs[RG_ANT_DIV] = 0x03;
+    regs[RG_IRQ_MASK] = 0x00;
+    regs[RG_XOSC_CTRL] = 0xF0;
+    regs[RG_CC_CTRL_0] = 0x00;
+    regs[RG_CC_CTRL_1] = 0x00;
+    regs[RG_RX_SYN] = 0x00;
+    regs[RG_XAH_CTRL_1] = 0x00;
+    regs[RG_SHORT_ADDR_0] = 0xFF;
+    regs[RG_SHORT_ADDR_1] = 0xFF;
+    regs[RG_PAN_ID_0] = 0xFF;
+    regs[RG_PAN_ID_1] = 0xFF;
+    regs[RG_XAH_CTRL_0] = 0x38;
+    regs[RG_CSMA_SEED_1] = 0x42;
+    regs[RG_CSMA_BE] = 0x53;
+
+    irq_status = 0;
+    irq_edge = false;
+    trac_status = TRAC_INVALID;
+    cca_done = false;
+    cca_idle = true;
+    ed_done_us = 0;
+    rx_protected = false;
+    rx_active = false;
+    rx_collided = false;
+    tx_frame_written = false;
+    pending_cmd = CMD_NOP;
+    memset(&tx, 0, sizeof(tx));
+}
+
+
+
+/**
+ * @brief Raises interrupts of the transceiver
+ *
+ * @param cause Interrupt reasons
+ * @param event_us Point in time of the event
+ */
+static void raise_irq(uint8_t cause, uint64_t event_us)
+{
+    bool line_was_high = (0 != irq_status);
+
+    /* Only enabled interrupts are reported (IRQ_MASK_MODE = 0). */
+    irq_status |= (uint8_t)(cause & regs[RG_IRQ_MASK]);
+
+    if (!line_was_high && (0 != irq_status))
+    {
+        uint64_t now = now_us();
+
+        irq_edge = true;
+        irq_edge_time = pal_host_time_us() - (uint32_t)(now - event_us);
+    }
+}
+
+
+
+/**
+ * @brief Handles a state transition command
+ *
+ * @param cmd Command written to TRX_STATE
+ */
+static void change_state(uint8_t cmd)
+{
+    uint8_t prev_state = trx_state;
+    bool busy = ((BUSY_RX == trx_state) || (BUSY_TX == trx_state) ||
+                 (BUSY_RX_AACK == trx_state) || (BUSY_TX_ARET == trx_state));
+
+    switch (cmd)
+    {
+        case CMD_NOP:
+            return;
+
+        case CMD_TX_START:
+            if ((PLL_ON == trx_state) || (TX_ARET_ON == trx_state))
+            {
+                /* Same as a rising edge at SLP_TR. */
+                bool level = pin_slp_tr;
+
+                pin_slp_tr = false;
+                trx_emu_set_slp_tr(true);
+                pin_slp_tr = level;
+            }
+            return;
+
+        case CMD_FORCE_TRX_OFF:
+            tx.active = false;
+            tx.armed = false;
+            tx.wait_ack = false;
+            rx_active = false;
+            ed_done_us = 0;
+            pending_cmd = CMD_NOP;
+            trx_state = TRX_OFF;
+            return;
+
+        case CMD_FORCE_PLL_ON:
+            tx.active = false;
+            tx.armed = false;
+            tx.wait_ack = false;
+            rx_active = false;
+            ed_done_us = 0;
+            pending_cmd = CMD_NOP;
+            trx_state = PLL_ON;
+            break;
+
+        case CMD_TRX_OFF:
+        case CMD_PLL_ON:
+        case CMD_RX_ON:
+        case CMD_RX_AACK_ON:
+        case CMD_TX_ARET_ON:
+            if (busy)
+            {
+                /* The transition is done after the current transaction. */
+                pending_cmd = cmd;
+                return;
+            }
+            if ((P_ON == trx_state) && (CMD_TRX_OFF != cmd))
+            {
+                return;
+            }
+            trx_state = cmd;
+            if (CMD_TRX_OFF == cmd)
+            {
+                ed_done_us = 0;
+                return;
+            }
+            break;
+
+        case CMD_PREP_DEEP_SLEEP:
+            if (TRX_OFF == trx_state)
+            {
+                trx_state = PREP_DEEP_SLEEP;
+            }
+            return;
+
+        default:
+            return;
+    }
+
+    if ((RX_ON != trx_state) && (RX_AACK_ON != trx_state))
+    {
+        ed_done_us = 0;
+    }
+
+    if (TX_ARET_ON != trx_state)
+    {
+        tx_frame_written = false;
+    }
+
+    if ((TRX_OFF == prev_state) || (P_ON == prev_state))
+    {
+        /* The PLL locks immediately. */
+        raise_irq(TRX_IRQ_0_PLL_LOCK, now_us());
+    }
+}
+
+
+
+/**
+ * @brief Starts the transmission of the frame buffer content
+ */
+static void start_tx(void)
+{
+    uint8_t len = sram[0] & 0x7F;
+    uint64_t now = now_us();
+    int8_t pwr = tx_pwr_table[regs[RG_PHY_TX_PWR] & 0x0F];
+    uint16_t fcf;
+
+    tx.armed = false;
+    tx_frame_written = false;
+
+    if (len < 2)
+    {
+        len = 2;
+    }
+
+    memset(&tx.frame, 0, sizeof(tx.frame));
+    tx.frame.magic = MEDIUM_MAGIC;
+    tx.frame.src_node = node_id;
+    tx.frame.dst_node = TRX_EMU_BROADCAST;
+    tx.frame.is_ack = 0;
+    tx.frame.tx_pwr_dbm = pwr;
+    tx.frame.freq = current_freq();
+    tx.frame.psdu_len = len;
+    memcpy(tx.frame.pos, node_pos, sizeof(node_pos));
+    memcpy(tx.frame.psdu, &sram[1], len - 2);
+
+    /* Append the FCS (TX_AUTO_CRC_ON). */
+    {
+        uint16_t crc = 0;
+        uint8_t i;
+
+        for (i = 0; i < (len - 2); i++)
+        {
+            crc = CRC_CCITT_UPDATE(crc, tx.frame.psdu[i]);
+        }
+        tx.frame.psdu[len - 2] = (uint8_t)crc;
+        tx.frame.psdu[len - 1] = (uint8_t)(crc >> 8);
+    }
+
+    if (response_pending)
+    {
+        uint32_t response_us = (uint32_t)(now - response_rx_end_us);
+
+        response_pending = false;
+        emu_stats.responses++;
+        emu_stats.response_time_sum_us += response_us;
+        if (response_us > emu_stats.response_time_max_us)
+        {
+            emu_stats.response_time_max_us = response_us;
+        }
+    }
+
+    tx.active = true;
+    tx.wait_ack = false;
+
+    fcf = (uint16_t)tx.frame.psdu[0] | ((uint16_t)tx.frame.psdu[1] << 8);
+    if (tx.aret && (fcf & FCF_ACK_REQUEST))
+    {
+        tx.retries = (regs[RG_XAH_CTRL_0] >> 4) & 0x0F;
+    }
+    else
+    {
+        tx.retries = 0;
+    }
+
+    tx.csma = tx.aret && (EMU_NO_CSMA != ((regs[RG_XAH_CTRL_0] >> 1) & 0x07));
+    if (tx.csma)
+    {
+        tx.nb = 0;
+        tx.be = regs[RG_CSMA_BE] & 0x0F;
+        start_backoff(now);
+    }
+    else
+    {
+        transmit(now);
+    }
+}
+
+
+
+/**
+ * @brief Starts a random backoff of CSMA-CA followed by a CCA
+ *
+ * @param now Start of the backoff
+ */
+static void start_backoff(uint64_t now)
+{
+    uint32_t periods = emu_rand() & ((1UL << tx.be) - 1);
+
+    tx.backoff = true;
+    tx.cca_end_us = now + ((uint64_t)periods * EMU_BACKOFF_PERIOD_US) +
+                    EMU_ED_DURATION_US;
+}
+
+
+
+/**
+ * @brief Puts the frame to be transmitted on air
+ *
+ * @param start Start of the frame
+ */
+static void transmit(uint64_t start)
+{
+    tx.backoff = false;
+    tx.wait_ack = false;
+    tx.frame.start_us = start;
+    tx.end_us = start + (uint64_t)(EMU_SHR_PHR_LEN + tx.frame.psdu_len) * EMU_OCTET_US;
+
+    emu_stats.tx_frames++;
+    medium_send(&tx.frame);
+}
+
+
+
+/**
+ * @brief Handles the end of a transmission and the ACK reception
+ *
+ * @param now Current time
+ */
+static void handle_tx(uint64_t now)
+{
+    uint16_t fcf;
+
+    if (!tx.active)
+    {
+        return;
+    }
+
+    fcf = (uint16_t)tx.frame.psdu[0] | ((uint16_t)tx.frame.psdu[1] << 8);
+
+    if (tx.backoff)
+    {
+        uint8_t max_csma_retries = (regs[RG_XAH_CTRL_0] >> 1) & 0x07;
+        uint8_t max_be = regs[RG_CSMA_BE] >> 4;
+
+        if (now < tx.cca_end_us)
+        {
+            return;
+        }
+
+        if (!rx_active && (channel_energy(tx.cca_end_us) < cca_threshold()))
+        {
+            /* Channel is idle. */
+            transmit(tx.cca_end_us);
+            return;
+        }
+
+        emu_stats.cca_busy++;
+        tx.nb++;
+        if (tx.be < max_be)
+        {
+            tx.be++;
+        }
+
+        if (tx.nb > max_csma_retries)
+        {
+            emu_stats.channel_access_failures++;
+            tx.active = false;
+            tx.backoff = false;
+            trac_status = TRAC_CHANNEL_ACCESS_FAILURE;
+            trx_state = TX_ARET_ON;
+            raise_irq(TRX_IRQ_3_TRX_END, tx.cca_end_us);
+        }
+        else
+        {
+            start_backoff(tx.cca_end_us);
+            return;
+        }
+    }
+    else if (!tx.wait_ack)
+    {
+        if (now < tx.end_us)
+        {
+            return;
+        }
+
+        if (tx.aret && (fcf & FCF_ACK_REQUEST))
+        {
+            tx.wait_ack = true;
+            tx.ack_deadline_us = tx.end_us + ack_timeout_us;
+            return;
+        }
+
+        /* Transmission without ACK is done. */
+        tx.active = false;
+        trac_status = TRAC_SUCCESS;
+        trx_state = tx.aret ? TX_ARET_ON : PLL_ON;
+        raise_irq(TRX_IRQ_3_TRX_END, tx.end_us);
+    }
+    else
+    {
+        uint8_t i;
+
+        /* Look for the ACK within the received datagrams. */
+        for (i = 0; i < medium_queue_len; i++)
+        {
+            trx_emu_frame_t *f =
+                &medium_queue[(medium_queue_head + i) % MEDIUM_QUEUE_LEN];
+
+            if ((MEDIUM_MAGIC == f->magic) && f->is_ack &&
+                (f->dst_node == node_id) &&
+                (f->psdu[2] == tx.frame.psdu[2]) &&
+                (frame_end_us(f) <= now))
+            {
+                bool pending = (0 != (f->psdu[0] & FCF_FRAME_PENDING));
+                uint64_t ack_end = frame_end_us(f);
+
+                peer_node = f->src_node;
+                memcpy(peer_pos, f->pos, sizeof(peer_pos));
+
+                f->magic = 0;   /* consumed */
+                tx.active = false;
+                tx.wait_ack = false;
+                trac_status = pending ? TRAC_SUCCESS_DATA_PENDING : TRAC_SUCCESS;
+                trx_state = TX_ARET_ON;
+                raise_irq(TRX_IRQ_3_TRX_END, ack_end);
+                return;
+            }
+        }
+
+        if (now >= tx.ack_deadline_us)
+        {
+            if (tx.retries > 0)
+            {
+                /* Retransmission, including CSMA-CA */
+                tx.retries--;
+                tx.wait_ack = false;
+                if (tx.csma)
+                {
+                    tx.nb = 0;
+                    tx.be = regs[RG_CSMA_BE] & 0x0F;
+                    start_backoff(tx.ack_deadline_us);
+                }
+                else
+                {
+                    transmit(tx.ack_deadline_us);
+                }
+            }
+            else
+            {
+                emu_stats.no_ack++;
+                tx.active = false;
+                tx.wait_ack = false;
+                trac_status = TRAC_NO_ACK;
+                trx_state = TX_ARET_ON;
+                raise_irq(TRX_IRQ_3_TRX_END, now);
+            }
+        }
+    }
+
+    if (!tx.active && (CMD_NOP != pending_cmd))
+    {
+        uint8_t cmd = pending_cmd;
+
+        pending_cmd = CMD_NOP;
+        change_state(cmd);
+    }
+}
+
+
+
+/**
+ * @brief Handles frame reception
+ *
+ * @param now Current time
+ */
+static void handle_rx(uint64_t now)
+{
+    while (true)
+    {
+        if (rx_active)
+        {
+            detect_collisions(now);
+            if (now < rx_end_us)
+            {
+                return;
+            }
+            complete_rx();
+            continue;
+        }
+
+        if (0 == medium_queue_len)
+        {
+            return;
+        }
+
+        {
+            trx_emu_frame_t *f = &medium_queue[medium_queue_head];
+            bool rx_state = (RX_ON == trx_state) || (RX_AACK_ON == trx_state);
+            bool receivable;
+
+            if (MEDIUM_MAGIC == f->magic)
+            {
+                if (arrival_us(f) > now)
+                {
+                    /* Frame has not reached this node yet. */
+                    return;
+                }
+
+                /* ACKs for this node are kept while waiting for them. */
+                if (f->is_ack && tx.wait_ack && (f->dst_node == node_id))
+                {
+                    return;
+                }
+
+                /* Frames are held while the MCU has not yet re-enabled RX. */
+                if (!f->is_ack && !rx_state &&
+                    (now < (frame_end_us(f) + rx_hold_us)))
+                {
+                    return;
+                }
+            }
+
+            receivable = (MEDIUM_MAGIC == f->magic) &&
+                         rx_state &&
+                         (f->freq == current_freq()) &&
+                         !rx_protected &&
+                         !(f->is_ack && (RX_AACK_ON == trx_state)) &&
+                         (energy_level(f->tx_pwr_dbm, f->pos) > 0);
+
+            if (receivable)
+            {
+                rx_frame = *f;
+                rx_active = true;
+                rx_collided = false;
+                rx_end_us = frame_end_us(f);
+                trx_state = (RX_ON == trx_state) ? BUSY_RX : BUSY_RX_AACK;
+                rx_ed = energy_level(f->tx_pwr_dbm, f->pos);
+                raise_irq(TRX_IRQ_2_RX_START,
+                          arrival_us(f) + (uint64_t)EMU_SHR_PHR_LEN * EMU_OCTET_US);
+            }
+
+            medium_queue_head = (medium_queue_head + 1) % MEDIUM_QUEUE_LEN;
+            medium_queue_len--;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Checks for frames overlapping the frame in reception
+ *
+ * Frames reaching this node during the reception cannot be received.
+ * They destroy the frame in reception unless they are weaker by at
+ * least @ref EMU_CAPTURE_THRESHOLD_DB.
+ *
+ * @param now Current time
+ */
+static void detect_collisions(uint64_t now)
+{
+    uint8_t i;
+
+    for (i = 0; i < medium_queue_len; i++)
+    {
+        trx_emu_frame_t *f = &medium_queue[(medium_queue_head + i) % MEDIUM_QUEUE_LEN];
+        uint64_t arrival;
+
+        if ((MEDIUM_MAGIC != f->magic) || (f->freq != rx_frame.freq))
+        {
+            continue;
+        }
+
+        arrival = arrival_us(f);
+        if ((arrival > now) || (arrival >= rx_end_us))
+        {
+            continue;
+        }
+
+        if ((energy_level(f->tx_pwr_dbm, f->pos) + EMU_CAPTURE_THRESHOLD_DB) > rx_ed)
+        {
+            if (!rx_collided)
+            {
+                emu_stats.rx_collisions++;
+            }
+            rx_collided = true;
+        }
+
+        /* The receiver is locked to the frame in reception. */
+        f->magic = 0;
+    }
+}
+
+
+
+/**
+ * @brief Completes a reception and stores the frame in the frame buffer
+ */
+static void complete_rx(void)
+{
+    bool aack = (BUSY_RX_AACK == trx_state);
+    bool ack_requested = false;
+    uint8_t cause = TRX_IRQ_3_TRX_END;
+
+    rx_active = false;
+    trx_state = aack ? RX_AACK_ON : RX_ON;
+
+    if (!rx_collided && (frame_loss_permille > 0) &&
+        ((emu_rand() % 1000) < frame_loss_permille))
+    {
+        emu_stats.rx_lost++;
+        rx_collided = true;
+    }
+
+    if (rx_collided && aack)
+    {
+        /* FCS is invalid: the frame is discarded by the filter. */
+        goto state_update;
+    }
+
+    if (aack)
+    {
+        if (!aack_filter(&rx_frame, &ack_requested))
+        {
+            /* Frame is not for this node: no TRX_END */
+            goto state_update;
+        }
+        cause |= TRX_IRQ_5_AMI;
+    }
+
+    sram[0] = rx_frame.psdu_len;
+    memset(&sram[1], 0, EMU_SRAM_SIZE - 1);
+    memcpy(&sram[1], rx_frame.psdu, rx_frame.psdu_len);
+    rx_lqi = rx_collided ? 0x00 : 0xFF;
+    ed_level = rx_ed;
+    rx_crc_valid = !rx_collided;
+    tx_frame_written = false;
+    emu_stats.rx_frames++;
+    response_rx_end_us = rx_end_us;
+    response_pending = true;
+
+    if (regs[RG_TRX_CTRL_2] & 0x80)
+    {
+        rx_protected = true;
+    }
+
+    peer_node = rx_frame.src_node;
+    memcpy(peer_pos, rx_frame.pos, sizeof(peer_pos));
+
+    raise_irq(cause, rx_end_us);
+
+    if (aack && ack_requested)
+    {
+        send_ack(&rx_frame);
+    }
+
+state_update:
+    if (CMD_NOP != pending_cmd)
+    {
+        uint8_t cmd = pending_cmd;
+
+        pending_cmd = CMD_NOP;
+        change_state(cmd);
+    }
+}
+
+
+
+/**
+ * @brief Frame filter of the RX_AACK mode
+ *
+ * @param frame Received frame
+ * @param[out] ack_requested true if the frame needs to be acknowledged
+ *
+ * @return true if the frame is to be passed to the MCU
+ */
+static bool aack_filter(trx_emu_frame_t *frame, bool *ack_requested)
+{
+    uint16_t fcf = (uint16_t)frame->psdu[0] | ((uint16_t)frame->psdu[1] << 8);
+    uint8_t type = fcf & FCF_FRAME_TYPE_MASK;
+    uint8_t dst_mode = FCF_DST_ADDR_MODE(fcf);
+    uint16_t own_pan = (uint16_t)regs[RG_PAN_ID_0] | ((uint16_t)regs[RG_PAN_ID_1] << 8);
+    uint16_t own_short = (uint16_t)regs[RG_SHORT_ADDR_0] |
+                         ((uint16_t)regs[RG_SHORT_ADDR_1] << 8);
+    bool broadcast = false;
+    uint8_t *p = &frame->psdu[3];
+
+    *ack_requested = false;
+
+    if (FCF_FRAMETYPE_ACK == type)
+    {
+        return false;
+    }
+
+    if (FCF_FRAMETYPE_BEACON == type)
+    {
+        return true;
+    }
+
+    if (FCF_ADDR_MODE_NONE == dst_mode)
+    {
+        /* Only the PAN coordinator accepts frames without destination. */
+        if (0 == (regs[RG_CSMA_SEED_1] & 0x08))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        uint16_t dst_pan = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+
+        p += 2;
+        if ((dst_pan != 0xFFFF) && (dst_pan != own_pan))
+        {
+            return false;
+        }
+
+        if (FCF_ADDR_MODE_SHORT == dst_mode)
+        {
+            uint16_t dst_addr = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+
+            if (0xFFFF == dst_addr)
+            {
+                broadcast = true;
+            }
+            else if (dst_addr != own_short)
+            {
+                return false;
+            }
+        }
+        else if (FCF_ADDR_MODE_LONG == dst_mode)
+        {
+            if (0 != memcmp(p, &regs[RG_IEEE_ADDR_0], 8))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    *ack_requested = (!broadcast) && (0 != (fcf & FCF_ACK_REQUEST)) &&
+                     (0 == (regs[RG_CSMA_SEED_1] & 0x10));
+
+    return true;
+}
+
+
+
+/**
+ * @brief Transmits the ACK of a received frame
+ *
+ * @param frame Received frame to be acknowledged
+ */
+static void send_ack(trx_emu_frame_t *frame)
+{
+    trx_emu_frame_t ack;
+    uint16_t fcf = (uint16_t)frame->psdu[0] | ((uint16_t)frame->psdu[1] << 8);
+    uint16_t crc = 0;
+    uint8_t i;
+
+    memset(&ack, 0, sizeof(ack));
+    ack.magic = MEDIUM_MAGIC;
+    ack.src_node = node_id;
+    ack.dst_node = frame->src_node;
+    ack.is_ack = 1;
+    ack.tx_pwr_dbm = tx_pwr_table[regs[RG_PHY_TX_PWR] & 0x0F];
+    ack.freq = frame->freq;
+    ack.psdu_len = 5;
+    memcpy(ack.pos, node_pos, sizeof(node_pos));
+    ack.start_us = rx_end_us + EMU_ACK_TURNAROUND_US;
+
+    ack.psdu[0] = FCF_FRAMETYPE_ACK;
+    /* SET_PD: the frame pending bit is set in ACKs of data requests. */
+    if ((regs[RG_CSMA_SEED_1] & 0x20) &&
+        ((fcf & FCF_FRAME_TYPE_MASK) == FCF_FRAMETYPE_MAC_CMD))
+    {
+        ack.psdu[0] |= FCF_FRAME_PENDING;
+    }
+    ack.psdu[1] = 0x00;
+    ack.psdu[2] = frame->psdu[2];
+
+    for (i = 0; i < 3; i++)
+    {
+        crc = CRC_CCITT_UPDATE(crc, ack.psdu[i]);
+    }
+    ack.psdu[3] = (uint8_t)crc;
+    ack.psdu[4] = (uint8_t)(crc >> 8);
+
+    emu_stats.tx_acks++;
+    medium_send(&ack);
+}
+
+
+
+/**
+ * @brief Returns the current carrier frequency
+ *
+ * Channel page 0 is used if CC_BAND is 0. Otherwise CC_BAND 8 selects
+ * 2322 MHz + CC_NUMBER. Since the PMU needs to be stepped in 500 kHz,
+ * the emulation uses PMU_IF_INVERSE as the additional 500 kHz offset of
+ * the PMU measurement frequency.
+ *
+ * @return Frequency in units of 500 kHz
+ */
+static uint16_t current_freq(void)
+{
+    uint8_t cc_band = regs[RG_CC_CTRL_1] & 0x0F;
+    uint16_t freq_mhz;
+    uint16_t freq;
+
+    if (8 == cc_band)
+    {
+        freq_mhz = 2322 + regs[RG_CC_CTRL_0];
+    }
+    else
+    {
+        uint8_t channel = regs[RG_PHY_CC_CCA] & 0x1F;
+
+        freq_mhz = 2405 + 5 * (channel - 11);
+    }
+
+    freq = (uint16_t)(freq_mhz * 2);
+    if ((8 == cc_band) && (regs[RG_TRX_CTRL_0] & 0x10))
+    {
+        freq++;
+    }
+
+    return freq;
+}
+
+
+
+/**
+ * @brief Distance between this node and a position
+ */
+static double distance_to(const double *pos)
+{
+    double dx = pos[0] - node_pos[0];
+    double dy = pos[1] - node_pos[1];
+    double dz = pos[2] - node_pos[2];
+
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+
+
+/**
+ * @brief Energy level of a frame at this node
+ *
+ * @param tx_pwr_dbm Transmit power of the sender
+ * @param pos Position of the sender
+ *
+ * @return ED value (0 if below sensitivity)
+ */
+static uint8_t energy_level(int8_t tx_pwr_dbm, const double *pos)
+{
+    double d = distance_to(pos);
+    double rx_dbm;
+    int ed;
+
+    if (d < 1.0)
+    {
+        d = 1.0;
+    }
+    rx_dbm = tx_pwr_dbm - EMU_PATH_LOSS_1M_DB - 20.0 * log10(d);
+
+    if (rx_dbm < EMU_SENSITIVITY_DBM)
+    {
+        return 0;
+    }
+
+    ed = (int)(rx_dbm + EMU_ED_OFFSET_DB);
+    if (ed < 1)
+    {
+        ed = 1;
+    }
+    if (ed > 84)
+    {
+        ed = 84;
+    }
+
+    return (uint8_t)ed;
+}
+
+
+
+/**
+ * @brief Local oscillator phase offset of a node at a frequency
+ *
+ * @return Phase offset in units of 1/256 of a cycle
+ */
+static uint8_t lo_phase(uint8_t node, uint16_t freq)
+{
+    uint32_t h = ((uint32_t)node * 0x9E3779B1UL) ^ ((uint32_t)freq * 0x85EBCA77UL);
+
+    h ^= h >> 15;
+    h *= 0x2C1B3C6DUL;
+    h ^= h >> 12;
+
+    return (uint8_t)h;
+}
+
+
+
+/**
+ * @brief Phase measured by the PMU
+ *
+ * The phase of the carrier of the peer as measured against the local
+ * oscillator: the propagation delay over the distance d gives
+ * f * d / c cycles, the phase offsets of both oscillators add up.
+ * The sum of the phases measured by both nodes at the same frequency
+ * is 2 * f * d / c (mod 1), which is the basis of the distance
+ * calculation.
+ *
+ * @return Phase in units of 1/256 of a cycle
+ */
+static uint8_t pmu_phase(void)
+{
+    uint16_t freq = current_freq();
+    double f_hz = (double)freq * 500000.0;
+    double cycles;
+    int32_t phase;
+
+    if ((TRX_EMU_BROADCAST == peer_node) || interferer_on(freq))
+    {
+        return (uint8_t)emu_rand();
+    }
+
+    cycles = f_hz * distance_to(peer_pos) / EMU_SPEED_OF_LIGHT;
+    cycles -= floor(cycles);
+
+    phase = (int32_t)lround(cycles * 256.0);
+    phase += lo_phase(peer_node, freq);
+    phase -= lo_phase(node_id, freq);
+
+    if (phase_noise > 0)
+    {
+        phase += (int32_t)(emu_rand() % (2u * phase_noise + 1)) - phase_noise;
+    }
+
+    return (uint8_t)phase;
+}
+
+
+
+/**
+ * @brief Checks whether the interferer is on the air at a frequency
+ *
+ * The interferer is modelled as bursty like Wi-Fi, every call is an
+ * independent draw with the probability of its duty cycle. The random
+ * generator is only used within the band of the interferer.
+ *
+ * @param freq Frequency in units of 500 kHz
+ *
+ * @return true if the interferer is on the air
+ */
+static bool interferer_on(uint16_t freq)
+{
+    if ((0 == interferer_duty) ||
+        (freq < interferer_start_mhz * 2) ||
+        (freq > interferer_stop_mhz * 2))
+    {
+        return false;
+    }
+
+    return ((emu_rand() % 100) < interferer_duty);
+}
+
+
+
+/**
+ * @brief Random numbers of the emulation (xorshift32)
+ */
+static uint32_t emu_rand(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+
+    return rnd_state;
+}
+
+
+
+/**
+ * @brief Reads the host clock shared by all nodes
+ */
+static uint64_t now_us(void)
+{
+    return pal_host_clock_us();
+}
+
+
+
+/**
+ * @brief Arrival time of the first symbol of a frame at this node
+ */
+static uint64_t arrival_us(const trx_emu_frame_t *frame)
+{
+    return frame->start_us +
+           (uint64_t)lround(distance_to(frame->pos) / EMU_SPEED_OF_LIGHT * 1e6);
+}
+
+
+
+/**
+ * @brief End time of a frame at this node
+ */
+static uint64_t frame_end_us(const trx_emu_frame_t *frame)
+{
+    return arrival_us(frame) +
+           ((uint64_t)EMU_SHR_PHR_LEN + frame->psdu_len) * EMU_OCTET_US;
+}
+
+
+
+/**
+ * @brief Energy on the current channel at this node
+ *
+ * @param now Time of the measurement
+ *
+ * @return ED value of the strongest frame on air
+ */
+static uint8_t channel_energy(uint64_t now)
+{
+    uint16_t freq = current_freq();
+    uint8_t energy = 0;
+    uint8_t i;
+
+    if (rx_active)
+    {
+        energy = rx_ed;
+    }
+
+    if (interferer_on(freq))
+    {
+        int ed = interferer_dbm + EMU_ED_OFFSET_DB;
+
+        ed = (ed < 1) ? 1 : ((ed > 84) ? 84 : ed);
+        if ((uint8_t)ed > energy)
+        {
+            energy = (uint8_t)ed;
+        }
+    }
+
+    for (i = 0; i < medium_queue_len; i++)
+    {
+        trx_emu_frame_t *f = &medium_queue[(medium_queue_head + i) % MEDIUM_QUEUE_LEN];
+        uint8_t level;
+
+        if ((MEDIUM_MAGIC != f->magic) || (f->freq != freq) ||
+            (arrival_us(f) > now) || (frame_end_us(f) <= now))
+        {
+            continue;
+        }
+
+        level = energy_level(f->tx_pwr_dbm, f->pos);
+        if (level > energy)
+        {
+            energy = level;
+        }
+    }
+
+    return energy;
+}
+
+
+
+/**
+ * @brief CCA energy threshold in ED units
+ *
+ * The threshold is CCA_ED_THRES * 2 dB above -91 dBm, i.e. 3 ED steps
+ * above the lowest ED value.
+ */
+static uint8_t cca_threshold(void)
+{
+    return (uint8_t)(3 + 2 * (regs[RG_CCA_THRES] & 0x0F));
+}
+
+
+
+/**
+ * @brief Attaches the node to the emulated medium
+ */
+static void medium_init(void)
+{
+    struct sockaddr_in addr;
+
+    medium_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (medium_sock < 0)
+    {
+        perror("AT86RF233 emulation: socket");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)(base_port + node_id));
+
+    if (bind(medium_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("AT86RF233 emulation: bind");
+        exit(EXIT_FAILURE);
+    }
+
+    fcntl(medium_sock, F_SETFL, fcntl(medium_sock, F_GETFL) | O_NONBLOCK);
+}
+
+
+
+/**
+ * @brief Sends a frame to the other nodes
+ *
+ * @param frame Frame to be sent
+ */
+static void medium_send(trx_emu_frame_t *frame)
+{
+    struct sockaddr_in addr;
+    uint8_t node;
+
+    if ((NULL != medium) && (NULL != medium->send))
+    {
+        medium->send(medium->ctx, frame);
+        return;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (node = 0; node < no_of_nodes; node++)
+    {
+        if ((node == node_id) ||
+            ((TRX_EMU_BROADCAST != frame->dst_node) && (node != frame->dst_node)))
+        {
+            continue;
+        }
+        addr.sin_port = htons((uint16_t)(base_port + node));
+        sendto(medium_sock, frame, sizeof(trx_emu_frame_t), 0,
+               (struct sockaddr *)&addr, sizeof(addr));
+    }
+}
+
+
+
+/**
+ * @brief Fetches the frames sent by other nodes
+ */
+static void medium_poll(void)
+{
+    if (medium_sock < 0)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        trx_emu_frame_t frame;
+        ssize_t len = recv(medium_sock, &frame, sizeof(frame), 0);
+
+        if (len < 0)
+        {
+            break;
+        }
+
+        if ((len != (ssize_t)sizeof(frame)) || (MEDIUM_MAGIC != frame.magic) ||
+            (frame.psdu_len > TRX_EMU_MAX_PSDU_LEN))
+        {
+            continue;
+        }
+
+        if (!pin_rst || (TRX_SLEEP == trx_state))
+        {
+            /* Transceiver is not able to receive. */
+            continue;
+        }
+
+        medium_enqueue(&frame);
+    }
+}
+
+
+
+/**
+ * @brief Appends a frame of another node to the receive queue
+ *
+ * @param frame Frame to be queued
+ */
+static void medium_enqueue(const trx_emu_frame_t *frame)
+{
+    if (medium_queue_len == MEDIUM_QUEUE_LEN)
+    {
+        /* Overflow: the oldest frame is lost. */
+        medium_queue_head = (medium_queue_head + 1) % MEDIUM_QUEUE_LEN;
+        medium_queue_len--;
+    }
+    medium_queue[(medium_queue_head + medium_queue_len) % MEDIUM_QUEUE_LEN] = *frame;
+    medium_queue_len++;
+}
+
+/* EOF */
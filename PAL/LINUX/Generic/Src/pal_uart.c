@@ -0,0 +1,341 @@
+/**
+ * @file pal_uart.c
+ *
+ * @brief PAL UART related functions
+ *
+ * This file implements the UART related transmission and reception
+ * functions for hosted Linux builds. Each UART is mapped either to a
+ * pseudo terminal (default) or to stdin/stdout of the process,
+ * see pal_uart.h.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================= */
+
+#if ((defined UART0) || (defined UART1))
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "pal.h"
+#include "pal_config.h"
+#include "pal_uart.h"
+
+/* === Macros =============================================================== */
+
+
+/* === Types ================================================================ */
+
+/*
+ * Host side of an emulated UART
+ */
+typedef struct uart_port_tag
+{
+    /* File descriptor used for reception */
+    int rx_fd;
+    /* File descriptor used for transmission */
+    int tx_fd;
+    /* Slave side of the pseudo terminal, kept open to preserve its settings */
+    int slave_fd;
+} uart_port_t;
+
+/* === Globals ============================================================== */
+
+#if (defined UART0)
+static uart_port_t uart_0_port = { -1, -1, -1 };
+#endif
+
+#if (defined UART1)
+static uart_port_t uart_1_port = { -1, -1, -1 };
+#endif
+
+/* Terminal settings of stdin to be restored on exit */
+static struct termios stdin_termios;
+static bool stdin_termios_saved;
+
+/* === Prototypes =========================================================== */
+
+static void uart_init(uart_port_t *port, const char *mode_env,
+                      const char *link_env, const char *name);
+static uint8_t uart_tx(uart_port_t *port, uint8_t *data, uint8_t length);
+static uint8_t uart_rx(uart_port_t *port, uint8_t *data, uint8_t max_length);
+
+/* === Implementation ======================================================= */
+
+#if (defined UART0)
+/**
+ * @brief Initializes UART 0
+ *
+ * @param baud_rate Baud rate, ignored since there is no physical line
+ */
+void sio_uart_0_init(uint32_t baud_rate)
+{
+    /* Keep compiler happy. */
+    baud_rate = baud_rate;
+
+    uart_init(&uart_0_port, UART_0_ENV_MODE, UART_0_ENV_LINK, "UART0");
+}
+#endif  /* #if (defined UART0) */
+
+
+
+#if (defined UART1)
+/**
+ * @brief Initializes UART 1
+ *
+ * @param baud_rate Baud rate, ignored since there is no physical line
+ */
+void sio_uart_1_init(uint32_t baud_rate)
+{
+    /* Keep compiler happy. */
+    baud_rate = baud_rate;
+
+    uart_init(&uart_1_port, UART_1_ENV_MODE, UART_1_ENV_LINK, "UART1");
+}
+#endif  /* #if (defined UART1) */
+
+
+
+#if (defined UART0)
+/**
+ * @brief Transmit data via UART 0
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length)
+{
+    return uart_tx(&uart_0_port, data, length);
+}
+#endif  /* #if (defined UART0) */
+
+
+
+#if (defined UART1)
+/**
+ * @brief Transmit data via UART 1
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length)
+{
+    return uart_tx(&uart_1_port, data, length);
+}
+#endif  /* #if (defined UART1) */
+
+
+
+#if (defined UART0)
+/**
+ * @brief Receives data from UART 0
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length)
+{
+    return uart_rx(&uart_0_port, data, max_length);
+}
+#endif  /* #if (defined UART0) */
+
+
+
+#if (defined UART1)
+/**
+ * @brief Receives data from UART 1
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length)
+{
+    return uart_rx(&uart_1_port, data, max_length);
+}
+#endif  /* #if (defined UART1) */
+
+
+
+/**
+ * @brief Restores the terminal settings of stdin
+ */
+static void restore_stdin(void)
+{
+    if (stdin_termios_saved)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &stdin_termios);
+    }
+}
+
+
+
+/**
+ * @brief Attaches an emulated UART to its host resource
+ *
+ * @param port UART to be initialized
+ * @param mode_env Name of the environment variable selecting the backend
+ * @param link_env Name of the environment variable holding the symlink path
+ * @param name Name of the UART used in diagnostic messages
+ */
+static void uart_init(uart_port_t *port, const char *mode_env,
+                      const char *link_env, const char *name)
+{
+    const char *mode = getenv(mode_env);
+
+    if ((NULL != mode) && (0 == strcmp(mode, "stdio")))
+    {
+        struct termios tio;
+
+        port->rx_fd = STDIN_FILENO;
+        port->tx_fd = STDOUT_FILENO;
+
+        /* Character wise input without local echo, as seen by a UART. */
+        if (isatty(STDIN_FILENO) && !stdin_termios_saved &&
+            (0 == tcgetattr(STDIN_FILENO, &stdin_termios)))
+        {
+            stdin_termios_saved = true;
+            atexit(restore_stdin);
+            tio = stdin_termios;
+            tio.c_lflag &= ~(ICANON | ECHO);
+            tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        }
+        fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    }
+    else
+    {
+        struct termios tio;
+        const char *link_path = getenv(link_env);
+        int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+        if ((fd < 0) || (0 != grantpt(fd)) || (0 != unlockpt(fd)))
+        {
+            fprintf(stderr, "%s: cannot create pseudo terminal\n", name);
+            exit(EXIT_FAILURE);
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        port->rx_fd = fd;
+        port->tx_fd = fd;
+
+        /*
+         * The slave side is kept open by the process itself, so that
+         * terminal programs can attach and detach at any time. It is
+         * configured for raw byte transfer like a serial line.
+         */
+        port->slave_fd = open(ptsname(fd), O_RDWR | O_NOCTTY);
+        if ((port->slave_fd >= 0) && (0 == tcgetattr(port->slave_fd, &tio)))
+        {
+            cfmakeraw(&tio);
+            tcsetattr(port->slave_fd, TCSANOW, &tio);
+        }
+
+        if (NULL != link_path)
+        {
+            unlink(link_path);
+            if (0 != symlink(ptsname(fd), link_path))
+            {
+                fprintf(stderr, "%s: cannot create link %s\n", name, link_path);
+            }
+        }
+
+        fprintf(stderr, "%s: %s\n", name, ptsname(fd));
+    }
+}
+
+
+
+/**
+ * @brief Transmits data via an emulated UART
+ *
+ * Data that cannot be taken by the pseudo terminal since nobody reads its
+ * slave side are discarded, like a physical UART does without listener.
+ *
+ * @param port UART
+ * @param data Pointer to the data to be transmitted
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+static uint8_t uart_tx(uart_port_t *port, uint8_t *data, uint8_t length)
+{
+    ssize_t written;
+
+    if (port->tx_fd < 0)
+    {
+        return 0;
+    }
+
+    do
+    {
+        written = write(port->tx_fd, data, length);
+    }
+    while ((written < 0) && (EINTR == errno));
+
+    if (written < 0)
+    {
+        if (EAGAIN == errno)
+        {
+            /* Transmit buffer full: the line is not listened to. */
+            return length;
+        }
+        return 0;
+    }
+
+    return (uint8_t)written;
+}
+
+
+
+/**
+ * @brief Receives data from an emulated UART
+ *
+ * @param port UART
+ * @param data Pointer to the buffer where the received data is to be stored
+ * @param max_length Maximum length of data to be received
+ *
+ * @return Actual number of bytes received
+ */
+static uint8_t uart_rx(uart_port_t *port, uint8_t *data, uint8_t max_length)
+{
+    ssize_t received;
+
+    if ((port->rx_fd < 0) || (0 == max_length))
+    {
+        return 0;
+    }
+
+    received = read(port->rx_fd, data, max_length);
+    if (received <= 0)
+    {
+        return 0;
+    }
+
+    return (uint8_t)received;
+}
+
+#endif  /* #if ((defined UART0) || (defined UART1)) */
+
+/* EOF */
@@ -0,0 +1,203 @@
+/**
+ * @file pal_utils.c
+ *
+ * @brief Utilities for PAL for hosted Linux builds
+ *
+ * This file implements the assertion support of the PAL and the stream
+ * binding of the C library as expected by the applications.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "pal.h"
+
+/* === Macros ============================================================== */
+
+#if (DEBUG > 0)
+/**
+ * The event payload can be max 255 bytes, 1 byte goes as length byte
+ * for octetstring and 1 byte as command code
+ */
+#define MAX_OCTETSTRING_SIZE        (253)
+#endif
+
+/* === Types =============================================================== */
+
+/*
+ * Character I/O functions bound to a stream by fdevopen()
+ */
+typedef struct dev_stream_tag
+{
+    int (*put)(char, FILE *);
+    int (*get)(FILE *);
+    FILE *stream;
+} dev_stream_t;
+
+/* === Globals ============================================================= */
+
+#if (DEBUG > 0)
+/* Holds the assert message to be printed. */
+static char tmpbuf[MAX_OCTETSTRING_SIZE];
+#endif
+
+/* Character I/O functions of the stream opened by fdevopen(). */
+static dev_stream_t dev_stream;
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+#if (DEBUG > 0)
+/**
+ * @brief Tests for Assertion
+ *
+ * This function tests the assertion of a given expression and
+ * if the expression fails, a message is printed. This function
+ * is implemented similar to the C library function except
+ * that the processing will not be aborted if the assertion fails.
+ *
+ * @param expression To be tested for assertion
+ * @param message Data to be printed over SIO
+ * @file file File in which assertion has to be tested.
+ * @line line Line number on which assertion has to be tested.
+ */
+void pal_assert(bool expression,
+                FLASH_STRING_T message,
+                int8_t *file,
+                uint16_t line)
+{
+    /*
+     * Assert for the expression. This expression should be true always,
+     * false indicates that something went wrong
+     */
+    if (!expression)
+    {
+        /* Standard for all applications */
+        strncpy(tmpbuf, message, sizeof(tmpbuf) - 1);
+        PRINTF("Assertion Failed on File %s, line %d, expression %s\n",
+               (char *)file, line, tmpbuf);
+    }
+}
+#endif  /* (DEBUG > 0) */
+
+
+
+/**
+ * @brief Cookie write function of the device stream
+ */
+static ssize_t dev_stream_write(void *cookie, const char *buf, size_t size)
+{
+    dev_stream_t *dev = (dev_stream_t *)cookie;
+    size_t i;
+
+    if (NULL == dev->put)
+    {
+        return (ssize_t)size;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        if (0 != dev->put(buf[i], dev->stream))
+        {
+            break;
+        }
+    }
+
+    return (ssize_t)i;
+}
+
+
+
+/**
+ * @brief Cookie read function of the device stream
+ */
+static ssize_t dev_stream_read(void *cookie, char *buf, size_t size)
+{
+    dev_stream_t *dev = (dev_stream_t *)cookie;
+    int c;
+
+    if ((NULL == dev->get) || (0 == size))
+    {
+        return 0;
+    }
+
+    /* Characters are passed one by one like the avr-libc stream does. */
+    c = dev->get(dev->stream);
+    if (c < 0)
+    {
+        return 0;
+    }
+    buf[0] = (char)c;
+
+    return 1;
+}
+
+
+
+/**
+ * @brief Binds character I/O functions to a stream
+ *
+ * This is the counterpart of avr-libc's fdevopen(): the first stream
+ * opened for writing becomes stdout (and stderr is kept for diagnostic
+ * output of the host), the first stream opened for reading becomes stdin.
+ * Both directions are unbuffered, so each character is passed to the
+ * I/O functions immediately.
+ *
+ * @param put Character output function
+ * @param get Character input function
+ *
+ * @return The stream
+ */
+FILE *fdevopen(int (*put)(char, FILE *), int (*get)(FILE *))
+{
+    cookie_io_functions_t io_funcs =
+    {
+        .read = dev_stream_read,
+        .write = dev_stream_write,
+        .seek = NULL,
+        .close = NULL
+    };
+    FILE *stream;
+
+    dev_stream.put = put;
+    dev_stream.get = get;
+
+    stream = fopencookie(&dev_stream, "r+", io_funcs);
+    if (NULL == stream)
+    {
+        return NULL;
+    }
+    dev_stream.stream = stream;
+    setvbuf(stream, NULL, _IONBF, 0);
+
+    if (NULL != put)
+    {
+        stdout = stream;
+    }
+    if (NULL != get)
+    {
+        stdin = stream;
+    }
+
+    return stream;
+}
+
+
+/* EOF */
@@ -0,0 +1,242 @@
+/**
+ * @file pal_board.c
+ *
+ * @brief PAL board specific functionality
+ *
+ * This file implements PAL board specific functionality of the emulated
+ * AT86RF233 board running as Linux process.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pal.h"
+#include "pal_boardtypes.h"
+#include "pal_config.h"
+#include "pal_internal.h"
+#include "pal_timer.h"
+
+#if (BOARD_TYPE == EMU_RF233)
+
+/* === Macros ============================================================== */
+
+/**
+ * Environment variable defining the state of button 0:
+ * A value n > 0 means the button is held for the first n reads and
+ * released afterwards, any other value means released. This allows to
+ * step through selections done by holding the button (e.g. 1 selects the
+ * Initiator, 2 the Reflector within the RTB Eval App).
+ */
+#define BUTTON_ENV                      "PAL_BUTTON0"
+
+/**
+ * Environment variable enabling the trace of LED changes on stderr.
+ */
+#define LED_TRACE_ENV                   "PAL_LED_TRACE"
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/* Current state of the LEDs. */
+static bool led_state[NO_OF_LEDS];
+
+/* Indicates whether LED changes are reported on stderr. */
+static bool led_trace;
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Provides timestamp of the last received frame
+ *
+ * This function provides the timestamp (in microseconds)
+ * of the last received frame.
+ *
+ * @param[out] Timestamp in microseconds
+ */
+void pal_trx_read_timestamp(uint32_t *timestamp)
+{
+    /*
+     * The emulated transceiver latches the system time at every rising
+     * edge of its IRQ pin, which is the equivalent of the input capture.
+     */
+    *timestamp = trx_emu_irq_timestamp();
+}
+
+
+
+/**
+ * @brief Calibrates the internal RC oscillator
+ *
+ * This function calibrates the internal RC oscillator.
+ *
+ * @return True since there is no RC oscillator on the host
+ */
+bool pal_calibrate_rc_osc(void)
+{
+    return (true);
+}
+
+
+
+/**
+ * @brief Initializes the interrupt system
+ */
+void interrupt_system_init(void)
+{
+    DISABLE_GLOBAL_IRQ();
+    DISABLE_TRX_IRQ();
+    pal_trx_irq_pending = false;
+}
+
+
+
+/**
+ * @brief Initializes the GPIO pins
+ *
+ * This function is used to initialize the port pins used to connect
+ * the microcontroller to transceiver.
+ */
+void gpio_init(void)
+{
+    RST_HIGH();
+    SLP_TR_LOW();
+}
+
+
+
+/*
+ * This function is called by timer_init() to perform the non-generic portion
+ * of the initialization of the timer module.
+ */
+void timer_init_non_generic(void)
+{
+    /* Select proper clock as timer clock source when radio is sleeping */
+    TIMER_SRC_DURING_TRX_SLEEP();
+}
+
+
+
+/**
+ * @brief Initialize LEDs
+ */
+void pal_led_init(void)
+{
+    const char *env = getenv(LED_TRACE_ENV);
+
+    led_trace = ((NULL != env) && (0 == strcmp(env, "1")));
+
+    /* initially off */
+    memset(led_state, 0, sizeof(led_state));
+}
+
+
+
+/**
+ * @brief Control LED status
+ *
+ * @param[in]  led_no LED ID
+ * @param[in]  led_setting LED_ON, LED_OFF, LED_TOGGLE
+ */
+void pal_led(led_id_t led_no, led_action_t led_setting)
+{
+    bool old_state;
+
+    if (led_no >= NO_OF_LEDS)
+    {
+        led_no = LED_0;
+    }
+
+    old_state = led_state[led_no];
+
+    switch (led_setting)
+    {
+        case LED_ON:
+            led_state[led_no] = true;
+            break;
+
+        case LED_OFF:
+            led_state[led_no] = false;
+            break;
+
+        case LED_TOGGLE:
+        default:
+            led_state[led_no] = !led_state[led_no];
+            break;
+    }
+
+    if (led_trace && (old_state != led_state[led_no]))
+    {
+        fprintf(stderr, "LED%u %s\n", (unsigned)led_no,
+                led_state[led_no] ? "on" : "off");
+    }
+}
+
+
+
+/**
+ * @brief Initialize the button
+ */
+void pal_button_init(void)
+{
+    /* Nothing to be done, the button state is read from the environment. */
+}
+
+
+
+/**
+ * @brief Read button
+ *
+ * @param button_no Button ID
+ */
+button_state_t pal_button_read(button_id_t button_no)
+{
+    static int button_reads;
+    const char *env = getenv(BUTTON_ENV);
+
+    /* Keep compiler happy. */
+    button_no = button_no;
+
+    if ((NULL != env) && (button_reads < atoi(env)))
+    {
+        button_reads++;
+        return BUTTON_PRESSED;
+    }
+    else
+    {
+        return BUTTON_OFF;
+    }
+}
+
+
+
+/**
+ * @brief Prepare the system for sleep
+ *
+ * There is no MCU sleep mode on the host, the function returns immediately.
+ */
+void pal_sleep_mode(uint8_t sleep_mode)
+{
+    /* Keep compiler happy. */
+    sleep_mode = sleep_mode;
+}
+
+#endif /* EMU_RF233 */
+
+/* EOF */
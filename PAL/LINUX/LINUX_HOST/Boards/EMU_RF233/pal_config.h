@@ -0,0 +1,339 @@
+/**
+ * @file pal_config.h
+ *
+ * @brief PAL configuration for the emulated AT86RF233 on a Linux host
+ *
+ * This header file contains configuration parameters for the PAL running
+ * as Linux process with a software model of the AT86RF233.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_CONFIG_H
+#define PAL_CONFIG_H
+
+/* === Includes =============================================================*/
+
+#include "pal_boardtypes.h"
+
+#if (BOARD_TYPE == EMU_RF233)
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * This header file is required since a function with
+ * return type retval_t is declared
+ */
+#include "return_val.h"
+#include "pal_trx_emu.h"
+
+/* === Types ================================================================*/
+
+/** Enumerations used to identify LEDs. */
+typedef enum led_id_tag
+{
+    LED_0,
+    LED_1,
+    LED_2
+} SHORTENUM led_id_t;
+
+/** Number of LEDs on this board. */
+#define NO_OF_LEDS                      (3)
+
+
+/** Enumerations used to identify buttons */
+typedef enum button_id_tag
+{
+    BUTTON_0
+} SHORTENUM button_id_t;
+
+/** Number of buttons on this board. */
+#define NO_OF_BUTTONS                   (1)
+
+/* === Externals ============================================================*/
+
+/*
+ * Emulated interrupt controller, see pal_irq.c.
+ */
+extern volatile bool pal_global_irq_flag;
+extern volatile bool pal_trx_irq_enabled;
+extern volatile bool pal_trx_irq_pending;
+
+extern void pal_irq_service(void);
+
+/* === Macros ===============================================================*/
+
+/**
+ * This board doesn't use Antenna Diversity.
+ * The antenna diversity support can be overwritten by Makefile setting.
+ */
+#ifndef ANTENNA_DIVERSITY
+#define ANTENNA_DIVERSITY               (0)
+#endif
+
+/**
+ * The emulated transceiver does not provide the timestamp interrupt (DIG2).
+ * The timestamp of the IRQ pin edge is used instead.
+ */
+#ifndef DISABLE_TSTAMP_IRQ
+#define DISABLE_TSTAMP_IRQ              (1)
+#endif
+
+/** Autonomous antenna selection is used as default. */
+#ifndef ANTENNA_DEFAULT
+#define ANTENNA_DEFAULT                 (ANT_CTRL_0)
+#endif
+
+/**
+ * Value of an external PA gain.
+ * If no external PA is available, the value is 0.
+ */
+#define EXTERN_PA_GAIN                  (0)
+
+/*
+ * IRQ macros for the Linux host
+ *
+ * There is no interrupt controller, the interrupt enable flags are plain
+ * variables. A pending transceiver interrupt is executed by
+ * pal_irq_service() as soon as both flags allow it.
+ */
+
+/** Enables the transceiver main interrupt. */
+#define ENABLE_TRX_IRQ()                do {                        \
+        pal_trx_irq_enabled = true;                                 \
+        pal_irq_service();                                          \
+    } while (0)
+
+/** Disables the transceiver main interrupt. */
+#define DISABLE_TRX_IRQ()               (pal_trx_irq_enabled = false)
+
+/** Clears the transceiver main interrupt. */
+#define CLEAR_TRX_IRQ()                 do {                        \
+        (void)trx_emu_get_irq_edge();                               \
+        pal_trx_irq_pending = false;                                \
+    } while (0)
+
+
+/** Enables the global interrupts. */
+#define ENABLE_GLOBAL_IRQ()             do {                        \
+        pal_global_irq_flag = true;                                 \
+        pal_irq_service();                                          \
+    } while (0)
+
+/** Disables the global interrupts. */
+#define DISABLE_GLOBAL_IRQ()            (pal_global_irq_flag = false)
+
+/**
+ * This macro saves the global interrupt status.
+ */
+#define ENTER_CRITICAL_REGION()         {bool sreg = pal_global_irq_flag; pal_global_irq_flag = false
+
+/**
+ *  This macro restores the global interrupt status.
+ */
+#define LEAVE_CRITICAL_REGION()         pal_global_irq_flag = sreg; pal_irq_service();}
+
+/**
+ * This macro saves the trx interrupt status and disables the trx interrupt.
+ */
+#define ENTER_TRX_REGION()      { bool irq_mask = pal_trx_irq_enabled; pal_trx_irq_enabled = false
+
+/**
+ *  This macro restores the transceiver interrupt status.
+ */
+#define LEAVE_TRX_REGION()      pal_trx_irq_enabled = irq_mask; pal_irq_service(); }
+
+
+/*
+ * GPIO macros for the Linux host
+ */
+
+/**
+ * This board uses an SPI-attached transceiver.
+ * The SPI accesses are mapped to the transceiver emulation.
+ */
+#define PAL_USE_SPI_TRX                 (1)
+
+/**
+ * IRQ pin access
+ */
+#define IRQ_PINGET()                    (trx_emu_get_irq())
+
+/*
+ * Set TRX GPIO pins.
+ */
+/** Set TRX_RST pin to high. */
+#define RST_HIGH()                      trx_emu_set_rst(true)
+/** Set TRX_RST pin to low. */
+#define RST_LOW()                       trx_emu_set_rst(false)
+/** Set SLP_TR pin to high. */
+#define SLP_TR_HIGH()                   trx_emu_set_slp_tr(true)
+/** Set SLP_TR pin to low. */
+#define SLP_TR_LOW()                    trx_emu_set_slp_tr(false)
+
+/*
+ * Timer macros for the Linux host
+ *
+ * The transceiver emulation has no timing constraints on the pin accesses,
+ * hence the short delays are empty.
+ */
+/* Wait for 65 ns. */
+#define PAL_WAIT_65_NS()
+/* Wait for 500 ns. */
+#define PAL_WAIT_500_NS()
+/* Wait for 1 us. */
+#define PAL_WAIT_1_US()
+
+/**
+ * The smallest timeout in microseconds
+ */
+#define MIN_TIMEOUT                     (0x80)
+
+/**
+ * The largest timeout in microseconds
+ */
+#define MAX_TIMEOUT                     (0x7FFFFFFF)
+
+/**
+ * Minimum time in microseconds, accepted as a delay request
+ */
+#define MIN_DELAY_VAL                   (5)
+
+/**
+ * Timer clock source while radio is awake.
+ *
+ * The system time is always derived from the monotonic clock of the host.
+ */
+#define TIMER_SRC_DURING_TRX_AWAKE()
+
+/**
+ * Timer clock source while radio is sleeping.
+ */
+#define TIMER_SRC_DURING_TRX_SLEEP()
+
+/**
+ * Maximum numbers of software timers running at a time
+ */
+#define MAX_NO_OF_TIMERS                (25)
+#if (MAX_NO_OF_TIMERS > 255)
+#error "MAX_NO_OF_TIMERS must not be larger than 255"
+#endif
+
+
+/*
+ * TRX Access macros for the Linux host
+ */
+
+/**
+ * TRX Initialization
+ */
+#define TRX_INIT()                      trx_emu_init()
+
+/**
+ * CRC-CCITT update as provided by avr-libc's _crc_ccitt_update().
+ */
+#define CRC_CCITT_UPDATE(crc, data)     crc_ccitt_update(crc, data)
+
+static inline uint16_t crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+    data ^= (uint8_t)(crc & 0xFF);
+    data ^= (uint8_t)(data << 4);
+
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^
+            (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+/**
+ * The IEEE address is stored in the (emulated) user signature row.
+ */
+#ifndef EXTERN_EEPROM_AVAILABLE
+#define EXTERN_EEPROM_AVAILABLE            (0)
+#endif
+#ifndef USER_SIGN_AVAILABLE
+#define USER_SIGN_AVAILABLE           (1)
+#endif
+
+/**
+ * Last address of the internal EEPROM, which is kept in a file.
+ */
+#define E2END                           (0x0FFF)
+
+/**
+ * Page size of the internal EEPROM, as of the ATxmega256A3U.
+ */
+#define EEPROM_PAGE_SIZE                (32)
+
+/**
+ * Address range of the user signature row.
+ */
+#define USER_SIGNATURES_START           (0x0000)
+#define USER_SIGNATURES_END             (0x01FF)
+
+/**
+ * Storage location for crystal trim value - within external EEPROM
+ */
+#define EE_XTAL_TRIM_ADDR                  (21)
+
+/**
+ * Alert initialization
+ */
+#define ALERT_INIT()                    do {    \
+        fprintf(stderr, "PAL alert\n");         \
+    } while (0)
+
+/**
+ * Alert indication
+ */
+#define ALERT_INDICATE()                do {    \
+        pal_led(LED_0, LED_TOGGLE);             \
+        pal_led(LED_1, LED_TOGGLE);             \
+        pal_led(LED_2, LED_TOGGLE);             \
+    } while (0)
+
+/**
+ * Sleep configurations
+ *
+ * The MCU sleep modes are not available on the host.
+ */
+#define CONFIGURE_SLEEP( sleep_mode )
+#define DISABLE_SLEEP()
+#define pal_pwr_mode(x)
+#define CPU_SLEEP()
+
+
+/**
+ * If ranging is enabled define the distance offset for this board in cm.
+ * The valid range is -128...127 (cm).
+ * The emulated transceiver has no group delay, hence there is no offset.
+ */
+#if defined(ENABLE_RTB) || defined(DOXYGEN)
+#define DISTANCE_OFFSET                 (0)
+#if ((DISTANCE_OFFSET < INT8_MIN) || (DISTANCE_OFFSET > INT8_MAX))
+#   error "Invalid Distance Offset"
+#endif
+#endif  /* ENABLE_RTB */
+
+/* === Prototypes ===========================================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* EMU_RF233 */
+
+#endif  /* PAL_CONFIG_H */
+/* EOF */
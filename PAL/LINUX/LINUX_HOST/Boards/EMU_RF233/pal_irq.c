@@ -0,0 +1,124 @@
+/**
+ * @file pal_irq.c
+ *
+ * @brief PAL IRQ functionality
+ *
+ * This file contains functions to initialize, enable, disable and install
+ * handler for the transceiver interrupts.
+ * Since a Linux process has no interrupts, the interrupt controller of the
+ * MCU is emulated: the transceiver interrupt handler is executed
+ * synchronously by pal_irq_service() whenever the emulated IRQ line has
+ * seen a rising edge and both the transceiver and the global interrupts
+ * are enabled.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "pal_boardtypes.h"
+#include "pal_internal.h"
+
+#if (BOARD_TYPE == EMU_RF233)
+
+/* === Types ============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/* Global interrupt enable flag (I-bit of the status register). */
+volatile bool pal_global_irq_flag;
+
+/* Transceiver interrupt enable flag (port interrupt level). */
+volatile bool pal_trx_irq_enabled;
+
+/* Transceiver interrupt flag (port interrupt flag). */
+volatile bool pal_trx_irq_pending;
+
+/* Set while the transceiver interrupt handler is executed. */
+static bool in_isr;
+
+/*
+ * Function pointers to store the callback function of
+ * the transceiver interrupt
+ */
+static irq_handler_t irq_hdl_trx;
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the transceiver main interrupt
+ *
+ * This function installs the handler for the transceiver main interrupt.
+ *
+ * @param trx_irq_cb Callback function for the transceiver main
+ * interrupt
+ */
+void pal_trx_irq_init(FUNC_PTR(trx_irq_cb))
+{
+    /*
+     * Set the handler function.
+     * The handler is set before enabling the interrupt to prepare for spurious
+     * interrupts, that can pop up the moment they are enabled
+     */
+    irq_hdl_trx = (irq_handler_t)trx_irq_cb;
+
+    /* Clear pending interrupts */
+    CLEAR_TRX_IRQ();
+}
+
+
+
+/**
+ * @brief Services pending emulated interrupts
+ */
+void pal_irq_service(void)
+{
+    if (in_isr)
+    {
+        return;
+    }
+
+    /* Latch a rising edge of the IRQ pin into the interrupt flag. */
+    if (trx_emu_get_irq_edge())
+    {
+        pal_trx_irq_pending = true;
+    }
+
+    while (pal_trx_irq_pending && pal_trx_irq_enabled && pal_global_irq_flag &&
+           (NULL != irq_hdl_trx))
+    {
+        /* The interrupt flag is cleared by entering the ISR. */
+        pal_trx_irq_pending = false;
+
+        /* The ISR is executed with the global interrupts disabled. */
+        in_isr = true;
+        pal_global_irq_flag = false;
+        irq_hdl_trx();
+        pal_global_irq_flag = true;
+        in_isr = false;
+
+        if (trx_emu_get_irq_edge())
+        {
+            pal_trx_irq_pending = true;
+        }
+    }
+}
+
+#endif /* EMU_RF233 */
+
+/* EOF */
@@ -0,0 +1,44 @@
+/**
+ * @file pal_boardtypes.h
+ *
+ * @brief PAL board types for hosted Linux builds
+ *
+ * This header file contains board types for the PAL running as
+ * Linux process.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_BOARDTYPES_H
+#define PAL_BOARDTYPES_H
+
+/* === Includes ============================================================= */
+
+#if defined(VENDOR_BOARDTYPES) && (VENDOR_BOARDTYPES != 0)
+#include "vendor_boardtypes.h"
+#else   /* Use standard board types as defined below. */
+
+/* === Macros =============================================================== */
+
+/* Boards for AT86RF233 */
+
+/* Linux host with
+ * - software model of the AT86RF233 (see pal_trx_emu.c)
+ * - UDP based radio medium shared between several processes
+ */
+#define EMU_RF233                   (0x01)
+
+#endif  /* #if defined(VENDOR_BOARDTYPES) && (VENDOR_BOARDTYPES != 0) */
+
+#endif  /* PAL_BOARDTYPES_H */
+
+/* EOF */
@@ -43,6 +43,11 @@ typedef struct timer_info_tag
 
     /* Next timer which was started or has expired */
     uint_fast8_t next_timer_in_queue;
+
+#ifdef PAL_TIMER_HEAP
+    /* Position in the running timer heap, NO_TIMER if not running */
+    uint_fast8_t heap_index;
+#endif
 } timer_info_t;
 
 /*
@@ -19,11 +19,35 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "pal.h"
 #include "pal_config.h"
 #include "pal_timer.h"
 #include "pal_internal.h"
 
+/* === Macros ============================================================== */
+
+#ifdef PAL_PS_STORE
+/** Length of the header of a record: sequence number and length */
+#define PS_STORE_HEADER_LEN             (3)
+
+/** Length of the CRC of a record */
+#define PS_STORE_CRC_LEN                (2)
+
+/** Slot of the record store that holds no valid record */
+#define PS_STORE_NO_SLOT                (0xFF)
+
+/** Reads one byte of the internal EEPROM */
+#define PS_STORE_READ(addr)             eeprom_read_byte((uint8_t *)(addr))
+
+#if (PAL_PS_STORE_PAGES > 32)
+#   error "The record store supports up to 32 EEPROM pages"
+#endif
+#if ((PAL_PS_STORE_START + PAL_PS_STORE_PAGES * EEPROM_PAGE_SIZE) > (E2END + 1))
+#   error "The record store exceeds the internal EEPROM"
+#endif
+#endif  /* PAL_PS_STORE */
+
 /* === Globals ============================================================= */
 
 /*
@@ -37,6 +61,26 @@
  */
 volatile uint16_t sys_time;
 
+#ifdef PAL_PS_STORE
+/* Sequence number of the newest record of the record store. */
+static uint16_t ps_store_seq;
+
+/* Slot of the newest record of the record store. */
+static uint8_t ps_store_slot = PS_STORE_NO_SLOT;
+
+/* Data of the stored or staged record. */
+static uint8_t ps_store_data[PAL_PS_STORE_MAX_LEN];
+
+/* Length of the stored or staged record, 0 if none is known. */
+static uint8_t ps_store_len;
+
+/* A staged record waits for pal_ps_store_commit(). */
+static bool ps_store_pending_record;
+
+/* The record store has been scanned for its newest record. */
+static bool ps_store_scanned;
+#endif  /* PAL_PS_STORE */
+
 /* === Prototypes ========================================================== */
 
 static uint8_t eeprom_read_byte(uint8_t *addr);
@@ -46,6 +90,11 @@ static void eeprom_flush_buffer(void);
 #ifndef __ICCAVR__
 static inline void NVM_EXEC();
 #endif
+#ifdef PAL_PS_STORE
+static void eeprom_write_page(uint16_t page_addr, const uint8_t *data);
+static uint8_t ps_store_slot_pages(uint8_t length);
+static bool ps_store_scan(uint8_t length, uint8_t *value);
+#endif
 
 #ifdef EXTERNAL_OSC
 //#define FREQ_OUT_PORT  (PORTD)
@@ -202,6 +251,10 @@ void pal_task(void)
 #if (TOTAL_NUMBER_OF_TIMERS > 0)
     timer_service();
 #endif
+
+#if (defined SIO_HUB) && (defined PAL_SIO_TX_RING)
+    pal_sio_tx_ring_service();
+#endif
 }
 
 
@@ -359,6 +412,38 @@ static void eeprom_write_byte(uint8_t addr, uint8_t value)
     NVM_EXEC();
 }
 
+#ifdef PAL_PS_STORE
+/**
+ * @brief Writes one complete EEPROM page
+ *
+ * The page buffer is loaded with all bytes of the page, which are then
+ * written by a single erase and write operation of the page.
+ *
+ * @param page_addr EEPROM address of the page
+ * @param data Data of the page, EEPROM_PAGE_SIZE bytes
+ */
+static void eeprom_write_page(uint16_t page_addr, const uint8_t *data)
+{
+    eeprom_flush_buffer();
+    NVM.CMD = NVM_CMD_LOAD_EEPROM_BUFFER_gc;
+    NVM.ADDR1 = (page_addr >> 8) & 0x1F;
+    NVM.ADDR2 = 0x00;
+
+    for (uint8_t i = 0; i < EEPROM_PAGE_SIZE; i++)
+    {
+        NVM.ADDR0 = (page_addr + i) & 0xFF;
+        /* Loading the data triggers the loading of the page buffer. */
+        NVM.DATA0 = data[i];
+    }
+
+    NVM.ADDR0 = page_addr & 0xFF;
+    NVM.CMD = NVM_CMD_ERASE_WRITE_EEPROM_PAGE_gc;
+    NVM_EXEC();
+}
+#endif  /* PAL_PS_STORE */
+
+
+
 uint8_t ReadUserSigByte( uint8_t index ){
 	uint8_t result;
 
@@ -472,6 +557,251 @@ retval_t pal_ps_set(uint16_t start_addr, uint16_t length, void *value)
 }
 
 
+#ifdef PAL_PS_STORE
+/**
+ * @brief Gets the number of EEPROM pages of a slot of the record store
+ *
+ * A slot holds the header (sequence number, length), the data and the CRC.
+ */
+static uint8_t ps_store_slot_pages(uint8_t length)
+{
+    return (uint8_t)((PS_STORE_HEADER_LEN + length + PS_STORE_CRC_LEN +
+                      EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE);
+}
+
+
+
+/**
+ * @brief Finds the newest valid record of the record store
+ *
+ * @param length Length of the data of the records
+ * @param[out] value Data of the record, NULL if not needed
+ *
+ * @return true if a valid record was found
+ */
+static bool ps_store_scan(uint8_t length, uint8_t *value)
+{
+    uint8_t slot_pages = ps_store_slot_pages(length);
+    uint8_t no_of_slots = PAL_PS_STORE_PAGES / slot_pages;
+    uint32_t checked = 0;
+
+    ps_store_scanned = true;
+    ps_store_slot = PS_STORE_NO_SLOT;
+
+    while (true)
+    {
+        uint8_t best = PS_STORE_NO_SLOT;
+        uint16_t best_seq = 0;
+        uint16_t addr;
+        uint16_t crc = 0;
+        uint8_t i;
+
+        /* Find the newest unchecked record by its header only. */
+        for (uint8_t slot = 0; slot < no_of_slots; slot++)
+        {
+            uint16_t slot_addr = PAL_PS_STORE_START +
+                                 (uint16_t)slot * slot_pages * EEPROM_PAGE_SIZE;
+            uint16_t seq;
+
+            if (checked & (1UL << slot))
+            {
+                continue;
+            }
+            if (PS_STORE_READ(slot_addr + 2) != length)
+            {
+                /* Erased slot or record of another length */
+                checked |= (1UL << slot);
+                continue;
+            }
+
+            seq = PS_STORE_READ(slot_addr) |
+                  ((uint16_t)PS_STORE_READ(slot_addr + 1) << 8);
+            /* The sequence numbers wrap around, hence the difference decides. */
+            if ((PS_STORE_NO_SLOT == best) || ((int16_t)(seq - best_seq) > 0))
+            {
+                best = slot;
+                best_seq = seq;
+            }
+        }
+
+        if (PS_STORE_NO_SLOT == best)
+        {
+            return false;
+        }
+        checked |= (1UL << best);
+
+        /* Verify the CRC of the header and the data. */
+        addr = PAL_PS_STORE_START + (uint16_t)best * slot_pages * EEPROM_PAGE_SIZE;
+        for (i = 0; i < PS_STORE_HEADER_LEN; i++)
+        {
+            crc = CRC_CCITT_UPDATE(crc, PS_STORE_READ(addr++));
+        }
+        for (i = 0; i < length; i++)
+        {
+            uint8_t data = PS_STORE_READ(addr++);
+
+            crc = CRC_CCITT_UPDATE(crc, data);
+            if (NULL != value)
+            {
+                value[i] = data;
+            }
+        }
+
+        if (((uint16_t)PS_STORE_READ(addr) |
+             ((uint16_t)PS_STORE_READ(addr + 1) << 8)) == crc)
+        {
+            ps_store_slot = best;
+            ps_store_seq = best_seq;
+            return true;
+        }
+    }
+}
+
+
+
+retval_t pal_ps_store_load(void *value, uint8_t length)
+{
+    if ((0 == length) || (length > PAL_PS_STORE_MAX_LEN))
+    {
+        return FAILURE;
+    }
+
+    if (!ps_store_scan(length, (uint8_t *)value))
+    {
+        return FAILURE;
+    }
+
+    /* The loaded record is the stored one. */
+    memcpy(ps_store_data, value, length);
+    ps_store_len = length;
+    ps_store_pending_record = false;
+
+    return MAC_SUCCESS;
+}
+
+
+
+retval_t pal_ps_store_save(const void *value, uint8_t length)
+{
+    if ((0 == length) || (length > PAL_PS_STORE_MAX_LEN))
+    {
+        return FAILURE;
+    }
+
+    if (!ps_store_pending_record && (length == ps_store_len) &&
+        (0 == memcmp(ps_store_data, value, length)))
+    {
+        /* Unchanged */
+        return MAC_SUCCESS;
+    }
+
+    memcpy(ps_store_data, value, length);
+    ps_store_len = length;
+    ps_store_pending_record = true;
+
+    return MAC_SUCCESS;
+}
+
+
+
+bool pal_ps_store_pending(void)
+{
+    return ps_store_pending_record;
+}
+
+
+
+void pal_ps_store_commit(void)
+{
+    uint8_t page[EEPROM_PAGE_SIZE];
+    uint8_t slot_pages;
+    uint8_t no_of_slots;
+    uint16_t page_addr;
+    uint16_t crc = 0;
+    uint16_t pos = 0;
+    uint16_t record_len;
+
+    if (!ps_store_pending_record)
+    {
+        return;
+    }
+
+    slot_pages = ps_store_slot_pages(ps_store_len);
+    no_of_slots = PAL_PS_STORE_PAGES / slot_pages;
+    record_len = PS_STORE_HEADER_LEN + ps_store_len + PS_STORE_CRC_LEN;
+
+    if (!ps_store_scanned)
+    {
+        ps_store_scan(ps_store_len, NULL);
+    }
+
+    /* The record goes into the slot following the newest record. */
+    if (PS_STORE_NO_SLOT == ps_store_slot)
+    {
+        ps_store_slot = 0;
+        ps_store_seq = 0;
+    }
+    else
+    {
+        ps_store_slot = (ps_store_slot + 1) % no_of_slots;
+        ps_store_seq++;
+    }
+
+    page_addr = PAL_PS_STORE_START +
+                (uint16_t)ps_store_slot * slot_pages * EEPROM_PAGE_SIZE;
+
+    for (uint8_t p = 0; p < slot_pages; p++)
+    {
+        for (uint8_t i = 0; i < EEPROM_PAGE_SIZE; i++, pos++)
+        {
+            uint8_t data;
+
+            if (pos == 0)
+            {
+                data = (uint8_t)ps_store_seq;
+            }
+            else if (pos == 1)
+            {
+                data = (uint8_t)(ps_store_seq >> 8);
+            }
+            else if (pos == 2)
+            {
+                data = ps_store_len;
+            }
+            else if (pos < (record_len - PS_STORE_CRC_LEN))
+            {
+                data = ps_store_data[pos - PS_STORE_HEADER_LEN];
+            }
+            else if (pos == (record_len - PS_STORE_CRC_LEN))
+            {
+                data = (uint8_t)crc;
+            }
+            else if (pos == (record_len - 1))
+            {
+                data = (uint8_t)(crc >> 8);
+            }
+            else
+            {
+                /* Remainder of the last page */
+                data = 0xFF;
+            }
+
+            if (pos < (record_len - PS_STORE_CRC_LEN))
+            {
+                crc = CRC_CCITT_UPDATE(crc, data);
+            }
+            page[i] = data;
+        }
+
+        eeprom_write_page(page_addr, page);
+        page_addr += EEPROM_PAGE_SIZE;
+    }
+
+    ps_store_pending_record = false;
+}
+#endif  /* PAL_PS_STORE */
+
+
 /*
  * @brief Alert indication
  *
@@ -5,6 +5,14 @@
  *
  * This file implements timer related functions for AVR ATxmega MCUs.
  *
+ * By default the running timers are kept in a list sorted by expiry time,
+ * so starting a timer walks the list with interrupts disabled. With
+ * PAL_TIMER_HEAP they are kept in a binary heap instead, which starts and
+ * stops a timer in O(log n), but calls timers with the same expiry time in
+ * undefined order. With PAL_TIMER_STATS the longest critical
+ * region and the lateness of the callbacks are recorded, see
+ * pal_timer_get_stats().
+ *
  * $Id: pal_timer.c 33806 2012-11-09 15:53:06Z uwalter $
  *
  * @author    Atmel Corporation: http://www.atmel.com
@@ -27,6 +35,19 @@
 #include "pal_timer.h"
 #include "app_config.h"
 
+/* === Macros =============================================================== */
+
+#ifdef PAL_TIMER_STATS
+/* Critical region of the timer module, its duration is recorded. */
+#define TIMER_ENTER_CRITICAL_REGION()   ENTER_CRITICAL_REGION(); \
+                                        uint32_t critical_start = gettime()
+#define TIMER_LEAVE_CRITICAL_REGION()   timer_stats_critical(critical_start); \
+                                        LEAVE_CRITICAL_REGION()
+#else
+#define TIMER_ENTER_CRITICAL_REGION()   ENTER_CRITICAL_REGION()
+#define TIMER_LEAVE_CRITICAL_REGION()   LEAVE_CRITICAL_REGION()
+#endif
+
 /* === Globals ============================================================== */
 
 /*
@@ -64,6 +85,20 @@ static uint_fast8_t expired_timer_queue_head;
 /* This is the reference to the tail of the expired timer queue. */
 static uint_fast8_t expired_timer_queue_tail;
 
+#ifdef PAL_TIMER_HEAP
+/*
+ * The running timers as binary min-heap ordered by their expiry time.
+ * The root is also referenced by running_timer_queue_head, the number of
+ * entries is running_timers.
+ */
+static uint8_t running_timer_heap[TOTAL_NUMBER_OF_TIMERS];
+#endif
+
+#ifdef PAL_TIMER_STATS
+/* Run time statistics of the timer module */
+static pal_timer_stats_t timer_stats;
+#endif
+
 #endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
 
 /* === Prototypes =========================================================== */
@@ -74,6 +109,15 @@ static void start_absolute_timer(uint8_t timer_id,
                                  uint32_t point_in_time,
                                  FUNC_PTR(handler_cb),
                                  void *parameter);
+#ifdef PAL_TIMER_HEAP
+static void heap_sift_up(uint_fast8_t index);
+static void heap_sift_down(uint_fast8_t index);
+static void heap_insert(uint8_t timer_id);
+static void heap_remove(uint_fast8_t index);
+#endif
+#ifdef PAL_TIMER_STATS
+static void timer_stats_critical(uint32_t start);
+#endif
 #endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
 static inline uint32_t gettime(void);
 
@@ -111,24 +155,28 @@ static inline bool compare_time(uint32_t t1, uint32_t t2)
  */
 void timer_service(void)
 {
-    ENTER_CRITICAL_REGION();
+    TIMER_ENTER_CRITICAL_REGION();
     internal_timer_handler();
-    LEAVE_CRITICAL_REGION();
+    TIMER_LEAVE_CRITICAL_REGION();
 
     /*
      * Process expired timers.
      * Call the callback functions of the expired timers in the order of their
-     * expiry.
+     * expiry. With PAL_TIMER_HEAP the order of timers with the same expiry
+     * time is undefined.
      */
     {
         timer_expiry_cb_t callback;
         void *callback_param;
         uint8_t next_expired_timer;
+#ifdef PAL_TIMER_STATS
+        uint32_t expiry;
+#endif
 
         /* Expired timer if any will be processed here */
         while (NO_TIMER != expired_timer_queue_head)
         {
-            ENTER_CRITICAL_REGION();
+            TIMER_ENTER_CRITICAL_REGION();
 
             next_expired_timer = timer_array[expired_timer_queue_head].next_timer_in_queue;
 
@@ -138,6 +186,10 @@ void timer_service(void)
             /* Callback parameter is stored */
             callback_param = timer_array[expired_timer_queue_head].param_cb;
 
+#ifdef PAL_TIMER_STATS
+            expiry = timer_array[expired_timer_queue_head].abs_exp_timer;
+#endif
+
             /*
              * The expired timer's structure elements are updated and the timer
              * is taken out of expired timer queue
@@ -157,10 +209,25 @@ void timer_service(void)
                 expired_timer_queue_tail = NO_TIMER;
             }
 
-            LEAVE_CRITICAL_REGION();
+            TIMER_LEAVE_CRITICAL_REGION();
 
             if (NULL != callback)
             {
+#ifdef PAL_TIMER_STATS
+                uint32_t now = gettime();
+                uint32_t lateness = 0;
+
+                if (compare_time(expiry, now))
+                {
+                    lateness = SUB_TIME(now, expiry);
+                }
+                if (lateness > timer_stats.max_lateness_us)
+                {
+                    timer_stats.max_lateness_us = lateness;
+                }
+                timer_stats.sum_lateness_us += lateness;
+                timer_stats.callbacks++;
+#endif
                 /* Callback function is called */
                 callback(callback_param);
             }
@@ -285,11 +352,27 @@ retval_t pal_timer_stop(uint8_t timer_id)
         return (PAL_TMR_INVALID_ID);
     }
 
-    ENTER_CRITICAL_REGION();
+    TIMER_ENTER_CRITICAL_REGION();
 
     /* Check if any timer has expired. */
     internal_timer_handler();
 
+#ifdef PAL_TIMER_HEAP
+    /* A running timer is removed from the heap directly. */
+    if (NO_TIMER != timer_array[timer_id].heap_index)
+    {
+        timer_stop_request_status = true;
+        heap_remove(timer_array[timer_id].heap_index);
+        if (timer_id == running_timer_queue_head)
+        {
+            /* The timer was the root, so OCR needs to be reloaded. */
+            running_timer_queue_head = (running_timers > 0) ?
+                                       running_timer_heap[0] : NO_TIMER;
+            prog_ocr();
+        }
+        timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+    }
+#else
     /* The requested timer is first searched in the running timer queue */
     if (running_timers > 0)
     {
@@ -337,6 +420,7 @@ retval_t pal_timer_stop(uint8_t timer_id)
             running_timers--;
         }
     }
+#endif  /* PAL_TIMER_HEAP */
 
     /*
      * The requested timer is not present in the running timer queue.
@@ -409,7 +493,7 @@ retval_t pal_timer_stop(uint8_t timer_id)
         timer_array[timer_id].timer_cb = NULL;
     }
 
-    LEAVE_CRITICAL_REGION();
+    TIMER_LEAVE_CRITICAL_REGION();
 
     if (timer_stop_request_status)
     {
@@ -446,7 +530,14 @@ void timer_init(void)
     {
         timer_array[index].next_timer_in_queue = NO_TIMER;
         timer_array[index].timer_cb = NULL;
+#ifdef PAL_TIMER_HEAP
+        timer_array[index].heap_index = NO_TIMER;
+#endif
     }
+
+#ifdef PAL_TIMER_STATS
+    timer_stats = (pal_timer_stats_t){ 0 };
+#endif
 #endif  /* #if (TOTAL_NUMBER_OF_TIMERS > 0) */
 
     /* Do non-generic/PAL specific actions here. */
@@ -713,14 +804,20 @@ void internal_timer_handler(void)
                 expired_timer_queue_tail = running_timer_queue_head;
             }
 
+#ifdef PAL_TIMER_HEAP
+            heap_remove(0);
+            running_timer_queue_head = (running_timers > 0) ?
+                                       running_timer_heap[0] : NO_TIMER;
+#else
             running_timer_queue_head =
                 timer_array[running_timer_queue_head].next_timer_in_queue;
 
+            running_timers--;
+#endif
+
             timer_array[expired_timer_queue_tail].next_timer_in_queue =
                 NO_TIMER;
 
-            running_timers--;
-
             /*
              * As a timer has expired, the OCR1A is programmed (if possible)
              * with the new timeout value of the timer pointed by running
@@ -752,13 +849,24 @@ static void start_absolute_timer(uint8_t timer_id,
                                  FUNC_PTR(handler_cb),
                                  void *parameter)
 {
-    ENTER_CRITICAL_REGION();
+    TIMER_ENTER_CRITICAL_REGION();
 
     /* Check is done to see if any timer has expired */
     internal_timer_handler();
 
     bool load_ocr = false;
 
+#ifdef PAL_TIMER_HEAP
+    timer_array[timer_id].abs_exp_timer = point_in_time;
+    timer_array[timer_id].next_timer_in_queue = NO_TIMER;
+    heap_insert(timer_id);
+    if (timer_id == running_timer_heap[0])
+    {
+        /* The timer expires first, hence load the OCR. */
+        running_timer_queue_head = timer_id;
+        load_ocr = true;
+    }
+#else
     if (NO_TIMER == running_timer_queue_head)
     {
         running_timer_queue_head = timer_id;
@@ -820,9 +928,17 @@ static void start_absolute_timer(uint8_t timer_id,
         }
     }
     timer_array[timer_id].abs_exp_timer = point_in_time;
+    running_timers++;
+#endif  /* PAL_TIMER_HEAP */
     timer_array[timer_id].timer_cb = (FUNC_PTR())handler_cb;
     timer_array[timer_id].param_cb = parameter;
-    running_timers++;
+
+#ifdef PAL_TIMER_STATS
+    if (running_timers > timer_stats.max_running)
+    {
+        timer_stats.max_running = running_timers;
+    }
+#endif
 
     /*
      * If there is only one timer in the timer queue
@@ -833,12 +949,192 @@ static void start_absolute_timer(uint8_t timer_id,
         prog_ocr();
     }
 
-    LEAVE_CRITICAL_REGION();
+    TIMER_LEAVE_CRITICAL_REGION();
 }
 #endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) || defined(DOXYGEN)) */
 
 
 
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_HEAP)) || defined(DOXYGEN)
+/**
+ * @brief Checks whether a timer expires strictly before another one
+ *
+ * Timers with the same expiry time are not ordered, so they leave the heap
+ * in undefined order.
+ *
+ * @param t1 Expiry time of the first timer
+ * @param t2 Expiry time of the second timer
+ *
+ * @return true if t1 is before t2, false otherwise
+ */
+static inline bool heap_before(uint32_t t1, uint32_t t2)
+{
+    return ((t1 != t2) && compare_time(t1, t2));
+}
+
+
+
+/**
+ * @brief Moves a heap entry towards the root
+ *
+ * @param index Position of the entry in the heap
+ */
+static void heap_sift_up(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+    uint32_t expiry = timer_array[timer_id].abs_exp_timer;
+
+    while (index > 0)
+    {
+        uint_fast8_t parent = (index - 1) >> 1;
+        uint8_t parent_id = running_timer_heap[parent];
+
+        if (!heap_before(expiry, timer_array[parent_id].abs_exp_timer))
+        {
+            break;
+        }
+
+        running_timer_heap[index] = parent_id;
+        timer_array[parent_id].heap_index = index;
+        index = parent;
+    }
+
+    running_timer_heap[index] = timer_id;
+    timer_array[timer_id].heap_index = index;
+}
+
+
+
+/**
+ * @brief Moves a heap entry away from the root
+ *
+ * @param index Position of the entry in the heap
+ */
+static void heap_sift_down(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+    uint32_t expiry = timer_array[timer_id].abs_exp_timer;
+
+    for (;;)
+    {
+        /* 16 bit, since the child of entry 127 exceeds 8 bit */
+        uint16_t child = 2 * (uint16_t)index + 1;
+        uint8_t child_id;
+
+        if (child >= running_timers)
+        {
+            break;
+        }
+
+        child_id = running_timer_heap[child];
+        if ((child + 1 < running_timers) &&
+            heap_before(timer_array[running_timer_heap[child + 1]].abs_exp_timer,
+                        timer_array[child_id].abs_exp_timer))
+        {
+            child++;
+            child_id = running_timer_heap[child];
+        }
+
+        if (!heap_before(timer_array[child_id].abs_exp_timer, expiry))
+        {
+            break;
+        }
+
+        running_timer_heap[index] = child_id;
+        timer_array[child_id].heap_index = index;
+        index = (uint_fast8_t)child;
+    }
+
+    running_timer_heap[index] = timer_id;
+    timer_array[timer_id].heap_index = index;
+}
+
+
+
+/**
+ * @brief Inserts a timer into the running timer heap
+ *
+ * The expiry time of the timer needs to be set before.
+ *
+ * @param timer_id Timer identifier
+ */
+static void heap_insert(uint8_t timer_id)
+{
+    running_timer_heap[running_timers] = timer_id;
+    running_timers++;
+    heap_sift_up(running_timers - 1);
+}
+
+
+
+/**
+ * @brief Removes a timer from the running timer heap
+ *
+ * The caller updates running_timer_queue_head.
+ *
+ * @param index Position of the timer in the heap
+ */
+static void heap_remove(uint_fast8_t index)
+{
+    uint8_t timer_id = running_timer_heap[index];
+
+    timer_array[timer_id].heap_index = NO_TIMER;
+    running_timers--;
+
+    if (index != running_timers)
+    {
+        /* The last entry fills the gap and moves up or down. */
+        uint8_t last_id = running_timer_heap[running_timers];
+
+        running_timer_heap[index] = last_id;
+        heap_sift_down(index);
+        heap_sift_up(timer_array[last_id].heap_index);
+    }
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_HEAP)) || defined(DOXYGEN) */
+
+
+
+#if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_STATS)) || defined(DOXYGEN)
+/**
+ * @brief Records the duration of a critical region of the timer module
+ *
+ * @param start Time when the critical region was entered
+ */
+static void timer_stats_critical(uint32_t start)
+{
+    uint32_t duration = SUB_TIME(gettime(), start);
+
+    if (duration > timer_stats.max_critical_us)
+    {
+        timer_stats.max_critical_us = duration;
+    }
+}
+
+
+
+/**
+ * @brief Gets the run time statistics of the timer module
+ *
+ * @param[out] stats Statistics since timer_init() or the last reset
+ * @param reset true to reset the statistics after reading
+ */
+void pal_timer_get_stats(pal_timer_stats_t *stats, bool reset)
+{
+    ENTER_CRITICAL_REGION();
+
+    *stats = timer_stats;
+    if (reset)
+    {
+        timer_stats = (pal_timer_stats_t){ 0 };
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+#endif  /* #if ((TOTAL_NUMBER_OF_TIMERS > 0) && defined(PAL_TIMER_STATS)) || defined(DOXYGEN) */
+
+
+
 #if defined(DOXYGEN)
 /**
  * @brief Timer Overflow ISR
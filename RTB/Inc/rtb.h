@@ -60,12 +60,25 @@ extern "C" {
 
     void rtb_range_request(uint8_t *msg);
 
+#ifdef ENABLE_RTB_BATCH
+    void rtb_range_batch_request(uint8_t *msg);
+    void rtb_range_batch_conf(uint8_t *msg);
+#endif  /* #ifdef ENABLE_RTB_BATCH */
+
 #ifndef RTB_WITHOUT_MAC
     void rtb_reset_request(uint8_t *msg);
 #endif  /* #ifndef RTB_WITHOUT_MAC */
 
     void rtb_process_data_ind(uint8_t *msg);
 
+#ifdef ENABLE_RTB_TDMA
+    void rtb_tdma_process_beacon(uint8_t *payload, uint8_t payload_len);
+#endif  /* ENABLE_RTB_TDMA */
+
+#ifdef ENABLE_RTB_SPECTRUM
+    bool rtb_spectrum_ed_end(uint8_t energy_level);
+#endif  /* ENABLE_RTB_SPECTRUM */
+
 #ifdef ENABLE_RTB_REMOTE
     void rtb_remote_range_conf(uint8_t *msg);
 #endif  /* ENABLE_RTB_REMOTE */
@@ -84,6 +97,14 @@ extern "C" {
     void rtb_set_conf(uint8_t *msg);
     retval_t rtb_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_to_sleep);
 
+#ifdef ENABLE_RTB_BULK_PIB
+    retval_t rtb_get(uint8_t attribute, pib_value_t *attribute_value);
+    void rtb_set_bulk_request(uint8_t *msg);
+    void rtb_set_bulk_conf(uint8_t *msg);
+    void rtb_get_bulk_request(uint8_t *msg);
+    void rtb_get_bulk_conf(uint8_t *msg);
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
+
 #ifndef RTB_WITHOUT_MAC
     void rtb_pmu_validitiy_ind(uint8_t *msg);
 #endif  /* #ifndef RTB_WITHOUT_MAC */
@@ -29,12 +29,105 @@
 
 /* === Macros =============================================================== */
 
+#if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN)
+/**
+ * Maximum number of Reflectors within one RTB-RANGE-BATCH.request.
+ * The request must fit into a large buffer.
+ */
+#define RTB_BATCH_MAX_REFLECTORS        (6)
+#endif  /* #if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN)
+/**
+ * Maximum number of PIB attributes within one RTB-SET-BULK.request or
+ * RTB-GET-BULK.request. The request must fit into a large buffer.
+ */
+#define RTB_BULK_MAX_ATTRIBUTES         (8)
+#endif  /* #if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN)
+/**
+ * Maximum number of ranging slots of a TDMA schedule.
+ * The schedule must fit into the beacon payload (aMaxBeaconPayloadLength).
+ */
+#define RTB_TDMA_MAX_SLOTS              (11)
+#endif  /* #if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN)
+/** Number of completed ranging procedures kept by the trace. */
+#define RTB_TRACE_MAX_TRANSACTIONS      (4)
+
+/** Maximum number of result exchange rounds reported per ranging procedure. */
+#define RTB_TRACE_MAX_ROUNDS            (8)
+
+/**
+ * Number of bins of the duration histograms.
+ * Bin 0 counts durations below 32 us, bin n durations from 2^(n+4) us
+ * to below 2^(n+5) us, the last bin all longer durations.
+ */
+#define RTB_TRACE_HIST_BINS             (16)
+
+/** Histogram index of the single result exchange rounds. */
+#define RTB_TRACE_HIST_ROUND            (RTB_TRACE_NO_OF_PHASES)
+
+/** Number of duration histograms, one per phase and one for the rounds. */
+#define RTB_TRACE_NO_OF_HISTS           (RTB_TRACE_NO_OF_PHASES + 1)
+#endif  /* #if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN)
+/** Width of a block of the interference map in MHz. */
+#define RTB_SPECTRUM_BLOCK_MHZ          (4)
+
+/**
+ * Number of blocks of the interference map; block n covers the
+ * frequencies from PMU_MIN_FREQ + n * RTB_SPECTRUM_BLOCK_MHZ on.
+ */
+#define RTB_SPECTRUM_NO_OF_BLOCKS       ((PMU_MAX_FREQ - PMU_MIN_FREQ) / RTB_SPECTRUM_BLOCK_MHZ + 1)
+
+/** Length of a frequency plan, i.e. one bit per block avoided by the PMU sweep. */
+#define RTB_SPECTRUM_PLAN_LEN           ((RTB_SPECTRUM_NO_OF_BLOCKS + 7) / 8)
+#endif  /* #if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN) */
 
 /* === Types ================================================================ */
 
 /* Ranging API types ****************** */
 
 /* RTB Range Request related types **** */
+#if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN)
+/**
+ * Ranging profile applied to a single ranging procedure instead of the
+ * corresponding RTB PIB attributes; the same value ranges apply.
+ */
+typedef struct rtb_range_profile_tag
+{
+    /** The PMU measurement start frequency (see RTB_PIB_PMU_FREQ_START). */
+    uint16_t PMUFreqStart;
+    /** The PMU measurement step size (see RTB_PIB_PMU_FREQ_STEP). */
+    uint8_t PMUFreqStep;
+    /** The PMU measurement stop frequency (see RTB_PIB_PMU_FREQ_STOP). */
+    uint16_t PMUFreqStop;
+    /**
+     * Antenna diversity of the Initiator; the Reflector is asked to use
+     * antenna diversity as well (see RTB_PIB_ENABLE_ANTENNA_DIV).
+     */
+    bool EnableAntennaDiv;
+    /** The Ranging Transmit Power (see RTB_PIB_RANGING_TX_POWER). */
+    uint8_t RangingTransmitPower;
+    /**
+     * Send the Ranging Transmit Power to the other ranging party
+     * (see RTB_PIB_PROVIDE_RANGING_TX_POWER).
+     */
+    bool ProvideRangingTransmitPower;
+#if !defined(RTB_WITHOUT_MAC) || defined(DOXYGEN)
+    /**
+     * Provide the distances and DQFs of all antenna combinations
+     * (see RTB_PIB_PROVIDE_ANTENNA_DIV_RESULTS).
+     */
+    bool ProvideAntennaDivResults;
+#endif  /* #if !defined(RTB_WITHOUT_MAC) || defined(DOXYGEN) */
+} rtb_range_profile_t;
+#endif  /* #if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN) */
+
 /** Structure creating the wpan_rtb_range_req() API function. */
 typedef struct wpan_rtb_range_req_tag
 {
@@ -84,6 +177,16 @@ typedef struct wpan_rtb_range_req_tag
      */
     uint8_t CoordinatorAddrMode;
 //#endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
+#if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN)
+    /**
+     * Apply Profile to this ranging procedure instead of the RTB PIB
+     * attributes of the Initiator (or of the Coordinator in case of
+     * remote ranging). The RTB PIB attributes are not changed.
+     */
+    bool UseProfile;
+    /** The ranging profile of this ranging procedure. */
+    rtb_range_profile_t Profile;
+#endif  /* #if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN) */
 } wpan_rtb_range_req_t;
 
 
@@ -98,7 +201,7 @@ typedef struct measurement_pair_tag
     uint32_t distance;
     /** The measured DQF in percent. */
     uint8_t dqf;
-} measurement_pair_t;
+} PACKED measurement_pair_t;
 
 /*
  * Structure containing the actual local ranging results within the usr_rtb_range_conf()
@@ -207,6 +310,12 @@ typedef struct
      * measurement in percent.
      */
     uint8_t dqf;
+    /**
+     * The handle of the remote ranging session at the Coordinator, starting
+     * with 1 and incremented with each opened session.
+     * Zero if the remote ranging was rejected before a session was opened.
+     */
+    uint8_t SessionHandle;
     /**
      * The number of provided measurements pairs (consisting of distance and
      * DQF) based on the value of the PIB attribute ProvideAntennaDivResults
@@ -265,6 +374,293 @@ typedef struct
 } usr_rtb_range_conf_t;
 
 
+#if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN)
+/* RTB Range Batch Request related types **** */
+/** Structure implementing the address of one Reflector of a batch. */
+typedef struct reflector_addr_spec_tag
+{
+    /**
+     * The Reflector addressing mode.
+     * This value can take one of the following values:
+     * 0x02 = 16 bit short address.
+     * 0x03 = 64 bit extended address.
+     * Other values are not allowed.
+     */
+    uint8_t ReflectorAddrMode;
+    /**
+     * The 16 bit PAN identifier of the Reflector.
+     */
+    uint16_t ReflectorPANId;
+    /**
+     * The individual device address the Reflector.
+     */
+    uint64_t ReflectorAddr;
+} reflector_addr_spec_t;
+
+/** Structure creating the wpan_rtb_range_batch_req() API function. */
+typedef struct wpan_rtb_range_batch_req_tag
+{
+    /**
+     * The Initiator addressing mode for this primitive.
+     * This value can take one of the following values:
+     * 0x02 = 16 bit short address.
+     * 0x03 = 64 bit extended address.
+     * Other values are not allowed.
+     */
+    uint8_t InitiatorAddrMode;
+    /**
+     * The 16 bit PAN identifier of the Initiator.
+     */
+    uint16_t InitiatorPANId;
+    /**
+     * The individual device address the Initiator.
+     */
+    uint64_t InitiatorAddr;
+    /**
+     * The number of Reflectors (1 .. RTB_BATCH_MAX_REFLECTORS).
+     */
+    uint8_t NoOfReflectors;
+    /**
+     * The Reflectors in the order they are ranged with.
+     */
+    reflector_addr_spec_t Reflectors[RTB_BATCH_MAX_REFLECTORS];
+} wpan_rtb_range_batch_req_t;
+
+
+/* RTB Range Batch Confirm related types **** */
+/** Structure implementing the result of the ranging with one Reflector. */
+typedef struct batch_ranging_result_tag
+{
+    /** The status of the ranging measurement. */
+    uint8_t status;
+    /** The final calculated distance of the ranging measurement in cm. */
+    uint32_t distance;
+    /** The final calculated DQF of the ranging measurement in percent. */
+    uint8_t dqf;
+} batch_ranging_result_t;
+
+/** Structure creating the usr_rtb_range_batch_conf() callback. */
+typedef struct usr_rtb_range_batch_conf_tag
+{
+    /**
+     * The status of the batch.
+     * RTB_SUCCESS if all Reflectors have been ranged with;
+     * the individual results indicate the status of each ranging.
+     */
+    uint8_t status;
+    /**
+     * The number of results, i.e. the number of requested Reflectors,
+     * or zero if the batch was rejected.
+     */
+    uint8_t NoOfResults;
+    /**
+     * The results in the order of the Reflectors within the request.
+     */
+    batch_ranging_result_t results[RTB_BATCH_MAX_REFLECTORS];
+} usr_rtb_range_batch_conf_t;
+#endif  /* #if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN) */
+
+
+#if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN)
+/* RTB TDMA schedule related types **** */
+/** Structure implementing one ranging slot of a TDMA schedule. */
+typedef struct rtb_tdma_slot_tag
+{
+    /**
+     * The short address of the Initiator ranging within this slot.
+     */
+    uint16_t InitiatorAddr;
+    /**
+     * The short address of the Reflector ranged with within this slot.
+     */
+    uint16_t ReflectorAddr;
+} rtb_tdma_slot_t;
+
+/** Structure creating the rtb_tdma_set_schedule() API function. */
+typedef struct rtb_tdma_schedule_tag
+{
+    /**
+     * The start of the first ranging slot after the beacon in ms.
+     * Frames of the MAC and rangings of nodes without ranging slot are
+     * transmitted before the first slot.
+     */
+    uint8_t SlotStart;
+    /**
+     * The duration of a ranging slot in ms.
+     * A complete ranging procedure needs to fit into one slot before its
+     * guard time (RTB_TDMA_GUARD_TIME_US), otherwise it is stopped with
+     * status RTB_TDMA_SLOT_END.
+     */
+    uint8_t SlotDuration;
+    /**
+     * The number of ranging slots (0 .. RTB_TDMA_MAX_SLOTS).
+     * Zero removes the schedule from the beacon payload.
+     */
+    uint8_t NoOfSlots;
+    /**
+     * The ranging slots in the order of their start time.
+     */
+    rtb_tdma_slot_t Slots[RTB_TDMA_MAX_SLOTS];
+} rtb_tdma_schedule_t;
+#endif  /* #if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN) */
+
+
+#if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN)
+/* RTB latency trace related types **** */
+/** Phases of a ranging procedure measured by the trace. */
+typedef enum rtb_trace_phase_tag
+{
+    /** Range Request and Range Accept frame exchange */
+    RTB_TRACE_PHASE_RANGE_REQ = 0,
+    /** Time Sync Request and PMU Start frame exchange */
+    RTB_TRACE_PHASE_TIME_SYNC,
+    /** PMU measurement */
+    RTB_TRACE_PHASE_PMU,
+    /** Result exchange, i.e. all Result Request and Result Confirm frames */
+    RTB_TRACE_PHASE_RESULT_EXCHANGE,
+    /** Result calculation and presentation at the Initiator */
+    RTB_TRACE_PHASE_CALC,
+    /** Remote Range Request and Remote Range Confirm frame handling */
+    RTB_TRACE_PHASE_REMOTE,
+    /** Number of phases */
+    RTB_TRACE_NO_OF_PHASES
+} SHORTENUM rtb_trace_phase_t;
+
+/** Structure implementing the phase durations of one ranging procedure. */
+typedef struct rtb_trace_transaction_tag
+{
+    /**
+     * The number of the ranging procedure, counted since start-up.
+     */
+    uint16_t Seq;
+    /**
+     * The role of the node: 1 = Initiator, 2 = Reflector, 3 = Coordinator.
+     */
+    uint8_t Role;
+    /**
+     * The range error at the end of the ranging procedure, 0 if successful.
+     */
+    uint8_t Status;
+    /**
+     * False if the trace ring overflowed during the ranging procedure,
+     * so the durations of its first phases are missing.
+     */
+    bool Complete;
+    /**
+     * The number of result exchange rounds, i.e. of Result Request frames
+     * transmitted by the Initiator or answered by the Reflector.
+     */
+    uint8_t NoOfRounds;
+    /**
+     * The duration of each phase in us, indexed by rtb_trace_phase_t.
+     */
+    uint32_t PhaseDuration[RTB_TRACE_NO_OF_PHASES];
+    /**
+     * The duration of the first RTB_TRACE_MAX_ROUNDS result exchange
+     * rounds in us.
+     */
+    uint32_t RoundDuration[RTB_TRACE_MAX_ROUNDS];
+} rtb_trace_transaction_t;
+#endif  /* #if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN) */
+
+
+#if defined(ENABLE_RTB_ADAPTIVE) || defined(DOXYGEN)
+/* RTB adaptive frequency sweep related types **** */
+/** Structure implementing the configuration of the adaptive frequency sweep. */
+typedef struct rtb_adaptive_config_tag
+{
+    /**
+     * Local rangings are refined by a dense sweep if the sweep of the
+     * PMU band is of poor quality.
+     */
+    bool Enabled;
+    /**
+     * A sweep with a DQF below this threshold (in percent) is of
+     * poor quality.
+     */
+    uint8_t DQFThreshold;
+    /**
+     * A sweep with less valid PMU values than this share of its frequencies
+     * (in percent) is of poor quality; a PMU value is valid as reported by
+     * the RTB-PMU-VALIDITY.indication for any antenna measurement pair.
+     */
+    uint8_t MinValidPercent;
+    /**
+     * The frequency step of the dense sweep (PMU_STEP_FREQ_500kHz ..
+     * PMU_STEP_FREQ_4MHz); a coarser step is used if the useful band
+     * requires too many frequencies. No dense sweep is done if this is
+     * not finer than the step of the first sweep.
+     */
+    uint8_t DenseFreqStep;
+} rtb_adaptive_config_t;
+
+/** Structure implementing the statistics of the adaptive frequency sweep. */
+typedef struct rtb_adaptive_stats_tag
+{
+    /**
+     * The number of successful local rangings.
+     */
+    uint32_t NoOfRangings;
+    /**
+     * The number of these rangings refined by a dense sweep.
+     */
+    uint32_t NoOfDenseSweeps;
+    /**
+     * The number of frequencies measured by all sweeps of these rangings;
+     * each frequency is measured once per antenna measurement pair.
+     */
+    uint32_t NoOfFrequencies;
+} rtb_adaptive_stats_t;
+#endif  /* #if defined(ENABLE_RTB_ADAPTIVE) || defined(DOXYGEN) */
+
+
+#if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN)
+/* RTB spectrum monitor related types **** */
+/** Structure implementing the configuration of the spectrum monitor. */
+typedef struct rtb_spectrum_config_tag
+{
+    /**
+     * The spectrum monitor scans the PMU band of the RTB PIB, and the
+     * rangings initiated by this node propose a frequency plan avoiding
+     * the busy blocks.
+     */
+    bool Enabled;
+    /**
+     * A block with an energy level above this threshold is busy; the
+     * energy level is scaled like the result of an ED scan (0 .. 255).
+     */
+    uint8_t EDThreshold;
+    /**
+     * The time between the ED scans of two blocks in ms. Each ED scan
+     * keeps the transceiver from receiving for about 31 ms.
+     */
+    uint16_t ScanInterval;
+} rtb_spectrum_config_t;
+
+/** Structure implementing the statistics of the spectrum monitor. */
+typedef struct rtb_spectrum_stats_tag
+{
+    /**
+     * The number of ED scans of a block.
+     */
+    uint32_t NoOfScans;
+    /**
+     * The number of rangings initiated by this node with a negotiated
+     * frequency plan.
+     */
+    uint32_t NoOfRangings;
+    /**
+     * The number of these rangings with a narrowed band.
+     */
+    uint32_t NoOfReducedPlans;
+    /**
+     * The number of frequencies outside the narrowed band of these rangings.
+     */
+    uint32_t NoOfSkippedFrequencies;
+} rtb_spectrum_stats_t;
+#endif  /* #if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN) */
+
+
 #ifndef RTB_WITHOUT_MAC
 /* RTB Reset Confirm related types **** */
 /** Structure creating the usr_rtb_reset_conf() callback. */
@@ -298,6 +694,78 @@ typedef struct usr_rtb_set_conf_tag
 } usr_rtb_set_conf_t;
 
 
+#if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN)
+/* RTB Set/Get Bulk Request related types **** */
+/** Layer holding a PIB attribute of a bulk request. */
+typedef enum rtb_bulk_layer_tag
+{
+    /** RTB PIB attribute (rtb_pib_attribute_id_t) */
+    RTB_BULK_LAYER_RTB                  = 0,
+    /**
+     * MAC PIB attribute residing in the TAL: phyCurrentChannel,
+     * phyTransmitPower, macPANId, macShortAddress, or macIeeeAddress.
+     */
+    RTB_BULK_LAYER_MAC                  = 1
+} SHORTENUM rtb_bulk_layer_t;
+
+/** Structure implementing one PIB attribute of a bulk request. */
+typedef struct rtb_bulk_attr_tag
+{
+    /** The layer holding the PIB attribute (rtb_bulk_layer_t). */
+    uint8_t Layer;
+    /** The identifier of the PIB attribute. */
+    uint8_t PIBAttribute;
+    /** The value of the PIB attribute. */
+    pib_value_t PIBAttributeValue;
+} rtb_bulk_attr_t;
+
+/** Structure creating the wpan_rtb_set_bulk_req() API function. */
+typedef struct wpan_rtb_set_bulk_req_tag
+{
+    /** The number of PIB attributes (1 .. RTB_BULK_MAX_ATTRIBUTES). */
+    uint8_t NoOfAttributes;
+    /** The PIB attributes and the values to write. */
+    rtb_bulk_attr_t Attributes[RTB_BULK_MAX_ATTRIBUTES];
+} wpan_rtb_set_bulk_req_t;
+
+/** Structure creating the usr_rtb_set_bulk_conf() callback. */
+typedef struct usr_rtb_set_bulk_conf_tag
+{
+    /**
+     * The result of the request to write the PIB attributes.
+     * If not RTB_SUCCESS, none of the PIB attributes has been changed.
+     */
+    uint8_t status;
+    /** The index of the PIB attribute that could not be written. */
+    uint8_t FailedAttribute;
+    /** The number of PIB attributes of the request. */
+    uint8_t NoOfAttributes;
+} usr_rtb_set_bulk_conf_t;
+
+/** Structure creating the wpan_rtb_get_bulk_req() API function. */
+typedef struct wpan_rtb_get_bulk_req_tag
+{
+    /** The number of PIB attributes (1 .. RTB_BULK_MAX_ATTRIBUTES). */
+    uint8_t NoOfAttributes;
+    /** The PIB attributes to read; the values are ignored. */
+    rtb_bulk_attr_t Attributes[RTB_BULK_MAX_ATTRIBUTES];
+} wpan_rtb_get_bulk_req_t;
+
+/** Structure creating the usr_rtb_get_bulk_conf() callback. */
+typedef struct usr_rtb_get_bulk_conf_tag
+{
+    /** The result of the request to read the PIB attributes. */
+    uint8_t status;
+    /** The index of the PIB attribute that could not be read. */
+    uint8_t FailedAttribute;
+    /** The number of PIB attributes of the request. */
+    uint8_t NoOfAttributes;
+    /** The PIB attributes and their values. */
+    rtb_bulk_attr_t Attributes[RTB_BULK_MAX_ATTRIBUTES];
+} usr_rtb_get_bulk_conf_t;
+#endif  /* #if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN) */
+
+
 /* RTB PMU Validity Indication related types **** */
 /** Structure creating the usr_rtb_pmu_validity_ind() callback. */
 typedef struct usr_rtb_pmu_validity_ind_tag
@@ -431,6 +899,20 @@ extern pmu_avg_data_t pmu_avg_data;
 #define COORDINATOR_LONG_ADDR           (FCF_LONG_ADDR)
 //#endif  /* ENABLE_RTB_REMOTE */
 
+/**
+ * Checks whether a PMU verbose level is supported.
+ * The binary capture is built from pmu_avg_data by the RTB itself, so it is
+ * available beyond aRTBMaxPMUVerboseLevel of the PMU implementation.
+ */
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC)
+#define RTB_PMU_VERBOSE_LEVEL_SUPPORTED(level)                  \
+    (((level) <= aRTBMaxPMUVerboseLevel) ||                     \
+     ((level) == PMU_VERBOSE_LEVEL_BINARY_DUMP))
+#else
+#define RTB_PMU_VERBOSE_LEVEL_SUPPORTED(level)                  \
+    ((level) <= aRTBMaxPMUVerboseLevel)
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC) */
+
 /* === Prototypes =========================================================== */
 #ifdef __cplusplus
 extern "C" {
@@ -455,6 +937,164 @@ extern "C" {
      */
     bool wpan_rtb_range_req(wpan_rtb_range_req_t *wrrr);
 
+#if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN)
+    /**
+     * Initiate RTB-RANGE-BATCH.request service and have it placed in the
+     * RTB-SAP queue.
+     *
+     * The RTB ranges with all Reflectors back-to-back and reports all
+     * results by a single RTB-RANGE-BATCH.confirm.
+     *
+     * @param wrrbr Pointer to wpan_rtb_range_batch_req_t structure
+     *
+     * @return true - success; false - buffer not available or queue full.
+     *
+     * @ingroup apiRTB_API
+     */
+    bool wpan_rtb_range_batch_req(wpan_rtb_range_batch_req_t *wrrbr);
+#endif  /* #if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN)
+    /**
+     * Sets the TDMA schedule distributed within the beacon payload.
+     *
+     * This function is executed immediately (like mlme_set()) by a
+     * Coordinator of a beacon-enabled network. Initiators and Reflectors
+     * tracking its beacons perform the rangings of their slots without
+     * CSMA-CA; range requests of an Initiator are deferred until the slot
+     * assigned to the Initiator and its Reflector. If macBeaconOrder is set
+     * before the MLME-START.request, already the first beacon contains the
+     * schedule.
+     *
+     * With one slot per node pair and beacon interval, each pair ranges at
+     * most once per beacon interval. For a few node pairs CSMA-CA therefore
+     * reaches a higher throughput; the schedule pays off with many node
+     * pairs, where CSMA-CA suffers from collisions and channel access
+     * failures.
+     *
+     * @param schedule  Pointer to rtb_tdma_schedule_t structure
+     *
+     * @return RTB_SUCCESS if the schedule is transmitted with the next beacon,
+     *         RTB_INVALID_PARAMETER if macBeaconOrder is not set, the slots
+     *         do not fit into the beacon interval or a slot is not longer
+     *         than the guard time.
+     *
+     * @ingroup apiRTB_API
+     */
+    uint8_t rtb_tdma_set_schedule(rtb_tdma_schedule_t *schedule);
+#endif  /* #if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN)
+    /**
+     * Gets the phase durations of the last completed ranging procedures.
+     *
+     * Each transition of the RTB state machine is recorded with its time
+     * into a trace ring; once a ranging procedure is finished, its phase
+     * durations are derived from the ring.
+     *
+     * @param trans     Pointer to an array receiving the ranging procedures,
+     *                  the oldest first
+     * @param max_trans Number of entries of the array
+     *
+     * @return Number of ranging procedures copied
+     *         (at most RTB_TRACE_MAX_TRANSACTIONS).
+     *
+     * @ingroup apiRTB_API
+     */
+    uint8_t rtb_trace_get_transactions(rtb_trace_transaction_t *trans,
+                                       uint8_t max_trans);
+
+    /**
+     * Gets the rolling duration histogram of a phase.
+     *
+     * Once a histogram holds 256 durations, all of its bins are halved,
+     * so the histogram follows recent ranging procedures.
+     *
+     * @param hist  Phase (rtb_trace_phase_t) or RTB_TRACE_HIST_ROUND
+     * @param bins  Pointer to an array of RTB_TRACE_HIST_BINS entries
+     *
+     * @ingroup apiRTB_API
+     */
+    void rtb_trace_get_histogram(uint8_t hist, uint16_t *bins);
+#endif  /* #if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_ADAPTIVE) || defined(DOXYGEN)
+    /**
+     * Sets the configuration of the adaptive frequency sweep.
+     *
+     * A local ranging first sweeps the PMU band of its range request
+     * (or of the RTB PIB). If the quality of this sweep is poor, the
+     * ranging is not confirmed, but repeated right away by a dense sweep
+     * restricted to the useful band, i.e. from the first to the last
+     * valid PMU value of the first sweep; only the result of the dense
+     * sweep is confirmed. The configuration is reset to disabled by a reset of the RTB.
+     *
+     * @param config  Pointer to rtb_adaptive_config_t structure
+     *
+     * @return RTB_SUCCESS if the configuration is applied,
+     *         RTB_INVALID_PARAMETER if a value is out of range.
+     *
+     * @ingroup apiRTB_API
+     */
+    uint8_t rtb_adaptive_set_config(rtb_adaptive_config_t *config);
+
+    /**
+     * Gets the statistics of the adaptive frequency sweep.
+     *
+     * The statistics cover all successful local rangings since the last
+     * reset of the RTB, even while the adaptive frequency sweep is disabled,
+     * so the frequencies measured per ranging can be compared.
+     *
+     * @param stats  Pointer to rtb_adaptive_stats_t structure
+     *
+     * @ingroup apiRTB_API
+     */
+    void rtb_adaptive_get_stats(rtb_adaptive_stats_t *stats);
+#endif  /* #if defined(ENABLE_RTB_ADAPTIVE) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN)
+    /**
+     * Sets the configuration of the spectrum monitor.
+     *
+     * While the RTB and the MAC are idle, the spectrum monitor scans one
+     * block of the PMU band of the RTB PIB per scan interval by an ED scan
+     * and keeps the energy level of each block in its interference map.
+     * The Range Request frame proposes a frequency plan marking the busy
+     * blocks; the Reflector adds the blocks busy at its side and returns
+     * the plan in the Range Accept frame. Both nodes narrow their sweep to
+     * the longest run of frequencies outside the busy blocks. The
+     * configuration is reset to disabled by a reset of the RTB.
+     *
+     * @param config  Pointer to rtb_spectrum_config_t structure
+     *
+     * @return RTB_SUCCESS if the configuration is applied,
+     *         RTB_INVALID_PARAMETER if the scan interval is too short.
+     *
+     * @ingroup apiRTB_API
+     */
+    uint8_t rtb_spectrum_set_config(rtb_spectrum_config_t *config);
+
+    /**
+     * Gets the statistics of the spectrum monitor since the last reset
+     * of the RTB.
+     *
+     * @param stats  Pointer to rtb_spectrum_stats_t structure
+     *
+     * @ingroup apiRTB_API
+     */
+    void rtb_spectrum_get_stats(rtb_spectrum_stats_t *stats);
+
+    /**
+     * Gets the interference map of the spectrum monitor.
+     *
+     * @param ed_levels  Pointer to RTB_SPECTRUM_NO_OF_BLOCKS octets receiving
+     *                   the energy level of each block, 0 if not scanned
+     *
+     * @ingroup apiRTB_API
+     */
+    void rtb_spectrum_get_map(uint8_t *ed_levels);
+#endif  /* #if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN) */
+
 #ifndef RTB_WITHOUT_MAC
     /**
      * Initiate RTB-RESET.request service and have it placed in RTB-SAP queue.
@@ -478,6 +1118,71 @@ extern "C" {
      */
     bool wpan_rtb_set_req(wpan_rtb_set_req_t *wrsr);
 
+#if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN)
+    /**
+     * Initiate RTB-SET-BULK.request service and have it placed in the
+     * RTB-SAP queue.
+     *
+     * All PIB attributes are written by one request, validated against
+     * each other, and confirmed by a single RTB-SET-BULK.confirm; either all
+     * of them are written or none.
+     *
+     * @param wrsbr Pointer to wpan_rtb_set_bulk_req_t structure
+     *
+     * @return true - success; false - buffer not available or queue full.
+     *
+     * @ingroup apiRTB_API
+     */
+    bool wpan_rtb_set_bulk_req(wpan_rtb_set_bulk_req_t *wrsbr);
+
+    /**
+     * Initiate RTB-GET-BULK.request service and have it placed in the
+     * RTB-SAP queue.
+     *
+     * @param wrgbr Pointer to wpan_rtb_get_bulk_req_t structure
+     *
+     * @return true - success; false - buffer not available or queue full.
+     *
+     * @ingroup apiRTB_API
+     */
+    bool wpan_rtb_get_bulk_req(wpan_rtb_get_bulk_req_t *wrgbr);
+
+    /**
+     * Writes several PIB attributes via functional access.
+     *
+     * The RTB PIB attributes are written first; one rejected as invalid is
+     * tried again after the others, so dependent attributes (such as
+     * RTB_PIB_PMU_FREQ_START and RTB_PIB_PMU_FREQ_STOP) can be given in any
+     * order. The MAC PIB attributes follow, the last of them puts the
+     * transceiver back to sleep if it has been woken up. If any attribute
+     * cannot be written, all attributes are restored.
+     *
+     * @param attrs         PIB attributes and values
+     * @param no_of_attrs   Number of PIB attributes
+     * @param failed_attr   Index of the PIB attribute that could not be written
+     *
+     * @return RTB_SUCCESS or the status of the failed PIB attribute
+     *
+     * @ingroup apiRTB_API
+     */
+    retval_t rtb_set_bulk(rtb_bulk_attr_t *attrs, uint8_t no_of_attrs,
+                          uint8_t *failed_attr);
+
+    /**
+     * Reads several PIB attributes via functional access.
+     *
+     * @param attrs         PIB attributes, the values are filled in
+     * @param no_of_attrs   Number of PIB attributes
+     * @param failed_attr   Index of the PIB attribute that could not be read
+     *
+     * @return RTB_SUCCESS or the status of the failed PIB attribute
+     *
+     * @ingroup apiRTB_API
+     */
+    retval_t rtb_get_bulk(rtb_bulk_attr_t *attrs, uint8_t no_of_attrs,
+                          uint8_t *failed_attr);
+#endif  /* #if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN) */
+
 
 #ifndef RTB_WITHOUT_MAC
     /**
@@ -506,6 +1211,32 @@ extern "C" {
      */
     void usr_rtb_set_conf(usr_rtb_set_conf_t *ursc);
 
+#if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN)
+    /**
+     * Callback function that must be implemented by the application (NHLE)
+     * for the RTB service RTB-SET-BULK.confirm.
+     *
+     * @param ursbc Pointer to usr_rtb_set_bulk_conf_t result structure.
+     *
+     * @return void
+     *
+     * @ingroup apiRTB_API
+     */
+    void usr_rtb_set_bulk_conf(usr_rtb_set_bulk_conf_t *ursbc);
+
+    /**
+     * Callback function that must be implemented by the application (NHLE)
+     * for the RTB service RTB-GET-BULK.confirm.
+     *
+     * @param urgbc Pointer to usr_rtb_get_bulk_conf_t result structure.
+     *
+     * @return void
+     *
+     * @ingroup apiRTB_API
+     */
+    void usr_rtb_get_bulk_conf(usr_rtb_get_bulk_conf_t *urgbc);
+#endif  /* #if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN) */
+
 
     /**
      * Callback function that must be implemented by the application (NHLE)
@@ -520,6 +1251,21 @@ extern "C" {
     void usr_rtb_range_conf(usr_rtb_range_conf_t *urrc);
 
 
+#if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN)
+    /**
+     * Callback function that must be implemented by the application (NHLE)
+     * for the RTB service RTB-RANGE-BATCH.confirm.
+     *
+     * @param urrbc Pointer to usr_rtb_range_batch_conf_t result structure.
+     *
+     * @return void
+     *
+     * @ingroup apiRTB_API
+     */
+    void usr_rtb_range_batch_conf(usr_rtb_range_batch_conf_t *urrbc);
+#endif  /* #if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN) */
+
+
     /**
      * Callback function that must be implemented by the application (NHLE)
      * for the RTB service RTB-PMU-VALIDITY.indication.
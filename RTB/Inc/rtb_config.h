@@ -87,6 +87,29 @@
 #   endif   /* (HIGHEST_STACK_LAYER == RTB) */
 #endif  /* #ifdef ENABLE_RTB_REMOTE */
 
+#ifdef ENABLE_RTB_TDMA
+/*
+ * The TDMA schedule is distributed by the beacon frames of the MAC,
+ * so beacon-enabled networks need to be supported.
+ */
+#   ifndef BEACON_SUPPORT
+#       error ("BEACON_SUPPORT must be defined if ENABLE_RTB_TDMA is defined")
+#   endif   /* BEACON_SUPPORT */
+#   if (HIGHEST_STACK_LAYER == RTB)
+#       error ("HIGHEST_STACK_LAYER must NOT be RTB if ENABLE_RTB_TDMA is defined")
+#   endif   /* (HIGHEST_STACK_LAYER == RTB) */
+#endif  /* #ifdef ENABLE_RTB_TDMA */
+
+#ifdef ENABLE_RTB_SPECTRUM
+/*
+ * The spectrum monitor uses the ED scan of the TAL, whose end is
+ * forwarded by the MAC, so the MAC needs to be included.
+ */
+#   if (HIGHEST_STACK_LAYER == RTB)
+#       error ("HIGHEST_STACK_LAYER must NOT be RTB if ENABLE_RTB_SPECTRUM is defined")
+#   endif   /* (HIGHEST_STACK_LAYER == RTB) */
+#endif  /* #ifdef ENABLE_RTB_SPECTRUM */
+
 #ifdef ENABLE_RH
 /*
  * In case RTB PIB attribute handling only shall be supported (i.e. as
@@ -106,14 +129,48 @@
 #   define RTB_FIRST_TIMER_ID           (TAL_LAST_TIMER_ID + 1)
 #endif
 
+#ifdef ENABLE_RTB_REMOTE
+#define NUMBER_OF_RTB_REMOTE_TIMERS     (1)
+#else
+#define NUMBER_OF_RTB_REMOTE_TIMERS     (0)
+#endif  /* ENABLE_RTB_REMOTE */
+
+#ifdef ENABLE_RTB_TDMA
+#define NUMBER_OF_RTB_TDMA_TIMERS       (1)
+#else
+#define NUMBER_OF_RTB_TDMA_TIMERS       (0)
+#endif  /* ENABLE_RTB_TDMA */
+
+#ifdef ENABLE_RTB_SPECTRUM
+#define NUMBER_OF_RTB_SPECTRUM_TIMERS   (1)
+#else
+#define NUMBER_OF_RTB_SPECTRUM_TIMERS   (0)
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+#define NUMBER_OF_RTB_TIMERS        (1 + \
+                                     NUMBER_OF_RTB_REMOTE_TIMERS + \
+                                     NUMBER_OF_RTB_TDMA_TIMERS + \
+                                     NUMBER_OF_RTB_SPECTRUM_TIMERS)
+
 /* Timer ID's used by RTB */
 typedef enum rtb_timer_id_tag
 {
     T_RTB_Wait_Time                 = (RTB_FIRST_TIMER_ID)
+#ifdef ENABLE_RTB_REMOTE
+    ,
+    T_RTB_Remote_Session            = (RTB_FIRST_TIMER_ID + 1)
+#endif  /* ENABLE_RTB_REMOTE */
+#ifdef ENABLE_RTB_TDMA
+    ,
+    T_RTB_TDMA_Slot                 = (RTB_FIRST_TIMER_ID + 1 + NUMBER_OF_RTB_REMOTE_TIMERS)
+#endif  /* ENABLE_RTB_TDMA */
+#ifdef ENABLE_RTB_SPECTRUM
+    ,
+    T_RTB_Spectrum_Scan             = (RTB_FIRST_TIMER_ID + 1 + NUMBER_OF_RTB_REMOTE_TIMERS +
+                                       NUMBER_OF_RTB_TDMA_TIMERS)
+#endif  /* ENABLE_RTB_SPECTRUM */
 } rtb_timer_id_t;
 
-#define NUMBER_OF_RTB_TIMERS        (1)
-
 #if (NUMBER_OF_RTB_TIMERS > 0)
 #   define RTB_LAST_TIMER_ID    (RTB_FIRST_TIMER_ID + NUMBER_OF_RTB_TIMERS - 1) // -1: timer id starts with 0
 #else
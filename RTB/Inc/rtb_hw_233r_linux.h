@@ -0,0 +1,54 @@
+/**
+ * @file rtb_hw_233r_linux.h
+ *
+ * @brief Header file for AT86RF233R on hosted Linux dependent functionality of RTB
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_HW_233R_LINUX_H
+#define RTB_HW_233R_LINUX_H
+
+/* === Includes ============================================================= */
+
+#include "rtb_types.h"
+#if (RTB_TYPE == RTB_PMU_233R)
+
+/* === Macros =============================================================== */
+
+/** Default Ranging Transmit Power is set to -17dBm. */
+#define RTB_TRANSMIT_POWER_DEFAULT      (0xAF)
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void set_slp_trx_high(void);
+    void set_slp_trx_low(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RTB_PMU_233R */
+
+#endif /* RTB_HW_233R_LINUX_H */
+
+/* EOF */
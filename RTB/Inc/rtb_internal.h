@@ -36,6 +36,12 @@
 
 /* === Macros =============================================================== */
 
+#ifdef ENABLE_BMM_STATS
+/* Buffers allocated by the RTB are accounted to the RTB. */
+#undef BMM_OWNER
+#define BMM_OWNER                       (BMM_OWNER_RTB)
+#endif  /* ENABLE_BMM_STATS */
+
 /**
  * Length of RTB frame identifier, which forms the first octets of any
  * ranging related frame (i.e. first octets of data frame payload).
@@ -64,6 +70,12 @@
 #define CMD_PMU_START_LEN               (RTB_FRAME_ID_LEN + 1)          /**< Length of PMU Start Frame */
 #define CMD_RESULT_REQ_LEN              (RTB_FRAME_ID_LEN + 5)          /**< Length of Result Request Frame */
 #define CMD_RESULT_CONF_LEN             (RTB_FRAME_ID_LEN + 5)          /**< Length of Result Confirm Frame */
+#if defined(ENABLE_RTB_PUSH_RESULTS) ||  defined(DOXYGEN)
+#   define CMD_RESULT_REQ_PUSH_LEN      (CMD_RESULT_REQ_LEN + 2)        /**< Length of Result Request Frame starting a burst */
+// 2 octets number of values to be pushed
+#   define CMD_RESULT_CONF_PUSH_LEN     (CMD_RESULT_CONF_LEN + 2)       /**< Length of pushed Result Confirm Frame */
+// 2 octets start index of the included values
+#endif  /* #if defined(ENABLE_RTB_PUSH_RESULTS) ||  defined(DOXYGEN) */
 #if defined(ENABLE_RTB_REMOTE) ||  defined(DOXYGEN)
 #   define CMD_REMOTE_RANGE_REQ_LEN     (CMD_RANGE_REQ_LEN + 1 + 2 + 2) /**< Length of remote Range Request Frame */
 // 1 octet Reflector AddrMode
@@ -80,15 +92,57 @@
 // 1 octet Additional Result IE
 #endif  /* #if defined(ENABLE_RTB_REMOTE) ||  defined(DOXYGEN) */
 
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+/** The Initiator always offers to receive compressed PMU values. */
+#   define INITIATOR_COMPR_CAPS     (PMU_CAP_INITIATOR_COMPR)
+#else
+#   define INITIATOR_COMPR_CAPS     (0)
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+/** The Initiator always offers to receive pushed Result Confirm frames. */
+#   define INITIATOR_PUSH_CAPS      (PMU_CAP_INITIATOR_PUSH)
+#else
+#   define INITIATOR_PUSH_CAPS      (0)
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+#ifdef ENABLE_RTB_SPECTRUM
+/** The Initiator proposes a frequency plan while its spectrum monitor is enabled. */
+#   define INITIATOR_SPECTRUM_CAPS  (range_spectrum_enabled() ? PMU_CAP_INITIATOR_SPECTRUM : 0)
+#else
+#   define INITIATOR_SPECTRUM_CAPS  (0)
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+#if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN)
+/**
+ * Ranging parameter of the ongoing ranging procedure at the Initiator or
+ * Coordinator, taken from the range request profile or the RTB PIB.
+ */
+#   define RANGE_PROFILE(attr)      (range_profile.attr)
+/** A range request profile without antenna diversity asks the Reflector not to use it. */
+#   define RANGE_PROFILE_REFL_ANT   (!range_profile_used || range_profile.EnableAntennaDiv)
+#else
+#   define RANGE_PROFILE(attr)      (rtb_pib.attr)
+#   define RANGE_PROFILE_REFL_ANT   (1)
+#endif  /* #if defined(ENABLE_RTB_RANGE_PROFILE) || defined(DOXYGEN) */
+
 #if (ANTENNA_DIVERSITY == 1)
 /*
  * Always initially request antenna diversity from Reflector,
- * even if we currently are not using antenna diversity ourselves.
+ * even if we currently are not using antenna diversity ourselves,
+ * unless the range request profile disables antenna diversity.
  */
 #   define SET_INITIATOR_CAPS(x)    {x = \
-                                             (rtb_pib.EnableAntennaDiv << BIT_POS_INITIATOR_ANT) | \
-                                             (1 << BIT_POS_REFLECTOR_ANT); \
+                                             (RANGE_PROFILE(EnableAntennaDiv) << BIT_POS_INITIATOR_ANT) | \
+                                             (RANGE_PROFILE_REFL_ANT << BIT_POS_REFLECTOR_ANT) | \
+                                             INITIATOR_COMPR_CAPS | \
+                                             INITIATOR_PUSH_CAPS | \
+                                             INITIATOR_SPECTRUM_CAPS; \
 }
+#elif defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(ENABLE_RTB_PUSH_RESULTS) || \
+    defined(ENABLE_RTB_SPECTRUM)
+#   define SET_INITIATOR_CAPS(x)    {x = INITIATOR_COMPR_CAPS | INITIATOR_PUSH_CAPS | \
+                                             INITIATOR_SPECTRUM_CAPS;}
 #else   /* ANTENNA_DIVERSITY */
 #   define SET_INITIATOR_CAPS(x)
 #endif  /* (ANTENNA_DIVERSITY == 1) */
@@ -96,9 +150,96 @@
 /** Requested Ranging Transmit Power IE identifier */
 #define REQ_RANGING_TX_POWER_IE         (0x01)
 
+/** Frequency Plan IE identifier */
+#define FREQ_PLAN_IE                    (0x02)
+
+/** Compression Width IE identifier */
+#define COMPR_WIDTH_IE                  (0x03)
+
 /** Waiting time for expected next RTB frame */
 #define RTB_AWAIT_FRAME_TIME            (TAL_CONVERT_SYMBOLS_TO_US(macResponseWaitTime_def))
 
+#if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
+#ifndef RTB_REMOTE_MAX_SESSIONS
+/**
+ * Maximum number of remote ranging procedures a Coordinator
+ * may have ongoing concurrently.
+ */
+#define RTB_REMOTE_MAX_SESSIONS         (4)
+#endif  /* RTB_REMOTE_MAX_SESSIONS */
+
+/*
+ * Time the Coordinator waits for the Remote Range Confirm frame of a remote
+ * ranging procedure: the base time covers the frame exchanges independent
+ * of the sweep, the time per PMU value covers its measurement and result
+ * exchange. The Coordinator does not know whether the Initiator and the
+ * Reflector use antenna diversity, so all antenna measurement pairs are
+ * taken into account.
+ */
+#ifndef RTB_REMOTE_SESSION_BASE_TIME
+/** Time of a remote ranging procedure independent of the sweep in us */
+#define RTB_REMOTE_SESSION_BASE_TIME    (500000UL)
+#endif  /* RTB_REMOTE_SESSION_BASE_TIME */
+
+#ifndef RTB_REMOTE_SESSION_VALUE_TIME
+/** Time per PMU value of a remote ranging procedure in us */
+#define RTB_REMOTE_SESSION_VALUE_TIME   (2000UL)
+#endif  /* RTB_REMOTE_SESSION_VALUE_TIME */
+
+/** Antenna measurement pairs if both Initiator and Reflector use antenna diversity */
+#define RTB_REMOTE_SESSION_ANT_PAIRS    (4)
+
+/** Longest time the Coordinator waits for a Remote Range Confirm frame in us */
+#define RTB_REMOTE_SESSION_MAX_TIME                             \
+    (RTB_REMOTE_SESSION_BASE_TIME +                             \
+     RTB_REMOTE_SESSION_VALUE_TIME * RTB_REMOTE_SESSION_ANT_PAIRS * \
+     (2UL * (PMU_MAX_FREQ - PMU_MIN_FREQ) + 1))
+
+#ifndef RTB_REMOTE_MAX_BUSY_CONF
+/**
+ * Maximum number of Remote Range Request frames an Initiator keeps while
+ * busy, in order to reject them once the ongoing ranging is finished.
+ */
+#define RTB_REMOTE_MAX_BUSY_CONF        (2)
+#endif  /* RTB_REMOTE_MAX_BUSY_CONF */
+#endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN)
+/*
+ * TDMA schedule within the beacon payload of the Coordinator.
+ * All multi-octet fields are little endian.
+ *
+ * Octets  Field
+ * 3       RTB frame id
+ * 1       Schedule id (RTB_TDMA_SCHEDULE_ID)
+ * 1       Start of the first ranging slot after the beacon in ms
+ * 1       Duration of a ranging slot in ms
+ * 1       Number of ranging slots N
+ * N * 4   Short address of the Initiator (2) and the Reflector (2) per slot
+ */
+/** Schedule id of the TDMA schedule following the RTB frame id */
+#define RTB_TDMA_SCHEDULE_ID            (0x41)
+/** Length of the TDMA schedule before the ranging slots */
+#define RTB_TDMA_SCHEDULE_HDR_LEN       (RTB_FRAME_ID_LEN + 4)
+/** Length of a ranging slot within the TDMA schedule */
+#define RTB_TDMA_SLOT_LEN               (4)
+
+/**
+ * Number of beacon intervals a deferred range request waits for a beacon
+ * before the schedule is dropped and the ranging is started using CSMA-CA.
+ */
+#define RTB_TDMA_MAX_LOST_BEACONS       (aMaxLostBeacons)
+
+/**
+ * Guard time at the end of each ranging slot in us.
+ * No frame of a ranging is transmitted within the guard time, so that a
+ * frame started before and its acknowledgment end within the slot.
+ */
+#ifndef RTB_TDMA_GUARD_TIME_US
+#define RTB_TDMA_GUARD_TIME_US          (2000)
+#endif  /* RTB_TDMA_GUARD_TIME_US */
+#endif  /* #if defined(ENABLE_RTB_TDMA) || defined(DOXYGEN) */
+
 /* === Types ================================================================ */
 
 /**
@@ -257,6 +398,11 @@ typedef enum range_cmd_tag
 
 /* === Frame format === */
 
+/*
+ * The following types are laid over received frames,
+ * so they must not contain any padding.
+ */
+
 /** Reflector address type */
 typedef struct refl_addr_tag
 {
@@ -264,7 +410,7 @@ typedef struct refl_addr_tag
     uint8_t refl_addr_mode;
     uint16_t refl_pan_id;
     address_field_t refl_addr;
-} refl_addr_t;
+} PACKED refl_addr_t;
 
 
 #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
@@ -276,14 +422,14 @@ typedef struct prov_antenna_div_results_tag
 {
     uint8_t no_of_provided_meas_pairs;
     measurement_pair_t provided_meas_pairs[];
-} prov_antenna_div_results_t;
+} PACKED prov_antenna_div_results_t;
 #endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
 
 #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
 typedef union
 {
     prov_antenna_div_results_t prov_antenna_div_results;
-} additional_result_fields_t;
+} PACKED additional_result_fields_t;
 #endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
 
 #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
@@ -298,7 +444,7 @@ typedef struct range_remote_answer_tag
     uint8_t dqf;
     additional_result_ie_t additional_result_ie;
     additional_result_fields_t additional_result_fields;
-} range_remote_answer_t;
+} PACKED range_remote_answer_t;
 #endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
 
 
@@ -316,6 +462,35 @@ typedef enum range_error_t
     TMO_RTB_AWAIT_RESULT_REQ_FRAME = RTB_AWAIT_RESULT_REQ_FRAME         /**< Range Result Request frame not received. */
 } range_error_t;
 
+#if defined(ENABLE_RTB_STATS) || defined(DOXYGEN)
+/** Number of entries of the ranging timeout statistics, indexed by range_error_t. */
+#define RTB_TIMEOUT_STATS_LEN           (TMO_RTB_AWAIT_RESULT_REQ_FRAME + 1)
+
+/** Counts a ranging timeout in the timeout statistics. */
+#define RTB_STATS_COUNT_TIMEOUT(error)  (rtb_timeout_stats[(error)]++)
+#else
+#define RTB_STATS_COUNT_TIMEOUT(error)
+#endif  /* #if defined(ENABLE_RTB_STATS) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN)
+#ifndef RTB_TRACE_LEN
+/** Number of state transitions kept in the trace ring. */
+#define RTB_TRACE_LEN                   (64)
+#endif  /* RTB_TRACE_LEN */
+
+/** Sets the state of the RTB state machine and traces the transition. */
+#define RTB_SET_STATE(state)            do {        \
+        rtb_state = (state);                        \
+        range_trace_state(rtb_state);               \
+    } while (0)
+
+/** Traces a step of the ranging procedure that has no state of its own. */
+#define RTB_TRACE_STEP(state)           range_trace_state(state)
+#else
+#define RTB_SET_STATE(state)            (rtb_state = (state))
+#define RTB_TRACE_STEP(state)
+#endif  /* #if defined(ENABLE_RTB_TRACE) || defined(DOXYGEN) */
+
 
 
 /** General ranging data structure for parameter storage. */
@@ -344,6 +519,11 @@ typedef struct range_param_tag
     /** Transceiver capabilities negotiated between Initiator and Reflector */
     uint8_t caps;
 
+#if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(DOXYGEN)
+    /** Minimum width of compressed PMU values agreed by the Initiator */
+    uint8_t compr_min_width;
+#endif  /* #if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(DOXYGEN) */
+
 #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
     /** Remote range capabilities requested by Coordinator for Initiator */
     uint8_t remote_caps;
@@ -523,6 +703,13 @@ extern mac_pib_t mac_pib;
 #endif  /* #ifdef RTB_WITHOUT_MAC */
 extern uint8_t orig_tal_transmit_power;
 extern volatile bool timer_is_synced;
+#ifdef ENABLE_RTB_STATS
+extern uint32_t rtb_timeout_stats[];
+#endif  /* ENABLE_RTB_STATS */
+#ifdef ENABLE_RTB_RANGE_PROFILE
+extern rtb_range_profile_t range_profile;
+extern bool range_profile_used;
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
 
 /* === Prototypes =========================================================== */
 
@@ -538,7 +725,18 @@ extern "C" {
     void pmu_fill_initial_start_addr(uint8_t *ptr_to_frame);
     void pmu_fill_result_data(uint16_t no_of_values,
                               uint8_t *ptr_to_frame);
+#ifdef ENABLE_RTB_ADAPTIVE
+    uint8_t pmu_fit_freq_step(uint16_t f_start, uint16_t f_stop, uint8_t f_step);
+    uint8_t pmu_get_no_of_freq(void);
+    uint8_t pmu_get_valid_band(uint16_t *f_start, uint16_t *f_stop);
+#endif  /* ENABLE_RTB_ADAPTIVE */
+#ifdef ENABLE_RTB_SPECTRUM
+    void pmu_set_ed_frequency(uint16_t freq_mhz);
+#endif  /* ENABLE_RTB_SPECTRUM */
     uint16_t pmu_get_no_of_results_to_be_sent(void);
+#if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(ENABLE_RTB_PUSH_RESULTS)
+    uint16_t pmu_get_result_data_len(uint16_t *no_of_values);
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS || ENABLE_RTB_PUSH_RESULTS */
     void pmu_handle_received_pmu_values(uint8_t *curr_frame_ptr);
     bool pmu_more_results_to_be_expected(void);
     bool pmu_no_more_pmu_data_available(void);
@@ -549,6 +747,16 @@ extern "C" {
     void pmu_reset_fec_vars(void);
     void pmu_reset_pmu_result_vars(void);
     bool pmu_update_result_ptr(void);
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    void pmu_push_extract_window(uint8_t *ptr_to_frame);
+    void pmu_push_fill_start_addr(uint8_t *ptr_to_frame);
+    void pmu_push_fill_window(uint8_t *ptr_to_frame);
+    bool pmu_push_more_in_window(bool acked);
+    bool pmu_push_all_acked(void);
+    bool pmu_push_progress(void);
+    void pmu_push_select_window(void);
+    bool pmu_push_window_done(void);
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
 
     void range_assemble_and_tx_frame_csma(frame_msgtype_t msgtype,
                                           range_cmd_t cmd_type,
@@ -560,17 +768,61 @@ extern "C" {
                               int fec,
                               uint8_t *pmu_avg);
     void range_exit(void);
+#ifdef ENABLE_RTB_ADAPTIVE
+    void range_adaptive_init(void);
+    bool range_adaptive_refine(void);
+    void range_adaptive_start(void);
+#endif  /* ENABLE_RTB_ADAPTIVE */
+#ifdef ENABLE_RTB_BATCH
+    void range_batch_init(void);
+    bool range_batch_ongoing(void);
+    void range_batch_reject_range_req(buffer_t *msg);
+    bool range_batch_store_result(uint8_t status,
+                                  uint32_t distance,
+                                  uint8_t dqf);
+    void range_batch_task(void);
+#endif  /* ENABLE_RTB_BATCH */
 #ifdef ENABLE_RTB_REMOTE
     void range_gen_rtb_remote_range_conf(uint8_t status,
                                          uint32_t distance,
                                          uint8_t dqf,
                                          uint8_t no_of_provided_meas_pairs,
                                          measurement_pair_t *provided_meas_pairs);
+    void range_gen_rtb_remote_session_conf(wpan_addr_spec_t *initiator_addr_spec,
+                                           wpan_addr_spec_t *reflector_addr_spec,
+                                           uint8_t session_handle,
+                                           uint8_t status,
+                                           uint32_t distance,
+                                           uint8_t dqf,
+                                           uint8_t no_of_provided_meas_pairs,
+                                           measurement_pair_t *provided_meas_pairs);
+    void range_remote_busy_store(wpan_addr_spec_t *initiator_addr_spec,
+                                 wpan_addr_spec_t *reflector_addr_spec,
+                                 wpan_addr_spec_t *coordinator_addr_spec);
+    void range_remote_busy_task(void);
+    uint8_t range_remote_session_close(wpan_addr_spec_t *initiator_addr_spec,
+                                       wpan_addr_spec_t *reflector_addr_spec);
+    void range_remote_session_init(void);
+    uint8_t range_remote_session_open(wpan_addr_spec_t *initiator_addr_spec,
+                                      wpan_addr_spec_t *reflector_addr_spec);
 #endif  /* ENABLE_RTB_REMOTE */
+#ifdef ENABLE_RTB_TDMA
+    bool range_tdma_defer_range_req(buffer_t *msg);
+    void range_tdma_init(void);
+    bool range_tdma_slot_active(void);
+    bool range_tdma_slot_blocked(void);
+#endif  /* ENABLE_RTB_TDMA */
     void range_gen_rtb_range_conf(uint8_t status,
                                   uint32_t distance,
                                   uint8_t dqf);
     void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame);
+#ifdef ENABLE_RTB_RANGE_PROFILE
+    bool range_profile_load(wpan_rtb_range_req_t *wrrr);
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
+    void range_start_local_ranging(wpan_rtb_range_req_t *wrrr);
+#ifdef ENABLE_RTB_TRACE
+    void range_trace_state(rtb_state_t state);
+#endif  /* ENABLE_RTB_TRACE */
     void range_result_presentation(void);
     void range_start_await_timer(rtb_state_t current_state);
     void range_stop_await_timer(void);
@@ -582,8 +834,18 @@ extern "C" {
     void range_tx_result_conf_frame(void);
     void range_tx_result_req_frame(void);
     void reset_pmu_average_data(void);
+#ifdef ENABLE_RTB_SPECTRUM
+    void range_spectrum_accept_plan(const uint8_t *plan);
+    void range_spectrum_apply_plan(const uint8_t *plan);
+    bool range_spectrum_enabled(void);
+    void range_spectrum_fill_plan(uint8_t *ptr_to_frame);
+    void range_spectrum_init(void);
+    void range_spectrum_propose_plan(uint8_t *ptr_to_frame);
+    void range_spectrum_task(void);
+#endif  /* ENABLE_RTB_SPECTRUM */
 
     void rtb_exit_rx_tx_end_irq(void);
+    void rtb_state_machine(void);
     void rtb_sync_handler_cb(void);
     void rtb_init_rx_end_irq(void);
     void rtb_init_tx_end_irq(void);
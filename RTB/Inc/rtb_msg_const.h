@@ -45,6 +45,18 @@ typedef enum rtb_msg_code_tag
                                           ,
     RTB_PMU_VALIDITY_INDICATION         = (0xF7)  /**< */
 #endif  /* #ifndef RTB_WITHOUT_MAC */
+#ifdef ENABLE_RTB_BATCH
+                                          ,
+    RTB_RANGE_BATCH_REQUEST             = (0xF8), /**< */
+    RTB_RANGE_BATCH_CONFIRM             = (0xF9)  /**< */
+#endif  /* #ifdef ENABLE_RTB_BATCH */
+#ifdef ENABLE_RTB_BULK_PIB
+                                          ,
+    RTB_SET_BULK_REQUEST                = (0xFA), /**< */
+    RTB_SET_BULK_CONFIRM                = (0xFB), /**< */
+    RTB_GET_BULK_REQUEST                = (0xFC), /**< */
+    RTB_GET_BULK_CONFIRM                = (0xFD)  /**< */
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
 } SHORTENUM rtb_msg_code_t;
 
 /*
@@ -52,7 +64,13 @@ typedef enum rtb_msg_code_tag
  */
 /** First defined RTB message */
 #define FIRST_RTB_MESSAGE               (RTB_DATA_INDICATION)
-#ifndef RTB_WITHOUT_MAC
+#if defined(ENABLE_RTB_BULK_PIB)
+/** Last defined RTB message if bulk PIB requests are enabled */
+#   define LAST_RTB_MESSAGE             (RTB_GET_BULK_CONFIRM)
+#elif defined(ENABLE_RTB_BATCH)
+/** Last defined RTB message if batch ranging is enabled */
+#   define LAST_RTB_MESSAGE             (RTB_RANGE_BATCH_CONFIRM)
+#elif !defined(RTB_WITHOUT_MAC)
 /** Last defined RTB message for regular RTB */
 #   define LAST_RTB_MESSAGE             (RTB_PMU_VALIDITY_INDICATION)
 #else
@@ -98,6 +116,31 @@ typedef enum rtb_msg_code_tag
 /** Length of Requested Ranging Transmit Power IE. */
 #define IE_REQ_RANGING_TX_POWER_LEN     (2)
 
+/**
+ * Length of Compression Width IE.
+ *
+ * 1: Compression Width IE identifier
+ * 2: Minimum width of compressed PMU values in bits accepted by the Initiator
+ *
+ * It precedes a Frequency Plan IE, so that Reflectors without compressed
+ * PMU values can skip it.
+ */
+#define IE_COMPR_WIDTH_LEN              (2)
+
+#if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN)
+/**
+ * Length of Frequency Plan IE.
+ *
+ * 1: Frequency Plan IE identifier
+ * 2..: One bit per block of the interference map, set for a busy block
+ *
+ * Both nodes narrow the PMU sweep to the longest run of frequencies outside
+ * the busy blocks, starting and stopping at full MHz. If this run leaves
+ * fewer than PMU_PLAN_MIN_STEPS steps, the full band is swept.
+ */
+#define IE_FREQ_PLAN_LEN                (1 + RTB_SPECTRUM_PLAN_LEN)
+#endif  /* #if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN) */
+
 
 /**
  * Minimum length of Reflector Address Spec IE.
@@ -53,6 +53,76 @@ typedef struct rtb_range_conf_tag
     usr_rtb_range_conf_t range_conf;
 } rtb_range_conf_t;
 
+#if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN)
+/**
+ * @brief This is the RTB-RANGE-BATCH.request message structure.
+ */
+typedef struct rtb_range_batch_req_tag
+{
+    /** This identifies the message as \ref RTB_RANGE_BATCH_REQUEST */
+    rtb_msg_code_t cmdcode;
+    /** The parameters of the current batch. */
+    wpan_rtb_range_batch_req_t range_batch_req;
+} rtb_range_batch_req_t;
+
+/**
+ * @brief This is the RTB-RANGE-BATCH.confirm message structure.
+ */
+typedef struct rtb_range_batch_conf_tag
+{
+    /** This identifies the message as \ref RTB_RANGE_BATCH_CONFIRM */
+    rtb_msg_code_t cmdcode;
+    /** The results of the current batch. */
+    usr_rtb_range_batch_conf_t range_batch_conf;
+} rtb_range_batch_conf_t;
+#endif  /* #if defined(ENABLE_RTB_BATCH) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN)
+/**
+ * @brief This is the RTB-SET-BULK.request message structure.
+ */
+typedef struct rtb_set_bulk_req_tag
+{
+    /** This identifies the message as \ref RTB_SET_BULK_REQUEST */
+    rtb_msg_code_t cmdcode;
+    /** The PIB attributes to write. */
+    wpan_rtb_set_bulk_req_t set_bulk_req;
+} rtb_set_bulk_req_t;
+
+/**
+ * @brief This is the RTB-SET-BULK.confirm message structure.
+ */
+typedef struct rtb_set_bulk_conf_tag
+{
+    /** This identifies the message as \ref RTB_SET_BULK_CONFIRM */
+    rtb_msg_code_t cmdcode;
+    /** The result of the bulk write. */
+    usr_rtb_set_bulk_conf_t set_bulk_conf;
+} rtb_set_bulk_conf_t;
+
+/**
+ * @brief This is the RTB-GET-BULK.request message structure.
+ */
+typedef struct rtb_get_bulk_req_tag
+{
+    /** This identifies the message as \ref RTB_GET_BULK_REQUEST */
+    rtb_msg_code_t cmdcode;
+    /** The PIB attributes to read. */
+    wpan_rtb_get_bulk_req_t get_bulk_req;
+} rtb_get_bulk_req_t;
+
+/**
+ * @brief This is the RTB-GET-BULK.confirm message structure.
+ */
+typedef struct rtb_get_bulk_conf_tag
+{
+    /** This identifies the message as \ref RTB_GET_BULK_CONFIRM */
+    rtb_msg_code_t cmdcode;
+    /** The result of the bulk read and the values read. */
+    usr_rtb_get_bulk_conf_t get_bulk_conf;
+} rtb_get_bulk_conf_t;
+#endif  /* #if defined(ENABLE_RTB_BULK_PIB) || defined(DOXYGEN) */
+
 #ifndef RTB_WITHOUT_MAC
 /**
  * @brief This is the RTB-RESET.request message structure.
@@ -70,6 +70,13 @@
 /** Maximum PMU frequency step in MHz (required for further calculation) */
 #define PMU_STEP_FREQ_MAX_IN_MHZ        (4) /* == 4MHz */
 
+/** PMU verbose level: RTB-PMU-VALIDITY.indication is generated */
+#define PMU_VERBOSE_LEVEL_VALIDITY      (1)
+/** PMU verbose level: PMU values are additionally printed as text */
+#define PMU_VERBOSE_LEVEL_TEXT_DUMP     (2)
+/** PMU verbose level: PMU values are additionally sent as binary frames */
+#define PMU_VERBOSE_LEVEL_BINARY_DUMP   (3)
+
 /* === Types ================================================================ */
 
 /** Structure implementing the RTB related PIB attributes. */
@@ -20,9 +20,14 @@
 
 /* === Includes ============================================================= */
 
+#include "pal_types.h"
 #include "rtb_types.h"
 #if (RTB_TYPE == RTB_PMU_233R)
-#   include "rtb_hw_233r_xmega.h"
+#   if (PAL_GENERIC_TYPE == LINUX)
+#       include "rtb_hw_233r_linux.h"
+#   else
+#       include "rtb_hw_233r_xmega.h"
+#   endif
 #elif (RTB_TYPE == RTB_PMU_RFR2)
 #   include "rtb_hw_rfr2.h"
 #elif (RTB_TYPE == RTB_FOR_RH)
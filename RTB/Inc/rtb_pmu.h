@@ -51,6 +51,60 @@
 /** Capability field bit mask for Reflector antenna diversity */
 #define PMU_CAP_REFLECTOR_ANT           (_BV(BIT_POS_REFLECTOR_ANT))
 
+/**
+ * Bit position of the Initiator compressed results bit in capability field
+ * of Range Request frame, set if the Initiator accepts compressed PMU values.
+ */
+#define BIT_POS_INITIATOR_COMPR         (2)
+/**
+ * Bit position of the Reflector compressed results bit in capability field
+ * of Range Accept frame, set if the Reflector sends compressed PMU values.
+ * A separate bit is used, since Reflectors not supporting compression
+ * return the other capability bits unchanged.
+ */
+#define BIT_POS_REFLECTOR_COMPR         (3)
+
+/** Capability field bit mask for Initiator compressed results */
+#define PMU_CAP_INITIATOR_COMPR         (_BV(BIT_POS_INITIATOR_COMPR))
+/** Capability field bit mask for Reflector compressed results */
+#define PMU_CAP_REFLECTOR_COMPR         (_BV(BIT_POS_REFLECTOR_COMPR))
+
+/**
+ * Bit position of the Initiator push results bit in capability field
+ * of Range Request frame, set if the Initiator accepts a burst of Result
+ * Confirm frames upon a single Result Request frame.
+ */
+#define BIT_POS_INITIATOR_PUSH          (4)
+/**
+ * Bit position of the Reflector push results bit in capability field
+ * of Range Accept frame, set if the Reflector sends a burst of Result
+ * Confirm frames upon a single Result Request frame.
+ */
+#define BIT_POS_REFLECTOR_PUSH          (5)
+
+/** Capability field bit mask for Initiator push results */
+#define PMU_CAP_INITIATOR_PUSH          (_BV(BIT_POS_INITIATOR_PUSH))
+/** Capability field bit mask for Reflector push results */
+#define PMU_CAP_REFLECTOR_PUSH          (_BV(BIT_POS_REFLECTOR_PUSH))
+
+/**
+ * Bit position of the Initiator frequency plan bit in capability field
+ * of Range Request frame, set if the Range Request frame carries the
+ * frequency plan proposed by the Initiator.
+ */
+#define BIT_POS_INITIATOR_SPECTRUM      (6)
+/**
+ * Bit position of the Reflector frequency plan bit in capability field
+ * of Range Accept frame, set if the Range Accept frame carries the
+ * frequency plan both nodes sweep.
+ */
+#define BIT_POS_REFLECTOR_SPECTRUM      (7)
+
+/** Capability field bit mask for Initiator frequency plan */
+#define PMU_CAP_INITIATOR_SPECTRUM      (_BV(BIT_POS_INITIATOR_SPECTRUM))
+/** Capability field bit mask for Reflector frequency plan */
+#define PMU_CAP_REFLECTOR_SPECTRUM      (_BV(BIT_POS_REFLECTOR_SPECTRUM))
+
 
 #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN)
 /*
@@ -78,9 +132,101 @@
 #define PMU_REM_CAP_APPLY_MIN_DIST_THRSHLD  (_BV(BIT_POS_APPLY_MIN_DIST_THRSHLD))
 #endif  /* #if defined(ENABLE_RTB_REMOTE) || defined(DOXYGEN) */
 
-/** The Range Result Confirm frame must not exceed the MAC frame length. */
+/** Lowest frequency which can be set with CC_BAND 8 in MHz */
+#define PMU_CC_BAND_8_BASE_FREQ         (2322)
+
+/** Channel band used for the PMU measurement */
+#define PMU_CC_BAND                     (8)
+
+#if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN)
+/**
+ * Minimum number of phase steps of a band narrowed by a frequency plan;
+ * otherwise the full band is measured.
+ */
+#define PMU_PLAN_MIN_STEPS              (4)
+#endif  /* #if defined(ENABLE_RTB_SPECTRUM) || defined(DOXYGEN) */
+
+/**
+ * Maximum deviation of the phase step at a frequency from the mean
+ * phase step to consider the PMU value as valid (45 degree).
+ */
+#define PMU_VALIDITY_THRESHOLD          (32)
+
+/**
+ * The Range Result Confirm frame must not exceed the MAC frame length.
+ * This is also the maximum length of a block of compressed PMU values.
+ */
 #define MAX_RESULT_VALUES_PER_FRAME     (aMaxMACSafePayloadSize - CMD_RESULT_CONF_LEN)
 
+#if defined(ENABLE_RTB_PUSH_RESULTS) || defined(DOXYGEN)
+/**
+ * Maximum length of the result data of a pushed Result Confirm frame,
+ * which additionally contains the start index of its values.
+ */
+#define MAX_RESULT_VALUES_PER_PUSH_FRAME    (aMaxMACSafePayloadSize - CMD_RESULT_CONF_PUSH_LEN)
+#endif  /* #if defined(ENABLE_RTB_PUSH_RESULTS) || defined(DOXYGEN) */
+
+#if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(DOXYGEN)
+/** Width of compressed PMU values in bits that keeps them lossless. */
+#define RTB_COMPR_RESULTS_FULL_WIDTH    (8)
+
+#ifndef RTB_COMPR_RESULTS_MIN_WIDTH
+/**
+ * Minimum width of compressed PMU values in bits the Initiator accepts.
+ * By default compressed PMU values are lossless. A smaller width is requested
+ * from the Reflector by the Compression Width IE of the Range Request frame;
+ * the Reflector then truncates its PMU values down to this width if this saves
+ * Result Request/Confirm exchanges.
+ * 4 bits fit all values of a 0.5 MHz sweep into one Result Confirm frame.
+ */
+#define RTB_COMPR_RESULTS_MIN_WIDTH     (RTB_COMPR_RESULTS_FULL_WIDTH)
+#endif  /* RTB_COMPR_RESULTS_MIN_WIDTH */
+#endif  /* #if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(DOXYGEN) */
+
+/*
+ * Binary PMU capture frame, sent at PMU_VERBOSE_LEVEL_BINARY_DUMP.
+ * All multi-octet fields are little endian.
+ *
+ * Octets  Field
+ * 2       Sync (PMU_CAPTURE_SYNC_0, PMU_CAPTURE_SYNC_1)
+ * 2       Length of the payload
+ * n       Payload:
+ *         1  Frame type (PMU_CAPTURE_TYPE_PMU_VALUES)
+ *         1  Frame version (PMU_CAPTURE_VERSION)
+ *         2  Sequence number
+ *         2  Start frequency in MHz
+ *         1  Frequency step (PMU_STEP_FREQ_500kHz .. PMU_STEP_FREQ_4MHz)
+ *         1  Number of frequencies N
+ *         1  Number of antenna measurement pairs A
+ *         1  Distance offset in cm (signed)
+ *         4  Distance in cm
+ *         1  DQF in percent
+ *         A * 5  Distance (4) and DQF (1) per antenna measurement pair
+ *         A * N  Averaged PMU values of the Initiator
+ *         A * N  Averaged PMU values of the Reflector
+ * 2       CRC-16 (CCITT, reflected, initial value 0xFFFF) over length
+ *         and payload
+ *
+ * The frames are interleaved with the text output of the application;
+ * a receiver synchronizes by the sync octets and the CRC.
+ */
+/** First sync octet of a binary PMU capture frame */
+#define PMU_CAPTURE_SYNC_0              (0xA5)
+/** Second sync octet of a binary PMU capture frame */
+#define PMU_CAPTURE_SYNC_1              (0x5A)
+/** Frame type of a binary PMU capture frame containing PMU values */
+#define PMU_CAPTURE_TYPE_PMU_VALUES     (0x01)
+/** Version of the binary PMU capture frame format */
+#define PMU_CAPTURE_VERSION             (1)
+/** Length of sync and length field of a binary PMU capture frame */
+#define PMU_CAPTURE_HDR_LEN             (4)
+/** Length of the payload before the antenna measurement pair results */
+#define PMU_CAPTURE_FIXED_LEN           (15)
+/** Length of the results of an antenna measurement pair */
+#define PMU_CAPTURE_ANT_RESULT_LEN      (5)
+/** Initial value of the CRC of a binary PMU capture frame */
+#define PMU_CAPTURE_CRC_INIT            (0xFFFF)
+
 /* === Types ================================================================ */
 
 /**
@@ -89,6 +235,7 @@
 typedef enum result_frame_ie_tag
 {
     RESULT_IE_PMU_VALUES    = 0x00, /**< Information Element for PMU results values */
+    RESULT_IE_PMU_VALUES_COMPR = 0x01  /**< Information Element for bit-packed PMU results values */
 } SHORTENUM result_frame_ie_t;
 
 /**
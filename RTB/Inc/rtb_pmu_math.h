@@ -0,0 +1,196 @@
+/**
+ * @file rtb_pmu_math.h
+ *
+ * @brief PMU to distance calculation of the AT86RF233R on hosted platforms
+ *
+ * The calculation only depends on the averaged PMU values, so it is used
+ * by the Linux port of the PMU ranging as well as by host tools
+ * reprocessing captured PMU values. Both produce identical results.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef RTB_PMU_MATH_H
+#define RTB_PMU_MATH_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** Value 1.0 of the cosine and sine table */
+#define PMU_MATH_Q14_ONE                (16384L)
+
+/** Distance of an invalid measurement (same as INVALID_DISTANCE) */
+#define PMU_MATH_INVALID_DISTANCE       (0xFFFFFFFFUL)
+
+/** Width of an unpacked PMU value in bits */
+#define PMU_MATH_PACK_MAX_WIDTH         (8)
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Cosine of a phase in 1/256 cycles
+ *
+ * @param phase Phase in 1/256 cycles
+ *
+ * @return Cosine in Q14
+ */
+int16_t pmu_math_cos_q14(uint8_t phase);
+
+/**
+ * @brief Sine of a phase in 1/256 cycles
+ *
+ * @param phase Phase in 1/256 cycles
+ *
+ * @return Sine in Q14
+ */
+int16_t pmu_math_sin_q14(uint8_t phase);
+
+/**
+ * @brief Sums the phase steps of an antenna measurement pair as unit vectors
+ *
+ * The phase sums of consecutive frequencies differ by 2 * df * d / c.
+ * The phase steps are summed as unit vectors to be robust against
+ * single wrong PMU values.
+ *
+ * @param init_val Averaged PMU values of the Initiator
+ * @param refl_val Averaged PMU values of the Reflector
+ * @param no_of_freq Number of frequencies
+ * @param[out] sum_cos Sum of the cosines of the phase steps in Q14
+ * @param[out] sum_sin Sum of the sines of the phase steps in Q14
+ */
+void pmu_math_sum_steps(const uint8_t *init_val,
+                        const uint8_t *refl_val,
+                        uint8_t no_of_freq,
+                        int32_t *sum_cos,
+                        int32_t *sum_sin);
+
+/**
+ * @brief Calculates distance and quality of the summed phase steps
+ *
+ * The angle of the summed vector is the mean phase step, its length
+ * is the distance quality factor.
+ *
+ * @param sum_cos Sum of the cosines of the phase steps in Q14
+ * @param sum_sin Sum of the sines of the phase steps in Q14
+ * @param no_of_freq Number of frequencies
+ * @param f_step Frequency step (PMU_STEP_FREQ_500kHz .. PMU_STEP_FREQ_4MHz)
+ * @param dist_offset Distance offset in cm
+ * @param[out] dist_cm Distance in cm
+ * @param[out] dqf Distance quality factor in percent
+ *
+ * @return Mean phase step in 1/256 cycles
+ */
+int16_t pmu_math_steps_2_dist(int32_t sum_cos,
+                              int32_t sum_sin,
+                              uint8_t no_of_freq,
+                              uint8_t f_step,
+                              int8_t dist_offset,
+                              uint32_t *dist_cm,
+                              uint8_t *dqf);
+
+/**
+ * @brief Combines the results of all antenna measurement pairs
+ *
+ * @param dist_cm Distances of the antenna measurement pairs in cm
+ * @param dqf Distance quality factors of the antenna measurement pairs
+ * @param no_of_ant_meas Number of antenna measurement pairs
+ * @param apply_min_dist_threshold true to use the minimum distance instead
+ *                                 of the average weighted by the DQF
+ * @param[out] result_dist_cm Distance in cm
+ * @param[out] result_dqf Distance quality factor in percent
+ */
+void pmu_math_combine(const uint32_t *dist_cm,
+                      const uint8_t *dqf,
+                      uint8_t no_of_ant_meas,
+                      bool apply_min_dist_threshold,
+                      uint32_t *result_dist_cm,
+                      uint8_t *result_dqf);
+
+/**
+ * @brief Length of a block of packed PMU values
+ * @param no_of_values Number of values of the block
+ * @param width Width of the packed values in bits
+ * @return Length of the block in octets
+ */
+uint16_t pmu_math_pack_len(uint16_t no_of_values, uint8_t width);
+
+/**
+ * @brief Selects the width of the next block of packed PMU values
+ *
+ * The values are sent within the smallest number of blocks possible with
+ * min_width; the width is the largest one requiring no more blocks, so
+ * the values are only truncated if this saves a block.
+ *
+ * @param no_of_values Number of values still to be sent
+ * @param max_len Maximum length of a block in octets
+ * @param min_width Minimum width of the packed values in bits
+ * @param[out] no_of_packed_values Number of values of the next block
+ * @return Width of the packed values in bits
+ */
+uint8_t pmu_math_pack_width(uint16_t no_of_values,
+                            uint16_t max_len,
+                            uint8_t min_width,
+                            uint16_t *no_of_packed_values);
+
+/**
+ * @brief Packs PMU values into a block
+ *
+ * The block consists of one octet containing the width, followed by the
+ * upper width bits of the values packed LSB first. A dither depending on
+ * the index of the value is added before truncation.
+ *
+ * @param values PMU values in 1/256 cycles
+ * @param start Index of the first value within the antenna measurement pair
+ * @param no_of_values Number of values of the block
+ * @param width Width of the packed values in bits
+ * @param[out] block Block of packed values
+ * @return Length of the block in octets
+ */
+uint16_t pmu_math_pack(const uint8_t *values,
+                       uint16_t start,
+                       uint16_t no_of_values,
+                       uint8_t width,
+                       uint8_t *block);
+
+/**
+ * @brief Unpacks a block of PMU values
+ * @param block Block of packed values
+ * @param start Index of the first value within the antenna measurement pair
+ * @param no_of_values Number of values of the block
+ * @param[out] values PMU values in 1/256 cycles
+ * @return false if the block is invalid
+ */
+bool pmu_math_unpack(const uint8_t *block,
+                     uint16_t start,
+                     uint16_t no_of_values,
+                     uint8_t *values);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* RTB_PMU_MATH_H */
+/* EOF */
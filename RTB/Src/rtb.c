@@ -69,6 +69,25 @@ range_param_t range_param;
 /** PMU Parameter variable, it holds all PMU related ranging parameters. */
 range_param_pmu_t range_param_pmu;
 
+#ifdef ENABLE_RTB_STATS
+/**
+ * Number of ranging procedures aborted by a timeout,
+ * indexed by the range error of the timeout.
+ */
+uint32_t rtb_timeout_stats[RTB_TIMEOUT_STATS_LEN];
+#endif  /* ENABLE_RTB_STATS */
+
+#ifdef ENABLE_RTB_RANGE_PROFILE
+/**
+ * Ranging parameter of the ongoing ranging procedure at the Initiator or
+ * Coordinator, taken from the range request or from the RTB PIB.
+ */
+rtb_range_profile_t range_profile;
+
+/** Indicates whether range_profile has been given by the range request. */
+bool range_profile_used;
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
+
 /** Status variable, it holds all general measurement data. */
 range_status_t volatile range_status;
 
@@ -137,15 +156,28 @@ volatile bool timer_is_synced = false;
  */
 bool rtb_tx_in_progress = false;
 
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC)
+/* Sequence number of the next binary PMU capture frame */
+static uint16_t range_capture_seq;
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC) */
+
 /* === Prototypes ========================================================== */
 
 static void range_prepare_result_exchange(void);
 static void range_result_calculation(void);
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC)
+static void range_pmu_result_capture(void);
+static uint16_t range_capture_write(uint16_t crc, uint8_t *data, uint16_t len);
+static uint16_t range_capture_crc_update(uint16_t crc, uint8_t data);
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC) */
 static void range_start_initiator(void);
 #ifdef ENABLE_RTB_REMOTE
 static void range_start_remote(uint16_t coordinator_addr_mode);
 #endif  /* ENABLE_RTB_REMOTE */
 static void store_range_req_parameter(wpan_rtb_range_req_t *wrrr);
+#ifdef ENABLE_RTB_RANGE_PROFILE
+extern uint8_t limit_tx_pwr(uint8_t tal_pib_TransmitPower);
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
 
 /* === Implementation ====================================================== */
 
@@ -177,8 +209,31 @@ retval_t rtb_init(void)
      * no remote ranging is ongoing.
      */
     range_param.CoordinatorAddrSpec.AddrMode = 0;
+
+    /* No remote ranging session ongoing at the Coordinator. */
+    range_remote_session_init();
 #endif  /* ENABLE_RTB_REMOTE */
 
+#ifdef ENABLE_RTB_BATCH
+    /* No batch ranging ongoing. */
+    range_batch_init();
+#endif  /* ENABLE_RTB_BATCH */
+
+#ifdef ENABLE_RTB_ADAPTIVE
+    /* Adaptive frequency sweep disabled. */
+    range_adaptive_init();
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+#ifdef ENABLE_RTB_TDMA
+    /* No range request waiting for its ranging slot. */
+    range_tdma_init();
+#endif  /* ENABLE_RTB_TDMA */
+
+#ifdef ENABLE_RTB_SPECTRUM
+    /* Spectrum monitor disabled. */
+    range_spectrum_init();
+#endif  /* ENABLE_RTB_SPECTRUM */
+
     /* General PIB attribute default values */
     rtb_pib.RangingEnabled = true;      // Ranging is enabled.
     rtb_pib.DefaultAntenna = false;     // Use antenna 0 as default.
@@ -288,6 +343,26 @@ void rtb_task(void)
         }
     }
 
+    rtb_state_machine();
+
+#ifdef ENABLE_RTB_SPECTRUM
+    /* Scan the next block of the PMU band while idle. */
+    range_spectrum_task();
+#endif  /* ENABLE_RTB_SPECTRUM */
+}
+
+
+
+/**
+ * @brief Advances the RTB state machine
+ *
+ * This function is called by rtb_task() and, with
+ * ENABLE_RTB_DIRECT_DISPATCH, right after a received RTB frame has been
+ * handled, so the next frame is transmitted without waiting for the next
+ * pass of rtb_task().
+ */
+void rtb_state_machine(void)
+{
     /*
      * The RTB shall only handle its state machine if no other RTB initiated
      * frame transmission is ongoing, otherwise we may run into serious issues
@@ -296,6 +371,28 @@ void rtb_task(void)
      */
     if (!rtb_tx_in_progress)
     {
+#ifdef ENABLE_RTB_REMOTE
+        if ((RTB_IDLE == rtb_state) && (RTB_ROLE_NONE == rtb_role))
+        {
+            /*
+             * The previous ranging is finished, so Remote Range Requests
+             * received meanwhile are rejected first.
+             */
+            range_remote_busy_task();
+        }
+#endif  /* ENABLE_RTB_REMOTE */
+
+#ifdef ENABLE_RTB_BATCH
+        if ((RTB_IDLE == rtb_state) && (RTB_ROLE_NONE == rtb_role))
+        {
+            /*
+             * The previous ranging is finished, so an ongoing batch ranging
+             * continues with its next Reflector or is confirmed.
+             */
+            range_batch_task();
+        }
+#endif  /* ENABLE_RTB_BATCH */
+
         switch (rtb_state)
         {
             case RTB_INIT_RANGE_REQ_FRAME:
@@ -319,6 +416,7 @@ void rtb_task(void)
 
             case RTB_INIT_PMU_START_FRAME:
                 /* State occurs at Reflector. */
+                RTB_TRACE_STEP(RTB_PMU_MEASUREMENT);
                 pmu_perform_pmu_measurement();
                 break;
 
@@ -365,6 +463,29 @@ void rtb_range_request(uint8_t *msg)
 
     wpan_rtb_range_req_t *wrrr = &rrr.range_req;
 
+#ifdef ENABLE_RTB_BATCH
+    if (range_batch_ongoing())
+    {
+        /*
+         * Batch ranging in progress, reject new request.
+         * The buffer of the ongoing ranging must not be touched.
+         */
+        range_batch_reject_range_req((buffer_t *)msg);
+        return;
+    }
+#endif  /* ENABLE_RTB_BATCH */
+
+#ifdef ENABLE_RTB_TDMA
+    if (range_tdma_defer_range_req((buffer_t *)msg))
+    {
+        /*
+         * The request is passed again at the start of its ranging slot,
+         * or it has been rejected.
+         */
+        return;
+    }
+#endif  /* ENABLE_RTB_TDMA */
+
 #ifdef ENABLE_RTB_REMOTE
     if (wrrr->CoordinatorAddrMode != FCF_NO_ADDR)
     {
@@ -432,6 +553,32 @@ void rtb_range_request(uint8_t *msg)
         return;
     }
 
+#ifdef ENABLE_RTB_RANGE_PROFILE
+    if (!range_profile_load(wrrr))
+    {
+        /* Invalid ranging profile, reject range request. */
+#ifdef ENABLE_RTB_REMOTE
+        if (wrrr->CoordinatorAddrMode != FCF_NO_ADDR)
+        {
+            store_range_req_parameter(wrrr);
+
+            range_gen_rtb_remote_range_conf((uint8_t)RTB_INVALID_PARAMETER,
+                                            INVALID_DISTANCE,
+                                            DQF_ZERO,
+                                            0,
+                                            NULL);
+        }
+        else
+#endif  /* ENABLE_RTB_REMOTE */
+        {
+            range_gen_rtb_range_conf((uint8_t)RTB_INVALID_PARAMETER,
+                                     INVALID_DISTANCE,
+                                     DQF_ZERO);
+        }
+        return;
+    }
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
+
 #ifdef ENABLE_RTB_REMOTE
     if (wrrr->CoordinatorAddrMode != FCF_NO_ADDR)
     {
@@ -460,14 +607,32 @@ void rtb_range_request(uint8_t *msg)
             }
         }
 
+        store_range_req_parameter(wrrr);
+
+        /*
+         * Open the session to match the Remote Range Confirm frame,
+         * i.e. several remote rangings may be ongoing concurrently.
+         */
+        uint8_t session_status =
+            range_remote_session_open(&range_param.InitiatorAddrSpec,
+                                      &range_param.ReflectorAddrSpec);
+
+        if (RTB_SUCCESS != session_status)
+        {
+            range_gen_rtb_remote_range_conf(session_status,
+                                            INVALID_DISTANCE,
+                                            DQF_ZERO,
+                                            0,
+                                            NULL);
+            return;
+        }
+
         /*
          * First make MAC busy, to prevent further tasks from MAC beeing done,
          * until this ranging procedure is finished.
          */
         MAKE_MAC_BUSY();
 
-        store_range_req_parameter(wrrr);
-
         /* Remote range request. */
         range_start_remote(wrrr->CoordinatorAddrMode);
     }
@@ -478,18 +643,7 @@ void rtb_range_request(uint8_t *msg)
                (wrrr->InitiatorAddr == tal_pib.IeeeAddress))))
     {
         /* This node is Initiator. */
-
-        /*
-         * First make MAC busy, to prevent further tasks from MAC beeing done,
-         * until this ranging procedure is finished.
-         */
-        MAKE_MAC_BUSY();
-
-        store_range_req_parameter(wrrr);
-
-        /* Start a regular ranging procedure. */
-        range_status.range_error = RANGE_OK;
-        rtb_state = RTB_INIT_RANGE_REQ_FRAME;
+        range_start_local_ranging(wrrr);
     }
     else
     {
@@ -519,22 +673,104 @@ void rtb_range_request(uint8_t *msg)
     }
     else
     {
+        range_start_local_ranging(wrrr);
+    }
+#endif  /* ENABLE_RTB_REMOTE */
+}
+
+
+
+/**
+ * @brief Starts a local ranging procedure with this node as Initiator
+ *
+ * The request parameters must have been checked already.
+ *
+ * @param wrrr Pointer to the range request parameters
+ */
+void range_start_local_ranging(wpan_rtb_range_req_t *wrrr)
+{
 #ifndef RTB_WITHOUT_MAC
-        /*
-         * First make MAC busy, to prevent further tasks from MAC beeing done,
-         * until this ranging procedure is finished.
-         */
-        MAKE_MAC_BUSY();
+    /*
+     * First make MAC busy, to prevent further tasks from MAC beeing done,
+     * until this ranging procedure is finished.
+     */
+    MAKE_MAC_BUSY();
 #endif  /* #ifndef RTB_WITHOUT_MAC */
 
-        store_range_req_parameter(wrrr);
+    store_range_req_parameter(wrrr);
 
-        /* Start a regular ranging procedure. */
-        range_status.range_error = RANGE_OK;
-        rtb_state = RTB_INIT_RANGE_REQ_FRAME;
+#ifdef ENABLE_RTB_ADAPTIVE
+    range_adaptive_start();
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+    /* Start a regular ranging procedure. */
+    range_status.range_error = RANGE_OK;
+    RTB_SET_STATE(RTB_INIT_RANGE_REQ_FRAME);
+}
+
+
+
+#ifdef ENABLE_RTB_RANGE_PROFILE
+/**
+ * @brief Loads the ranging parameter of a new ranging procedure
+ *
+ * The ranging parameter are taken from the profile of the range request,
+ * if given, or else from the RTB PIB. A profile is checked like the
+ * corresponding RTB PIB attributes.
+ *
+ * @param wrrr Pointer to the range request parameters,
+ *             NULL if the ranging procedure has not been requested locally
+ *
+ * @return true if the profile is valid, false otherwise
+ */
+bool range_profile_load(wpan_rtb_range_req_t *wrrr)
+{
+    if ((NULL == wrrr) || !wrrr->UseProfile)
+    {
+        range_profile.PMUFreqStart = rtb_pib.PMUFreqStart;
+        range_profile.PMUFreqStep = rtb_pib.PMUFreqStep;
+        range_profile.PMUFreqStop = rtb_pib.PMUFreqStop;
+        range_profile.EnableAntennaDiv = rtb_pib.EnableAntennaDiv;
+        range_profile.RangingTransmitPower = rtb_pib.RangingTransmitPower;
+        range_profile.ProvideRangingTransmitPower =
+            rtb_pib.ProvideRangingTransmitPower;
+#ifndef RTB_WITHOUT_MAC
+        range_profile.ProvideAntennaDivResults =
+            rtb_pib.ProvideAntennaDivResults;
+#endif  /* #ifndef RTB_WITHOUT_MAC */
+        range_profile_used = false;
+        return true;
     }
-#endif  /* ENABLE_RTB_REMOTE */
+
+    rtb_range_profile_t *profile = &wrrr->Profile;
+
+    if ((profile->PMUFreqStart < PMU_MIN_FREQ) ||
+        (profile->PMUFreqStop > PMU_MAX_FREQ) ||
+        (profile->PMUFreqStart + PMU_STEP_FREQ_MAX_IN_MHZ >= profile->PMUFreqStop))
+    {
+        return false;
+    }
+
+    if ((PMU_STEP_FREQ_500kHz != profile->PMUFreqStep) &&
+        (PMU_STEP_FREQ_1MHz != profile->PMUFreqStep) &&
+        (PMU_STEP_FREQ_2MHz != profile->PMUFreqStep) &&
+        (PMU_STEP_FREQ_4MHz != profile->PMUFreqStep))
+    {
+        return false;
+    }
+
+    range_profile = *profile;
+#if (ANTENNA_DIVERSITY != 1)
+    /* Antenna diversity cannot be used by this node. */
+    range_profile.EnableAntennaDiv = false;
+#endif  /* (ANTENNA_DIVERSITY != 1) */
+    range_profile.RangingTransmitPower =
+        limit_tx_pwr(range_profile.RangingTransmitPower);
+    range_profile_used = true;
+
+    return true;
 }
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
 
 
 
@@ -590,6 +826,14 @@ static void store_range_req_parameter(wpan_rtb_range_req_t *wrrr)
  */
 void range_gen_rtb_range_conf(uint8_t status, uint32_t distance, uint8_t dqf)
 {
+#ifdef ENABLE_RTB_BATCH
+    if (range_batch_store_result(status, distance, dqf))
+    {
+        /* Result of a batch ranging, confirmed at the end of the batch. */
+        return;
+    }
+#endif  /* ENABLE_RTB_BATCH */
+
     rtb_range_conf_t *rrc = (rtb_range_conf_t *)BMM_BUFFER_POINTER(range_confirm_msg_ptr);
 
     rrc->cmdcode = RTB_RANGE_CONFIRM;
@@ -601,7 +845,7 @@ void range_gen_rtb_range_conf(uint8_t status, uint32_t distance, uint8_t dqf)
 #ifndef RTB_WITHOUT_MAC
     /* Add the actual measurement pairs consisting of distance and dqf if required. */
     /* This is only allowed in case the MAC layer is included. */
-    if ((rtb_pib.ProvideAntennaDivResults) &&
+    if ((RANGE_PROFILE(ProvideAntennaDivResults)) &&
         (range_param_pmu.antenna_measurement_nos > 1))
     {
         /*
@@ -642,8 +886,10 @@ void range_gen_rtb_range_conf(uint8_t status, uint32_t distance, uint8_t dqf)
 /*
  * @brief Initiates RTB remote range confirm message
  *
- * This function creates the RTB remote range confirm structure,
+ * This function creates the RTB remote range confirm structure
+ * for the remote ranging requested by this Coordinator,
  * and appends it into internal event queue.
+ * A failed remote ranging procedure of the Coordinator closes its session.
  *
  */
 void range_gen_rtb_remote_range_conf(uint8_t status,
@@ -651,6 +897,46 @@ void range_gen_rtb_remote_range_conf(uint8_t status,
                                      uint8_t dqf,
                                      uint8_t no_of_provided_meas_pairs,
                                      measurement_pair_t *provided_meas_pairs)
+{
+    uint8_t session_handle = 0;
+
+    if (RTB_ROLE_COORDINATOR == rtb_role)
+    {
+        session_handle =
+            range_remote_session_close(&range_param.InitiatorAddrSpec,
+                                       &range_param.ReflectorAddrSpec);
+    }
+
+    range_gen_rtb_remote_session_conf(&range_param.InitiatorAddrSpec,
+                                      &range_param.ReflectorAddrSpec,
+                                      session_handle,
+                                      status,
+                                      distance,
+                                      dqf,
+                                      no_of_provided_meas_pairs,
+                                      provided_meas_pairs);
+}
+
+
+
+/*
+ * @brief Initiates RTB remote range confirm message of a session
+ *
+ * This function creates the RTB remote range confirm structure,
+ * and appends it into internal event queue.
+ *
+ * @param initiator_addr_spec Address spec of the Initiator
+ * @param reflector_addr_spec Address spec of the Reflector
+ * @param session_handle Handle of the session, or 0 if none has been opened
+ */
+void range_gen_rtb_remote_session_conf(wpan_addr_spec_t *initiator_addr_spec,
+                                       wpan_addr_spec_t *reflector_addr_spec,
+                                       uint8_t session_handle,
+                                       uint8_t status,
+                                       uint32_t distance,
+                                       uint8_t dqf,
+                                       uint8_t no_of_provided_meas_pairs,
+                                       measurement_pair_t *provided_meas_pairs)
 {
     buffer_t *buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
 
@@ -663,18 +949,18 @@ void range_gen_rtb_remote_range_conf(uint8_t status,
         rrc->range_conf.ranging_type = RTB_REMOTE_RANGING;
 
         rrc->range_conf.results.remote.InitiatorAddrMode =
-            range_param.InitiatorAddrSpec.AddrMode;
+            initiator_addr_spec->AddrMode;
         rrc->range_conf.results.remote.InitiatorPANId =
-            range_param.InitiatorAddrSpec.PANId;
+            initiator_addr_spec->PANId;
         ADDR_COPY_DST_SRC_64(rrc->range_conf.results.remote.InitiatorAddr,
-                             range_param.InitiatorAddrSpec.Addr.long_address);
+                             initiator_addr_spec->Addr.long_address);
 
         rrc->range_conf.results.remote.ReflectorAddrMode =
-            range_param.ReflectorAddrSpec.AddrMode;
+            reflector_addr_spec->AddrMode;
         rrc->range_conf.results.remote.ReflectorPANId =
-            range_param.ReflectorAddrSpec.PANId;
+            reflector_addr_spec->PANId;
         ADDR_COPY_DST_SRC_64(rrc->range_conf.results.remote.ReflectorAddr,
-                             range_param.ReflectorAddrSpec.Addr.long_address);
+                             reflector_addr_spec->Addr.long_address);
 
         rrc->range_conf.results.remote.status =
             status;
@@ -682,6 +968,8 @@ void range_gen_rtb_remote_range_conf(uint8_t status,
             distance;
         rrc->range_conf.results.remote.dqf =
             dqf;
+        rrc->range_conf.results.remote.SessionHandle =
+            session_handle;
 
         /* Add the actual measurement pairs consisting of distance and dqf if required. */
         if (no_of_provided_meas_pairs)
@@ -881,6 +1169,12 @@ void rtb_reset_request(uint8_t *msg)
 /** Ranging procedure clean-up function */
 void range_exit(void)
 {
+    /*
+     * The PMU library sets the state without tracing it, so the last state
+     * of the procedure gets its time here before returning to RTB_IDLE.
+     */
+    RTB_TRACE_STEP(rtb_state);
+
     if ((RTB_ROLE_INITIATOR == rtb_role) || (RTB_ROLE_REFLECTOR == rtb_role))
     {
         /* Restore regular Transmit Power. */
@@ -897,7 +1191,7 @@ void range_exit(void)
 
     /* Reset internal variables */
     rtb_role = RTB_ROLE_NONE;
-    rtb_state = RTB_IDLE;
+    RTB_SET_STATE(RTB_IDLE);
     rtb_tx_in_progress = false;
     pmu_reset_pmu_result_vars();
     pmu_reset_fec_vars();
@@ -940,16 +1234,38 @@ void configure_ranging(void)
 /** Initial preparation of result exchange procedure. */
 static void range_prepare_result_exchange(void)
 {
-    /* Prepare for exchange of PMU values. */
-    pmu_prepare_result_exchange(RESULT_IE_PMU_VALUES);
+    /* The end of the PMU measurement is set by the PMU library. */
+    RTB_TRACE_STEP(RTB_PREPARE_RESULT_EXCHANGE);
+
+    /*
+     * Prepare for exchange of PMU values.
+     * Compressed values are only requested if the Reflector
+     * has agreed to send them.
+     */
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    if (range_param.caps & PMU_CAP_REFLECTOR_COMPR)
+    {
+        pmu_prepare_result_exchange(RESULT_IE_PMU_VALUES_COMPR);
+    }
+    else
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+    {
+        pmu_prepare_result_exchange(RESULT_IE_PMU_VALUES);
+    }
 
     if (RTB_ROLE_INITIATOR == rtb_role)
     {
-        rtb_state = RTB_INIT_RESULT_REQ_FRAME;
+        RTB_SET_STATE(RTB_INIT_RESULT_REQ_FRAME);
     }
     else if (RTB_ROLE_REFLECTOR == rtb_role)
     {
-        rtb_state = RTB_AWAIT_RESULT_REQ_FRAME;
+        RTB_SET_STATE(RTB_AWAIT_RESULT_REQ_FRAME);
+
+        /*
+         * Start timer in case the first Result Request frame
+         * is not received.
+         */
+        range_start_await_timer(RTB_AWAIT_RESULT_REQ_FRAME);
     }
 }
 
@@ -970,11 +1286,29 @@ void range_result_presentation(void)
          * but sent the data back to the Coordinator.
          */
         range_status.range_error = RANGE_OK;
-        rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+        RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
     }
     else
 #endif  /* ENABLE_RTB_REMOTE */
     {
+#ifdef ENABLE_RTB_ADAPTIVE
+        if (range_adaptive_refine())
+        {
+            /*
+             * The sweep is of poor quality, so the ranging procedure is
+             * repeated right away with the dense sweep instead of being
+             * confirmed. The address parameters are kept.
+             */
+            range_exit();
+#ifndef RTB_WITHOUT_MAC
+            MAKE_MAC_BUSY();
+#endif  /* #ifndef RTB_WITHOUT_MAC */
+            range_status.range_error = RANGE_OK;
+            RTB_SET_STATE(RTB_INIT_RANGE_REQ_FRAME);
+            return;
+        }
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
 #ifndef RTB_WITHOUT_MAC
         pmu_result_presentation();
 #endif  /* #ifndef RTB_WITHOUT_MAC */
@@ -994,14 +1328,155 @@ void range_result_presentation(void)
 static void range_result_calculation(void)
 {
 #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT)&& !defined(RTB_WITHOUT_MAC)
-    if ((range_status.range_error == RANGE_OK) && (rtb_pib.PMUVerboseLevel > 1))
+    /*
+     * The text dump is only printed at its own level, i.e. no longer at
+     * every level above PMU_VERBOSE_LEVEL_VALIDITY: the binary capture is
+     * meant to run at full ranging rate, which the text dump would defeat.
+     */
+    if ((range_status.range_error == RANGE_OK) &&
+        (rtb_pib.PMUVerboseLevel == PMU_VERBOSE_LEVEL_TEXT_DUMP))
     {
         pmu_range_pmu_result_dump();
     }
 #endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT)&& !defined(RTB_WITHOUT_MAC) */
 
     pmu_math_pmu_2_dist(); //range_pmu_result_data is shared between the static lib functions only!
+
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC)
+    /* The binary capture contains the results, so it follows the calculation. */
+    if ((range_status.range_error == RANGE_OK) &&
+        (rtb_pib.PMUVerboseLevel == PMU_VERBOSE_LEVEL_BINARY_DUMP))
+    {
+        range_pmu_result_capture();
+    }
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC) */
+}
+
+
+
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC)
+/**
+ * @brief Sends the PMU values and the results as binary capture frame
+ *
+ * The frame format is described in rtb_pmu.h. The averaged PMU values are
+ * taken from pmu_avg_data, which points into range_pmu_result_data of the
+ * PMU implementation, so the capture works with the PMU libraries as well.
+ * Compared to the text dump the frame is about ten times shorter, so it can
+ * be sent for every measurement even at full ranging rate.
+ */
+static void range_pmu_result_capture(void)
+{
+    uint8_t ant_nos = pmu_avg_data.no_of_ant_meas;
+    uint8_t no_of_freq = pmu_avg_data.no_of_freq;
+    uint16_t len;
+    uint8_t hdr[PMU_CAPTURE_HDR_LEN + PMU_CAPTURE_FIXED_LEN +
+                PMU_CAPTURE_ANT_RESULT_LEN * PMU_MAX_NO_ANTENNAS];
+    uint8_t *ptr = hdr;
+    uint16_t crc;
+    uint8_t ant_meas;
+
+    if ((NULL == pmu_avg_data.p_pmu_avg_init) ||
+        (NULL == pmu_avg_data.p_pmu_avg_refl) ||
+        (ant_nos > PMU_MAX_NO_ANTENNAS))
+    {
+        return;
+    }
+
+    len = PMU_CAPTURE_FIXED_LEN +
+          ant_nos * (PMU_CAPTURE_ANT_RESULT_LEN + 2 * (uint16_t)no_of_freq);
+
+    *ptr++ = PMU_CAPTURE_SYNC_0;
+    *ptr++ = PMU_CAPTURE_SYNC_1;
+    *ptr++ = (uint8_t)len;
+    *ptr++ = (uint8_t)(len >> 8);
+    *ptr++ = PMU_CAPTURE_TYPE_PMU_VALUES;
+    *ptr++ = PMU_CAPTURE_VERSION;
+    *ptr++ = (uint8_t)range_capture_seq;
+    *ptr++ = (uint8_t)(range_capture_seq >> 8);
+    *ptr++ = (uint8_t)range_param_pmu.f_start;
+    *ptr++ = (uint8_t)(range_param_pmu.f_start >> 8);
+    *ptr++ = range_param_pmu.f_step;
+    *ptr++ = no_of_freq;
+    *ptr++ = ant_nos;
+    *ptr++ = (uint8_t)rtb_dist_offset;
+    convert_32_bit_to_byte_array(range_status.distance_cm, ptr);
+    ptr += sizeof(uint32_t);
+    *ptr++ = range_status.dqf;
+    for (ant_meas = 0; ant_meas < ant_nos; ant_meas++)
+    {
+        convert_32_bit_to_byte_array(range_status_pmu.measured_distance_cm[ant_meas],
+                                     ptr);
+        ptr += sizeof(uint32_t);
+        *ptr++ = range_status_pmu.measured_dqf[ant_meas];
+    }
+    range_capture_seq++;
+
+    /* The sync octets are not covered by the CRC. */
+    sio_binarywrite(hdr, 2);
+    crc = range_capture_write(PMU_CAPTURE_CRC_INIT, &hdr[2], (uint16_t)(ptr - &hdr[2]));
+    for (ant_meas = 0; ant_meas < ant_nos; ant_meas++)
+    {
+        crc = range_capture_write(crc,
+                                  pmu_avg_data.p_pmu_avg_init +
+                                  ant_meas * pmu_avg_data.ant_meas_ptr_offset,
+                                  no_of_freq);
+    }
+    for (ant_meas = 0; ant_meas < ant_nos; ant_meas++)
+    {
+        crc = range_capture_write(crc,
+                                  pmu_avg_data.p_pmu_avg_refl +
+                                  ant_meas * pmu_avg_data.ant_meas_ptr_offset,
+                                  no_of_freq);
+    }
+
+    hdr[0] = (uint8_t)crc;
+    hdr[1] = (uint8_t)(crc >> 8);
+    sio_binarywrite(hdr, 2);
+}
+
+
+
+/**
+ * @brief Sends data of a binary capture frame and updates its CRC
+ *
+ * @param crc Current CRC
+ * @param data Data to be sent
+ * @param len Length of the data
+ *
+ * @return Updated CRC
+ */
+static uint16_t range_capture_write(uint16_t crc, uint8_t *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc = range_capture_crc_update(crc, data[i]);
+    }
+    sio_binarywrite(data, (int16_t)len);
+
+    return crc;
+}
+
+
+
+/**
+ * @brief Computes the CCITT-CRC16 on a byte by byte basis
+ *
+ * Same algorithm as _crc_ccitt_update() of avr-libc.
+ *
+ * @param crc Current crc value
+ * @param data Next byte that should be included into the CRC16
+ *
+ * @return updated CRC16
+ */
+static uint16_t range_capture_crc_update(uint16_t crc, uint8_t data)
+{
+    data ^= crc & 0xFF;
+    data ^= data << 4;
+
+    return ((((uint16_t)data << 8) | ((crc & 0xFF00) >> 8)) ^
+            (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
 }
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) && !defined(RTB_WITHOUT_MAC) */
 
 
 
@@ -1010,6 +1485,9 @@ void range_start_await_timer(rtb_state_t current_state)
     retval_t timer_status;
     last_rtb_state = current_state;
 
+    /* Callers may await a frame without changing the state. */
+    RTB_TRACE_STEP(current_state);
+
     timer_status = pal_timer_start(T_RTB_Wait_Time,
                                    RTB_AWAIT_FRAME_TIME,
                                    TIMEOUT_RELATIVE,
@@ -1043,6 +1521,7 @@ void range_t_await_frame_cb(void *callback_parameter)
             {
                 /* Happens at Initiator. */
                 range_status.range_error = TMO_RTB_AWAIT_RANGE_ACPT_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_AWAIT_RANGE_ACPT_FRAME);
 
                 handle_range_frame_error(RTB_TIMEOUT);
             }
@@ -1052,6 +1531,7 @@ void range_t_await_frame_cb(void *callback_parameter)
             {
                 /* Happens at Reflector. */
                 range_status.range_error = TMO_RTB_AWAIT_TIME_SYNC_REQ_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_AWAIT_TIME_SYNC_REQ_FRAME);
 
                 /* Clean-up RTB */
                 range_exit();
@@ -1062,6 +1542,7 @@ void range_t_await_frame_cb(void *callback_parameter)
             {
                 /* Happens at Initiator. */
                 range_status.range_error = TMO_RTB_AWAIT_PMU_START_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_AWAIT_PMU_START_FRAME);
 
                 handle_range_frame_error(RTB_TIMEOUT);
             }
@@ -1071,6 +1552,7 @@ void range_t_await_frame_cb(void *callback_parameter)
             {
                 /* Happens at Reflector. */
                 range_status.range_error = TMO_RTB_INIT_PMU_START_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_INIT_PMU_START_FRAME);
 
                 /* Clean-up RTB */
                 range_exit();
@@ -1080,7 +1562,21 @@ void range_t_await_frame_cb(void *callback_parameter)
         case RTB_AWAIT_RESULT_CONF_FRAME:
             {
                 /* Happens at Initiator. */
+#ifdef ENABLE_RTB_PUSH_RESULTS
+                if ((range_param.caps & PMU_CAP_REFLECTOR_PUSH) &&
+                    pmu_push_progress())
+                {
+                    /*
+                     * The end of the burst got lost,
+                     * request the missing values again.
+                     */
+                    RTB_SET_STATE(RTB_INIT_RESULT_REQ_FRAME);
+                    break;
+                }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
                 range_status.range_error = TMO_RTB_AWAIT_RESULT_CONF_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_AWAIT_RESULT_CONF_FRAME);
 
                 handle_range_frame_error(RTB_TIMEOUT);
             }
@@ -1090,6 +1586,7 @@ void range_t_await_frame_cb(void *callback_parameter)
             {
                 /* Happens at Reflector. */
                 range_status.range_error = TMO_RTB_AWAIT_RESULT_REQ_FRAME;
+                RTB_STATS_COUNT_TIMEOUT(TMO_RTB_AWAIT_RESULT_REQ_FRAME);
 
                 /* Clean-up RTB */
                 range_exit();
@@ -1116,7 +1613,7 @@ void handle_range_frame_error(uint8_t error)
          * Notify Coordinator in error case.
          */
         range_status.range_error = (range_error_t)error;
-        rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+        RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
     }
     else
 #endif  /* ENABLE_RTB_REMOTE */
@@ -0,0 +1,214 @@
+/**
+ * @file rtb_adaptive.c
+ *
+ * @brief Adaptive frequency sweep of local rangings
+ *
+ * A local ranging first sweeps the configured PMU band. If its DQF or
+ * its share of valid PMU values is too low, the ranging is not confirmed,
+ * but repeated right away by a dense sweep restricted to the useful band
+ * of the first sweep, i.e. from its first to its last valid PMU value.
+ * The dense sweep is applied by overwriting the ranging profile of the
+ * ongoing ranging, so ENABLE_RTB_RANGE_PROFILE is required.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_ADAPTIVE)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "tal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+/** Default share of valid PMU values of a sweep of good quality in percent */
+#define ADAPTIVE_DEFAULT_MIN_VALID      (75)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/** Configuration of the adaptive frequency sweep */
+static rtb_adaptive_config_t adaptive_config;
+
+/** Statistics of the adaptive frequency sweep */
+static rtb_adaptive_stats_t adaptive_stats;
+
+/** Indicates that the ongoing local ranging performs the dense sweep. */
+static bool adaptive_dense_sweep;
+
+/** Number of frequencies measured so far by the ongoing local ranging */
+static uint16_t adaptive_no_of_freq;
+
+/* === Prototypes ========================================================== */
+
+static bool adaptive_poor_quality(uint8_t no_of_valid, uint8_t no_of_freq);
+static bool adaptive_load_dense_sweep(uint16_t f_start, uint16_t f_stop);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the adaptive frequency sweep
+ *
+ * The adaptive frequency sweep is disabled and its statistics are cleared.
+ */
+void range_adaptive_init(void)
+{
+    adaptive_config.Enabled = false;
+    adaptive_config.DQFThreshold = 0;
+    adaptive_config.MinValidPercent = ADAPTIVE_DEFAULT_MIN_VALID;
+    adaptive_config.DenseFreqStep = PMU_STEP_FREQ_500kHz;
+    memset(&adaptive_stats, 0, sizeof(adaptive_stats));
+    adaptive_dense_sweep = false;
+    adaptive_no_of_freq = 0;
+}
+
+
+
+/**
+ * @brief Marks the start of a new local ranging
+ *
+ * The first sweep of the ranging uses its regular ranging profile.
+ */
+void range_adaptive_start(void)
+{
+    adaptive_dense_sweep = false;
+    adaptive_no_of_freq = 0;
+}
+
+
+
+/**
+ * @brief Evaluates the finished sweep of a local ranging
+ *
+ * This function is called after the result calculation of a local ranging,
+ * before its result is presented. In case of a poor first sweep the
+ * ranging profile is changed to the dense sweep.
+ *
+ * @return true if the ranging shall be repeated with the dense sweep,
+ *         false if its result shall be presented
+ */
+bool range_adaptive_refine(void)
+{
+    uint8_t no_of_freq = pmu_get_no_of_freq();
+
+    adaptive_no_of_freq += no_of_freq;
+
+    if (adaptive_config.Enabled && !adaptive_dense_sweep && (no_of_freq > 0))
+    {
+        uint16_t f_start;
+        uint16_t f_stop;
+        uint8_t no_of_valid = pmu_get_valid_band(&f_start, &f_stop);
+
+        if (adaptive_poor_quality(no_of_valid, no_of_freq) &&
+            adaptive_load_dense_sweep(f_start, f_stop))
+        {
+            adaptive_dense_sweep = true;
+            adaptive_stats.NoOfDenseSweeps++;
+            return true;
+        }
+    }
+
+    adaptive_stats.NoOfRangings++;
+    adaptive_stats.NoOfFrequencies += adaptive_no_of_freq;
+
+    return false;
+}
+
+
+
+uint8_t rtb_adaptive_set_config(rtb_adaptive_config_t *config)
+{
+    if ((config->DQFThreshold > 100) ||
+        (config->MinValidPercent > 100) ||
+        (config->DenseFreqStep > PMU_STEP_FREQ_4MHz))
+    {
+        return (uint8_t)RTB_INVALID_PARAMETER;
+    }
+
+    adaptive_config = *config;
+
+    return (uint8_t)RTB_SUCCESS;
+}
+
+
+
+void rtb_adaptive_get_stats(rtb_adaptive_stats_t *stats)
+{
+    *stats = adaptive_stats;
+}
+
+
+
+/* Helper function checking whether the finished sweep is of poor quality. */
+static bool adaptive_poor_quality(uint8_t no_of_valid, uint8_t no_of_freq)
+{
+    return ((range_status.dqf < adaptive_config.DQFThreshold) ||
+            (((uint16_t)no_of_valid * 100) <
+             ((uint16_t)adaptive_config.MinValidPercent * no_of_freq)));
+}
+
+
+
+/**
+ * @brief Changes the ranging profile to the dense sweep of a band
+ *
+ * The band is widened within the band of the first sweep until it is
+ * accepted like the PMU band of the RTB PIB.
+ *
+ * @param f_start Start frequency of the useful band in MHz
+ * @param f_stop Stop frequency of the useful band in MHz
+ *
+ * @return true if the dense sweep is finer than the first sweep
+ */
+static bool adaptive_load_dense_sweep(uint16_t f_start, uint16_t f_stop)
+{
+    uint8_t f_step;
+
+    while (f_stop <= (f_start + PMU_STEP_FREQ_MAX_IN_MHZ))
+    {
+        if (f_stop < (uint16_t)range_param_pmu.f_stop)
+        {
+            f_stop++;
+        }
+        else if (f_start > (uint16_t)range_param_pmu.f_start)
+        {
+            f_start--;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    f_step = pmu_fit_freq_step(f_start, f_stop, adaptive_config.DenseFreqStep);
+    if (f_step >= range_param_pmu.f_step)
+    {
+        /* The dense sweep would not measure any additional frequency. */
+        return false;
+    }
+
+    range_profile.PMUFreqStart = f_start;
+    range_profile.PMUFreqStep = f_step;
+    range_profile.PMUFreqStop = f_stop;
+
+    return true;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_ADAPTIVE) */
+
+/* EOF */
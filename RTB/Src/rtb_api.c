@@ -37,6 +37,11 @@
 
 /* === Macros ============================================================== */
 
+#ifdef ENABLE_BMM_STATS
+/* The requests of the RTB API are accounted to the application. */
+#undef BMM_OWNER
+#define BMM_OWNER                       (BMM_OWNER_APP)
+#endif  /* ENABLE_BMM_STATS */
 
 /* === Globals ============================================================= */
 
@@ -61,7 +66,7 @@ bool wpan_rtb_reset_req(void)
     buffer_t *buffer_header;
     rtb_reset_req_t *rtb_reset_req;
 
-    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    buffer_header = bmm_buffer_alloc(BMM_MSG_SIZE(sizeof(rtb_reset_req_t)));
 
     /* Check for buffer availability */
     if (NULL == buffer_header)
@@ -95,7 +100,7 @@ bool wpan_rtb_set_req(wpan_rtb_set_req_t *wrsr)
     rtb_set_req_t *rtb_set_req;
     uint8_t pib_attribute_octet_no;
 
-    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    buffer_header = bmm_buffer_alloc(BMM_MSG_SIZE(sizeof(rtb_set_req_t)));
 
     /* Check for buffer availability */
     if (NULL == buffer_header)
@@ -180,6 +185,142 @@ bool wpan_rtb_range_req(wpan_rtb_range_req_t *wrrr)
 
 
 
+#ifdef ENABLE_RTB_BATCH
+/**
+ * Initiate RTB-RANGE-BATCH.request service and have it placed in the RTB-SAP queue.
+ *
+ * @param wrrbr Pointer to wpan_rtb_range_batch_req_t structure containing the
+ *              Initiator and the list of Reflectors.
+ *
+ * @return true - success; false - buffer not available or queue full.
+ */
+bool wpan_rtb_range_batch_req(wpan_rtb_range_batch_req_t *wrrbr)
+{
+    buffer_t *buffer_header;
+    rtb_range_batch_req_t *rtb_range_batch_req;
+
+    /* Allocate a large buffer for rtb range batch request */
+    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+
+    if (NULL == buffer_header)
+    {
+        /* Buffer is not available */
+        return false;
+    }
+
+    /* Get the buffer body from buffer header */
+    rtb_range_batch_req = (rtb_range_batch_req_t *)BMM_BUFFER_POINTER(buffer_header);
+
+    /* Construct rtb_range_batch_req_t message */
+    rtb_range_batch_req->cmdcode = RTB_RANGE_BATCH_REQUEST;
+
+    memcpy(&rtb_range_batch_req->range_batch_req, wrrbr,
+           sizeof(wpan_rtb_range_batch_req_t));
+
+#ifdef RTB_WITHOUT_MAC
+    /* Insert message into NHLE RTB queue */
+    qmm_queue_append(&nhle_rtb_q, buffer_header);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Insert message into NHLE MAC queue */
+    qmm_queue_append(&nhle_mac_q, buffer_header);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+
+    return true;
+}
+#endif  /* #ifdef ENABLE_RTB_BATCH */
+
+
+
+#ifdef ENABLE_RTB_BULK_PIB
+/**
+ * Initiate RTB-SET-BULK.request service and have it placed in the RTB-SAP queue.
+ *
+ * @param wrsbr Pointer to wpan_rtb_set_bulk_req_t structure containing the
+ *              list of PIB attributes to be written.
+ *
+ * @return true - success; false - buffer not available or queue full.
+ */
+bool wpan_rtb_set_bulk_req(wpan_rtb_set_bulk_req_t *wrsbr)
+{
+    buffer_t *buffer_header;
+    rtb_set_bulk_req_t *rtb_set_bulk_req;
+
+    /* Allocate a large buffer for rtb set bulk request */
+    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+
+    if (NULL == buffer_header)
+    {
+        /* Buffer is not available */
+        return false;
+    }
+
+    /* Get the buffer body from buffer header */
+    rtb_set_bulk_req = (rtb_set_bulk_req_t *)BMM_BUFFER_POINTER(buffer_header);
+
+    /* Construct rtb_set_bulk_req_t message */
+    rtb_set_bulk_req->cmdcode = RTB_SET_BULK_REQUEST;
+
+    memcpy(&rtb_set_bulk_req->set_bulk_req, wrsbr,
+           sizeof(wpan_rtb_set_bulk_req_t));
+
+#ifdef RTB_WITHOUT_MAC
+    /* Insert message into NHLE RTB queue */
+    qmm_queue_append(&nhle_rtb_q, buffer_header);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Insert message into NHLE MAC queue */
+    qmm_queue_append(&nhle_mac_q, buffer_header);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+
+    return true;
+}
+
+
+
+/**
+ * Initiate RTB-GET-BULK.request service and have it placed in the RTB-SAP queue.
+ *
+ * @param wrgbr Pointer to wpan_rtb_get_bulk_req_t structure containing the
+ *              list of PIB attributes to be read.
+ *
+ * @return true - success; false - buffer not available or queue full.
+ */
+bool wpan_rtb_get_bulk_req(wpan_rtb_get_bulk_req_t *wrgbr)
+{
+    buffer_t *buffer_header;
+    rtb_get_bulk_req_t *rtb_get_bulk_req;
+
+    /* Allocate a large buffer for rtb get bulk request */
+    buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+
+    if (NULL == buffer_header)
+    {
+        /* Buffer is not available */
+        return false;
+    }
+
+    /* Get the buffer body from buffer header */
+    rtb_get_bulk_req = (rtb_get_bulk_req_t *)BMM_BUFFER_POINTER(buffer_header);
+
+    /* Construct rtb_get_bulk_req_t message */
+    rtb_get_bulk_req->cmdcode = RTB_GET_BULK_REQUEST;
+
+    memcpy(&rtb_get_bulk_req->get_bulk_req, wrgbr,
+           sizeof(wpan_rtb_get_bulk_req_t));
+
+#ifdef RTB_WITHOUT_MAC
+    /* Insert message into NHLE RTB queue */
+    qmm_queue_append(&nhle_rtb_q, buffer_header);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Insert message into NHLE MAC queue */
+    qmm_queue_append(&nhle_mac_q, buffer_header);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+
+    return true;
+}
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
+
+
+
 #ifdef RTB_WITHOUT_MAC
 /*
  * MAC is not available, therefore the functions wpan_init and
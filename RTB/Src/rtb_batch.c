@@ -0,0 +1,306 @@
+/**
+ * @file rtb_batch.c
+ *
+ * @brief Batch ranging with several Reflectors
+ *
+ * This file implements the RTB-RANGE-BATCH.request, which ranges with a
+ * list of Reflectors back-to-back and delivers all results by one
+ * RTB-RANGE-BATCH.confirm. Each single ranging is a regular local ranging
+ * procedure; only its confirm is collected instead of being sent to the
+ * NHLE.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_BATCH)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "tal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/**
+ * Buffer of the ongoing batch ranging.
+ * It holds the request until all Reflectors are ranged with and is
+ * re-used for the confirm afterwards, so the batch can always be confirmed.
+ * NULL if no batch ranging is ongoing.
+ */
+static buffer_t *batch_msg_ptr = NULL;
+
+/** Index of the Reflector currently (or next) ranged with. */
+static uint8_t batch_idx;
+
+/** Number of Reflectors of the ongoing batch ranging. */
+static uint8_t batch_no_of_reflectors;
+
+/** Indicates that a single ranging of the batch is ongoing. */
+static bool batch_ranging_ongoing;
+
+/** Collected results of the ongoing batch ranging. */
+static batch_ranging_result_t batch_results[RTB_BATCH_MAX_REFLECTORS];
+
+/* === Prototypes ========================================================== */
+
+static void batch_gen_conf(buffer_t *msg,
+                           uint8_t status,
+                           uint8_t no_of_results);
+static bool batch_initiator_valid(wpan_rtb_range_batch_req_t *wrrbr);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the batch ranging
+ *
+ * Any ongoing batch ranging is aborted silently.
+ */
+void range_batch_init(void)
+{
+    if (NULL != batch_msg_ptr)
+    {
+        bmm_buffer_free(batch_msg_ptr);
+        batch_msg_ptr = NULL;
+    }
+    batch_ranging_ongoing = false;
+}
+
+
+
+/**
+ * @brief Checks whether a batch ranging is ongoing
+ *
+ * @return true if a batch ranging is ongoing
+ */
+bool range_batch_ongoing(void)
+{
+    return (NULL != batch_msg_ptr);
+}
+
+
+
+/**
+ * @brief Handles the RTB-RANGE-BATCH.request
+ *
+ * @param msg Pointer to the RTB-RANGE-BATCH.request parameter
+ */
+void rtb_range_batch_request(uint8_t *msg)
+{
+    rtb_range_batch_req_t *rrbr =
+        (rtb_range_batch_req_t *)BMM_BUFFER_POINTER((buffer_t *)msg);
+    wpan_rtb_range_batch_req_t *wrrbr = &rrbr->range_batch_req;
+
+    if (!rtb_pib.RangingEnabled)
+    {
+        /* Ranging is currently disabled, reject new request. */
+        batch_gen_conf((buffer_t *)msg, (uint8_t)RTB_UNSUPPORTED_RANGING, 0);
+        return;
+    }
+
+    if ((NULL != batch_msg_ptr) || (RTB_ROLE_NONE != rtb_role))
+    {
+        /* Ranging procedure in progress, reject new request. */
+        batch_gen_conf((buffer_t *)msg, (uint8_t)RTB_RANGING_IN_PROGRESS, 0);
+        return;
+    }
+
+    if ((0 == wrrbr->NoOfReflectors) ||
+        (wrrbr->NoOfReflectors > RTB_BATCH_MAX_REFLECTORS) ||
+        !batch_initiator_valid(wrrbr))
+    {
+        /* Invalid parameters received. Reject batch request. */
+        batch_gen_conf((buffer_t *)msg, (uint8_t)RTB_INVALID_PARAMETER, 0);
+        return;
+    }
+
+    /* The request is kept in its buffer until the batch is finished. */
+    batch_msg_ptr = (buffer_t *)msg;
+    batch_no_of_reflectors = wrrbr->NoOfReflectors;
+    batch_idx = 0;
+    batch_ranging_ongoing = false;
+
+    /* The first ranging is started by range_batch_task(). */
+}
+
+
+
+/**
+ * @brief Continues the ongoing batch ranging
+ *
+ * This function is called from rtb_task() while the RTB is idle.
+ * It starts the ranging with the next Reflector, or generates the
+ * RTB-RANGE-BATCH.confirm once all Reflectors are ranged with.
+ */
+void range_batch_task(void)
+{
+    if ((NULL == batch_msg_ptr) || batch_ranging_ongoing)
+    {
+        return;
+    }
+
+    if (batch_idx < batch_no_of_reflectors)
+    {
+        rtb_range_batch_req_t *rrbr =
+            (rtb_range_batch_req_t *)BMM_BUFFER_POINTER(batch_msg_ptr);
+        wpan_rtb_range_batch_req_t *wrrbr = &rrbr->range_batch_req;
+        reflector_addr_spec_t *refl = &wrrbr->Reflectors[batch_idx];
+        wpan_rtb_range_req_t wrrr;
+
+        memset(&wrrr, 0, sizeof(wrrr));
+#ifdef ENABLE_RTB_REMOTE
+        wrrr.CoordinatorAddrMode = FCF_NO_ADDR;
+#endif  /* ENABLE_RTB_REMOTE */
+        wrrr.InitiatorAddrMode = wrrbr->InitiatorAddrMode;
+        wrrr.InitiatorPANId = wrrbr->InitiatorPANId;
+        wrrr.InitiatorAddr = wrrbr->InitiatorAddr;
+        wrrr.ReflectorAddrMode = refl->ReflectorAddrMode;
+        wrrr.ReflectorPANId = refl->ReflectorPANId;
+        wrrr.ReflectorAddr = refl->ReflectorAddr;
+
+        batch_ranging_ongoing = true;
+#ifdef ENABLE_RTB_RANGE_PROFILE
+        /* The batch rangings use the RTB PIB. */
+        range_profile_load(&wrrr);
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
+        range_start_local_ranging(&wrrr);
+    }
+    else
+    {
+        buffer_t *msg = batch_msg_ptr;
+
+        batch_msg_ptr = NULL;
+        batch_gen_conf(msg, (uint8_t)RTB_SUCCESS, batch_no_of_reflectors);
+    }
+}
+
+
+
+/**
+ * @brief Stores the result of a single ranging of the batch
+ *
+ * This function is called instead of generating an RTB-RANGE.confirm.
+ *
+ * @param status Ranging status
+ * @param distance Calculated distance in cm
+ * @param dqf Calculated DQF in percent
+ *
+ * @return true if the result belongs to the ongoing batch ranging,
+ *         false if a regular RTB-RANGE.confirm shall be generated
+ */
+bool range_batch_store_result(uint8_t status, uint32_t distance, uint8_t dqf)
+{
+    if ((NULL == batch_msg_ptr) || !batch_ranging_ongoing)
+    {
+        return false;
+    }
+
+    batch_results[batch_idx].status = status;
+    batch_results[batch_idx].distance = distance;
+    batch_results[batch_idx].dqf = dqf;
+    batch_idx++;
+    batch_ranging_ongoing = false;
+
+    return true;
+}
+
+
+
+/**
+ * @brief Rejects an RTB-RANGE.request during an ongoing batch ranging
+ *
+ * @param msg Buffer of the RTB-RANGE.request, re-used for the confirm
+ */
+void range_batch_reject_range_req(buffer_t *msg)
+{
+    rtb_range_conf_t *rrc = (rtb_range_conf_t *)BMM_BUFFER_POINTER(msg);
+
+    rrc->cmdcode = RTB_RANGE_CONFIRM;
+    rrc->range_conf.ranging_type = RTB_LOCAL_RANGING;
+    rrc->range_conf.results.local.status = (uint8_t)RTB_RANGING_IN_PROGRESS;
+    rrc->range_conf.results.local.distance = INVALID_DISTANCE;
+    rrc->range_conf.results.local.dqf = DQF_ZERO;
+#ifndef RTB_WITHOUT_MAC
+    rrc->range_conf.results.local.no_of_provided_meas_pairs = 0;
+#endif  /* #ifndef RTB_WITHOUT_MAC */
+
+#ifdef RTB_WITHOUT_MAC
+    /* Append the RTB range confirmation message to the RTB-NHLE queue */
+    qmm_queue_append(&rtb_nhle_q, msg);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Append the RTB range confirmation message to the MAC-NHLE queue */
+    qmm_queue_append(&mac_nhle_q, msg);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+}
+
+
+
+/*
+ * @brief Initiates rtb range batch confirm message
+ *
+ * The request within the buffer is overwritten by the confirm.
+ *
+ * @param msg Buffer for the RTB range batch confirmation
+ * @param status Status of the batch
+ * @param no_of_results Number of collected results
+ */
+static void batch_gen_conf(buffer_t *msg,
+                           uint8_t status,
+                           uint8_t no_of_results)
+{
+    rtb_range_batch_conf_t *rrbc =
+        (rtb_range_batch_conf_t *)BMM_BUFFER_POINTER(msg);
+
+    rrbc->cmdcode = RTB_RANGE_BATCH_CONFIRM;
+    rrbc->range_batch_conf.status = status;
+    rrbc->range_batch_conf.NoOfResults = no_of_results;
+    memcpy(rrbc->range_batch_conf.results, batch_results,
+           no_of_results * sizeof(batch_ranging_result_t));
+
+#ifdef RTB_WITHOUT_MAC
+    /* Append the RTB range batch confirmation message to the RTB-NHLE queue */
+    qmm_queue_append(&rtb_nhle_q, msg);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Append the RTB range batch confirmation message to the MAC-NHLE queue */
+    qmm_queue_append(&mac_nhle_q, msg);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+}
+
+
+
+/* Helper function checking whether this node is the requested Initiator. */
+static bool batch_initiator_valid(wpan_rtb_range_batch_req_t *wrrbr)
+{
+#ifdef ENABLE_RTB_REMOTE
+    return ((wrrbr->InitiatorPANId == tal_pib.PANId) &&
+            (((wrrbr->InitiatorAddrMode == FCF_SHORT_ADDR) &&
+              (wrrbr->InitiatorAddr == tal_pib.ShortAddress)) ||
+             ((wrrbr->InitiatorAddrMode == FCF_LONG_ADDR) &&
+              (wrrbr->InitiatorAddr == tal_pib.IeeeAddress))));
+#else   /* ENABLE_RTB_REMOTE */
+    return !((wrrbr->InitiatorAddrMode == FCF_SHORT_ADDR) &&
+             ((BROADCAST == tal_pib.ShortAddress) ||
+              (MAC_NO_SHORT_ADDR_VALUE == tal_pib.ShortAddress)));
+#endif  /* ENABLE_RTB_REMOTE */
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_BATCH) */
+
+/* EOF */
@@ -143,6 +143,81 @@ void rtb_pmu_validitiy_ind(uint8_t *msg)
 }
 #endif  /* #ifndef RTB_WITHOUT_MAC */
 
+#ifdef ENABLE_RTB_BATCH
+/**
+ * @brief Wrapper function for messages of type rtb_range_batch_conf_t
+ *
+ * This function is a callback for rtb range batch confirm.
+ *
+ * @param m Pointer to message structure
+ */
+void rtb_range_batch_conf(uint8_t *msg)
+{
+    rtb_range_batch_conf_t *pmsg;
+    usr_rtb_range_batch_conf_t *purrbc;
+
+    /* Get the buffer body from buffer header */
+    pmsg = (rtb_range_batch_conf_t *)BMM_BUFFER_POINTER(((buffer_t *)msg));
+
+    purrbc = (usr_rtb_range_batch_conf_t *)(&(pmsg->range_batch_conf));
+
+    usr_rtb_range_batch_conf(purrbc);
+
+    /* Free the buffer */
+    bmm_buffer_free((buffer_t *)msg);
+}
+#endif  /* #ifdef ENABLE_RTB_BATCH */
+
+#ifdef ENABLE_RTB_BULK_PIB
+/**
+ * @brief Wrapper function for messages of type rtb_set_bulk_conf_t
+ *
+ * This function is a callback for rtb set bulk confirm.
+ *
+ * @param m Pointer to message structure
+ */
+void rtb_set_bulk_conf(uint8_t *msg)
+{
+    rtb_set_bulk_conf_t *pmsg;
+    usr_rtb_set_bulk_conf_t *pursbc;
+
+    /* Get the buffer body from buffer header */
+    pmsg = (rtb_set_bulk_conf_t *)BMM_BUFFER_POINTER(((buffer_t *)msg));
+
+    pursbc = (usr_rtb_set_bulk_conf_t *)(&(pmsg->set_bulk_conf));
+
+    usr_rtb_set_bulk_conf(pursbc);
+
+    /* Free the buffer */
+    bmm_buffer_free((buffer_t *)msg);
+}
+
+
+
+/**
+ * @brief Wrapper function for messages of type rtb_get_bulk_conf_t
+ *
+ * This function is a callback for rtb get bulk confirm.
+ *
+ * @param m Pointer to message structure
+ */
+void rtb_get_bulk_conf(uint8_t *msg)
+{
+    rtb_get_bulk_conf_t *pmsg;
+    usr_rtb_get_bulk_conf_t *purgbc;
+
+    /* Get the buffer body from buffer header */
+    pmsg = (rtb_get_bulk_conf_t *)BMM_BUFFER_POINTER(((buffer_t *)msg));
+
+    purgbc = (usr_rtb_get_bulk_conf_t *)(&(pmsg->get_bulk_conf));
+
+    usr_rtb_get_bulk_conf(purgbc);
+
+    /* Free the buffer */
+    bmm_buffer_free((buffer_t *)msg);
+}
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
+
 #endif  /* #ifdef ENABLE_RTB */
 
 /* EOF */
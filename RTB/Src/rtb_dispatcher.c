@@ -60,6 +60,18 @@ static FLASH_DECLARE(handler_rtb_t dispatch_rtb_table[LAST_RTB_MESSAGE - FIRST_R
     ,
     [RTB_PMU_VALIDITY_INDICATION - FIRST_RTB_MESSAGE]   = rtb_pmu_validitiy_ind
 #endif  /* #ifndef RTB_WITHOUT_MAC */
+#ifdef ENABLE_RTB_BATCH
+    ,
+    [RTB_RANGE_BATCH_REQUEST - FIRST_RTB_MESSAGE]       = rtb_range_batch_request,
+    [RTB_RANGE_BATCH_CONFIRM - FIRST_RTB_MESSAGE]       = rtb_range_batch_conf
+#endif  /* #ifdef ENABLE_RTB_BATCH */
+#ifdef ENABLE_RTB_BULK_PIB
+    ,
+    [RTB_SET_BULK_REQUEST - FIRST_RTB_MESSAGE]          = rtb_set_bulk_request,
+    [RTB_SET_BULK_CONFIRM - FIRST_RTB_MESSAGE]          = rtb_set_bulk_conf,
+    [RTB_GET_BULK_REQUEST - FIRST_RTB_MESSAGE]          = rtb_get_bulk_request,
+    [RTB_GET_BULK_CONFIRM - FIRST_RTB_MESSAGE]          = rtb_get_bulk_conf
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
 };
 
 /* === Prototypes ========================================================== */
@@ -0,0 +1,94 @@
+/**
+ * @file rtb_hw_233r_linux.c
+ *
+ * @brief Platform dependent functionality of RTB using AT86RF233R on hosted Linux
+ *
+ * This file implements platform dependent functionality within the RTB
+ * using the emulated AT86RF233R of the Linux PAL. Since both nodes of a
+ * ranging procedure are separate processes, there is no common timer to
+ * be synchronized via the timestamp IRQ; the emulated PMU provides its
+ * values independent of the exact timing of the measurement.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+/* === Includes ============================================================ */
+
+#include "rtb_types.h"
+#include "pal.h"
+#if ((RTB_TYPE == RTB_PMU_233R) && (PAL_GENERIC_TYPE == LINUX))
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+
+/* === Globals ============================================================= */
+
+
+/* === Externals =========================================================== */
+
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+void set_slp_trx_high(void)
+{
+    PAL_SLP_TR_HIGH();
+}
+
+
+
+void set_slp_trx_low(void)
+{
+    PAL_SLP_TR_LOW();
+}
+
+
+
+/**
+ * Function initializing the Timestamp IRQ to get synchronized
+ * as required for ranging.
+ */
+void rtb_tstamp_irq_init(void)
+{
+    pal_trx_irq_dis();
+
+    pal_trx_reg_read(RG_IRQ_STATUS);
+
+    /* Both nodes are synchronized by the emulated medium. */
+    timer_is_synced = true;
+}
+
+
+
+/**
+ * Function disabling the Timestamp IRQ as utilized for ranging.
+ */
+void rtb_tstamp_irq_exit(void)
+{
+    /* Clear status register. */
+    pal_trx_reg_read(RG_IRQ_STATUS);
+
+    /* Enable main Trx IRQ. */
+    pal_trx_irq_en();
+
+    /* Re-enable all interrupts. */
+    pal_global_irq_enable();
+}
+
+#endif  /* ((RTB_TYPE == RTB_PMU_233R) && (PAL_GENERIC_TYPE == LINUX)) */
+
+/* EOF */
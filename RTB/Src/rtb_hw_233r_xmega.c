@@ -29,6 +29,13 @@
 
 /* === Macros ============================================================== */
 
+#ifdef ENABLE_RTB_ADAPTIVE
+/**
+ * Unambiguous range of a PMU measurement with 0.5 MHz frequency step in cm,
+ * i.e. c / (2 * 0.5 MHz); a phase step of one cycle equals this distance.
+ */
+#define PMU_UNAMBIGUOUS_RANGE_CM        (29979L)
+#endif  /* ENABLE_RTB_ADAPTIVE */
 
 /* === Globals ============================================================= */
 
@@ -46,6 +53,10 @@ PORT_t *rtb_trx_spi_port = &TRX_SPI_PORT;
 
 /* === Prototypes ========================================================== */
 
+#ifdef ENABLE_RTB_ADAPTIVE
+static uint8_t pmu_mean_step(uint8_t ant_meas);
+static bool pmu_value_valid(uint8_t ant_meas, uint8_t idx, uint8_t mean_step);
+#endif  /* ENABLE_RTB_ADAPTIVE */
 
 /* === Implementation ====================================================== */
 
@@ -146,6 +157,193 @@ ISR(TCC1_CCA_vect)
     timer_is_synced = true; 
 }
 
+
+
+#ifdef ENABLE_RTB_ADAPTIVE
+/*
+ * The PMU library keeps its evaluation of the PMU values internal, so the
+ * adaptive frequency sweep evaluates the averaged PMU values provided by
+ * pmu_avg_data with the same criterion as the Linux port.
+ */
+uint8_t pmu_get_no_of_freq(void)
+{
+    return pmu_avg_data.no_of_freq;
+}
+
+
+
+/**
+ * @brief Gets the useful band of the finished PMU measurement
+ *
+ * A frequency is useful if its PMU value is valid for at least one
+ * antenna measurement pair; the useful band reaches from the first to the
+ * last useful frequency. Without any useful frequency the whole band of
+ * the measurement is returned.
+ *
+ * @param[out] f_start Start frequency of the useful band in MHz
+ * @param[out] f_stop Stop frequency of the useful band in MHz
+ *
+ * @return Number of useful frequencies
+ */
+uint8_t pmu_get_valid_band(uint16_t *f_start, uint16_t *f_stop)
+{
+    uint8_t no_of_freq = pmu_avg_data.no_of_freq;
+    uint8_t mean_step[PMU_MAX_NO_ANTENNAS];
+    uint8_t no_of_valid = 0;
+    uint8_t first = 0;
+    uint8_t last = no_of_freq - 1;
+    uint16_t freq;
+
+    if ((NULL == pmu_avg_data.p_pmu_avg_init) || (no_of_freq < 2))
+    {
+        /* No averaged PMU values available. */
+        *f_start = (uint16_t)range_param_pmu.f_start;
+        *f_stop = (uint16_t)range_param_pmu.f_stop;
+        return 0;
+    }
+
+    for (uint8_t ant_meas = 0; ant_meas < pmu_avg_data.no_of_ant_meas; ant_meas++)
+    {
+        mean_step[ant_meas] = pmu_mean_step(ant_meas);
+    }
+
+    for (uint8_t i = 0; i < no_of_freq; i++)
+    {
+        bool valid = false;
+
+        for (uint8_t ant_meas = 0;
+             (ant_meas < pmu_avg_data.no_of_ant_meas) && !valid;
+             ant_meas++)
+        {
+            valid = pmu_value_valid(ant_meas, i, mean_step[ant_meas]);
+        }
+
+        if (valid)
+        {
+            if (0 == no_of_valid)
+            {
+                first = i;
+            }
+            last = i;
+            no_of_valid++;
+        }
+    }
+
+    if (0 == no_of_valid)
+    {
+        last = no_of_freq - 1;
+    }
+
+    /* The frequencies are counted in 0.5 MHz. */
+    freq = (uint16_t)range_param_pmu.f_start * 2;
+    *f_start = (freq + ((uint16_t)first << range_param_pmu.f_step)) / 2;
+    *f_stop = (freq + ((uint16_t)last << range_param_pmu.f_step) + 1) / 2;
+
+    return no_of_valid;
+}
+
+
+
+/**
+ * @brief Gets the finest frequency step a PMU band can be measured with
+ *
+ * The PMU library measures every band accepted by the RTB PIB,
+ * so the requested frequency step is always kept.
+ *
+ * @param f_start Start frequency in MHz
+ * @param f_stop Stop frequency in MHz
+ * @param f_step Requested frequency step
+ *
+ * @return The requested frequency step
+ */
+uint8_t pmu_fit_freq_step(uint16_t f_start, uint16_t f_stop, uint8_t f_step)
+{
+    /* Keep compiler happy. */
+    f_start = f_start;
+    f_stop = f_stop;
+
+    return f_step;
+}
+
+
+
+/**
+ * @brief Gets the mean phase step of an antenna measurement pair
+ *
+ * The mean phase step is derived from the distance the PMU library has
+ * measured for the antenna measurement pair.
+ *
+ * @param ant_meas Antenna measurement pair
+ *
+ * @return Mean phase step in 1/256 cycles
+ */
+static uint8_t pmu_mean_step(uint8_t ant_meas)
+{
+    int32_t dist_cm = (int32_t)range_status_pmu.measured_distance_cm[ant_meas] -
+                      rtb_dist_offset;
+
+    /* The unambiguous range shrinks with each doubling of the step. */
+    return (uint8_t)((((dist_cm << range_param_pmu.f_step) * 256) +
+                      (PMU_UNAMBIGUOUS_RANGE_CM / 2)) /
+                     PMU_UNAMBIGUOUS_RANGE_CM);
+}
+
+
+
+/**
+ * @brief Checks whether the averaged PMU value of one frequency is valid
+ *
+ * A PMU value is considered as valid if the phase step towards the
+ * adjacent frequency does not deviate too much from the mean phase step.
+ *
+ * @param ant_meas Antenna measurement pair
+ * @param idx Index of the frequency
+ * @param mean_step Mean phase step of the antenna measurement pair
+ *
+ * @return true if the PMU value is valid
+ */
+static bool pmu_value_valid(uint8_t ant_meas, uint8_t idx, uint8_t mean_step)
+{
+    uint16_t offset = (uint16_t)ant_meas * pmu_avg_data.ant_meas_ptr_offset;
+    const uint8_t *init_val = pmu_avg_data.p_pmu_avg_init + offset;
+    const uint8_t *refl_val = pmu_avg_data.p_pmu_avg_refl + offset;
+    /* Step towards the next frequency, the last uses the previous. */
+    uint8_t a = (idx < (pmu_avg_data.no_of_freq - 1)) ? idx : (idx - 1);
+    uint8_t step;
+    int8_t dev;
+
+    step = (uint8_t)((init_val[a + 1] + refl_val[a + 1]) -
+                     (init_val[a] + refl_val[a]));
+    dev = (int8_t)(uint8_t)(step - mean_step);
+
+    return ((dev <= PMU_VALIDITY_THRESHOLD) && (dev >= -PMU_VALIDITY_THRESHOLD));
+}
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+
+
+#ifdef ENABLE_RTB_SPECTRUM
+/**
+ * @brief Tunes the transceiver to the frequency of an ED scan
+ *
+ * @param freq_mhz Frequency in MHz, 0 to return to the regular channel
+ */
+void pmu_set_ed_frequency(uint16_t freq_mhz)
+{
+    if (0 == freq_mhz)
+    {
+        pal_trx_bit_write(SR_CC_BAND, 0);
+        pal_trx_bit_write(SR_CC_NUMBER, 0);
+    }
+    else
+    {
+        pal_trx_bit_write(SR_CC_BAND, PMU_CC_BAND);
+        pal_trx_bit_write(SR_CC_NUMBER,
+                          (uint8_t)(freq_mhz - PMU_CC_BAND_8_BASE_FREQ));
+    }
+}
+#endif  /* ENABLE_RTB_SPECTRUM */
+
 #endif  /* ((RTB_TYPE == RTB_PMU_233R) && (PAL_GENERIC_TYPE == XMEGA)) */
 
 /* EOF */
@@ -179,7 +179,7 @@ retval_t rtb_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_t
 
 #if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH)
         case RTB_PIB_PMU_VERBOSE_LEVEL:
-            if (attribute_value->pib_value_8bit <= aRTBMaxPMUVerboseLevel)
+            if (RTB_PMU_VERBOSE_LEVEL_SUPPORTED(attribute_value->pib_value_8bit))
             {
                 /*
                  * The above comparison requires the type of
@@ -295,6 +295,118 @@ retval_t rtb_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_t
 
 
 
+#ifdef ENABLE_RTB_BULK_PIB
+/**
+ * @brief Reading of RTB PIB attributes via functional access
+ *
+ * This is the counterpart of rtb_set() and reads the same PIB attributes.
+ *
+ * @param attribute PIB attribute to be read
+ * @param attribute_value Value of the PIB attribute
+ *
+ * @return Status of the attempt to read the RTB PIB attribute:
+ *         RTB_UNSUPPORTED_ATTRIBUTE if the PIB attribute was not found
+ *         RTB_SUCCESS if the attempt to read the PIB attribute was successful
+ */
+retval_t rtb_get(uint8_t attribute, pib_value_t *attribute_value)
+{
+    retval_t status = RTB_SUCCESS;
+
+    switch (attribute)
+    {
+        case RTB_PIB_RANGING_ENABLED:
+            attribute_value->pib_value_bool = rtb_pib.RangingEnabled;
+            break;
+
+#if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH)
+        case RTB_PIB_RANGE_METHOD:
+            attribute_value->pib_value_8bit = rtb_pib.RangingMethod;
+            break;
+#endif  /* #if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH) */
+
+        case RTB_PIB_PMU_FREQ_START:
+            attribute_value->pib_value_16bit = rtb_pib.PMUFreqStart;
+            break;
+
+        case RTB_PIB_PMU_FREQ_STEP:
+            attribute_value->pib_value_8bit = rtb_pib.PMUFreqStep;
+            break;
+
+        case RTB_PIB_PMU_FREQ_STOP:
+            attribute_value->pib_value_16bit = rtb_pib.PMUFreqStop;
+            break;
+
+#if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH)
+        case RTB_PIB_PMU_VERBOSE_LEVEL:
+            attribute_value->pib_value_8bit = rtb_pib.PMUVerboseLevel;
+            break;
+#endif  /* #if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH) */
+
+        case RTB_PIB_DEFAULT_ANTENNA:
+            attribute_value->pib_value_bool = rtb_pib.DefaultAntenna;
+            break;
+
+#if (ANTENNA_DIVERSITY == 1)
+        case RTB_PIB_ENABLE_ANTENNA_DIV:
+            attribute_value->pib_value_bool = rtb_pib.EnableAntennaDiv;
+            break;
+#endif  /* (ANTENNA_DIVERSITY == 1/0) */
+
+#if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH)
+        case RTB_PIB_PROVIDE_ANTENNA_DIV_RESULTS:
+            attribute_value->pib_value_bool = rtb_pib.ProvideAntennaDivResults;
+            break;
+#endif  /* #if (!defined RTB_WITHOUT_MAC) && (!defined ENABLE_RH) */
+
+        case RTB_PIB_RANGING_TX_POWER:
+            attribute_value->pib_value_8bit = rtb_pib.RangingTransmitPower;
+            break;
+
+        case RTB_PIB_PROVIDE_RANGING_TX_POWER:
+            attribute_value->pib_value_bool = rtb_pib.ProvideRangingTransmitPower;
+            break;
+
+        case RTB_PIB_APPLY_MIN_DIST_THRESHOLD:
+            attribute_value->pib_value_bool = rtb_pib.ApplyMinDistThreshold;
+            break;
+
+#ifdef RTB_WITHOUT_MAC
+            /*
+             * MAC standard PIB attributes residing in the TAL required for the RTB
+             * are read directly from the TAL.
+             */
+        case macPANId:
+            attribute_value->pib_value_16bit = tal_pib.PANId;
+            break;
+
+        case macShortAddress:
+            attribute_value->pib_value_16bit = tal_pib.ShortAddress;
+            break;
+
+        case phyCurrentChannel:
+            attribute_value->pib_value_8bit = tal_pib.CurrentChannel;
+            break;
+
+        case phyTransmitPower:
+            attribute_value->pib_value_8bit = tal_pib.TransmitPower;
+            break;
+
+        case macIeeeAddress:
+            attribute_value->pib_value_64bit = tal_pib.IeeeAddress;
+            break;
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+
+        default:
+            status = RTB_UNSUPPORTED_ATTRIBUTE;
+            break;
+    }
+
+    return status;
+}
+#endif  /* #ifdef ENABLE_RTB_BULK_PIB */
+
+
+
 #ifndef ENABLE_RH
 /**
  * @brief Handles an RTB-SET.request primitive
@@ -0,0 +1,399 @@
+/**
+ * @file rtb_pib_bulk.c
+ *
+ * @brief Bulk access to the RTB and MAC PIB attributes
+ *
+ * This file implements the RTB-SET-BULK.request and RTB-GET-BULK.request,
+ * which write or read a list of PIB attributes by a single request and
+ * confirm. A bulk write is validated as a whole: either all PIB attributes
+ * are written or none of them.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_BULK_PIB)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "tal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+/** Index of no PIB attribute of a bulk request */
+#define NO_ATTR                         (0xFF)
+
+/* === Globals ============================================================= */
+
+
+/* === Prototypes ========================================================== */
+
+static uint8_t attr_layer(rtb_bulk_attr_t *attr);
+static retval_t mac_attr_get(uint8_t attribute, pib_value_t *attribute_value);
+static retval_t mac_attr_set(uint8_t attribute, pib_value_t *attribute_value,
+                             bool set_trx_to_sleep);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Gets the layer a PIB attribute of a bulk request is handled by
+ *
+ * Without MAC the RTB also gives access to the MAC PIB attributes residing
+ * in the TAL; these are handled as MAC PIB attributes whatever layer
+ * the request names.
+ *
+ * @param attr PIB attribute of the bulk request
+ *
+ * @return RTB_BULK_LAYER_RTB or RTB_BULK_LAYER_MAC
+ */
+static uint8_t attr_layer(rtb_bulk_attr_t *attr)
+{
+#ifdef RTB_WITHOUT_MAC
+    if (attr->PIBAttribute < RTB_PIB_RANGING_ENABLED)
+    {
+        return RTB_BULK_LAYER_MAC;
+    }
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+    return attr->Layer;
+}
+
+
+
+/**
+ * @brief Reads a MAC PIB attribute residing in the TAL
+ *
+ * @param attribute PIB attribute to be read
+ * @param attribute_value Value of the PIB attribute
+ *
+ * @return RTB_SUCCESS or RTB_UNSUPPORTED_ATTRIBUTE
+ */
+static retval_t mac_attr_get(uint8_t attribute, pib_value_t *attribute_value)
+{
+#ifdef RTB_WITHOUT_MAC
+    /* The RTB gives access to these PIB attributes itself. */
+    return rtb_get(attribute, attribute_value);
+#else
+    switch (attribute)
+    {
+        case macPANId:
+            attribute_value->pib_value_16bit = tal_pib.PANId;
+            break;
+
+        case macShortAddress:
+            attribute_value->pib_value_16bit = tal_pib.ShortAddress;
+            break;
+
+        case phyCurrentChannel:
+            attribute_value->pib_value_8bit = tal_pib.CurrentChannel;
+            break;
+
+        case phyTransmitPower:
+            attribute_value->pib_value_8bit = tal_pib.TransmitPower;
+            break;
+
+        case macIeeeAddress:
+            attribute_value->pib_value_64bit = tal_pib.IeeeAddress;
+            break;
+
+        default:
+            return RTB_UNSUPPORTED_ATTRIBUTE;
+    }
+
+    return RTB_SUCCESS;
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+}
+
+
+
+/**
+ * @brief Writes a MAC PIB attribute residing in the TAL
+ *
+ * @param attribute PIB attribute to be written
+ * @param attribute_value Value of the PIB attribute
+ * @param set_trx_to_sleep Set TRX back to sleep after this PIB access
+ *
+ * @return Status of the attempt to write the PIB attribute
+ */
+static retval_t mac_attr_set(uint8_t attribute, pib_value_t *attribute_value,
+                             bool set_trx_to_sleep)
+{
+#if defined(RTB_WITHOUT_MAC)
+    return rtb_set(attribute, attribute_value, set_trx_to_sleep);
+#elif defined(MAC_SECURITY_ZIP)
+    return mlme_set(attribute, 0, attribute_value, set_trx_to_sleep);
+#else
+    return mlme_set(attribute, attribute_value, set_trx_to_sleep);
+#endif
+}
+
+
+
+retval_t rtb_set_bulk(rtb_bulk_attr_t *attrs, uint8_t no_of_attrs,
+                      uint8_t *failed_attr)
+{
+    rtb_pib_t saved_rtb_pib;
+    pib_value_t old_value[RTB_BULK_MAX_ATTRIBUTES];
+    uint8_t layer[RTB_BULK_MAX_ATTRIBUTES];
+    uint16_t pending = 0;
+    uint8_t first_mac = NO_ATTR;
+    uint8_t last_mac = NO_ATTR;
+    retval_t status = RTB_SUCCESS;
+    bool progress;
+
+    *failed_attr = 0;
+    if ((0 == no_of_attrs) || (no_of_attrs > RTB_BULK_MAX_ATTRIBUTES))
+    {
+        return RTB_INVALID_PARAMETER;
+    }
+
+    /*
+     * All PIB attributes are checked before any of them is written; their
+     * current values are kept to restore them if the request fails.
+     */
+    for (uint8_t i = 0; i < no_of_attrs; i++)
+    {
+        layer[i] = attr_layer(&attrs[i]);
+        if (RTB_BULK_LAYER_RTB == layer[i])
+        {
+            status = rtb_get(attrs[i].PIBAttribute, &old_value[i]);
+            pending |= (1U << i);
+        }
+        else if (RTB_BULK_LAYER_MAC == layer[i])
+        {
+            status = mac_attr_get(attrs[i].PIBAttribute, &old_value[i]);
+            if (NO_ATTR == first_mac)
+            {
+                first_mac = i;
+            }
+            last_mac = i;
+        }
+        else
+        {
+            status = RTB_INVALID_PARAMETER;
+        }
+
+        if (RTB_SUCCESS != status)
+        {
+            *failed_attr = i;
+            return status;
+        }
+    }
+
+    saved_rtb_pib = rtb_pib;
+
+    /*
+     * The RTB PIB attributes only reside in RAM. One rejected as invalid
+     * may depend on another one of the request (f_start has to stay below
+     * f_stop), so it is tried again as long as the others make progress.
+     */
+    do
+    {
+        progress = false;
+        for (uint8_t i = 0; i < no_of_attrs; i++)
+        {
+            if (!(pending & (1U << i)))
+            {
+                continue;
+            }
+
+            status = rtb_set(attrs[i].PIBAttribute,
+                             &attrs[i].PIBAttributeValue,
+                             false);
+            if (RTB_SUCCESS == status)
+            {
+                pending &= ~(1U << i);
+                progress = true;
+            }
+            else if (RTB_INVALID_PARAMETER != status)
+            {
+                /* Not to be resolved by any other PIB attribute */
+                *failed_attr = i;
+                rtb_pib = saved_rtb_pib;
+                return status;
+            }
+        }
+    }
+    while (pending && progress);
+
+    if (pending)
+    {
+        for (uint8_t i = 0; i < no_of_attrs; i++)
+        {
+            if (pending & (1U << i))
+            {
+                *failed_attr = i;
+                break;
+            }
+        }
+        rtb_pib = saved_rtb_pib;
+        return RTB_INVALID_PARAMETER;
+    }
+
+    /*
+     * The MAC PIB attributes may wake up the transceiver; it is put back
+     * to sleep once by the last one.
+     */
+    for (uint8_t i = 0; (NO_ATTR != first_mac) && (i <= last_mac); i++)
+    {
+        if (RTB_BULK_LAYER_MAC != layer[i])
+        {
+            continue;
+        }
+
+        status = mac_attr_set(attrs[i].PIBAttribute,
+                              &attrs[i].PIBAttributeValue,
+                              (i == last_mac));
+        if (MAC_SUCCESS != status)
+        {
+            *failed_attr = i;
+
+            /* Restore the MAC PIB attributes written so far. */
+            while (i-- > first_mac)
+            {
+                if (RTB_BULK_LAYER_MAC == layer[i])
+                {
+                    mac_attr_set(attrs[i].PIBAttribute, &old_value[i],
+                                 (i == first_mac));
+                }
+            }
+            rtb_pib = saved_rtb_pib;
+            return status;
+        }
+    }
+
+    return RTB_SUCCESS;
+}
+
+
+
+retval_t rtb_get_bulk(rtb_bulk_attr_t *attrs, uint8_t no_of_attrs,
+                      uint8_t *failed_attr)
+{
+    retval_t status = RTB_SUCCESS;
+
+    *failed_attr = 0;
+    if ((0 == no_of_attrs) || (no_of_attrs > RTB_BULK_MAX_ATTRIBUTES))
+    {
+        return RTB_INVALID_PARAMETER;
+    }
+
+    for (uint8_t i = 0; i < no_of_attrs; i++)
+    {
+        uint8_t layer = attr_layer(&attrs[i]);
+
+        if (RTB_BULK_LAYER_RTB == layer)
+        {
+            status = rtb_get(attrs[i].PIBAttribute,
+                             &attrs[i].PIBAttributeValue);
+        }
+        else if (RTB_BULK_LAYER_MAC == layer)
+        {
+            status = mac_attr_get(attrs[i].PIBAttribute,
+                                  &attrs[i].PIBAttributeValue);
+        }
+        else
+        {
+            status = RTB_INVALID_PARAMETER;
+        }
+
+        if (RTB_SUCCESS != status)
+        {
+            *failed_attr = i;
+            break;
+        }
+    }
+
+    return status;
+}
+
+
+
+/**
+ * @brief Handles an RTB-SET-BULK.request primitive
+ *
+ * The request buffer is re-used for the confirm.
+ *
+ * @param msg Pointer to the request structure
+ */
+void rtb_set_bulk_request(uint8_t *msg)
+{
+    rtb_set_bulk_req_t *rsbr = (rtb_set_bulk_req_t *)BMM_BUFFER_POINTER((buffer_t *)msg);
+    rtb_set_bulk_conf_t *rsbc = (rtb_set_bulk_conf_t *)rsbr;
+    uint8_t no_of_attrs = rsbr->set_bulk_req.NoOfAttributes;
+    uint8_t failed_attr;
+    retval_t status;
+
+    status = rtb_set_bulk(rsbr->set_bulk_req.Attributes, no_of_attrs,
+                          &failed_attr);
+
+    rsbc->cmdcode = RTB_SET_BULK_CONFIRM;
+    rsbc->set_bulk_conf.status = status;
+    rsbc->set_bulk_conf.FailedAttribute = failed_attr;
+    rsbc->set_bulk_conf.NoOfAttributes = no_of_attrs;
+
+#ifdef RTB_WITHOUT_MAC
+    /* Append the confirm message to the RTB-NHLE queue */
+    qmm_queue_append(&rtb_nhle_q, (buffer_t *)msg);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Append the confirm message to the MAC-NHLE queue */
+    qmm_queue_append(&mac_nhle_q, (buffer_t *)msg);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+}
+
+
+
+/**
+ * @brief Handles an RTB-GET-BULK.request primitive
+ *
+ * The request buffer is re-used for the confirm.
+ *
+ * @param msg Pointer to the request structure
+ */
+void rtb_get_bulk_request(uint8_t *msg)
+{
+    rtb_get_bulk_req_t *rgbr = (rtb_get_bulk_req_t *)BMM_BUFFER_POINTER((buffer_t *)msg);
+    rtb_get_bulk_conf_t *rgbc = (rtb_get_bulk_conf_t *)rgbr;
+    uint8_t no_of_attrs = rgbr->get_bulk_req.NoOfAttributes;
+    uint8_t failed_attr;
+    retval_t status;
+
+    status = rtb_get_bulk(rgbr->get_bulk_req.Attributes, no_of_attrs,
+                          &failed_attr);
+
+    /* The attribute list is located behind the status within the confirm. */
+    if (no_of_attrs > RTB_BULK_MAX_ATTRIBUTES)
+    {
+        no_of_attrs = RTB_BULK_MAX_ATTRIBUTES;
+    }
+    memmove(rgbc->get_bulk_conf.Attributes, rgbr->get_bulk_req.Attributes,
+            no_of_attrs * sizeof(rtb_bulk_attr_t));
+
+    rgbc->cmdcode = RTB_GET_BULK_CONFIRM;
+    rgbc->get_bulk_conf.status = status;
+    rgbc->get_bulk_conf.FailedAttribute = failed_attr;
+    rgbc->get_bulk_conf.NoOfAttributes = no_of_attrs;
+
+#ifdef RTB_WITHOUT_MAC
+    /* Append the confirm message to the RTB-NHLE queue */
+    qmm_queue_append(&rtb_nhle_q, (buffer_t *)msg);
+#else   /* #ifdef RTB_WITHOUT_MAC */
+    /* Append the confirm message to the MAC-NHLE queue */
+    qmm_queue_append(&mac_nhle_q, (buffer_t *)msg);
+#endif  /* #ifdef RTB_WITHOUT_MAC */
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_BULK_PIB) */
+
+/* EOF */
@@ -0,0 +1,1125 @@
+/**
+ * @file rtb_pmu_233r_linux.c
+ *
+ * @brief PMU based ranging for AT86RF233R on hosted Linux
+ *
+ * This file implements the PMU specific part of the Ranging Toolbox
+ * (measurement, result exchange and distance calculation) for the hosted
+ * Linux platform. On the AVR platforms this functionality is provided by
+ * the precompiled library lib_rtb_pmu_233r.a.
+ *
+ * Both nodes measure the phase of the carrier of the peer node at each
+ * frequency of the configured sweep. The sum of the phases measured by the
+ * Initiator and the Reflector at a frequency f is 2 * f * d / c (modulo one
+ * cycle), i.e. the distance d is given by the slope of the summed phase
+ * over frequency.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifdef ENABLE_RTB
+
+/* === Includes ============================================================ */
+
+#include "rtb_types.h"
+#include "pal.h"
+#if ((RTB_TYPE == RTB_PMU_233R) && (PAL_GENERIC_TYPE == LINUX))
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tal.h"
+#include "tal_internal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+#include "rtb_pmu_math.h"
+
+/* === Macros ============================================================== */
+
+/**
+ * Maximum number of frequencies of a PMU measurement.
+ * This is limited by the number of validity values of the
+ * RTB-PMU-VALIDITY.indication.
+ */
+#define PMU_MAX_NO_OF_FREQ              (160)
+
+/** Number of PMU values read per frequency */
+#define PMU_SAMPLES_PER_FREQ            (4)
+
+/* === Globals ============================================================= */
+
+/** Highest verbose level supported by this implementation. */
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT)
+const uint8_t aRTBMaxPMUVerboseLevel = PMU_VERBOSE_LEVEL_BINARY_DUMP;
+#else
+const uint8_t aRTBMaxPMUVerboseLevel = PMU_VERBOSE_LEVEL_TEXT_DUMP;
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) */
+
+/* Averaged PMU values measured by this node (per antenna measurement). */
+static uint8_t pmu_local_values[PMU_MAX_NO_ANTENNAS][PMU_MAX_NO_OF_FREQ];
+
+/* Averaged PMU values received from the Reflector (Initiator only). */
+static uint8_t pmu_peer_values[PMU_MAX_NO_ANTENNAS][PMU_MAX_NO_OF_FREQ];
+
+/* Raw PMU values of one sweep */
+static uint8_t pmu_raw_values[PMU_SAMPLES_PER_FREQ * PMU_MAX_NO_OF_FREQ];
+
+/* Number of frequencies of the current measurement */
+static uint8_t pmu_no_of_freq;
+
+/* Index of the next value to be transmitted (Reflector) */
+static uint16_t pmu_tx_idx;
+
+/* Number of values received so far (Initiator) */
+static uint16_t pmu_rx_idx;
+
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+/* Width of the packed values of the next Result Confirm frame (Reflector) */
+static uint8_t pmu_tx_compr_width;
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+/* Values received so far, one bit per value of all antenna measurements (Initiator) */
+static uint8_t pmu_push_rx_map[(PMU_MAX_NO_ANTENNAS * PMU_MAX_NO_OF_FREQ + 7) / 8];
+
+/* Number of different values received so far (Initiator) */
+static uint16_t pmu_push_rx_cnt;
+
+/* Index following the values of the last Result Confirm frame (Initiator) */
+static uint16_t pmu_push_rx_end;
+
+/* Values have been received since the last Result Request frame (Initiator) */
+static bool pmu_push_rx_progress;
+
+/* Number of values of the last Result Confirm frame (Reflector) */
+static uint16_t pmu_push_tx_cnt;
+
+/* Number of values acknowledged by the Initiator (Reflector) */
+static uint16_t pmu_push_tx_acked;
+
+/*
+ * Index following the last value of the current burst; indices count
+ * the values of all antenna measurements consecutively.
+ */
+static uint16_t pmu_push_end;
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+/* Mean phase step per antenna measurement in 1/256 cycles */
+static int16_t pmu_mean_step[PMU_MAX_NO_ANTENNAS];
+
+/* Frequency error correction */
+static bool pmu_fec_enabled;
+static int8_t pmu_fec;
+
+/* === Prototypes ========================================================== */
+
+static void pmu_set_frequency(uint16_t freq_half_mhz);
+static void pmu_calc_distance(uint8_t ant_meas, uint32_t *dist_cm, uint8_t *dqf);
+static uint16_t pmu_max_result_len(void);
+#if !defined(RTB_WITHOUT_MAC) || defined(ENABLE_RTB_ADAPTIVE)
+static bool pmu_value_valid(uint8_t ant_meas, uint8_t idx);
+#endif  /* #if !defined(RTB_WITHOUT_MAC) || defined(ENABLE_RTB_ADAPTIVE) */
+#ifdef ENABLE_RTB_PUSH_RESULTS
+static bool pmu_push_active(void);
+static uint16_t pmu_push_no_of_values(void);
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+/* === Implementation ====================================================== */
+
+bool pmu_check_pmu_params(void)
+{
+    uint16_t span;
+
+    if ((range_param_pmu.f_step > PMU_STEP_FREQ_4MHz) ||
+        (range_param_pmu.f_start < PMU_MIN_FREQ) ||
+        (range_param_pmu.f_stop > PMU_MAX_FREQ) ||
+        (range_param_pmu.f_stop < (range_param_pmu.f_start + PMU_STEP_FREQ_MAX_IN_MHZ)))
+    {
+        return false;
+    }
+
+    span = (uint16_t)(range_param_pmu.f_stop - range_param_pmu.f_start) * 2;
+    if (((span >> range_param_pmu.f_step) + 1) > PMU_MAX_NO_OF_FREQ)
+    {
+        return false;
+    }
+
+    pmu_no_of_freq = (uint8_t)((span >> range_param_pmu.f_step) + 1);
+
+    return true;
+}
+
+
+
+#ifdef ENABLE_RTB_SPECTRUM
+/**
+ * @brief Tunes the transceiver to the frequency of an ED scan
+ *
+ * @param freq_mhz Frequency in MHz, 0 to return to the regular channel
+ */
+void pmu_set_ed_frequency(uint16_t freq_mhz)
+{
+    if (0 == freq_mhz)
+    {
+        pal_trx_bit_write(SR_CC_BAND, 0);
+        pal_trx_bit_write(SR_CC_NUMBER, 0);
+    }
+    else
+    {
+        pal_trx_bit_write(SR_CC_BAND, PMU_CC_BAND);
+        pal_trx_bit_write(SR_CC_NUMBER,
+                          (uint8_t)(freq_mhz - PMU_CC_BAND_8_BASE_FREQ));
+    }
+}
+#endif  /* ENABLE_RTB_SPECTRUM */
+
+
+
+void pmu_configure_antenna(void)
+{
+    uint8_t init_ant = (range_param.caps & PMU_CAP_INITIATOR_ANT) ? 2 : 1;
+    uint8_t refl_ant = (range_param.caps & PMU_CAP_REFLECTOR_ANT) ? 2 : 1;
+
+    range_param_pmu.antenna_measurement_nos = init_ant * refl_ant;
+
+#if (ANTENNA_DIVERSITY == 1)
+    /*
+     * The Initiator antenna changes with every measurement, the
+     * Reflector antenna after all Initiator antennas are measured.
+     */
+    for (uint8_t i = 0; i < range_param_pmu.antenna_measurement_nos; i++)
+    {
+        uint8_t ant;
+
+        if (RTB_ROLE_INITIATOR == rtb_role)
+        {
+            ant = (init_ant > 1) ? (i % 2) : rtb_pib.DefaultAntenna;
+        }
+        else
+        {
+            ant = (refl_ant > 1) ? (i / init_ant) : rtb_pib.DefaultAntenna;
+        }
+        range_param_pmu.antenna_array[i] = ant;
+    }
+#endif  /* (ANTENNA_DIVERSITY == 1) */
+}
+
+
+
+void pmu_configure_ranging(void)
+{
+    /* Store the regular transmit power, restored within range_exit(). */
+    orig_tal_transmit_power = tal_pib.TransmitPower;
+
+    tal_pib_set(phyTransmitPower, (pib_value_t *)&range_param.req_tx_power);
+
+    /* Derive the number of frequencies; the Initiator has not checked it. */
+    if (!pmu_check_pmu_params())
+    {
+        pmu_no_of_freq = 0;
+    }
+
+    range_status_pmu.curr_antenna_measurement_no = 0;
+    pmu_reset_pmu_result_vars();
+}
+
+
+
+void pmu_enable_fec_measurement(void)
+{
+    pmu_fec_enabled = true;
+    pmu_fec = 0;
+}
+
+
+
+void pmu_disable_fec_measurement(void)
+{
+    pmu_fec_enabled = false;
+}
+
+
+
+void pmu_reset_fec_vars(void)
+{
+    pmu_fec = 0;
+}
+
+
+
+/**
+ * @brief Updates the frequency error correction
+ *
+ * Called from the transceiver ISR after each frame. The frequency error
+ * correction compensates the phase drift between consecutive PMU values
+ * caused by the crystal offset between both nodes. The emulated
+ * transceivers share the same time base, so the correction stays zero.
+ */
+void rtb_update_fec(void)
+{
+    if (pmu_fec_enabled)
+    {
+        pmu_fec = 0;
+    }
+}
+
+
+
+/**
+ * @brief Averages 4 PMU values per frequency
+ *
+ * @param p_pmu Raw PMU values, PMU_SAMPLES_PER_FREQ values per frequency
+ * @param freq_N Number of frequencies
+ * @param fec Phase drift between consecutive values in 1/256 cycles
+ * @param pmu_avg Averaged PMU values
+ */
+void range_calc_aver_pmu4(uint8_t *p_pmu,
+                          int freq_N,
+                          int fec,
+                          uint8_t *pmu_avg)
+{
+    for (int i = 0; i < freq_N; i++)
+    {
+        uint8_t ref = p_pmu[0];
+        int16_t sum = 0;
+
+        for (uint8_t k = 0; k < PMU_SAMPLES_PER_FREQ; k++)
+        {
+            /* Deviation from the first value, corrected by the drift. */
+            sum += (int8_t)(uint8_t)(p_pmu[k] - ref - (k * fec));
+        }
+
+        pmu_avg[i] = (uint8_t)(ref + (sum / PMU_SAMPLES_PER_FREQ));
+        p_pmu += PMU_SAMPLES_PER_FREQ;
+    }
+}
+
+
+
+/**
+ * @brief Tunes the transceiver to a PMU measurement frequency
+ *
+ * @param freq_half_mhz Frequency in units of 500 kHz
+ */
+static void pmu_set_frequency(uint16_t freq_half_mhz)
+{
+    pal_trx_bit_write(SR_CC_NUMBER,
+                      (uint8_t)((freq_half_mhz >> 1) - PMU_CC_BAND_8_BASE_FREQ));
+    pal_trx_bit_write(SR_PMU_IF_INVERSE, freq_half_mhz & 0x01);
+}
+
+
+
+void pmu_perform_pmu_measurement(void)
+{
+    uint16_t freq = (uint16_t)range_param_pmu.f_start * 2;
+    uint8_t step = (uint8_t)(1 << range_param_pmu.f_step);
+    uint8_t ant_meas;
+    uint8_t i;
+
+    rtb_tstamp_irq_init();
+
+    set_trx_state(CMD_PLL_ON);
+    pal_trx_bit_write(SR_CC_BAND, PMU_CC_BAND);
+
+    for (ant_meas = 0; ant_meas < range_param_pmu.antenna_measurement_nos; ant_meas++)
+    {
+#if (ANTENNA_DIVERSITY == 1)
+        pal_trx_bit_write(SR_ANT_SEL, range_param_pmu.antenna_array[ant_meas]);
+#endif  /* (ANTENNA_DIVERSITY == 1) */
+
+        for (i = 0; i < pmu_no_of_freq; i++)
+        {
+            pmu_set_frequency(freq + (uint16_t)i * step);
+
+            pal_trx_bit_write(SR_PMU_EN, 1);
+            for (uint8_t k = 0; k < PMU_SAMPLES_PER_FREQ; k++)
+            {
+                pmu_raw_values[i * PMU_SAMPLES_PER_FREQ + k] =
+                    pal_trx_reg_read(RG_PHY_PMU_VALUE);
+            }
+            pal_trx_bit_write(SR_PMU_EN, 0);
+        }
+
+        range_calc_aver_pmu4(pmu_raw_values, pmu_no_of_freq, pmu_fec,
+                             pmu_local_values[ant_meas]);
+    }
+
+    /* Back to the regular channel page. */
+    pal_trx_bit_write(SR_PMU_IF_INVERSE, 0);
+    pal_trx_bit_write(SR_CC_BAND, 0);
+    pal_trx_bit_write(SR_CC_NUMBER, 0);
+
+#if (ANTENNA_DIVERSITY == 1)
+    pal_trx_bit_write(SR_ANT_SEL, rtb_pib.DefaultAntenna);
+#endif  /* (ANTENNA_DIVERSITY == 1) */
+
+    set_trx_state(CMD_RX_AACK_ON);
+
+    rtb_tstamp_irq_exit();
+
+    /* Measurement finished. */
+    range_stop_await_timer();
+    RTB_SET_STATE(RTB_PREPARE_RESULT_EXCHANGE);
+}
+
+
+
+void pmu_tx_pmu_time_sync_frame(void)
+{
+    /* Send PMU Time Sync Request frame using CSMA/CA. */
+    range_assemble_and_tx_frame_csma(RTB_CMD_PMU_TIME_SYNC_REQ,    // Internal RTB message type
+                                     CMD_PMU_TIME_SYNC_REQ,        // External RTB command frame type
+                                     RTB_TIME_SYNC_REQ_FRAME_DONE, // Next RTB state
+                                     /*
+                                      * Generate a Range-Confirm if required,
+                                      * since this is an Initiator.
+                                      */
+                                     LOCAL_CONF);
+}
+
+
+
+void pmu_prepare_result_exchange(result_frame_ie_t next_result_data)
+{
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    uint16_t no_of_values;
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    /*
+     * A burst saves nothing if a single Result Confirm frame carries all
+     * values. Both nodes decide this alike, so no further frame is needed.
+     */
+    if (1 == range_param_pmu.antenna_measurement_nos)
+    {
+        bool single_frame = (pmu_no_of_freq <= MAX_RESULT_VALUES_PER_FRAME);
+
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+        if (RESULT_IE_PMU_VALUES_COMPR == next_result_data)
+        {
+            pmu_math_pack_width(pmu_no_of_freq,
+                                MAX_RESULT_VALUES_PER_FRAME,
+                                range_param.compr_min_width,
+                                &no_of_values);
+            single_frame = (no_of_values >= pmu_no_of_freq);
+        }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+        if (single_frame)
+        {
+            range_param.caps &= ~(PMU_CAP_REFLECTOR_PUSH);
+        }
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+
+    /*
+     * Packed values are only requested if they save Result Request/Confirm
+     * exchanges; otherwise the width octet would be sent in vain.
+     */
+    if ((RESULT_IE_PMU_VALUES_COMPR == next_result_data) &&
+        (pmu_math_pack_width(pmu_no_of_freq,
+                             pmu_max_result_len(),
+                             range_param.compr_min_width,
+                             &no_of_values) == PMU_MATH_PACK_MAX_WIDTH))
+    {
+        next_result_data = RESULT_IE_PMU_VALUES;
+    }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+    req_result_type = next_result_data;
+    range_status_pmu.curr_antenna_measurement_no = 0;
+    pmu_reset_pmu_result_vars();
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    memset(pmu_push_rx_map, 0, sizeof(pmu_push_rx_map));
+    pmu_push_rx_cnt = 0;
+    pmu_push_tx_acked = 0;
+    pmu_push_end = 0;
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+}
+
+
+
+void pmu_reset_pmu_result_vars(void)
+{
+    pmu_tx_idx = 0;
+    pmu_rx_idx = 0;
+}
+
+
+
+void pmu_fill_initial_start_addr(uint8_t *ptr_to_frame)
+{
+    /* The start index is the number of values received so far. */
+    convert_16_bit_to_byte_array(pmu_rx_idx, ptr_to_frame);
+}
+
+
+
+void pmu_extract_no_of_req_result_values(uint16_t received_value_cnt)
+{
+    pmu_tx_idx = received_value_cnt;
+}
+
+
+
+bool pmu_update_result_ptr(void)
+{
+    return (pmu_tx_idx < pmu_no_of_freq);
+}
+
+
+
+uint16_t pmu_get_no_of_results_to_be_sent(void)
+{
+    if (pmu_tx_idx >= pmu_no_of_freq)
+    {
+        return 0;
+    }
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (pmu_push_active())
+    {
+        /* The frame must not exceed the current burst. */
+        uint16_t window_left = pmu_push_end -
+                               (range_status_pmu.curr_antenna_measurement_no * pmu_no_of_freq +
+                                pmu_tx_idx);
+
+        if (window_left < (pmu_no_of_freq - pmu_tx_idx))
+        {
+            return window_left;
+        }
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+    return (pmu_no_of_freq - pmu_tx_idx);
+}
+
+
+
+/**
+ * @brief Limits the number of values of the next Result Confirm frame
+ *
+ * @param[in,out] no_of_values Number of values to be sent, limited to the
+ *                             number of values fitting into the frame
+ *
+ * @return Length of the result data in octets
+ */
+uint16_t pmu_get_result_data_len(uint16_t *no_of_values)
+{
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    if (RESULT_IE_PMU_VALUES_COMPR == req_result_type)
+    {
+        pmu_tx_compr_width = pmu_math_pack_width(*no_of_values,
+                                                 pmu_max_result_len(),
+                                                 range_param.compr_min_width,
+                                                 no_of_values);
+
+        return pmu_math_pack_len(*no_of_values, pmu_tx_compr_width);
+    }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+    if (*no_of_values > pmu_max_result_len())
+    {
+        *no_of_values = pmu_max_result_len();
+    }
+
+    return *no_of_values;
+}
+
+
+
+void pmu_fill_result_data(uint16_t no_of_values, uint8_t *ptr_to_frame)
+{
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    if (RESULT_IE_PMU_VALUES_COMPR == req_result_type)
+    {
+        pmu_math_pack(&pmu_local_values[range_status_pmu.curr_antenna_measurement_no][pmu_tx_idx],
+                      pmu_tx_idx,
+                      no_of_values,
+                      pmu_tx_compr_width,
+                      ptr_to_frame);
+    }
+    else
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+    {
+        memcpy(ptr_to_frame,
+               &pmu_local_values[range_status_pmu.curr_antenna_measurement_no][pmu_tx_idx],
+               no_of_values);
+    }
+    pmu_tx_idx += no_of_values;
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    pmu_push_tx_cnt = no_of_values;
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+}
+
+
+
+bool pmu_no_more_pmu_data_available(void)
+{
+    return (pmu_tx_idx >= pmu_no_of_freq);
+}
+
+
+
+void pmu_handle_received_pmu_values(uint8_t *curr_frame_ptr)
+{
+    uint8_t ant_meas = *curr_frame_ptr++;
+    uint16_t cnt = convert_byte_array_to_16_bit(curr_frame_ptr);
+    uint16_t start = pmu_rx_idx;
+
+    curr_frame_ptr += 2;
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (pmu_push_active())
+    {
+        /* Pushed frames carry their position, since frames may be lost. */
+        start = convert_byte_array_to_16_bit(curr_frame_ptr);
+        curr_frame_ptr += 2;
+
+        if ((ant_meas >= range_param_pmu.antenna_measurement_nos) ||
+            (start >= pmu_no_of_freq))
+        {
+            return;
+        }
+    }
+    else
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+    if (ant_meas != range_status_pmu.curr_antenna_measurement_no)
+    {
+        return;
+    }
+
+    if (cnt > (pmu_no_of_freq - start))
+    {
+        cnt = pmu_no_of_freq - start;
+    }
+
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    if (RESULT_IE_PMU_VALUES_COMPR == req_result_type)
+    {
+        if (!pmu_math_unpack(curr_frame_ptr, start, cnt,
+                             &pmu_peer_values[ant_meas][start]))
+        {
+            /* The values are requested again. */
+            return;
+        }
+    }
+    else
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+    {
+        memcpy(&pmu_peer_values[ant_meas][start], curr_frame_ptr, cnt);
+    }
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (pmu_push_active())
+    {
+        uint16_t idx = ant_meas * pmu_no_of_freq + start;
+
+        pmu_push_rx_end = idx + cnt;
+        pmu_push_rx_progress = true;
+
+        for (; idx < pmu_push_rx_end; idx++)
+        {
+            if (!(pmu_push_rx_map[idx >> 3] & _BV(idx & 7)))
+            {
+                pmu_push_rx_map[idx >> 3] |= _BV(idx & 7);
+                pmu_push_rx_cnt++;
+            }
+        }
+        return;
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+    pmu_rx_idx += cnt;
+}
+
+
+
+bool pmu_more_results_to_be_expected(void)
+{
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (pmu_push_active())
+    {
+        /* The values of all antenna measurements are pushed at once. */
+        return (pmu_push_rx_cnt < pmu_push_no_of_values());
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+    return (pmu_rx_idx < pmu_no_of_freq);
+}
+
+
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+/**
+ * @brief Selects the values to be requested by the next Result Request frame
+ *
+ * The burst covers the first run of values not received so far. It starts
+ * at the current antenna measurement and the current receive index.
+ */
+void pmu_push_select_window(void)
+{
+    uint16_t total = pmu_push_no_of_values();
+    uint16_t idx = 0;
+
+    while ((idx < total) && (pmu_push_rx_map[idx >> 3] & _BV(idx & 7)))
+    {
+        idx++;
+    }
+
+    range_status_pmu.curr_antenna_measurement_no = idx / pmu_no_of_freq;
+    pmu_rx_idx = idx % pmu_no_of_freq;
+
+    while ((idx < total) && !(pmu_push_rx_map[idx >> 3] & _BV(idx & 7)))
+    {
+        idx++;
+    }
+
+    pmu_push_end = idx;
+    pmu_push_rx_end = 0;
+    pmu_push_rx_progress = false;
+}
+
+
+
+/**
+ * @brief Adds the number of values of the burst to the Result Request frame
+ *
+ * @param ptr_to_frame Pointer to the frame following the start index
+ */
+void pmu_push_fill_window(uint8_t *ptr_to_frame)
+{
+    convert_16_bit_to_byte_array(pmu_push_end -
+                                 (range_status_pmu.curr_antenna_measurement_no * pmu_no_of_freq +
+                                  pmu_rx_idx),
+                                 ptr_to_frame);
+}
+
+
+
+/**
+ * @brief Checks whether the last Result Confirm frame of the burst is received
+ *
+ * Any values still missing afterwards are requested again.
+ *
+ * @return true if no further pushed Result Confirm frame is expected
+ */
+bool pmu_push_window_done(void)
+{
+    return (pmu_push_rx_end >= pmu_push_end);
+}
+
+
+
+/**
+ * @brief Checks whether values have been received during the current burst
+ *
+ * A burst whose last frame is lost is continued by a new Result Request
+ * frame, as long as it delivered any values at all.
+ *
+ * @return true if values have been received since the last Result Request
+ */
+bool pmu_push_progress(void)
+{
+    return pmu_push_rx_progress;
+}
+
+
+
+/**
+ * @brief Extracts the number of values of the burst from the Result Request frame
+ *
+ * @param ptr_to_frame Pointer to the frame following the start index
+ */
+void pmu_push_extract_window(uint8_t *ptr_to_frame)
+{
+    uint16_t start = range_status_pmu.curr_antenna_measurement_no * pmu_no_of_freq +
+                     pmu_tx_idx;
+    uint16_t len = convert_byte_array_to_16_bit(ptr_to_frame);
+
+    if (len > (pmu_push_no_of_values() - start))
+    {
+        len = pmu_push_no_of_values() - start;
+    }
+
+    pmu_push_end = start + len;
+}
+
+
+
+/**
+ * @brief Adds the start index of the values to the pushed Result Confirm frame
+ *
+ * @param ptr_to_frame Pointer to the frame following the number of values
+ */
+void pmu_push_fill_start_addr(uint8_t *ptr_to_frame)
+{
+    convert_16_bit_to_byte_array(pmu_tx_idx, ptr_to_frame);
+}
+
+
+
+/**
+ * @brief Advances the burst after transmission of a Result Confirm frame
+ *
+ * Values of the next antenna measurement follow immediately
+ * within the same burst.
+ *
+ * @param acked true if the Result Confirm frame has been acknowledged
+ *
+ * @return true if further values of the burst are to be sent
+ */
+bool pmu_push_more_in_window(bool acked)
+{
+    if (acked)
+    {
+        pmu_push_tx_acked += pmu_push_tx_cnt;
+    }
+
+    if ((range_status_pmu.curr_antenna_measurement_no * pmu_no_of_freq +
+         pmu_tx_idx) >= pmu_push_end)
+    {
+        return false;
+    }
+
+    if (pmu_tx_idx >= pmu_no_of_freq)
+    {
+        range_status_pmu.curr_antenna_measurement_no++;
+        pmu_tx_idx = 0;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Checks whether all values have been acknowledged by the Initiator
+ *
+ * @return true if no further Result Request frame is expected
+ */
+bool pmu_push_all_acked(void)
+{
+    return (pmu_push_tx_acked >= pmu_push_no_of_values());
+}
+
+
+
+/* Checks whether the Result Confirm frames are pushed. */
+static bool pmu_push_active(void)
+{
+    return ((range_param.caps & PMU_CAP_REFLECTOR_PUSH) != 0);
+}
+
+
+
+/* Number of values of all antenna measurements */
+static uint16_t pmu_push_no_of_values(void)
+{
+    return ((uint16_t)pmu_no_of_freq * range_param_pmu.antenna_measurement_nos);
+}
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+
+
+/* Maximum length of the result data of a Result Confirm frame */
+static uint16_t pmu_max_result_len(void)
+{
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (pmu_push_active())
+    {
+        return MAX_RESULT_VALUES_PER_PUSH_FRAME;
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
+    return MAX_RESULT_VALUES_PER_FRAME;
+}
+
+
+
+void pmu_set_pmu_result_idx_done(void)
+{
+    pmu_avg_data.no_of_ant_meas = range_param_pmu.antenna_measurement_nos;
+    pmu_avg_data.no_of_freq = pmu_no_of_freq;
+    pmu_avg_data.ant_meas_ptr_offset = PMU_MAX_NO_OF_FREQ;
+    pmu_avg_data.p_pmu_avg_init = pmu_local_values[0];
+    pmu_avg_data.p_pmu_avg_refl = pmu_peer_values[0];
+}
+
+
+
+/**
+ * @brief Calculates the distance of one antenna measurement pair
+ *
+ * The phase sums of consecutive frequencies differ by 2 * df * d / c.
+ * The phase steps are averaged as unit vectors to be robust against
+ * single wrong PMU values; the length of the resulting vector is the
+ * distance quality factor.
+ *
+ * @param ant_meas Antenna measurement pair
+ * @param[out] dist_cm Distance in cm
+ * @param[out] dqf Distance quality factor in percent
+ */
+static void pmu_calc_distance(uint8_t ant_meas, uint32_t *dist_cm, uint8_t *dqf)
+{
+    int32_t sum_cos;
+    int32_t sum_sin;
+
+    pmu_math_sum_steps(pmu_local_values[ant_meas],
+                       pmu_peer_values[ant_meas],
+                       pmu_no_of_freq,
+                       &sum_cos,
+                       &sum_sin);
+
+    pmu_mean_step[ant_meas] = pmu_math_steps_2_dist(sum_cos,
+                                                    sum_sin,
+                                                    pmu_no_of_freq,
+                                                    range_param_pmu.f_step,
+                                                    rtb_dist_offset,
+                                                    dist_cm,
+                                                    dqf);
+}
+
+
+
+void pmu_math_pmu_2_dist(void)
+{
+    uint8_t ant_meas;
+    uint32_t dist[PMU_MAX_NO_ANTENNAS];
+    uint8_t dqf[PMU_MAX_NO_ANTENNAS];
+    uint32_t distance_cm;
+    uint8_t distance_dqf;
+
+    for (ant_meas = 0; ant_meas < range_param_pmu.antenna_measurement_nos; ant_meas++)
+    {
+        pmu_calc_distance(ant_meas, &dist[ant_meas], &dqf[ant_meas]);
+
+        range_status_pmu.measured_distance_cm[ant_meas] = dist[ant_meas];
+        range_status_pmu.measured_dqf[ant_meas] = dqf[ant_meas];
+    }
+
+    pmu_math_combine(dist,
+                     dqf,
+                     range_param_pmu.antenna_measurement_nos,
+                     range_param_pmu.apply_min_dist_threshold,
+                     &distance_cm,
+                     &distance_dqf);
+
+    range_status.distance_cm = distance_cm;
+    range_status.dqf = distance_dqf;
+}
+
+
+
+#if !defined(RTB_WITHOUT_MAC) || defined(ENABLE_RTB_ADAPTIVE)
+/**
+ * @brief Checks whether the PMU value of one frequency is valid
+ *
+ * A PMU value is considered as valid if the phase step towards the
+ * adjacent frequency does not deviate too much from the mean phase step.
+ *
+ * @param ant_meas Antenna measurement pair
+ * @param idx Index of the frequency
+ *
+ * @return true if the PMU value is valid
+ */
+static bool pmu_value_valid(uint8_t ant_meas, uint8_t idx)
+{
+    const uint8_t *init_val = pmu_local_values[ant_meas];
+    const uint8_t *refl_val = pmu_peer_values[ant_meas];
+    /* Step towards the next frequency, the last uses the previous. */
+    uint8_t a = (idx < (pmu_no_of_freq - 1)) ? idx : (idx - 1);
+    uint8_t step;
+    int8_t dev;
+
+    step = (uint8_t)((init_val[a + 1] + refl_val[a + 1]) -
+                     (init_val[a] + refl_val[a]));
+    dev = (int8_t)(uint8_t)(step - (uint8_t)pmu_mean_step[ant_meas]);
+
+    return ((dev <= PMU_VALIDITY_THRESHOLD) && (dev >= -PMU_VALIDITY_THRESHOLD));
+}
+#endif  /* #if !defined(RTB_WITHOUT_MAC) || defined(ENABLE_RTB_ADAPTIVE) */
+
+
+
+#ifdef ENABLE_RTB_ADAPTIVE
+uint8_t pmu_get_no_of_freq(void)
+{
+    return pmu_no_of_freq;
+}
+
+
+
+/**
+ * @brief Gets the useful band of the finished PMU measurement
+ *
+ * A frequency is useful if its PMU value is valid for at least one
+ * antenna measurement pair; the useful band reaches from the first to the
+ * last useful frequency, so only invalid band edges are cut off and the
+ * bandwidth determining the accuracy is kept otherwise. Without any useful
+ * frequency the whole band of the measurement is returned.
+ *
+ * @param[out] f_start Start frequency of the useful band in MHz
+ * @param[out] f_stop Stop frequency of the useful band in MHz
+ *
+ * @return Number of useful frequencies
+ */
+uint8_t pmu_get_valid_band(uint16_t *f_start, uint16_t *f_stop)
+{
+    uint8_t no_of_valid = 0;
+    uint8_t first = 0;
+    uint8_t last = pmu_no_of_freq - 1;
+    uint16_t freq;
+
+    for (uint8_t i = 0; i < pmu_no_of_freq; i++)
+    {
+        bool valid = false;
+
+        for (uint8_t ant_meas = 0;
+             (ant_meas < range_param_pmu.antenna_measurement_nos) && !valid;
+             ant_meas++)
+        {
+            valid = pmu_value_valid(ant_meas, i);
+        }
+
+        if (valid)
+        {
+            if (0 == no_of_valid)
+            {
+                first = i;
+            }
+            last = i;
+            no_of_valid++;
+        }
+    }
+
+    if (0 == no_of_valid)
+    {
+        last = pmu_no_of_freq - 1;
+    }
+
+    /* The frequencies are counted in 0.5 MHz. */
+    freq = (uint16_t)range_param_pmu.f_start * 2;
+    *f_start = (freq + ((uint16_t)first << range_param_pmu.f_step)) / 2;
+    *f_stop = (freq + ((uint16_t)last << range_param_pmu.f_step) + 1) / 2;
+
+    return no_of_valid;
+}
+
+
+
+/**
+ * @brief Gets the finest frequency step a PMU band can be measured with
+ *
+ * @param f_start Start frequency in MHz
+ * @param f_stop Stop frequency in MHz
+ * @param f_step Requested frequency step
+ *
+ * @return The requested frequency step, or the next coarser one
+ *         not exceeding the maximum number of frequencies
+ */
+uint8_t pmu_fit_freq_step(uint16_t f_start, uint16_t f_stop, uint8_t f_step)
+{
+    uint16_t span = (f_stop - f_start) * 2;
+
+    while ((f_step < PMU_STEP_FREQ_4MHz) &&
+           (((span >> f_step) + 1) > PMU_MAX_NO_OF_FREQ))
+    {
+        f_step++;
+    }
+
+    return f_step;
+}
+#endif  /* ENABLE_RTB_ADAPTIVE */
+
+
+
+#ifndef RTB_WITHOUT_MAC
+void pmu_result_presentation(void)
+{
+    if (rtb_pib.PMUVerboseLevel > 0)
+    {
+        for (uint8_t i = 0; i < range_param_pmu.antenna_measurement_nos; i++)
+        {
+            pmu_validity_indication(i);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Generates the RTB-PMU-VALIDITY.indication
+ *
+ * @param antenna_value Antenna measurement pair
+ */
+void pmu_validity_indication(uint8_t antenna_value)
+{
+    buffer_t *buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    rtb_pmu_validity_ind_t *rpvi;
+
+    if (NULL == buffer_header)
+    {
+        return;
+    }
+
+    rpvi = (rtb_pmu_validity_ind_t *)BMM_BUFFER_POINTER(buffer_header);
+    rpvi->cmdcode = RTB_PMU_VALIDITY_INDICATION;
+    rpvi->pmu_validity.PMUAntennaMeasurementValue = antenna_value;
+    rpvi->pmu_validity.PMUValidityValueNo = pmu_no_of_freq;
+    memset(rpvi->pmu_validity.PMUValidityValues, 0, (pmu_no_of_freq + 7) / 8);
+
+    for (uint8_t i = 0; i < pmu_no_of_freq; i++)
+    {
+        if (pmu_value_valid(antenna_value, i))
+        {
+            rpvi->pmu_validity.PMUValidityValues[i / 8] |= (uint8_t)(1 << (i % 8));
+        }
+    }
+
+    qmm_queue_append(&mac_nhle_q, buffer_header);
+}
+#endif  /* #ifndef RTB_WITHOUT_MAC */
+
+
+
+#if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT)
+void pmu_range_pmu_result_dump(void)
+{
+    for (uint8_t ant_meas = 0; ant_meas < range_param_pmu.antenna_measurement_nos; ant_meas++)
+    {
+        printf("PMU values for antenna measurement value %u\n", ant_meas);
+        printf("Freq [MHz]  Init  Refl\n");
+        for (uint8_t i = 0; i < pmu_no_of_freq; i++)
+        {
+            uint16_t freq = (uint16_t)range_param_pmu.f_start * 2 +
+                            (uint16_t)i * (1 << range_param_pmu.f_step);
+
+            printf("%4u.%u      %3u   %3u\n",
+                   freq / 2, (freq & 0x01) ? 5 : 0,
+                   pmu_local_values[ant_meas][i],
+                   pmu_peer_values[ant_meas][i]);
+        }
+    }
+}
+#endif  /* #if defined(SIO_HUB) && defined(ENABLE_RTB_PRINT) */
+
+#endif  /* ((RTB_TYPE == RTB_PMU_233R) && (PAL_GENERIC_TYPE == LINUX)) */
+
+#endif  /* #ifdef ENABLE_RTB */
+
+/* EOF */
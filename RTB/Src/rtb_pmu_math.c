@@ -0,0 +1,331 @@
+/**
+ * @file rtb_pmu_math.c
+ *
+ * @brief PMU to distance calculation of the AT86RF233R on hosted platforms
+ *
+ * This file has no dependencies on the stack, it is shared by the Linux
+ * port of the PMU ranging (rtb_pmu_233r_linux.c) and by host tools.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "rtb_pmu_math.h"
+
+/* === Macros ============================================================== */
+
+/** Speed of light in m/s */
+#define SPEED_OF_LIGHT                  (299792458.0)
+
+/** Frequency step in Hz */
+#define PMU_STEP_IN_HZ(step)            (500000.0 * (double)(1 << (step)))
+
+/** Step of the dither sequence of packed values (about 256 / golden ratio) */
+#define PACK_DITHER_STEP                (157)
+
+/* === Globals ============================================================= */
+
+/* Cosine in Q14 for the first quarter of the circle (1/256 cycle units) */
+static const int16_t pmu_cos_q14[65] =
+{
+    16384, 16379, 16364, 16340, 16305, 16261, 16207, 16143,
+    16069, 15986, 15893, 15791, 15679, 15557, 15426, 15286,
+    15137, 14978, 14811, 14635, 14449, 14256, 14053, 13842,
+    13623, 13395, 13160, 12916, 12665, 12406, 12140, 11866,
+    11585, 11297, 11003, 10702, 10394, 10080,  9760,  9434,
+     9102,  8765,  8423,  8076,  7723,  7366,  7005,  6639,
+     6270,  5897,  5520,  5139,  4756,  4370,  3981,  3590,
+     3196,  2801,  2404,  2006,  1606,  1205,   804,   402,
+        0
+};
+
+/* === Implementation ====================================================== */
+
+int16_t pmu_math_cos_q14(uint8_t phase)
+{
+    uint8_t idx = phase & 0x7F;
+    int16_t val;
+
+    /* cos(x + pi) = -cos(x) */
+    if (idx <= 64)
+    {
+        val = pmu_cos_q14[idx];
+    }
+    else
+    {
+        val = -pmu_cos_q14[128 - idx];
+    }
+
+    return (phase & 0x80) ? -val : val;
+}
+
+
+
+int16_t pmu_math_sin_q14(uint8_t phase)
+{
+    return pmu_math_cos_q14((uint8_t)(phase - 64));
+}
+
+
+
+void pmu_math_sum_steps(const uint8_t *init_val,
+                        const uint8_t *refl_val,
+                        uint8_t no_of_freq,
+                        int32_t *sum_cos,
+                        int32_t *sum_sin)
+{
+    uint8_t prev = (uint8_t)(init_val[0] + refl_val[0]);
+    int32_t sc = 0;
+    int32_t ss = 0;
+
+    for (uint8_t i = 1; i < no_of_freq; i++)
+    {
+        uint8_t curr = (uint8_t)(init_val[i] + refl_val[i]);
+        uint8_t step = (uint8_t)(curr - prev);
+
+        sc += pmu_math_cos_q14(step);
+        ss += pmu_math_sin_q14(step);
+        prev = curr;
+    }
+
+    *sum_cos = sc;
+    *sum_sin = ss;
+}
+
+
+
+int16_t pmu_math_steps_2_dist(int32_t sum_cos,
+                              int32_t sum_sin,
+                              uint8_t no_of_freq,
+                              uint8_t f_step,
+                              int8_t dist_offset,
+                              uint32_t *dist_cm,
+                              uint8_t *dqf)
+{
+    double angle;
+    double magnitude;
+    double dist;
+    int32_t dist_cm_signed;
+
+    angle = atan2((double)sum_sin, (double)sum_cos);
+    if (angle < 0)
+    {
+        angle += 2.0 * M_PI;
+    }
+
+    dist = (angle / (2.0 * M_PI)) * SPEED_OF_LIGHT /
+           (2.0 * PMU_STEP_IN_HZ(f_step));
+
+    dist_cm_signed = (int32_t)lround(dist * 100.0) + dist_offset;
+    *dist_cm = (dist_cm_signed < 0) ? 0 : (uint32_t)dist_cm_signed;
+
+    magnitude = sqrt((double)sum_cos * sum_cos + (double)sum_sin * sum_sin);
+    *dqf = (uint8_t)lround(100.0 * magnitude /
+                           ((double)PMU_MATH_Q14_ONE * (no_of_freq - 1)));
+
+    return (int16_t)lround(angle * 128.0 / M_PI);
+}
+
+
+
+void pmu_math_combine(const uint32_t *dist_cm,
+                      const uint8_t *dqf,
+                      uint8_t no_of_ant_meas,
+                      bool apply_min_dist_threshold,
+                      uint32_t *result_dist_cm,
+                      uint8_t *result_dqf)
+{
+    uint32_t weighted_dist = 0;
+    uint16_t dqf_sum = 0;
+    uint32_t min_dist = PMU_MATH_INVALID_DISTANCE;
+    uint8_t min_dqf = 0;
+
+    for (uint8_t ant_meas = 0; ant_meas < no_of_ant_meas; ant_meas++)
+    {
+        weighted_dist += dist_cm[ant_meas] * dqf[ant_meas];
+        dqf_sum += dqf[ant_meas];
+
+        if ((dqf[ant_meas] > 0) && (dist_cm[ant_meas] < min_dist))
+        {
+            min_dist = dist_cm[ant_meas];
+            min_dqf = dqf[ant_meas];
+        }
+    }
+
+    if (0 == dqf_sum)
+    {
+        *result_dist_cm = PMU_MATH_INVALID_DISTANCE;
+        *result_dqf = 0;
+    }
+    else if (apply_min_dist_threshold)
+    {
+        *result_dist_cm = min_dist;
+        *result_dqf = min_dqf;
+    }
+    else
+    {
+        *result_dist_cm = weighted_dist / dqf_sum;
+        *result_dqf = (uint8_t)(dqf_sum / no_of_ant_meas);
+    }
+}
+
+
+
+
+uint16_t pmu_math_pack_len(uint16_t no_of_values, uint8_t width)
+{
+    /* One octet for the width */
+    return (uint16_t)(1 + (((uint32_t)no_of_values * width + 7) / 8));
+}
+
+
+
+/*
+ * Dither of the packed value with the given index.
+ * Adding a dither known to both sides before truncation and subtracting it
+ * afterwards makes the truncation error independent of the PMU value, so
+ * the error averages out over the frequencies instead of biasing the
+ * distance.
+ */
+static uint8_t pack_dither(uint16_t idx, uint8_t shift)
+{
+    return (uint8_t)((uint8_t)(idx * PACK_DITHER_STEP) >> (PMU_MATH_PACK_MAX_WIDTH - shift));
+}
+
+
+
+/* Number of values fitting into a block of packed values. */
+static uint16_t pack_values_per_block(uint16_t max_len, uint8_t width)
+{
+    return (uint16_t)(((uint32_t)(max_len - 1) * 8) / width);
+}
+
+
+
+uint8_t pmu_math_pack_width(uint16_t no_of_values,
+                            uint16_t max_len,
+                            uint8_t min_width,
+                            uint16_t *no_of_packed_values)
+{
+    uint16_t min_blocks;
+    uint16_t per_block;
+    uint8_t width;
+
+    per_block = pack_values_per_block(max_len, min_width);
+    min_blocks = (no_of_values + per_block - 1) / per_block;
+
+    for (width = PMU_MATH_PACK_MAX_WIDTH; width > min_width; width--)
+    {
+        per_block = pack_values_per_block(max_len, width);
+        if (((no_of_values + per_block - 1) / per_block) <= min_blocks)
+        {
+            break;
+        }
+    }
+
+    per_block = pack_values_per_block(max_len, width);
+
+    *no_of_packed_values = (no_of_values < per_block) ? no_of_values : per_block;
+
+    return width;
+}
+
+
+
+uint16_t pmu_math_pack(const uint8_t *values,
+                       uint16_t start,
+                       uint16_t no_of_values,
+                       uint8_t width,
+                       uint8_t *block)
+{
+    uint16_t len = pmu_math_pack_len(no_of_values, width);
+    uint8_t shift = PMU_MATH_PACK_MAX_WIDTH - width;
+    uint8_t *ptr = block + 1;
+    uint8_t bit_pos = 0;
+
+    block[0] = width;
+    for (uint16_t i = 1; i < len; i++)
+    {
+        block[i] = 0;
+    }
+
+    for (uint16_t i = 0; i < no_of_values; i++)
+    {
+        uint16_t value = values[i];
+
+        /* The phase wraps around. */
+        if (shift > 0)
+        {
+            value = ((value + pack_dither(start + i, shift)) & 0xFF) >> shift;
+        }
+
+        value <<= bit_pos;
+        ptr[0] |= (uint8_t)value;
+        if ((bit_pos + width) > 8)
+        {
+            ptr[1] |= (uint8_t)(value >> 8);
+        }
+
+        bit_pos += width;
+        ptr += bit_pos / 8;
+        bit_pos %= 8;
+    }
+
+    return len;
+}
+
+
+
+bool pmu_math_unpack(const uint8_t *block,
+                     uint16_t start,
+                     uint16_t no_of_values,
+                     uint8_t *values)
+{
+    uint8_t width = block[0];
+    uint8_t shift = PMU_MATH_PACK_MAX_WIDTH - width;
+    const uint8_t *ptr = block + 1;
+    uint8_t bit_pos = 0;
+
+    if ((0 == width) || (width > PMU_MATH_PACK_MAX_WIDTH))
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < no_of_values; i++)
+    {
+        uint16_t value = ptr[0];
+
+        if ((bit_pos + width) > 8)
+        {
+            value |= (uint16_t)ptr[1] << 8;
+        }
+        value = (value >> bit_pos) & (uint16_t)((1 << width) - 1);
+
+        values[i] = (uint8_t)(value << shift);
+        if (shift > 0)
+        {
+            /* Center of the truncation interval without dither */
+            values[i] += (uint8_t)((1 << (shift - 1)) - pack_dither(start + i, shift));
+        }
+
+        bit_pos += width;
+        ptr += bit_pos / 8;
+        bit_pos %= 8;
+    }
+
+    return true;
+}
+
+/* EOF */
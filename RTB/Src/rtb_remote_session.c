@@ -0,0 +1,441 @@
+/**
+ * @file rtb_remote_session.c
+ *
+ * @brief Remote ranging sessions of the Coordinator
+ *
+ * A Coordinator requests a remote ranging by a Remote Range Request frame
+ * and is released as soon as this frame is transmitted; the Initiator
+ * performs the actual ranging and answers by a Remote Range Confirm frame.
+ * Each requested remote ranging is kept as session, keyed by the Initiator
+ * and Reflector address, so that several remote rangings can be ongoing
+ * concurrently, received Remote Range Confirm frames are matched to their
+ * request, and a remote ranging not answered by the Initiator is confirmed
+ * with RTB_TIMEOUT.
+ *
+ * An Initiator receiving a Remote Range Request frame while busy with
+ * another ranging keeps the request and rejects it with
+ * RTB_RANGING_IN_PROGRESS as soon as the ongoing ranging is finished,
+ * instead of leaving the Coordinator waiting for the session timeout.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_REMOTE)
+
+/* === Includes ============================================================ */
+
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+/** Handle of an unused session */
+#define NO_SESSION                      (0)
+
+/* === Types =============================================================== */
+
+/** Remote ranging session of the Coordinator */
+typedef struct range_remote_session_tag
+{
+    /** Handle of the session, NO_SESSION if unused */
+    uint8_t handle;
+    /** Address spec of the Initiator */
+    wpan_addr_spec_t InitiatorAddrSpec;
+    /** Address spec of the Reflector */
+    wpan_addr_spec_t ReflectorAddrSpec;
+    /** Time at which the session expires (in us) */
+    uint32_t expiry_time;
+} range_remote_session_t;
+
+/** Remote Range Request received by the busy Initiator */
+typedef struct range_remote_busy_tag
+{
+    /** The request is to be rejected */
+    bool pending;
+    /** Address spec of the Initiator, i.e. this node */
+    wpan_addr_spec_t InitiatorAddrSpec;
+    /** Address spec of the Reflector */
+    wpan_addr_spec_t ReflectorAddrSpec;
+    /** Address spec of the Coordinator */
+    wpan_addr_spec_t CoordinatorAddrSpec;
+} range_remote_busy_t;
+
+/* === Globals ============================================================= */
+
+/** Remote ranging sessions of the Coordinator */
+static range_remote_session_t remote_sessions[RTB_REMOTE_MAX_SESSIONS];
+
+/** Handle of the last opened session */
+static uint8_t last_session_handle;
+
+/** Remote Range Requests to be rejected by the busy Initiator */
+static range_remote_busy_t remote_busy[RTB_REMOTE_MAX_BUSY_CONF];
+
+/* === Prototypes ========================================================== */
+
+static bool addr_spec_equal(wpan_addr_spec_t *a, wpan_addr_spec_t *b);
+static range_remote_session_t *find_session(wpan_addr_spec_t *initiator_addr_spec,
+                                            wpan_addr_spec_t *reflector_addr_spec);
+static uint32_t session_time(void);
+static void start_session_timer(void);
+static void remote_session_timer_cb(void *callback_parameter);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the remote ranging sessions
+ *
+ * Ongoing sessions are dropped without confirm, as well as Remote Range
+ * Requests to be rejected.
+ */
+void range_remote_session_init(void)
+{
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_SESSIONS; i++)
+    {
+        remote_sessions[i].handle = NO_SESSION;
+    }
+
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_BUSY_CONF; i++)
+    {
+        remote_busy[i].pending = false;
+    }
+
+    pal_timer_stop(T_RTB_Remote_Session);
+}
+
+
+
+/**
+ * @brief Opens a remote ranging session
+ *
+ * @param initiator_addr_spec Address spec of the Initiator
+ * @param reflector_addr_spec Address spec of the Reflector
+ *
+ * @return RTB_SUCCESS if the session has been opened,
+ *         RTB_RANGING_IN_PROGRESS if a session with the same Initiator and
+ *         Reflector is ongoing, or RTB_SESSION_TABLE_FULL if no further
+ *         session can be opened.
+ */
+uint8_t range_remote_session_open(wpan_addr_spec_t *initiator_addr_spec,
+                                  wpan_addr_spec_t *reflector_addr_spec)
+{
+    range_remote_session_t *session = NULL;
+    uint32_t now;
+
+    if (NULL != find_session(initiator_addr_spec, reflector_addr_spec))
+    {
+        /*
+         * The Remote Range Confirm frames of both sessions could not be
+         * distinguished.
+         */
+        return (uint8_t)RTB_RANGING_IN_PROGRESS;
+    }
+
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_SESSIONS; i++)
+    {
+        if (NO_SESSION == remote_sessions[i].handle)
+        {
+            session = &remote_sessions[i];
+            break;
+        }
+    }
+
+    if (NULL == session)
+    {
+        return (uint8_t)RTB_SESSION_TABLE_FULL;
+    }
+
+    last_session_handle++;
+    if (NO_SESSION == last_session_handle)
+    {
+        last_session_handle++;
+    }
+
+    pal_get_current_time(&now);
+
+    session->handle = last_session_handle;
+    session->InitiatorAddrSpec = *initiator_addr_spec;
+    session->ReflectorAddrSpec = *reflector_addr_spec;
+    session->expiry_time = pal_add_time_us(now, session_time());
+
+    /*
+     * The session time depends on the sweep of the request, so the new
+     * session may expire before the one the timer is running for.
+     */
+    pal_timer_stop(T_RTB_Remote_Session);
+    start_session_timer();
+
+    return (uint8_t)RTB_SUCCESS;
+}
+
+
+
+/**
+ * @brief Closes a remote ranging session
+ *
+ * @param initiator_addr_spec Address spec of the Initiator
+ * @param reflector_addr_spec Address spec of the Reflector
+ *
+ * @return Handle of the closed session, or 0 if no session has been ongoing
+ */
+uint8_t range_remote_session_close(wpan_addr_spec_t *initiator_addr_spec,
+                                   wpan_addr_spec_t *reflector_addr_spec)
+{
+    range_remote_session_t *session = find_session(initiator_addr_spec,
+                                                   reflector_addr_spec);
+    uint8_t handle;
+
+    if (NULL == session)
+    {
+        return NO_SESSION;
+    }
+
+    /* The session timer is updated on its next expiry. */
+    handle = session->handle;
+    session->handle = NO_SESSION;
+
+    return handle;
+}
+
+
+
+/**
+ * @brief Keeps a Remote Range Request received while busy (Initiator)
+ *
+ * The request is rejected by range_remote_busy_task() once the ongoing
+ * ranging is finished. If too many requests are kept already, the
+ * Coordinator confirms the request after its session timeout.
+ * A repeated request, e.g. a retransmission due to a lost ACK, is not
+ * kept, since it belongs to the same session of the Coordinator.
+ *
+ * @param initiator_addr_spec Address spec of the Initiator, i.e. this node
+ * @param reflector_addr_spec Address spec of the requested Reflector
+ * @param coordinator_addr_spec Address spec of the Coordinator
+ */
+void range_remote_busy_store(wpan_addr_spec_t *initiator_addr_spec,
+                             wpan_addr_spec_t *reflector_addr_spec,
+                             wpan_addr_spec_t *coordinator_addr_spec)
+{
+    range_remote_busy_t *free_busy = NULL;
+
+    /* The ongoing remote ranging answers the repeated request. */
+    if ((0 != range_param.CoordinatorAddrSpec.AddrMode) &&
+        addr_spec_equal(&range_param.CoordinatorAddrSpec, coordinator_addr_spec) &&
+        addr_spec_equal(&range_param.ReflectorAddrSpec, reflector_addr_spec))
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_BUSY_CONF; i++)
+    {
+        range_remote_busy_t *busy = &remote_busy[i];
+
+        if (!busy->pending)
+        {
+            if (NULL == free_busy)
+            {
+                free_busy = busy;
+            }
+        }
+        else if (addr_spec_equal(&busy->CoordinatorAddrSpec, coordinator_addr_spec) &&
+                 addr_spec_equal(&busy->ReflectorAddrSpec, reflector_addr_spec))
+        {
+            /* The request is already kept. */
+            return;
+        }
+    }
+
+    if (NULL != free_busy)
+    {
+        free_busy->InitiatorAddrSpec = *initiator_addr_spec;
+        free_busy->ReflectorAddrSpec = *reflector_addr_spec;
+        free_busy->CoordinatorAddrSpec = *coordinator_addr_spec;
+        free_busy->pending = true;
+    }
+}
+
+
+
+/**
+ * @brief Rejects a Remote Range Request received while busy (Initiator)
+ *
+ * This function is called by the RTB state machine while no ranging is
+ * ongoing. It sends the Remote Range Confirm frame of the next kept
+ * request with RTB_RANGING_IN_PROGRESS as reject reason, the same way
+ * as a request rejected right away.
+ */
+void range_remote_busy_task(void)
+{
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_BUSY_CONF; i++)
+    {
+        range_remote_busy_t *busy = &remote_busy[i];
+
+        if (busy->pending)
+        {
+            busy->pending = false;
+
+            range_param.InitiatorAddrSpec = busy->InitiatorAddrSpec;
+            range_param.ReflectorAddrSpec = busy->ReflectorAddrSpec;
+            range_param.CoordinatorAddrSpec = busy->CoordinatorAddrSpec;
+            /* No measurement pairs are appended to a rejection. */
+            range_param.remote_caps = 0;
+
+            rtb_role = RTB_ROLE_INITIATOR;
+            reset_pmu_average_data();
+            range_status.range_error = (range_error_t)RTB_RANGING_IN_PROGRESS;
+            RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
+            return;
+        }
+    }
+}
+
+
+
+/* Helper function comparing two address specs. */
+static bool addr_spec_equal(wpan_addr_spec_t *a, wpan_addr_spec_t *b)
+{
+    if ((a->AddrMode != b->AddrMode) || (a->PANId != b->PANId))
+    {
+        return false;
+    }
+
+    if (FCF_SHORT_ADDR == a->AddrMode)
+    {
+        return (a->Addr.short_address == b->Addr.short_address);
+    }
+
+    return (a->Addr.long_address == b->Addr.long_address);
+}
+
+
+
+/* Helper function searching the session of an Initiator and Reflector. */
+static range_remote_session_t *find_session(wpan_addr_spec_t *initiator_addr_spec,
+                                            wpan_addr_spec_t *reflector_addr_spec)
+{
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_SESSIONS; i++)
+    {
+        range_remote_session_t *session = &remote_sessions[i];
+
+        if ((NO_SESSION != session->handle) &&
+            addr_spec_equal(&session->InitiatorAddrSpec, initiator_addr_spec) &&
+            addr_spec_equal(&session->ReflectorAddrSpec, reflector_addr_spec))
+        {
+            return session;
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/*
+ * Time the Coordinator waits for the Remote Range Confirm frame of the
+ * requested ranging, derived from the number of PMU values of its sweep.
+ */
+static uint32_t session_time(void)
+{
+    uint16_t no_of_freq = 1;
+
+    if (RANGE_PROFILE(PMUFreqStop) > RANGE_PROFILE(PMUFreqStart))
+    {
+        no_of_freq += (uint16_t)((RANGE_PROFILE(PMUFreqStop) -
+                                  RANGE_PROFILE(PMUFreqStart)) * 2) >>
+                      RANGE_PROFILE(PMUFreqStep);
+    }
+
+    return (RTB_REMOTE_SESSION_BASE_TIME +
+            RTB_REMOTE_SESSION_VALUE_TIME * RTB_REMOTE_SESSION_ANT_PAIRS *
+            no_of_freq);
+}
+
+
+
+/*
+ * Starts the session timer for the earliest expiring session.
+ * Sessions which are already expired are confirmed with RTB_TIMEOUT.
+ */
+static void start_session_timer(void)
+{
+    uint32_t now;
+    uint32_t timeout = 0;
+    bool pending = false;
+
+    pal_get_current_time(&now);
+
+    for (uint8_t i = 0; i < RTB_REMOTE_MAX_SESSIONS; i++)
+    {
+        range_remote_session_t *session = &remote_sessions[i];
+        uint32_t remaining;
+
+        if (NO_SESSION == session->handle)
+        {
+            continue;
+        }
+
+        remaining = pal_sub_time_us(session->expiry_time, now);
+
+        if ((remaining == 0) || (remaining > RTB_REMOTE_SESSION_MAX_TIME))
+        {
+            /* Session expired; the Initiator did not answer. */
+            uint8_t handle = session->handle;
+
+            session->handle = NO_SESSION;
+            range_gen_rtb_remote_session_conf(&session->InitiatorAddrSpec,
+                                              &session->ReflectorAddrSpec,
+                                              handle,
+                                              (uint8_t)RTB_TIMEOUT,
+                                              INVALID_DISTANCE,
+                                              DQF_ZERO,
+                                              0,
+                                              NULL);
+        }
+        else if (!pending || (remaining < timeout))
+        {
+            timeout = remaining;
+            pending = true;
+        }
+    }
+
+    if (pending)
+    {
+        if (timeout < MIN_TIMEOUT)
+        {
+            timeout = MIN_TIMEOUT;
+        }
+
+        pal_timer_start(T_RTB_Remote_Session,
+                        timeout,
+                        TIMEOUT_RELATIVE,
+                        (FUNC_PTR())remote_session_timer_cb,
+                        NULL);
+    }
+}
+
+
+
+/* Timer callback handling expired sessions. */
+static void remote_session_timer_cb(void *callback_parameter)
+{
+    start_session_timer();
+
+    /* Keep compiler happy. */
+    callback_parameter = callback_parameter;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_REMOTE) */
+
+/* EOF */
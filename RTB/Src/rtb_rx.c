@@ -49,7 +49,13 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr);
 static void handle_result_conf_frame(uint8_t *curr_frame_ptr);
 static void handle_result_req_frame(uint8_t *curr_frame_ptr);
 static bool handle_rx_rtb_frame_type(frame_info_t *rx_frame_ptr);
+#ifdef ENABLE_RTB_DIRECT_DISPATCH
+static bool is_rtb_frame(frame_info_t *rx_frame_ptr);
+#endif  /* ENABLE_RTB_DIRECT_DISPATCH */
 #ifdef ENABLE_RTB_REMOTE
+static uint8_t extract_remote_refl_addr(uint8_t *curr_frame_ptr,
+                                        wpan_addr_spec_t *reflector_addr_spec);
+static void handle_busy_remote_range_req_frame(uint8_t *curr_frame_ptr);
 static void handle_remote_range_conf_frame(uint8_t *curr_frame_ptr);
 static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr);
 #endif  /* ENABLE_RTB_REMOTE */
@@ -62,6 +68,11 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr);
  * This function pushes an event into the TAL-RTB queue, indicating a
  * frame reception.
  *
+ * With ENABLE_RTB_DIRECT_DISPATCH an RTB frame is handled right away
+ * instead, and the RTB state machine transmits the next frame of the
+ * ranging procedure before returning to the TAL. This saves one pass of
+ * the main loop per frame of the ranging procedure.
+ *
  * @param frame Pointer to recived frame
  */
 void rtb_rx_frame_cb(frame_info_t *frame)
@@ -76,11 +87,86 @@ void rtb_rx_frame_cb(frame_info_t *frame)
         return;
     }
 
+#ifdef ENABLE_RTB_DIRECT_DISPATCH
+    /*
+     * Frames queued before are handled first, in their order.
+     * The TAL handles the end of a transmission after the received frames,
+     * so while an RTB frame is being transmitted, the received frame is
+     * queued and handled once the RTB knows the transmission is done.
+     */
+    if ((0 == tal_rtb_q.size) && !rtb_tx_in_progress && is_rtb_frame(frame))
+    {
+        rtb_process_data_ind((uint8_t *)frame->buffer_header);
+        rtb_state_machine();
+        return;
+    }
+#endif  /* ENABLE_RTB_DIRECT_DISPATCH */
+
     qmm_queue_append(&tal_rtb_q, frame->buffer_header);
 }
 
 
 
+#ifdef ENABLE_RTB_DIRECT_DISPATCH
+/*
+ * @brief Checks whether a received frame is an RTB frame
+ *
+ * Only the frame identifier is checked; the frame is parsed
+ * by handle_rx_rtb_frame_type() afterwards.
+ *
+ * @param rx_frame_ptr Pointer to frame received from TAL
+ *
+ * @return bool True if the frame is an unsecured data frame carrying the
+ *              RTB frame identifier.
+ */
+static bool is_rtb_frame(frame_info_t *rx_frame_ptr)
+{
+    uint8_t *mpdu = rx_frame_ptr->mpdu;
+    uint16_t fcf;
+    uint8_t addr_mode;
+    /* Length, FCF and Sequence Number precede the addressing fields. */
+    uint8_t payload_index = 4;
+
+    fcf = convert_byte_array_to_16_bit(&mpdu[1]);
+    fcf = CLE16_TO_CPU_ENDIAN(fcf);
+
+    if ((FCF_FRAMETYPE_DATA != FCF_GET_FRAMETYPE(fcf)) ||
+        (fcf & FCF_SECURITY_ENABLED))
+    {
+        return false;
+    }
+
+    addr_mode = FCF_GET_DEST_ADDR_MODE(fcf);
+    if (FCF_NO_ADDR != addr_mode)
+    {
+        payload_index += sizeof(uint16_t);
+        payload_index += (FCF_LONG_ADDR == addr_mode) ? sizeof(uint64_t) : sizeof(uint16_t);
+    }
+
+    addr_mode = FCF_GET_SOURCE_ADDR_MODE(fcf);
+    if (FCF_NO_ADDR != addr_mode)
+    {
+        if (!(fcf & FCF_PAN_ID_COMPRESSION))
+        {
+            payload_index += sizeof(uint16_t);
+        }
+        payload_index += (FCF_LONG_ADDR == addr_mode) ? sizeof(uint64_t) : sizeof(uint16_t);
+    }
+
+    /* Frame identifier and command id need to be followed by the FCS. */
+    if ((payload_index + 4 + FCS_LEN) > (mpdu[0] + 1))
+    {
+        return false;
+    }
+
+    return ((RTB_FRAME_ID_1 == mpdu[payload_index]) &&
+            (RTB_FRAME_ID_2 == mpdu[payload_index + 1]) &&
+            (RTB_FRAME_ID_3 == mpdu[payload_index + 2]));
+}
+#endif  /* ENABLE_RTB_DIRECT_DISPATCH */
+
+
+
 void rtb_process_data_ind(uint8_t *msg)
 {
     buffer_t *buf_ptr = (buffer_t *)msg;
@@ -245,8 +331,16 @@ static bool handle_rx_rtb_frame_type(frame_info_t *rx_frame_ptr)
 					
                     case CMD_RESULT_REQ:
                         {
-                            /* This is a result request frame. */
-                            if (RTB_ROLE_REFLECTOR == rtb_role)
+                            /*
+                             * This is a result request frame.
+                             * It is only answered once the own PMU values
+                             * are available, i.e. not if the measurement
+                             * has been missed.
+                             */
+                            if ((RTB_ROLE_REFLECTOR == rtb_role) &&
+                                ((RTB_AWAIT_RESULT_REQ_FRAME == rtb_state) ||
+                                 (RTB_INIT_RESULT_CONF_FRAME == rtb_state) ||
+                                 (RTB_RESULT_CONF_FRAME_DONE == rtb_state)))
                             {
                                 handle_result_req_frame(temp_frame_ptr);
 
@@ -298,11 +392,21 @@ static void handle_received_pmu_values(uint8_t *curr_frame_ptr)
 {
     pmu_handle_received_pmu_values(curr_frame_ptr);
 
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if ((range_param.caps & PMU_CAP_REFLECTOR_PUSH) &&
+        !pmu_push_window_done())
+    {
+        /* Further pushed Result Confirm frames are pending. */
+        range_start_await_timer(RTB_AWAIT_RESULT_CONF_FRAME);
+        return;
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
     /* Check whether we should expect further values. */
     if (pmu_more_results_to_be_expected())
     {
         /* More result values pending. */
-        rtb_state = RTB_INIT_RESULT_REQ_FRAME;
+        RTB_SET_STATE(RTB_INIT_RESULT_REQ_FRAME);
     }
     else
     {
@@ -314,8 +418,12 @@ static void handle_received_pmu_values(uint8_t *curr_frame_ptr)
          * Check whether results for more antenna
          * values available.
          */
-        if (range_status_pmu.curr_antenna_measurement_no <
-            (range_param_pmu.antenna_measurement_nos - 1))
+        if ((range_status_pmu.curr_antenna_measurement_no <
+             (range_param_pmu.antenna_measurement_nos - 1))
+#ifdef ENABLE_RTB_PUSH_RESULTS
+            && !(range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+           )
         {
             /*
              * Continue with next result values for
@@ -323,7 +431,7 @@ static void handle_received_pmu_values(uint8_t *curr_frame_ptr)
              */
             range_status_pmu.curr_antenna_measurement_no++;
             pmu_reset_pmu_result_vars();
-            rtb_state = RTB_INIT_RESULT_REQ_FRAME;
+            RTB_SET_STATE(RTB_INIT_RESULT_REQ_FRAME);
         }
         else
         {
@@ -333,7 +441,7 @@ static void handle_received_pmu_values(uint8_t *curr_frame_ptr)
              */
             /* Regular handling, no more result data to be requested. */
             pmu_set_pmu_result_idx_done();
-            rtb_state = RTB_RESULT_CALC;
+            RTB_SET_STATE(RTB_RESULT_CALC);
         }
     }
 }
@@ -350,7 +458,7 @@ static void handle_pmu_time_sync_frame(void)
     /* Cancel running timer. */
     range_stop_await_timer();
 
-    rtb_state = RTB_INIT_PMU_START_FRAME;
+    RTB_SET_STATE(RTB_INIT_PMU_START_FRAME);
 
     /* Start timer in case Result Request frame is not received. */
     range_start_await_timer(RTB_INIT_PMU_START_FRAME);
@@ -380,10 +488,19 @@ static void handle_range_acpt_frame(uint8_t *curr_frame_ptr)
                  */
                 range_param.caps = *curr_frame_ptr++;
                 pmu_configure_antenna();
+
+#ifdef ENABLE_RTB_SPECTRUM
+                /* Sweep the Frequency Plan agreed by the Reflector. */
+                if ((range_param.caps & PMU_CAP_REFLECTOR_SPECTRUM) &&
+                    (FREQ_PLAN_IE == *curr_frame_ptr))
+                {
+                    range_spectrum_apply_plan(curr_frame_ptr + 1);
+                }
+#endif  /* ENABLE_RTB_SPECTRUM */
             }
 
             /* Ranging Request is accepted. */
-            rtb_state = RTB_INIT_TIME_SYNC_REQ_FRAME;
+            RTB_SET_STATE(RTB_INIT_TIME_SYNC_REQ_FRAME);
         }
         else
         {
@@ -398,7 +515,7 @@ static void handle_range_acpt_frame(uint8_t *curr_frame_ptr)
                  * a Remote Range Confirm frame.
                  */
                 range_status.range_error = range_reject_reason;
-                rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+                RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
             }
             else
 #endif  /* ENABLE_RTB_REMOTE */
@@ -449,7 +566,7 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
     {
         /* Ranging is currently disabled, reject new request. */
         range_status.range_error = (range_error_t)RTB_UNSUPPORTED_RANGING;
-        rtb_state = RTB_INIT_RANGE_ACPT_FRAME;
+        RTB_SET_STATE(RTB_INIT_RANGE_ACPT_FRAME);
         /*
          * The role needs to be updated even in error
          * case to  be able to properly release the
@@ -467,6 +584,9 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
     else
     {
         uint8_t frame_len;
+#ifdef ENABLE_RTB_SPECTRUM
+        uint8_t *plan_ptr = NULL;
+#endif  /* ENABLE_RTB_SPECTRUM */
 
         rtb_role = RTB_ROLE_REFLECTOR;
 
@@ -513,10 +633,12 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
                  * use antenna diversity value received from the initiator,
                  * and simply update our own.
                  */
-                if (rtb_pib.EnableAntennaDiv)
+                if (rtb_pib.EnableAntennaDiv &&
+                    (range_param.caps & PMU_CAP_REFLECTOR_ANT))
                 {
                     /*
-                     * Reflector uses antenna diversity.
+                     * Reflector uses antenna diversity, unless the
+                     * Initiator asks not to use it for this ranging.
                      * Keep Initiator antenna diversity as is.
                      */
                     range_param.caps |= PMU_CAP_REFLECTOR_ANT;
@@ -538,6 +660,36 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
 
 #endif  /* (ANTENNA_DIVERSITY == 1) */
 
+                /*
+                 * Agree to send compressed PMU values if the Initiator
+                 * accepts them.
+                 */
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+                if (range_param.caps & PMU_CAP_INITIATOR_COMPR)
+                {
+                    range_param.caps |= PMU_CAP_REFLECTOR_COMPR;
+                }
+                else
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+                {
+                    range_param.caps &= ~(PMU_CAP_REFLECTOR_COMPR);
+                }
+
+                /*
+                 * Agree to push all Result Confirm frames upon a single
+                 * Result Request frame if the Initiator accepts them.
+                 */
+#ifdef ENABLE_RTB_PUSH_RESULTS
+                if (range_param.caps & PMU_CAP_INITIATOR_PUSH)
+                {
+                    range_param.caps |= PMU_CAP_REFLECTOR_PUSH;
+                }
+                else
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+                {
+                    range_param.caps &= ~(PMU_CAP_REFLECTOR_PUSH);
+                }
+
                 /*
                  * Initialize the Ranging Transmit Power to be applied at the
                  * Reflector in case this parameter is not included properly
@@ -546,17 +698,58 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
                 range_param.req_tx_power = rtb_pib.RangingTransmitPower;
 
                 /* Check wether Requested Ranging Transmit Power IE is available. */
-                if (frame_len == IE_PMU_RANGING_LEN + IE_REQ_RANGING_TX_POWER_LEN)
+                if ((frame_len >= IE_PMU_RANGING_LEN + IE_REQ_RANGING_TX_POWER_LEN) &&
+                    (REQ_RANGING_TX_POWER_IE == *curr_frame_ptr))
                 {
                     /*
                      * Extract and set requested Ranging Transmit Power
                      * (if changed).
                      */
-                    if (REQ_RANGING_TX_POWER_IE == *curr_frame_ptr++)
+                    curr_frame_ptr++;
+                    /* Overwrite Ranging Transmit Power. */
+                    range_param.req_tx_power = *curr_frame_ptr++;
+                    frame_len -= IE_REQ_RANGING_TX_POWER_LEN;
+                }
+
+                /*
+                 * Truncate compressed PMU values only down to the width
+                 * explicitly accepted by the Initiator, otherwise keep them
+                 * lossless. The IE is skipped if compression is not supported.
+                 */
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+                range_param.compr_min_width = RTB_COMPR_RESULTS_FULL_WIDTH;
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+                if ((frame_len >= IE_PMU_RANGING_LEN + IE_COMPR_WIDTH_LEN) &&
+                    (COMPR_WIDTH_IE == *curr_frame_ptr))
+                {
+                    curr_frame_ptr++;
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+                    if ((*curr_frame_ptr > 0) &&
+                        (*curr_frame_ptr < RTB_COMPR_RESULTS_FULL_WIDTH))
                     {
-                        /* Overwrite Ranging Transmit Power. */
-                        range_param.req_tx_power = *curr_frame_ptr++;
+                        range_param.compr_min_width = *curr_frame_ptr;
                     }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+                    curr_frame_ptr++;
+                    frame_len -= IE_COMPR_WIDTH_LEN;
+                }
+
+                /*
+                 * Agree to sweep a common Frequency Plan if the Initiator
+                 * has proposed one.
+                 */
+#ifdef ENABLE_RTB_SPECTRUM
+                if ((range_param.caps & PMU_CAP_INITIATOR_SPECTRUM) &&
+                    (frame_len >= IE_PMU_RANGING_LEN + IE_FREQ_PLAN_LEN) &&
+                    (FREQ_PLAN_IE == *curr_frame_ptr))
+                {
+                    plan_ptr = curr_frame_ptr + 1;
+                    range_param.caps |= PMU_CAP_REFLECTOR_SPECTRUM;
+                }
+                else
+#endif  /* ENABLE_RTB_SPECTRUM */
+                {
+                    range_param.caps &= ~(PMU_CAP_REFLECTOR_SPECTRUM);
                 }
 
                 pmu_configure_antenna();
@@ -565,7 +758,7 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
                 {
                     /* Unsupported ranging parameters, reject new request. */
                     range_status.range_error = (range_error_t)RTB_INVALID_PARAMETER;
-                    rtb_state = RTB_INIT_RANGE_ACPT_FRAME;
+                    RTB_SET_STATE(RTB_INIT_RANGE_ACPT_FRAME);
                 }
                 else
                 {
@@ -576,6 +769,14 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
 
                     configure_ranging();
 
+#ifdef ENABLE_RTB_SPECTRUM
+                    if (NULL != plan_ptr)
+                    {
+                        /* Add the busy blocks of the Reflector to the plan. */
+                        range_spectrum_accept_plan(plan_ptr);
+                    }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
 #ifndef RTB_WITHOUT_MAC
                     /*
                      * Block MAC from doing anything else than ranging
@@ -586,21 +787,21 @@ static void handle_range_req_frame(uint8_t *curr_frame_ptr)
 
                     /* Next a Range Accept frame needs to be assembled. */
                     range_status.range_error = RANGE_OK;
-                    rtb_state = RTB_INIT_RANGE_ACPT_FRAME;
+                    RTB_SET_STATE(RTB_INIT_RANGE_ACPT_FRAME);
                 }
             }
             else
             {
                 /* Unsupported ranging method, reject new request. */
                 range_status.range_error = (range_error_t)RTB_UNSUPPORTED_METHOD;
-                rtb_state = RTB_INIT_RANGE_ACPT_FRAME;
+                RTB_SET_STATE(RTB_INIT_RANGE_ACPT_FRAME);
             }
         }
         else    /* if (RTB_PROTOCOL_VERSION_01 == *curr_frame_ptr++) */
         {
             /* Unsupported RTB Protocol Version, reject new request. */
             range_status.range_error = (range_error_t)RTB_UNSUPPORTED_PROTOCOL;
-            rtb_state = RTB_INIT_RANGE_ACPT_FRAME;
+            RTB_SET_STATE(RTB_INIT_RANGE_ACPT_FRAME);
         }
     }
 }
@@ -616,7 +817,12 @@ static void handle_result_req_frame(uint8_t *curr_frame_ptr)
     req_result_type = *(result_frame_ie_t *)curr_frame_ptr;
     curr_frame_ptr++;
 
-    if (RESULT_IE_PMU_VALUES == req_result_type)
+    if ((RESULT_IE_PMU_VALUES == req_result_type)
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+        || ((RESULT_IE_PMU_VALUES_COMPR == req_result_type) &&
+            (range_param.caps & PMU_CAP_REFLECTOR_COMPR))
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+       )
     {
         /* PMU result values are requested and handled. */
         /* Which antenna measurement value is requested? */
@@ -624,6 +830,14 @@ static void handle_result_req_frame(uint8_t *curr_frame_ptr)
 
         pmu_extract_no_of_req_result_values(*(uint16_t *)curr_frame_ptr);
 
+#ifdef ENABLE_RTB_PUSH_RESULTS
+        if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+        {
+            /* Number of values to be pushed follows the start index. */
+            pmu_push_extract_window(curr_frame_ptr + 2);
+        }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
         /*
          * Check whether invalid antenna measurement
          * value has been requested.
@@ -645,7 +859,7 @@ static void handle_result_req_frame(uint8_t *curr_frame_ptr)
         else
         {
             /* Everything is as expected. */
-            rtb_state = RTB_INIT_RESULT_CONF_FRAME;
+            RTB_SET_STATE(RTB_INIT_RESULT_CONF_FRAME);
         }
     }
     else
@@ -677,93 +891,109 @@ static void handle_result_conf_frame(uint8_t *curr_frame_ptr)
 #ifdef ENABLE_RTB_REMOTE
 static void handle_remote_range_conf_frame(uint8_t *curr_frame_ptr)
 {
-    if (RTB_ROLE_NONE == rtb_role)
-    {
-        /*
-         * Only if the Coordinator is currently not
-         * actively involved itself, the Remote-Range-Confirm
-         * is handled, otherwise it is ignored, because this
-         * would corrupt our current local ranging related
-         * address information.
-         */
-        /* Set proper ranging address parameter. */
-        /* Set received source address address as Initiator address. */
-        range_param.InitiatorAddrSpec.AddrMode = mac_parse_data.src_addr_mode;
-        range_param.InitiatorAddrSpec.PANId = mac_parse_data.src_panid;
-        /* Long address also covers short address here. */
-        ADDR_COPY_DST_SRC_64(range_param.InitiatorAddrSpec.Addr.long_address,
-                             mac_parse_data.src_addr.long_address);
+    wpan_addr_spec_t initiator_addr_spec;
+    wpan_addr_spec_t reflector_addr_spec;
+    range_remote_answer_t *rra;
+    uint8_t session_handle;
 
-        refl_addr_t *ra = (refl_addr_t *)curr_frame_ptr;
+    /*
+     * The addresses are kept locally, since range_param may belong to
+     * an ongoing ranging procedure of this node.
+     */
+    /* Set received source address address as Initiator address. */
+    initiator_addr_spec.AddrMode = mac_parse_data.src_addr_mode;
+    initiator_addr_spec.PANId = mac_parse_data.src_panid;
+    /* Long address also covers short address here. */
+    ADDR_COPY_DST_SRC_64(initiator_addr_spec.Addr.long_address,
+                         mac_parse_data.src_addr.long_address);
 
-        /*
-         * Set Reflector address received in frame as
-         * Reflector address.
-         */
-        range_param.ReflectorAddrSpec.PANId = ra->refl_pan_id;
+    refl_addr_t *ra = (refl_addr_t *)curr_frame_ptr;
+
+    /*
+     * Set Reflector address received in frame as
+     * Reflector address.
+     */
+    reflector_addr_spec.PANId = ra->refl_pan_id;
 
-        range_remote_answer_t *rra;
+    if (ra->refl_addr_mode == FCF_SHORT_ADDR)
+    {
+        reflector_addr_spec.AddrMode = FCF_SHORT_ADDR;
+        reflector_addr_spec.Addr.long_address = 0;    // Init long address first
+        ADDR_COPY_DST_SRC_16(reflector_addr_spec.Addr.short_address,
+                             ra->refl_addr.short_address);
+        rra = (range_remote_answer_t *)((uint8_t *) & (ra->refl_addr) + 2);
+    }
+    else
+    {
+        reflector_addr_spec.AddrMode = FCF_LONG_ADDR;
+        ADDR_COPY_DST_SRC_64(reflector_addr_spec.Addr.long_address,
+                             ra->refl_addr.long_address);
+        rra = (range_remote_answer_t *)((uint8_t *) & (ra->refl_addr) + 8);
+    }
 
-        if (ra->refl_addr_mode == FCF_SHORT_ADDR)
-        {
-            range_param.ReflectorAddrSpec.AddrMode = FCF_SHORT_ADDR;
-            range_param.ReflectorAddrSpec.Addr.long_address = 0;    // Init long address first
-            ADDR_COPY_DST_SRC_16(range_param.ReflectorAddrSpec.Addr.short_address,
-                                 ra->refl_addr.short_address);
-            rra = (range_remote_answer_t *)((uint8_t *) & (ra->refl_addr) + 2);
-        }
-        else
-        {
-            range_param.ReflectorAddrSpec.AddrMode = FCF_LONG_ADDR;
-            ADDR_COPY_DST_SRC_64(range_param.ReflectorAddrSpec.Addr.long_address,
-                                 ra->refl_addr.long_address);
-            rra = (range_remote_answer_t *)((uint8_t *) & (ra->refl_addr) + 8);
-        }
+    session_handle = range_remote_session_close(&initiator_addr_spec,
+                                                &reflector_addr_spec);
+    if (0 == session_handle)
+    {
+        /*
+         * No remote ranging with this Initiator and Reflector is ongoing,
+         * e.g. it has already been confirmed due to a timeout.
+         */
+        return;
+    }
 
-        if (RTB_SUCCESS == rra->status)
+    if (RTB_SUCCESS == rra->status)
+    {
+        /* Remote ranging was successful. */
+        /* Check Additional Results IE type. */
+        if (NO_ADDITIONAL_RESULTS == rra->additional_result_ie)
         {
-            /* Remote ranging was successful. */
-            /* Check Additional Results IE type. */
-            if (NO_ADDITIONAL_RESULTS == rra->additional_result_ie)
-            {
-                /* Return remote range confirm. */
-                range_gen_rtb_remote_range_conf(RTB_SUCCESS,
-                                                rra->distance_cm,
-                                                rra->dqf,
-                                                0,
-                                                NULL);
-            }
-            else if (ANT_DIV_MEAS_RESULTS == rra->additional_result_ie)
-            {
-                /* Return remote range confirm with measured values. */
-                range_gen_rtb_remote_range_conf(RTB_SUCCESS,
-                                                rra->distance_cm,
-                                                rra->dqf,
-                                                rra->additional_result_fields.
-                                                prov_antenna_div_results.
-                                                no_of_provided_meas_pairs,
-                                                rra->additional_result_fields.
-                                                prov_antenna_div_results.
-                                                provided_meas_pairs);
-            }
+            /* Return remote range confirm. */
+            range_gen_rtb_remote_session_conf(&initiator_addr_spec,
+                                              &reflector_addr_spec,
+                                              session_handle,
+                                              RTB_SUCCESS,
+                                              rra->distance_cm,
+                                              rra->dqf,
+                                              0,
+                                              NULL);
         }
-        else
+        else if (ANT_DIV_MEAS_RESULTS == rra->additional_result_ie)
         {
-            /* Ranging request is NOT accepted. */
-            /* Return remote range confirm with error values. */
-            range_gen_rtb_remote_range_conf(rra->range_reject_reason,
-                                            INVALID_DISTANCE,
-                                            DQF_ZERO,
-                                            0,
-                                            NULL);
+            /* Return remote range confirm with measured values. */
+            range_gen_rtb_remote_session_conf(&initiator_addr_spec,
+                                              &reflector_addr_spec,
+                                              session_handle,
+                                              RTB_SUCCESS,
+                                              rra->distance_cm,
+                                              rra->dqf,
+                                              rra->additional_result_fields.
+                                              prov_antenna_div_results.
+                                              no_of_provided_meas_pairs,
+                                              rra->additional_result_fields.
+                                              prov_antenna_div_results.
+                                              provided_meas_pairs);
         }
-
-        /*
-         * Note: range_exit() must not be called here;
-         * The remote range confirm is just notified to the
-         * application.
-         */
     }
+    else
+    {
+        /* Ranging request is NOT accepted. */
+        /* Return remote range confirm with error values. */
+        range_gen_rtb_remote_session_conf(&initiator_addr_spec,
+                                          &reflector_addr_spec,
+                                          session_handle,
+                                          rra->range_reject_reason,
+                                          INVALID_DISTANCE,
+                                          DQF_ZERO,
+                                          0,
+                                          NULL);
+    }
+
+    /*
+     * Note: range_exit() must not be called here;
+     * The remote range confirm is just notified to the
+     * application.
+     */
 }
 #endif  /* ENABLE_RTB_REMOTE */
 
@@ -772,6 +1002,17 @@ static void handle_remote_range_conf_frame(uint8_t *curr_frame_ptr)
 #ifdef ENABLE_RTB_REMOTE
 static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
 {
+    if (RTB_ROLE_NONE != rtb_role)
+    {
+        /*
+         * Ranging is currently already ongoing.
+         * The addresses of the ongoing procedure must not be overwritten,
+         * so the request is kept and rejected once this ranging is done.
+         */
+        handle_busy_remote_range_req_frame(curr_frame_ptr);
+        return;
+    }
+
     /*
      * Store addresses for the ongoing transaction.
      * This is required for all cases, also for
@@ -795,15 +1036,22 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
     ADDR_COPY_DST_SRC_64(range_param.CoordinatorAddrSpec.Addr.long_address,
                          mac_parse_data.src_addr.long_address);
 
-    if (RTB_ROLE_NONE != rtb_role)
-    {
-        /* Ranging is currently already ongoing, do nothing. */
-    }
-    else if (!rtb_pib.RangingEnabled)
+    if (!rtb_pib.RangingEnabled)
     {
+        /*
+         * The Coordinator matches the Remote Range Confirm frame to its
+         * session by the Reflector address.
+         */
+        if (RTB_PROTOCOL_VERSION_01 == curr_frame_ptr[1])
+        {
+            extract_remote_refl_addr(&curr_frame_ptr[2],
+                                     &range_param.ReflectorAddrSpec);
+        }
+        range_param.remote_caps = 0;
+
         /* Ranging is currently disabled, reject new request. */
         range_status.range_error = (range_error_t)RTB_UNSUPPORTED_RANGING;
-        rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+        RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
         /*
          * The role needs to be updated even in error
          * case to  be able to properly release the
@@ -832,12 +1080,17 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
 
         if (RTB_PROTOCOL_VERSION_01 == *curr_frame_ptr++)
         {
-            uint8_t refl_addr_len = IE_REFLECTOR_ADDR_SPEC_LEN_MIN;
+            uint8_t refl_addr_len;
 
             /* Currently only one RTB Protocol Version is supported. */
 
             rtb_role = RTB_ROLE_INITIATOR;
 
+#ifdef ENABLE_RTB_RANGE_PROFILE
+            /* The Initiator of a remote ranging uses its own RTB PIB. */
+            range_profile_load(NULL);
+#endif  /* ENABLE_RTB_RANGE_PROFILE */
+
             /*
             * Reset the PMU average data since no valid PMU average data are available
             * at this stage.
@@ -845,25 +1098,8 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
             reset_pmu_average_data();
 
             /* Extract Reflector address information from the frame. */
-            refl_addr_t *ra =
-                (refl_addr_t *)curr_frame_ptr;
-
-            range_param.ReflectorAddrSpec.AddrMode = ra->refl_addr_mode;
-            range_param.ReflectorAddrSpec.PANId = ra->refl_pan_id;
-            /* Long address also covers short address here. */
-
-            if (ra->refl_addr_mode == FCF_SHORT_ADDR)
-            {
-                range_param.ReflectorAddrSpec.Addr.long_address = 0;
-                ADDR_COPY_DST_SRC_16(range_param.ReflectorAddrSpec.Addr.short_address,
-                                     ra->refl_addr.short_address);
-            }
-            else
-            {
-                ADDR_COPY_DST_SRC_64(range_param.ReflectorAddrSpec.Addr.long_address,
-                                     ra->refl_addr.long_address);
-                refl_addr_len += 6;
-            }
+            refl_addr_len = extract_remote_refl_addr(curr_frame_ptr,
+                                                     &range_param.ReflectorAddrSpec);
             curr_frame_ptr += refl_addr_len;
 
             /* Check whether requested ranging method is supported. */
@@ -924,7 +1160,7 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
                 {
                     /* Unsupported ranging parameters, reject new request. */
                     range_status.range_error = (range_error_t)RTB_INVALID_PARAMETER;
-                    rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+                    RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
                 }
                 else
                 {
@@ -952,24 +1188,98 @@ static void handle_remote_range_req_frame(uint8_t *curr_frame_ptr)
                      * transmitted to Reflector
                      */
                     range_status.range_error = RANGE_OK;
-                    rtb_state = RTB_INIT_RANGE_REQ_FRAME;
+                    RTB_SET_STATE(RTB_INIT_RANGE_REQ_FRAME);
                 }
             }
             else
             {
                 /* Unsupported ranging method, reject new request. */
                 range_status.range_error = (range_error_t)RTB_UNSUPPORTED_METHOD;
-                rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+                RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
             }
         }
         else    /* if (RTB_PROTOCOL_VERSION_01 == *curr_frame_ptr++) */
         {
             /* Unsupported RTB Protocol Version, reject new request. */
             range_status.range_error = (range_error_t)RTB_UNSUPPORTED_PROTOCOL;
-            rtb_state = RTB_INIT_REMOTE_RANGE_CONF_FRAME;
+            RTB_SET_STATE(RTB_INIT_REMOTE_RANGE_CONF_FRAME);
         }
     }
 }
+
+
+
+/*
+ * Keeps a Remote Range Request frame received while this node is busy,
+ * so that it can be rejected with RTB_RANGING_IN_PROGRESS once the ongoing
+ * ranging is finished.
+ */
+static void handle_busy_remote_range_req_frame(uint8_t *curr_frame_ptr)
+{
+    wpan_addr_spec_t initiator_addr_spec;
+    wpan_addr_spec_t reflector_addr_spec;
+    wpan_addr_spec_t coordinator_addr_spec;
+
+    /* Skip the Frame length field. */
+    curr_frame_ptr++;
+
+    if (RTB_PROTOCOL_VERSION_01 != *curr_frame_ptr++)
+    {
+        /* The Reflector address cannot be parsed. */
+        return;
+    }
+
+    initiator_addr_spec.AddrMode = mac_parse_data.dest_addr_mode;
+    initiator_addr_spec.PANId = mac_parse_data.dest_panid;
+    /* Long address also covers short address here. */
+    ADDR_COPY_DST_SRC_64(initiator_addr_spec.Addr.long_address,
+                         mac_parse_data.dest_addr.long_address);
+
+    coordinator_addr_spec.AddrMode = mac_parse_data.src_addr_mode;
+    coordinator_addr_spec.PANId = mac_parse_data.src_panid;
+    ADDR_COPY_DST_SRC_64(coordinator_addr_spec.Addr.long_address,
+                         mac_parse_data.src_addr.long_address);
+
+    extract_remote_refl_addr(curr_frame_ptr, &reflector_addr_spec);
+
+    range_remote_busy_store(&initiator_addr_spec,
+                            &reflector_addr_spec,
+                            &coordinator_addr_spec);
+}
+#endif  /* ENABLE_RTB_REMOTE */
+
+
+
+#ifdef ENABLE_RTB_REMOTE
+/*
+ * Extracts the Reflector address spec of a Remote Range Request frame.
+ *
+ * @param curr_frame_ptr Pointer to the Reflector address spec of the frame
+ * @param reflector_addr_spec Extracted Reflector address spec
+ *
+ * @return Length of the Reflector address spec within the frame
+ */
+static uint8_t extract_remote_refl_addr(uint8_t *curr_frame_ptr,
+                                        wpan_addr_spec_t *reflector_addr_spec)
+{
+    refl_addr_t *ra = (refl_addr_t *)curr_frame_ptr;
+
+    reflector_addr_spec->AddrMode = ra->refl_addr_mode;
+    reflector_addr_spec->PANId = ra->refl_pan_id;
+    /* Long address also covers short address here. */
+
+    if (ra->refl_addr_mode == FCF_SHORT_ADDR)
+    {
+        reflector_addr_spec->Addr.long_address = 0;
+        ADDR_COPY_DST_SRC_16(reflector_addr_spec->Addr.short_address,
+                             ra->refl_addr.short_address);
+        return IE_REFLECTOR_ADDR_SPEC_LEN_MIN;
+    }
+
+    ADDR_COPY_DST_SRC_64(reflector_addr_spec->Addr.long_address,
+                         ra->refl_addr.long_address);
+    return IE_REFLECTOR_ADDR_SPEC_LEN_MIN + 6;
+}
 #endif  /* ENABLE_RTB_REMOTE */
 
 #endif /* #ifdef ENABLE_RTB */
@@ -0,0 +1,460 @@
+/**
+ * @file rtb_spectrum.c
+ *
+ * @brief Spectrum monitor and frequency plan of the PMU sweep
+ *
+ * While the RTB and the MAC are idle, the spectrum monitor scans the
+ * blocks of the PMU band of the RTB PIB one after the other by the ED scan
+ * of the TAL and keeps the energy level of each block in an interference
+ * map. A ranging initiated by this node proposes a frequency plan marking
+ * the busy blocks within the Range Request frame; the Reflector adds the
+ * blocks busy at its side and returns the plan within the Range Accept
+ * frame. Both nodes narrow their sweep to the longest run of frequencies
+ * outside the marked blocks, so they sweep the same band.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_SPECTRUM)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "tal_internal.h"
+#include "ieee_const.h"
+#include "mac_build_config.h"
+#include "mac.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+#if (MAC_SCAN_ED_REQUEST_CONFIRM == 0)
+#   error ("MAC_SCAN_ED_REQUEST_CONFIRM must be 1 if ENABLE_RTB_SPECTRUM is defined")
+#endif  /* (MAC_SCAN_ED_REQUEST_CONFIRM == 0) */
+
+/* === Macros ============================================================== */
+
+/** Default energy level of a busy block (about -70 dBm) */
+#define SPECTRUM_DEFAULT_ED_THRESHOLD   (109)
+
+/** Default time between the ED scans of two blocks in ms */
+#define SPECTRUM_DEFAULT_SCAN_INTERVAL  (500)
+
+/** Shortest time between the ED scans of two blocks in ms */
+#define SPECTRUM_MIN_SCAN_INTERVAL      (50)
+
+/** Scan duration of an ED scan, i.e. 2 * aBaseSuperframeDuration symbols */
+#define SPECTRUM_SCAN_DURATION          (0)
+
+/** No ED scan ongoing */
+#define SPECTRUM_NO_BLOCK               (0xFF)
+
+/** Block of the interference map containing a frequency in MHz */
+#define SPECTRUM_BLOCK(freq_mhz)        \
+    ((uint8_t)(((freq_mhz) - PMU_MIN_FREQ) / RTB_SPECTRUM_BLOCK_MHZ))
+
+/** Converts a time in ms into us */
+#define MS_TO_US(ms)                    ((uint32_t)(ms) * 1000UL)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/** Configuration of the spectrum monitor */
+static rtb_spectrum_config_t spectrum_config;
+
+/** Statistics of the spectrum monitor */
+static rtb_spectrum_stats_t spectrum_stats;
+
+/** Energy level of each block, 0 if not scanned yet */
+static uint8_t spectrum_map[RTB_SPECTRUM_NO_OF_BLOCKS];
+
+/** Frequency plan of the ongoing ranging */
+static uint8_t spectrum_plan[RTB_SPECTRUM_PLAN_LEN];
+
+/** Block of the ongoing ED scan or SPECTRUM_NO_BLOCK */
+static uint8_t spectrum_scan_block;
+
+/** Block to be scanned next */
+static uint8_t spectrum_next_block;
+
+/** The scan interval has expired, so the next block is to be scanned. */
+static bool spectrum_scan_due;
+
+/* === Prototypes ========================================================== */
+
+static void spectrum_add_busy_blocks(uint8_t *plan);
+static uint8_t spectrum_narrow_band(const uint8_t *plan);
+static void spectrum_start_scan_timer(void);
+static void spectrum_scan_timer_cb(void *callback_parameter);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the spectrum monitor
+ *
+ * The spectrum monitor is disabled, its interference map and its
+ * statistics are cleared.
+ */
+void range_spectrum_init(void)
+{
+    pal_timer_stop(T_RTB_Spectrum_Scan);
+
+    spectrum_config.Enabled = false;
+    spectrum_config.EDThreshold = SPECTRUM_DEFAULT_ED_THRESHOLD;
+    spectrum_config.ScanInterval = SPECTRUM_DEFAULT_SCAN_INTERVAL;
+    memset(&spectrum_stats, 0, sizeof(spectrum_stats));
+    memset(spectrum_map, 0, sizeof(spectrum_map));
+    memset(spectrum_plan, 0, sizeof(spectrum_plan));
+    spectrum_next_block = 0;
+    spectrum_scan_due = false;
+
+    /* Reset requests are only handled while the MAC is not busy. */
+    spectrum_scan_block = SPECTRUM_NO_BLOCK;
+}
+
+
+
+/**
+ * @brief Starts the ED scan of the next block if it is due
+ *
+ * The ED scan is only started while no ranging or MAC request is ongoing
+ * or pending, otherwise it is tried again on the next call. The MAC is
+ * kept busy during the ED scan, so requests of the application are
+ * deferred until its end.
+ */
+void range_spectrum_task(void)
+{
+    uint8_t first = SPECTRUM_BLOCK(rtb_pib.PMUFreqStart);
+    uint8_t last = SPECTRUM_BLOCK(rtb_pib.PMUFreqStop);
+
+    if (!spectrum_scan_due ||
+        (SPECTRUM_NO_BLOCK != spectrum_scan_block) ||
+        mac_busy ||
+        (nhle_mac_q.size != 0) ||
+        (RTB_IDLE != rtb_state) ||
+        (RTB_ROLE_NONE != rtb_role) ||
+        rtb_tx_in_progress ||
+        (TAL_IDLE != tal_state))
+    {
+        return;
+    }
+
+    spectrum_scan_due = false;
+
+    /* The PMU band of the RTB PIB may have changed since the last scan. */
+    if ((spectrum_next_block < first) || (spectrum_next_block > last))
+    {
+        spectrum_next_block = first;
+    }
+
+    MAKE_MAC_BUSY();
+
+    /* Tune to the center of the block; the ED scan keeps the frequency. */
+    pmu_set_ed_frequency(PMU_MIN_FREQ +
+                         (uint16_t)spectrum_next_block * RTB_SPECTRUM_BLOCK_MHZ +
+                         RTB_SPECTRUM_BLOCK_MHZ / 2);
+
+    if (MAC_SUCCESS == tal_ed_start(SPECTRUM_SCAN_DURATION))
+    {
+        spectrum_scan_block = spectrum_next_block;
+    }
+    else
+    {
+        /* Transceiver is asleep, try again after the scan interval. */
+        pmu_set_ed_frequency(0);
+        MAKE_MAC_NOT_BUSY();
+        spectrum_start_scan_timer();
+    }
+}
+
+
+
+/**
+ * @brief Handles the end of an ED scan
+ *
+ * This function is called by tal_ed_end_cb() of the MAC, which has
+ * already released the MAC.
+ *
+ * @param energy_level Maximum energy of the scanned block
+ *
+ * @return true if the ED scan has been started by the spectrum monitor,
+ *         false if it belongs to a scan of the MAC
+ */
+bool rtb_spectrum_ed_end(uint8_t energy_level)
+{
+    uint8_t block = spectrum_scan_block;
+
+    if (SPECTRUM_NO_BLOCK == block)
+    {
+        return false;
+    }
+
+    spectrum_scan_block = SPECTRUM_NO_BLOCK;
+    pmu_set_ed_frequency(0);
+
+    /*
+     * Interference such as Wi-Fi is bursty, so a higher energy level is
+     * taken at once, while a lower one only halves the distance.
+     */
+    if (energy_level >= spectrum_map[block])
+    {
+        spectrum_map[block] = energy_level;
+    }
+    else
+    {
+        spectrum_map[block] = (uint8_t)(((uint16_t)spectrum_map[block] + energy_level) / 2);
+    }
+    spectrum_stats.NoOfScans++;
+
+    spectrum_next_block = block + 1;
+    spectrum_start_scan_timer();
+
+    return true;
+}
+
+
+
+bool range_spectrum_enabled(void)
+{
+    return spectrum_config.Enabled;
+}
+
+
+
+/**
+ * @brief Adds the frequency plan proposed by the Initiator to a frame
+ *
+ * @param ptr_to_frame Pointer to RTB_SPECTRUM_PLAN_LEN octets of the
+ *                     Range Request frame
+ */
+void range_spectrum_propose_plan(uint8_t *ptr_to_frame)
+{
+    memset(spectrum_plan, 0, sizeof(spectrum_plan));
+    spectrum_add_busy_blocks(spectrum_plan);
+    memcpy(ptr_to_frame, spectrum_plan, sizeof(spectrum_plan));
+}
+
+
+
+/**
+ * @brief Applies the frequency plan proposed by the Initiator (Reflector)
+ *
+ * The blocks busy at the Reflector are added to the plan, which is
+ * returned within the Range Accept frame.
+ *
+ * @param plan Frequency plan of the Range Request frame
+ */
+void range_spectrum_accept_plan(const uint8_t *plan)
+{
+    memcpy(spectrum_plan, plan, sizeof(spectrum_plan));
+    spectrum_add_busy_blocks(spectrum_plan);
+    spectrum_narrow_band(spectrum_plan);
+}
+
+
+
+/**
+ * @brief Adds the frequency plan of the ongoing ranging to a frame
+ *
+ * @param ptr_to_frame Pointer to RTB_SPECTRUM_PLAN_LEN octets of the
+ *                     Range Accept frame
+ */
+void range_spectrum_fill_plan(uint8_t *ptr_to_frame)
+{
+    memcpy(ptr_to_frame, spectrum_plan, sizeof(spectrum_plan));
+}
+
+
+
+/**
+ * @brief Applies the frequency plan returned by the Reflector (Initiator)
+ *
+ * @param plan Frequency plan of the Range Accept frame
+ */
+void range_spectrum_apply_plan(const uint8_t *plan)
+{
+    uint8_t skipped;
+
+    memcpy(spectrum_plan, plan, sizeof(spectrum_plan));
+    skipped = spectrum_narrow_band(spectrum_plan);
+
+    spectrum_stats.NoOfRangings++;
+    if (skipped > 0)
+    {
+        spectrum_stats.NoOfReducedPlans++;
+        spectrum_stats.NoOfSkippedFrequencies += skipped;
+    }
+}
+
+
+
+uint8_t rtb_spectrum_set_config(rtb_spectrum_config_t *config)
+{
+    if (config->ScanInterval < SPECTRUM_MIN_SCAN_INTERVAL)
+    {
+        return (uint8_t)RTB_INVALID_PARAMETER;
+    }
+
+    spectrum_config = *config;
+
+    pal_timer_stop(T_RTB_Spectrum_Scan);
+    spectrum_scan_due = false;
+    if (spectrum_config.Enabled)
+    {
+        /* The first block is scanned right away. */
+        spectrum_scan_due = true;
+    }
+
+    return (uint8_t)RTB_SUCCESS;
+}
+
+
+
+void rtb_spectrum_get_stats(rtb_spectrum_stats_t *stats)
+{
+    *stats = spectrum_stats;
+}
+
+
+
+void rtb_spectrum_get_map(uint8_t *ed_levels)
+{
+    memcpy(ed_levels, spectrum_map, sizeof(spectrum_map));
+}
+
+
+
+/* Helper function marking the blocks above the ED threshold as skipped. */
+static void spectrum_add_busy_blocks(uint8_t *plan)
+{
+    if (!spectrum_config.Enabled)
+    {
+        return;
+    }
+
+    for (uint8_t block = 0; block < RTB_SPECTRUM_NO_OF_BLOCKS; block++)
+    {
+        if (spectrum_map[block] > spectrum_config.EDThreshold)
+        {
+            plan[block / 8] |= (uint8_t)(1 << (block % 8));
+        }
+    }
+}
+
+
+
+/*
+ * Helper function narrowing the PMU sweep of the ongoing ranging to the
+ * longest run of frequencies outside the blocks marked in the plan, with
+ * band edges at full MHz. The PMU library of the XMEGA can only sweep a
+ * contiguous band, so all platforms follow this rule and both nodes derive
+ * the same band from the same plan. If the run leaves fewer than
+ * PMU_PLAN_MIN_STEPS steps, the full band is measured.
+ * Returns the number of frequencies not measured.
+ */
+static uint8_t spectrum_narrow_band(const uint8_t *plan)
+{
+    int16_t f_start = range_param_pmu.f_start;
+    int16_t f_stop = range_param_pmu.f_stop;
+    uint16_t freq = (uint16_t)f_start * 2;
+    uint8_t f_step = range_param_pmu.f_step;
+    uint8_t no_of_freq = (uint8_t)((((uint16_t)(f_stop - f_start) * 2) >> f_step) + 1);
+    /* Frequencies at half a MHz cannot limit the band. */
+    uint8_t align = (PMU_STEP_FREQ_500kHz == f_step) ? 2 : 1;
+    uint8_t run_first = 0;
+    uint8_t best_first = 0;
+    uint8_t best_last = 0;
+    bool in_run = false;
+
+    for (uint8_t i = 0; i < no_of_freq; i++)
+    {
+        uint16_t freq_mhz = (freq + ((uint16_t)i << f_step)) / 2;
+        uint8_t block = SPECTRUM_BLOCK(freq_mhz);
+
+        if (plan[block / 8] & (1 << (block % 8)))
+        {
+            in_run = false;
+            continue;
+        }
+
+        if (!in_run)
+        {
+            /* The run starts at the next frequency at a full MHz. */
+            run_first = (uint8_t)(((i + align - 1) / align) * align);
+            in_run = true;
+        }
+
+        /* The run stops at the last frequency at a full MHz. */
+        if ((i >= run_first) && (0 == ((i - run_first) % align)) &&
+            ((i - run_first) > (best_last - best_first)))
+        {
+            best_first = run_first;
+            best_last = i;
+        }
+    }
+
+    if (((best_last - best_first) < PMU_PLAN_MIN_STEPS) ||
+        ((0 == best_first) && (best_last == (no_of_freq - 1))))
+    {
+        return 0;
+    }
+
+    range_param_pmu.f_start = (int16_t)((freq + ((uint16_t)best_first << f_step)) / 2);
+    range_param_pmu.f_stop = (int16_t)((freq + ((uint16_t)best_last << f_step)) / 2);
+
+    /* Derive the number of frequencies of the narrowed band. */
+    if ((range_param_pmu.f_stop <= (range_param_pmu.f_start + PMU_STEP_FREQ_MAX_IN_MHZ)) ||
+        !pmu_check_pmu_params())
+    {
+        range_param_pmu.f_start = f_start;
+        range_param_pmu.f_stop = f_stop;
+        pmu_check_pmu_params();
+        return 0;
+    }
+
+    return (uint8_t)(no_of_freq - (best_last - best_first + 1));
+}
+
+
+
+/* Helper function starting the timer of the next ED scan. */
+static void spectrum_start_scan_timer(void)
+{
+    if (!spectrum_config.Enabled)
+    {
+        return;
+    }
+
+    pal_timer_start(T_RTB_Spectrum_Scan,
+                    MS_TO_US(spectrum_config.ScanInterval),
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR())spectrum_scan_timer_cb,
+                    NULL);
+}
+
+
+
+/* Timer callback marking the next ED scan as due. */
+static void spectrum_scan_timer_cb(void *callback_parameter)
+{
+    spectrum_scan_due = true;
+
+    /* Keep compiler happy. */
+    callback_parameter = callback_parameter;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_SPECTRUM) */
+
+/* EOF */
@@ -0,0 +1,542 @@
+/**
+ * @file rtb_tdma.c
+ *
+ * @brief Beacon-synchronized TDMA scheduling of rangings
+ *
+ * The Coordinator of a beacon-enabled network assigns ranging slots to
+ * Initiator-Reflector pairs and distributes this TDMA schedule within its
+ * beacon payload. Initiators and Reflectors tracking the beacons take the
+ * schedule from each received beacon:
+ * - A range request of an Initiator is deferred until the start of the slot
+ *   assigned to the Initiator and the requested Reflector.
+ * - All frames of a ranging within its slot are transmitted without CSMA-CA,
+ *   since the slot is reserved for this ranging.
+ * - No frame of a ranging is transmitted within the slot of another node
+ *   pair or within the guard time at the end of a slot; such a ranging is
+ *   stopped, so that a ranging exceeding its slot does not collide with
+ *   the ranging of the next slot.
+ * Range requests without assigned slot are handled as before. A node
+ * tracking the beacons defers its range requests until it has received the
+ * first beacon, since it does not know its slots before.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_TDMA)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "mac_build_config.h"
+#include "mac.h"
+#include "mac_internal.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+/** Index of a ranging slot not assigned to this node */
+#define NO_SLOT                         (0xFF)
+
+/** Converts a time in ms into us */
+#define MS_TO_US(ms)                    ((uint32_t)(ms) * 1000UL)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+/** TDMA schedule taken from the last received beacon */
+static rtb_tdma_schedule_t tdma_schedule;
+
+/** Indicates that tdma_schedule is valid */
+static bool tdma_schedule_valid;
+
+/** Time of the last received beacon (in us) */
+static uint32_t tdma_beacon_time;
+
+/** Indicates that a beacon has been received since the last beacon loss */
+static bool tdma_beacon_received;
+
+/**
+ * Buffer of the range request waiting for its ranging slot.
+ * While the request is passed to the RTB again at the start of the slot,
+ * it still points to this buffer, so that the request is not deferred again.
+ */
+static buffer_t *tdma_deferred_msg = NULL;
+
+/** Indicates that the deferred range request has been passed to the RTB again */
+static bool tdma_deferred_released;
+
+/** Indicates that the slot timer expires at the start of a ranging slot */
+static bool tdma_slot_timer_pending;
+
+/* === Prototypes ========================================================== */
+
+static uint8_t find_slot(uint16_t reflector_addr);
+static uint8_t current_slot(bool *guard);
+static bool own_slot(uint8_t idx);
+static uint32_t beacon_interval_us(void);
+static void schedule_deferred_req(void);
+static void release_deferred_req(void);
+static void reject_range_req(buffer_t *msg);
+static void tdma_slot_timer_cb(void *callback_parameter);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the TDMA scheduling
+ *
+ * A range request waiting for its slot is dropped without confirm.
+ */
+void range_tdma_init(void)
+{
+    if ((NULL != tdma_deferred_msg) && !tdma_deferred_released)
+    {
+        bmm_buffer_free(tdma_deferred_msg);
+    }
+    tdma_deferred_msg = NULL;
+    tdma_deferred_released = false;
+
+    pal_timer_stop(T_RTB_TDMA_Slot);
+    tdma_slot_timer_pending = false;
+    tdma_schedule_valid = false;
+    tdma_beacon_received = false;
+}
+
+
+
+#if (MAC_START_REQUEST_CONFIRM == 1) || defined(DOXYGEN)
+/**
+ * @brief Sets the TDMA schedule distributed within the beacon payload
+ *
+ * @param schedule Pointer to the TDMA schedule
+ *
+ * @return RTB_SUCCESS or RTB_INVALID_PARAMETER
+ */
+uint8_t rtb_tdma_set_schedule(rtb_tdma_schedule_t *schedule)
+{
+    uint8_t payload[RTB_TDMA_SCHEDULE_HDR_LEN +
+                    RTB_TDMA_MAX_SLOTS * RTB_TDMA_SLOT_LEN];
+    uint8_t payload_len = 0;
+
+    if (schedule->NoOfSlots > 0)
+    {
+        uint8_t *ptr = payload;
+
+        if ((NON_BEACON_NWK == tal_pib.BeaconOrder) ||
+            (schedule->NoOfSlots > RTB_TDMA_MAX_SLOTS) ||
+            (MS_TO_US(schedule->SlotDuration) <= RTB_TDMA_GUARD_TIME_US) ||
+            ((MS_TO_US(schedule->SlotStart) +
+              MS_TO_US(schedule->SlotDuration) * schedule->NoOfSlots) >
+             beacon_interval_us()))
+        {
+            return (uint8_t)RTB_INVALID_PARAMETER;
+        }
+
+        *ptr++ = RTB_FRAME_ID_1;
+        *ptr++ = RTB_FRAME_ID_2;
+        *ptr++ = RTB_FRAME_ID_3;
+        *ptr++ = RTB_TDMA_SCHEDULE_ID;
+        *ptr++ = schedule->SlotStart;
+        *ptr++ = schedule->SlotDuration;
+        *ptr++ = schedule->NoOfSlots;
+
+        for (uint8_t i = 0; i < schedule->NoOfSlots; i++)
+        {
+            convert_16_bit_to_byte_array(schedule->Slots[i].InitiatorAddr, ptr);
+            ptr += sizeof(uint16_t);
+            convert_16_bit_to_byte_array(schedule->Slots[i].ReflectorAddr, ptr);
+            ptr += sizeof(uint16_t);
+        }
+
+        payload_len = (uint8_t)(ptr - payload);
+    }
+
+    /* The length needs to be set first, since it limits the payload. */
+    mlme_set(macBeaconPayloadLength, (pib_value_t *)&payload_len, false);
+    mlme_set(macBeaconPayload, (pib_value_t *)payload, false);
+
+    return (uint8_t)RTB_SUCCESS;
+}
+#endif  /* (MAC_START_REQUEST_CONFIRM == 1) */
+
+
+
+/**
+ * @brief Takes the TDMA schedule from a received beacon
+ *
+ * This function is called by the MAC for each beacon received from the
+ * Coordinator this node is tracking. The start of the ranging slots refers
+ * to the reception time of this beacon (macBeaconTxTime).
+ *
+ * @param payload Pointer to the beacon payload
+ * @param payload_len Length of the beacon payload
+ */
+void rtb_tdma_process_beacon(uint8_t *payload, uint8_t payload_len)
+{
+    uint8_t no_of_slots;
+
+    if ((payload_len < RTB_TDMA_SCHEDULE_HDR_LEN) ||
+        (RTB_FRAME_ID_1 != payload[0]) ||
+        (RTB_FRAME_ID_2 != payload[1]) ||
+        (RTB_FRAME_ID_3 != payload[2]) ||
+        (RTB_TDMA_SCHEDULE_ID != payload[3]))
+    {
+        /* The Coordinator does not schedule any ranging (anymore). */
+        tdma_schedule_valid = false;
+    }
+    else
+    {
+        no_of_slots = payload[6];
+        if (no_of_slots > RTB_TDMA_MAX_SLOTS)
+        {
+            no_of_slots = RTB_TDMA_MAX_SLOTS;
+        }
+        if (payload_len < (RTB_TDMA_SCHEDULE_HDR_LEN + no_of_slots * RTB_TDMA_SLOT_LEN))
+        {
+            /* Truncated schedule */
+            no_of_slots = (payload_len - RTB_TDMA_SCHEDULE_HDR_LEN) / RTB_TDMA_SLOT_LEN;
+        }
+
+        tdma_schedule.SlotStart = payload[4];
+        tdma_schedule.SlotDuration = payload[5];
+        tdma_schedule.NoOfSlots = no_of_slots;
+
+        payload += RTB_TDMA_SCHEDULE_HDR_LEN;
+        for (uint8_t i = 0; i < no_of_slots; i++)
+        {
+            tdma_schedule.Slots[i].InitiatorAddr = convert_byte_array_to_16_bit(payload);
+            payload += sizeof(uint16_t);
+            tdma_schedule.Slots[i].ReflectorAddr = convert_byte_array_to_16_bit(payload);
+            payload += sizeof(uint16_t);
+        }
+
+        tdma_beacon_time = TAL_CONVERT_SYMBOLS_TO_US(tal_pib.BeaconTxTime);
+        tdma_schedule_valid = (MS_TO_US(tdma_schedule.SlotDuration) >
+                               RTB_TDMA_GUARD_TIME_US);
+    }
+
+    tdma_beacon_received = true;
+
+    if ((NULL != tdma_deferred_msg) && !tdma_deferred_released &&
+        !tdma_slot_timer_pending)
+    {
+        /* The request waits for this beacon. */
+        schedule_deferred_req();
+    }
+}
+
+
+
+/**
+ * @brief Defers a range request until its ranging slot
+ *
+ * This function is called for each RTB-RANGE.request.
+ *
+ * @param msg Buffer of the RTB-RANGE.request
+ *
+ * @return true if the request has been deferred or rejected,
+ *         false if the request shall be handled now
+ */
+bool range_tdma_defer_range_req(buffer_t *msg)
+{
+    rtb_range_req_t rrr;
+    wpan_rtb_range_req_t *wrrr = &rrr.range_req;
+
+    if (msg == tdma_deferred_msg)
+    {
+        /* The ranging slot of this request has started. */
+        tdma_deferred_msg = NULL;
+        tdma_deferred_released = false;
+        return false;
+    }
+
+    if (!tdma_schedule_valid &&
+        (tdma_beacon_received || (MAC_SYNC_NEVER == mac_sync_state)))
+    {
+        return false;
+    }
+
+    memcpy(&rrr, BMM_BUFFER_POINTER(msg), sizeof(rtb_range_req_t));
+
+#ifdef ENABLE_RTB_REMOTE
+    if (wrrr->CoordinatorAddrMode != FCF_NO_ADDR)
+    {
+        /* Remote rangings are scheduled by the Initiator. */
+        return false;
+    }
+#endif  /* ENABLE_RTB_REMOTE */
+
+    if ((FCF_SHORT_ADDR != wrrr->ReflectorAddrMode) ||
+        (wrrr->ReflectorPANId != tal_pib.PANId) ||
+        (tdma_schedule_valid &&
+         (NO_SLOT == find_slot((uint16_t)wrrr->ReflectorAddr))))
+    {
+        /* No slot assigned, the ranging uses CSMA-CA. */
+        return false;
+    }
+
+    if (NULL != tdma_deferred_msg)
+    {
+        /* Another request is waiting for its slot, reject new request. */
+        reject_range_req(msg);
+        return true;
+    }
+
+    tdma_deferred_msg = msg;
+    tdma_deferred_released = false;
+    schedule_deferred_req();
+
+    return true;
+}
+
+
+
+/**
+ * @brief Checks whether a ranging slot of this node is active
+ *
+ * @return true if this node is Initiator or Reflector of the current slot
+ *         and its guard time has not started yet
+ */
+bool range_tdma_slot_active(void)
+{
+    bool guard;
+    uint8_t idx = current_slot(&guard);
+
+    return ((NO_SLOT != idx) && !guard && own_slot(idx));
+}
+
+
+
+/**
+ * @brief Checks whether this node must not transmit a ranging frame now
+ *
+ * @return true within the ranging slot of another node pair or within the
+ *         guard time at the end of any ranging slot
+ */
+bool range_tdma_slot_blocked(void)
+{
+    bool guard;
+    uint8_t idx = current_slot(&guard);
+
+    return ((NO_SLOT != idx) && (guard || !own_slot(idx)));
+}
+
+
+
+/*
+ * Searches the ranging slot of this node as Initiator and a Reflector.
+ */
+static uint8_t find_slot(uint16_t reflector_addr)
+{
+    if (tdma_schedule_valid)
+    {
+        for (uint8_t i = 0; i < tdma_schedule.NoOfSlots; i++)
+        {
+            if ((tdma_schedule.Slots[i].InitiatorAddr == tal_pib.ShortAddress) &&
+                (tdma_schedule.Slots[i].ReflectorAddr == reflector_addr))
+            {
+                return i;
+            }
+        }
+    }
+
+    return NO_SLOT;
+}
+
+
+
+/*
+ * Searches the ranging slot at the current time.
+ * guard is set if the guard time at the end of this slot has started.
+ */
+static uint8_t current_slot(bool *guard)
+{
+    uint32_t now;
+    uint32_t offset;
+    uint32_t slot_start;
+    uint8_t idx;
+
+    *guard = false;
+
+    if (!tdma_schedule_valid)
+    {
+        return NO_SLOT;
+    }
+
+    pal_get_current_time(&now);
+    slot_start = pal_add_time_us(tdma_beacon_time,
+                                 MS_TO_US(tdma_schedule.SlotStart));
+    offset = pal_sub_time_us(now, slot_start);
+
+    /* Before the first slot the offset wraps around. */
+    if (offset >= (MS_TO_US(tdma_schedule.SlotDuration) * tdma_schedule.NoOfSlots))
+    {
+        return NO_SLOT;
+    }
+
+    idx = (uint8_t)(offset / MS_TO_US(tdma_schedule.SlotDuration));
+    *guard = ((offset - MS_TO_US(tdma_schedule.SlotDuration) * idx) >=
+              (MS_TO_US(tdma_schedule.SlotDuration) - RTB_TDMA_GUARD_TIME_US));
+
+    return idx;
+}
+
+
+
+/* Helper function checking whether this node ranges within a slot. */
+static bool own_slot(uint8_t idx)
+{
+    return ((tdma_schedule.Slots[idx].InitiatorAddr == tal_pib.ShortAddress) ||
+            (tdma_schedule.Slots[idx].ReflectorAddr == tal_pib.ShortAddress));
+}
+
+
+
+/* Helper function returning the beacon interval in us. */
+static uint32_t beacon_interval_us(void)
+{
+    return TAL_CONVERT_SYMBOLS_TO_US(TAL_GET_BEACON_INTERVAL_TIME(tal_pib.BeaconOrder));
+}
+
+
+
+/*
+ * Starts the slot timer for the deferred range request.
+ *
+ * If the slot of the current beacon interval has already started, the
+ * timer supervises the reception of the next beacon instead.
+ */
+static void schedule_deferred_req(void)
+{
+    rtb_range_req_t rrr;
+    uint8_t idx;
+    uint32_t now;
+    uint32_t slot_start;
+    uint32_t timeout;
+
+    pal_timer_stop(T_RTB_TDMA_Slot);
+
+    if (!tdma_beacon_received)
+    {
+        /* Wait for the first beacon, which contains the slots. */
+        tdma_slot_timer_pending = false;
+        pal_timer_start(T_RTB_TDMA_Slot,
+                        beacon_interval_us() * RTB_TDMA_MAX_LOST_BEACONS,
+                        TIMEOUT_RELATIVE,
+                        (FUNC_PTR())tdma_slot_timer_cb,
+                        NULL);
+        return;
+    }
+
+    memcpy(&rrr, BMM_BUFFER_POINTER(tdma_deferred_msg), sizeof(rtb_range_req_t));
+
+    idx = find_slot((uint16_t)rrr.range_req.ReflectorAddr);
+    if (NO_SLOT == idx)
+    {
+        /* The slot has been removed from the schedule. */
+        release_deferred_req();
+        return;
+    }
+
+    pal_get_current_time(&now);
+    slot_start = pal_add_time_us(tdma_beacon_time,
+                                 MS_TO_US(tdma_schedule.SlotStart) +
+                                 MS_TO_US(tdma_schedule.SlotDuration) * idx);
+    timeout = pal_sub_time_us(slot_start, now);
+
+    if ((timeout > 0) && (timeout < beacon_interval_us()))
+    {
+        tdma_slot_timer_pending = true;
+    }
+    else
+    {
+        tdma_slot_timer_pending = false;
+        timeout = beacon_interval_us() * RTB_TDMA_MAX_LOST_BEACONS;
+    }
+
+    if (timeout < MIN_TIMEOUT)
+    {
+        timeout = MIN_TIMEOUT;
+    }
+
+    pal_timer_start(T_RTB_TDMA_Slot,
+                    timeout,
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR())tdma_slot_timer_cb,
+                    NULL);
+}
+
+
+
+/*
+ * Passes the deferred range request to the RTB again.
+ * tdma_deferred_msg is kept to recognize the request.
+ */
+static void release_deferred_req(void)
+{
+    pal_timer_stop(T_RTB_TDMA_Slot);
+    tdma_slot_timer_pending = false;
+    tdma_deferred_released = true;
+
+    qmm_queue_append(&nhle_mac_q, tdma_deferred_msg);
+}
+
+
+
+/*
+ * Rejects a range request while another request waits for its slot.
+ * The buffer of the request is re-used for the confirm.
+ */
+static void reject_range_req(buffer_t *msg)
+{
+    rtb_range_conf_t *rrc = (rtb_range_conf_t *)BMM_BUFFER_POINTER(msg);
+
+    rrc->cmdcode = RTB_RANGE_CONFIRM;
+    rrc->range_conf.ranging_type = RTB_LOCAL_RANGING;
+    rrc->range_conf.results.local.status = (uint8_t)RTB_RANGING_IN_PROGRESS;
+    rrc->range_conf.results.local.distance = INVALID_DISTANCE;
+    rrc->range_conf.results.local.dqf = DQF_ZERO;
+    rrc->range_conf.results.local.no_of_provided_meas_pairs = 0;
+
+    /* Append the RTB range confirmation message to the MAC-NHLE queue */
+    qmm_queue_append(&mac_nhle_q, msg);
+}
+
+
+
+/* Timer callback at the start of the ranging slot or if beacons are lost. */
+static void tdma_slot_timer_cb(void *callback_parameter)
+{
+    if ((NULL != tdma_deferred_msg) && !tdma_deferred_released)
+    {
+        if (!tdma_slot_timer_pending)
+        {
+            /* No beacon received, the ranging uses CSMA-CA. */
+            tdma_schedule_valid = false;
+            tdma_beacon_received = false;
+        }
+
+        release_deferred_req();
+    }
+
+    /* Keep compiler happy. */
+    callback_parameter = callback_parameter;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_TDMA) */
+
+/* EOF */
@@ -0,0 +1,357 @@
+/**
+ * @file rtb_trace.c
+ *
+ * @brief Latency trace of the RTB state machine
+ *
+ * Each transition of the RTB state machine is recorded with its time into
+ * a trace ring. A ranging procedure starts with the first transition out of
+ * RTB_IDLE and ends with the return to RTB_IDLE; then the time spent in
+ * each state is summed up per phase of the ranging procedure and per result
+ * exchange round, kept for the last ranging procedures, and added to a
+ * rolling duration histogram of each phase.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_TRACE)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "rtb.h"
+#include "rtb_msg_types.h"
+#include "rtb_internal.h"
+
+/* === Macros ============================================================== */
+
+/** Phase of the states that do not belong to a ranging procedure */
+#define NO_PHASE                        (0xFF)
+
+/** Number of durations after which a histogram is halved */
+#define HIST_WINDOW                     (256)
+
+/** Durations below 2^HIST_FIRST_SHIFT us are counted in the first bin */
+#define HIST_FIRST_SHIFT                (5)
+
+/* === Types =============================================================== */
+
+/** Recorded state transition */
+typedef struct trace_entry_tag
+{
+    /** Time of the transition (in us) */
+    uint32_t time;
+    /** New state */
+    uint8_t state;
+} trace_entry_t;
+
+/* === Globals ============================================================= */
+
+/** Trace ring of the state transitions */
+static trace_entry_t trace_ring[RTB_TRACE_LEN];
+
+/** Index of the next entry of the trace ring */
+static uint8_t trace_head;
+
+/** Number of transitions of the ongoing ranging procedure */
+static uint16_t trace_count;
+
+/** Last traced state */
+static uint8_t trace_last_state = RTB_IDLE;
+
+/** Role of the node in the ongoing ranging procedure */
+static uint8_t trace_role;
+
+/** Number of the last ranging procedure */
+static uint16_t trace_seq;
+
+/** Completed ranging procedures */
+static rtb_trace_transaction_t trace_trans[RTB_TRACE_MAX_TRANSACTIONS];
+
+/** Index of the next entry of trace_trans */
+static uint8_t trace_trans_head;
+
+/** Number of valid entries of trace_trans */
+static uint8_t trace_trans_count;
+
+/** Rolling duration histograms */
+static uint16_t trace_hist[RTB_TRACE_NO_OF_HISTS][RTB_TRACE_HIST_BINS];
+
+/** Number of durations of each histogram */
+static uint16_t trace_hist_count[RTB_TRACE_NO_OF_HISTS];
+
+/* === Prototypes ========================================================== */
+
+static uint8_t state_phase(uint8_t state);
+static void hist_add(uint8_t hist, uint32_t duration);
+static void trace_complete(void);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Gets the phase of a ranging procedure a state belongs to
+ *
+ * @param state State of the RTB state machine
+ *
+ * @return Phase, NO_PHASE for RTB_IDLE
+ */
+static uint8_t state_phase(uint8_t state)
+{
+    switch (state)
+    {
+        case RTB_INIT_RANGE_REQ_FRAME:
+        case RTB_RANGE_REQ_FRAME_DONE:
+        case RTB_AWAIT_RANGE_ACPT_FRAME:
+        case RTB_INIT_RANGE_ACPT_FRAME:
+        case RTB_RANGE_ACPT_FRAME_DONE:
+            return RTB_TRACE_PHASE_RANGE_REQ;
+
+        case RTB_INIT_TIME_SYNC_REQ_FRAME:
+        case RTB_TIME_SYNC_REQ_FRAME_DONE:
+        case RTB_AWAIT_PMU_START_FRAME:
+        case RTB_AWAIT_TIME_SYNC_REQ_FRAME:
+        case RTB_INIT_PMU_START_FRAME:
+        case RTB_PMU_START_FRAME_DONE:
+        case RTB_INITIALIZE_PMU:
+            return RTB_TRACE_PHASE_TIME_SYNC;
+
+        case RTB_PMU_MEASUREMENT:
+            return RTB_TRACE_PHASE_PMU;
+
+        case RTB_PREPARE_RESULT_EXCHANGE:
+        case RTB_INIT_RESULT_REQ_FRAME:
+        case RTB_RESULT_REQ_FRAME_DONE:
+        case RTB_AWAIT_RESULT_CONF_FRAME:
+        case RTB_AWAIT_RESULT_REQ_FRAME:
+        case RTB_INIT_RESULT_CONF_FRAME:
+        case RTB_RESULT_CONF_FRAME_DONE:
+            return RTB_TRACE_PHASE_RESULT_EXCHANGE;
+
+        case RTB_RESULT_CALC:
+            return RTB_TRACE_PHASE_CALC;
+
+#ifdef ENABLE_RTB_REMOTE
+        case RTB_INIT_REMOTE_RANGE_CONF_FRAME:
+        case RTB_REMOTE_RANGE_CONF_FRAME_DONE:
+        case RTB_REMOTE_RANGE_REQ_FRAME_DONE:
+            return RTB_TRACE_PHASE_REMOTE;
+#endif  /* ENABLE_RTB_REMOTE */
+
+        default:
+            return NO_PHASE;
+    }
+}
+
+
+
+/**
+ * @brief Adds a duration to a histogram
+ *
+ * @param hist Index of the histogram
+ * @param duration Duration in us
+ */
+static void hist_add(uint8_t hist, uint32_t duration)
+{
+    uint8_t bin = 0;
+
+    duration >>= HIST_FIRST_SHIFT;
+    while ((duration > 0) && (bin < (RTB_TRACE_HIST_BINS - 1)))
+    {
+        duration >>= 1;
+        bin++;
+    }
+
+    if (trace_hist_count[hist] >= HIST_WINDOW)
+    {
+        /* Age the histogram, so it follows recent ranging procedures. */
+        trace_hist_count[hist] = 0;
+        for (uint8_t i = 0; i < RTB_TRACE_HIST_BINS; i++)
+        {
+            trace_hist[hist][i] >>= 1;
+            trace_hist_count[hist] += trace_hist[hist][i];
+        }
+    }
+
+    trace_hist[hist][bin]++;
+    trace_hist_count[hist]++;
+}
+
+
+
+/**
+ * @brief Derives the phase durations of the finished ranging procedure
+ *
+ * The last entry of the trace ring is the return to RTB_IDLE.
+ */
+static void trace_complete(void)
+{
+    rtb_trace_transaction_t *trans = &trace_trans[trace_trans_head];
+    uint8_t entries = RTB_TRACE_LEN;
+    uint8_t idx;
+    bool in_round = false;
+
+    memset(trans, 0, sizeof(rtb_trace_transaction_t));
+    trans->Seq = ++trace_seq;
+    trans->Role = trace_role;
+    trans->Status = (uint8_t)range_status.range_error;
+    trans->Complete = (trace_count <= RTB_TRACE_LEN);
+    if (trans->Complete)
+    {
+        entries = (uint8_t)trace_count;
+    }
+
+    idx = (uint8_t)((trace_head + RTB_TRACE_LEN - entries) % RTB_TRACE_LEN);
+
+    for (uint8_t i = 1; i < entries; i++)
+    {
+        trace_entry_t *entry = &trace_ring[idx];
+        uint8_t next_idx = (uint8_t)((idx + 1) % RTB_TRACE_LEN);
+        uint32_t duration = trace_ring[next_idx].time - entry->time;
+        uint8_t phase = state_phase(entry->state);
+
+        /*
+         * A round starts with each Result Request frame of the Initiator,
+         * or with each Result Request frame answered by the Reflector;
+         * further Result Confirm frames pushed by the Reflector belong
+         * to the same round.
+         */
+        if ((RTB_INIT_RESULT_REQ_FRAME == entry->state) ||
+            ((RTB_INIT_RESULT_CONF_FRAME == entry->state) &&
+             (RTB_AWAIT_RESULT_REQ_FRAME == trace_ring[(idx + RTB_TRACE_LEN - 1) %
+                                                       RTB_TRACE_LEN].state)))
+        {
+            in_round = true;
+            trans->NoOfRounds++;
+        }
+        else if (RTB_TRACE_PHASE_RESULT_EXCHANGE != phase)
+        {
+            in_round = false;
+        }
+
+        if (NO_PHASE != phase)
+        {
+            trans->PhaseDuration[phase] += duration;
+        }
+        if (in_round && (trans->NoOfRounds <= RTB_TRACE_MAX_ROUNDS))
+        {
+            trans->RoundDuration[trans->NoOfRounds - 1] += duration;
+        }
+
+        idx = next_idx;
+    }
+
+    for (uint8_t phase = 0; phase < RTB_TRACE_NO_OF_PHASES; phase++)
+    {
+        if (trans->PhaseDuration[phase] > 0)
+        {
+            hist_add(phase, trans->PhaseDuration[phase]);
+        }
+    }
+    for (uint8_t i = 0; (i < trans->NoOfRounds) && (i < RTB_TRACE_MAX_ROUNDS); i++)
+    {
+        hist_add(RTB_TRACE_HIST_ROUND, trans->RoundDuration[i]);
+    }
+
+    trace_trans_head = (trace_trans_head + 1) % RTB_TRACE_MAX_TRANSACTIONS;
+    if (trace_trans_count < RTB_TRACE_MAX_TRANSACTIONS)
+    {
+        trace_trans_count++;
+    }
+}
+
+
+
+/**
+ * @brief Records a transition of the RTB state machine
+ *
+ * This function is called by RTB_SET_STATE() and RTB_TRACE_STEP().
+ *
+ * @param state New state
+ */
+void range_trace_state(rtb_state_t state)
+{
+    trace_entry_t *entry;
+
+    if ((uint8_t)state == trace_last_state)
+    {
+        return;
+    }
+
+    if (RTB_IDLE == trace_last_state)
+    {
+        /* A new ranging procedure starts. */
+        trace_count = 0;
+        trace_role = RTB_ROLE_NONE;
+    }
+
+    entry = &trace_ring[trace_head];
+    pal_get_current_time(&entry->time);
+    entry->state = (uint8_t)state;
+    trace_head = (trace_head + 1) % RTB_TRACE_LEN;
+    if (trace_count < UINT16_MAX)
+    {
+        trace_count++;
+    }
+    trace_last_state = (uint8_t)state;
+
+    if (RTB_ROLE_NONE != rtb_role)
+    {
+        trace_role = (uint8_t)rtb_role;
+    }
+
+    if (RTB_IDLE == state)
+    {
+        trace_complete();
+    }
+}
+
+
+
+uint8_t rtb_trace_get_transactions(rtb_trace_transaction_t *trans,
+                                   uint8_t max_trans)
+{
+    uint8_t count = trace_trans_count;
+    uint8_t idx;
+
+    if (count > max_trans)
+    {
+        count = max_trans;
+    }
+
+    idx = (uint8_t)((trace_trans_head + RTB_TRACE_MAX_TRANSACTIONS - count) %
+                    RTB_TRACE_MAX_TRANSACTIONS);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        trans[i] = trace_trans[idx];
+        idx = (idx + 1) % RTB_TRACE_MAX_TRANSACTIONS;
+    }
+
+    return count;
+}
+
+
+
+void rtb_trace_get_histogram(uint8_t hist, uint16_t *bins)
+{
+    if (hist >= RTB_TRACE_NO_OF_HISTS)
+    {
+        memset(bins, 0, RTB_TRACE_HIST_BINS * sizeof(uint16_t));
+        return;
+    }
+
+    memcpy(bins, trace_hist[hist], RTB_TRACE_HIST_BINS * sizeof(uint16_t));
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_TRACE) */
+
+/* EOF */
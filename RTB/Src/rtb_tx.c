@@ -51,6 +51,8 @@ static void build_result_conf_frame(uint8_t *curr_frame_ptr,
 static void build_result_req_frame(uint8_t *curr_frame_ptr);
 static void build_range_acpt_frame(uint8_t *curr_frame_ptr);
 static void build_range_req_frame(uint8_t *curr_frame_ptr);
+static void tx_frame_not_started(uint8_t status,
+                                 conf_on_error_t generate_range_conf_on_error);
 
 /* === Implementation ====================================================== */
 
@@ -175,32 +177,28 @@ void range_assemble_and_tx_frame_csma(frame_msgtype_t msgtype,
                                       conf_on_error_t generate_range_conf_on_error)
 {
     retval_t status = FAILURE;
-
-    buffer_t *buf_ptr = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    buffer_t *buf_ptr;
     frame_info_t *transmit_frame;
 
-    if (NULL == buf_ptr)
+#ifdef ENABLE_RTB_TDMA
+    if (range_tdma_slot_blocked())
     {
-        if (LOCAL_CONF == generate_range_conf_on_error)
-        {
-            /* Return range request. */
-            range_gen_rtb_range_conf((uint8_t)RTB_OUT_OF_BUFFERS,
-                                     INVALID_DISTANCE, DQF_ZERO);
-        }
-#ifdef ENABLE_RTB_REMOTE
-        else if (REMOTE_CONF == generate_range_conf_on_error)
-        {
-            /* Return range request. */
-            range_gen_rtb_remote_range_conf((uint8_t)RTB_OUT_OF_BUFFERS,
-                                            INVALID_DISTANCE,
-                                            DQF_ZERO,
-                                            0,
-                                            NULL);
-        }
-#endif  /* ENABLE_RTB_REMOTE */
+        /*
+         * The slot of this ranging is over or belongs to another node pair,
+         * so the ranging is stopped instead of disturbing that slot.
+         */
+        tx_frame_not_started((uint8_t)RTB_TDMA_SLOT_END,
+                             generate_range_conf_on_error);
+        return;
+    }
+#endif  /* ENABLE_RTB_TDMA */
 
-        /* Clean-up RTB */
-        range_exit();
+    buf_ptr = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+
+    if (NULL == buf_ptr)
+    {
+        tx_frame_not_started((uint8_t)RTB_OUT_OF_BUFFERS,
+                             generate_range_conf_on_error);
         return;
     }
 
@@ -216,12 +214,20 @@ void range_assemble_and_tx_frame_csma(frame_msgtype_t msgtype,
     transmit_frame->buffer_header = buf_ptr;
 
     /* Update RTB state */
-    rtb_state = next_rtb_state;
+    RTB_SET_STATE(next_rtb_state);
 
     /* Transmission should be done with CSMA-CA and with frame retries. */
 #ifdef BEACON_SUPPORT
     csma_mode_t cur_csma_mode;
 
+#ifdef ENABLE_RTB_TDMA
+    if (range_tdma_slot_active())
+    {
+        /* The ranging slot is reserved for this ranging, so no CSMA-CA. */
+        cur_csma_mode = NO_CSMA_WITH_IFS;
+    }
+    else
+#endif  /* ENABLE_RTB_TDMA */
     if (NON_BEACON_NWK == tal_pib.BeaconOrder)
     {
         /* In Nonbeacon network the frame is sent with unslotted CSMA-CA. */
@@ -283,6 +289,38 @@ void range_assemble_and_tx_frame_csma(frame_msgtype_t msgtype,
 
 
 
+/*
+ * Helper function ending the ranging if a frame cannot be transmitted.
+ *
+ * status Status of the range confirm
+ * generate_range_conf_on_error Type of the range confirm
+ */
+static void tx_frame_not_started(uint8_t status,
+                                 conf_on_error_t generate_range_conf_on_error)
+{
+    if (LOCAL_CONF == generate_range_conf_on_error)
+    {
+        /* Return range request. */
+        range_gen_rtb_range_conf(status, INVALID_DISTANCE, DQF_ZERO);
+    }
+#ifdef ENABLE_RTB_REMOTE
+    else if (REMOTE_CONF == generate_range_conf_on_error)
+    {
+        /* Return range request. */
+        range_gen_rtb_remote_range_conf(status,
+                                        INVALID_DISTANCE,
+                                        DQF_ZERO,
+                                        0,
+                                        NULL);
+    }
+#endif  /* ENABLE_RTB_REMOTE */
+
+    /* Clean-up RTB */
+    range_exit();
+}
+
+
+
 /*
  * @brief Process rtb_tx_frame_done_cb status
  *
@@ -313,7 +351,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                 {
                     configure_ranging();
 
-                    rtb_state = RTB_AWAIT_RANGE_ACPT_FRAME;
+                    RTB_SET_STATE(RTB_AWAIT_RANGE_ACPT_FRAME);
 
                     /* Start timer in case Range Accept frame is not received. */
                     range_start_await_timer(RTB_AWAIT_RANGE_ACPT_FRAME);
@@ -335,7 +373,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                 }
                 else
                 {
-                    rtb_state = RTB_AWAIT_TIME_SYNC_REQ_FRAME;
+                    RTB_SET_STATE(RTB_AWAIT_TIME_SYNC_REQ_FRAME);
 
                     /* Start timer in case Time Sync Request frame is not received. */
                     range_start_await_timer(RTB_AWAIT_TIME_SYNC_REQ_FRAME);
@@ -353,7 +391,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                 }
                 else
                 {
-                    rtb_state = RTB_AWAIT_PMU_START_FRAME;
+                    RTB_SET_STATE(RTB_AWAIT_PMU_START_FRAME);
 
                     /*
                      * Start timer in case the PMU Start frame is not received.
@@ -368,6 +406,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                     range_start_await_timer(RTB_AWAIT_PMU_START_FRAME);
 
                     /* Now the PMU Start frame is expected and handled. */
+                    RTB_TRACE_STEP(RTB_PMU_MEASUREMENT);
                     pmu_perform_pmu_measurement();			
                 }
             }
@@ -383,7 +422,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                 }
                 else
                 {
-                    rtb_state = RTB_AWAIT_RESULT_CONF_FRAME;
+                    RTB_SET_STATE(RTB_AWAIT_RESULT_CONF_FRAME);
 
                     /* Start timer in case Result Confirm frame is not received. */
                     range_start_await_timer(RTB_AWAIT_RESULT_CONF_FRAME);
@@ -395,6 +434,35 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
             {
                 ASSERT(rtb_state == RTB_RESULT_CONF_FRAME_DONE);
 
+#ifdef ENABLE_RTB_PUSH_RESULTS
+                if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+                {
+                    /*
+                     * A lost frame does not stop the burst,
+                     * the Initiator requests missing values afterwards.
+                     */
+                    if (pmu_push_more_in_window(MAC_SUCCESS == tx_status))
+                    {
+                        RTB_SET_STATE(RTB_INIT_RESULT_CONF_FRAME);
+                    }
+                    else if (pmu_push_all_acked())
+                    {
+                        /* Clean-up RTB */
+                        range_exit();
+                    }
+                    else
+                    {
+                        RTB_SET_STATE(RTB_AWAIT_RESULT_REQ_FRAME);
+
+                        /*
+                         * Start timer in case no Result Request frame
+                         * for the missing values is received.
+                         */
+                        range_start_await_timer(RTB_AWAIT_RESULT_REQ_FRAME);
+                    }
+                }
+                else
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
                 if ((MAC_NO_ACK == tx_status) || (MAC_CHANNEL_ACCESS_FAILURE == tx_status))
                 {
                     /* Clean-up RTB */
@@ -419,7 +487,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                              * Continue with next result values for
                              * next antenna combination.
                              */
-                            rtb_state = RTB_AWAIT_RESULT_REQ_FRAME;
+                            RTB_SET_STATE(RTB_AWAIT_RESULT_REQ_FRAME);
                             pmu_reset_pmu_result_vars();
                             /*
                              * Start timer in case the next Result Confirm frame
@@ -435,7 +503,7 @@ void range_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
                     }
                     else
                     {
-                        rtb_state = RTB_AWAIT_RESULT_REQ_FRAME;
+                        RTB_SET_STATE(RTB_AWAIT_RESULT_REQ_FRAME);
 
                         /*
                          * Start timer in case the next Result Confirm frame
@@ -524,6 +592,12 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                                 (uint8_t *)frame +
                                 LARGE_BUFFER_SIZE -
                                 CMD_RANGE_REQ_LEN
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+                                - IE_COMPR_WIDTH_LEN
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+#ifdef ENABLE_RTB_SPECTRUM
+                                - IE_FREQ_PLAN_LEN
+#endif  /* ENABLE_RTB_SPECTRUM */
                                 - 2;    /* Add 2 octets for FCS. */
 
                 build_range_req_frame(frame_ptr);
@@ -538,12 +612,28 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                             2 + // 2 octets for destination PAN-Id
                             3;  // 3 octets DSN and FCF
 
-                if (rtb_pib.ProvideRangingTransmitPower)
+                if (RANGE_PROFILE(ProvideRangingTransmitPower))
                 {
                     /* Add octets for the Requested Ranging Transmit Power. */
                     frame_len += IE_REQ_RANGING_TX_POWER_LEN;
                 }
 
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+                if (range_param.compr_min_width < RTB_COMPR_RESULTS_FULL_WIDTH)
+                {
+                    /* Add octets for the accepted Compression Width. */
+                    frame_len += IE_COMPR_WIDTH_LEN;
+                }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+#ifdef ENABLE_RTB_SPECTRUM
+                if (range_param.caps & PMU_CAP_INITIATOR_SPECTRUM)
+                {
+                    /* Add octets for the proposed Frequency Plan. */
+                    frame_len += IE_FREQ_PLAN_LEN;
+                }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
                 /* Update the FCF. */
                 fcf = FCF_ACK_REQUEST;
 
@@ -560,6 +650,9 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                                 (uint8_t *)frame +
                                 LARGE_BUFFER_SIZE -
                                 CMD_RANGE_ACPT_LEN
+#ifdef ENABLE_RTB_SPECTRUM
+                                - IE_FREQ_PLAN_LEN
+#endif  /* ENABLE_RTB_SPECTRUM */
                                 - 2;    /* Add 2 octets for FCS. */
 
                 build_range_acpt_frame(frame_ptr);
@@ -574,6 +667,15 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                             2 + // 2 octets for destination PAN-Id
                             3;  // 3 octets DSN and FCF
 
+#ifdef ENABLE_RTB_SPECTRUM
+                if ((RANGE_OK == range_status.range_error) &&
+                    (range_param.caps & PMU_CAP_REFLECTOR_SPECTRUM))
+                {
+                    /* Add octets for the agreed Frequency Plan. */
+                    frame_len += IE_FREQ_PLAN_LEN;
+                }
+#endif  /* ENABLE_RTB_SPECTRUM */
+
                 /* Update the FCF. */
                 fcf = FCF_ACK_REQUEST;
 
@@ -600,7 +702,7 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                             2 + // 2 octets for destination PAN-Id
                             3;  // 3 octets DSN and FCF
 
-                if (rtb_pib.ProvideRangingTransmitPower)
+                if (RANGE_PROFILE(ProvideRangingTransmitPower))
                 {
                     /* Add octets for the Requested Ranging Transmit Power. */
                     frame_len += IE_REQ_RANGING_TX_POWER_LEN;
@@ -738,14 +840,23 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
 
         case CMD_RESULT_REQ:
             {
+                uint8_t result_req_len = CMD_RESULT_REQ_LEN;
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+                if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+                {
+                    result_req_len = CMD_RESULT_REQ_PUSH_LEN;
+                }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
                 frame_ptr = temp_frame_ptr =
                                 (uint8_t *)frame +
                                 LARGE_BUFFER_SIZE -
-                                CMD_RESULT_REQ_LEN
+                                result_req_len
                                 - 2;    /* Add 2 octets for FCS. */
 
                 /* Update the length. */
-                frame_len = CMD_RESULT_REQ_LEN +
+                frame_len = result_req_len +
                             2 + // 2 octets for FCS
                             2 + // 2 octets for short source address
                             2 + // 2 octets for short destination address
@@ -769,24 +880,39 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
         case CMD_RESULT_CONF:
             {
                 uint16_t result_values_to_be_sent;
+                uint16_t result_data_len;
+                uint8_t result_conf_len = CMD_RESULT_CONF_LEN;
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+                if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+                {
+                    result_conf_len = CMD_RESULT_CONF_PUSH_LEN;
+                }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
 
                 frame_ptr =
                     (uint8_t *)frame +
                     LARGE_BUFFER_SIZE -
-                    CMD_RESULT_CONF_LEN
+                    result_conf_len
                     - 2;    /* Add 2 octets for FCS. */
 
                 result_values_to_be_sent = pmu_get_no_of_results_to_be_sent();
+#if defined(ENABLE_RTB_COMPRESSED_RESULTS) || defined(ENABLE_RTB_PUSH_RESULTS)
+                result_data_len =
+                    pmu_get_result_data_len(&result_values_to_be_sent);
+#else
                 if (result_values_to_be_sent > MAX_RESULT_VALUES_PER_FRAME)
                 {
                     result_values_to_be_sent = MAX_RESULT_VALUES_PER_FRAME;
                 }
+                result_data_len = result_values_to_be_sent;
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS || ENABLE_RTB_PUSH_RESULTS */
 
                 /*
-                 * Adjust frame pointer with number of result values
+                 * Adjust frame pointer with length of result values
                  * to be sent.
                  */
-                frame_ptr -= result_values_to_be_sent;
+                frame_ptr -= result_data_len;
                 temp_frame_ptr = frame_ptr;
 
                 build_result_conf_frame(frame_ptr, result_values_to_be_sent);
@@ -794,8 +920,8 @@ void range_build_frame(range_cmd_t cmd, frame_info_t *frame)
                 frame_ptr = temp_frame_ptr;
 
                 /* Update the length. */
-                frame_len = CMD_RESULT_CONF_LEN +
-                            result_values_to_be_sent +   // Number of result values to be sent
+                frame_len = result_conf_len +
+                            result_data_len +   // Length of result values to be sent
                             2 + // 2 octets for FCS
                             2 + // 2 octets for short source address
                             2 + // 2 octets for short destination address
@@ -991,7 +1117,7 @@ static uint8_t build_remote_range_conf_frame(uint8_t *curr_frame_ptr,
         for (uint8_t i = 0; i < range_param_pmu.antenna_measurement_nos; i++)
         {
             memcpy(curr_frame_ptr,
-                   &range_status_pmu.measured_distance_cm[i],
+                   (uint32_t *)&range_status_pmu.measured_distance_cm[i],
                    sizeof(uint32_t));
             curr_frame_ptr += sizeof(uint32_t);
             *curr_frame_ptr++ = range_status_pmu.measured_dqf[i];
@@ -1053,12 +1179,12 @@ static void build_remote_range_req_frame(uint8_t *curr_frame_ptr)
     range_param.method = rtb_pib.RangingMethod;
 
     /* Set Requested Ranging Transmit Power. */
-    range_param.req_tx_power = rtb_pib.RangingTransmitPower;
+    range_param.req_tx_power = RANGE_PROFILE(RangingTransmitPower);
 
     /* Set PMU specific parameter for current ranging procedure. */
-    range_param_pmu.f_start = rtb_pib.PMUFreqStart;
-    range_param_pmu.f_step = rtb_pib.PMUFreqStep;
-    range_param_pmu.f_stop = rtb_pib.PMUFreqStop;
+    range_param_pmu.f_start = RANGE_PROFILE(PMUFreqStart);
+    range_param_pmu.f_step = RANGE_PROFILE(PMUFreqStep);
+    range_param_pmu.f_stop = RANGE_PROFILE(PMUFreqStop);
     range_param_pmu.apply_min_dist_threshold = rtb_pib.ApplyMinDistThreshold;
     /*
      * The remote capabilities at the Coordinator are set here.
@@ -1068,7 +1194,7 @@ static void build_remote_range_req_frame(uint8_t *curr_frame_ptr)
      */
     range_param.remote_caps = 0;
 
-    if (rtb_pib.ProvideAntennaDivResults)
+    if (RANGE_PROFILE(ProvideAntennaDivResults))
     {
         range_param.remote_caps |= PMU_REM_CAP_PROV_ANT_DIV_RES;
     }
@@ -1090,7 +1216,7 @@ static void build_remote_range_req_frame(uint8_t *curr_frame_ptr)
     /* Local caps are not used within Remote Range request. */
     *curr_frame_ptr++ = range_param.remote_caps;
 
-    if (rtb_pib.ProvideRangingTransmitPower)
+    if (RANGE_PROFILE(ProvideRangingTransmitPower))
     {
         /* Add octets for the Requested Ranging Transmit Power. */
         *curr_frame_ptr++ = REQ_RANGING_TX_POWER_IE;
@@ -1123,6 +1249,15 @@ static void build_result_conf_frame(uint8_t *curr_frame_ptr,
     *curr_frame_ptr++ = values_to_be_sent;
     *curr_frame_ptr++ = (values_to_be_sent >> 8);
 
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+    {
+        /* Send start index, since pushed frames may get lost. */
+        pmu_push_fill_start_addr(curr_frame_ptr);
+        curr_frame_ptr += 2;
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
     /*
      * Include correct data depending on the type of result data
      * to be sent.
@@ -1142,6 +1277,14 @@ static void build_result_req_frame(uint8_t *curr_frame_ptr)
     /* Request measured PMU values. */
     *curr_frame_ptr++ = req_result_type;
 
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+    {
+        /* Request the first run of missing values as one burst. */
+        pmu_push_select_window();
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
+
     /*
      * Set requested antenna combination,
      * i.e. 0, 1, 2, 3, depending on used
@@ -1151,6 +1294,14 @@ static void build_result_req_frame(uint8_t *curr_frame_ptr)
 
     /* Send initial start address for result exchange. */
     pmu_fill_initial_start_addr(curr_frame_ptr);
+
+#ifdef ENABLE_RTB_PUSH_RESULTS
+    if (range_param.caps & PMU_CAP_REFLECTOR_PUSH)
+    {
+        /* Send number of values to be pushed. */
+        pmu_push_fill_window(curr_frame_ptr + 2);
+    }
+#endif  /* ENABLE_RTB_PUSH_RESULTS */
 }
 
 
@@ -1181,6 +1332,15 @@ static void build_range_acpt_frame(uint8_t *curr_frame_ptr)
          * procedure.
          */
         *curr_frame_ptr++ = range_param.caps;
+
+#ifdef ENABLE_RTB_SPECTRUM
+        if (range_param.caps & PMU_CAP_REFLECTOR_SPECTRUM)
+        {
+            /* Return the Frequency Plan agreed by both nodes. */
+            *curr_frame_ptr++ = FREQ_PLAN_IE;
+            range_spectrum_fill_plan(curr_frame_ptr);
+        }
+#endif  /* ENABLE_RTB_SPECTRUM */
     }
     else
     {
@@ -1236,12 +1396,12 @@ static void build_range_req_frame(uint8_t *curr_frame_ptr)
 #endif  /* #ifdef RTB_WITHOUT_MAC */
 
         /* Set Requested Ranging Transmit Power. */
-        range_param.req_tx_power = rtb_pib.RangingTransmitPower;
+        range_param.req_tx_power = RANGE_PROFILE(RangingTransmitPower);
 
         /* Set PMU specific parameter for current ranging procedure. */
-        range_param_pmu.f_start = rtb_pib.PMUFreqStart;
-        range_param_pmu.f_step = rtb_pib.PMUFreqStep;
-        range_param_pmu.f_stop = rtb_pib.PMUFreqStop;
+        range_param_pmu.f_start = RANGE_PROFILE(PMUFreqStart);
+        range_param_pmu.f_step = RANGE_PROFILE(PMUFreqStep);
+        range_param_pmu.f_stop = RANGE_PROFILE(PMUFreqStop);
         range_param_pmu.apply_min_dist_threshold =
             rtb_pib.ApplyMinDistThreshold;
         SET_INITIATOR_CAPS(range_param.caps);
@@ -1264,7 +1424,7 @@ static void build_range_req_frame(uint8_t *curr_frame_ptr)
 
     *curr_frame_ptr++ = range_param.caps;
 
-    if (rtb_pib.ProvideRangingTransmitPower)
+    if (RANGE_PROFILE(ProvideRangingTransmitPower))
     {
         /* Add octets for the Requested Ranging Transmit Power. */
         *curr_frame_ptr++ = REQ_RANGING_TX_POWER_IE;
@@ -1272,6 +1432,34 @@ static void build_range_req_frame(uint8_t *curr_frame_ptr)
         /* Update Lenght of Range Request Frame octet. */
         *ptr_to_len_field += IE_REQ_RANGING_TX_POWER_LEN;
     }
+
+#ifdef ENABLE_RTB_COMPRESSED_RESULTS
+    /*
+     * Compressed PMU values stay lossless unless the Initiator explicitly
+     * accepts truncated ones.
+     */
+    range_param.compr_min_width = RTB_COMPR_RESULTS_FULL_WIDTH;
+    if ((range_param.caps & PMU_CAP_INITIATOR_COMPR) &&
+        (RTB_COMPR_RESULTS_MIN_WIDTH < RTB_COMPR_RESULTS_FULL_WIDTH))
+    {
+        range_param.compr_min_width = RTB_COMPR_RESULTS_MIN_WIDTH;
+        *curr_frame_ptr++ = COMPR_WIDTH_IE;
+        *curr_frame_ptr++ = range_param.compr_min_width;
+        /* Update Lenght of Range Request Frame octet. */
+        *ptr_to_len_field += IE_COMPR_WIDTH_LEN;
+    }
+#endif  /* ENABLE_RTB_COMPRESSED_RESULTS */
+
+#ifdef ENABLE_RTB_SPECTRUM
+    if (range_param.caps & PMU_CAP_INITIATOR_SPECTRUM)
+    {
+        /* Propose the Frequency Plan of the Initiator. */
+        *curr_frame_ptr++ = FREQ_PLAN_IE;
+        range_spectrum_propose_plan(curr_frame_ptr);
+        /* Update Lenght of Range Request Frame octet. */
+        *ptr_to_len_field += IE_FREQ_PLAN_LEN;
+    }
+#endif  /* ENABLE_RTB_SPECTRUM */
 }
 
 #endif /* #ifdef ENABLE_RTB */
@@ -0,0 +1,44 @@
+/**
+ * @file usr_rtb_range_batch_conf.c
+ *
+ * @brief This file contains user call back function for RTB-RANGE-BATCH.confirm.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_BATCH)
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtb_api.h"
+
+/* === Macros ============================================================== */
+
+
+/* === Globals ============================================================= */
+
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+void usr_rtb_range_batch_conf(usr_rtb_range_batch_conf_t *urrbc)
+{
+    /* Keep compiler happy. */
+    urrbc = urrbc;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_BATCH) */
+
+/* EOF */
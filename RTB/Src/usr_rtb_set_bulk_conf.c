@@ -0,0 +1,44 @@
+/**
+ * @file usr_rtb_set_bulk_conf.c
+ *
+ * @brief This file contains user call back function for RTB-SET-BULK.confirm.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RTB) && defined(ENABLE_RTB_BULK_PIB)
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtb_api.h"
+
+/* === Macros ============================================================== */
+
+
+/* === Globals ============================================================= */
+
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+void usr_rtb_set_bulk_conf(usr_rtb_set_bulk_conf_t *ursbc)
+{
+    /* Keep compiler happy. */
+    ursbc = ursbc;
+}
+
+#endif  /* #if defined(ENABLE_RTB) && defined(ENABLE_RTB_BULK_PIB) */
+
+/* EOF */
@@ -30,6 +30,34 @@
  */
 #define BMM_BUFFER_POINTER(buf) ((buf)->body)
 
+/**
+ * Size to be allocated for a message that is never turned into a frame.
+ * With ENABLE_BMM_MSG_BUFS such messages are placed into the small buffers,
+ * which are sized for them (see stack_config.h); bmm_buffer_alloc falls
+ * back to a large buffer if no small buffer is available.
+ */
+#ifdef ENABLE_BMM_MSG_BUFS
+#define BMM_MSG_SIZE(msg_size)  ((uint8_t)(msg_size))
+#else
+#define BMM_MSG_SIZE(msg_size)  (LARGE_BUFFER_SIZE)
+#endif  /* ENABLE_BMM_MSG_BUFS */
+
+#if defined(ENABLE_BMM_STATS) || defined(DOXYGEN)
+/** Size classes of the buffer pool */
+#define BMM_CLASS_LARGE         (0)
+#define BMM_CLASS_SMALL         (1)
+#define BMM_NO_OF_CLASSES       (2)
+
+/**
+ * Owner of the buffers allocated by a source file. The internal header
+ * files of the layers redefine it, so buffers are accounted to the
+ * allocating layer.
+ */
+#ifndef BMM_OWNER
+#define BMM_OWNER               (BMM_OWNER_APP)
+#endif
+#endif  /* ENABLE_BMM_STATS */
+
 /* === Types =============================================================== */
 
 /**
@@ -48,6 +76,48 @@ typedef struct
     struct buffer_tag *next;
 } buffer_t;
 
+#if defined(ENABLE_BMM_STATS) || defined(DOXYGEN)
+/**
+ * @brief Owners of buffers, i.e. the layer allocating a buffer
+ *
+ * @ingroup apiMacTypes
+ */
+typedef enum bmm_owner_tag
+{
+    /** Application, including the requests of the MAC and RTB API */
+    BMM_OWNER_APP,
+    /** TAL, receive buffers */
+    BMM_OWNER_TAL,
+    /** MAC */
+    BMM_OWNER_MAC,
+    /** RTB */
+    BMM_OWNER_RTB,
+    BMM_NO_OF_OWNERS
+} bmm_owner_t;
+
+/**
+ * @brief Statistics of the buffer pool
+ *
+ * @ingroup apiMacTypes
+ */
+typedef struct
+#if !defined(DOXYGEN)
+        bmm_stats_tag
+#endif
+{
+    /** Currently free buffers per size class */
+    uint8_t free[BMM_NO_OF_CLASSES];
+    /** Minimum of free buffers per size class */
+    uint8_t min_free[BMM_NO_OF_CLASSES];
+    /** Failed allocations per requested size class */
+    uint16_t alloc_failures[BMM_NO_OF_CLASSES];
+    /** Buffers currently allocated per owner */
+    uint8_t used[BMM_NO_OF_OWNERS];
+    /** Maximum of concurrently allocated buffers per owner */
+    uint8_t peak_used[BMM_NO_OF_OWNERS];
+} bmm_stats_t;
+#endif  /* ENABLE_BMM_STATS */
+
 /* === Externals =========================================================== */
 
 
@@ -84,6 +154,27 @@ extern "C" {
      */
     buffer_t *bmm_buffer_alloc(uint8_t size);
 
+#if defined(ENABLE_BMM_STATS) || defined(DOXYGEN)
+    /**
+     * @brief Allocates a buffer for a given owner
+     *
+     * Same as bmm_buffer_alloc, but the buffer is accounted to the given
+     * owner. With ENABLE_BMM_STATS bmm_buffer_alloc is mapped to this
+     * function with the owner BMM_OWNER of the calling source file.
+     *
+     * @param size size of buffer to be allocated.
+     * @param owner Owner of the buffer
+     *
+     * @return pointer to the buffer allocated,
+     *  NULL if buffer not available.
+     *
+     * @ingroup apiResApi
+     */
+    buffer_t *bmm_buffer_alloc_owner(uint8_t size, bmm_owner_t owner);
+
+#define bmm_buffer_alloc(size)  bmm_buffer_alloc_owner((size), BMM_OWNER)
+#endif  /* ENABLE_BMM_STATS */
+
     /**
      * @brief Frees up a buffer.
      *
@@ -97,6 +188,48 @@ extern "C" {
      */
     void bmm_buffer_free(buffer_t *pbuffer);
 
+#if defined(ENABLE_BMM_STATS) || defined(DOXYGEN)
+    /**
+     * @brief Returns the statistics of the buffer pool.
+     *
+     * @param stats Pointer to the statistics to be filled
+     * @param reset If true, the minimum of free buffers, the allocation
+     *              failures and the peak use are restarted from the
+     *              current state.
+     *
+     * @ingroup apiResApi
+     */
+    void bmm_get_stats(bmm_stats_t *stats, bool reset);
+#endif  /* ENABLE_BMM_STATS */
+
+#if defined(ENABLE_QUEUE_INDEX) || defined(DOXYGEN)
+    /**
+     * @brief Returns the number of a buffer.
+     *
+     * The buffers are numbered from 0 to TOTAL_NUMBER_OF_BUFS - 1, so
+     * per-buffer information can be kept in arrays instead of the buffer
+     * header.
+     *
+     * @param pbuffer Pointer to the buffer header
+     *
+     * @return Number of the buffer
+     *
+     * @ingroup apiResApi
+     */
+    uint8_t bmm_buffer_number(buffer_t *pbuffer);
+
+    /**
+     * @brief Returns the buffer of a given number.
+     *
+     * @param number Number of the buffer
+     *
+     * @return Pointer to the buffer header
+     *
+     * @ingroup apiResApi
+     */
+    buffer_t *bmm_buffer_by_number(uint8_t number);
+#endif  /* ENABLE_QUEUE_INDEX */
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -26,6 +26,13 @@
 #include "tal.h"
 #include "ieee_const.h"
 #include "app_config.h"
+#if defined(ENABLE_BMM_MSG_BUFS) && (HIGHEST_STACK_LAYER == MAC)
+/* The size of the small buffers is derived from the message types. */
+#include "mac_msg_types.h"
+#ifdef ENABLE_RTB
+#include "rtb_msg_types.h"
+#endif  /* ENABLE_RTB */
+#endif
 
 #if (TOTAL_NUMBER_OF_BUFS > 0)
 
@@ -82,8 +89,29 @@ static queue_t free_large_buffer_q;
 static queue_t free_small_buffer_q;
 #endif
 
+#ifdef ENABLE_BMM_STATS
+/*
+ * Owner of each allocated buffer, by buffer number
+ */
+static uint8_t buf_owner[TOTAL_NUMBER_OF_LARGE_BUFS + TOTAL_NUMBER_OF_SMALL_BUFS];
+
+/*
+ * Statistics of the buffer pool; the numbers of free buffers are taken from
+ * the free buffer queues.
+ */
+static uint8_t min_free[BMM_NO_OF_CLASSES];
+static uint16_t alloc_failures[BMM_NO_OF_CLASSES];
+static uint8_t used[BMM_NO_OF_OWNERS];
+static uint8_t peak_used[BMM_NO_OF_OWNERS];
+#endif  /* ENABLE_BMM_STATS */
+
 /* === Prototypes ========================================================== */
 
+#ifdef ENABLE_BMM_STATS
+static void free_buffers(uint8_t *free);
+static void update_alloc_stats(buffer_t *pbuffer, uint8_t size,
+                               bmm_owner_t owner);
+#endif  /* ENABLE_BMM_STATS */
 
 /* === Implementation ====================================================== */
 
@@ -146,6 +174,19 @@ void bmm_buffer_init(void)
                          &buf_header[index + TOTAL_NUMBER_OF_LARGE_BUFS]);
     }
 #endif
+
+#ifdef ENABLE_BMM_STATS
+    free_buffers(min_free);
+    for (index = 0; index < BMM_NO_OF_CLASSES; index++)
+    {
+        alloc_failures[index] = 0;
+    }
+    for (index = 0; index < BMM_NO_OF_OWNERS; index++)
+    {
+        used[index] = 0;
+        peak_used[index] = 0;
+    }
+#endif  /* ENABLE_BMM_STATS */
 }
 
 
@@ -161,7 +202,11 @@ void bmm_buffer_init(void)
  * @return pointer to the buffer allocated,
  *  NULL if buffer not available.
  */
+#ifdef ENABLE_BMM_STATS
+buffer_t *bmm_buffer_alloc_owner(uint8_t size, bmm_owner_t owner)
+#else
 buffer_t *bmm_buffer_alloc(uint8_t size)
+#endif  /* ENABLE_BMM_STATS */
 {
     buffer_t *pfree_buffer = NULL;
 
@@ -199,10 +244,33 @@ buffer_t *bmm_buffer_alloc(uint8_t size)
     size = size;    /* Keep compiler happy. */
 #endif
 
+#ifdef ENABLE_BMM_STATS
+    update_alloc_stats(pfree_buffer, size, owner);
+#endif  /* ENABLE_BMM_STATS */
+
     return pfree_buffer;
 }
 
 
+#ifdef ENABLE_BMM_STATS
+/**
+ * @brief Allocates a buffer
+ *
+ * Allocation by callers not using the bmm_buffer_alloc macro of bmm.h,
+ * the buffer is accounted to the application.
+ *
+ * @param size size of buffer to be allocated.
+ *
+ * @return pointer to the buffer allocated,
+ *  NULL if buffer not available.
+ */
+buffer_t *(bmm_buffer_alloc)(uint8_t size)
+{
+    return (bmm_buffer_alloc_owner(size, BMM_OWNER_APP));
+}
+#endif  /* ENABLE_BMM_STATS */
+
+
 /**
  * @brief Frees up a buffer.
  *
@@ -220,6 +288,15 @@ void bmm_buffer_free(buffer_t *pbuffer)
         return;
     }
 
+#ifdef ENABLE_BMM_STATS
+    ENTER_CRITICAL_REGION();
+    if (used[buf_owner[pbuffer - buf_header]] > 0)
+    {
+        used[buf_owner[pbuffer - buf_header]]--;
+    }
+    LEAVE_CRITICAL_REGION();
+#endif  /* ENABLE_BMM_STATS */
+
 #if (TOTAL_NUMBER_OF_SMALL_BUFS > 0)
     if (IS_SMALL_BUF(pbuffer))
     {
@@ -238,5 +315,151 @@ void bmm_buffer_free(buffer_t *pbuffer)
 
 }
 
+
+#ifdef ENABLE_QUEUE_INDEX
+/**
+ * @brief Returns the number of a buffer.
+ *
+ * @param pbuffer Pointer to the buffer header
+ *
+ * @return Number of the buffer
+ */
+uint8_t bmm_buffer_number(buffer_t *pbuffer)
+{
+    return ((uint8_t)(pbuffer - buf_header));
+}
+
+
+/**
+ * @brief Returns the buffer of a given number.
+ *
+ * @param number Number of the buffer
+ *
+ * @return Pointer to the buffer header
+ */
+buffer_t *bmm_buffer_by_number(uint8_t number)
+{
+    return (&buf_header[number]);
+}
+#endif  /* ENABLE_QUEUE_INDEX */
+
+
+#ifdef ENABLE_BMM_STATS
+/**
+ * @brief Returns the statistics of the buffer pool.
+ *
+ * @param stats Pointer to the statistics to be filled
+ * @param reset If true, the minimum of free buffers, the allocation
+ *              failures and the peak use are restarted from the
+ *              current state.
+ */
+void bmm_get_stats(bmm_stats_t *stats, bool reset)
+{
+    uint8_t index;
+
+    ENTER_CRITICAL_REGION();
+
+    free_buffers(stats->free);
+    for (index = 0; index < BMM_NO_OF_CLASSES; index++)
+    {
+        stats->min_free[index] = min_free[index];
+        stats->alloc_failures[index] = alloc_failures[index];
+        if (reset)
+        {
+            min_free[index] = stats->free[index];
+            alloc_failures[index] = 0;
+        }
+    }
+
+    for (index = 0; index < BMM_NO_OF_OWNERS; index++)
+    {
+        stats->used[index] = used[index];
+        stats->peak_used[index] = peak_used[index];
+        if (reset)
+        {
+            peak_used[index] = used[index];
+        }
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/*
+ * @brief Returns the number of free buffers per size class
+ *
+ * @param free Array of BMM_NO_OF_CLASSES entries to be filled
+ */
+static void free_buffers(uint8_t *free)
+{
+#if (TOTAL_NUMBER_OF_LARGE_BUFS > 0)
+    free[BMM_CLASS_LARGE] = free_large_buffer_q.size;
+#else
+    free[BMM_CLASS_LARGE] = 0;
+#endif
+#if (TOTAL_NUMBER_OF_SMALL_BUFS > 0)
+    free[BMM_CLASS_SMALL] = free_small_buffer_q.size;
+#else
+    free[BMM_CLASS_SMALL] = 0;
+#endif
+}
+
+
+
+/*
+ * @brief Updates the statistics after an allocation
+ *
+ * @param pbuffer Allocated buffer, NULL if the allocation failed
+ * @param size Requested size
+ * @param owner Owner of the buffer
+ */
+static void update_alloc_stats(buffer_t *pbuffer, uint8_t size,
+                               bmm_owner_t owner)
+{
+    ENTER_CRITICAL_REGION();
+
+    if (NULL == pbuffer)
+    {
+        uint8_t size_class = BMM_CLASS_LARGE;
+
+#if (TOTAL_NUMBER_OF_SMALL_BUFS > 0)
+        if (size <= SMALL_BUFFER_SIZE)
+        {
+            size_class = BMM_CLASS_SMALL;
+        }
+#else
+        size = size;    /* Keep compiler happy. */
+#endif
+        if (alloc_failures[size_class] < UINT16_MAX)
+        {
+            alloc_failures[size_class]++;
+        }
+    }
+    else
+    {
+        uint8_t free[BMM_NO_OF_CLASSES];
+
+        buf_owner[pbuffer - buf_header] = owner;
+        used[owner]++;
+        if (used[owner] > peak_used[owner])
+        {
+            peak_used[owner] = used[owner];
+        }
+
+        free_buffers(free);
+        for (uint8_t index = 0; index < BMM_NO_OF_CLASSES; index++)
+        {
+            if (free[index] < min_free[index])
+            {
+                min_free[index] = free[index];
+            }
+        }
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+#endif  /* ENABLE_BMM_STATS */
+
 #endif /* (TOTAL_NUMBER_OF_BUFS > 0) */
 /* EOF */
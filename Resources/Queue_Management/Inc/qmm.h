@@ -25,6 +25,20 @@
 
 /* === Macros ============================================================== */
 
+#if defined(ENABLE_QUEUE_INDEX) || defined(DOXYGEN)
+/** Number of keys by which the buffers of an indexed queue can be found */
+#ifndef QUEUE_INDEX_KEYS
+#define QUEUE_INDEX_KEYS                (2)
+#endif
+
+/** Number of hash buckets per key of an indexed queue (power of 2) */
+#ifndef QUEUE_INDEX_BUCKETS
+#define QUEUE_INDEX_BUCKETS             (16)
+#endif
+
+/** Buffer number marking an empty hash bucket */
+#define QUEUE_INDEX_NONE                (0xFF)
+#endif  /* ENABLE_QUEUE_INDEX */
 
 /* === Types =============================================================== */
 
@@ -42,6 +56,30 @@ typedef struct
     void *handle;
 } search_t;
 
+#if defined(ENABLE_QUEUE_INDEX) || defined(DOXYGEN)
+/**
+ * @brief Keyed index of a queue
+ *
+ * The index chains the buffers of a queue per key value, so buffers can be
+ * found without traversing the complete queue. The keys of a buffer are
+ * taken by the key function when the buffer is appended; they must not
+ * change while the buffer is queued.
+ */
+typedef struct
+#if !defined(DOXYGEN)
+        queue_index_tag
+#endif
+{
+    /**
+     * Pointer to key function. Returns false if the buffer has no key of the
+     * given number, otherwise the key is written to key.
+     */
+    bool (*key_func)(void *buf, uint8_t key_no, uint16_t *key);
+    /** Number of the oldest buffer of each hash bucket */
+    uint8_t bucket[QUEUE_INDEX_KEYS][QUEUE_INDEX_BUCKETS];
+} queue_index_t;
+#endif  /* ENABLE_QUEUE_INDEX */
+
 /**
  * @brief Queue structure
  *
@@ -72,6 +110,10 @@ typedef struct
      * Number of buffers present in the current queue
      */
     uint8_t size;
+#ifdef ENABLE_QUEUE_INDEX
+    /** Pointer to keyed index, NULL if the queue is not indexed */
+    queue_index_t *index;
+#endif  /* ENABLE_QUEUE_INDEX */
 } queue_t;
 
 /* === Externals =========================================================== */
@@ -163,6 +205,75 @@ extern "C"
      */
     void qmm_queue_flush(queue_t *q);
 
+#if defined(ENABLE_QUEUE_INDEX) || defined(DOXYGEN)
+    /**
+     * @brief Attaches a keyed index to a queue.
+     *
+     * Buffers already present in the queue are added to the index.
+     * Note that the index is detached by qmm_queue_init.
+     *
+     * @param q Queue to be indexed
+     * @param index Index to be attached
+     * @param key_func Function returning the keys of a buffer
+     *
+     * @ingroup apiResApi
+     */
+    void qmm_queue_index_init(queue_t *q, queue_index_t *index,
+                              bool (*key_func)(void *buf, uint8_t key_no,
+                                               uint16_t *key));
+
+    /**
+     * @brief Reads a buffer by key from an indexed queue.
+     *
+     * Only buffers with the given key are passed to the search criteria,
+     * the first matching buffer in queue order is returned. If the queue
+     * is not indexed, the complete queue is searched.
+     *
+     * @param q The queue from which buffer should be read.
+     * @param key_no Number of the key
+     * @param key Key of the buffer
+     * @param search Search criteria, NULL matches any buffer with the key.
+     *
+     * @return Pointer to the buffer header, NULL if no buffer matches
+     *
+     * @ingroup apiResApi
+     */
+    buffer_t *qmm_queue_index_read(queue_t *q, uint8_t key_no, uint16_t key,
+                                   search_t *search);
+
+    /**
+     * @brief Removes a buffer by key from an indexed queue.
+     *
+     * Same as qmm_queue_index_read, but the buffer is removed from the queue.
+     *
+     * @param q Queue from which buffer should be removed
+     * @param key_no Number of the key
+     * @param key Key of the buffer
+     * @param search Search criteria, NULL matches any buffer with the key.
+     *
+     * @return Pointer to the buffer header, NULL if no buffer matches
+     *
+     * @ingroup apiResApi
+     */
+    buffer_t *qmm_queue_index_remove(queue_t *q, uint8_t key_no, uint16_t key,
+                                     search_t *search);
+
+    /**
+     * @brief Removes a given buffer from a queue.
+     *
+     * The buffer is removed in constant time from an indexed queue, other
+     * queues are searched for the buffer.
+     *
+     * @param q Queue from which buffer should be removed
+     * @param buf Pointer to the buffer header
+     *
+     * @return Pointer to the buffer header, NULL if the buffer is not queued
+     *
+     * @ingroup apiResApi
+     */
+    buffer_t *qmm_queue_remove_buffer(queue_t *q, buffer_t *buf);
+#endif  /* ENABLE_QUEUE_INDEX */
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
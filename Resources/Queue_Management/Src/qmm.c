@@ -42,12 +42,55 @@ typedef enum buffer_mode_tag
 
 /* === Macros ============================================================== */
 
+#ifdef ENABLE_QUEUE_INDEX
+/* Hash bucket of a key */
+#define INDEX_BUCKET(key)   ((uint8_t)((key) ^ ((key) >> 8)) & \
+                             (QUEUE_INDEX_BUCKETS - 1))
+#endif  /* ENABLE_QUEUE_INDEX */
+
+/* === Globals ============================================================= */
+
+#ifdef ENABLE_QUEUE_INDEX
+/*
+ * Links of the buffers of indexed queues, by buffer number. A buffer is
+ * member of one queue at a time, so the links can be shared by all queues.
+ */
+
+/* Indexed queue of a buffer, NULL if the buffer is in no indexed queue */
+static queue_t *queue_of[TOTAL_NUMBER_OF_BUFS];
+
+/* Predecessor of a buffer in its queue, QUEUE_INDEX_NONE for the head */
+static uint8_t queue_prev[TOTAL_NUMBER_OF_BUFS];
+
+/*
+ * Successor and predecessor of a buffer in the circular chain of its hash
+ * bucket per key. The predecessor of the oldest buffer of a bucket is the
+ * youngest one. The predecessor is QUEUE_INDEX_NONE if the buffer has no
+ * key of this number.
+ */
+static uint8_t chain_next[QUEUE_INDEX_KEYS][TOTAL_NUMBER_OF_BUFS];
+static uint8_t chain_prev[QUEUE_INDEX_KEYS][TOTAL_NUMBER_OF_BUFS];
+
+/* Keys of a buffer */
+static uint16_t chain_key[QUEUE_INDEX_KEYS][TOTAL_NUMBER_OF_BUFS];
+#endif  /* ENABLE_QUEUE_INDEX */
 
 /* === Prototypes ========================================================== */
 
 static buffer_t *queue_read_or_remove(queue_t *q,
                                       buffer_mode_t mode,
                                       search_t *search);
+#ifdef ENABLE_QUEUE_INDEX
+static void index_insert(queue_t *q, buffer_t *buf);
+static void index_unlink(queue_t *q, buffer_t *buf);
+static void index_remove(queue_t *q, buffer_t *buf);
+static buffer_t *index_read_or_remove(queue_t *q,
+                                      buffer_mode_t mode,
+                                      uint8_t key_no,
+                                      uint16_t key,
+                                      search_t *search);
+static uint8_t is_buffer_cb(void *buf, void *body);
+#endif  /* ENABLE_QUEUE_INDEX */
 
 /* === Implementation ====================================================== */
 
@@ -71,6 +114,9 @@ void qmm_queue_init(queue_t *q)
 #ifdef ENABLE_QUEUE_CAPACITY
     q->capacity = capacity;
 #endif  /* ENABLE_QUEUE_CAPACITY */
+#ifdef ENABLE_QUEUE_INDEX
+    q->index = NULL;
+#endif  /* ENABLE_QUEUE_INDEX */
 }
 
 
@@ -107,6 +153,14 @@ void qmm_queue_append(queue_t *q, buffer_t *buf)
     else
 #endif  /* ENABLE_QUEUE_CAPACITY */
     {
+#ifdef ENABLE_QUEUE_INDEX
+        if (NULL != q->index)
+        {
+            /* Add the buffer to the index before the tail is updated */
+            index_insert(q, buf);
+        }
+#endif  /* ENABLE_QUEUE_INDEX */
+
         /* Check whether queue is empty */
         if (q->size == 0)
         {
@@ -234,6 +288,13 @@ static buffer_t *queue_read_or_remove(queue_t *q,
                 {
                     q->tail = NULL;
                 }
+
+#ifdef ENABLE_QUEUE_INDEX
+                if (NULL != q->index)
+                {
+                    index_unlink(q, buffer_current);
+                }
+#endif  /* ENABLE_QUEUE_INDEX */
             }
             /* Read buffer from the queue */
             else
@@ -320,6 +381,366 @@ void qmm_queue_flush(queue_t *q)
     }
 }
 
+
+#ifdef ENABLE_QUEUE_INDEX
+/**
+ * @brief Attaches a keyed index to a queue.
+ *
+ * Buffers already present in the queue are added to the index.
+ * Note that the index is detached by qmm_queue_init.
+ *
+ * @param q Queue to be indexed
+ * @param index Index to be attached
+ * @param key_func Function returning the keys of a buffer
+ */
+void qmm_queue_index_init(queue_t *q, queue_index_t *index,
+                          bool (*key_func)(void *buf, uint8_t key_no,
+                                           uint16_t *key))
+{
+    buffer_t *buf;
+    buffer_t *last;
+
+    ENTER_CRITICAL_REGION();
+
+    index->key_func = key_func;
+    for (uint8_t key_no = 0; key_no < QUEUE_INDEX_KEYS; key_no++)
+    {
+        for (uint8_t b = 0; b < QUEUE_INDEX_BUCKETS; b++)
+        {
+            index->bucket[key_no][b] = QUEUE_INDEX_NONE;
+        }
+    }
+    q->index = index;
+
+    /* index_insert() links to the tail, so rebuild the queue buffer by buffer */
+    buf = q->head;
+    last = q->tail;
+    q->tail = NULL;
+    q->size = 0;
+    while (NULL != buf)
+    {
+        index_insert(q, buf);
+        q->tail = buf;
+        q->size++;
+        if (buf == last)
+        {
+            break;
+        }
+        buf = buf->next;
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Reads a buffer by key from an indexed queue.
+ *
+ * @param q The queue from which buffer should be read.
+ * @param key_no Number of the key
+ * @param key Key of the buffer
+ * @param search Search criteria, NULL matches any buffer with the key.
+ *
+ * @return Pointer to the buffer header, NULL if no buffer matches
+ */
+buffer_t *qmm_queue_index_read(queue_t *q, uint8_t key_no, uint16_t key,
+                               search_t *search)
+{
+    return (index_read_or_remove(q, READ_MODE, key_no, key, search));
+}
+
+
+
+/**
+ * @brief Removes a buffer by key from an indexed queue.
+ *
+ * @param q Queue from which buffer should be removed
+ * @param key_no Number of the key
+ * @param key Key of the buffer
+ * @param search Search criteria, NULL matches any buffer with the key.
+ *
+ * @return Pointer to the buffer header, NULL if no buffer matches
+ */
+buffer_t *qmm_queue_index_remove(queue_t *q, uint8_t key_no, uint16_t key,
+                                 search_t *search)
+{
+    return (index_read_or_remove(q, REMOVE_MODE, key_no, key, search));
+}
+
+
+
+/**
+ * @brief Removes a given buffer from a queue.
+ *
+ * @param q Queue from which buffer should be removed
+ * @param buf Pointer to the buffer header
+ *
+ * @return Pointer to the buffer header, NULL if the buffer is not queued
+ */
+buffer_t *qmm_queue_remove_buffer(queue_t *q, buffer_t *buf)
+{
+    if (NULL == q->index)
+    {
+        search_t find_buf;
+
+        find_buf.criteria_func = is_buffer_cb;
+        find_buf.handle = buf->body;
+
+        return (queue_read_or_remove(q, REMOVE_MODE, &find_buf));
+    }
+
+    ENTER_CRITICAL_REGION();
+
+    if (queue_of[bmm_buffer_number(buf)] == q)
+    {
+        index_remove(q, buf);
+    }
+    else
+    {
+        buf = NULL;
+    }
+
+    LEAVE_CRITICAL_REGION();
+
+    return (buf);
+}
+
+
+
+/*
+ * @brief Adds a buffer to the index of a queue
+ *
+ * The buffer is added as youngest buffer of the queue and of the hash
+ * buckets of its keys. Called with interrupts disabled before the buffer
+ * is linked to the queue.
+ *
+ * @param q Indexed queue
+ * @param buf Pointer to the buffer header
+ */
+static void index_insert(queue_t *q, buffer_t *buf)
+{
+    uint8_t number = bmm_buffer_number(buf);
+
+    queue_of[number] = q;
+
+    if (q->size == 0)
+    {
+        queue_prev[number] = QUEUE_INDEX_NONE;
+    }
+    else
+    {
+        queue_prev[number] = bmm_buffer_number(q->tail);
+    }
+
+    for (uint8_t key_no = 0; key_no < QUEUE_INDEX_KEYS; key_no++)
+    {
+        uint16_t key;
+        uint8_t *head;
+
+        if (!q->index->key_func((void *)buf->body, key_no, &key))
+        {
+            chain_prev[key_no][number] = QUEUE_INDEX_NONE;
+            continue;
+        }
+
+        chain_key[key_no][number] = key;
+        head = &q->index->bucket[key_no][INDEX_BUCKET(key)];
+
+        if (QUEUE_INDEX_NONE == *head)
+        {
+            /* First buffer of the bucket */
+            *head = number;
+            chain_next[key_no][number] = number;
+            chain_prev[key_no][number] = number;
+        }
+        else
+        {
+            /* Link between youngest and oldest buffer of the bucket */
+            uint8_t youngest = chain_prev[key_no][*head];
+
+            chain_next[key_no][youngest] = number;
+            chain_prev[key_no][number] = youngest;
+            chain_next[key_no][number] = *head;
+            chain_prev[key_no][*head] = number;
+        }
+    }
+}
+
+
+
+/*
+ * @brief Removes a buffer from the index of a queue
+ *
+ * Called with interrupts disabled after the buffer has been unlinked from
+ * the queue; the next pointer of the buffer must still be valid.
+ *
+ * @param q Indexed queue
+ * @param buf Pointer to the buffer header
+ */
+static void index_unlink(queue_t *q, buffer_t *buf)
+{
+    uint8_t number = bmm_buffer_number(buf);
+
+    queue_of[number] = NULL;
+
+    if (NULL != buf->next)
+    {
+        queue_prev[bmm_buffer_number(buf->next)] = queue_prev[number];
+    }
+
+    for (uint8_t key_no = 0; key_no < QUEUE_INDEX_KEYS; key_no++)
+    {
+        uint8_t next = chain_next[key_no][number];
+        uint8_t prev = chain_prev[key_no][number];
+        uint8_t *head;
+
+        if (QUEUE_INDEX_NONE == prev)
+        {
+            continue;
+        }
+
+        head = &q->index->bucket[key_no][INDEX_BUCKET(chain_key[key_no][number])];
+
+        if (next == number)
+        {
+            /* Last buffer of the bucket */
+            *head = QUEUE_INDEX_NONE;
+        }
+        else
+        {
+            chain_next[key_no][prev] = next;
+            chain_prev[key_no][next] = prev;
+            if (*head == number)
+            {
+                *head = next;
+            }
+        }
+
+        chain_prev[key_no][number] = QUEUE_INDEX_NONE;
+    }
+}
+
+
+
+/*
+ * @brief Removes a buffer of an indexed queue from the queue and the index
+ *
+ * Called with interrupts disabled.
+ *
+ * @param q Indexed queue
+ * @param buf Pointer to the buffer header, must be member of the queue
+ */
+static void index_remove(queue_t *q, buffer_t *buf)
+{
+    uint8_t prev = queue_prev[bmm_buffer_number(buf)];
+    buffer_t *buffer_previous = NULL;
+
+    if (QUEUE_INDEX_NONE == prev)
+    {
+        q->head = buf->next;
+    }
+    else
+    {
+        buffer_previous = bmm_buffer_by_number(prev);
+        buffer_previous->next = buf->next;
+    }
+
+    if (buf == q->tail)
+    {
+        q->tail = buffer_previous;
+    }
+
+    q->size--;
+
+    index_unlink(q, buf);
+}
+
+
+
+/*
+ * @brief Reads or removes a buffer by key from an indexed queue
+ *
+ * Only the hash bucket of the key is searched, from the oldest to the
+ * youngest buffer, so the first matching buffer in queue order is found.
+ * Queues without index are searched completely.
+ *
+ * @param q Queue from which buffer is to be read or removed.
+ * @param mode REMOVE_MODE or READ_MODE
+ * @param key_no Number of the key
+ * @param key Key of the buffer
+ * @param search Search criteria structure pointer, may be NULL.
+ *
+ * @return Buffer header pointer, if the buffer is successfully
+ *         removed or read, otherwise NULL is returned.
+ */
+static buffer_t *index_read_or_remove(queue_t *q,
+                                      buffer_mode_t mode,
+                                      uint8_t key_no,
+                                      uint16_t key,
+                                      search_t *search)
+{
+    buffer_t *buffer_current = NULL;
+    uint8_t head;
+    uint8_t number;
+
+    if (NULL == q->index)
+    {
+        return (queue_read_or_remove(q, mode, search));
+    }
+
+    ENTER_CRITICAL_REGION();
+
+    head = q->index->bucket[key_no][INDEX_BUCKET(key)];
+    number = head;
+
+    if (QUEUE_INDEX_NONE != head)
+    {
+        do
+        {
+            if (chain_key[key_no][number] == key)
+            {
+                buffer_t *buf = bmm_buffer_by_number(number);
+
+                if ((NULL == search) ||
+                    search->criteria_func((void *)buf->body, search->handle))
+                {
+                    buffer_current = buf;
+                    break;
+                }
+            }
+
+            number = chain_next[key_no][number];
+        }
+        while (number != head);
+    }
+
+    if ((NULL != buffer_current) && (REMOVE_MODE == mode))
+    {
+        index_remove(q, buffer_current);
+    }
+
+    LEAVE_CRITICAL_REGION();
+
+    return (buffer_current);
+}
+
+
+
+/*
+ * @brief Checks whether a buffer is the searched one
+ *
+ * @param buf Pointer to the buffer body
+ * @param body Pointer to the body of the searched buffer
+ *
+ * @return 1 if the buffer is the searched one, 0 otherwise
+ */
+static uint8_t is_buffer_cb(void *buf, void *body)
+{
+    return (buf == body);
+}
+#endif  /* ENABLE_QUEUE_INDEX */
+
 #endif  /* (TOTAL_NUMBER_OF_BUFS > 0) */
 
 /* EOF */
@@ -105,6 +105,12 @@ extern bool tal_beacon_transmission;
 
 /* === MACROS ============================================================== */
 
+#ifdef ENABLE_BMM_STATS
+/* Buffers allocated by the TAL are accounted to the TAL. */
+#undef BMM_OWNER
+#define BMM_OWNER                       (BMM_OWNER_TAL)
+#endif  /* ENABLE_BMM_STATS */
+
 /**
  * Conversion of number of PSDU octets to duration in microseconds
  */